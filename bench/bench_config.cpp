@@ -0,0 +1,45 @@
+#include <benchmark/benchmark.h>
+
+#include "bench_data.hpp"
+#include "core/config.hpp"
+
+#ifndef ENVIRONET_BENCH_CONFIG_FILE
+#define ENVIRONET_BENCH_CONFIG_FILE "config/config.json"
+#endif
+
+using namespace environet;
+
+// File read + JSON parse + validation, as done once per component at startup
+static void BM_ConfigLoad(benchmark::State& state) {
+    const std::string path = ENVIRONET_BENCH_CONFIG_FILE;
+    if (bench::read_file(path).empty()) {
+        state.SkipWithError("config.json not found");
+        return;
+    }
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(core::Config::load(path));
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_ConfigLoad);
+
+static void BM_ConfigFromJson(benchmark::State& state) {
+    const std::string json = bench::read_file(ENVIRONET_BENCH_CONFIG_FILE);
+    if (json.empty()) {
+        state.SkipWithError("config.json not found");
+        return;
+    }
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(core::Config::from_json(json));
+    }
+    state.SetBytesProcessed(state.iterations() * static_cast<int64_t>(json.size()));
+}
+BENCHMARK(BM_ConfigFromJson);
+
+static void BM_ConfigToJson(benchmark::State& state) {
+    const auto config = core::Config::get_defaults();
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(config.to_json());
+    }
+}
+BENCHMARK(BM_ConfigToJson);
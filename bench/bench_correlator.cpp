@@ -0,0 +1,268 @@
+#include <benchmark/benchmark.h>
+#include <algorithm>
+#include <arpa/inet.h>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <memory>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <vector>
+
+#include "bench_data.hpp"
+#include "correlate/correlator.hpp"
+#include "correlate/live_feed.hpp"
+#include "correlate/query_api.hpp"
+#include "net/pcap_sniffer.hpp"
+
+using namespace environet;
+
+namespace {
+
+// Pushes per correlator before it is replaced, keeping buffers realistic
+constexpr size_t kPushBatch = 4096;
+
+std::vector<net::PacketMeta> packet_metas() {
+    bench::Capture capture;
+    bench::load_pcap(bench::data_path("synthetic_en10mb.pcap"), capture);
+    std::vector<net::PacketMeta> metas;
+    metas.reserve(capture.packets.size());
+    for (const auto& pkt : capture.packets) {
+        net::PacketMeta meta;
+        meta.length = pkt.len;
+        net::PcapSniffer::parse_packet(pkt.data.data(), pkt.caplen, meta);
+        metas.push_back(std::move(meta));
+    }
+    return metas;
+}
+
+const std::vector<net::PacketMeta>& bench_packets() {
+    static const auto metas = packet_metas();
+    return metas;
+}
+
+const std::vector<sensors::SensorFrame>& bench_frames() {
+    static const auto frames = bench::load_sensor_trace(bench::data_path("sensor_trace.csv"));
+    return frames;
+}
+
+// Correlator loaded with one window of sensor, WiFi, packet and ping data
+std::unique_ptr<correlate::Correlator> loaded_correlator(size_t packets) {
+    auto corr = std::make_unique<correlate::Correlator>("");
+    corr->init();
+    const auto& frames = bench_frames();
+    const auto& metas = bench_packets();
+    for (size_t i = 0; i < frames.size() && i < 50; ++i) corr->push_sensor(frames[i]);
+    for (int i = 0; i < 20; ++i) {
+        net::BssInfo bss("bench", "02:00:00:00:00:01", 2437, -5000 - i * 50);
+        corr->push_bss(bss);
+    }
+    for (size_t i = 0; i < packets && !metas.empty(); ++i) corr->push_packet(metas[i % metas.size()]);
+    for (int i = 0; i < 5; ++i) {
+        net::PingStats ps;
+        ps.target = "8.8.8.8";
+        ps.avg_rtt_ms = 14.0 + i;
+        ps.reachable = true;
+        corr->push_ping_stats(ps);
+    }
+    return corr;
+}
+
+} // namespace
+
+static void BM_CorrelatorPushSensor(benchmark::State& state) {
+    const auto& frames = bench_frames();
+    if (frames.empty()) {
+        state.SkipWithError("sensor_trace.csv not found");
+        return;
+    }
+    auto corr = std::make_unique<correlate::Correlator>("");
+    size_t i = 0, n = 0;
+    for (auto _ : state) {
+        corr->push_sensor(frames[i]);
+        if (++i == frames.size()) i = 0;
+        if (++n == kPushBatch) {
+            state.PauseTiming();
+            corr = std::make_unique<correlate::Correlator>("");
+            n = 0;
+            state.ResumeTiming();
+        }
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_CorrelatorPushSensor);
+
+static void BM_CorrelatorPushPacket(benchmark::State& state) {
+    const auto& metas = bench_packets();
+    if (metas.empty()) {
+        state.SkipWithError("synthetic_en10mb.pcap not found");
+        return;
+    }
+    auto corr = std::make_unique<correlate::Correlator>("");
+    size_t i = 0, n = 0;
+    for (auto _ : state) {
+        corr->push_packet(metas[i]);
+        if (++i == metas.size()) i = 0;
+        if (++n == kPushBatch) {
+            state.PauseTiming();
+            corr = std::make_unique<correlate::Correlator>("");
+            n = 0;
+            state.ResumeTiming();
+        }
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_CorrelatorPushPacket);
+
+static void BM_CorrelatorPushPacketContended(benchmark::State& state) {
+    static correlate::Correlator* shared = nullptr;
+    if (state.thread_index() == 0) shared = new correlate::Correlator("");
+    const auto& metas = bench_packets();
+    size_t i = static_cast<size_t>(state.thread_index());
+    for (auto _ : state) {
+        shared->push_packet(metas[i % metas.size()]);
+        ++i;
+    }
+    state.SetItemsProcessed(state.iterations());
+    if (state.thread_index() == 0) {
+        delete shared;
+        shared = nullptr;
+    }
+}
+BENCHMARK(BM_CorrelatorPushPacketContended)->Threads(2)->Threads(4)->Iterations(50000)->UseRealTime();
+
+static void BM_CorrelatorProcess(benchmark::State& state) {
+    auto corr = loaded_correlator(static_cast<size_t>(state.range(0)));
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(corr->process());
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_CorrelatorProcess)->Arg(1000)->Arg(10000);
+
+static void BM_CorrelatorWindowStats(benchmark::State& state) {
+    auto corr = loaded_correlator(static_cast<size_t>(state.range(0)));
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(corr->get_window_stats(0, UINT64_MAX));
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_CorrelatorWindowStats)->Arg(1000)->Arg(10000);
+
+// 60 one-second windows over the last minute; arg 1 = task pool workers (0 = inline)
+static void BM_CorrelatorWindowSeries(benchmark::State& state) {
+    auto corr = loaded_correlator(10000);
+    core::TaskPool pool;
+    if (state.range(0) > 0) {
+        pool.start(static_cast<size_t>(state.range(0)));
+        corr->set_task_pool(&pool);
+    }
+    uint64_t now = std::chrono::duration_cast<std::chrono::milliseconds>(
+                       std::chrono::steady_clock::now().time_since_epoch()).count();
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(corr->get_window_series(now - 60000, now + 1000, 1000));
+    }
+    state.SetItemsProcessed(state.iterations() * 61);
+    state.counters["steals"] = pool.get_stats()["steals"].get<double>();
+}
+BENCHMARK(BM_CorrelatorWindowSeries)->Arg(0)->Arg(2)->Arg(4)->UseRealTime();
+
+// One keep-alive request per iteration over loopback, response read in full;
+// arg = 0 packet series (60 points), 1 findings, 2 window statistics
+static void BM_QueryApi(benchmark::State& state) {
+    static const char* const targets[] = {
+        "/api/v1/series?name=packets&last=60000&step=1000",
+        "/api/v1/findings?limit=100",
+        "/api/v1/window?last=60000",
+    };
+    auto corr = loaded_correlator(10000);
+    auto config = std::make_shared<core::Config>(core::Config::get_defaults());
+    config->api.port = 0;
+    correlate::QueryApi api(config, *corr);
+    if (!api.start()) {
+        state.SkipWithError("query API failed to start");
+        return;
+    }
+    int fd = socket(AF_INET, SOCK_STREAM, 0);
+    sockaddr_in addr{};
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(static_cast<uint16_t>(api.port()));
+    inet_pton(AF_INET, "127.0.0.1", &addr.sin_addr);
+    int one = 1;
+    setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+    if (connect(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0) {
+        close(fd);
+        state.SkipWithError("connect failed");
+        return;
+    }
+    std::string req = std::string("GET ") + targets[state.range(0)] + " HTTP/1.1\r\nHost: bench\r\n\r\n";
+    std::string resp;
+    char buf[65536];
+    std::vector<double> latency_us;
+    size_t bytes = 0;
+    for (auto _ : state) {
+        auto start = std::chrono::steady_clock::now();
+        send(fd, req.data(), req.size(), 0);
+        resp.clear();
+        size_t header_end = std::string::npos, total = 0;
+        while (header_end == std::string::npos || resp.size() < total) {
+            ssize_t n = recv(fd, buf, sizeof(buf), 0);
+            if (n <= 0) break;
+            resp.append(buf, static_cast<size_t>(n));
+            if (header_end == std::string::npos && (header_end = resp.find("\r\n\r\n")) != std::string::npos) {
+                size_t cl = resp.find("Content-Length: ");
+                total = header_end + 4 + std::strtoul(resp.c_str() + cl + 16, nullptr, 10);
+            }
+        }
+        latency_us.push_back(std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count());
+        bytes += resp.size();
+    }
+    close(fd);
+    api.stop();
+    state.SetItemsProcessed(state.iterations());
+    state.SetBytesProcessed(static_cast<int64_t>(bytes));
+    if (!latency_us.empty()) {
+        auto p99 = latency_us.begin() + static_cast<std::ptrdiff_t>(latency_us.size() * 99 / 100);
+        std::nth_element(latency_us.begin(), p99, latency_us.end());
+        state.counters["p99_us"] = *p99;
+    }
+}
+BENCHMARK(BM_QueryApi)->Arg(0)->Arg(1)->Arg(2)->UseRealTime();
+
+// RSSI samples over 16 BSSIDs published to arg SSE clients that drain every
+// 64 publishes, so most updates are coalesced as for a slow reader
+static void BM_LiveFeedPublish(benchmark::State& state) {
+    auto config = std::make_shared<core::Config>(core::Config::get_defaults());
+    config->push.max_clients = 128;
+    correlate::LiveFeed feed(config);
+    std::vector<std::shared_ptr<core::HttpStream>> clients;
+    core::HttpRequest req;
+    req.query = "topics=rssi";
+    for (int64_t i = 0; i < state.range(0); ++i) {
+        core::HttpResponse resp;
+        clients.push_back(feed.open(req, resp));
+    }
+    std::vector<net::BssInfo> aps;
+    for (int i = 0; i < 16; ++i) {
+        aps.emplace_back("ap" + std::to_string(i), "aa:bb:cc:00:00:" + std::to_string(10 + i), 2412, -5000 - i * 100);
+    }
+    std::string out;
+    uint64_t n = 0;
+    for (auto _ : state) {
+        feed.publish_bss(n, aps[n % aps.size()]);
+        if (++n % 64 == 0) {
+            for (auto& c : clients) {
+                out.clear();
+                c->pull(out);
+            }
+        }
+    }
+    state.SetItemsProcessed(state.iterations());
+    auto stats = feed.get_stats();
+    state.counters["sent_per_publish"] =
+        static_cast<double>(stats["sent"].get<uint64_t>()) / static_cast<double>(std::max<uint64_t>(n, 1));
+    for (auto& c : clients) c->closed();
+}
+BENCHMARK(BM_LiveFeedPublish)->Arg(1)->Arg(16);
@@ -0,0 +1,97 @@
+#include "bench_data.hpp"
+
+#include <cstddef>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+
+#ifndef ENVIRONET_BENCH_DATA_DIR
+#define ENVIRONET_BENCH_DATA_DIR "bench/data"
+#endif
+
+namespace environet {
+namespace bench {
+
+std::string data_path(const std::string& name) {
+    const char* dir = std::getenv("ENVIRONET_BENCH_DATA");
+    return std::string(dir && *dir ? dir : ENVIRONET_BENCH_DATA_DIR) + "/" + name;
+}
+
+std::string read_file(const std::string& path) {
+    std::ifstream in(path, std::ios::binary);
+    if (!in) return {};
+    std::ostringstream ss;
+    ss << in.rdbuf();
+    return ss.str();
+}
+
+bool load_pcap(const std::string& path, Capture& capture) {
+    FILE* f = std::fopen(path.c_str(), "rb");
+    if (!f) return false;
+
+    uint8_t gh[24];
+    if (std::fread(gh, 1, sizeof(gh), f) != sizeof(gh)) {
+        std::fclose(f);
+        return false;
+    }
+    uint32_t magic;
+    std::memcpy(&magic, gh, 4);
+    bool swapped;
+    bool nanosecond = magic == 0xa1b23c4d || magic == 0x4d3cb2a1;
+    if (magic == 0xa1b2c3d4 || magic == 0xa1b23c4d) {
+        swapped = false;
+    } else if (magic == 0xd4c3b2a1 || magic == 0x4d3cb2a1) {
+        swapped = true;
+    } else {
+        std::fclose(f);
+        return false;
+    }
+    auto u32 = [swapped](const uint8_t* p) {
+        uint32_t v;
+        std::memcpy(&v, p, 4);
+        return swapped ? __builtin_bswap32(v) : v;
+    };
+    capture.linktype = static_cast<int>(u32(gh + 20) & 0x0FFFFFFF);
+    capture.packets.clear();
+
+    uint8_t rh[16];
+    while (std::fread(rh, 1, sizeof(rh), f) == sizeof(rh)) {
+        CapturedPacket pkt;
+        pkt.ts_us = u32(rh) * 1000000ULL + (nanosecond ? u32(rh + 4) / 1000 : u32(rh + 4));
+        pkt.caplen = u32(rh + 8);
+        pkt.len = u32(rh + 12);
+        if (pkt.caplen > 262144) break;  // corrupt record
+        pkt.data.resize(pkt.caplen);
+        if (std::fread(pkt.data.data(), 1, pkt.caplen, f) != pkt.caplen) break;
+        capture.packets.push_back(std::move(pkt));
+    }
+    std::fclose(f);
+    return !capture.packets.empty();
+}
+
+std::vector<sensors::SensorFrame> load_sensor_trace(const std::string& path) {
+    std::vector<sensors::SensorFrame> frames;
+    std::ifstream in(path);
+    std::string line;
+    std::getline(in, line);  // header
+    while (std::getline(in, line)) {
+        unsigned long ts = 0;
+        int ir = 0;
+        unsigned ultra = 0, status = 0;
+        if (std::sscanf(line.c_str(), "%lu,%d,%u,%u", &ts, &ir, &ultra, &status) != 4) continue;
+        sensors::SensorFrame frame;
+        frame.ts_ms = static_cast<uint32_t>(ts);
+        frame.ir_raw = static_cast<int16_t>(ir);
+        frame.ultra_mm = static_cast<uint16_t>(ultra);
+        frame.status = static_cast<uint8_t>(status);
+        frame.crc16 = sensors::ArduinoI2C::compute_crc16(reinterpret_cast<const uint8_t*>(&frame),
+                                                         sizeof(sensors::SensorFrame) - sizeof(uint16_t));
+        frames.push_back(frame);
+    }
+    return frames;
+}
+
+} // namespace bench
+} // namespace environet
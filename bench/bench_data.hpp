@@ -0,0 +1,72 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "sensors/arduino_i2c.hpp"
+
+namespace environet {
+namespace bench {
+
+/**
+ * @brief One packet read from a capture file
+ */
+struct CapturedPacket {
+    uint64_t ts_us;             // Capture timestamp in microseconds
+    uint32_t caplen;            // Captured bytes
+    uint32_t len;               // Original length on the wire
+    std::vector<uint8_t> data;  // Packet bytes (caplen)
+};
+
+/**
+ * @brief Packets and link type of a capture file
+ */
+struct Capture {
+    int linktype = 0;
+    std::vector<CapturedPacket> packets;
+};
+
+/**
+ * @brief Resolve a file in the bundled benchmark data directory
+ *
+ * The directory defaults to the compiled-in bench/data path and can be
+ * overridden with the ENVIRONET_BENCH_DATA environment variable.
+ *
+ * @param name File name
+ * @return Full path
+ */
+std::string data_path(const std::string& name);
+
+/**
+ * @brief Read a whole file into a string
+ *
+ * @param path File path
+ * @return File contents (empty if unreadable)
+ */
+std::string read_file(const std::string& path);
+
+/**
+ * @brief Load a classic (non-pcapng) pcap file
+ *
+ * Self-contained reader so benchmarks do not depend on libpcap and can run
+ * on hosts without capture privileges.
+ *
+ * @param path Capture file path
+ * @param capture Output capture
+ * @return true if the file was read
+ */
+bool load_pcap(const std::string& path, Capture& capture);
+
+/**
+ * @brief Load a sensor trace (CSV: ts_ms,ir_raw,ultra_mm,status)
+ *
+ * Frames get a valid CRC16 so they pass ArduinoI2C::validate_crc16().
+ *
+ * @param path Trace file path
+ * @return Sensor frames in file order
+ */
+std::vector<sensors::SensorFrame> load_sensor_trace(const std::string& path);
+
+} // namespace bench
+} // namespace environet
@@ -0,0 +1,109 @@
+#include <benchmark/benchmark.h>
+#include <memory>
+#include <mutex>
+#include <spdlog/async.h>
+#include <spdlog/sinks/base_sink.h>
+#include <spdlog/details/null_mutex.h>
+
+#include "core/log.hpp"
+
+namespace {
+
+// Runs the full pattern formatter and discards the result, so benchmarks
+// measure formatting cost without terminal or disk I/O
+template<typename Mutex>
+class FormatOnlySink : public spdlog::sinks::base_sink<Mutex> {
+protected:
+    void sink_it_(const spdlog::details::log_msg& msg) override {
+        spdlog::memory_buf_t formatted;
+        this->formatter_->format(msg, formatted);
+        benchmark::DoNotOptimize(formatted.data());
+    }
+    void flush_() override {}
+};
+
+std::shared_ptr<spdlog::logger> bench_logger() {
+    static auto logger = [] {
+        auto l = std::make_shared<spdlog::logger>("bench", std::make_shared<FormatOnlySink<std::mutex>>());
+        l->set_level(spdlog::level::info);
+        return l;
+    }();
+    return logger;
+}
+
+// Same sink behind a background thread; the caller only enqueues
+std::shared_ptr<spdlog::logger> bench_async_logger() {
+    static auto pool = std::make_shared<spdlog::details::thread_pool>(8192, 1);
+    static auto logger = [] {
+        auto l = std::make_shared<spdlog::async_logger>("bench_async", std::make_shared<FormatOnlySink<std::mutex>>(),
+                                                        pool, spdlog::async_overflow_policy::overrun_oldest);
+        l->set_level(spdlog::level::info);
+        return l;
+    }();
+    return logger;
+}
+
+} // namespace
+
+static void BM_LogFormatInfo(benchmark::State& state) {
+    auto logger = bench_logger();
+    int i = 0;
+    for (auto _ : state) {
+        logger->info("Captured packet {} len={} proto={} rssi={:.1f}", i++, 1514, "udp", -52.5);
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_LogFormatInfo);
+
+static void BM_LogFormatInfoContended(benchmark::State& state) {
+    auto logger = bench_logger();
+    int i = 0;
+    for (auto _ : state) {
+        logger->info("Captured packet {} len={} proto={} rssi={:.1f}", i++, 1514, "udp", -52.5);
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_LogFormatInfoContended)->Threads(4)->UseRealTime();
+
+static void BM_LogAsyncInfo(benchmark::State& state) {
+    auto logger = bench_async_logger();
+    int i = 0;
+    for (auto _ : state) {
+        logger->info("Captured packet {} len={} proto={} rssi={:.1f}", i++, 1514, "udp", -52.5);
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_LogAsyncInfo);
+
+static void BM_LogFilteredLevel(benchmark::State& state) {
+    auto logger = bench_logger();
+    int i = 0;
+    for (auto _ : state) {
+        logger->debug("Captured packet {} len={}", i++, 1514);
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_LogFilteredLevel);
+
+// LOGI below the configured level: cost of the macro's logger lookup and level check
+// (a single atomic load since the macros use the cached raw logger pointer)
+static void BM_LogMacroFiltered(benchmark::State& state) {
+    environet::core::init_logger("warn");
+    int i = 0;
+    for (auto _ : state) {
+        LOGI("Captured packet {} len={}", i++, 1514);
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_LogMacroFiltered);
+
+// Hot-path call site suppressed by its rate limiter
+static void BM_LogRateLimited(benchmark::State& state) {
+    environet::core::init_logger("info");
+    int i = 0;
+    for (auto _ : state) {
+        LOGI_RATELIMITED(3600000, "Captured packet {} len={}", i++, 1514);
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_LogRateLimited);
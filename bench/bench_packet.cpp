@@ -0,0 +1,227 @@
+#include <benchmark/benchmark.h>
+#include <algorithm>
+
+#include "bench_data.hpp"
+#include "net/pcap_sniffer.hpp"
+
+using namespace environet;
+
+static const bench::Capture& en10mb_capture() {
+    static const bench::Capture capture = [] {
+        bench::Capture c;
+        bench::load_pcap(bench::data_path("synthetic_en10mb.pcap"), c);
+        return c;
+    }();
+    return capture;
+}
+
+// Full Ethernet/IP/L4 parse of the bundled capture, one packet per iteration
+static void BM_ParsePacket_EN10MB(benchmark::State& state) {
+    const auto& capture = en10mb_capture();
+    if (capture.packets.empty()) {
+        state.SkipWithError("synthetic_en10mb.pcap not found");
+        return;
+    }
+    size_t i = 0;
+    uint64_t bytes = 0;
+    for (auto _ : state) {
+        const auto& pkt = capture.packets[i];
+        net::PacketMeta meta;
+        meta.length = pkt.len;
+        benchmark::DoNotOptimize(net::PcapSniffer::parse_packet(pkt.data.data(), pkt.caplen, meta));
+        benchmark::DoNotOptimize(meta);
+        bytes += pkt.caplen;
+        if (++i == capture.packets.size()) i = 0;
+    }
+    state.SetItemsProcessed(state.iterations());
+    state.SetBytesProcessed(static_cast<int64_t>(bytes));
+}
+BENCHMARK(BM_ParsePacket_EN10MB);
+
+// Truncated frames exercise the caplen bounds checks
+static void BM_ParsePacket_Truncated(benchmark::State& state) {
+    const auto& capture = en10mb_capture();
+    if (capture.packets.empty()) {
+        state.SkipWithError("synthetic_en10mb.pcap not found");
+        return;
+    }
+    const uint32_t caplen = static_cast<uint32_t>(state.range(0));
+    size_t i = 0;
+    for (auto _ : state) {
+        const auto& pkt = capture.packets[i];
+        net::PacketMeta meta;
+        benchmark::DoNotOptimize(net::PcapSniffer::parse_packet(pkt.data.data(), std::min(caplen, pkt.caplen), meta));
+        if (++i == capture.packets.size()) i = 0;
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_ParsePacket_Truncated)->Arg(14)->Arg(34);
+
+// The bundled Ethernet capture re-framed for another datalink
+template <net::LinkType L>
+static const bench::Capture& reframed_capture() {
+    static const bench::Capture capture = [] {
+        bench::Capture c;
+        for (const auto& eth : en10mb_capture().packets) {
+            if (eth.caplen < 14) continue;
+            const uint8_t* mac = eth.data.data();
+            uint8_t type_hi = eth.data[12], type_lo = eth.data[13];
+            std::vector<uint8_t> hdr;
+            if (L == net::LinkType::LINUX_SLL) {
+                hdr = {0, 0, 0, 1, 0, 6};
+                hdr.insert(hdr.end(), mac + 6, mac + 12);
+                hdr.insert(hdr.end(), {0, 0, type_hi, type_lo});
+            } else if (L == net::LinkType::LINUX_SLL2) {
+                hdr = {type_hi, type_lo, 0, 0, 0, 0, 0, 2, 0, 1, 0, 6};
+                hdr.insert(hdr.end(), mac + 6, mac + 12);
+                hdr.insert(hdr.end(), {0, 0});
+            } else if (L == net::LinkType::IEEE802_11_RADIO) {
+                // Radiotap with flags, rate, channel and signal, then a to-DS QoS data frame
+                hdr = {0, 0, 16, 0, 0x2e, 0, 0, 0, 0x10, 0x02, 0x6c, 0x09, 0xa0, 0x00, 0xc4, 0x00,
+                       0x88, 0x01, 0, 0};
+                hdr.insert(hdr.end(), mac, mac + 6);        // BSSID
+                hdr.insert(hdr.end(), mac + 6, mac + 12);   // Source
+                hdr.insert(hdr.end(), mac, mac + 6);        // Destination
+                hdr.insert(hdr.end(), {0, 0, 0, 0, 0xaa, 0xaa, 0x03, 0, 0, 0, type_hi, type_lo});
+            }
+            bench::CapturedPacket pkt;
+            pkt.data = hdr;
+            pkt.data.insert(pkt.data.end(), eth.data.begin() + 14, eth.data.end());
+            pkt.caplen = static_cast<uint32_t>(pkt.data.size());
+            pkt.len = pkt.caplen;
+            c.packets.push_back(std::move(pkt));
+        }
+        return c;
+    }();
+    return capture;
+}
+
+// Specialized dissector for one datalink, called through the pointer the sniffer holds
+template <net::LinkType L>
+static void BM_Dissect(benchmark::State& state) {
+    const auto& capture = L == net::LinkType::EN10MB ? en10mb_capture() : reframed_capture<L>();
+    if (capture.packets.empty()) {
+        state.SkipWithError("synthetic_en10mb.pcap not found");
+        return;
+    }
+    net::Dissector dissector = &net::dissect<L>;
+    benchmark::DoNotOptimize(dissector);
+    size_t i = 0;
+    uint64_t bytes = 0;
+    for (auto _ : state) {
+        const auto& pkt = capture.packets[i];
+        net::PacketMeta meta;
+        net::PacketLayers layers;
+        meta.length = pkt.len;
+        benchmark::DoNotOptimize(dissector(pkt.data.data(), pkt.caplen, meta, layers));
+        benchmark::DoNotOptimize(meta);
+        bytes += pkt.caplen;
+        if (++i == capture.packets.size()) i = 0;
+    }
+    state.SetItemsProcessed(state.iterations());
+    state.SetBytesProcessed(static_cast<int64_t>(bytes));
+}
+BENCHMARK_TEMPLATE(BM_Dissect, net::LinkType::EN10MB);
+BENCHMARK_TEMPLATE(BM_Dissect, net::LinkType::IEEE802_11_RADIO);
+BENCHMARK_TEMPLATE(BM_Dissect, net::LinkType::LINUX_SLL);
+BENCHMARK_TEMPLATE(BM_Dissect, net::LinkType::LINUX_SLL2);
+BENCHMARK_TEMPLATE(BM_Dissect, net::LinkType::RAW);
+
+// Classification after dissection; cost should not grow with the rule count
+static void BM_Classify(benchmark::State& state) {
+    const auto& capture = en10mb_capture();
+    if (capture.packets.empty()) {
+        state.SkipWithError("synthetic_en10mb.pcap not found");
+        return;
+    }
+    std::vector<core::Config::ClassRule> rules;
+    for (int64_t i = 0; i < state.range(0); ++i) {
+        core::Config::ClassRule rule;
+        rule.name = "class" + std::to_string(i % 8);
+        rule.ips = {"10." + std::to_string(i) + ".0.0/16"};
+        rule.ports = {std::to_string(1000 + i * 10) + "-" + std::to_string(1009 + i * 10)};
+        rule.protocols = {6, 17};
+        rules.push_back(rule);
+    }
+    net::Classifier classifier;
+    classifier.load(rules);
+    std::vector<std::pair<net::PacketMeta, net::PacketLayers>> dissected(capture.packets.size());
+    for (size_t i = 0; i < capture.packets.size(); ++i) {
+        const auto& pkt = capture.packets[i];
+        dissected[i].first.length = pkt.len;
+        net::dissect<net::LinkType::EN10MB>(pkt.data.data(), pkt.caplen, dissected[i].first, dissected[i].second);
+    }
+    size_t i = 0;
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(classifier.classify(dissected[i].first, dissected[i].second));
+        if (++i == dissected.size()) i = 0;
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_Classify)->Arg(1)->Arg(16)->Arg(64);
+
+// Per-host accounting of a dissected packet: 4 Count-Min updates and 4 top-K updates
+static void BM_Account(benchmark::State& state) {
+    const auto& capture = en10mb_capture();
+    if (capture.packets.empty()) {
+        state.SkipWithError("synthetic_en10mb.pcap not found");
+        return;
+    }
+    auto config = std::make_shared<core::Config>(core::Config::get_defaults());
+    config->accounting.top_k = static_cast<int>(state.range(0));
+    net::TrafficAccounting accounting(config);
+    accounting.init();
+    std::vector<std::pair<net::PacketMeta, net::PacketLayers>> dissected(capture.packets.size());
+    for (size_t i = 0; i < capture.packets.size(); ++i) {
+        const auto& pkt = capture.packets[i];
+        dissected[i].first.length = pkt.len;
+        net::dissect<net::LinkType::EN10MB>(pkt.data.data(), pkt.caplen, dissected[i].first, dissected[i].second);
+    }
+    size_t i = 0;
+    for (auto _ : state) {
+        accounting.record(dissected[i].first, dissected[i].second);
+        if (++i == dissected.size()) i = 0;
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_Account)->Arg(16)->Arg(64);
+
+// DNS query/response matching over a busy resolver's traffic (~10k DNS packets/s of capture time)
+static void BM_DnsAnalyzer(benchmark::State& state) {
+    static const bench::Capture capture = [] {
+        bench::Capture c;
+        bench::load_pcap(bench::data_path("synthetic_dns.pcap"), c);
+        return c;
+    }();
+    if (capture.packets.empty()) {
+        state.SkipWithError("synthetic_dns.pcap not found");
+        return;
+    }
+    auto config = std::make_shared<core::Config>(core::Config::get_defaults());
+    config->dns.max_pending = static_cast<size_t>(state.range(0));
+    net::DnsAnalyzer dns(config);
+    dns.init();
+    std::vector<std::pair<net::PacketMeta, net::PacketLayers>> dissected(capture.packets.size());
+    for (size_t i = 0; i < capture.packets.size(); ++i) {
+        const auto& pkt = capture.packets[i];
+        dissected[i].first.length = pkt.len;
+        net::dissect<net::LinkType::EN10MB>(pkt.data.data(), pkt.caplen, dissected[i].first, dissected[i].second);
+    }
+    // Each replay is shifted past the previous one so capture time keeps moving forward
+    const uint64_t span_us = capture.packets.back().ts_us - capture.packets.front().ts_us + 1000000;
+    uint64_t offset_us = 0;
+    std::vector<net::DnsSample> samples;
+    size_t i = 0;
+    for (auto _ : state) {
+        uint64_t ts_us = capture.packets[i].ts_us + offset_us;
+        dns.process_at(ts_us / 1000, ts_us, dissected[i].first, dissected[i].second);
+        if (++i == dissected.size()) {
+            i = 0;
+            offset_us += span_us;
+            samples.clear();
+            dns.drain(ts_us / 1000, samples);
+        }
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_DnsAnalyzer)->Arg(64)->Arg(4096);
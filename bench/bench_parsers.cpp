@@ -0,0 +1,49 @@
+#include <benchmark/benchmark.h>
+
+#include "bench_data.hpp"
+#include "net/metrics.hpp"
+
+using namespace environet;
+
+static void BM_ParsePingOutput(benchmark::State& state) {
+    const std::string output = bench::read_file(bench::data_path("ping_output.txt"));
+    if (output.empty()) {
+        state.SkipWithError("ping_output.txt not found");
+        return;
+    }
+    net::Metrics metrics("");
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(metrics.parse_ping_output(output, "8.8.8.8"));
+    }
+    state.SetItemsProcessed(state.iterations());
+    state.SetBytesProcessed(state.iterations() * static_cast<int64_t>(output.size()));
+}
+BENCHMARK(BM_ParsePingOutput);
+
+static void BM_ParseIperf3Json(benchmark::State& state) {
+    const std::string output = bench::read_file(bench::data_path("iperf3_output.json"));
+    if (output.empty()) {
+        state.SkipWithError("iperf3_output.json not found");
+        return;
+    }
+    net::Metrics metrics("");
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(metrics.parse_iperf3_output(output, "192.168.1.1"));
+    }
+    state.SetItemsProcessed(state.iterations());
+    state.SetBytesProcessed(state.iterations() * static_cast<int64_t>(output.size()));
+}
+BENCHMARK(BM_ParseIperf3Json);
+
+static void BM_ParseIperf3Text(benchmark::State& state) {
+    const std::string output =
+        "[ ID] Interval           Transfer     Bitrate         Retr\n"
+        "[  5]   0.00-10.00  sec   108 MBytes  90.6 Mbits/sec    4             sender\n"
+        "[  5]   0.00-10.01  sec   107 MBytes  89.9 Mbits/sec                  receiver\n";
+    net::Metrics metrics("");
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(metrics.parse_iperf3_output(output, "192.168.1.1"));
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_ParseIperf3Text);
@@ -0,0 +1,53 @@
+#include <benchmark/benchmark.h>
+
+#include "bench_data.hpp"
+#include "sensors/arduino_i2c.hpp"
+
+using namespace environet;
+
+static const std::vector<sensors::SensorFrame>& sensor_trace() {
+    static const auto frames = bench::load_sensor_trace(bench::data_path("sensor_trace.csv"));
+    return frames;
+}
+
+static void BM_Crc16_Frame(benchmark::State& state) {
+    const auto& frames = sensor_trace();
+    if (frames.empty()) {
+        state.SkipWithError("sensor_trace.csv not found");
+        return;
+    }
+    size_t i = 0;
+    for (auto _ : state) {
+        const auto* bytes = reinterpret_cast<const uint8_t*>(&frames[i]);
+        benchmark::DoNotOptimize(sensors::ArduinoI2C::compute_crc16(bytes, sizeof(sensors::SensorFrame) - sizeof(uint16_t)));
+        if (++i == frames.size()) i = 0;
+    }
+    state.SetItemsProcessed(state.iterations());
+    state.SetBytesProcessed(state.iterations() * static_cast<int64_t>(sizeof(sensors::SensorFrame) - sizeof(uint16_t)));
+}
+BENCHMARK(BM_Crc16_Frame);
+
+static void BM_Crc16_Buffer(benchmark::State& state) {
+    std::vector<uint8_t> buf(static_cast<size_t>(state.range(0)));
+    for (size_t i = 0; i < buf.size(); ++i) buf[i] = static_cast<uint8_t>(i * 31 + 7);
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(sensors::ArduinoI2C::compute_crc16(buf.data(), buf.size()));
+    }
+    state.SetBytesProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_Crc16_Buffer)->Arg(64)->Arg(1024);
+
+static void BM_ValidateCrc16(benchmark::State& state) {
+    const auto& frames = sensor_trace();
+    if (frames.empty()) {
+        state.SkipWithError("sensor_trace.csv not found");
+        return;
+    }
+    size_t i = 0;
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(sensors::ArduinoI2C::validate_crc16(frames[i]));
+        if (++i == frames.size()) i = 0;
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_ValidateCrc16);
@@ -0,0 +1,78 @@
+#include <benchmark/benchmark.h>
+#include <cstdio>
+#include <string>
+#include <unistd.h>
+
+#include "core/timeline.hpp"
+#include "core/trace_log.hpp"
+
+namespace {
+
+// One trace log per process, writing to a scratch file that is removed on exit
+environet::core::TraceLog& bench_trace() {
+    static std::string path = "/tmp/environet_bench_" + std::to_string(getpid()) + ".trace";
+    static environet::core::TraceLog trace;
+    static bool started = [] {
+        bool ok = trace.start(path, 256ULL * 1024 * 1024, 1, 1 << 18, 5);
+        std::atexit([] {
+            trace.stop();
+            std::remove(path.c_str());
+        });
+        return ok;
+    }();
+    (void)started;
+    return trace;
+}
+
+} // namespace
+
+// Cost of one sensor record: slot reservation, payload fill and publish
+static void BM_TraceSensorRecord(benchmark::State& state) {
+    auto& trace = bench_trace();
+    uint64_t dropped_before = trace.get_stats()["records_dropped"].get<uint64_t>();
+    uint32_t i = 0;
+    for (auto _ : state) {
+        if (environet::core::TraceRecord* rec = trace.begin(environet::core::TraceEventType::Sensor)) {
+            rec->sensor.ts_ms = i++;
+            rec->sensor.ir_raw = 123;
+            rec->sensor.ultra_mm = 1500;
+            trace.commit();
+        }
+    }
+    state.SetItemsProcessed(state.iterations());
+    state.counters["dropped"] = static_cast<double>(trace.get_stats()["records_dropped"].get<uint64_t>() - dropped_before);
+}
+BENCHMARK(BM_TraceSensorRecord);
+
+// Packet records from several threads, each with its own ring
+static void BM_TracePacketRecordThreads(benchmark::State& state) {
+    auto& trace = bench_trace();
+    uint32_t i = 0;
+    for (auto _ : state) {
+        if (environet::core::TraceRecord* rec = trace.begin(environet::core::TraceEventType::Packet)) {
+            rec->packet.length = i++;
+            rec->packet.ethertype = 0x0800;
+            rec->packet.protocol = 17;
+            rec->packet.ip_version = 4;
+            trace.commit();
+        }
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_TracePacketRecordThreads)->Threads(1)->Threads(4)->UseRealTime();
+
+// Timeline slice around an empty scope, recording and disabled
+static void BM_TimelineScope(benchmark::State& state) {
+    auto& timeline = environet::core::Timeline::instance();
+    if (state.range(0)) {
+        timeline.enable();
+    } else {
+        timeline.disable();
+    }
+    for (auto _ : state) {
+        TIMELINE_SCOPE("bench.scope");
+    }
+    timeline.disable();
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_TimelineScope)->Arg(0)->Arg(1);
@@ -0,0 +1,196 @@
+#!/usr/bin/env python3
+"""
+Generate the synthetic inputs used by environet_bench.
+
+Outputs (written next to this script, deterministic for a given seed):
+  synthetic_en10mb.pcap   Ethernet capture: IPv4 TCP/UDP, IPv6 UDP, ARP
+  synthetic_dns.pcap      Ethernet capture of a busy resolver: DNS over UDP
+  sensor_trace.csv        Arduino sensor frames with periodic motion events
+  ping_output.txt         Linux iputils ping output
+  iperf3_output.json      iperf3 -J output for a TCP test
+"""
+
+import argparse
+import json
+import os
+import random
+import struct
+
+SNAPLEN = 128
+
+
+def mac(rng):
+    return bytes([0x02] + [rng.randrange(256) for _ in range(5)])
+
+
+def ipv4_header(rng, proto, payload_len):
+    total = 20 + payload_len
+    src = bytes([192, 168, 1, rng.randrange(2, 250)])
+    dst = bytes([10, 0, rng.randrange(256), rng.randrange(1, 255)])
+    return struct.pack("!BBHHHBBH4s4s", 0x45, 0, total, rng.randrange(65536), 0x4000,
+                       64, proto, 0, src, dst)
+
+
+def ipv6_header(rng, next_header, payload_len):
+    src = bytes([0xfe, 0x80] + [0] * 6 + [rng.randrange(256) for _ in range(8)])
+    dst = bytes([0x20, 0x01, 0x0d, 0xb8] + [rng.randrange(256) for _ in range(12)])
+    return struct.pack("!IHBB16s16s", 6 << 28, payload_len, next_header, 64, src, dst)
+
+
+def tcp_header(rng):
+    return struct.pack("!HHIIBBHHH", rng.randrange(1024, 65535), rng.choice([80, 443, 22, 8080]),
+                       rng.randrange(1 << 32), rng.randrange(1 << 32), 5 << 4, 0x18,
+                       65535, 0, 0)
+
+
+def udp_header(rng, payload_len):
+    return struct.pack("!HHHH", rng.randrange(1024, 65535), rng.choice([53, 123, 5353, 5201]),
+                       8 + payload_len, 0)
+
+
+def make_packet(rng):
+    kind = rng.random()
+    dst, src = mac(rng), mac(rng)
+    if kind < 0.5:
+        payload = rng.randrange(0, 1400)
+        l4 = tcp_header(rng)
+        frame = struct.pack("!6s6sH", dst, src, 0x0800) + ipv4_header(rng, 6, len(l4) + payload) + l4
+    elif kind < 0.8:
+        payload = rng.randrange(0, 512)
+        l4 = udp_header(rng, payload)
+        frame = struct.pack("!6s6sH", dst, src, 0x0800) + ipv4_header(rng, 17, len(l4) + payload) + l4
+    elif kind < 0.9:
+        payload = rng.randrange(0, 512)
+        l4 = udp_header(rng, payload)
+        frame = struct.pack("!6s6sH", dst, src, 0x86DD) + ipv6_header(rng, 17, len(l4) + payload) + l4
+    else:
+        payload = 0
+        arp = struct.pack("!HHBBH6s4s6s4s", 1, 0x0800, 6, 4, 1, src, bytes([192, 168, 1, 10]),
+                          bytes(6), bytes([192, 168, 1, 1]))
+        frame = struct.pack("!6s6sH", b"\xff" * 6, src, 0x0806) + arp
+    frame += bytes(rng.randrange(256) for _ in range(min(payload, SNAPLEN)))
+    wire_len = len(frame) - min(payload, SNAPLEN) + payload
+    return frame[:SNAPLEN], max(wire_len, 60)
+
+
+def write_pcap(path, rng, count):
+    with open(path, "wb") as f:
+        # Classic pcap, microsecond timestamps, LINKTYPE_ETHERNET
+        f.write(struct.pack("<IHHiIII", 0xa1b2c3d4, 2, 4, 0, 0, SNAPLEN, 1))
+        ts_us = 1_700_000_000 * 1_000_000
+        for _ in range(count):
+            data, wire_len = make_packet(rng)
+            ts_us += rng.randrange(50, 2000)
+            f.write(struct.pack("<IIII", ts_us // 1_000_000, ts_us % 1_000_000, len(data), wire_len))
+            f.write(data)
+
+
+def dns_frame(client, client_port, txid, response, rcode=0):
+    resolver = bytes([192, 168, 1, 1])
+    flags = (0x8180 | rcode) if response else 0x0100
+    msg = struct.pack("!HHHHHH", txid, flags, 1, 1 if response else 0, 0, 0)
+    msg += b"\x07example\x03com\x00" + struct.pack("!HH", 1, 1)
+    if response:
+        msg += struct.pack("!HHHIH4s", 0xc00c, 1, 1, 300, 4, bytes([93, 184, 216, 34]))
+    src, dst = (resolver, client) if response else (client, resolver)
+    sport, dport = (53, client_port) if response else (client_port, 53)
+    udp = struct.pack("!HHHH", sport, dport, 8 + len(msg), 0)
+    ip = struct.pack("!BBHHHBBH4s4s", 0x45, 0, 28 + len(msg), txid, 0x4000, 64, 17, 0, src, dst)
+    frame = struct.pack("!6s6sH", b"\x02\x00\x00\x00\x00\x01", b"\x02\x00\x00\x00\x00\x02", 0x0800)
+    frame += ip + udp + msg
+    return frame[:SNAPLEN], max(len(frame), 60)
+
+
+def write_dns_pcap(path, rng, count):
+    """Queries from 200 clients; most answered within 1-80 ms, some failed or never answered."""
+    packets = []
+    ts_us = 1_700_000_000 * 1_000_000
+    for _ in range(count):
+        ts_us += rng.randrange(20, 400)
+        client = bytes([10, 0, rng.randrange(4), rng.randrange(1, 51)])
+        port, txid = rng.randrange(1024, 65535), rng.randrange(65536)
+        packets.append((ts_us, dns_frame(client, port, txid, False)))
+        outcome = rng.random()
+        if outcome < 0.03:
+            continue
+        rcode = 3 if outcome < 0.10 else 2 if outcome < 0.12 else 0
+        packets.append((ts_us + rng.randrange(1000, 80000), dns_frame(client, port, txid, True, rcode)))
+    packets.sort(key=lambda p: p[0])
+    with open(path, "wb") as f:
+        f.write(struct.pack("<IHHiIII", 0xa1b2c3d4, 2, 4, 0, 0, SNAPLEN, 1))
+        for ts, (data, wire_len) in packets:
+            f.write(struct.pack("<IIII", ts // 1_000_000, ts % 1_000_000, len(data), wire_len))
+            f.write(data)
+
+
+def write_sensor_trace(path, rng, count):
+    with open(path, "w") as f:
+        f.write("ts_ms,ir_raw,ultra_mm,status\n")
+        ts = 0
+        for i in range(count):
+            ts += 100
+            motion = (i // 50) % 4 == 3
+            ir = rng.randrange(150, 260) + (rng.randrange(300, 500) if motion else 0)
+            ultra = rng.randrange(400, 900) if motion else rng.randrange(1800, 2200)
+            f.write(f"{ts},{ir},{ultra},{1 if motion else 0}\n")
+
+
+PING_OUTPUT = """PING 8.8.8.8 (8.8.8.8) 56(84) bytes of data.
+64 bytes from 8.8.8.8: icmp_seq=1 ttl=117 time=14.2 ms
+64 bytes from 8.8.8.8: icmp_seq=2 ttl=117 time=13.8 ms
+64 bytes from 8.8.8.8: icmp_seq=3 ttl=117 time=15.1 ms
+64 bytes from 8.8.8.8: icmp_seq=5 ttl=117 time=14.0 ms
+
+--- 8.8.8.8 ping statistics ---
+5 packets transmitted, 4 received, 20% packet loss, time 4006ms
+rtt min/avg/max/mdev = 13.812/14.275/15.104/0.491 ms
+"""
+
+
+def iperf3_output(rng):
+    intervals = []
+    for i in range(10):
+        bps = rng.uniform(80e6, 95e6)
+        stream = {"socket": 5, "start": float(i), "end": float(i + 1), "seconds": 1.0,
+                  "bytes": int(bps / 8), "bits_per_second": bps, "retransmits": rng.randrange(3),
+                  "snd_cwnd": 314000, "omitted": False, "sender": True}
+        intervals.append({"streams": [stream], "sum": dict(stream)})
+    total_bytes = sum(iv["sum"]["bytes"] for iv in intervals)
+    summary = {"start": 0, "end": 10.0, "seconds": 10.0, "bytes": total_bytes,
+               "bits_per_second": total_bytes * 8 / 10.0, "sender": True}
+    return {
+        "start": {"connected": [{"socket": 5, "local_host": "192.168.1.20", "local_port": 40222,
+                                 "remote_host": "192.168.1.1", "remote_port": 5201}],
+                  "version": "iperf 3.9", "timestamp": {"time": "Tue, 14 Nov 2023 22:13:20 GMT",
+                                                          "timesecs": 1700000000},
+                  "test_start": {"protocol": "TCP", "num_streams": 1, "duration": 10}},
+        "intervals": intervals,
+        "end": {"streams": [{"sender": summary, "receiver": dict(summary, sender=False)}],
+                "sum_sent": summary, "sum_received": dict(summary, sender=False),
+                "cpu_utilization_percent": {"host_total": 3.1, "remote_total": 1.4}},
+    }
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("--seed", type=int, default=42)
+    parser.add_argument("--packets", type=int, default=1000)
+    parser.add_argument("--frames", type=int, default=2000)
+    parser.add_argument("--dns-queries", type=int, default=2000)
+    parser.add_argument("--out", default=os.path.dirname(os.path.abspath(__file__)))
+    args = parser.parse_args()
+
+    rng = random.Random(args.seed)
+    write_pcap(os.path.join(args.out, "synthetic_en10mb.pcap"), rng, args.packets)
+    write_sensor_trace(os.path.join(args.out, "sensor_trace.csv"), rng, args.frames)
+    with open(os.path.join(args.out, "ping_output.txt"), "w") as f:
+        f.write(PING_OUTPUT)
+    with open(os.path.join(args.out, "iperf3_output.json"), "w") as f:
+        json.dump(iperf3_output(rng), f, indent=2)
+        f.write("\n")
+    # Own random stream, so the other outputs do not depend on it
+    write_dns_pcap(os.path.join(args.out, "synthetic_dns.pcap"), random.Random(args.seed + 1), args.dns_queries)
+
+
+if __name__ == "__main__":
+    main()
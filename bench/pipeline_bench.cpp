@@ -0,0 +1,504 @@
+/**
+ * @file pipeline_bench.cpp
+ * @brief End-to-end pipeline throughput harness
+ *
+ * Runs the main.cpp data path in-process (PcapSniffer packet processing,
+ * sensor frame validation, WiFi BSS and ping result handling, all feeding
+ * one Correlator that is processed on a fixed tick) with synthetic sources
+ * instead of hardware. Each source offers items at a configured rate into a
+ * bounded queue standing in for the kernel/driver buffer in front of that
+ * stage; a full queue counts as a drop.
+ *
+ * The packet rate is ramped step by step until the loss or p99 latency SLO
+ * is violated. The last passing step is reported as the saturation
+ * throughput, along with per-stage queue depths, CPU and RSS per step.
+ */
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+#include <sys/resource.h>
+#include <unistd.h>
+#include <nlohmann/json.hpp>
+
+#include "bench_data.hpp"
+#include "core/latency.hpp"
+#include "core/log.hpp"
+#include "correlate/correlator.hpp"
+#include "net/metrics.hpp"
+#include "net/pcap_sniffer.hpp"
+#include "net/wifi_scan.hpp"
+#include "sensors/arduino_i2c.hpp"
+
+using namespace environet;
+
+namespace {
+
+/**
+ * @brief Bounded single-producer/single-consumer ring
+ */
+template<typename T>
+class SpscRing {
+public:
+    explicit SpscRing(size_t capacity) {
+        size_t cap = 1;
+        while (cap < capacity) cap <<= 1;
+        slots_.resize(cap);
+        mask_ = cap - 1;
+    }
+
+    bool try_push(const T& v) {
+        size_t head = head_.load(std::memory_order_relaxed);
+        if (head - tail_.load(std::memory_order_acquire) > mask_) return false;
+        slots_[head & mask_] = v;
+        head_.store(head + 1, std::memory_order_release);
+        return true;
+    }
+
+    bool try_pop(T& v) {
+        size_t tail = tail_.load(std::memory_order_relaxed);
+        if (tail == head_.load(std::memory_order_acquire)) return false;
+        v = slots_[tail & mask_];
+        tail_.store(tail + 1, std::memory_order_release);
+        return true;
+    }
+
+    size_t size() const {
+        return head_.load(std::memory_order_acquire) - tail_.load(std::memory_order_acquire);
+    }
+
+private:
+    std::vector<T> slots_;
+    size_t mask_ = 0;
+    alignas(64) std::atomic<size_t> head_{0};
+    alignas(64) std::atomic<size_t> tail_{0};
+};
+
+// Work item: index into the stage's synthetic data set plus enqueue time
+struct Item {
+    uint32_t index;
+    uint64_t enqueue_ticks;
+};
+
+/**
+ * @brief One pipeline stage: bounded input queue, counters and latency
+ */
+struct Stage {
+    Stage(const char* n, size_t capacity) : name(n), queue(capacity), latency(core::latency_seconds_per_tick()) {}
+
+    const char* name;
+    SpscRing<Item> queue;
+    std::atomic<uint64_t> offered{0};
+    std::atomic<uint64_t> dropped{0};
+    std::atomic<uint64_t> processed{0};
+    size_t max_depth = 0;
+    uint64_t depth_sum = 0;
+    uint64_t depth_samples = 0;
+    core::Histogram latency;  // enqueue -> correlator push, in latency ticks
+};
+
+struct Options {
+    double start_rate = 5000;        // packets/s for the first step
+    double max_rate = 2000000;       // stop ramping here
+    double ramp_factor = 1.5;
+    double step_seconds = 3.0;
+    bool fixed = false;              // single step at start_rate
+    double loss_slo_pct = 0.1;
+    double p99_slo_ms = 10.0;
+    double sensor_rate = 10;         // frames/s
+    double bss_scan_rate = 0.2;      // scans/s
+    int bss_per_scan = 20;
+    double ping_rate = 0.5;          // ping results/s
+    size_t packet_queue = 4096;
+    size_t aux_queue = 256;
+    int correlate_interval_ms = 1000;
+    std::string json_path;
+};
+
+struct Usage {
+    double cpu_seconds;
+    double rss_mb;
+    double max_rss_mb;
+};
+
+Usage sample_usage() {
+    rusage ru{};
+    getrusage(RUSAGE_SELF, &ru);
+    Usage u;
+    u.cpu_seconds = ru.ru_utime.tv_sec + ru.ru_utime.tv_usec * 1e-6 + ru.ru_stime.tv_sec + ru.ru_stime.tv_usec * 1e-6;
+    u.max_rss_mb = ru.ru_maxrss / 1024.0;
+    u.rss_mb = 0.0;
+    std::ifstream statm("/proc/self/statm");
+    unsigned long size = 0, resident = 0;
+    if (statm >> size >> resident) {
+        u.rss_mb = static_cast<double>(resident) * static_cast<double>(sysconf(_SC_PAGESIZE)) / (1024.0 * 1024.0);
+    }
+    return u;
+}
+
+double ticks_to_us(uint64_t ticks) {
+    return static_cast<double>(ticks) * core::latency_seconds_per_tick() * 1e6;
+}
+
+/**
+ * @brief Synthetic inputs shared by all steps
+ */
+struct Dataset {
+    bench::Capture capture;
+    std::vector<sensors::SensorFrame> frames;
+    std::vector<net::BssInfo> bss;
+    std::string ping_output;
+};
+
+bool load_dataset(Dataset& d, std::string& error) {
+    if (!bench::load_pcap(bench::data_path("synthetic_en10mb.pcap"), d.capture)) {
+        error = "cannot load " + bench::data_path("synthetic_en10mb.pcap");
+        return false;
+    }
+    d.frames = bench::load_sensor_trace(bench::data_path("sensor_trace.csv"));
+    if (d.frames.empty()) {
+        error = "cannot load " + bench::data_path("sensor_trace.csv");
+        return false;
+    }
+    d.ping_output = bench::read_file(bench::data_path("ping_output.txt"));
+    if (d.ping_output.empty()) {
+        error = "cannot load " + bench::data_path("ping_output.txt");
+        return false;
+    }
+    for (int i = 0; i < 64; ++i) {
+        char bssid[18];
+        std::snprintf(bssid, sizeof(bssid), "02:00:00:00:%02x:%02x", i / 256, i % 256);
+        net::BssInfo b("bench-" + std::to_string(i), bssid, i % 2 ? 5180 : 2437, -4000 - (i * 97) % 5000);
+        b.channel = i % 2 ? 36 : 6;
+        d.bss.push_back(b);
+    }
+    return true;
+}
+
+// Offer items at a fixed rate; a full queue counts as a drop
+void run_source(Stage& stage, double rate, size_t dataset_size, size_t burst, const std::atomic<bool>& stop) {
+    if (rate <= 0.0 || dataset_size == 0) return;
+    auto start = std::chrono::steady_clock::now();
+    uint64_t sent = 0;
+    uint32_t index = 0;
+    while (!stop.load(std::memory_order_relaxed)) {
+        double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        auto due = static_cast<uint64_t>(elapsed * rate) * burst;
+        while (sent < due) {
+            uint64_t now = core::latency_ticks();
+            for (size_t b = 0; b < burst; ++b) {
+                if (!stage.queue.try_push(Item{index, now})) stage.dropped.fetch_add(1, std::memory_order_relaxed);
+                if (++index == dataset_size) index = 0;
+            }
+            stage.offered.fetch_add(burst, std::memory_order_relaxed);
+            sent += burst;
+        }
+        std::this_thread::sleep_for(std::chrono::microseconds(100));
+    }
+}
+
+// Drain a stage queue, handing each item to fn; exits once stopped and empty
+template<typename Fn>
+void run_consumer(Stage& stage, const std::atomic<bool>& stop, Fn fn) {
+    Item item;
+    int idle = 0;
+    for (;;) {
+        if (stage.queue.try_pop(item)) {
+            fn(item);
+            stage.latency.record(core::latency_ticks() - item.enqueue_ticks);
+            stage.processed.fetch_add(1, std::memory_order_relaxed);
+            idle = 0;
+            continue;
+        }
+        if (stop.load(std::memory_order_acquire)) break;
+        if (++idle < 64) {
+            std::this_thread::yield();
+        } else {
+            std::this_thread::sleep_for(std::chrono::microseconds(50));
+        }
+    }
+}
+
+/**
+ * @brief Run one load step and return its report
+ */
+nlohmann::json run_step(const Dataset& data, const Options& opt, double packet_rate) {
+    auto correlator = std::make_shared<correlate::Correlator>("");
+    correlator->init();
+    net::PcapSniffer sniffer("");
+    net::Metrics metrics("");
+    sniffer.set_packet_callback([&correlator](const net::PacketMeta& meta, const uint8_t*) {
+        correlator->push_packet(meta);
+    });
+
+    Stage packets("packet", opt.packet_queue);
+    Stage sensor("sensor", opt.aux_queue);
+    Stage bss("bss", opt.aux_queue);
+    Stage ping("ping", opt.aux_queue);
+    Stage* stages[] = {&packets, &sensor, &bss, &ping};
+    core::Histogram process_latency(core::latency_seconds_per_tick());
+
+    std::atomic<bool> stop_sources{false};
+    std::atomic<bool> stop_consumers{false};
+    std::atomic<bool> stop_sampler{false};
+
+    Usage usage0 = sample_usage();
+    auto t0 = std::chrono::steady_clock::now();
+
+    std::vector<std::thread> threads;
+    // Consumers: same per-item work as the main.cpp threads, minus the sleeps
+    threads.emplace_back([&]() {
+        run_consumer(packets, stop_consumers, [&](const Item& it) {
+            const auto& pkt = data.capture.packets[it.index];
+            pcap_pkthdr hdr{};
+            hdr.caplen = pkt.caplen;
+            hdr.len = pkt.len;
+            sniffer.inject_packet(&hdr, pkt.data.data());
+        });
+    });
+    threads.emplace_back([&]() {
+        run_consumer(sensor, stop_consumers, [&](const Item& it) {
+            const auto& frame = data.frames[it.index];
+            if (sensors::ArduinoI2C::validate_crc16(frame)) correlator->push_sensor(frame);
+        });
+    });
+    threads.emplace_back([&]() {
+        run_consumer(bss, stop_consumers, [&](const Item& it) { correlator->push_bss(data.bss[it.index]); });
+    });
+    threads.emplace_back([&]() {
+        run_consumer(ping, stop_consumers, [&](const Item&) {
+            correlator->push_ping_stats(metrics.parse_ping_output(data.ping_output, "8.8.8.8"));
+        });
+    });
+
+    // Correlation tick
+    threads.emplace_back([&]() {
+        auto next = std::chrono::steady_clock::now();
+        while (!stop_consumers.load(std::memory_order_acquire)) {
+            next += std::chrono::milliseconds(opt.correlate_interval_ms);
+            while (std::chrono::steady_clock::now() < next && !stop_consumers.load(std::memory_order_acquire)) {
+                std::this_thread::sleep_for(std::chrono::milliseconds(5));
+            }
+            uint64_t start = core::latency_ticks();
+            correlator->process();
+            process_latency.record(core::latency_ticks() - start);
+        }
+    });
+
+    // Queue depth sampler
+    threads.emplace_back([&]() {
+        while (!stop_sampler.load(std::memory_order_acquire)) {
+            for (Stage* s : stages) {
+                size_t depth = s->queue.size();
+                s->max_depth = std::max(s->max_depth, depth);
+                s->depth_sum += depth;
+                ++s->depth_samples;
+            }
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        }
+    });
+
+    // Sources
+    std::vector<std::thread> sources;
+    sources.emplace_back(run_source, std::ref(packets), packet_rate, data.capture.packets.size(), 1, std::cref(stop_sources));
+    sources.emplace_back(run_source, std::ref(sensor), opt.sensor_rate, data.frames.size(), 1, std::cref(stop_sources));
+    sources.emplace_back(run_source, std::ref(bss), opt.bss_scan_rate, data.bss.size(),
+                         static_cast<size_t>(std::max(1, opt.bss_per_scan)), std::cref(stop_sources));
+    sources.emplace_back(run_source, std::ref(ping), opt.ping_rate, size_t{1}, 1, std::cref(stop_sources));
+
+    std::this_thread::sleep_for(std::chrono::duration<double>(opt.step_seconds));
+    stop_sources.store(true, std::memory_order_release);
+    for (auto& t : sources) t.join();
+    auto t_offer_end = std::chrono::steady_clock::now();
+
+    // Let consumers drain what was accepted, then stop everything
+    stop_consumers.store(true, std::memory_order_release);
+    stop_sampler.store(true, std::memory_order_release);
+    for (auto& t : threads) t.join();
+    auto t1 = std::chrono::steady_clock::now();
+    Usage usage1 = sample_usage();
+
+    double offer_seconds = std::chrono::duration<double>(t_offer_end - t0).count();
+    double wall_seconds = std::chrono::duration<double>(t1 - t0).count();
+
+    nlohmann::json step;
+    step["target_packet_rate"] = packet_rate;
+    step["offered_packet_rate"] = packets.offered.load() / offer_seconds;
+    step["processed_packet_rate"] = packets.processed.load() / wall_seconds;
+    nlohmann::json stage_json = nlohmann::json::object();
+    for (Stage* s : stages) {
+        auto snap = s->latency.snapshot();
+        uint64_t offered = s->offered.load();
+        nlohmann::json j;
+        j["offered"] = offered;
+        j["dropped"] = s->dropped.load();
+        j["processed"] = s->processed.load();
+        j["loss_pct"] = offered ? 100.0 * s->dropped.load() / offered : 0.0;
+        j["queue_capacity"] = s == &packets ? opt.packet_queue : opt.aux_queue;
+        j["max_queue_depth"] = s->max_depth;
+        j["avg_queue_depth"] = s->depth_samples ? static_cast<double>(s->depth_sum) / s->depth_samples : 0.0;
+        j["latency_p50_us"] = ticks_to_us(snap.percentile(0.50));
+        j["latency_p99_us"] = ticks_to_us(snap.percentile(0.99));
+        j["latency_max_us"] = ticks_to_us(snap.max);
+        stage_json[s->name] = j;
+    }
+    step["stages"] = stage_json;
+    auto proc = process_latency.snapshot();
+    step["correlator"] = {
+        {"process_runs", proc.count},
+        {"process_p99_us", ticks_to_us(proc.percentile(0.99))},
+        {"process_max_us", ticks_to_us(proc.max)},
+        {"buffer_sizes", correlator->get_stats()["buffer_sizes"]},
+    };
+    step["cpu_pct"] = 100.0 * (usage1.cpu_seconds - usage0.cpu_seconds) / wall_seconds;
+    step["rss_mb"] = usage1.rss_mb;
+    step["max_rss_mb"] = usage1.max_rss_mb;
+
+    double loss = stage_json["packet"]["loss_pct"].get<double>();
+    double p99_ms = stage_json["packet"]["latency_p99_us"].get<double>() / 1000.0;
+    bool source_kept_up = step["offered_packet_rate"].get<double>() >= 0.95 * packet_rate;
+    std::string violation;
+    if (loss > opt.loss_slo_pct) violation = "loss";
+    else if (p99_ms > opt.p99_slo_ms) violation = "latency";
+    else if (!source_kept_up) violation = "source";
+    step["passed"] = violation.empty();
+    step["violation"] = violation;
+    return step;
+}
+
+void print_step(FILE* out, const nlohmann::json& s) {
+    const auto& p = s["stages"]["packet"];
+    std::fprintf(out, "%10.0f %10.0f %10.0f %8.3f %10.1f %10.1f %7zu %7zu %6.1f %8.1f  %s\n",
+                s["target_packet_rate"].get<double>(), s["offered_packet_rate"].get<double>(),
+                s["processed_packet_rate"].get<double>(), p["loss_pct"].get<double>(),
+                p["latency_p50_us"].get<double>(), p["latency_p99_us"].get<double>(),
+                p["max_queue_depth"].get<size_t>(),
+                s["correlator"]["buffer_sizes"]["packet"].get<size_t>(),
+                s["cpu_pct"].get<double>(), s["rss_mb"].get<double>(),
+                s["passed"].get<bool>() ? "ok" : s["violation"].get<std::string>().c_str());
+    std::fflush(out);
+}
+
+void usage(const char* argv0) {
+    std::cout << "EnviroNet Analyzer - pipeline throughput benchmark\n"
+              << "Usage: " << argv0 << " [options]\n"
+              << "Options:\n"
+              << "  --start-rate <pps>      Packet rate of the first step (default 5000)\n"
+              << "  --max-rate <pps>        Stop ramping at this rate (default 2000000)\n"
+              << "  --ramp-factor <x>       Rate multiplier between steps (default 1.5)\n"
+              << "  --step-seconds <s>      Duration of each step (default 3)\n"
+              << "  --fixed                 Run a single step at --start-rate\n"
+              << "  --loss-slo <pct>        Max packet loss per step (default 0.1)\n"
+              << "  --p99-slo-ms <ms>       Max p99 packet latency per step (default 10)\n"
+              << "  --sensor-rate <hz>      Sensor frames per second (default 10)\n"
+              << "  --bss-scan-rate <hz>    WiFi scans per second (default 0.2)\n"
+              << "  --bss-per-scan <n>      Networks reported per scan (default 20)\n"
+              << "  --ping-rate <hz>        Ping results per second (default 0.5)\n"
+              << "  --packet-queue <n>      Capture queue capacity (default 4096)\n"
+              << "  --correlate-ms <ms>     Correlator tick interval (default 1000)\n"
+              << "  --json <path>           Write the JSON report to path ('-' for stdout)\n"
+              << "  --help, -h              Show this help message\n";
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    Options opt;
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        auto next = [&](double& out) {
+            if (i + 1 < argc) out = std::atof(argv[++i]);
+        };
+        double v = 0;
+        if (arg == "--start-rate") { next(opt.start_rate); }
+        else if (arg == "--max-rate") { next(opt.max_rate); }
+        else if (arg == "--ramp-factor") { next(opt.ramp_factor); }
+        else if (arg == "--step-seconds") { next(opt.step_seconds); }
+        else if (arg == "--fixed") { opt.fixed = true; }
+        else if (arg == "--loss-slo") { next(opt.loss_slo_pct); }
+        else if (arg == "--p99-slo-ms") { next(opt.p99_slo_ms); }
+        else if (arg == "--sensor-rate") { next(opt.sensor_rate); }
+        else if (arg == "--bss-scan-rate") { next(opt.bss_scan_rate); }
+        else if (arg == "--bss-per-scan") { next(v); opt.bss_per_scan = static_cast<int>(v); }
+        else if (arg == "--ping-rate") { next(opt.ping_rate); }
+        else if (arg == "--packet-queue") { next(v); opt.packet_queue = static_cast<size_t>(v); }
+        else if (arg == "--correlate-ms") { next(v); opt.correlate_interval_ms = static_cast<int>(v); }
+        else if (arg == "--json" && i + 1 < argc) { opt.json_path = argv[++i]; }
+        else if (arg == "--help" || arg == "-h") { usage(argv[0]); return 0; }
+        else {
+            std::cerr << "Unknown option: " << arg << "\n";
+            usage(argv[0]);
+            return 1;
+        }
+    }
+    if (opt.ramp_factor <= 1.0 || opt.start_rate <= 0.0 || opt.step_seconds <= 0.0 || opt.correlate_interval_ms <= 0) {
+        std::cerr << "Error: invalid ramp parameters\n";
+        return 1;
+    }
+
+    // Components log through the global logger; keep the console quiet
+    core::init_logger("warn");
+
+    Dataset data;
+    std::string error;
+    if (!load_dataset(data, error)) {
+        std::cerr << "Error: " << error << " (set ENVIRONET_BENCH_DATA)\n";
+        return 1;
+    }
+
+    // Keep stdout clean for the JSON report when it goes there
+    FILE* table = opt.json_path == "-" ? stderr : stdout;
+    std::fprintf(table, "%10s %10s %10s %8s %10s %10s %7s %7s %6s %8s  %s\n", "target", "offered", "processed",
+                "loss%", "p50_us", "p99_us", "maxq", "corrbuf", "cpu%", "rss_mb", "result");
+
+    nlohmann::json steps = nlohmann::json::array();
+    double saturation = 0.0;
+    std::string limit = "max_rate";
+    for (double rate = opt.start_rate; rate <= opt.max_rate; rate *= opt.ramp_factor) {
+        auto step = run_step(data, opt, rate);
+        print_step(table, step);
+        steps.push_back(step);
+        if (!step["passed"].get<bool>()) {
+            limit = step["violation"].get<std::string>();
+            break;
+        }
+        saturation = step["processed_packet_rate"].get<double>();
+        if (opt.fixed) {
+            limit = "fixed";
+            break;
+        }
+    }
+
+    std::fprintf(table, "Saturation throughput: %.0f packets/s (limited by %s)\n", saturation, limit.c_str());
+
+    nlohmann::json report;
+    report["config"] = {
+        {"start_rate", opt.start_rate}, {"max_rate", opt.max_rate}, {"ramp_factor", opt.ramp_factor},
+        {"step_seconds", opt.step_seconds}, {"loss_slo_pct", opt.loss_slo_pct}, {"p99_slo_ms", opt.p99_slo_ms},
+        {"sensor_rate", opt.sensor_rate}, {"bss_scan_rate", opt.bss_scan_rate}, {"bss_per_scan", opt.bss_per_scan},
+        {"ping_rate", opt.ping_rate}, {"packet_queue", opt.packet_queue}, {"correlate_interval_ms", opt.correlate_interval_ms},
+        {"hardware_threads", std::thread::hardware_concurrency()},
+    };
+    report["steps"] = steps;
+    report["saturation_packet_rate"] = saturation;
+    report["limited_by"] = limit;
+
+    if (opt.json_path == "-") {
+        std::cout << report.dump(2) << std::endl;
+    } else if (!opt.json_path.empty()) {
+        std::ofstream out(opt.json_path);
+        if (!out) {
+            std::cerr << "Error: cannot write " << opt.json_path << "\n";
+            return 1;
+        }
+        out << report.dump(2) << std::endl;
+    }
+    return 0;
+}
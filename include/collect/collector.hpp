@@ -0,0 +1,216 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <deque>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <nlohmann/json.hpp>
+
+#include "collect/protocol.hpp"
+#include "core/config.hpp"
+#include "core/http_server.hpp"
+#include "core/json_writer.hpp"
+
+namespace environet {
+namespace collect {
+
+/**
+ * @brief Central side of multi-node aggregation (environet --collector)
+ *
+ * Accepts edge connections on collector.port on one epoll thread. Each
+ * batch is applied and acknowledged before the edge's next one is read,
+ * and an edge may have at most collector.credits batches unacknowledged,
+ * so an edge's receive buffer is bounded by its credit window and a busy
+ * collector slows only the edges that are sending (their spools absorb
+ * the backlog). Batches with a sequence number already applied for that
+ * edge are acknowledged and dropped.
+ *
+ * Findings and rollups are kept per edge (bounded) and queried across
+ * sites over HTTP:
+ *   GET /api/v1/edges                        per-edge state and counters
+ *   GET /api/v1/findings?edge=&since=&limit= findings of one or all edges, oldest first
+ *   GET /api/v1/rollups?edge=&since=&limit=  rollups of one or all edges, oldest first
+ *   GET /api/v1/stats                        collector statistics
+ *
+ * Times are wall-clock milliseconds stamped by the edge ("wall_ms").
+ */
+class Collector {
+public:
+    /**
+     * @brief Constructor
+     *
+     * @param config Configuration snapshot (must not be null)
+     */
+    explicit Collector(std::shared_ptr<const core::Config> config);
+
+    /**
+     * @brief Destructor (stops the collector)
+     */
+    ~Collector();
+
+    Collector(const Collector&) = delete;
+    Collector& operator=(const Collector&) = delete;
+
+    /**
+     * @brief Bind the ingest port and start accepting edges
+     *
+     * @return true if successful, false otherwise
+     */
+    bool start();
+
+    /**
+     * @brief Serve the query routes on an HTTP server
+     *
+     * @param bind_address IPv4 address to bind
+     * @param port TCP port (0 picks an ephemeral port)
+     * @return true if successful, false otherwise
+     */
+    bool start_api(const std::string& bind_address, int port);
+
+    /**
+     * @brief Stop ingest and the query server
+     */
+    void stop();
+
+    /**
+     * @brief Get the bound ingest port (useful when configured with port 0)
+     */
+    int port() const { return port_; }
+
+    /**
+     * @brief Get the bound query port (0 if not serving)
+     */
+    int api_port() const { return api_.port(); }
+
+    /**
+     * @brief Handle one query request (what the query server calls for each route)
+     *
+     * @param req Parsed request
+     * @return Response with a JSON body
+     */
+    core::HttpResponse handle(const core::HttpRequest& req) const;
+
+    /**
+     * @brief Get per-edge state and counters
+     *
+     * @return JSON object keyed by edge name
+     */
+    nlohmann::json get_edges() const;
+
+    /**
+     * @brief Write retained records as a JSON array, oldest first
+     *
+     * Each element is {"edge", "wall_ms", "data"} (rollups also carry
+     * "interval_ms").
+     *
+     * @param out Writer positioned where a value may go
+     * @param rollups Rollups instead of findings
+     * @param edge Only this edge (empty for all)
+     * @param since_ms Only records stamped after this time (wall clock)
+     * @param limit Maximum number of records to write (the newest are kept)
+     * @return Number of records written
+     */
+    size_t write_records(core::JsonWriter& out, bool rollups, const std::string& edge, uint64_t since_ms,
+                         size_t limit) const;
+
+    /**
+     * @brief Get collector statistics
+     *
+     * @return JSON object with connection, batch and record counters
+     */
+    nlohmann::json get_stats() const;
+
+    /**
+     * @brief Get last error message
+     *
+     * @return Error message string
+     */
+    std::string get_last_error() const { return last_error_; }
+
+private:
+    struct Record {
+        uint64_t wall_ms;
+        uint64_t interval_ms;
+        std::string data;           // Serialized JSON
+    };
+
+    struct Edge {
+        uint64_t acked_seq = 0;     // Highest batch applied
+        uint64_t epoch = 0;         // Spool epoch acked_seq belongs to (0 = not sent)
+        std::deque<Record> findings;
+        std::deque<Record> rollups;
+        bool connected = false;
+        std::string peer;
+        uint64_t last_seen_ms = 0;  // Wall clock
+        uint64_t batches = 0;
+        uint64_t duplicates = 0;
+        uint64_t records = 0;
+        uint64_t bad_records = 0;
+        uint64_t sequence_resets = 0;   // Hellos from an edge whose spool started over
+        uint64_t bytes = 0;         // Batch payload bytes received
+    };
+
+    struct Connection {
+        std::string in;
+        std::string out;
+        size_t out_pos = 0;
+        std::string edge;           // Set by Hello
+        std::string peer;
+        bool close_after_write = false;
+    };
+
+    void serve_loop();
+    void accept_connections();
+    void handle_readable(int fd);
+    void handle_writable(int fd);
+    void close_connection(int fd);
+    bool handle_frame(int fd, Connection& conn, const Frame& frame);
+    bool hello(int fd, Connection& conn, const Frame& frame);
+    bool apply_batch(Connection& conn, const Frame& frame);
+    void reject(Connection& conn, const std::string& message);
+    void cleanup();
+    static uint64_t wall_ms();
+
+    // Configuration
+    std::string bind_address_;
+    int config_port_;
+    size_t max_edges_;
+    size_t credits_;
+    size_t max_batch_bytes_;
+    size_t findings_per_edge_;
+    size_t rollups_per_edge_;
+
+    // Edges (guarded by edges_mutex_; written by the ingest thread)
+    mutable std::mutex edges_mutex_;
+    std::map<std::string, Edge> edges_;
+
+    // Ingest (ingest thread)
+    std::map<int, Connection> connections_;
+    int listen_fd_ = -1;
+    int epoll_fd_ = -1;
+    int wake_fd_ = -1;
+    int port_ = 0;
+    std::atomic<bool> running_{false};
+    std::thread thread_;
+
+    core::HttpServer api_;
+
+    // Statistics
+    std::atomic<uint64_t> connections_accepted_{0};
+    std::atomic<uint64_t> connections_rejected_{0};
+    std::atomic<uint64_t> batches_{0};
+    std::atomic<uint64_t> duplicates_{0};
+    std::atomic<uint64_t> records_{0};
+    std::atomic<uint64_t> bytes_in_{0};
+    std::atomic<uint64_t> bytes_raw_{0};
+    mutable std::atomic<uint64_t> bad_requests_{0};
+
+    std::string last_error_;
+};
+
+} // namespace collect
+} // namespace environet
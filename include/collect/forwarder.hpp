@@ -0,0 +1,195 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <nlohmann/json.hpp>
+
+#include "collect/protocol.hpp"
+#include "core/config.hpp"
+#include "core/wal.hpp"
+
+namespace environet {
+namespace correlate {
+struct Finding;
+}
+
+namespace collect {
+
+/**
+ * @brief Edge side of multi-node aggregation
+ *
+ * Findings and periodic rollups (window statistics) are JSON records
+ * appended to a write-ahead log in forward.spool_dir (core::WriteAheadLog).
+ * The forwarding thread group-commits the log every
+ * forward.sync_interval_ms and sends durable records to the collector in
+ * batches of forward.batch_max_records (partial batches at least every
+ * batch_interval_ms). A batch's sequence number is the LSN of its last
+ * record. Records are released from the log only once the collector
+ * acknowledges them, so they survive disconnects, restarts and crashes
+ * (up to the last sync) and are delivered at least once; the collector
+ * drops repeats by sequence number.
+ *
+ * The collector grants a number of credits on connect: at most that many
+ * batches are unacknowledged at a time, and the rest wait in the log.
+ * The log is bounded by forward.spool_max_mb; beyond it the oldest
+ * segments are dropped and their records counted as lost.
+ */
+class Forwarder {
+public:
+    /**
+     * @brief Constructor
+     *
+     * @param config Configuration snapshot (must not be null)
+     */
+    explicit Forwarder(std::shared_ptr<const core::Config> config);
+
+    /**
+     * @brief Destructor (stops the forwarder)
+     */
+    ~Forwarder();
+
+    Forwarder(const Forwarder&) = delete;
+    Forwarder& operator=(const Forwarder&) = delete;
+
+    /**
+     * @brief Open the spool and recover records left from a previous run
+     *
+     * @return true if successful, false otherwise
+     */
+    bool init();
+
+    /**
+     * @brief Start the forwarding thread
+     *
+     * @return true if successful, false otherwise
+     */
+    bool start();
+
+    /**
+     * @brief Stop and make every queued record durable
+     */
+    void stop();
+
+    /**
+     * @brief Set the rollup source
+     *
+     * Called on the forwarding thread every forward.rollup_interval_ms;
+     * call before start().
+     *
+     * @param provider Returns a JSON object (e.g. window statistics)
+     */
+    void set_rollup_provider(std::function<nlohmann::json()> provider) { rollup_provider_ = std::move(provider); }
+
+    /**
+     * @brief Queue a finding for forwarding (thread-safe)
+     *
+     * @param finding Finding (as passed to the finding callback)
+     */
+    void publish_finding(const correlate::Finding& finding);
+
+    /**
+     * @brief Sync the spool and send queued records now instead of at the next interval (thread-safe)
+     */
+    void flush();
+
+    /**
+     * @brief Get this edge's name
+     */
+    const std::string& edge_id() const { return edge_id_; }
+
+    /**
+     * @brief Check whether the collector connection is up
+     */
+    bool connected() const { return connected_.load(); }
+
+    /**
+     * @brief Get the number of spooled records not yet acknowledged
+     *
+     * Until the collector reports its position after a restart, records
+     * it acknowledged in the previous run may still be counted.
+     */
+    size_t spooled() const;
+
+    /**
+     * @brief Get forwarder statistics
+     *
+     * @return JSON object with batch, byte, spool and connection counters
+     */
+    nlohmann::json get_stats() const;
+
+    /**
+     * @brief Get last error message
+     *
+     * @return Error message string
+     */
+    std::string get_last_error() const;
+
+private:
+    void run();
+    void add_record(const std::string& record);
+    void add_rollup(uint64_t interval_ms);
+    bool connect_collector();
+    bool wait_fd(int fd, short events, uint64_t deadline_ms);
+    void disconnect(const std::string& reason);
+    bool send_batches(bool partial);
+    bool flush_out();
+    bool read_frames();
+    void handle_ack(uint64_t seq);
+    void wake();
+    void set_error(const std::string& error);
+    static uint64_t now_ms();
+    static uint64_t wall_ms();
+
+    // Configuration
+    std::string host_;
+    int port_;
+    std::string edge_id_;
+    Compression compression_ = Compression::Zlib;
+    int batch_interval_ms_;
+    size_t batch_max_records_;
+    int rollup_interval_ms_;
+    int sync_interval_ms_;
+    int reconnect_ms_;
+    std::function<nlohmann::json()> rollup_provider_;
+
+    core::WriteAheadLog wal_;
+
+    // Connection (forwarding thread)
+    std::deque<uint64_t> in_flight_;    // Last LSN of each batch sent on this connection
+    uint64_t next_send_lsn_ = 1;
+    size_t credits_ = 0;
+    int fd_ = -1;
+    std::string in_;
+    std::string out_;
+    size_t out_pos_ = 0;            // Bytes of out_ already sent
+    std::string body_;              // Batch body scratch
+
+    std::thread thread_;
+    std::atomic<bool> running_{false};
+    std::atomic<bool> flush_requested_{false};
+    std::atomic<bool> connected_{false};
+    int wake_fd_ = -1;
+
+    // Statistics
+    std::atomic<uint64_t> records_{0};
+    std::atomic<uint64_t> records_dropped_{0};
+    std::atomic<uint64_t> batches_sent_{0};
+    std::atomic<uint64_t> batches_acked_{0};
+    std::atomic<uint64_t> bytes_raw_{0};
+    std::atomic<uint64_t> bytes_sent_{0};
+    std::atomic<uint64_t> connects_{0};
+    std::atomic<uint64_t> acked_seq_{0};
+    std::atomic<uint64_t> sent_lsn_{0};
+
+    mutable std::mutex error_mutex_;
+    std::string last_error_;
+};
+
+} // namespace collect
+} // namespace environet
@@ -0,0 +1,140 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+namespace environet {
+namespace collect {
+
+/**
+ * Edge-to-collector wire protocol (TCP, little-endian)
+ *
+ * Every message is a frame: a 16-byte header (u32 magic "EVN1", u8 type,
+ * u8 flags, u16 reserved, u32 payload length, u32 CRC-32 of the payload)
+ * followed by the payload.
+ *
+ *   Hello    edge -> collector   JSON {"edge": id, "proto": 1, "epoch": e, "next_seq": n}
+ *   Welcome  collector -> edge   JSON {"credits": n, "acked_seq": s}
+ *   Batch    edge -> collector   u64 seq, u32 records, u32 raw length, body
+ *   Ack      collector -> edge   u64 seq (this and all earlier batches applied)
+ *   Error    either way          JSON {"error": message}; the sender closes
+ *
+ * A batch body is newline-separated JSON records, deflated when the frame
+ * has FLAG_ZLIB. Records carry consecutive per-edge sequence numbers (the
+ * edge's spool LSNs, which survive restarts) and a batch's seq is that of
+ * its last record, so it holds records seq - records + 1 .. seq. The
+ * collector drops batches, and leading records of batches, it has already
+ * applied. epoch identifies the spool's sequence and changes whenever the
+ * spool starts over (e.g. was wiped); the collector resets an edge's
+ * acked_seq to 0 when it changes, so the new records are not mistaken for
+ * repeats. next_seq is the seq the edge assigns next; for edges that send
+ * no epoch, an acked_seq at or past it is taken as the same restart.
+ */
+enum class FrameType : uint8_t {
+    Hello = 1,
+    Welcome = 2,
+    Batch = 3,
+    Ack = 4,
+    Error = 5,
+};
+
+constexpr uint32_t FRAME_MAGIC = 0x314E5645;    // "EVN1"
+constexpr size_t FRAME_HEADER_SIZE = 16;
+constexpr size_t BATCH_HEADER_SIZE = 16;
+constexpr uint8_t FLAG_ZLIB = 0x01;
+constexpr int PROTOCOL_VERSION = 1;
+
+/**
+ * @brief Batch body compression
+ */
+enum class Compression {
+    None,
+    Zlib,
+};
+
+/**
+ * @brief One received frame
+ */
+struct Frame {
+    FrameType type = FrameType::Error;
+    uint8_t flags = 0;
+    std::string payload;
+};
+
+/**
+ * @brief Decoded batch
+ */
+struct Batch {
+    uint64_t seq = 0;
+    uint32_t records = 0;
+    std::string body;           // Newline-separated JSON records (decompressed)
+};
+
+/**
+ * @brief Append a frame
+ *
+ * @param out Buffer to append to
+ * @param type Frame type
+ * @param flags Frame flags
+ * @param payload Payload bytes
+ */
+void append_frame(std::string& out, FrameType type, uint8_t flags, std::string_view payload);
+
+/**
+ * @brief Take one frame off the front of a buffer
+ *
+ * @param in Received bytes; the frame is removed when complete
+ * @param frame Receives the frame
+ * @param max_payload Largest payload accepted
+ * @return 1 if a frame was taken, 0 if more bytes are needed, -1 on a bad
+ *         magic, oversized payload or checksum mismatch
+ */
+int take_frame(std::string& in, Frame& frame, size_t max_payload);
+
+/**
+ * @brief Append a batch frame
+ *
+ * Compression is skipped when it would not make the body smaller.
+ *
+ * @param out Buffer to append to
+ * @param seq Sequence number of the last record
+ * @param records Number of records in @p body
+ * @param body Newline-separated JSON records
+ * @param compression Requested compression
+ */
+void append_batch_frame(std::string& out, uint64_t seq, uint32_t records, std::string_view body,
+                        Compression compression);
+
+/**
+ * @brief Decode a batch frame
+ *
+ * @param frame Frame of type Batch
+ * @param batch Receives the batch
+ * @param max_body Largest decompressed body accepted
+ * @return true if the payload is well formed
+ */
+bool decode_batch(const Frame& frame, Batch& batch, size_t max_body);
+
+/**
+ * @brief Append an Ack frame
+ */
+void append_ack_frame(std::string& out, uint64_t seq);
+
+/**
+ * @brief Decode an Ack frame's sequence number
+ *
+ * @return true if the payload is well formed
+ */
+bool decode_ack(const Frame& frame, uint64_t& seq);
+
+/**
+ * @brief Parse a compression name ("zlib" or "none")
+ *
+ * @return true if the name is known
+ */
+bool parse_compression(const std::string& name, Compression& compression);
+
+} // namespace collect
+} // namespace environet
@@ -0,0 +1,83 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <memory_resource>
+#include <optional>
+#include <nlohmann/json.hpp>
+
+namespace environet {
+namespace core {
+
+/**
+ * @brief Monotonic scratch arena for one processing tick
+ *
+ * Allocations bump a pointer through a preallocated block and
+ * deallocation is a no-op; reset() frees everything at once at the end of
+ * the tick. When a tick outgrows the block the overflow comes from the
+ * heap, and the next reset() replaces the block with one large enough for
+ * that tick, so a steady workload stops calling malloc after a few ticks.
+ *
+ * Not thread-safe: one arena per processing thread.
+ */
+class TickArena : public std::pmr::memory_resource {
+public:
+    /**
+     * @brief Create an arena
+     *
+     * @param initial_bytes Size of the first block
+     */
+    explicit TickArena(size_t initial_bytes = 64 * 1024);
+
+    TickArena(const TickArena&) = delete;
+    TickArena& operator=(const TickArena&) = delete;
+
+    /**
+     * @brief Release every allocation made since the last reset
+     *
+     * All memory handed out since then becomes invalid.
+     */
+    void reset();
+
+    /**
+     * @brief Get the current block size in bytes
+     */
+    size_t capacity() const { return capacity_; }
+
+    /**
+     * @brief Get arena statistics
+     *
+     * @return JSON object with block size, high-water mark, resets and spills
+     */
+    nlohmann::json get_stats() const;
+
+private:
+    // Heap fallback that records how much a tick spilled past the block
+    class Spill : public std::pmr::memory_resource {
+    public:
+        size_t bytes = 0;
+
+    private:
+        void* do_allocate(size_t bytes, size_t alignment) override;
+        void do_deallocate(void* p, size_t bytes, size_t alignment) override;
+        bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override;
+    };
+
+    void* do_allocate(size_t bytes, size_t alignment) override;
+    void do_deallocate(void* p, size_t bytes, size_t alignment) override;
+    bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override;
+
+    size_t capacity_;
+    std::unique_ptr<std::byte[]> block_;
+    Spill spill_;
+    std::optional<std::pmr::monotonic_buffer_resource> monotonic_;
+
+    size_t used_ = 0;           // Bytes requested since the last reset
+    size_t high_water_ = 0;
+    uint64_t resets_ = 0;
+    uint64_t spills_ = 0;       // Resets after a tick that outgrew the block
+};
+
+} // namespace core
+} // namespace environet
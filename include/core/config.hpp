@@ -4,6 +4,7 @@
 #include <memory>
 #include <nlohmann/json.hpp>
 #include <stdexcept>
+#include <vector>
 
 namespace environet {
 namespace core {
@@ -36,6 +37,54 @@ public:
         int max_files = 10;                  // Max number of pcap files
     };
 
+    struct ClassRule {
+        std::string name;                    // Class assigned when the rule matches
+        std::vector<std::string> macs;       // MAC prefixes ("b8:27:eb" or "b8:27:eb:00:00:00/24")
+        std::vector<std::string> ips;        // IPv4/IPv6 CIDR prefixes
+        std::vector<std::string> ports;      // TCP/UDP ports or ranges ("53", "8000-8099")
+        std::vector<int> protocols;          // IP protocol numbers (6 = TCP, 17 = UDP)
+
+        bool operator==(const ClassRule& o) const {
+            return name == o.name && macs == o.macs && ips == o.ips && ports == o.ports &&
+                   protocols == o.protocols;
+        }
+    };
+
+    struct ClassifierConfig {
+        std::vector<ClassRule> rules;        // Evaluated in order; the first match wins
+    };
+
+    struct AccountingConfig {
+        bool enabled = true;                 // Per-host traffic sketches from captured packets
+        int bucket_ms = 1000;                // Time bucket length
+        int buckets = 32;                    // Buckets kept per capture thread
+        size_t top_k = 16;                   // Heavy hitters tracked per bucket and key type
+        size_t sketch_width = 512;           // Count-Min counters per row (power of two)
+        size_t sketch_depth = 4;             // Count-Min rows
+        int device_precision = 10;           // HyperLogLog index bits for unique devices (2^p bytes)
+    };
+
+    struct DnsConfig {
+        bool enabled = true;                 // Match DNS queries to responses on port 53
+        int bucket_ms = 1000;                // Interval of the series pushed to the correlator
+        size_t max_pending = 4096;           // Outstanding queries tracked (power of two)
+        int timeout_ms = 5000;               // Unanswered queries count as timeouts after this
+    };
+
+    struct FlowExportConfig {
+        bool enabled = false;                // Export captured flows over UDP
+        std::string protocol = "ipfix";      // ipfix or netflow9
+        std::string collector_host = "127.0.0.1"; // Flow collector address
+        int collector_port = 4739;           // Flow collector UDP port
+        uint32_t observation_domain = 1;     // IPFIX observation domain / NetFlow v9 source id
+        uint32_t enterprise_id = 32473;      // Private enterprise number of the custom IEs
+        int active_timeout_ms = 60000;       // Export long-lived flows at least this often
+        int inactive_timeout_ms = 15000;     // Export flows idle this long
+        int template_refresh_ms = 60000;     // Resend templates this often (UDP)
+        size_t max_flows = 65536;            // Flow table slots (power of two)
+        size_t mtu = 1400;                   // Maximum export datagram size
+    };
+
     struct CorrelatorConfig {
         int sensor_threshold = 200;          // Sensor change threshold
         int window_ms = 5000;                // Correlation window in milliseconds
@@ -48,6 +97,9 @@ public:
         bool console = true;                 // Enable console logging
         size_t max_size_mb = 5;              // Max log file size
         int max_files = 3;                   // Max log files to keep
+        bool async = true;                   // Log through a background thread
+        size_t async_queue_size = 8192;      // Preallocated async queue slots
+        std::string overflow_policy = "overrun_oldest"; // "block" or "overrun_oldest" when queue is full
     };
 
     struct MetricsConfig {
@@ -57,13 +109,110 @@ public:
         int iperf3_duration = 10;            // iperf3 test duration in seconds
     };
 
+    struct TelemetryConfig {
+        bool enabled = true;                 // Serve /metrics over HTTP
+        std::string bind_address = "127.0.0.1"; // Listen address (localhost only by default)
+        int port = 9464;                     // Listen port
+    };
+
+    struct ApiConfig {
+        bool enabled = true;                 // Serve the JSON query API
+        std::string bind_address = "127.0.0.1"; // Listen address (localhost only by default)
+        int port = 9465;                     // Listen port (-1 = Unix socket only)
+        std::string unix_socket;             // Also listen on this Unix socket path (empty = none)
+        int max_points = 2000;               // Points per series response (the step is widened to fit)
+    };
+
+    struct PushConfig {
+        bool enabled = true;                 // Stream findings and live series at /api/v1/stream
+        int max_clients = 16;                // Concurrent stream clients
+        int queue_size = 64;                 // Findings queued per client (oldest dropped beyond)
+        int max_series = 256;                // Distinct series (e.g. BSSIDs) pending per client
+    };
+
+    struct ForwardConfig {
+        bool enabled = false;                // Forward findings and rollups to a collector
+        std::string collector_host = "127.0.0.1"; // Collector address
+        int collector_port = 9470;           // Collector ingest port
+        std::string edge_id;                 // Name of this site (empty = hostname)
+        std::string spool_dir = "spool";     // Write-ahead log of records kept until acknowledged
+        std::string compression = "zlib";    // Batch compression: zlib or none
+        int batch_interval_ms = 1000;        // Send a partial batch at least this often
+        int batch_max_records = 500;         // Records per batch (full batches go out at once)
+        int rollup_interval_ms = 10000;      // Window statistics rollup period (0 = off)
+        int sync_interval_ms = 100;          // Group commit period: records are durable within this
+        size_t spool_segment_mb = 8;         // Spool segment file size
+        size_t spool_max_mb = 64;            // Oldest unacknowledged segments dropped beyond
+        int reconnect_ms = 2000;             // Delay between connection attempts
+    };
+
+    struct CollectorConfig {
+        std::string bind_address = "0.0.0.0"; // Ingest bind address (collector mode)
+        int port = 9470;                     // Ingest port
+        int max_edges = 64;                  // Distinct edges kept
+        int credits = 8;                     // Unacknowledged batches an edge may have in flight
+        size_t max_batch_kb = 4096;          // Largest batch accepted (compressed and raw)
+        int findings_per_edge = 1000;        // Findings retained per edge
+        int rollups_per_edge = 360;          // Rollups retained per edge
+    };
+
+    struct TraceConfig {
+        bool enabled = false;                // Record the binary event trace
+        std::string file = "traces/environet.trace"; // Trace file path
+        size_t max_file_size_mb = 64;        // Rotate trace file after this size
+        int max_files = 4;                   // Trace files to keep
+        size_t buffer_records = 65536;       // Per-thread ring capacity in records
+        int flush_interval_ms = 20;          // Flusher wake-up interval
+    };
+
+    struct TimelineConfig {
+        bool enabled = false;                // Record pipeline slices and counters
+        size_t buffer_events = 262144;       // Ring capacity (oldest events are overwritten)
+        int dump_seconds = 10;               // Window written on SIGUSR2 / /debug/timeline
+        std::string output_dir = "traces";   // Directory for SIGUSR2 dumps
+    };
+
+    struct TasksConfig {
+        size_t workers = 0;                  // Work-stealing pool size (0 = one per CPU)
+        bool pin_workers = false;            // Pin each worker to its own CPU
+    };
+
+    struct ThreadPlacementConfig {
+        std::vector<int> cpus;               // CPUs the thread may run on (empty = any)
+        std::string policy = "other";        // Scheduling policy: other, fifo or rr
+        int priority = 0;                    // Real-time priority 1..99 (fifo/rr only)
+        int nice = 0;                        // Nice value -20..19 (other only)
+    };
+
+    struct ThreadsConfig {
+        ThreadPlacementConfig capture;       // Packet capture thread
+        ThreadPlacementConfig writer;        // Async log writer thread
+        ThreadPlacementConfig sensor;        // Event loop thread (reads the sensor)
+        ThreadPlacementConfig correlation;   // Correlation tick worker
+        ThreadPlacementConfig metrics;       // Ping/iperf3 worker
+        int numa_node = -1;                  // Node for capture buffers (-1 = the capture NIC's node)
+    };
+
     // Configuration sections
     I2CConfig i2c;
     WifiConfig wifi;
     PcapConfig pcap;
+    ClassifierConfig classifier;
+    AccountingConfig accounting;
+    DnsConfig dns;
+    FlowExportConfig flow_export;
     CorrelatorConfig correlator;
     LoggingConfig logging;
     MetricsConfig metrics;
+    TelemetryConfig telemetry;
+    ApiConfig api;
+    PushConfig push;
+    ForwardConfig forward;
+    CollectorConfig collector;
+    TraceConfig trace;
+    TimelineConfig timeline;
+    TasksConfig tasks;
+    ThreadsConfig threads;
 
     /**
      * @brief Load configuration from JSON file
@@ -90,6 +239,17 @@ public:
      */
     static Config get_defaults();
 
+    /**
+     * @brief Load configuration as a shared immutable snapshot
+     * 
+     * For components still constructed from a file path; the defaults are
+     * returned if the file cannot be loaded.
+     * 
+     * @param path Path to configuration file
+     * @return Shared configuration snapshot (never null)
+     */
+    static std::shared_ptr<const Config> load_snapshot(const std::string& path);
+
     /**
      * @brief Validate configuration
      * 
@@ -0,0 +1,150 @@
+#pragma once
+
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include <nlohmann/json.hpp>
+
+#include "core/config.hpp"
+
+namespace environet {
+namespace core {
+
+/**
+ * @brief Owns the running configuration and reloads it without a restart
+ *
+ * The current configuration is an immutable snapshot; readers take a
+ * shared_ptr and keep using it while a reload publishes a new one. A
+ * reload loads and validates the file, diffs it against the running
+ * snapshot and hands both to every listener so components can apply the
+ * changed settings in place. An invalid file leaves the running
+ * configuration untouched.
+ */
+class ConfigManager {
+public:
+    /**
+     * @brief Reload listener
+     *
+     * @param old_config Configuration before the reload
+     * @param new_config Configuration now in effect
+     * @param changed Dotted keys ("pcap.bpf", ...) whose value changed
+     */
+    using Listener = std::function<void(const Config& old_config, const Config& new_config,
+                                        const std::vector<std::string>& changed)>;
+
+    /**
+     * @brief Adjustment applied to every loaded file (command-line overrides)
+     */
+    using Adjuster = std::function<void(Config&)>;
+
+    /**
+     * @brief Constructor
+     *
+     * @param path Configuration file to reload from
+     * @param initial Configuration already loaded from @p path
+     * @param adjust Optional adjustment applied after each reload
+     */
+    ConfigManager(const std::string& path, Config initial, Adjuster adjust = nullptr);
+
+    /**
+     * @brief Destructor
+     */
+    ~ConfigManager();
+
+    ConfigManager(const ConfigManager&) = delete;
+    ConfigManager& operator=(const ConfigManager&) = delete;
+
+    /**
+     * @brief Get the current configuration snapshot
+     *
+     * @return Immutable configuration, valid for as long as it is held
+     */
+    std::shared_ptr<const Config> current() const;
+
+    /**
+     * @brief Register a reload listener
+     *
+     * Listeners run on the thread that performed the reload, in
+     * registration order, and only when something changed.
+     *
+     * @param listener Listener to call
+     */
+    void subscribe(Listener listener);
+
+    /**
+     * @brief Reload the configuration file now
+     *
+     * @return true if the file was valid (changed or not), false otherwise
+     */
+    bool reload();
+
+    /**
+     * @brief Watch the configuration file with inotify and reload on change
+     *
+     * The parent directory is watched so editors that replace the file
+     * (write to a temporary and rename) are picked up too. Bursts of
+     * events are coalesced into a single reload.
+     *
+     * @return true if successful, false otherwise
+     */
+    bool start_watch();
+
+    /**
+     * @brief Stop the inotify watcher
+     */
+    void stop_watch();
+
+    /**
+     * @brief List the settings that differ between two configurations
+     *
+     * @param a First configuration
+     * @param b Second configuration
+     * @return Dotted keys ("section.key") whose values differ
+     */
+    static std::vector<std::string> diff(const Config& a, const Config& b);
+
+    /**
+     * @brief Get reload statistics
+     *
+     * @return JSON object with reload counts and the last changed keys
+     */
+    nlohmann::json get_stats() const;
+
+    /**
+     * @brief Get last error message
+     *
+     * @return Error message string
+     */
+    std::string get_last_error() const;
+
+private:
+    void watch_loop();
+    void set_error(const std::string& error);
+
+    const std::string path_;
+    Adjuster adjust_;
+
+    mutable std::mutex config_mutex_;
+    std::shared_ptr<const Config> current_;
+
+    mutable std::mutex reload_mutex_;   // Serializes reload() and listener calls
+    std::vector<Listener> listeners_;
+    uint64_t reloads_ = 0;
+    uint64_t failed_reloads_ = 0;
+    std::vector<std::string> last_changed_;
+
+    int inotify_fd_ = -1;
+    int wake_fd_ = -1;
+    std::atomic<bool> watching_{false};
+    std::thread watch_thread_;
+
+    mutable std::mutex error_mutex_;
+    std::string last_error_;
+};
+
+} // namespace core
+} // namespace environet
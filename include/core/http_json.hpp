@@ -0,0 +1,39 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+#include "core/http_server.hpp"
+
+namespace environet {
+namespace core {
+
+/**
+ * @brief JSON response with a trailing newline
+ *
+ * @param status HTTP status code
+ * @param body Serialized JSON document
+ */
+HttpResponse json_response(int status, std::string body);
+
+/**
+ * @brief JSON error response: {"error": message}
+ *
+ * @param status HTTP status code
+ * @param message Error description
+ */
+HttpResponse error_response(int status, std::string_view message);
+
+/**
+ * @brief Read an unsigned query parameter
+ *
+ * @param req Request
+ * @param key Parameter name
+ * @param value Set when the parameter is present; left unchanged otherwise
+ * @return false if the parameter is present but not a number
+ */
+bool param_u64(const HttpRequest& req, const char* key, uint64_t& value);
+
+} // namespace core
+} // namespace environet
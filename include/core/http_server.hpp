@@ -0,0 +1,256 @@
+#pragma once
+
+#include <atomic>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+#include <nlohmann/json.hpp>
+
+namespace environet {
+namespace core {
+
+/**
+ * @brief Parsed HTTP request
+ */
+struct HttpRequest {
+    std::string method;                          // e.g. "GET"
+    std::string path;                            // Path without query string
+    std::string query;                           // Raw query string (after '?')
+    std::map<std::string, std::string> headers;  // Header names lower-cased
+    std::string body;                            // Request body (Content-Length)
+
+    /**
+     * @brief Get a query parameter
+     *
+     * @param key Parameter name
+     * @param fallback Value returned when the parameter is absent
+     * @return Parameter value (not URL-decoded)
+     */
+    std::string query_param(const std::string& key, const std::string& fallback = "") const;
+};
+
+/**
+ * @brief HTTP response produced by a route handler
+ */
+struct HttpResponse {
+    int status = 200;
+    std::string content_type = "text/plain; charset=utf-8";
+    std::string body;
+    std::vector<std::pair<std::string, std::string>> headers;  // Extra response headers
+};
+
+/**
+ * @brief Long-lived response produced incrementally (server-sent events, WebSocket)
+ *
+ * Returned by a stream route handler. The server calls these methods on
+ * its own thread only; producers on other threads queue data inside the
+ * stream and call HttpServer::notify().
+ */
+class HttpStream {
+public:
+    virtual ~HttpStream() = default;
+
+    /**
+     * @brief Append data ready to send
+     *
+     * Called when the previous output has been sent in full and after
+     * every notify(), so queued data waits in the stream (where it can be
+     * bounded or coalesced) rather than in the socket buffer.
+     *
+     * @param out Buffer to append to
+     * @return false to close the connection once @p out is sent
+     */
+    virtual bool pull(std::string& out) = 0;
+
+    /**
+     * @brief Handle bytes received from the client
+     *
+     * @param in Received bytes; consumed bytes should be removed
+     * @param out Buffer for replies
+     * @return false to close the connection once @p out is sent
+     */
+    virtual bool receive(std::string& in, std::string& out) {
+        (void)out;
+        in.clear();
+        return true;
+    }
+
+    /**
+     * @brief Called once when the connection is closed
+     */
+    virtual void closed() {}
+};
+
+/**
+ * @brief Minimal embedded HTTP/1.1 server
+ *
+ * Serves registered exact-match routes from a single thread using
+ * non-blocking sockets and epoll, over TCP and optionally a Unix domain
+ * socket. Supports keep-alive; intended for localhost telemetry and query
+ * endpoints, not general web serving.
+ */
+class HttpServer {
+public:
+    /**
+     * @brief Route handler function type
+     */
+    using Handler = std::function<HttpResponse(const HttpRequest&)>;
+
+    /**
+     * @brief Stream route handler type
+     *
+     * Returns the stream that takes over the connection after the head of
+     * @p resp (status and headers, no body) is sent, or nullptr to send
+     * @p resp as an ordinary response instead.
+     */
+    using StreamHandler = std::function<std::shared_ptr<HttpStream>(const HttpRequest&, HttpResponse& resp)>;
+
+    /**
+     * @brief Constructor
+     */
+    HttpServer();
+
+    /**
+     * @brief Destructor (stops the server)
+     */
+    ~HttpServer();
+
+    HttpServer(const HttpServer&) = delete;
+    HttpServer& operator=(const HttpServer&) = delete;
+
+    /**
+     * @brief Register a handler for an exact path
+     *
+     * Routes must be registered before start().
+     *
+     * @param path Request path (e.g. "/metrics")
+     * @param handler Handler function
+     */
+    void add_route(const std::string& path, Handler handler);
+
+    /**
+     * @brief Register a handler that may turn GET requests for a path into streams
+     *
+     * Routes must be registered before start(). Streams are not closed
+     * for idleness.
+     *
+     * @param path Request path
+     * @param handler Stream handler
+     */
+    void add_stream_route(const std::string& path, StreamHandler handler);
+
+    /**
+     * @brief Wake the server thread to pull from its streams
+     *
+     * Thread-safe, but must not race with stop(): producers stop calling
+     * it before the server is stopped.
+     */
+    void notify();
+
+    /**
+     * @brief Also accept connections on a Unix domain socket
+     *
+     * Call before start(). A stale socket file at @p path is replaced; the
+     * file is removed again by stop().
+     *
+     * @param path Socket path
+     * @return true if successful, false otherwise
+     */
+    bool listen_unix(const std::string& path);
+
+    /**
+     * @brief Bind and start serving on a background thread
+     *
+     * @param bind_address IPv4 address to bind (e.g. "127.0.0.1")
+     * @param port TCP port (0 picks an ephemeral port, negative serves only the listen_unix() socket)
+     * @return true if successful, false otherwise
+     */
+    bool start(const std::string& bind_address, int port);
+
+    /**
+     * @brief Stop serving and close all connections
+     */
+    void stop();
+
+    /**
+     * @brief Check if the server is running
+     *
+     * @return true if serving
+     */
+    bool is_running() const { return running_; }
+
+    /**
+     * @brief Get the bound port (useful when started with port 0)
+     *
+     * @return Port number, or 0 if not started
+     */
+    int port() const { return port_; }
+
+    /**
+     * @brief Get server statistics
+     *
+     * @return JSON object with request counters
+     */
+    nlohmann::json get_stats() const;
+
+    /**
+     * @brief Get last error message
+     *
+     * @return Error message string
+     */
+    std::string get_last_error() const { return last_error_; }
+
+private:
+    struct Connection {
+        std::string in;
+        std::string out;
+        size_t out_pos = 0;             // Bytes of out already sent
+        std::shared_ptr<HttpStream> stream;
+        bool close_after_write = false;
+        uint64_t last_active_ms = 0;
+    };
+
+    std::map<std::string, Handler> routes_;
+    std::map<std::string, StreamHandler> stream_routes_;
+    std::map<int, Connection> connections_;
+
+    int listen_fd_;
+    int unix_fd_;
+    std::string unix_path_;
+    int epoll_fd_;
+    int wake_fd_;
+    int port_;
+    std::atomic<bool> running_;
+    std::thread thread_;
+
+    std::atomic<uint64_t> requests_served_;
+    std::atomic<uint64_t> connections_accepted_;
+    std::atomic<uint64_t> streams_opened_;
+
+    std::string last_error_;
+
+    void serve_loop();
+    void accept_connections(int listen_fd);
+    void handle_readable(int fd);
+    void handle_writable(int fd);
+    void close_connection(int fd);
+    void close_idle_connections();
+    void pull_streams();
+    void open_stream(Connection& conn, const HttpRequest& req);
+    bool parse_request(Connection& conn, HttpRequest& req, bool& keep_alive, bool& bad);
+    HttpResponse dispatch(const HttpRequest& req);
+    void set_error(const std::string& error);
+    void cleanup();
+
+    static void serialize(std::string& out, const HttpResponse& resp, bool keep_alive);
+    static void serialize_head(std::string& out, const HttpResponse& resp);
+    static const char* status_text(int status);
+};
+
+} // namespace core
+} // namespace environet
@@ -0,0 +1,127 @@
+#pragma once
+
+#include <chrono>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+#include <nlohmann/json.hpp>
+
+namespace environet {
+namespace core {
+
+/**
+ * @brief Outcome of one initialization step
+ */
+struct InitResult {
+    std::string name;         // Step name
+    bool required = true;     // Startup fails if a required step fails
+    bool ok = false;          // Step returned success within its deadline
+    bool timed_out = false;   // Deadline passed; the step was abandoned
+    bool skipped = false;     // Not run because a dependency did not succeed
+    double start_ms = 0.0;    // Start offset from the beginning of run()
+    double elapsed_ms = 0.0;  // Time the step ran (deadline if it timed out)
+    std::string error;        // Error message when not ok
+};
+
+/**
+ * @brief Runs component initialization as a dependency graph
+ *
+ * Each step starts on its own thread as soon as all of its dependencies
+ * have succeeded, so independent steps (shelling out to `iw`, opening
+ * the I2C bus, ...) overlap and startup takes as long as the slowest
+ * chain rather than the sum of all steps. A step still running at its
+ * deadline is abandoned: its thread is detached, it is reported as timed
+ * out and steps depending on it are skipped.
+ */
+class InitGraph {
+public:
+    /**
+     * @brief Initialization step
+     *
+     * @param error Set to a description of the failure
+     * @return true if successful, false otherwise
+     */
+    using InitFn = std::function<bool(std::string& error)>;
+
+    InitGraph();
+    ~InitGraph();
+
+    InitGraph(const InitGraph&) = delete;
+    InitGraph& operator=(const InitGraph&) = delete;
+
+    /**
+     * @brief Add an initialization step
+     *
+     * @param name Unique step name
+     * @param fn Step to run
+     * @param deps Steps that must succeed before this one starts
+     * @param deadline Time allowed for the step once started
+     * @param required Whether startup fails if this step does not succeed
+     */
+    void add(const std::string& name, InitFn fn, std::vector<std::string> deps = {},
+             std::chrono::milliseconds deadline = std::chrono::milliseconds(5000), bool required = true);
+
+    /**
+     * @brief Run all steps and wait until each has finished, failed or timed out
+     *
+     * @return true if every required step succeeded, false otherwise
+     */
+    bool run();
+
+    /**
+     * @brief Get the result of a step after run()
+     *
+     * @param name Step name
+     * @return Result, or nullptr if there is no such step
+     */
+    const InitResult* result(const std::string& name) const;
+
+    /**
+     * @brief Get all step results in the order they were added
+     */
+    const std::vector<InitResult>& results() const;
+
+    /**
+     * @brief Get wall-clock time taken by run()
+     *
+     * @return Milliseconds
+     */
+    double elapsed_ms() const;
+
+    /**
+     * @brief Get per-step timing
+     *
+     * @return JSON object with total time and per-step results
+     */
+    nlohmann::json get_stats() const;
+
+    /**
+     * @brief Get last error message
+     *
+     * @return Error message string
+     */
+    std::string get_last_error() const;
+
+private:
+    struct Node {
+        std::string name;
+        InitFn fn;
+        std::vector<size_t> deps;
+        std::vector<std::string> dep_names;
+        std::chrono::milliseconds deadline;
+        bool required;
+    };
+    struct State;
+
+    bool resolve();
+
+    std::vector<Node> nodes_;
+    std::vector<InitResult> results_;
+    std::shared_ptr<State> state_;
+    double elapsed_ms_ = 0.0;
+    std::string last_error_;
+};
+
+} // namespace core
+} // namespace environet
@@ -0,0 +1,123 @@
+#pragma once
+
+#include <charconv>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <type_traits>
+
+namespace environet {
+namespace core {
+
+/**
+ * @brief Streaming JSON serializer appending to a string
+ *
+ * For large responses built straight from internal data: values are
+ * formatted in place instead of going through a nlohmann::json document.
+ * Commas are inserted automatically; the caller is responsible for
+ * balancing begin/end calls and for calling key() inside objects.
+ */
+class JsonWriter {
+public:
+    /**
+     * @brief Create a writer
+     *
+     * @param out String the document is appended to
+     */
+    explicit JsonWriter(std::string& out) : out_(out) {}
+
+    JsonWriter& begin_object() { return open('{'); }
+    JsonWriter& end_object() { return close('}'); }
+    JsonWriter& begin_array() { return open('['); }
+    JsonWriter& end_array() { return close(']'); }
+
+    /**
+     * @brief Write an object key; the next call writes its value
+     */
+    JsonWriter& key(std::string_view name) {
+        separator();
+        append_string(name);
+        out_ += ':';
+        need_comma_ = false;
+        return *this;
+    }
+
+    JsonWriter& value(std::string_view s) {
+        separator();
+        append_string(s);
+        return *this;
+    }
+
+    JsonWriter& value(const char* s) { return value(std::string_view(s)); }
+
+    JsonWriter& value(bool b) {
+        separator();
+        out_ += b ? "true" : "false";
+        return *this;
+    }
+
+    template <typename T, std::enable_if_t<std::is_integral_v<T> && !std::is_same_v<T, bool>, int> = 0>
+    JsonWriter& value(T v) {
+        separator();
+        char buf[24];
+        auto res = std::to_chars(buf, buf + sizeof(buf), v);
+        out_.append(buf, res.ptr);
+        return *this;
+    }
+
+    /**
+     * @brief Write a number in its shortest round-trip form (NaN and infinities as null)
+     */
+    JsonWriter& value(double v);
+
+    JsonWriter& null() {
+        separator();
+        out_ += "null";
+        return *this;
+    }
+
+    /**
+     * @brief Write an already serialized JSON value
+     */
+    JsonWriter& raw(std::string_view json) {
+        separator();
+        out_ += json;
+        return *this;
+    }
+
+    /**
+     * @brief Write a key and its value
+     */
+    template <typename T>
+    JsonWriter& field(std::string_view name, const T& v) {
+        key(name);
+        return value(v);
+    }
+
+private:
+    void separator() {
+        if (need_comma_) out_ += ',';
+        need_comma_ = true;
+    }
+
+    JsonWriter& open(char c) {
+        separator();
+        out_ += c;
+        need_comma_ = false;
+        return *this;
+    }
+
+    JsonWriter& close(char c) {
+        out_ += c;
+        need_comma_ = true;
+        return *this;
+    }
+
+    void append_string(std::string_view s);
+
+    std::string& out_;
+    bool need_comma_ = false;   // A value was written at the current level
+};
+
+} // namespace core
+} // namespace environet
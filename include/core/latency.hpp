@@ -0,0 +1,99 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <time.h>
+#include <nlohmann/json.hpp>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+#include "core/metrics_registry.hpp"
+
+namespace environet {
+namespace core {
+
+/**
+ * @brief Read the latency clock
+ *
+ * Uses the TSC on x86, the generic timer virtual counter on AArch64 and
+ * CLOCK_MONOTONIC_RAW elsewhere. Tick length is given by
+ * latency_seconds_per_tick().
+ *
+ * @return Current tick count
+ */
+inline uint64_t latency_ticks() {
+#if defined(__x86_64__) || defined(__i386__)
+    return __rdtsc();
+#elif defined(__aarch64__)
+    uint64_t ticks;
+    asm volatile("mrs %0, cntvct_el0" : "=r"(ticks));
+    return ticks;
+#else
+    timespec ts;
+    clock_gettime(CLOCK_MONOTONIC_RAW, &ts);
+    return static_cast<uint64_t>(ts.tv_sec) * 1000000000ULL + static_cast<uint64_t>(ts.tv_nsec);
+#endif
+}
+
+/**
+ * @brief Duration of one latency clock tick
+ *
+ * Calibrated once against CLOCK_MONOTONIC_RAW on first call when the TSC
+ * is in use; read from CNTFRQ_EL0 on AArch64.
+ *
+ * @return Seconds per tick
+ */
+double latency_seconds_per_tick();
+
+/**
+ * @brief Register (or look up) a latency histogram
+ *
+ * Samples are recorded in latency clock ticks and exported in seconds.
+ * Registered histograms are included in dump_latency_stats().
+ *
+ * @param name Metric name (should end in "_seconds")
+ * @param help Help text
+ * @return Histogram reference
+ */
+Histogram& latency_histogram(const std::string& name, const std::string& help);
+
+/**
+ * @brief Summarize a latency histogram
+ *
+ * @param hist Histogram registered via latency_histogram()
+ * @return JSON object with count, p50_ns, p99_ns, p999_ns, max_ns
+ */
+nlohmann::json latency_summary(const Histogram& hist);
+
+/**
+ * @brief Summaries of every registered latency histogram
+ *
+ * @return JSON object keyed by metric name
+ */
+nlohmann::json latency_stats();
+
+/**
+ * @brief Log summaries of every registered latency histogram
+ */
+void dump_latency_stats();
+
+/**
+ * @brief Scoped timer recording its lifetime into a latency histogram
+ */
+class ScopedLatency {
+public:
+    explicit ScopedLatency(Histogram& hist) : hist_(hist), start_(latency_ticks()) {}
+    ~ScopedLatency() { hist_.record(latency_ticks() - start_); }
+
+    ScopedLatency(const ScopedLatency&) = delete;
+    ScopedLatency& operator=(const ScopedLatency&) = delete;
+
+private:
+    Histogram& hist_;
+    uint64_t start_;
+};
+
+} // namespace core
+} // namespace environet
@@ -1,7 +1,12 @@
 #pragma once
 
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <time.h>
 #include <string>
 #include <memory>
+#include <nlohmann/json.hpp>
 #include <spdlog/spdlog.h>
 #include <spdlog/sinks/rotating_file_sink.h>
 #include <spdlog/sinks/stdout_color_sinks.h>
@@ -11,38 +16,170 @@ namespace core {
 
 /**
  * @brief Initialize the logging system
- * 
- * Sets up rotating file logger and console logger with specified level
- * 
+ *
+ * Sets up rotating file logger and console logger with specified level.
+ * In async mode records are formatted and written by a background thread
+ * fed from a preallocated queue, so callers never wait on console or disk.
+ *
  * @param level Log level (trace, debug, info, warn, error, critical)
  * @param file_path Path to log file (optional, defaults to console only)
  * @param max_size Maximum size of each log file in MB (default: 5MB)
  * @param max_files Maximum number of log files to keep (default: 3)
+ * @param async Log through a background thread (default: false)
+ * @param async_queue_size Number of preallocated queue slots in async mode
+ * @param overflow_policy "block" (wait for a free slot) or "overrun_oldest"
+ *                        (drop the oldest queued record) when the queue is full
+ * @param on_thread_start Called on the async writer thread when it starts;
+ *                        must not log
  */
-void init_logger(const std::string& level = "info", 
-                 const std::string& file_path = "", 
+void init_logger(const std::string& level = "info",
+                 const std::string& file_path = "",
                  size_t max_size = 5 * 1024 * 1024,  // 5MB
-                 size_t max_files = 3);
+                 size_t max_files = 3,
+                 bool async = false,
+                 size_t async_queue_size = 8192,
+                 const std::string& overflow_policy = "overrun_oldest",
+                 std::function<void()> on_thread_start = nullptr);
 
 /**
  * @brief Get the main logger instance
- * 
+ *
  * @return Shared pointer to the main logger
  */
 std::shared_ptr<spdlog::logger> get_logger();
 
+/**
+ * @brief Change the log level of the running logger and its sinks
+ *
+ * @param level Log level (trace, debug, info, warn, error, critical)
+ */
+void set_log_level(const std::string& level);
+
 /**
  * @brief Shutdown logging system gracefully
  */
 void shutdown_logger();
 
+/**
+ * @brief Get logging statistics
+ *
+ * @return JSON object with async queue depth, overruns and records
+ *         suppressed by rate limiting
+ */
+nlohmann::json get_log_stats();
+
+namespace detail {
+extern std::atomic<spdlog::logger*> g_logger_raw;
+spdlog::logger* fallback_logger();
+void count_suppressed();
+} // namespace detail
+
+/**
+ * @brief Raw pointer to the main logger, used by the logging macros
+ *
+ * A single atomic load with no reference counting. Loggers replaced by
+ * init_logger() or shutdown_logger() are retired rather than destroyed,
+ * so a pointer obtained here stays valid for the life of the process.
+ *
+ * @return Logger pointer (never null)
+ */
+inline spdlog::logger* logger_ptr() {
+    spdlog::logger* logger = detail::g_logger_raw.load(std::memory_order_acquire);
+    return logger ? logger : detail::fallback_logger();
+}
+
+/**
+ * @brief Per-call-site rate limiter: at most one record per interval
+ */
+class LogRateLimiter {
+public:
+    explicit LogRateLimiter(uint64_t interval_ms) : interval_ms_(interval_ms) {}
+
+    /**
+     * @brief Check whether the call site may log now
+     *
+     * @return true for the first call of each interval
+     */
+    bool allow() {
+        // Coarse clock: a few ns per read, tick resolution is plenty here
+        timespec ts;
+        clock_gettime(CLOCK_MONOTONIC_COARSE, &ts);
+        uint64_t now = static_cast<uint64_t>(ts.tv_sec) * 1000ULL + static_cast<uint64_t>(ts.tv_nsec) / 1000000ULL;
+        uint64_t next = next_ms_.load(std::memory_order_relaxed);
+        if (now >= next && next_ms_.compare_exchange_strong(next, now + interval_ms_, std::memory_order_relaxed)) {
+            return true;
+        }
+        detail::count_suppressed();
+        return false;
+    }
+
+private:
+    const uint64_t interval_ms_;
+    std::atomic<uint64_t> next_ms_{0};
+};
+
+/**
+ * @brief Per-call-site sampler: logs the 1st, (n+1)th, (2n+1)th... call
+ */
+class LogSampler {
+public:
+    explicit LogSampler(uint64_t n) : n_(n ? n : 1) {}
+
+    /**
+     * @brief Check whether this call is sampled
+     *
+     * @return true once every n calls
+     */
+    bool allow() {
+        if (count_.fetch_add(1, std::memory_order_relaxed) % n_ == 0) return true;
+        detail::count_suppressed();
+        return false;
+    }
+
+private:
+    const uint64_t n_;
+    std::atomic<uint64_t> count_{0};
+};
+
 } // namespace core
 } // namespace environet
 
 // Convenient logging macros
-#define LOGI(...) SPDLOG_LOGGER_INFO(environet::core::get_logger(), __VA_ARGS__)
-#define LOGW(...) SPDLOG_LOGGER_WARN(environet::core::get_logger(), __VA_ARGS__)
-#define LOGE(...) SPDLOG_LOGGER_ERROR(environet::core::get_logger(), __VA_ARGS__)
-#define LOGD(...) SPDLOG_LOGGER_DEBUG(environet::core::get_logger(), __VA_ARGS__)
-#define LOGT(...) SPDLOG_LOGGER_TRACE(environet::core::get_logger(), __VA_ARGS__)
-#define LOGC(...) SPDLOG_LOGGER_CRITICAL(environet::core::get_logger(), __VA_ARGS__)
+#define LOGI(...) SPDLOG_LOGGER_INFO(environet::core::logger_ptr(), __VA_ARGS__)
+#define LOGW(...) SPDLOG_LOGGER_WARN(environet::core::logger_ptr(), __VA_ARGS__)
+#define LOGE(...) SPDLOG_LOGGER_ERROR(environet::core::logger_ptr(), __VA_ARGS__)
+#define LOGD(...) SPDLOG_LOGGER_DEBUG(environet::core::logger_ptr(), __VA_ARGS__)
+#define LOGT(...) SPDLOG_LOGGER_TRACE(environet::core::logger_ptr(), __VA_ARGS__)
+#define LOGC(...) SPDLOG_LOGGER_CRITICAL(environet::core::logger_ptr(), __VA_ARGS__)
+
+// Level check first, then a limiter private to the call site
+#define ENVIRONET_LOG_LIMITED_(limiter, limit, lvl, ...)                                              \
+    do {                                                                                              \
+        spdlog::logger* environet_logger_ = environet::core::logger_ptr();                            \
+        if (environet_logger_->should_log(lvl)) {                                                     \
+            static environet::core::limiter environet_limiter_(limit);                                \
+            if (environet_limiter_.allow()) {                                                         \
+                environet_logger_->log(spdlog::source_loc{__FILE__, __LINE__, SPDLOG_FUNCTION}, lvl,  \
+                                       __VA_ARGS__);                                                  \
+            }                                                                                         \
+        }                                                                                             \
+    } while (0)
+
+// Hot-path logging: at most once per interval_ms, or once every n calls
+#define LOGI_RATELIMITED(interval_ms, ...) \
+    ENVIRONET_LOG_LIMITED_(LogRateLimiter, interval_ms, spdlog::level::info, __VA_ARGS__)
+#define LOGW_RATELIMITED(interval_ms, ...) \
+    ENVIRONET_LOG_LIMITED_(LogRateLimiter, interval_ms, spdlog::level::warn, __VA_ARGS__)
+#define LOGE_RATELIMITED(interval_ms, ...) \
+    ENVIRONET_LOG_LIMITED_(LogRateLimiter, interval_ms, spdlog::level::err, __VA_ARGS__)
+#define LOGI_EVERY_N(n, ...) ENVIRONET_LOG_LIMITED_(LogSampler, n, spdlog::level::info, __VA_ARGS__)
+#define LOGW_EVERY_N(n, ...) ENVIRONET_LOG_LIMITED_(LogSampler, n, spdlog::level::warn, __VA_ARGS__)
+
+#if SPDLOG_ACTIVE_LEVEL <= SPDLOG_LEVEL_DEBUG
+#define LOGD_RATELIMITED(interval_ms, ...) \
+    ENVIRONET_LOG_LIMITED_(LogRateLimiter, interval_ms, spdlog::level::debug, __VA_ARGS__)
+#define LOGD_EVERY_N(n, ...) ENVIRONET_LOG_LIMITED_(LogSampler, n, spdlog::level::debug, __VA_ARGS__)
+#else
+#define LOGD_RATELIMITED(interval_ms, ...) (void)0
+#define LOGD_EVERY_N(n, ...) (void)0
+#endif
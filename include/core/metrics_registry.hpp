@@ -0,0 +1,349 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+#include <nlohmann/json.hpp>
+
+namespace environet {
+namespace core {
+
+/**
+ * @brief Number of stripes used by sharded metrics
+ *
+ * Each thread is assigned one stripe on first use so concurrent writers
+ * rarely touch the same cache line.
+ */
+constexpr size_t kMetricShards = 8;
+
+/**
+ * @brief Label set attached to a metric (name/value pairs)
+ */
+using MetricLabels = std::vector<std::pair<std::string, std::string>>;
+
+/**
+ * @brief Get the metric shard assigned to the calling thread
+ *
+ * @return Shard index in [0, kMetricShards)
+ */
+inline size_t metric_shard_index() {
+    static std::atomic<size_t> next_shard{0};
+    thread_local size_t index = next_shard.fetch_add(1, std::memory_order_relaxed) % kMetricShards;
+    return index;
+}
+
+/**
+ * @brief Monotonic counter sharded across threads
+ *
+ * Increments are a single relaxed atomic add on the caller's shard;
+ * reads sum all shards.
+ */
+class Counter {
+public:
+    /**
+     * @brief Add to the counter
+     *
+     * @param n Amount to add (default 1)
+     */
+    void inc(uint64_t n = 1) {
+        shards_[metric_shard_index()].value.fetch_add(n, std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief Get the current counter value
+     *
+     * @return Sum over all shards
+     */
+    uint64_t value() const {
+        uint64_t total = 0;
+        for (const auto& s : shards_) total += s.value.load(std::memory_order_relaxed);
+        return total;
+    }
+
+private:
+    struct alignas(64) Shard {
+        std::atomic<uint64_t> value{0};
+    };
+    std::array<Shard, kMetricShards> shards_;
+};
+
+/**
+ * @brief Gauge holding a single floating-point value
+ */
+class Gauge {
+public:
+    /**
+     * @brief Set the gauge value
+     *
+     * @param v New value
+     */
+    void set(double v) { bits_.store(to_bits(v), std::memory_order_relaxed); }
+
+    /**
+     * @brief Add to the gauge value (may be negative)
+     *
+     * @param delta Amount to add
+     */
+    void add(double delta) {
+        uint64_t cur = bits_.load(std::memory_order_relaxed);
+        while (!bits_.compare_exchange_weak(cur, to_bits(from_bits(cur) + delta),
+                                            std::memory_order_relaxed)) {
+        }
+    }
+
+    /**
+     * @brief Get the current gauge value
+     *
+     * @return Current value
+     */
+    double value() const { return from_bits(bits_.load(std::memory_order_relaxed)); }
+
+private:
+    static uint64_t to_bits(double v) { uint64_t b; std::memcpy(&b, &v, sizeof(b)); return b; }
+    static double from_bits(uint64_t b) { double v; std::memcpy(&v, &b, sizeof(v)); return v; }
+
+    std::atomic<uint64_t> bits_{0};
+};
+
+/**
+ * @brief Log-linear histogram of unsigned integer samples
+ *
+ * Values are bucketed HDR-style: exact below 8, then 8 linear sub-buckets
+ * per power of two (relative error <= 12.5%). Every recording thread gets
+ * its own single-writer shard on first use, so record() is a handful of
+ * relaxed loads and stores with no locked instructions; snapshot() merges
+ * the shards.
+ */
+class Histogram {
+public:
+    static constexpr int kSubBucketBits = 3;
+    static constexpr size_t kSubBuckets = size_t{1} << kSubBucketBits;
+    static constexpr size_t kBucketCount = (64 - kSubBucketBits + 1) * kSubBuckets;
+
+    /**
+     * @brief Merged view of a histogram at a point in time
+     */
+    struct Snapshot {
+        uint64_t count = 0;
+        uint64_t sum = 0;
+        uint64_t max = 0;
+        std::array<uint64_t, kBucketCount> buckets{};
+
+        /**
+         * @brief Estimate a quantile
+         *
+         * @param q Quantile in [0, 1]
+         * @return Estimated value (bucket midpoint, clamped to max)
+         */
+        uint64_t percentile(double q) const;
+
+        /**
+         * @brief Mean of recorded samples
+         *
+         * @return Mean value, or 0 if empty
+         */
+        double mean() const { return count ? static_cast<double>(sum) / count : 0.0; }
+    };
+
+    /**
+     * @brief Constructor
+     *
+     * @param unit_scale Factor converting recorded units to exported units
+     *                   (e.g. 1e-9 to export nanosecond samples as seconds)
+     */
+    explicit Histogram(double unit_scale = 1.0);
+
+    Histogram(const Histogram&) = delete;
+    Histogram& operator=(const Histogram&) = delete;
+
+    /**
+     * @brief Record a sample
+     *
+     * @param v Sample value
+     */
+    void record(uint64_t v) {
+        Shard* s = local_shard();
+        bump(s->buckets[bucket_index(v)], 1);
+        bump(s->count, 1);
+        bump(s->sum, v);
+        if (v > s->max.load(std::memory_order_relaxed)) s->max.store(v, std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief Merge all shards into a snapshot
+     *
+     * @return Snapshot of the current state
+     */
+    Snapshot snapshot() const;
+
+    /**
+     * @brief Factor applied to values on export
+     */
+    double unit_scale() const { return unit_scale_; }
+
+    /**
+     * @brief Map a value to its bucket index
+     *
+     * @param v Sample value
+     * @return Bucket index in [0, kBucketCount)
+     */
+    static size_t bucket_index(uint64_t v) {
+        if (v < kSubBuckets) return static_cast<size_t>(v);
+        int exp = 63 - __builtin_clzll(v);
+        size_t sub = static_cast<size_t>(v >> (exp - kSubBucketBits)) & (kSubBuckets - 1);
+        return static_cast<size_t>(exp - kSubBucketBits + 1) * kSubBuckets + sub;
+    }
+
+    /**
+     * @brief Smallest value mapped to a bucket
+     *
+     * @param index Bucket index
+     * @return Lower bound (inclusive)
+     */
+    static uint64_t bucket_lower_bound(size_t index);
+
+    /**
+     * @brief Largest value mapped to a bucket
+     *
+     * @param index Bucket index
+     * @return Upper bound (inclusive)
+     */
+    static uint64_t bucket_upper_bound(size_t index);
+
+private:
+    struct alignas(64) Shard {
+        std::atomic<uint64_t> count{0};
+        std::atomic<uint64_t> sum{0};
+        std::atomic<uint64_t> max{0};
+        std::array<std::atomic<uint64_t>, kBucketCount> buckets{};
+    };
+
+    // Single-writer increment: readers only ever load, so no RMW is needed
+    static void bump(std::atomic<uint64_t>& a, uint64_t n) {
+        a.store(a.load(std::memory_order_relaxed) + n, std::memory_order_relaxed);
+    }
+
+    // Per-thread shard pointers indexed by histogram id
+    static std::vector<Shard*>& thread_shards() {
+        thread_local std::vector<Shard*> shards;
+        return shards;
+    }
+
+    Shard* local_shard() {
+        auto& shards = thread_shards();
+        if (id_ < shards.size() && shards[id_]) return shards[id_];
+        return attach_thread_shard();
+    }
+
+    Shard* attach_thread_shard();
+
+    const size_t id_;
+    double unit_scale_;
+    mutable std::mutex shards_mutex_;
+    std::vector<std::unique_ptr<Shard>> shards_;
+};
+
+/**
+ * @brief Process-wide registry of counters, gauges and histograms
+ *
+ * Registration is a cold path guarded by a mutex and returns a reference
+ * that stays valid for the lifetime of the process; registering the same
+ * name and labels twice returns the existing metric. Updates on the
+ * returned objects are lock-free.
+ */
+class MetricsRegistry {
+public:
+    /**
+     * @brief Get the global registry
+     *
+     * @return Registry instance
+     */
+    static MetricsRegistry& instance();
+
+    /**
+     * @brief Register (or look up) a counter
+     *
+     * @param name Metric name (Prometheus convention, e.g. "environet_x_total")
+     * @param help Help text
+     * @param labels Optional label set
+     * @return Counter reference
+     * @throws std::invalid_argument if name is registered with another type
+     */
+    Counter& counter(const std::string& name, const std::string& help,
+                     const MetricLabels& labels = {});
+
+    /**
+     * @brief Register (or look up) a gauge
+     *
+     * @param name Metric name
+     * @param help Help text
+     * @param labels Optional label set
+     * @return Gauge reference
+     * @throws std::invalid_argument if name is registered with another type
+     */
+    Gauge& gauge(const std::string& name, const std::string& help,
+                 const MetricLabels& labels = {});
+
+    /**
+     * @brief Register (or look up) a histogram
+     *
+     * @param name Metric name
+     * @param help Help text
+     * @param unit_scale Factor converting recorded units to exported units
+     * @param labels Optional label set
+     * @return Histogram reference
+     * @throws std::invalid_argument if name is registered with another type
+     */
+    Histogram& histogram(const std::string& name, const std::string& help,
+                         double unit_scale = 1.0, const MetricLabels& labels = {});
+
+    /**
+     * @brief Render all metrics in Prometheus text exposition format
+     *
+     * @param openmetrics Emit OpenMetrics 1.0 text (adds "# EOF")
+     * @return Exposition text
+     */
+    std::string render_prometheus(bool openmetrics = false) const;
+
+    /**
+     * @brief Get all metrics as JSON
+     *
+     * @return JSON object keyed by metric name
+     */
+    nlohmann::json to_json() const;
+
+private:
+    enum class Type { Counter, Gauge, Histogram };
+
+    struct Family {
+        Type type;
+        std::string help;
+        std::map<std::string, std::unique_ptr<Counter>> counters;
+        std::map<std::string, std::unique_ptr<Gauge>> gauges;
+        std::map<std::string, std::unique_ptr<Histogram>> histograms;
+    };
+
+    MetricsRegistry() = default;
+    Family& family(const std::string& name, const std::string& help, Type type);
+
+    mutable std::mutex mutex_;
+    std::map<std::string, Family> families_;
+};
+
+/**
+ * @brief Format a label set as a Prometheus label block
+ *
+ * @param labels Label set
+ * @return e.g. {iface="wlan0"}, or empty string when there are no labels
+ */
+std::string format_metric_labels(const MetricLabels& labels);
+
+} // namespace core
+} // namespace environet
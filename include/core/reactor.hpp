@@ -0,0 +1,179 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include <nlohmann/json.hpp>
+
+namespace environet {
+namespace core {
+
+/**
+ * @brief Single-threaded epoll event loop
+ *
+ * Timers (timerfd), signals (signalfd), arbitrary file descriptors and
+ * tasks posted from other threads (eventfd) are all dispatched from run()
+ * on the thread that calls it, which sleeps until one of them is due.
+ * Callbacks must not block; hand blocking work to a WorkerPool.
+ *
+ * Handlers are added and removed from the loop thread or before run();
+ * other threads use post() to get code onto the loop thread.
+ */
+class Reactor {
+public:
+    using Callback = std::function<void()>;
+    using FdCallback = std::function<void(uint32_t events)>;
+    using SignalCallback = std::function<void(int signo)>;
+
+    Reactor();
+    ~Reactor();
+
+    Reactor(const Reactor&) = delete;
+    Reactor& operator=(const Reactor&) = delete;
+
+    /**
+     * @brief Create the epoll instance and wake-up eventfd
+     *
+     * @return true if successful, false otherwise
+     */
+    bool init();
+
+    /**
+     * @brief Add a periodic timer
+     *
+     * @param interval Period between callbacks
+     * @param callback Called on the loop thread each time the timer fires
+     * @param first Delay before the first call (zero fires as soon as possible)
+     * @return Timer id, or -1 on error
+     */
+    int add_timer(std::chrono::milliseconds interval, Callback callback, std::chrono::milliseconds first);
+
+    /**
+     * @brief Add a periodic timer whose first call is one interval away
+     */
+    int add_timer(std::chrono::milliseconds interval, Callback callback) {
+        return add_timer(interval, std::move(callback), interval);
+    }
+
+    /**
+     * @brief Change a timer's period; the next call is one new period away
+     *
+     * @param id Timer id from add_timer()
+     * @param interval New period
+     * @return true if successful, false otherwise
+     */
+    bool set_timer_interval(int id, std::chrono::milliseconds interval);
+
+    /**
+     * @brief Receive signals through a signalfd
+     *
+     * The signals must be blocked in every thread (see block_signals()) or
+     * they may be delivered the default way instead.
+     *
+     * @param signals Signals to receive
+     * @param callback Called on the loop thread with each received signal
+     * @return true if successful, false otherwise
+     */
+    bool add_signals(const std::vector<int>& signals, SignalCallback callback);
+
+    /**
+     * @brief Watch a file descriptor
+     *
+     * @param fd Descriptor to watch (not owned)
+     * @param events epoll event mask (EPOLLIN, ...)
+     * @param callback Called on the loop thread with the ready events
+     * @return true if successful, false otherwise
+     */
+    bool add_fd(int fd, uint32_t events, FdCallback callback);
+
+    /**
+     * @brief Stop watching a file descriptor or timer
+     *
+     * @param fd Descriptor passed to add_fd() or timer id
+     * @return true if it was registered
+     */
+    bool remove(int fd);
+
+    /**
+     * @brief Run a task on the loop thread (thread-safe)
+     *
+     * @param task Task to run
+     */
+    void post(Callback task);
+
+    /**
+     * @brief Dispatch events until stop() is called
+     */
+    void run();
+
+    /**
+     * @brief Make run() return after the current callback (thread-safe)
+     */
+    void stop();
+
+    /**
+     * @brief Block signals in the calling thread
+     *
+     * Call at the top of main() before any thread is started; new threads
+     * inherit the mask, so the signals only arrive through add_signals().
+     *
+     * @param signals Signals to block
+     * @return true if successful, false otherwise
+     */
+    static bool block_signals(const std::vector<int>& signals);
+
+    /**
+     * @brief Get loop statistics
+     *
+     * @return JSON object with wakeup, timer, signal and task counts
+     */
+    nlohmann::json get_stats() const;
+
+    /**
+     * @brief Get last error message
+     *
+     * @return Error message string
+     */
+    std::string get_last_error() const;
+
+private:
+    enum class Kind { Fd, Timer, Signal };
+    struct Handler {
+        Kind kind;
+        Callback callback;
+        FdCallback fd_callback;
+        SignalCallback signal_callback;
+    };
+
+    bool watch(int fd, uint32_t events, std::shared_ptr<Handler> handler);
+    void dispatch(int fd, uint32_t events);
+    void drain_posted();
+    void set_error(const std::string& error);
+
+    int epoll_fd_ = -1;
+    int wake_fd_ = -1;
+    std::unordered_map<int, std::shared_ptr<Handler>> handlers_;
+    std::atomic<bool> stop_requested_{false};
+
+    std::mutex post_mutex_;
+    std::deque<Callback> posted_;
+
+    std::atomic<uint64_t> wakeups_{0};
+    std::atomic<uint64_t> timer_fires_{0};
+    std::atomic<uint64_t> timer_overruns_{0};
+    std::atomic<uint64_t> signals_{0};
+    std::atomic<uint64_t> tasks_{0};
+
+    mutable std::mutex error_mutex_;
+    std::string last_error_;
+};
+
+} // namespace core
+} // namespace environet
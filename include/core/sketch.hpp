@@ -0,0 +1,262 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+namespace environet {
+namespace core {
+
+/**
+ * @brief Hash a short byte string to 64 bits
+ *
+ * Multiply-rotate over 8-byte words with a murmur3 finalizer; meant for
+ * addresses and other keys of a few dozen bytes, not for adversarial input.
+ *
+ * @param data Bytes to hash
+ * @param len Number of bytes
+ * @param seed Seed for independent hash families
+ * @return 64-bit hash
+ */
+inline uint64_t hash64(const void* data, size_t len, uint64_t seed = 0) {
+    constexpr uint64_t K1 = 0x9e3779b97f4a7c15ULL, K2 = 0xc2b2ae3d27d4eb4fULL;
+    const auto* p = static_cast<const uint8_t*>(data);
+    uint64_t h = seed ^ (len * K1);
+    while (len >= 8) {
+        uint64_t w;
+        std::memcpy(&w, p, 8);
+        h ^= w * K2;
+        h = ((h << 31) | (h >> 33)) * K1;
+        p += 8;
+        len -= 8;
+    }
+    if (len > 0) {
+        uint64_t w = 0;
+        std::memcpy(&w, p, len);
+        h ^= w * K2;
+        h = ((h << 31) | (h >> 33)) * K1;
+    }
+    h ^= h >> 33;
+    h *= 0xff51afd7ed558ccdULL;
+    h ^= h >> 33;
+    h *= 0xc4ceb9fe1a85ec53ULL;
+    h ^= h >> 33;
+    return h;
+}
+
+/**
+ * @brief Count-Min sketch of per-key totals
+ *
+ * Fixed memory (width x depth counters) regardless of how many keys are
+ * added. estimate() never undercounts and overcounts by at most
+ * e/width of total() with probability 1 - e^-depth. Two sketches of the
+ * same shape merge by adding counters.
+ */
+class CountMinSketch {
+public:
+    /**
+     * @brief Create a sketch
+     *
+     * @param width Counters per row (rounded up to a power of two)
+     * @param depth Number of rows
+     */
+    explicit CountMinSketch(size_t width = 512, size_t depth = 4);
+
+    /**
+     * @brief Add to a key's count
+     *
+     * @param hash Key hash (from hash64)
+     * @param count Amount to add
+     */
+    void add(uint64_t hash, uint64_t count = 1) {
+        uint64_t h2 = (hash >> 32) | 1;
+        for (size_t row = 0; row < depth_; ++row) {
+            counters_[row * width_ + ((hash + row * h2) & mask_)] += count;
+        }
+        total_ += count;
+    }
+
+    /**
+     * @brief Estimate a key's count (upper bound)
+     *
+     * @param hash Key hash
+     * @return Smallest counter over the key's cells
+     */
+    uint64_t estimate(uint64_t hash) const;
+
+    /**
+     * @brief Add another sketch of the same shape into this one
+     *
+     * @param other Sketch to merge
+     * @return false if the shapes differ (nothing merged)
+     */
+    bool merge(const CountMinSketch& other);
+
+    /**
+     * @brief Reset all counters
+     */
+    void clear();
+
+    /**
+     * @brief Get the sum of all counts added
+     */
+    uint64_t total() const { return total_; }
+
+    /**
+     * @brief Get the memory held by the counters in bytes
+     */
+    size_t memory_bytes() const { return counters_.size() * sizeof(uint64_t); }
+
+private:
+    size_t width_;
+    size_t depth_;
+    uint64_t mask_;
+    std::vector<uint64_t> counters_;
+    uint64_t total_ = 0;
+};
+
+/**
+ * @brief Space-Saving top-K heavy hitters
+ *
+ * Tracks at most capacity() keys. A new key evicts the smallest entry and
+ * inherits its count as error, so every key whose true count exceeds
+ * total/capacity is present and each count is an upper bound within
+ * error of the truth. Keys are stored inline so updates never allocate.
+ * Merging keeps the capacity; counts stay upper bounds.
+ */
+class SpaceSaving {
+public:
+    static constexpr size_t KEY_SIZE = 48;  // Longest key kept, including the terminator
+
+    struct Entry {
+        uint64_t hash = 0;          // Key hash
+        uint64_t count = 0;         // Upper bound on the key's count
+        uint64_t error = 0;         // Maximum overcount
+        char key[KEY_SIZE] = {};    // Key text (truncated to KEY_SIZE - 1)
+    };
+
+    /**
+     * @brief Create a summary
+     *
+     * @param capacity Number of keys tracked
+     */
+    explicit SpaceSaving(size_t capacity = 16);
+
+    /**
+     * @brief Add to a key's count
+     *
+     * @param hash Key hash
+     * @param key Key text, stored when the key enters the summary
+     * @param len Length of @p key
+     * @param count Amount to add
+     */
+    void add(uint64_t hash, const char* key, size_t len, uint64_t count = 1);
+
+    /**
+     * @brief Merge another summary into this one
+     *
+     * @param other Summary to merge
+     */
+    void merge(const SpaceSaving& other);
+
+    /**
+     * @brief Get the tracked entries, largest first
+     *
+     * @param k Maximum number of entries
+     * @return Entries sorted by count
+     */
+    std::vector<Entry> top(size_t k) const;
+
+    /**
+     * @brief Get the tracked entries in no particular order
+     */
+    const std::vector<Entry>& entries() const { return entries_; }
+
+    /**
+     * @brief Reset to empty
+     */
+    void clear() { entries_.clear(); }
+
+    /**
+     * @brief Get the number of keys tracked when full
+     */
+    size_t capacity() const { return capacity_; }
+
+    /**
+     * @brief Get the smallest tracked count (0 while not full)
+     */
+    uint64_t min_count() const;
+
+private:
+    size_t capacity_;
+    std::vector<Entry> entries_;    // Reserved for 2 x capacity so merge() does not allocate
+};
+
+/**
+ * @brief HyperLogLog distinct-key counter
+ *
+ * 2^precision one-byte registers hold the longest run of leading zeros
+ * seen per hash prefix; the estimate's relative standard error is about
+ * 1.04 / sqrt(2^precision) (3.3% at precision 10, 1 KiB) however many
+ * keys are added. Counters of the same precision merge by register max,
+ * so per-thread or per-window counters combine losslessly.
+ */
+class HyperLogLog {
+public:
+    /**
+     * @brief Create a counter
+     *
+     * @param precision Index bits, clamped to 4..16
+     */
+    explicit HyperLogLog(int precision = 10);
+
+    /**
+     * @brief Add a key
+     *
+     * @param hash Key hash (from hash64); adding the same key again has no effect
+     */
+    void add(uint64_t hash) {
+        size_t index = static_cast<size_t>(hash >> (64 - precision_));
+        uint64_t rest = (hash << precision_) | (1ULL << (precision_ - 1));
+        uint8_t rank = static_cast<uint8_t>(__builtin_clzll(rest) + 1);
+        if (rank > registers_[index]) registers_[index] = rank;
+    }
+
+    /**
+     * @brief Estimate the number of distinct keys added
+     *
+     * @return Estimate, using linear counting while many registers are empty
+     */
+    double estimate() const;
+
+    /**
+     * @brief Merge another counter of the same precision into this one
+     *
+     * @param other Counter to merge
+     * @return false if the precisions differ (nothing merged)
+     */
+    bool merge(const HyperLogLog& other);
+
+    /**
+     * @brief Reset to empty
+     */
+    void clear();
+
+    /**
+     * @brief Get the number of index bits
+     */
+    int precision() const { return precision_; }
+
+    /**
+     * @brief Get the memory held by the registers in bytes
+     */
+    size_t memory_bytes() const { return registers_.size(); }
+
+private:
+    int precision_;
+    std::vector<uint8_t> registers_;
+};
+
+} // namespace core
+} // namespace environet
@@ -0,0 +1,175 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include <nlohmann/json.hpp>
+
+#include "core/metrics_registry.hpp"
+
+namespace environet {
+namespace core {
+
+/**
+ * @brief Work-stealing thread pool for CPU-bound analysis
+ *
+ * Every worker owns a deque: it pushes and pops its own tasks at the back
+ * (newest first, cache-warm) while idle workers steal the oldest task from
+ * the front of another worker's deque. Thieves scan the workers after
+ * their own index first, so with pinned workers they steal from
+ * neighbouring CPUs before distant ones. Idle workers sleep on a
+ * condition variable.
+ *
+ * Unlike WorkerPool (blocking jobs such as subprocesses), tasks here are
+ * expected to be short and compute-bound.
+ */
+class TaskPool {
+public:
+    using Task = std::function<void()>;
+
+    TaskPool();
+    ~TaskPool();
+
+    TaskPool(const TaskPool&) = delete;
+    TaskPool& operator=(const TaskPool&) = delete;
+
+    /**
+     * @brief Start the workers
+     *
+     * @param workers Number of workers (0 = one per available CPU)
+     * @param pin_workers Pin worker i to the i-th available CPU
+     * @return true if successful, false otherwise
+     */
+    bool start(size_t workers = 0, bool pin_workers = false);
+
+    /**
+     * @brief Stop the workers
+     *
+     * Tasks still queued run on the calling thread before this returns.
+     */
+    void stop();
+
+    /**
+     * @brief Get the number of running workers
+     */
+    size_t size() const { return running_.load(std::memory_order_acquire) ? queues_.size() : 0; }
+
+    /**
+     * @brief Queue a task
+     *
+     * Called from a worker, the task goes on that worker's own deque;
+     * otherwise deques are filled round-robin. Runs the task inline when
+     * the pool is not running.
+     *
+     * @param task Task to run
+     */
+    void submit(Task task);
+
+    /**
+     * @brief Run one queued task on the calling thread
+     *
+     * @return true if a task was run, false if every deque was empty
+     */
+    bool run_one();
+
+    /**
+     * @brief Call fn(i) for every i in [begin, end), split across the pool
+     *
+     * The range is cut into chunks of @p grain indices; the caller runs
+     * the first chunk and then helps with queued tasks until every chunk
+     * is done, so it is safe to call from inside a task. The first
+     * exception thrown by fn is rethrown on the caller.
+     *
+     * @param begin First index
+     * @param end One past the last index
+     * @param grain Indices per task (at least 1)
+     * @param fn Callable taking a size_t index
+     */
+    template <typename Fn>
+    void parallel_for(size_t begin, size_t end, size_t grain, Fn&& fn);
+
+    /**
+     * @brief Get pool statistics
+     *
+     * @return JSON object with task, steal and queue depth figures
+     */
+    nlohmann::json get_stats() const;
+
+private:
+    struct alignas(64) Queue {
+        std::mutex mutex;
+        std::deque<Task> tasks;
+    };
+
+    void worker_loop(size_t index);
+    bool pop_local(size_t index, Task& task);
+    bool steal(size_t thief, Task& task);
+    void execute(Task& task);
+    void queued(int64_t delta);
+
+    std::vector<std::unique_ptr<Queue>> queues_;
+    std::vector<std::thread> workers_;
+    std::atomic<bool> running_{false};
+    bool pinned_ = false;
+    std::atomic<size_t> next_queue_{0};
+    std::atomic<int64_t> pending_{0};
+    std::atomic<uint64_t> tasks_{0};
+    std::atomic<uint64_t> stolen_{0};
+
+    std::mutex sleep_mutex_;
+    std::condition_variable sleep_cv_;
+
+    Counter& tasks_run_;
+    Counter& steals_;
+    Gauge& queue_depth_;
+};
+
+template <typename Fn>
+void TaskPool::parallel_for(size_t begin, size_t end, size_t grain, Fn&& fn) {
+    if (begin >= end) return;
+    if (grain == 0) grain = 1;
+    const size_t chunks = (end - begin + grain - 1) / grain;
+    if (!running_.load(std::memory_order_acquire) || chunks == 1) {
+        for (size_t i = begin; i < end; ++i) fn(i);
+        return;
+    }
+
+    // Lives on the caller's stack; the caller does not return until every chunk has finished
+    struct Group {
+        std::atomic<size_t> remaining;
+        std::mutex error_mutex;
+        std::exception_ptr error;
+    } group;
+    group.remaining.store(chunks, std::memory_order_relaxed);
+
+    auto run_chunk = [&fn, &group, begin, end, grain](size_t chunk) {
+        size_t lo = begin + chunk * grain;
+        size_t hi = lo + grain < end ? lo + grain : end;
+        try {
+            for (size_t i = lo; i < hi; ++i) fn(i);
+        } catch (...) {
+            std::lock_guard<std::mutex> lock(group.error_mutex);
+            if (!group.error) group.error = std::current_exception();
+        }
+        group.remaining.fetch_sub(1, std::memory_order_acq_rel);
+    };
+
+    for (size_t chunk = 1; chunk < chunks; ++chunk) {
+        submit([&run_chunk, chunk]() { run_chunk(chunk); });
+    }
+    run_chunk(0);
+    while (group.remaining.load(std::memory_order_acquire) != 0) {
+        if (!run_one()) std::this_thread::yield();
+    }
+    if (group.error) std::rethrow_exception(group.error);
+}
+
+} // namespace core
+} // namespace environet
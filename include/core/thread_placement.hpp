@@ -0,0 +1,104 @@
+#pragma once
+
+#include <map>
+#include <mutex>
+#include <string>
+#include <vector>
+#include <sys/types.h>
+#include <nlohmann/json.hpp>
+
+#include "core/config.hpp"
+
+namespace environet {
+namespace core {
+
+/**
+ * @brief CPU, scheduling and NUMA placement of the pipeline threads
+ *
+ * Each long-lived pipeline thread calls apply() with its role (capture,
+ * writer, sensor, correlation, metrics) as soon as it starts; the settings
+ * from the `threads` config section are applied to that thread only.
+ * Failures such as EPERM for SCHED_FIFO without CAP_SYS_NICE leave the
+ * thread running with its inherited placement and are reported in the
+ * stats. get_stats() reads the live placement of every registered thread
+ * from the kernel, so changes made with taskset or chrt show up as well.
+ */
+class ThreadPlacement {
+public:
+    /**
+     * @brief Get the global placement registry
+     *
+     * @return ThreadPlacement instance
+     */
+    static ThreadPlacement& instance();
+
+    ThreadPlacement() = default;
+    ThreadPlacement(const ThreadPlacement&) = delete;
+    ThreadPlacement& operator=(const ThreadPlacement&) = delete;
+
+    /**
+     * @brief Set the placement used by later apply() calls
+     *
+     * @param threads Per-role placement settings
+     */
+    void configure(const Config::ThreadsConfig& threads);
+
+    /**
+     * @brief Apply the placement for a role to the calling thread
+     *
+     * Does not log, so it is safe to call from the log writer thread.
+     *
+     * @param role Thread role (capture, writer, sensor, correlation, metrics)
+     * @param memory_node NUMA node preferred for the thread's allocations (-1 = leave as is)
+     * @return true if every setting was applied, false otherwise (see get_last_error())
+     */
+    bool apply(const std::string& role, int memory_node = -1);
+
+    /**
+     * @brief Get the live placement of every registered thread
+     *
+     * @return JSON object mapping each role to a list of threads
+     */
+    nlohmann::json get_stats() const;
+
+    /**
+     * @brief Get the last error message
+     *
+     * @return Last error message
+     */
+    std::string get_last_error() const;
+
+    /**
+     * @brief Look up the NUMA node a network interface is attached to
+     *
+     * @param iface Interface name
+     * @return Node number, or -1 for virtual interfaces and non-NUMA systems
+     */
+    static int interface_numa_node(const std::string& iface);
+
+    /**
+     * @brief Set the preferred NUMA node for the calling thread's allocations
+     *
+     * Pages the kernel allocates on the thread's behalf (such as a packet
+     * socket's capture ring) follow the same policy.
+     *
+     * @param node Node number, or -1 to restore the default local policy
+     * @return true if successful, false otherwise
+     */
+    static bool set_memory_node(int node);
+
+private:
+    struct Entry {
+        pid_t tid = 0;
+        int memory_node = -1;
+        std::string error;
+    };
+
+    Config::ThreadsConfig threads_;
+    std::map<std::string, std::vector<Entry>> entries_;
+    mutable std::mutex mutex_;
+    std::string last_error_;
+};
+
+} // namespace core
+} // namespace environet
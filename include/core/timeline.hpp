@@ -0,0 +1,182 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <nlohmann/json.hpp>
+
+#include "core/latency.hpp"
+
+namespace environet {
+namespace core {
+
+/**
+ * @brief One slot of the timeline ring
+ *
+ * Names must be string literals (or otherwise outlive the process); only
+ * the pointer is stored.
+ */
+struct TimelineEvent {
+    std::atomic<uint64_t> seq{0};   // 2*index+1 while being written, 2*index+2 when complete
+    uint64_t ticks = 0;             // latency_ticks() at event start
+    uint64_t dur_ticks = 0;         // Slice duration ('X' events)
+    int64_t value = 0;              // Counter value ('C' events)
+    const char* name = nullptr;
+    uint32_t tid = 0;
+    char phase = 0;                 // 'X' slice, 'C' counter, 'i' instant
+};
+
+/**
+ * @brief Timeline of pipeline activity exported in Chrome trace format
+ *
+ * Threads record slices, counters and instants into a fixed-size
+ * overwrite ring shared by all threads (one atomic increment per event).
+ * The ring keeps the most recent events; dump() writes the last N
+ * seconds as Chrome trace JSON, which chrome://tracing and the Perfetto
+ * UI both open. Recording costs a single atomic load when disabled.
+ */
+class Timeline {
+public:
+    /**
+     * @brief Get the global timeline
+     *
+     * @return Timeline instance
+     */
+    static Timeline& instance();
+
+    Timeline() = default;
+    Timeline(const Timeline&) = delete;
+    Timeline& operator=(const Timeline&) = delete;
+
+    /**
+     * @brief Allocate the ring (first call only) and start recording
+     *
+     * @param capacity Ring size in events (rounded up to a power of two)
+     */
+    void enable(size_t capacity = 262144);
+
+    /**
+     * @brief Stop recording; buffered events remain available to dump()
+     */
+    void disable() { enabled_.store(false, std::memory_order_relaxed); }
+
+    /**
+     * @brief Check whether events are currently recorded
+     */
+    bool enabled() const { return enabled_.load(std::memory_order_acquire); }
+
+    /**
+     * @brief Record a completed slice
+     *
+     * @param name Slice name (string literal)
+     * @param start_ticks latency_ticks() at slice start
+     * @param end_ticks latency_ticks() at slice end
+     */
+    void slice(const char* name, uint64_t start_ticks, uint64_t end_ticks) {
+        if (enabled()) record('X', name, start_ticks, end_ticks - start_ticks, 0);
+    }
+
+    /**
+     * @brief Record a counter sample (queue depth, buffer size, ...)
+     *
+     * @param name Counter name (string literal)
+     * @param value Current value
+     */
+    void counter(const char* name, int64_t value) {
+        if (enabled()) record('C', name, latency_ticks(), 0, value);
+    }
+
+    /**
+     * @brief Record an instant event
+     *
+     * @param name Event name (string literal)
+     */
+    void instant(const char* name) {
+        if (enabled()) record('i', name, latency_ticks(), 0, 0);
+    }
+
+    /**
+     * @brief Name the calling thread in dumped traces
+     *
+     * @param name Thread name
+     */
+    void set_thread_name(const std::string& name);
+
+    /**
+     * @brief Render the last @p last_seconds of events as Chrome trace JSON
+     *
+     * @param last_seconds Window to export (<= 0 exports the whole ring)
+     * @return JSON document text
+     */
+    std::string to_chrome_json(double last_seconds) const;
+
+    /**
+     * @brief Write the last @p last_seconds of events to a file
+     *
+     * @param path Output file path (.json)
+     * @param last_seconds Window to export (<= 0 exports the whole ring)
+     * @return true if successful, false otherwise
+     */
+    bool dump(const std::string& path, double last_seconds);
+
+    /**
+     * @brief Get timeline statistics
+     *
+     * @return JSON object with enabled flag, capacity and events recorded
+     */
+    nlohmann::json get_stats() const;
+
+    /**
+     * @brief Get last error message
+     *
+     * @return Error message string
+     */
+    std::string get_last_error() const;
+
+private:
+    void record(char phase, const char* name, uint64_t ticks, uint64_t dur_ticks, int64_t value);
+
+    std::atomic<bool> enabled_{false};
+    std::atomic<uint64_t> next_{0};
+    std::unique_ptr<TimelineEvent[]> ring_;
+    size_t mask_ = 0;
+
+    mutable std::mutex mutex_;
+    std::map<uint32_t, std::string> thread_names_;
+    std::string last_error_;
+};
+
+/**
+ * @brief Scoped slice recorded into the global timeline
+ */
+class ScopedTimelineSlice {
+public:
+    explicit ScopedTimelineSlice(const char* name)
+        : name_(Timeline::instance().enabled() ? name : nullptr), start_(name_ ? latency_ticks() : 0) {}
+    ~ScopedTimelineSlice() {
+        if (name_) Timeline::instance().slice(name_, start_, latency_ticks());
+    }
+
+    ScopedTimelineSlice(const ScopedTimelineSlice&) = delete;
+    ScopedTimelineSlice& operator=(const ScopedTimelineSlice&) = delete;
+
+private:
+    const char* name_;
+    uint64_t start_;
+};
+
+} // namespace core
+} // namespace environet
+
+#define ENVIRONET_TIMELINE_CONCAT_(a, b) a##b
+#define ENVIRONET_TIMELINE_CONCAT(a, b) ENVIRONET_TIMELINE_CONCAT_(a, b)
+
+// Timeline instrumentation (no-ops until Timeline::instance().enable())
+#define TIMELINE_SCOPE(name) \
+    environet::core::ScopedTimelineSlice ENVIRONET_TIMELINE_CONCAT(environet_timeline_slice_, __LINE__)(name)
+#define TIMELINE_COUNTER(name, value) \
+    environet::core::Timeline::instance().counter(name, static_cast<int64_t>(value))
+#define TIMELINE_INSTANT(name) environet::core::Timeline::instance().instant(name)
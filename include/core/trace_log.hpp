@@ -0,0 +1,305 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include <nlohmann/json.hpp>
+
+#include "core/latency.hpp"
+
+namespace environet {
+namespace core {
+
+/**
+ * @brief Event types stored in the binary trace
+ */
+enum class TraceEventType : uint8_t {
+    Packet = 1,
+    Sensor = 2,
+    Bss = 3,
+    Finding = 4,
+};
+
+#pragma pack(push, 1)
+/**
+ * @brief Packet metadata (addresses in network byte order)
+ */
+struct TracePacket {
+    uint32_t length;            // Length on the wire
+    uint16_t ethertype;
+    uint8_t protocol;           // IP protocol number
+    uint8_t ip_version;         // 4, 6 or 0 when not IP
+    uint16_t src_port;
+    uint16_t dst_port;
+    uint8_t src_mac[6];
+    uint8_t dst_mac[6];
+    uint8_t src_ip[16];         // IPv4 uses the first 4 bytes
+    uint8_t dst_ip[16];
+    int16_t signal_dbm;         // Radiotap signal, 0 if unknown
+    uint8_t reserved[6];
+};
+
+/**
+ * @brief Sensor frame as read from the Arduino
+ */
+struct TraceSensor {
+    uint32_t ts_ms;             // Arduino timestamp
+    int16_t ir_raw;
+    uint16_t ultra_mm;
+    uint8_t status;
+    uint8_t reserved[55];
+};
+
+/**
+ * @brief One BSS from a WiFi scan
+ */
+struct TraceBss {
+    int32_t signal_mbm;
+    int32_t freq;
+    int16_t channel;
+    uint8_t bssid[6];
+    char ssid[33];              // NUL-terminated, truncated
+    uint8_t connected;
+    uint8_t reserved[14];
+};
+
+/**
+ * @brief Correlator finding summary
+ */
+struct TraceFinding {
+    float ir_raw_delta;
+    float ultra_distance_delta;
+    float rssi_avg;
+    float rssi_delta;
+    float ping_latency_delta;
+    float throughput_delta;
+    uint8_t sensor_status;
+    char event_type[39];        // NUL-terminated, truncated
+};
+
+/**
+ * @brief Fixed-size trace record (80 bytes)
+ */
+struct TraceRecord {
+    uint64_t ticks;             // latency_ticks() at record time
+    uint8_t type;               // TraceEventType
+    uint8_t reserved;
+    uint16_t thread;            // Writer thread index
+    uint32_t seq;               // Per-thread sequence number (gaps = drops)
+    union {
+        TracePacket packet;
+        TraceSensor sensor;
+        TraceBss bss;
+        TraceFinding finding;
+        uint8_t raw[64];
+    };
+};
+
+/**
+ * @brief Trace file header, repeated at the start of every rotated file
+ */
+struct TraceFileHeader {
+    char magic[8];              // "ENVTRACE"
+    uint32_t version;
+    uint32_t record_size;
+    double seconds_per_tick;    // Tick length of TraceRecord::ticks
+    uint64_t base_ticks;        // Tick count at base_realtime_ns
+    uint64_t base_realtime_ns;  // CLOCK_REALTIME in ns at base_ticks
+    uint8_t reserved[24];
+};
+#pragma pack(pop)
+
+static_assert(sizeof(TraceRecord) == 80, "TraceRecord layout changed");
+static_assert(sizeof(TraceFileHeader) == 64, "TraceFileHeader layout changed");
+
+constexpr uint32_t kTraceVersion = 1;
+
+/**
+ * @brief Binary event trace with per-thread lock-free buffers
+ *
+ * Each writing thread gets its own single-producer ring of fixed-size
+ * records on first use; after that begin()/commit() write straight into
+ * the ring and never block or allocate. A background thread drains all rings into a
+ * rotating file. When a ring is full the record is dropped and counted,
+ * so memory stays bounded at buffer_records * sizeof(TraceRecord) per
+ * writing thread.
+ */
+class TraceLog {
+public:
+    /**
+     * @brief Get the global trace log
+     *
+     * @return Trace log instance
+     */
+    static TraceLog& instance();
+
+    TraceLog();
+    ~TraceLog();
+
+    TraceLog(const TraceLog&) = delete;
+    TraceLog& operator=(const TraceLog&) = delete;
+
+    /**
+     * @brief Open the trace file and start the flusher thread
+     *
+     * @param path Trace file path (rotated files get .1, .2, ... suffixes)
+     * @param max_file_bytes Rotate once a file exceeds this size
+     * @param max_files Number of files to keep, including the current one
+     * @param buffer_records Ring capacity per writing thread (rounded up to a power of two)
+     * @param flush_interval_ms Flusher wake-up interval
+     * @return true if successful, false otherwise
+     */
+    bool start(const std::string& path, uint64_t max_file_bytes, int max_files,
+               size_t buffer_records = 65536, int flush_interval_ms = 20);
+
+    /**
+     * @brief Stop recording, drain all buffers and close the file
+     */
+    void stop();
+
+    /**
+     * @brief Check whether records are currently accepted
+     */
+    bool enabled() const { return enabled_.load(std::memory_order_relaxed); }
+
+    /**
+     * @brief Reserve the next record slot for the calling thread
+     *
+     * Fill the returned record's payload, then call commit(). Returns
+     * nullptr (and counts a drop) when tracing is disabled or the
+     * thread's ring is full.
+     *
+     * @param type Event type
+     * @return Record to fill, or nullptr
+     */
+    TraceRecord* begin(TraceEventType type);
+
+    /**
+     * @brief Publish the record returned by the last begin()
+     */
+    void commit();
+
+    /**
+     * @brief Get trace statistics
+     *
+     * @return JSON object with written, dropped, files and buffer counts
+     */
+    nlohmann::json get_stats() const;
+
+    /**
+     * @brief Get last error message
+     *
+     * @return Error message string
+     */
+    std::string get_last_error() const;
+
+private:
+    struct Ring;
+
+    Ring* local_ring();
+    void flush_loop();
+    size_t drain(Ring& ring);
+    bool open_file();
+    void rotate_file();
+    void set_error(const std::string& error);
+
+    const size_t id_;
+    std::atomic<bool> enabled_{false};
+    std::atomic<bool> running_{false};
+    std::atomic<uint64_t> records_written_{0};
+    std::atomic<uint64_t> records_dropped_{0};
+    std::atomic<uint64_t> files_rotated_{0};
+
+    std::string path_;
+    uint64_t max_file_bytes_ = 0;
+    int max_files_ = 1;
+    size_t buffer_records_ = 0;
+    int flush_interval_ms_ = 20;
+    int fd_ = -1;
+    uint64_t file_bytes_ = 0;
+
+    mutable std::mutex rings_mutex_;
+    std::vector<std::shared_ptr<Ring>> rings_;
+    std::thread flusher_;
+    std::mutex wake_mutex_;
+    std::condition_variable wake_cv_;
+    mutable std::mutex error_mutex_;
+    std::string last_error_;
+};
+
+/**
+ * @brief Sequential reader for trace files
+ */
+class TraceReader {
+public:
+    TraceReader() = default;
+    ~TraceReader();
+
+    TraceReader(const TraceReader&) = delete;
+    TraceReader& operator=(const TraceReader&) = delete;
+
+    /**
+     * @brief Open a trace file and validate its header
+     *
+     * @param path Trace file path
+     * @return true if successful, false otherwise
+     */
+    bool open(const std::string& path);
+
+    /**
+     * @brief Read the next record
+     *
+     * @param record Output record
+     * @return false at end of file (a truncated trailing record is ignored)
+     */
+    bool next(TraceRecord& record);
+
+    /**
+     * @brief Convert record ticks to wall-clock time
+     *
+     * @param ticks TraceRecord::ticks
+     * @return Nanoseconds since the Unix epoch
+     */
+    uint64_t to_realtime_ns(uint64_t ticks) const;
+
+    /**
+     * @brief Header of the open file
+     */
+    const TraceFileHeader& header() const { return header_; }
+
+    /**
+     * @brief Get last error message
+     */
+    std::string get_last_error() const { return last_error_; }
+
+private:
+    FILE* file_ = nullptr;
+    TraceFileHeader header_{};
+    std::string last_error_;
+};
+
+/**
+ * @brief Convert a trace record to JSON
+ *
+ * @param record Trace record
+ * @param realtime_ns Wall-clock timestamp of the record
+ * @return JSON object with type-specific fields
+ */
+nlohmann::json trace_record_to_json(const TraceRecord& record, uint64_t realtime_ns);
+
+/**
+ * @brief Get the name of a trace event type
+ *
+ * @param type TraceRecord::type
+ * @return "packet", "sensor", "bss", "finding" or "unknown"
+ */
+const char* trace_event_name(uint8_t type);
+
+} // namespace core
+} // namespace environet
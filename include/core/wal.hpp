@@ -0,0 +1,205 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <nlohmann/json.hpp>
+
+namespace environet {
+namespace core {
+
+/**
+ * @brief Segmented append-only write-ahead log
+ *
+ * Records get consecutive log sequence numbers (LSNs) starting at 1 and
+ * are stored in segment files named after their first LSN
+ * (<dir>/<lsn>.wal). Each record is framed as
+ *
+ *   u32 payload length, u32 CRC-32 of (LSN, payload), u64 LSN, payload
+ *
+ * (little-endian). append() only buffers; sync() writes the buffer and
+ * fdatasyncs it, and concurrent callers share one fdatasync (group
+ * commit). Only synced records are returned by read().
+ *
+ * open() scans every segment, verifying lengths, CRCs and LSN order. A
+ * torn or corrupt tail in the newest segment is truncated; in an older
+ * segment the rest of that segment is skipped. Segments whose records
+ * were all released are deleted, and when the total size exceeds the
+ * limit the oldest segments are deleted whether released or not.
+ *
+ * LSNs restart at 1 when open() finds no segments, so each such start
+ * writes a new random epoch to <dir>/epoch. Readers that remember LSNs
+ * across restarts compare epochs to tell a wiped log from the same one.
+ */
+class WriteAheadLog {
+public:
+    static constexpr size_t RECORD_HEADER_SIZE = 16;
+    static constexpr size_t MAX_RECORD_SIZE = 64 * 1024 * 1024;
+
+    /**
+     * @brief Create a log (call open() before use)
+     *
+     * @param dir Directory holding the segments
+     * @param segment_bytes Start a new segment once the current one reaches this size
+     * @param max_bytes Delete the oldest segments beyond this total size
+     */
+    WriteAheadLog(std::string dir, size_t segment_bytes, size_t max_bytes);
+
+    /**
+     * @brief Destructor (syncs and closes)
+     */
+    ~WriteAheadLog();
+
+    WriteAheadLog(const WriteAheadLog&) = delete;
+    WriteAheadLog& operator=(const WriteAheadLog&) = delete;
+
+    /**
+     * @brief Create the directory if needed and recover existing segments
+     *
+     * @return true if successful, false otherwise
+     */
+    bool open();
+
+    /**
+     * @brief Sync and close the current segment
+     */
+    void close();
+
+    /**
+     * @brief Buffer a record (thread-safe)
+     *
+     * @param payload Record bytes (at most MAX_RECORD_SIZE)
+     * @return LSN of the record, or 0 if the log is not open or the record is too large
+     */
+    uint64_t append(std::string_view payload);
+
+    /**
+     * @brief Make every record appended so far durable (thread-safe)
+     *
+     * @return false if writing or fdatasync failed
+     */
+    bool sync();
+
+    /**
+     * @brief Read synced records in LSN order
+     *
+     * Starting inside a gap (evicted or corrupt records) starts at the
+     * next retained record. A call never crosses a gap, so the records
+     * passed to @p fn are always consecutive.
+     *
+     * @param from_lsn First LSN wanted
+     * @param max_records Maximum number of records
+     * @param max_bytes Stop before the payloads exceed this many bytes (at least one record is read)
+     * @param fn Called with each record's LSN and payload
+     * @return Number of records read
+     */
+    size_t read(uint64_t from_lsn, size_t max_records, size_t max_bytes,
+                const std::function<void(uint64_t, std::string_view)>& fn);
+
+    /**
+     * @brief Mark records up to an LSN as no longer needed
+     *
+     * Segments made up only of released records are deleted, except the
+     * one being written.
+     *
+     * @param lsn Highest released LSN
+     */
+    void release(uint64_t lsn);
+
+    /**
+     * @brief Get the oldest LSN still on disk (next_lsn() when empty)
+     */
+    uint64_t first_lsn() const;
+
+    /**
+     * @brief Get the LSN the next append() will get
+     */
+    uint64_t next_lsn() const;
+
+    /**
+     * @brief Get the epoch of the LSN sequence (non-zero once open)
+     */
+    uint64_t epoch() const;
+
+    /**
+     * @brief Get the highest synced LSN (0 if none)
+     */
+    uint64_t synced_lsn() const;
+
+    /**
+     * @brief Get the total size of all segments in bytes (excluding unsynced records)
+     */
+    uint64_t size_bytes() const;
+
+    /**
+     * @brief Get log statistics
+     *
+     * @return JSON object with record, sync, segment, eviction and recovery counters
+     */
+    nlohmann::json get_stats() const;
+
+    /**
+     * @brief Get last error message
+     *
+     * @return Error message string
+     */
+    std::string get_last_error() const;
+
+private:
+    struct Segment {
+        uint64_t first_lsn;
+        uint64_t last_lsn;          // first_lsn - 1 while empty
+        uint64_t bytes;
+        std::string path;
+    };
+
+    bool recover_segment(Segment& seg, bool newest);
+    int create_segment(uint64_t first_lsn, std::string& path);
+    bool load_epoch(bool fresh);
+    void drop_segments();
+    void set_error(const std::string& error);
+
+    std::string dir_;
+    size_t segment_bytes_;
+    size_t max_bytes_;
+
+    mutable std::mutex mutex_;
+    std::condition_variable synced_cv_;
+    std::deque<Segment> segments_;  // Oldest first; the last one is written
+    std::string buffer_;            // Appended, not yet written
+    uint64_t buffered_records_ = 0;
+    int fd_ = -1;
+    uint64_t next_lsn_ = 1;
+    uint64_t epoch_ = 0;
+    uint64_t synced_lsn_ = 0;
+    uint64_t released_lsn_ = 0;
+    uint64_t total_bytes_ = 0;
+    bool syncing_ = false;          // A sync leader is writing outside the lock
+
+    // Position after the last read(), so sequential reads do not rescan segments
+    uint64_t hint_lsn_ = 0;
+    uint64_t hint_segment_ = 0;
+    uint64_t hint_offset_ = 0;
+
+    // Statistics (guarded by mutex_)
+    uint64_t records_appended_ = 0;
+    uint64_t bytes_appended_ = 0;
+    uint64_t syncs_ = 0;
+    uint64_t records_synced_ = 0;
+    uint64_t records_evicted_ = 0;
+    uint64_t segments_evicted_ = 0;
+    uint64_t corrupt_records_ = 0;
+    uint64_t recovered_records_ = 0;
+    uint64_t recovered_bytes_ = 0;
+    double recovery_ms_ = 0.0;
+
+    mutable std::mutex error_mutex_;
+    std::string last_error_;
+};
+
+} // namespace core
+} // namespace environet
@@ -0,0 +1,73 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+#include "core/http_server.hpp"
+
+namespace environet {
+namespace core {
+
+/**
+ * @brief WebSocket frame opcodes (RFC 6455)
+ */
+enum class WsOpcode : uint8_t {
+    Continuation = 0x0,
+    Text = 0x1,
+    Binary = 0x2,
+    Close = 0x8,
+    Ping = 0x9,
+    Pong = 0xA,
+};
+
+/**
+ * @brief One frame received from a client
+ */
+struct WsFrame {
+    WsOpcode opcode = WsOpcode::Text;
+    bool fin = true;
+    std::string payload;        // Unmasked
+};
+
+/**
+ * @brief Check whether a request asks for a WebSocket upgrade
+ *
+ * @param req Parsed request
+ * @return true for a version 13 upgrade request with a key
+ */
+bool is_websocket_upgrade(const HttpRequest& req);
+
+/**
+ * @brief Compute the Sec-WebSocket-Accept value for a client key
+ *
+ * @param key Sec-WebSocket-Key header value
+ * @return Base64 SHA-1 of the key and the RFC 6455 GUID
+ */
+std::string websocket_accept(const std::string& key);
+
+/**
+ * @brief Append an unmasked (server to client) frame
+ *
+ * @param out Buffer to append to
+ * @param opcode Frame opcode
+ * @param data Payload
+ * @param len Payload length
+ */
+void append_websocket_frame(std::string& out, WsOpcode opcode, const void* data, size_t len);
+
+/**
+ * @brief Take one client frame off the front of a buffer
+ *
+ * Client frames must be masked; an unmasked frame or one larger than
+ * @p max_payload is a protocol error.
+ *
+ * @param in Received bytes; the frame is removed when complete
+ * @param frame Receives the frame
+ * @param max_payload Largest payload accepted
+ * @return 1 if a frame was taken, 0 if more bytes are needed, -1 on a protocol error
+ */
+int take_websocket_frame(std::string& in, WsFrame& frame, size_t max_payload = 64 * 1024);
+
+} // namespace core
+} // namespace environet
@@ -0,0 +1,85 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include <nlohmann/json.hpp>
+
+namespace environet {
+namespace core {
+
+/**
+ * @brief Small fixed pool of threads for blocking work
+ *
+ * Jobs that shell out or wait on the network (WiFi scans, ping, iperf3)
+ * run here so the event loop never blocks. Idle workers sleep on a
+ * condition variable; there is no polling.
+ */
+class WorkerPool {
+public:
+    using Job = std::function<void()>;
+    using ThreadHook = std::function<void()>;
+
+    WorkerPool() = default;
+    ~WorkerPool();
+
+    WorkerPool(const WorkerPool&) = delete;
+    WorkerPool& operator=(const WorkerPool&) = delete;
+
+    /**
+     * @brief Start the worker threads
+     *
+     * @param threads Number of workers
+     * @param name Thread name prefix (workers are named name-0, name-1, ...)
+     * @param on_thread_start Called on each worker before it takes its first job
+     * @return true if successful, false otherwise
+     */
+    bool start(size_t threads, const std::string& name = "worker", ThreadHook on_thread_start = nullptr);
+
+    /**
+     * @brief Queue a job
+     *
+     * @param job Job to run on a worker
+     * @return true if queued, false if the pool is not running
+     */
+    bool submit(Job job);
+
+    /**
+     * @brief Stop the workers
+     *
+     * Queued jobs that have not started are dropped; running jobs are
+     * waited for.
+     */
+    void stop();
+
+    /**
+     * @brief Get pool statistics
+     *
+     * @return JSON object with worker count, queue depth and job counts
+     */
+    nlohmann::json get_stats() const;
+
+private:
+    void worker_loop(size_t index);
+
+    std::string name_;
+    ThreadHook on_thread_start_;
+    std::vector<std::thread> workers_;
+    mutable std::mutex mutex_;
+    std::condition_variable cv_;
+    std::deque<Job> queue_;
+    bool running_ = false;
+
+    std::atomic<uint64_t> completed_{0};
+    std::atomic<uint64_t> dropped_{0};
+    std::atomic<size_t> active_{0};
+};
+
+} // namespace core
+} // namespace environet
@@ -3,8 +3,11 @@
 #include <string>
 #include <vector>
 #include <queue>
+#include <atomic>
 #include <mutex>
 #include <memory>
+#include <memory_resource>
+#include <string_view>
 #include <chrono>
 #include <functional>
 #include <nlohmann/json.hpp>
@@ -14,44 +17,75 @@
 #include "net/wifi_scan.hpp"         // BssInfo
 #include "net/pcap_sniffer.hpp"      // PacketMeta
 #include "net/metrics.hpp"           // PingStats, Iperf3Results
+#include "net/dns_analyzer.hpp"
+#include "net/throughput.hpp"
+#include "net/traffic_accounting.hpp"
+#include "core/arena.hpp"
+#include "core/config.hpp"
+#include "core/json_writer.hpp"
+#include "core/metrics_registry.hpp"
+#include "core/task_pool.hpp"
 
 namespace environet {
 namespace correlate {
 
+class LiveFeed;
+
 /**
  * @brief Finding structure for correlation results
  * 
- * Contains correlated environmental and network data
+ * Contains correlated environmental and network data. Allocator-aware:
+ * the strings and network list come from the memory resource given at
+ * construction (the default heap if none), so findings can be built in a
+ * per-tick arena and kept in a pool.
  */
 struct Finding {
-    uint64_t timestamp_ms;      // Timestamp when finding was generated
-    std::string event_type;     // Type of event (motion, signal_drop, etc.)
-    std::string description;    // Human-readable description
+    using allocator_type = std::pmr::polymorphic_allocator<char>;
+
+    uint64_t timestamp_ms = 0;  // Timestamp when finding was generated
+    std::pmr::string event_type; // Type of event (motion, signal_drop, etc.)
+    std::pmr::string description; // Human-readable description
     
     // Sensor data
-    double ir_raw_delta;        // Change in IR sensor reading
-    double ultra_distance_delta; // Change in ultrasonic distance
-    uint8_t sensor_status;      // Sensor status flags
+    double ir_raw_delta = 0.0;  // Change in IR sensor reading
+    double ultra_distance_delta = 0.0; // Change in ultrasonic distance
+    uint8_t sensor_status = 0;  // Sensor status flags
     
     // Network data
-    double rssi_avg;            // Average RSSI during correlation window
-    double rssi_delta;          // RSSI change during correlation window
-    double ping_latency_delta;  // Change in ping latency
-    double packet_loss_delta;   // Change in packet loss
-    double throughput_delta;    // Change in throughput
+    double rssi_avg = 0.0;      // Average RSSI during correlation window
+    double rssi_delta = 0.0;    // RSSI change during correlation window
+    double ping_latency_delta = 0.0; // Change in ping latency
+    double packet_loss_delta = 0.0; // Change in packet loss
+    double throughput_delta = 0.0; // Change in throughput (Mbps; passive capture, else iperf3)
+    double dns_latency_delta = 0.0; // Change in mean DNS response time (ms)
+    double dns_failure_delta = 0.0; // Change in share of DNS queries failed (SERVFAIL or timeout, %)
     
     // Correlation metadata
-    int correlation_window_ms;  // Correlation window size in milliseconds
-    int sensor_threshold;       // Sensor threshold that triggered correlation
-    std::vector<std::string> affected_networks; // Networks affected by event
-    
-    // Default constructor
-    Finding() : timestamp_ms(0), ir_raw_delta(0.0), ultra_distance_delta(0.0), 
-                 sensor_status(0), rssi_avg(0.0), rssi_delta(0.0), 
-                 ping_latency_delta(0.0), packet_loss_delta(0.0), 
-                 throughput_delta(0.0), correlation_window_ms(0), sensor_threshold(0) {}
+    int correlation_window_ms = 0; // Correlation window size in milliseconds
+    int sensor_threshold = 0;   // Sensor threshold that triggered correlation
+    std::pmr::vector<std::pmr::string> affected_networks; // Networks affected by event
+    std::pmr::vector<std::pmr::string> affected_hosts; // Devices whose traffic volume shifted
+    
+    Finding() = default;
+    explicit Finding(const allocator_type& alloc)
+        : event_type(alloc), description(alloc), affected_networks(alloc), affected_hosts(alloc) {}
+    // Allocator-extended copy/move: contents are copied into alloc's resource
+    Finding(const Finding& other, const allocator_type& alloc) : Finding(alloc) { *this = other; }
+    Finding(Finding&& other, const allocator_type& alloc) : Finding(alloc) { *this = std::move(other); }
+    Finding(const Finding&) = default;
+    Finding(Finding&&) = default;
+    Finding& operator=(const Finding&) = default;
+    Finding& operator=(Finding&&) = default;
 };
 
+/**
+ * @brief Write a finding as a JSON object
+ *
+ * @param out Writer positioned where a value may go
+ * @param finding Finding to write
+ */
+void write_finding(core::JsonWriter& out, const Finding& finding);
+
 /**
  * @brief Time-series data point
  * 
@@ -73,10 +107,17 @@ struct TimeSeriesPoint {
  */
 class Correlator {
 public:
+    /**
+     * @brief Construct from a shared configuration snapshot
+     * 
+     * @param config Configuration snapshot (must not be null)
+     */
+    explicit Correlator(std::shared_ptr<const core::Config> config);
+
     /**
      * @brief Constructor
      * 
-     * @param config_path Path to configuration file
+     * @param config_path Path to configuration file (parsed once, defaults if unreadable)
      */
     explicit Correlator(const std::string& config_path);
     
@@ -98,6 +139,14 @@ public:
      * @param frame Sensor frame data
      */
     void push_sensor(const sensors::SensorFrame& frame);
+
+    /**
+     * @brief Add sensor data stamped with a given time
+     * 
+     * @param now_ms Time in milliseconds (steady clock)
+     * @param frame Sensor frame data
+     */
+    void push_sensor_at(uint64_t now_ms, const sensors::SensorFrame& frame);
     
     /**
      * @brief Add WiFi BSS information to correlation buffer
@@ -105,6 +154,14 @@ public:
      * @param bss BSS information
      */
     void push_bss(const net::BssInfo& bss);
+
+    /**
+     * @brief Add WiFi BSS information stamped with a given time
+     * 
+     * @param now_ms Time in milliseconds (steady clock)
+     * @param bss BSS information
+     */
+    void push_bss_at(uint64_t now_ms, const net::BssInfo& bss);
     
     /**
      * @brief Add packet metadata to correlation buffer
@@ -119,6 +176,14 @@ public:
      * @param ping_stats Ping statistics
      */
     void push_ping_stats(const net::PingStats& ping_stats);
+
+    /**
+     * @brief Add ping statistics stamped with a given time
+     * 
+     * @param now_ms Time in milliseconds (steady clock)
+     * @param ping_stats Ping statistics
+     */
+    void push_ping_stats_at(uint64_t now_ms, const net::PingStats& ping_stats);
     
     /**
      * @brief Add iperf3 results to correlation buffer
@@ -126,13 +191,64 @@ public:
      * @param iperf_results iperf3 test results
      */
     void push_iperf3_results(const net::Iperf3Results& iperf_results);
+
+    /**
+     * @brief Add a passive throughput bucket to correlation buffer
+     * 
+     * Stamped with the bucket start rather than the time of the call.
+     * 
+     * @param sample Bytes and packets per direction on one interface
+     */
+    void push_throughput(const net::ThroughputSample& sample);
+
+    /**
+     * @brief Drain a capture interface's throughput meter on every process() tick
+     *
+     * Call before processing starts.
+     *
+     * @param meter Meter to drain (not owned)
+     */
+    void add_throughput_meter(net::ThroughputMeter* meter) { throughput_meters_.push_back(meter); }
+
+    /**
+     * @brief Add a DNS interval to correlation buffer
+     * 
+     * Stamped with the interval start rather than the time of the call.
+     * 
+     * @param sample Query, response, error and latency counts
+     */
+    void push_dns(const net::DnsSample& sample);
+
+    /**
+     * @brief Drain a DNS analyzer on every process() tick
+     *
+     * Call before processing starts.
+     *
+     * @param dns Analyzer to drain (not owned)
+     */
+    void add_dns_analyzer(net::DnsAnalyzer* dns) { dns_analyzers_.push_back(dns); }
     
     /**
      * @brief Process correlation data and generate findings
      * 
-     * @return Vector of new findings
+     * Checks sensor frames whose correlation window has fully elapsed for
+     * changes above the sensor threshold and correlates each one with the
+     * network samples before and after it. Scratch data lives in a
+     * per-tick arena and retained findings in a pool, so a steady tick
+     * does not touch the heap. New findings go to the finding callback
+     * (which must not call process()) and get_findings().
+     * 
+     * @return Number of new findings
+     */
+    size_t process();
+
+    /**
+     * @brief Process correlation data as of a given time
+     * 
+     * @param now_ms Time in milliseconds (steady clock)
+     * @return Number of new findings
      */
-    std::vector<Finding> process();
+    size_t process_at(uint64_t now_ms);
     
     /**
      * @brief Get all findings
@@ -155,6 +271,96 @@ public:
      */
     void set_finding_callback(std::function<void(const Finding&)> callback);
     
+    /**
+     * @brief Get statistics over buffered data for a time window
+     * 
+     * @param start_time Start time in milliseconds (steady clock)
+     * @param end_time End time in milliseconds (steady clock)
+     * @return JSON object with sensor, RSSI, packet, ping, throughput, DNS and unique-device aggregates
+     */
+    nlohmann::json get_window_stats(uint64_t start_time, uint64_t end_time) const;
+
+    /**
+     * @brief Get window statistics for consecutive windows over a time range
+     *
+     * The samples in range are copied under the buffer lock in one pass;
+     * the windows are then computed from the copy, in parallel on the task
+     * pool when one is set, without blocking producers.
+     *
+     * @param start_time Start of the first window in milliseconds (steady clock)
+     * @param end_time End of the range in milliseconds (steady clock)
+     * @param step_ms Window length in milliseconds
+     * @return JSON array of window statistics, each with its "start" and "end"
+     */
+    nlohmann::json get_window_series(uint64_t start_time, uint64_t end_time, uint64_t step_ms) const;
+
+    /**
+     * @brief Write the most recent findings as a JSON array, oldest first
+     *
+     * Serialized straight from the retained findings, without copying them.
+     *
+     * @param out Writer positioned where a value may go
+     * @param since_ms Only findings generated after this time (steady clock)
+     * @param limit Maximum number of findings to write
+     * @return Number of findings written
+     */
+    size_t write_findings(core::JsonWriter& out, uint64_t since_ms, size_t limit) const;
+
+    /**
+     * @brief Write a buffered series downsampled to one point per step, as a JSON array
+     *
+     * Each point is an object with the step start "t", the sample count
+     * "n" and the series' aggregates; steps without samples are left out.
+     * Series: sensor, rssi, packets, ping, throughput, dns (see series_names()).
+     *
+     * @param out Writer positioned where a value may go
+     * @param series Series name
+     * @param start_time Start of the range in milliseconds (steady clock)
+     * @param end_time End of the range in milliseconds, exclusive (steady clock)
+     * @param step_ms Step length in milliseconds (> 0)
+     * @return false (and nothing written) if the series name is unknown
+     */
+    bool write_series(core::JsonWriter& out, std::string_view series, uint64_t start_time, uint64_t end_time,
+                      uint64_t step_ms) const;
+
+    /**
+     * @brief Names accepted by write_series()
+     */
+    static const std::vector<std::string_view>& series_names();
+
+    /**
+     * @brief Run analysis work on a task pool
+     *
+     * @param pool Pool to submit to (not owned; nullptr runs inline)
+     */
+    void set_task_pool(core::TaskPool* pool) { task_pool_ = pool; }
+
+    /**
+     * @brief Attribute sensor events to hosts whose traffic volume shifted
+     *
+     * Also adds unique-device counts to window statistics.
+     *
+     * @param accounting Per-host traffic accounting (not owned; nullptr disables)
+     */
+    void set_traffic_accounting(const net::TrafficAccounting* accounting) { accounting_ = accounting; }
+
+    /**
+     * @brief Push sensor frames, BSS samples and ping results to live subscribers
+     *
+     * @param feed Live feed (not owned; nullptr disables)
+     */
+    void set_live_feed(LiveFeed* feed) { live_feed_ = feed; }
+
+    /**
+     * @brief Apply settings that can change while running
+     *
+     * Sensor threshold and correlation window take effect on the next
+     * process() tick; buffered data is kept.
+     *
+     * @param cfg New configuration
+     */
+    void apply_config(const core::Config& cfg);
+    
     /**
      * @brief Get last error message
      * 
@@ -164,9 +370,15 @@ public:
 
 private:
     // Configuration
-    int sensor_threshold_;
-    int correlation_window_ms_;
-    std::string findings_dir_;
+    std::atomic<int> sensor_threshold_;
+    std::atomic<int> correlation_window_ms_;
+    core::TaskPool* task_pool_ = nullptr;
+    const net::TrafficAccounting* accounting_ = nullptr;
+    LiveFeed* live_feed_ = nullptr;
+    std::vector<net::ThroughputMeter*> throughput_meters_;
+    std::vector<net::ThroughputSample> drained_;    // Reused by process() (guarded by process_mutex_)
+    std::vector<net::DnsAnalyzer*> dns_analyzers_;
+    std::vector<net::DnsSample> drained_dns_;       // Reused by process() (guarded by process_mutex_)
     
     // Time-series buffers
     std::vector<TimeSeriesPoint<sensors::SensorFrame>> sensor_buffer_;
@@ -174,50 +386,73 @@ private:
     std::vector<TimeSeriesPoint<net::PacketMeta>> packet_buffer_;
     std::vector<TimeSeriesPoint<net::PingStats>> ping_buffer_;
     std::vector<TimeSeriesPoint<net::Iperf3Results>> iperf_buffer_;
+    std::vector<TimeSeriesPoint<net::ThroughputSample>> throughput_buffer_;
+    std::vector<TimeSeriesPoint<net::DnsSample>> dns_buffer_;
     
-    // Findings
-    std::vector<Finding> findings_;
+    // Findings (guarded by findings_mutex_), most recent last
+    std::pmr::unsynchronized_pool_resource finding_pool_;
+    std::pmr::vector<Finding> findings_{&finding_pool_};
+
+    // Per-tick scratch and trigger progress (guarded by process_mutex_)
+    core::TickArena tick_arena_;
+    uint64_t sensor_seq_ = 0;       // Sensor frames pushed so far (guarded by data_mutex_)
+    uint64_t sensor_checked_ = 0;   // Sensor frames already checked for triggers
     
     // Callbacks
     std::function<void(const Finding&)> finding_callback_;
     
-    // Statistics
-    uint64_t sensor_events_;
-    uint64_t network_events_;
-    uint64_t correlations_found_;
+    // Statistics (registered in the global metrics registry)
+    core::Counter& sensor_events_;
+    core::Counter& network_events_;
+    core::Counter& correlations_found_;
+    core::Histogram& push_packet_latency_;
     uint64_t start_time_ms_;
     
     // Thread safety
     mutable std::mutex data_mutex_;
     mutable std::mutex findings_mutex_;
+    mutable std::mutex process_mutex_;
     
     // Error handling
     std::string last_error_;
     
     // Private methods
-    void cleanup_old_data();
-    std::vector<Finding> correlate_sensor_event(const sensors::SensorFrame& frame);
+    void cleanup_old_data(uint64_t now);
+    bool correlate_sensor_event(const TimeSeriesPoint<sensors::SensorFrame>& point,
+                                const sensors::SensorFrame& previous, Finding& finding);
     
+    // Compact copies of the buffered samples in a time range (see correlator.cpp)
+    struct WindowSamples;
+
     /**
-     * @brief Calculate statistics for a time window
+     * @brief Copy the samples stamped in a time range, sorted by time
+     * 
+     * Holds data_mutex_ for a single pass over each buffer.
      * 
      * @param start_time Start time in milliseconds
-     * @param end_time End time in milliseconds
-     * @return JSON object with window statistics
+     * @param end_time End time in milliseconds, inclusive
+     * @param out Samples to fill
      */
-    nlohmann::json calculate_window_stats(uint64_t start_time, uint64_t end_time);
-    
+    void copy_window_samples(uint64_t start_time, uint64_t end_time, WindowSamples& out) const;
+
     /**
-     * @brief Save finding to file
+     * @brief Calculate statistics for a time window from copied samples
      * 
-     * @param finding Finding to save
+     * @param samples Samples covering at least the window
+     * @param start_time Start time in milliseconds
+     * @param end_time End time in milliseconds, inclusive
+     * @param devices Distinct devices over the window
+     * @return JSON object with window statistics
      */
-    void save_finding(const Finding& finding);
+    static nlohmann::json window_stats(const WindowSamples& samples, uint64_t start_time, uint64_t end_time,
+                                       const net::DeviceCount& devices);
     
     /**
-     * @brief Create findings directory if it doesn't exist
+     * @brief Record finding in the event trace (when tracing is enabled)
+     * 
+     * @param finding Finding to record
      */
-    void ensure_findings_dir();
+    void save_finding(const Finding& finding);
     
     /**
      * @brief Set error message
@@ -250,15 +485,6 @@ private:
      * @return Average RSSI value
      */
     double calculate_avg_rssi(uint64_t start_time, uint64_t end_time) const;
-    
-    /**
-     * @brief Calculate RSSI change for a time window
-     * 
-     * @param start_time Start time in milliseconds
-     * @param end_time End time in milliseconds
-     * @return RSSI change value
-     */
-    double calculate_rssi_delta(uint64_t start_time, uint64_t end_time) const;
 };
 
 } // namespace correlate
@@ -0,0 +1,168 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+#include <nlohmann/json.hpp>
+
+#include "core/config.hpp"
+#include "core/http_server.hpp"
+#include "net/metrics.hpp"
+#include "net/wifi_scan.hpp"
+#include "sensors/arduino_i2c.hpp"
+
+namespace environet {
+namespace correlate {
+
+struct Finding;
+
+/**
+ * @brief Topics a live feed client can subscribe to
+ */
+enum class FeedTopic : uint8_t {
+    Finding = 1,    // Each new finding
+    Ir = 2,         // Sensor frames (IR raw, ultrasonic distance, status)
+    Rssi = 3,       // BSS signal, one series per BSSID
+    Rtt = 4,        // Ping round-trip time and loss, one series per target
+};
+
+/**
+ * @brief Push channel for findings and live series
+ *
+ * Clients connect to the query API's /api/v1/stream with server-sent
+ * events or a WebSocket (JSON text frames, or with format=binary compact
+ * binary frames for series). Producers publish from the finding callback
+ * and the correlator's ingest path; each event is encoded once and queued
+ * per subscribed client.
+ *
+ * Queues are bounded per client. Findings keep the newest push.queue_size
+ * (older ones are dropped and counted). Series updates are coalesced: a
+ * client that has not taken the previous value of a series yet gets only
+ * the latest one, so a slow client sees fewer updates rather than stale
+ * ones, and memory stays at push.max_series pending values per client.
+ *
+ * Publishing with no subscribers is a relaxed atomic load.
+ */
+class LiveFeed {
+public:
+    static constexpr size_t MAX_PULL_BYTES = 64 * 1024;    // Output handed to the server per pull
+
+    /**
+     * @brief Constructor
+     *
+     * @param config Configuration snapshot (must not be null)
+     */
+    explicit LiveFeed(std::shared_ptr<const core::Config> config);
+
+    /**
+     * @brief Destructor
+     */
+    ~LiveFeed();
+
+    LiveFeed(const LiveFeed&) = delete;
+    LiveFeed& operator=(const LiveFeed&) = delete;
+
+    /**
+     * @brief Check whether pushing is enabled
+     */
+    bool enabled() const { return enabled_; }
+
+    /**
+     * @brief Accept a stream request (HttpServer stream handler)
+     *
+     * Query parameters: topics (comma-separated: findings, ir, rssi, rtt;
+     * default all) and format (json or binary; binary needs a WebSocket).
+     *
+     * @param req Request, possibly a WebSocket upgrade
+     * @param resp Receives the response head, or an error response
+     * @return Stream for the connection, or nullptr if refused (resp holds the reason)
+     */
+    std::shared_ptr<core::HttpStream> open(const core::HttpRequest& req, core::HttpResponse& resp);
+
+    /**
+     * @brief Set how to wake the server when data is queued
+     *
+     * Clear (nullptr) before the server stops.
+     *
+     * @param notify Thread-safe wake-up, e.g. HttpServer::notify
+     */
+    void set_notifier(std::function<void()> notify);
+
+    /**
+     * @brief Publish a new finding
+     *
+     * @param finding Finding (as passed to the finding callback)
+     */
+    void publish_finding(const Finding& finding);
+
+    /**
+     * @brief Publish a sensor frame
+     *
+     * @param ts_ms Time in milliseconds (steady clock)
+     * @param frame Sensor frame
+     */
+    void publish_sensor(uint64_t ts_ms, const sensors::SensorFrame& frame);
+
+    /**
+     * @brief Publish a BSS signal sample
+     *
+     * @param ts_ms Time in milliseconds (steady clock)
+     * @param bss BSS information
+     */
+    void publish_bss(uint64_t ts_ms, const net::BssInfo& bss);
+
+    /**
+     * @brief Publish ping statistics
+     *
+     * @param ts_ms Time in milliseconds (steady clock)
+     * @param ping Ping statistics
+     */
+    void publish_ping(uint64_t ts_ms, const net::PingStats& ping);
+
+    /**
+     * @brief Get the number of connected clients
+     */
+    size_t clients() const;
+
+    /**
+     * @brief Get feed statistics
+     *
+     * @return JSON object with client, message, drop and coalescing counts
+     */
+    nlohmann::json get_stats() const;
+
+private:
+    class Client;
+    struct Message;
+    friend class Client;
+
+    bool wanted(FeedTopic topic) const {
+        return subscribed_.load(std::memory_order_relaxed) & (1u << static_cast<unsigned>(topic));
+    }
+    void publish(std::shared_ptr<const Message> message);
+    void remove(Client* client);
+    void update_subscriptions();    // Requires mutex_
+
+    bool enabled_;
+    size_t max_clients_;
+    size_t queue_size_;
+    size_t max_series_;
+    std::atomic<uint32_t> subscribed_{0};      // Bit per FeedTopic with at least one client
+
+    mutable std::mutex mutex_;      // Guards clients, their queues and notify_
+    std::vector<std::shared_ptr<Client>> clients_;
+    std::function<void()> notify_;
+
+    std::atomic<uint64_t> published_{0};
+    std::atomic<uint64_t> sent_{0};
+    std::atomic<uint64_t> dropped_{0};
+    std::atomic<uint64_t> coalesced_{0};
+    std::atomic<uint64_t> refused_{0};
+};
+
+} // namespace correlate
+} // namespace environet
@@ -0,0 +1,133 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include <nlohmann/json.hpp>
+
+#include "core/config.hpp"
+#include "core/http_server.hpp"
+#include "correlate/correlator.hpp"
+#include "correlate/live_feed.hpp"
+
+namespace environet {
+namespace correlate {
+
+/**
+ * @brief Local HTTP/JSON query API over the correlator
+ *
+ * Serves, on its own HttpServer thread (TCP and/or a Unix socket):
+ *   GET /api/v1/stats                       component statistics
+ *   GET /api/v1/findings?since=&limit=      recent findings, oldest first
+ *   GET /api/v1/series?name=&from=&to=&last=&step=
+ *                                           a series downsampled to one point per step
+ *   GET /api/v1/window?from=&to=&last=&step=
+ *                                           window statistics, one window per
+ *                                           step when step is given
+ *   GET /api/v1/stream?topics=&format=      live findings and series (SSE or
+ *                                           WebSocket), when a live feed is set
+ *
+ * Times are steady-clock milliseconds, as in the correlator; every
+ * response carries "now_ms" so clients can build ranges, or use
+ * last=<ms> for the range ending now. Findings and series are written
+ * straight from the correlator's buffers with a JsonWriter.
+ */
+class QueryApi {
+public:
+    /**
+     * @brief Constructor
+     *
+     * @param config Configuration snapshot (must not be null)
+     * @param correlator Correlator to query (must outlive the API)
+     */
+    QueryApi(std::shared_ptr<const core::Config> config, const Correlator& correlator);
+
+    /**
+     * @brief Destructor (stops the server)
+     */
+    ~QueryApi();
+
+    QueryApi(const QueryApi&) = delete;
+    QueryApi& operator=(const QueryApi&) = delete;
+
+    /**
+     * @brief Set the source of /api/v1/stats
+     *
+     * Called on the server thread for each request; call before start().
+     *
+     * @param provider Returns a JSON object of component statistics
+     */
+    void set_stats_provider(std::function<nlohmann::json()> provider) { stats_provider_ = std::move(provider); }
+
+    /**
+     * @brief Serve a live feed on /api/v1/stream
+     *
+     * Call before start().
+     *
+     * @param feed Live feed (not owned; must outlive the API)
+     */
+    void set_live_feed(LiveFeed* feed) { live_feed_ = feed; }
+
+    /**
+     * @brief Start serving on the configured port and Unix socket
+     *
+     * @return true if successful, false otherwise
+     */
+    bool start();
+
+    /**
+     * @brief Stop serving
+     */
+    void stop();
+
+    /**
+     * @brief Get the bound TCP port (0 if not listening on TCP)
+     */
+    int port() const { return server_.port(); }
+
+    /**
+     * @brief Handle one request (what the server calls for each route)
+     *
+     * @param req Parsed request
+     * @return Response with a JSON body
+     */
+    core::HttpResponse handle(const core::HttpRequest& req) const;
+
+    /**
+     * @brief Get API statistics
+     *
+     * @return JSON object with request counters
+     */
+    nlohmann::json get_stats() const;
+
+    /**
+     * @brief Get last error message
+     *
+     * @return Error message string
+     */
+    std::string get_last_error() const { return last_error_; }
+
+private:
+    core::HttpResponse stats(uint64_t now) const;
+    core::HttpResponse findings(const core::HttpRequest& req, uint64_t now) const;
+    core::HttpResponse series(const core::HttpRequest& req, uint64_t now) const;
+    core::HttpResponse window(const core::HttpRequest& req, uint64_t now) const;
+    static uint64_t get_current_time_ms();
+
+    const Correlator& correlator_;
+    std::string bind_address_;
+    int port_;
+    std::string unix_socket_;
+    uint64_t max_points_;
+    std::function<nlohmann::json()> stats_provider_;
+    LiveFeed* live_feed_ = nullptr;
+    core::HttpServer server_;
+
+    mutable std::atomic<uint64_t> bad_requests_{0};
+    std::string last_error_;
+};
+
+} // namespace correlate
+} // namespace environet
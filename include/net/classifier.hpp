@@ -0,0 +1,200 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+#include <nlohmann/json.hpp>
+
+#include "core/config.hpp"
+#include "core/metrics_registry.hpp"
+#include "net/dissector.hpp"
+#include "net/packet_meta.hpp"
+
+namespace environet {
+namespace net {
+
+/**
+ * @brief Longest-prefix trie returning the rules whose prefixes cover a key
+ *
+ * Multibit trie with 4-bit strides. Prefixes that end inside a stride are
+ * expanded into every slot they cover, so a lookup is one table read per
+ * nibble and never backtracks. Each slot holds the bitmask of rules whose
+ * prefix ends at or above it.
+ */
+class PrefixTrie {
+public:
+    PrefixTrie();
+
+    /**
+     * @brief Add a prefix for a rule
+     *
+     * @param key Prefix bytes (big-endian bit order)
+     * @param bits Prefix length in bits (0 matches every key)
+     * @param rules Rule bits to set for keys under the prefix
+     */
+    void insert(const uint8_t* key, int bits, uint64_t rules);
+
+    /**
+     * @brief Collect the rules whose prefixes match a key
+     *
+     * @param key Key bytes
+     * @param key_bits Key length in bits (multiple of 4)
+     * @return Bitmask of matching rules
+     */
+    uint64_t lookup(const uint8_t* key, int key_bits) const;
+
+    /**
+     * @brief Get the number of trie nodes
+     */
+    size_t nodes() const { return nodes_.size(); }
+
+private:
+    struct Node {
+        std::array<uint64_t, 16> rules{};   // Rules matching through each slot
+        std::array<uint32_t, 16> child{};   // Next node per slot (0 = none)
+    };
+    std::vector<Node> nodes_;
+};
+
+/**
+ * @brief User-space packet classification rules engine
+ *
+ * Compiles Config::ClassRule entries into one decision structure per
+ * field: prefix tries for MAC, IPv4 and IPv6 addresses, a port table and
+ * a protocol table. Each field yields the bitmask of rules it satisfies
+ * (rules that leave a field empty are always satisfied); the packet's
+ * class is the first rule set in the AND of those masks. A lookup is a
+ * fixed number of table reads regardless of how many rules are loaded.
+ *
+ * Addresses and ports match in either direction. Class IDs follow the
+ * order of first appearance of each rule name, starting at 1; 0 is
+ * "unclassified". Packets and bytes per class are exported as
+ * environet_class_packets_total / environet_class_bytes_total.
+ *
+ * classify() is called from a single thread (the capture thread);
+ * load() may be called from any thread and takes effect on the next
+ * packet.
+ */
+class Classifier {
+public:
+    /**
+     * @brief Maximum number of rules in one rule set
+     */
+    static constexpr size_t MAX_RULES = 64;
+
+    /**
+     * @brief Create a classifier with no rules (everything unclassified)
+     */
+    Classifier();
+
+    /**
+     * @brief Compile and install a rule set
+     *
+     * If any rule does not parse the current rule set stays active.
+     *
+     * @param rules Rules in priority order
+     * @return true if successful, false otherwise
+     */
+    bool load(const std::vector<core::Config::ClassRule>& rules);
+
+    /**
+     * @brief Classify a dissected packet and count it against its class
+     *
+     * @param meta Packet metadata (length, ethertype, protocol, ports)
+     * @param layers Header positions from the dissector
+     * @return Class ID (0 = unclassified)
+     */
+    uint16_t classify(const PacketMeta& meta, const PacketLayers& layers);
+
+    /**
+     * @brief Get the class names of the installed rule set
+     *
+     * @return Names indexed by class ID ("unclassified" at 0)
+     */
+    std::vector<std::string> class_names() const;
+
+    /**
+     * @brief Get classifier statistics
+     *
+     * @return JSON object with rule count and per-class packets and bytes
+     */
+    nlohmann::json get_stats() const;
+
+    /**
+     * @brief Get last error message
+     *
+     * @return Error message string
+     */
+    std::string get_last_error() const;
+
+    /**
+     * @brief Parse a MAC prefix ("aa:bb:cc", "aa:bb:cc:dd:ee:ff/24")
+     *
+     * @param text Prefix text
+     * @param mac Prefix bytes
+     * @param bits Prefix length in bits
+     * @return true if the prefix is valid
+     */
+    static bool parse_mac_prefix(const std::string& text, std::array<uint8_t, 6>& mac, int& bits);
+
+    /**
+     * @brief Parse an IPv4 or IPv6 prefix ("10.0.0.0/8", "fe80::/10", bare address)
+     *
+     * @param text Prefix text
+     * @param addr Prefix bytes (first 4 used for IPv4)
+     * @param bits Prefix length in bits
+     * @param v6 Set to true for IPv6
+     * @return true if the prefix is valid
+     */
+    static bool parse_ip_prefix(const std::string& text, std::array<uint8_t, 16>& addr, int& bits, bool& v6);
+
+    /**
+     * @brief Parse a port or port range ("53", "8000-8099")
+     *
+     * @param text Port text
+     * @param lo First port
+     * @param hi Last port
+     * @return true if the range is valid
+     */
+    static bool parse_port_range(const std::string& text, uint16_t& lo, uint16_t& hi);
+
+private:
+    struct RuleSet {
+        PrefixTrie mac;
+        PrefixTrie ipv4;
+        PrefixTrie ipv6;
+        uint64_t mac_any = 0;               // Rules without MAC prefixes
+        uint64_t ip_any = 0;                // Rules without IP prefixes
+        uint64_t port_any = 0;              // Rules without ports
+        uint64_t protocol_any = 0;          // Rules without protocols
+        std::vector<uint16_t> port_class;   // Port -> index into port_rules
+        std::vector<uint64_t> port_rules;   // Distinct port rule masks
+        std::array<uint64_t, 256> protocol_rules{};
+        std::vector<uint16_t> rule_class;   // Rule index -> class ID
+        std::vector<std::string> names;     // Class ID -> name
+        std::vector<core::Counter*> packets; // Per class ID
+        std::vector<core::Counter*> bytes;
+        size_t rule_count = 0;
+    };
+
+    std::shared_ptr<const RuleSet> compile(const std::vector<core::Config::ClassRule>& rules, std::string& error) const;
+    uint16_t match(const RuleSet& set, const PacketMeta& meta, const PacketLayers& layers) const;
+
+    // Installed rule set, handed to the classifying thread by generation
+    mutable std::mutex mutex_;
+    std::shared_ptr<const RuleSet> installed_;
+    std::atomic<uint64_t> generation_{0};
+    std::string last_error_;
+
+    // Owned by the classifying thread
+    std::shared_ptr<const RuleSet> active_;
+    uint64_t active_generation_ = 0;
+};
+
+} // namespace net
+} // namespace environet
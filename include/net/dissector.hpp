@@ -0,0 +1,329 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <arpa/inet.h>
+#include <pcap.h>
+
+#include "net/packet_meta.hpp"
+
+#ifndef DLT_LINUX_SLL2
+#define DLT_LINUX_SLL2 276
+#endif
+#ifndef DLT_IPV4
+#define DLT_IPV4 228
+#endif
+#ifndef DLT_IPV6
+#define DLT_IPV6 229
+#endif
+
+namespace environet {
+namespace net {
+
+/**
+ * @brief Link-layer framings with a specialized dissector
+ */
+enum class LinkType {
+    EN10MB,             // Ethernet II
+    IEEE802_11_RADIO,   // Radiotap + 802.11 (monitor mode)
+    LINUX_SLL,          // Linux cooked capture v1 ("any" device)
+    LINUX_SLL2,         // Linux cooked capture v2
+    RAW,                // Bare IPv4/IPv6 (tun devices)
+};
+
+/**
+ * @brief Header positions found while dissecting a packet
+ *
+ * Pointers into the packet buffer; null when the layer is absent.
+ */
+struct PacketLayers {
+    const uint8_t* src_mac = nullptr;   // Link-layer source address (6 bytes)
+    const uint8_t* dst_mac = nullptr;   // Link-layer destination address (6 bytes)
+    const uint8_t* network = nullptr;   // Start of the IP header
+    size_t network_len = 0;             // Bytes available from network
+    const uint8_t* transport = nullptr; // Start of the upper-layer header (after IPv6
+                                        // extension headers; null for later fragments)
+    size_t transport_len = 0;           // Bytes available from transport
+};
+
+namespace detail {
+
+inline uint16_t be16(const uint8_t* p) { return static_cast<uint16_t>((p[0] << 8) | p[1]); }
+inline uint16_t le16(const uint8_t* p) { return static_cast<uint16_t>(p[0] | (p[1] << 8)); }
+inline uint32_t le32(const uint8_t* p) {
+    return static_cast<uint32_t>(p[0]) | (static_cast<uint32_t>(p[1]) << 8) |
+           (static_cast<uint32_t>(p[2]) << 16) | (static_cast<uint32_t>(p[3]) << 24);
+}
+
+inline std::string format_mac(const uint8_t* p) {
+    static const char* hexd = "0123456789abcdef";
+    std::string s(17, ':');
+    for (size_t i = 0; i < 6; ++i) {
+        s[i * 3] = hexd[(p[i] >> 4) & 0xF];
+        s[i * 3 + 1] = hexd[p[i] & 0xF];
+    }
+    return s;
+}
+
+inline std::string format_ip(const uint8_t* ip, int family) {
+    char buf[INET6_ADDRSTRLEN] = {};
+    inet_ntop(family, ip, buf, sizeof(buf));
+    return std::string(buf);
+}
+
+inline void dissect_transport(const uint8_t* l4, size_t len, PacketMeta& meta) {
+    // TCP and UDP both start with the port pair
+    if ((meta.protocol == 6 || meta.protocol == 17) && len >= 4) {
+        meta.src_port = be16(l4);
+        meta.dst_port = be16(l4 + 2);
+    }
+}
+
+// Skip IPv6 extension headers; returns the upper-layer offset, or 0 when it
+// is not in this packet (truncated, or a fragment other than the first)
+inline size_t skip_ipv6_extensions(const uint8_t* p, size_t len, uint8_t& next) {
+    size_t off = 40;
+    for (int i = 0; i < 8; ++i) {
+        size_t ext;
+        switch (next) {
+        case 0: case 43: case 60:                       // Hop-by-hop, routing, destination options
+            if (len < off + 2) return 0;
+            ext = (p[off + 1] + 1u) * 8u;
+            break;
+        case 51:                                        // Authentication header
+            if (len < off + 2) return 0;
+            ext = (p[off + 1] + 2u) * 4u;
+            break;
+        case 44:                                        // Fragment
+            if (len < off + 8 || (be16(p + off + 2) & 0xFFF8)) return 0;
+            ext = 8;
+            break;
+        default:
+            return off;
+        }
+        if (len < off + ext) return 0;
+        next = p[off];
+        off += ext;
+    }
+    return 0;
+}
+
+// Parses IPv4/IPv6 and the ports; bytes past the datagram length in the IP
+// header (link padding, trailers) are cut from layers. Returns that length,
+// or 0 when it is not known
+inline size_t dissect_network(const uint8_t* p, size_t len, uint16_t ethertype, PacketMeta& meta,
+                              PacketLayers& layers) {
+    size_t hdr = 0;
+    size_t datagram = 0;
+    if (ethertype == 0x0800) {
+        if (len < 20) return 0;
+        size_t ihl = (p[0] & 0x0F) * 4u;
+        if (ihl < 20 || ihl > len) return 0;
+        // Total length 0 is seen on segmentation-offloaded packets: unknown
+        datagram = be16(p + 2) >= ihl ? be16(p + 2) : 0;
+        if (datagram && len > datagram) len = layers.network_len = datagram;
+        meta.protocol = p[9];
+        meta.src_ip = format_ip(p + 12, AF_INET);
+        meta.dst_ip = format_ip(p + 16, AF_INET);
+        if (be16(p + 6) & 0x1FFF) return datagram;     // Later fragment: no transport header
+        hdr = ihl;
+    } else if (ethertype == 0x86DD && len >= 40) {
+        // Payload length 0 is a jumbogram; its length is in hop-by-hop options
+        if (be16(p + 4) != 0) datagram = 40u + be16(p + 4);
+        if (datagram && len > datagram) len = layers.network_len = datagram;
+        uint8_t next = p[6];
+        meta.src_ip = format_ip(p + 8, AF_INET6);
+        meta.dst_ip = format_ip(p + 24, AF_INET6);
+        hdr = skip_ipv6_extensions(p, len, next);
+        meta.protocol = next;
+        if (hdr == 0) return datagram;
+    } else {
+        return 0;
+    }
+    layers.transport = p + hdr;
+    layers.transport_len = len - hdr;
+    dissect_transport(layers.transport, layers.transport_len, meta);
+    return datagram;
+}
+
+// 802.11 MAC header; data frames carrying LLC/SNAP expose the network layer
+inline bool dissect_80211(const uint8_t* f, size_t len, PacketMeta& meta, PacketLayers& layers) {
+    if (len < 10) return false;
+    uint8_t type = (f[0] >> 2) & 0x3;
+    uint8_t subtype = f[0] >> 4;
+    uint8_t flags = f[1];
+    layers.dst_mac = f + 4;
+    if (type == 1) {                                    // Control: only some carry a transmitter
+        if (len >= 16) layers.src_mac = f + 10;
+        return true;
+    }
+    if (len < 24) return false;
+    if (type != 2) {                                    // Management
+        layers.src_mac = f + 10;
+        return true;
+    }
+    bool to_ds = flags & 0x01, from_ds = flags & 0x02;
+    size_t hdr = 24;
+    if (to_ds && from_ds) {
+        if (len < 30) return false;
+        hdr = 30;
+        layers.dst_mac = f + 16;
+        layers.src_mac = f + 24;
+    } else if (to_ds) {
+        layers.dst_mac = f + 16;
+        layers.src_mac = f + 10;
+    } else if (from_ds) {
+        layers.src_mac = f + 16;
+    } else {
+        layers.src_mac = f + 10;
+    }
+    if (subtype & 0x8) hdr += (flags & 0x80) ? 6 : 2;  // QoS control (+ HT control)
+    if ((flags & 0x40) || (subtype & 0x4)) return true; // Protected or no payload
+    if (len < hdr + 8 || f[hdr] != 0xAA || f[hdr + 1] != 0xAA || f[hdr + 2] != 0x03) return true;
+    meta.ethertype = be16(f + hdr + 6);
+    layers.network = f + hdr + 8;
+    layers.network_len = len - hdr - 8;
+    return true;
+}
+
+} // namespace detail
+
+/**
+ * @brief Link-layer parser for one framing
+ *
+ * parse() fills the link fields of @p meta and the header positions in
+ * @p layers, reading at most @p len bytes.
+ */
+template <LinkType L>
+struct LinkLayer;
+
+template <>
+struct LinkLayer<LinkType::EN10MB> {
+    static bool parse(const uint8_t* p, size_t len, PacketMeta& meta, PacketLayers& layers) {
+        if (len < 14) return false;
+        layers.dst_mac = p;
+        layers.src_mac = p + 6;
+        meta.ethertype = detail::be16(p + 12);
+        layers.network = p + 14;
+        layers.network_len = len - 14;
+        return true;
+    }
+};
+
+template <>
+struct LinkLayer<LinkType::IEEE802_11_RADIO> {
+    static bool parse(const uint8_t* p, size_t len, PacketMeta& meta, PacketLayers& layers) {
+        if (len < 8 || p[0] != 0) return false;
+        size_t rt_len = detail::le16(p + 2);
+        if (rt_len < 8 || rt_len > len) return false;
+        // Present bitmaps chain through bit 31; fields follow the last one
+        uint32_t present = detail::le32(p + 4);
+        size_t offset = 8;
+        for (uint32_t word = present; (word & 0x80000000u) && offset + 4 <= rt_len; offset += 4) {
+            word = detail::le32(p + offset);
+        }
+        // TSFT, flags, rate, channel, FHSS, antenna signal, antenna noise
+        static constexpr uint8_t ALIGN[] = {8, 1, 1, 2, 2, 1, 1};
+        static constexpr uint8_t SIZE[] = {8, 1, 1, 4, 2, 1, 1};
+        bool fcs = false;
+        for (unsigned bit = 0; bit < sizeof(SIZE); ++bit) {
+            if (!(present & (1u << bit))) continue;
+            offset = (offset + ALIGN[bit] - 1) & ~static_cast<size_t>(ALIGN[bit] - 1);
+            if (offset + SIZE[bit] > rt_len) break;
+            if (bit == 1) fcs = p[offset] & 0x10;
+            if (bit == 3) meta.frequency_mhz = detail::le16(p + offset);
+            if (bit == 5) meta.signal_strength = static_cast<int8_t>(p[offset]);
+            if (bit == 6) meta.noise_level = static_cast<int8_t>(p[offset]);
+            offset += SIZE[bit];
+        }
+        if (fcs) {
+            // The frame ends in a 4-byte FCS: not payload, and not counted
+            size_t wire = meta.length > len ? meta.length : len;
+            if (wire < rt_len + 4) return false;
+            meta.length = static_cast<uint32_t>(wire - 4);
+            if (len > wire - 4) len = wire - 4;
+        }
+        return detail::dissect_80211(p + rt_len, len - rt_len, meta, layers);
+    }
+};
+
+template <>
+struct LinkLayer<LinkType::LINUX_SLL> {
+    static bool parse(const uint8_t* p, size_t len, PacketMeta& meta, PacketLayers& layers) {
+        if (len < 16) return false;
+        if (detail::be16(p + 4) == 6) layers.src_mac = p + 6;
+        meta.ethertype = detail::be16(p + 14);
+        layers.network = p + 16;
+        layers.network_len = len - 16;
+        return true;
+    }
+};
+
+template <>
+struct LinkLayer<LinkType::LINUX_SLL2> {
+    static bool parse(const uint8_t* p, size_t len, PacketMeta& meta, PacketLayers& layers) {
+        if (len < 20) return false;
+        meta.ethertype = detail::be16(p);
+        if (p[11] == 6) layers.src_mac = p + 12;
+        layers.network = p + 20;
+        layers.network_len = len - 20;
+        return true;
+    }
+};
+
+template <>
+struct LinkLayer<LinkType::RAW> {
+    static bool parse(const uint8_t* p, size_t len, PacketMeta& meta, PacketLayers& layers) {
+        if (len < 1) return false;
+        uint8_t version = p[0] >> 4;
+        if (version != 4 && version != 6) return false;
+        meta.ethertype = version == 4 ? 0x0800 : 0x86DD;
+        layers.network = p;
+        layers.network_len = len;
+        return true;
+    }
+};
+
+/**
+ * @brief Parse link, network and transport headers for one framing
+ *
+ * Each instantiation is a straight-line chain with no link-type branches;
+ * never reads past @p caplen bytes. meta.length (the wire length, when set)
+ * is reduced by a radiotap-flagged FCS and by bytes past the IP datagram.
+ *
+ * @param packet Packet data
+ * @param caplen Number of captured bytes available
+ * @param meta Packet metadata to fill
+ * @param layers Header positions found
+ * @return true if the link header was recognized
+ */
+template <LinkType L>
+bool dissect(const uint8_t* packet, uint32_t caplen, PacketMeta& meta, PacketLayers& layers) {
+    if (!packet || !LinkLayer<L>::parse(packet, caplen, meta, layers)) return false;
+    if (layers.src_mac) meta.src_mac = detail::format_mac(layers.src_mac);
+    if (layers.dst_mac) meta.dst_mac = detail::format_mac(layers.dst_mac);
+    if (layers.network) {
+        size_t datagram = detail::dissect_network(layers.network, layers.network_len, meta.ethertype, meta, layers);
+        // Drop link padding (short Ethernet frames) from the counted length
+        size_t end = static_cast<size_t>(layers.network - packet) + datagram;
+        if (datagram && meta.length > end) meta.length = static_cast<uint32_t>(end);
+    }
+    return true;
+}
+
+/**
+ * @brief Dissector entry point, chosen once per capture handle
+ */
+using Dissector = bool (*)(const uint8_t*, uint32_t, PacketMeta&, PacketLayers&);
+
+/**
+ * @brief Select the dissector for a pcap datalink type
+ *
+ * @param dlt Value returned by pcap_datalink()
+ * @return Dissector, or nullptr if the framing is not supported
+ */
+Dissector dissector_for(int dlt);
+
+} // namespace net
+} // namespace environet
@@ -0,0 +1,173 @@
+#pragma once
+
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+#include <nlohmann/json.hpp>
+
+#include "core/config.hpp"
+#include "core/metrics_registry.hpp"
+#include "net/dissector.hpp"
+#include "net/packet_meta.hpp"
+
+namespace environet {
+namespace net {
+
+/**
+ * @brief DNS activity over one interval
+ */
+struct DnsSample {
+    uint64_t timestamp_ms = 0;      // Interval start (steady clock)
+    uint32_t interval_ms = 0;
+    uint64_t queries = 0;
+    uint64_t responses = 0;         // Responses matched to a pending query
+    uint64_t nxdomain = 0;          // Matched responses with RCODE 3
+    uint64_t servfail = 0;          // Matched responses with RCODE 2
+    uint64_t timeouts = 0;          // Queries expired or evicted unanswered
+    uint64_t unmatched = 0;         // Responses with no pending query
+    uint64_t latency_sum_us = 0;    // Over matched responses
+    uint64_t latency_max_us = 0;
+
+    double avg_latency_ms() const { return responses ? latency_sum_us / 1000.0 / responses : 0.0; }
+};
+
+/**
+ * @brief Passive DNS latency and error analysis
+ *
+ * Queries and responses on UDP or TCP port 53 are matched by client
+ * address, client port and transaction id. Latency is measured between
+ * capture timestamps. Outstanding queries live in a fixed-size
+ * open-addressed table: a query probes a few slots and, when all are
+ * taken, evicts the oldest (counted as a timeout), so memory and
+ * per-packet work stay bounded under query floods.
+ *
+ * Counts are aggregated into intervals of dns.bucket_ms on the steady
+ * clock (the correlator's time base) and collected with drain().
+ */
+class DnsAnalyzer {
+public:
+    static constexpr size_t PROBE = 8;          // Slots a key may occupy
+    static constexpr size_t MAX_SAMPLES = 256;  // Completed intervals kept until drained
+
+    /**
+     * @brief Construct from a shared configuration snapshot
+     *
+     * @param config Configuration snapshot (must not be null)
+     */
+    explicit DnsAnalyzer(std::shared_ptr<const core::Config> config);
+
+    /**
+     * @brief Constructor
+     *
+     * @param config_path Path to configuration file (parsed once, defaults if unreadable)
+     */
+    explicit DnsAnalyzer(const std::string& config_path);
+
+    /**
+     * @brief Initialize the analyzer
+     *
+     * @return true if successful, false otherwise
+     */
+    bool init();
+
+    /**
+     * @brief Check whether DNS analysis is enabled
+     */
+    bool enabled() const { return enabled_; }
+
+    /**
+     * @brief Inspect a dissected packet at the current time
+     *
+     * Packets that are not DNS return after a port check.
+     *
+     * @param ts_us Capture timestamp in microseconds
+     * @param meta Packet metadata
+     * @param layers Header positions from the dissector
+     */
+    void process(uint64_t ts_us, const PacketMeta& meta, const PacketLayers& layers);
+
+    /**
+     * @brief Inspect a dissected packet, counting it in the interval of @p now_ms
+     *
+     * @param now_ms Time in milliseconds (steady clock)
+     * @param ts_us Capture timestamp in microseconds
+     * @param meta Packet metadata
+     * @param layers Header positions from the dissector
+     */
+    void process_at(uint64_t now_ms, uint64_t ts_us, const PacketMeta& meta, const PacketLayers& layers);
+
+    /**
+     * @brief Collect intervals completed by @p now_ms
+     *
+     * @param now_ms Current time in milliseconds (steady clock)
+     * @param out Receives the intervals, oldest first (appended)
+     * @return Number of samples appended
+     */
+    size_t drain(uint64_t now_ms, std::vector<DnsSample>& out);
+
+    /**
+     * @brief Locate the DNS message in a dissected packet
+     *
+     * @param meta Packet metadata (protocol and ports)
+     * @param layers Header positions from the dissector
+     * @param len Receives the number of message bytes captured
+     * @return Start of the DNS header, or nullptr if not DNS or truncated
+     */
+    static const uint8_t* dns_message(const PacketMeta& meta, const PacketLayers& layers, size_t& len);
+
+    /**
+     * @brief Get analyzer statistics
+     *
+     * @return JSON object with totals and pending-table occupancy
+     */
+    nlohmann::json get_stats() const;
+
+    /**
+     * @brief Get last error message
+     *
+     * @return Error message string
+     */
+    std::string get_last_error() const { return last_error_; }
+
+private:
+    struct Pending {
+        uint64_t key = 0;           // 0 = free
+        uint64_t ts_us = 0;
+    };
+
+    void add_query(uint64_t key, uint64_t ts_us);
+    void add_response(uint64_t key, uint64_t ts_us, uint8_t rcode);
+    void expire(uint64_t ts_us);
+    void roll(uint64_t now_ms);
+    static uint64_t get_current_time_ms();
+
+    bool enabled_;
+    uint64_t bucket_ms_;
+    uint64_t timeout_us_;
+    size_t mask_;
+
+    mutable std::mutex mutex_;      // Guards everything below
+    std::vector<Pending> pending_;
+    size_t pending_count_ = 0;
+    uint64_t last_ts_us_ = 0;       // Latest capture timestamp seen
+    DnsSample current_;
+    std::deque<DnsSample> completed_;
+    uint64_t dropped_samples_ = 0;
+
+    core::Counter& queries_;
+    core::Counter& responses_noerror_;
+    core::Counter& responses_nxdomain_;
+    core::Counter& responses_servfail_;
+    core::Counter& responses_other_;
+    core::Counter& timeouts_;
+    core::Counter& unmatched_;
+    core::Histogram& latency_;
+
+    std::string last_error_;
+};
+
+} // namespace net
+} // namespace environet
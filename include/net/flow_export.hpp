@@ -0,0 +1,277 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+#include <nlohmann/json.hpp>
+
+#include "core/config.hpp"
+#include "core/metrics_registry.hpp"
+#include "net/dissector.hpp"
+#include "net/packet_meta.hpp"
+
+namespace environet {
+namespace net {
+
+/**
+ * @brief Why a flow record was exported (IPFIX flowEndReason)
+ */
+enum class FlowEndReason : uint8_t {
+    Idle = 1,           // No packets for flow_export.inactive_timeout_ms
+    Active = 2,         // Open for flow_export.active_timeout_ms
+    EndOfFlow = 3,      // TCP FIN or RST seen
+    Forced = 4,         // Exporter shut down
+    LackOfResources = 5 // Evicted from a full flow table
+};
+
+/**
+ * @brief Enterprise-specific information elements (flow_export.enterprise_id)
+ *
+ * Radio context is averaged over the flow's radiotap packets (0 when the
+ * capture has no radiotap header); sensor context is the latest sensor
+ * frame at export time.
+ */
+enum class FlowEnterpriseIe : uint16_t {
+    RssiAverage = 1,        // signed8, dBm
+    RssiMinimum = 2,        // signed8, dBm
+    RssiMaximum = 3,        // signed8, dBm
+    NoiseAverage = 4,       // signed8, dBm
+    ChannelFrequency = 5,   // unsigned16, MHz
+    TrafficClass = 6,       // unsigned16, classifier class id
+    SensorIrRaw = 7,        // signed16, raw IR reading
+    SensorUltrasonicMm = 8, // unsigned16, ultrasonic distance
+    SensorStatus = 9,       // unsigned8, sensor status bits
+};
+
+/**
+ * @brief IPFIX / NetFlow v9 exporter for flows seen by the capture path
+ *
+ * Packets are aggregated by 5-tuple (IP version, addresses, ports,
+ * protocol) in a fixed-size open-addressed table of flow_export.max_flows
+ * slots. A new flow probes a few slots and, when all are taken, evicts
+ * the least recently seen one (exported as LackOfResources), so memory
+ * and per-packet work stay bounded.
+ *
+ * A flow is exported when it has been idle for inactive_timeout_ms, open
+ * for active_timeout_ms (long flows are exported in pieces) or after a
+ * TCP FIN or RST. Records are encoded with fixed layouts straight into
+ * one preallocated datagram of at most flow_export.mtu bytes, which is
+ * sent over UDP when full and at the end of every expire() pass; no
+ * memory is allocated per packet or per record.
+ *
+ * Two templates are used, IPv4 (256) and IPv6 (257). They are sent in the
+ * first datagram and again every template_refresh_ms, as UDP transport
+ * requires. IPFIX (RFC 7011) carries the custom IEs with the enterprise
+ * bit and flow_export.enterprise_id; NetFlow v9 (RFC 3954) has no
+ * enterprise numbers, so they use field types 0x8000 + IE id there, and
+ * flow times are FIRST_SWITCHED/LAST_SWITCHED relative to the exporter's
+ * start instead of absolute milliseconds.
+ *
+ * Flow times are capture timestamps (wall clock, milliseconds).
+ */
+class FlowExporter {
+public:
+    static constexpr size_t PROBE = 8;              // Slots a flow may occupy
+    static constexpr uint16_t IPV4_TEMPLATE_ID = 256;
+    static constexpr uint16_t IPV6_TEMPLATE_ID = 257;
+
+    /**
+     * @brief Construct from a shared configuration snapshot
+     *
+     * @param config Configuration snapshot (must not be null)
+     */
+    explicit FlowExporter(std::shared_ptr<const core::Config> config);
+
+    /**
+     * @brief Constructor
+     *
+     * @param config_path Path to configuration file (parsed once, defaults if unreadable)
+     */
+    explicit FlowExporter(const std::string& config_path);
+
+    /**
+     * @brief Destructor (closes the socket without exporting open flows)
+     */
+    ~FlowExporter();
+
+    FlowExporter(const FlowExporter&) = delete;
+    FlowExporter& operator=(const FlowExporter&) = delete;
+
+    /**
+     * @brief Allocate the flow table and datagram buffer and open the UDP socket
+     *
+     * @return true if successful, false otherwise
+     */
+    bool init();
+
+    /**
+     * @brief Check whether flow export is enabled
+     */
+    bool enabled() const { return enabled_; }
+
+    /**
+     * @brief Account a dissected packet to its flow
+     *
+     * Packets without an IPv4 or IPv6 header are ignored.
+     *
+     * @param meta Packet metadata (timestamp, length, radio and class)
+     * @param layers Header positions from the dissector
+     */
+    void process(const PacketMeta& meta, const PacketLayers& layers);
+
+    /**
+     * @brief Export flows that timed out and send the pending datagram
+     *
+     * Call periodically (e.g. every second).
+     */
+    void expire();
+
+    /**
+     * @brief Export flows that timed out by @p now_ms and send the pending datagram
+     *
+     * @param now_ms Current time in milliseconds (wall clock, as capture timestamps)
+     */
+    void expire_at(uint64_t now_ms);
+
+    /**
+     * @brief Export every open flow (Forced) and send the pending datagram
+     */
+    void flush();
+
+    /**
+     * @brief Update the sensor context attached to exported records (thread-safe)
+     *
+     * @param ir_raw Raw IR reading
+     * @param ultra_mm Ultrasonic distance in millimeters
+     * @param status Sensor status bits
+     */
+    void set_sensor_context(int16_t ir_raw, uint16_t ultra_mm, uint8_t status);
+
+    /**
+     * @brief Get exporter statistics
+     *
+     * @return JSON object with flow table, record and datagram counters
+     */
+    nlohmann::json get_stats() const;
+
+    /**
+     * @brief Get last error message
+     *
+     * @return Error message string
+     */
+    std::string get_last_error() const;
+
+private:
+    struct FlowKey {
+        uint8_t src[16];
+        uint8_t dst[16];
+        uint16_t src_port;
+        uint16_t dst_port;
+        uint8_t version;            // 4 or 6
+        uint8_t protocol;
+        uint8_t pad[2];             // Zero, so keys hash and compare as bytes
+    };
+
+    struct Flow {
+        uint64_t hash = 0;          // 0 = free slot
+        FlowKey key;
+        uint8_t src_mac[6];
+        uint8_t dst_mac[6];
+        uint64_t first_ms;
+        uint64_t last_ms;
+        uint64_t packets;
+        uint64_t bytes;             // IP header and payload, no link layer
+        uint16_t tcp_flags;
+        uint16_t class_id;
+        uint16_t frequency_mhz;
+        int8_t rssi_min;
+        int8_t rssi_max;
+        int32_t rssi_sum;
+        int32_t noise_sum;
+        uint32_t radio_packets;     // Packets with radiotap signal
+        bool ended;                 // FIN or RST seen
+    };
+
+    struct Field {
+        uint16_t id;
+        uint16_t length;
+        bool enterprise;
+    };
+
+    struct Template {
+        uint16_t id;
+        std::vector<Field> fields;
+        size_t record_size = 0;
+    };
+
+    Template make_template(uint16_t id, bool v6) const;
+    void start_flow(Flow& flow, const FlowKey& key, uint64_t hash, const PacketMeta& meta, const PacketLayers& layers);
+    void add_packet(Flow& flow, const PacketMeta& meta, uint32_t ip_bytes, uint16_t tcp_flags);
+    void export_flow(Flow& flow, FlowEndReason reason);
+    void encode_record(uint8_t* out, const Template& tmpl, const Flow& flow, FlowEndReason reason) const;
+    void begin_message();
+    void append_templates();
+    void close_set();
+    void send_message();
+    void set_error(const std::string& error);
+    static uint64_t get_current_time_ms();
+
+    // Configuration
+    bool enabled_;
+    bool ipfix_;
+    std::string host_;
+    int port_;
+    uint32_t domain_;
+    uint32_t enterprise_id_;
+    uint64_t active_timeout_ms_;
+    uint64_t inactive_timeout_ms_;
+    uint64_t template_refresh_ms_;
+    size_t mask_;
+    size_t mtu_;
+
+    mutable std::mutex mutex_;      // Guards everything below
+    std::vector<Flow> flows_;
+    size_t active_flows_ = 0;
+    Template v4_;
+    Template v6_;
+    int fd_ = -1;
+    uint64_t start_ms_ = 0;         // NetFlow v9 sysUptime base
+    uint64_t clock_ms_ = 0;         // Latest time seen (packets or expire)
+
+    // Datagram being built
+    std::vector<uint8_t> buf_;
+    size_t len_ = 0;                // 0 = no message started
+    size_t set_start_ = 0;          // Offset of the open set header (0 = none)
+    uint16_t set_id_ = 0;
+    uint32_t message_records_ = 0;  // Template and data records (NetFlow v9 count)
+    uint32_t message_data_records_ = 0;
+    uint64_t next_template_ms_ = 0; // 0 = templates not sent yet
+
+    // Statistics
+    uint32_t sequence_ = 0;         // IPFIX: data records sent; NetFlow v9: datagrams sent
+    uint64_t flows_created_ = 0;
+    uint64_t records_ = 0;
+    uint64_t reasons_[6] = {};      // Records by FlowEndReason
+    uint64_t templates_sent_ = 0;
+    uint64_t messages_ = 0;
+    uint64_t bytes_sent_ = 0;
+    uint64_t errors_ = 0;
+    std::atomic<uint64_t> packets_ignored_{0};
+    core::Counter& records_exported_;
+    core::Counter& messages_sent_;
+    core::Counter& send_errors_;
+
+    // Sensor context (written by the sensor timer)
+    std::atomic<int16_t> sensor_ir_{0};
+    std::atomic<uint16_t> sensor_ultra_{0};
+    std::atomic<uint8_t> sensor_status_{0};
+
+    mutable std::mutex error_mutex_;
+    std::string last_error_;
+};
+
+} // namespace net
+} // namespace environet
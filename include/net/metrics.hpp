@@ -6,6 +6,9 @@
 #include <memory>
 #include <nlohmann/json.hpp>
 
+#include "core/config.hpp"
+#include "core/metrics_registry.hpp"
+
 namespace environet {
 namespace net {
 
@@ -62,10 +65,17 @@ struct Iperf3Results {
  */
 class Metrics {
 public:
+    /**
+     * @brief Construct from a shared configuration snapshot
+     * 
+     * @param config Configuration snapshot (must not be null)
+     */
+    explicit Metrics(std::shared_ptr<const core::Config> config);
+
     /**
      * @brief Constructor
      * 
-     * @param config_path Path to configuration file
+     * @param config_path Path to configuration file (parsed once, defaults if unreadable)
      */
     explicit Metrics(const std::string& config_path);
     
@@ -127,6 +137,24 @@ public:
      * @return Error message string
      */
     std::string get_last_error() const { return last_error_; }
+    
+    /**
+     * @brief Parse the output of the ping command
+     * 
+     * @param output Combined stdout/stderr of ping
+     * @param target Target that was pinged
+     * @return PingStats parsed from the summary lines
+     */
+    PingStats parse_ping_output(const std::string& output, const std::string& target);
+    
+    /**
+     * @brief Parse the output of iperf3 (JSON with -J, text otherwise)
+     * 
+     * @param output Combined stdout/stderr of iperf3
+     * @param server Server that was tested
+     * @return Iperf3Results parsed from the output
+     */
+    Iperf3Results parse_iperf3_output(const std::string& output, const std::string& server);
 
 private:
     // Configuration
@@ -135,20 +163,17 @@ private:
     int ping_interval_ms_;
     int iperf3_duration_;
     
-    // Statistics
-    int ping_tests_run_;
-    int iperf3_tests_run_;
-    int ping_errors_;
-    int iperf3_errors_;
+    // Statistics (registered in the global metrics registry)
+    core::Counter& ping_tests_run_;
+    core::Counter& iperf3_tests_run_;
+    core::Counter& ping_errors_;
+    core::Counter& iperf3_errors_;
     uint64_t start_time_ms_;
     
     // Error handling
     std::string last_error_;
     
     // Private methods
-    PingStats parse_ping_output(const std::string& output, const std::string& target);
-    Iperf3Results parse_iperf3_output(const std::string& output, const std::string& server);
-    
     /**
      * @brief Execute shell command and return output
      * 
@@ -0,0 +1,36 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+
+namespace environet {
+namespace net {
+
+/**
+ * @brief Packet metadata structure
+ * 
+ * Contains essential information about captured packets
+ */
+struct PacketMeta {
+    uint64_t timestamp_ms;      // Timestamp in milliseconds
+    uint32_t length;            // Packet length in bytes
+    std::string src_mac;        // Source MAC address
+    std::string dst_mac;        // Destination MAC address
+    uint16_t ethertype;         // Ethernet type
+    std::string src_ip;         // Source IP address (if available)
+    std::string dst_ip;         // Destination IP address (if available)
+    uint16_t src_port;          // Source port (if TCP/UDP)
+    uint16_t dst_port;          // Destination port (if TCP/UDP)
+    uint8_t protocol;           // IP protocol number
+    int signal_strength;        // Signal strength in dBm (if radiotap available)
+    int noise_level;            // Noise level in dBm (if radiotap available)
+    uint16_t frequency_mhz;     // Channel frequency in MHz (if radiotap available)
+    uint16_t class_id;          // Traffic class from the classifier (0 = unclassified)
+    
+    // Default constructor
+    PacketMeta() : timestamp_ms(0), length(0), ethertype(0), src_port(0), 
+                   dst_port(0), protocol(0), signal_strength(0), noise_level(0), frequency_mhz(0), class_id(0) {}
+};
+
+} // namespace net
+} // namespace environet
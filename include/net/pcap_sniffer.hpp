@@ -5,37 +5,25 @@
 #include <memory>
 #include <thread>
 #include <atomic>
+#include <condition_variable>
+#include <mutex>
 #include <vector>
 #include <pcap.h>
 #include <nlohmann/json.hpp>
 
+#include "core/config.hpp"
+#include "core/metrics_registry.hpp"
+#include "net/classifier.hpp"
+#include "net/dissector.hpp"
+#include "net/dns_analyzer.hpp"
+#include "net/flow_export.hpp"
+#include "net/packet_meta.hpp"
+#include "net/throughput.hpp"
+#include "net/traffic_accounting.hpp"
+
 namespace environet {
 namespace net {
 
-/**
- * @brief Packet metadata structure
- * 
- * Contains essential information about captured packets
- */
-struct PacketMeta {
-    uint64_t timestamp_ms;      // Timestamp in milliseconds
-    uint32_t length;            // Packet length in bytes
-    std::string src_mac;        // Source MAC address
-    std::string dst_mac;        // Destination MAC address
-    uint16_t ethertype;         // Ethernet type
-    std::string src_ip;         // Source IP address (if available)
-    std::string dst_ip;         // Destination IP address (if available)
-    uint16_t src_port;          // Source port (if TCP/UDP)
-    uint16_t dst_port;          // Destination port (if TCP/UDP)
-    uint8_t protocol;           // IP protocol number
-    int signal_strength;        // Signal strength in dBm (if radiotap available)
-    int noise_level;            // Noise level in dBm (if radiotap available)
-    
-    // Default constructor
-    PacketMeta() : timestamp_ms(0), length(0), ethertype(0), src_port(0), 
-                   dst_port(0), protocol(0), signal_strength(0), noise_level(0) {}
-};
-
 /**
  * @brief PCAP packet sniffer class
  * 
@@ -48,10 +36,17 @@ public:
      */
     using PacketCallback = std::function<void(const PacketMeta&, const uint8_t*)>;
     
+    /**
+     * @brief Construct from a shared configuration snapshot
+     * 
+     * @param config Configuration snapshot (must not be null)
+     */
+    explicit PcapSniffer(std::shared_ptr<const core::Config> config);
+
     /**
      * @brief Constructor
      * 
-     * @param config_path Path to configuration file
+     * @param config_path Path to configuration file (parsed once, defaults if unreadable)
      */
     explicit PcapSniffer(const std::string& config_path);
     
@@ -80,12 +75,56 @@ public:
      */
     void stop();
     
+    /**
+     * @brief Set the packet callback without starting live capture
+     * 
+     * @param callback Function to call for each processed packet
+     */
+    void set_packet_callback(PacketCallback callback);
+    
+    /**
+     * @brief Feed a packet through the capture processing path
+     * 
+     * Counts, parses and dispatches the packet exactly as live capture
+     * does, without an open interface (replay, pipeline benchmarks).
+     * 
+     * @param header Packet header (caplen, len, timestamp)
+     * @param packet Packet data
+     */
+    void inject_packet(const pcap_pkthdr* header, const uint8_t* packet);
+    
     /**
      * @brief Check if capture is running
      * 
      * @return true if capture is active
      */
     bool is_running() const { return running_; }
+
+    /**
+     * @brief Replace the BPF filter
+     *
+     * On a running capture the filter is handed to the capture thread,
+     * which is woken with pcap_breakloop() and installs it with
+     * pcap_setfilter() between reads, so the handle is never used from
+     * two threads. Blocks until the capture thread has applied it. If the
+     * filter does not compile the current one stays active.
+     *
+     * @param filter BPF filter expression (empty accepts everything)
+     * @return true if successful, false otherwise
+     */
+    bool set_bpf_filter(const std::string& filter);
+
+    /**
+     * @brief Apply settings that can change while running
+     *
+     * The BPF filter and classification rules are applied live;
+     * interface, output directory and rotation limits need a restart.
+     * Whichever of the two fails to apply keeps its current setting.
+     *
+     * @param cfg New configuration
+     * @return true if successful, false otherwise
+     */
+    bool apply_config(const core::Config& cfg);
     
     /**
      * @brief Get capture statistics
@@ -100,6 +139,65 @@ public:
      * @return Error message string
      */
     std::string get_last_error() const { return last_error_; }
+    
+    /**
+     * @brief Parse link, network and transport headers of an Ethernet frame
+     * 
+     * Never reads past @p caplen bytes. Captures on other datalinks are
+     * parsed with the dissector chosen by set_datalink().
+     * 
+     * @param packet Packet data
+     * @param caplen Number of captured bytes available
+     * @param meta Packet metadata to fill
+     * @return true if the link header was recognized
+     */
+    static bool parse_packet(const uint8_t* packet, uint32_t caplen, PacketMeta& meta);
+
+    /**
+     * @brief Select the dissector for a datalink type
+     * 
+     * Called once per capture handle; packets on an unsupported datalink
+     * are still counted and written but not dissected.
+     * 
+     * @param dlt Datalink type as returned by pcap_datalink()
+     * @return true if the datalink has a dissector
+     */
+    bool set_datalink(int dlt);
+
+    /**
+     * @brief Get the packet classifier
+     * 
+     * @return Classifier applied to every dissected packet
+     */
+    Classifier& classifier() { return classifier_; }
+
+    /**
+     * @brief Feed dissected packets to per-host traffic accounting
+     * 
+     * @param accounting Accounting stage (not owned; nullptr disables)
+     */
+    void set_traffic_accounting(TrafficAccounting* accounting) { accounting_ = accounting; }
+
+    /**
+     * @brief Feed DNS traffic to query/response latency analysis
+     * 
+     * @param dns DNS analyzer (not owned; nullptr disables)
+     */
+    void set_dns_analyzer(DnsAnalyzer* dns) { dns_ = dns; }
+
+    /**
+     * @brief Feed dissected packets to IPFIX / NetFlow v9 flow export
+     * 
+     * @param flows Flow exporter (not owned; nullptr disables)
+     */
+    void set_flow_exporter(FlowExporter* flows) { flows_ = flows; }
+
+    /**
+     * @brief Get the passive throughput meter
+     * 
+     * @return Per-direction byte and packet counts of this interface in 100 ms buckets
+     */
+    ThroughputMeter& throughput() { return throughput_; }
 
 private:
     // Configuration
@@ -112,21 +210,40 @@ private:
     
     // PCAP state
     pcap_t* pcap_handle_;
+    std::mutex handle_mutex_;   // Guards pcap_handle_ open/close against filter swaps
+
+    // Filter swap handed to the capture thread (guarded by filter_mutex_)
+    enum class FilterRequest { None, Pending, Applied, Failed };
+    std::mutex filter_mutex_;
+    std::condition_variable filter_cv_;
+    std::string pending_filter_;
+    FilterRequest filter_request_ = FilterRequest::None;
+    bool capture_active_ = false;  // Capture thread is reading and will serve requests
     pcap_dumper_t* pcap_dumper_;
     std::string current_pcap_file_;
     std::vector<std::string> file_history_;
     std::atomic<int> file_index_{0};
     int datalink_ = -1;
+    Dissector dissector_ = &dissect<LinkType::EN10MB>;
+    Classifier classifier_;
+    std::vector<core::Config::ClassRule> class_rules_;
+    TrafficAccounting* accounting_ = nullptr;
+    DnsAnalyzer* dns_ = nullptr;
+    FlowExporter* flows_ = nullptr;
+    ThroughputMeter throughput_;
+    int numa_node_;             // Configured node for capture buffers (-1 = the NIC's node)
+    std::atomic<int> capture_node_{-1}; // Node the capture ring was allocated on (-1 = no preference)
     
     // Capture state
     std::atomic<bool> running_;
     std::thread capture_thread_;
     PacketCallback packet_callback_;
     
-    // Statistics
-    uint64_t packets_captured_;
-    uint64_t packets_dropped_;
-    uint64_t bytes_captured_;
+    // Statistics (registered in the global metrics registry)
+    core::Counter& packets_captured_;
+    core::Counter& packets_dropped_;
+    core::Counter& bytes_captured_;
+    core::Histogram& process_packet_latency_;
     uint64_t start_time_ms_;
     
     // Error handling
@@ -135,6 +252,8 @@ private:
     // Private methods
     bool init_interface();
     bool compile_bpf();
+    bool install_bpf(const std::string& filter);
+    void apply_pending_filter();
     bool open_pcap_file();
     void close_pcap_file();
     void rotate_pcap_file();
@@ -151,51 +270,14 @@ private:
      * @param packet Packet data
      */
     void process_packet(const pcap_pkthdr* header, const uint8_t* packet);
-    
-    /**
-     * @brief Parse Ethernet header
-     * 
-     * @param packet Packet data
-     * @param meta Packet metadata to fill
-     * @return true if parsing successful
-     */
-    bool parse_ethernet_header(const uint8_t* packet, PacketMeta& meta);
-    
-    /**
-     * @brief Parse IP header
-     * 
-     * @param packet Packet data (starting at IP header)
-     * @param meta Packet metadata to fill
-     * @return true if parsing successful
-     */
-    bool parse_ip_header(const uint8_t* packet, PacketMeta& meta);
-    
-    /**
-     * @brief Parse TCP header
-     * 
-     * @param packet Packet data (starting at TCP header)
-     * @param meta Packet metadata to fill
-     * @return true if parsing successful
-     */
-    bool parse_tcp_header(const uint8_t* packet, PacketMeta& meta);
-    
-    /**
-     * @brief Parse UDP header
-     * 
-     * @param packet Packet data (starting at UDP header)
-     * @param meta Packet metadata to fill
-     * @return true if parsing successful
-     */
-    bool parse_udp_header(const uint8_t* packet, PacketMeta& meta);
-    
+
     /**
-     * @brief Parse radiotap header (if available)
-     * 
-     * @param packet Packet data (starting at radiotap header)
-     * @param meta Packet metadata to fill
-     * @return true if parsing successful
+     * @brief Append a packet record to the binary event trace
+     *
+     * @param meta Parsed packet metadata
+     * @param layers Header positions found by the dissector
      */
-    bool parse_radiotap_header(const uint8_t* packet, PacketMeta& meta);
+    static void trace_packet(const PacketMeta& meta, const PacketLayers& layers);
     
     /**
      * @brief Set error message
@@ -215,23 +297,6 @@ private:
      * @return Current timestamp
      */
     static uint64_t get_current_time_ms();
-    
-    /**
-     * @brief Convert MAC address bytes to string
-     * 
-     * @param mac MAC address bytes
-     * @return MAC address string
-     */
-    static std::string mac_to_string(const uint8_t* mac);
-    
-    /**
-     * @brief Convert IP address bytes to string
-     * 
-     * @param ip IP address bytes
-     * @param version IP version (4 or 6)
-     * @return IP address string
-     */
-    static std::string ip_to_string(const uint8_t* ip, int version);
 };
 
 } // namespace net
@@ -0,0 +1,159 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <vector>
+#include <nlohmann/json.hpp>
+
+#include "core/metrics_registry.hpp"
+#include "net/dissector.hpp"
+
+namespace environet {
+namespace net {
+
+/**
+ * @brief Direction of a packet relative to the capturing interface
+ */
+enum class Direction : uint8_t { Rx, Tx, Other };
+
+/**
+ * @brief Traffic on one interface over one bucket
+ */
+struct ThroughputSample {
+    std::string interface;
+    uint64_t timestamp_ms = 0;          // Bucket start (steady clock)
+    uint32_t interval_ms = 0;           // Bucket length
+    uint64_t bytes[3] = {};             // Per Direction
+    uint64_t packets[3] = {};           // Per Direction
+
+    uint64_t total_bytes() const { return bytes[0] + bytes[1] + bytes[2]; }
+};
+
+/**
+ * @brief Passive per-direction throughput of one capture interface
+ *
+ * Packets are counted into 100 ms buckets. Writers add into a ring of
+ * buckets selected by metric_shard_index() with relaxed atomic adds, so
+ * recording takes no lock; drain() merges the rings into one sample per
+ * completed bucket, idle buckets included.
+ *
+ * More writer threads than shards share rings. Recycling a slot for a new
+ * bucket is claimed with a compare-and-swap, so concurrent writers are
+ * safe; the one assumption is that a writer is not stalled for a whole
+ * ring (RING * BUCKET_MS) between reading a slot's bucket id and adding
+ * to it, or its packet is counted in the newer bucket.
+ */
+class ThroughputMeter {
+public:
+    static constexpr uint64_t BUCKET_MS = 100;
+    static constexpr size_t RING = 64;  // Buckets kept per thread (6.4 s between drains)
+
+    /**
+     * @brief Create a meter
+     *
+     * @param interface Interface name reported in samples
+     */
+    explicit ThroughputMeter(std::string interface = "");
+
+    /**
+     * @brief Set the interface's own MAC address
+     *
+     * Without it every packet counts as Direction::Other. Call before
+     * capture starts.
+     *
+     * @param mac Six-byte hardware address
+     */
+    void set_local_mac(const uint8_t* mac);
+
+    /**
+     * @brief Read an interface's hardware address from sysfs
+     *
+     * @param interface Interface name
+     * @param mac Receives the address
+     * @return true if the address was read
+     */
+    static bool read_interface_mac(const std::string& interface, std::array<uint8_t, 6>& mac);
+
+    /**
+     * @brief Classify a dissected packet's direction
+     *
+     * @param layers Header positions from the dissector
+     * @return Tx if sent by this interface, Rx if addressed to it (or to a group), else Other
+     */
+    Direction direction(const PacketLayers& layers) const;
+
+    /**
+     * @brief Count a packet at the current time
+     *
+     * @param layers Header positions from the dissector
+     * @param bytes Packet length
+     */
+    void record(const PacketLayers& layers, uint32_t bytes);
+
+    /**
+     * @brief Count a packet at a given time
+     *
+     * @param now_ms Time in milliseconds (steady clock)
+     * @param direction Packet direction
+     * @param bytes Packet length
+     */
+    void record_at(uint64_t now_ms, Direction direction, uint32_t bytes);
+
+    /**
+     * @brief Collect buckets completed since the last drain
+     *
+     * Buckets that fell out of the ring before being drained are skipped.
+     *
+     * @param now_ms Current time in milliseconds (steady clock)
+     * @param out Receives one sample per bucket, oldest first (appended)
+     * @return Number of samples appended
+     */
+    size_t drain(uint64_t now_ms, std::vector<ThroughputSample>& out);
+
+    /**
+     * @brief Get the interface name
+     */
+    const std::string& interface() const { return interface_; }
+
+    /**
+     * @brief Get meter statistics
+     *
+     * @return JSON object with totals per direction
+     */
+    nlohmann::json get_stats() const;
+
+    /**
+     * @brief Get the current time in milliseconds (steady clock)
+     */
+    static uint64_t get_current_time_ms();
+
+private:
+    static constexpr uint64_t RECYCLING = UINT64_MAX - 1;  // Slot id while a writer resets it
+
+    struct Slot {
+        std::atomic<uint64_t> id{UINT64_MAX};   // Bucket number this slot holds (UINT64_MAX = never used)
+        std::atomic<uint64_t> bytes[3] = {};
+        std::atomic<uint64_t> packets[3] = {};
+    };
+
+    struct alignas(64) Shard {
+        std::array<Slot, RING> slots;
+    };
+
+    std::string interface_;
+    std::array<uint8_t, 6> local_mac_{};
+    std::atomic<bool> has_local_mac_{false};
+    std::array<Shard, core::kMetricShards> shards_;
+
+    mutable std::mutex drain_mutex_;
+    uint64_t next_bucket_;              // First bucket not yet drained (guarded by drain_mutex_)
+    uint64_t drained_bytes_[3] = {};    // Totals per Direction (guarded by drain_mutex_)
+    uint64_t drained_packets_[3] = {};
+    uint64_t skipped_buckets_ = 0;      // Overwritten before being drained
+};
+
+} // namespace net
+} // namespace environet
@@ -0,0 +1,244 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <memory>
+#include <memory_resource>
+#include <mutex>
+#include <string>
+#include <vector>
+#include <nlohmann/json.hpp>
+
+#include "core/config.hpp"
+#include "core/metrics_registry.hpp"
+#include "core/sketch.hpp"
+#include "net/dissector.hpp"
+#include "net/packet_meta.hpp"
+
+namespace environet {
+namespace net {
+
+/**
+ * @brief Address a traffic volume is attributed to
+ */
+enum class TrafficKey { SrcMac, DstMac, SrcIp, DstIp };
+
+/**
+ * @brief Host kind for before/after attribution (both directions combined)
+ */
+enum class HostKind { Mac, Ip };
+
+/**
+ * @brief Heavy hitter over a time range
+ */
+struct HeavyHitter {
+    std::string host;           // MAC or IP address
+    uint64_t bytes = 0;         // Estimated bytes (upper bound)
+    uint64_t error = 0;         // Maximum overestimate
+};
+
+/**
+ * @brief A host's traffic volume before and after a point in time
+ */
+struct HostShift {
+    uint64_t hash = 0;
+    char host[core::SpaceSaving::KEY_SIZE] = {};
+    uint64_t before_bytes = 0;  // Sent plus received, estimated
+    uint64_t after_bytes = 0;
+};
+
+/**
+ * @brief Distinct devices seen on one channel
+ */
+struct ChannelDevices {
+    uint16_t frequency_mhz = 0;
+    double devices = 0.0;       // HyperLogLog estimate
+};
+
+/**
+ * @brief Distinct devices over a time range
+ */
+struct DeviceCount {
+    double devices = 0.0;                   // All unicast source MACs
+    std::vector<ChannelDevices> channels;   // Per radiotap channel (monitor mode only)
+};
+
+/**
+ * @brief Per-host traffic accounting with bounded memory
+ *
+ * Every dissected packet adds its length to a Count-Min sketch and a
+ * Space-Saving top-K summary for its source and destination MAC and IP,
+ * in the time bucket of the moment it is recorded (steady clock, the
+ * correlator's time base). Memory per capture thread is fixed at
+ * buckets x (4 sketches + 4 summaries) no matter how many distinct hosts
+ * (e.g. randomized MACs) appear. Unicast source MACs (data frames, probe
+ * requests and other management frames alike) also feed a HyperLogLog per
+ * bucket, and per channel for radiotap captures, to estimate how many
+ * devices are active.
+ *
+ * Each capture thread writes its own ring of buckets, so recording does
+ * not contend across threads; queries merge the rings of every thread
+ * over the requested range. Ranges are resolved to whole buckets.
+ */
+class TrafficAccounting {
+public:
+    /**
+     * @brief Construct from a shared configuration snapshot
+     *
+     * @param config Configuration snapshot (must not be null)
+     */
+    explicit TrafficAccounting(std::shared_ptr<const core::Config> config);
+
+    /**
+     * @brief Constructor
+     *
+     * @param config_path Path to configuration file (parsed once, defaults if unreadable)
+     */
+    explicit TrafficAccounting(const std::string& config_path);
+
+    /**
+     * @brief Initialize accounting
+     *
+     * @return true if successful, false otherwise
+     */
+    bool init();
+
+    /**
+     * @brief Check whether packets are being accounted
+     */
+    bool enabled() const { return enabled_; }
+
+    /**
+     * @brief Account a dissected packet at the current time
+     *
+     * @param meta Packet metadata (length and formatted addresses)
+     * @param layers Header positions from the dissector
+     */
+    void record(const PacketMeta& meta, const PacketLayers& layers);
+
+    /**
+     * @brief Account a dissected packet at a given time
+     *
+     * @param now_ms Time in milliseconds (steady clock)
+     * @param meta Packet metadata
+     * @param layers Header positions from the dissector
+     */
+    void record_at(uint64_t now_ms, const PacketMeta& meta, const PacketLayers& layers);
+
+    /**
+     * @brief Get the heaviest hosts for one key over a time range
+     *
+     * @param key Address to rank by
+     * @param start_time Start in milliseconds (steady clock, inclusive)
+     * @param end_time End in milliseconds (exclusive)
+     * @param k Maximum number of hosts
+     * @return Hosts sorted by estimated bytes
+     */
+    std::vector<HeavyHitter> top(TrafficKey key, uint64_t start_time, uint64_t end_time, size_t k) const;
+
+    /**
+     * @brief Compare the heaviest hosts' volume before and after a point in time
+     *
+     * Candidates are the heavy hitters of either range in either
+     * direction; volumes are Count-Min estimates of bytes sent plus
+     * received. Results are sorted by absolute change, largest first.
+     *
+     * @param kind MAC or IP addresses
+     * @param start_time Start of the "before" range in milliseconds
+     * @param split_time End of "before" and start of "after"
+     * @param end_time End of the "after" range
+     * @param out Receives the hosts (appended)
+     * @return Number of hosts appended
+     */
+    size_t host_shifts(HostKind kind, uint64_t start_time, uint64_t split_time, uint64_t end_time,
+                       std::pmr::vector<HostShift>& out) const;
+
+    /**
+     * @brief Estimate the number of distinct devices over a time range
+     *
+     * Per-bucket and per-thread counters are merged, so a device seen in
+     * several buckets or by several capture threads counts once.
+     *
+     * @param start_time Start in milliseconds (steady clock, inclusive)
+     * @param end_time End in milliseconds (exclusive)
+     * @return Device estimate overall and per channel, channels by frequency
+     */
+    DeviceCount devices(uint64_t start_time, uint64_t end_time) const;
+
+    /**
+     * @brief Get accounting statistics
+     *
+     * @return JSON object with memory use and the current top talkers
+     */
+    nlohmann::json get_stats() const;
+
+    /**
+     * @brief Get last error message
+     *
+     * @return Error message string
+     */
+    std::string get_last_error() const { return last_error_; }
+
+private:
+    static constexpr size_t KEYS = 4;
+    static constexpr size_t MAX_CHANNELS = 8;   // Channels counted per bucket; others count only overall
+
+    // Distinct-device counters for one time bucket
+    struct Devices {
+        explicit Devices(int precision);
+        void add(uint64_t hash, uint16_t frequency_mhz);
+        void clear();
+        void merge(const Devices& other);
+
+        core::HyperLogLog all;
+        std::array<uint16_t, MAX_CHANNELS> frequency{};     // 0 = free slot
+        std::vector<core::HyperLogLog> channel;
+    };
+
+    // Sketches for one time bucket
+    struct Bucket {
+        Bucket(size_t width, size_t depth, size_t top_k, int precision);
+        void clear();
+        void merge(const Bucket& other);
+
+        uint64_t id = UINT64_MAX;   // bucket_ms-sized interval this holds
+        uint64_t packets = 0;
+        uint64_t bytes = 0;
+        std::vector<core::CountMinSketch> volume;   // Per TrafficKey
+        std::vector<core::SpaceSaving> heavy;       // Per TrafficKey
+        Devices devices;
+    };
+
+    // One capture thread's ring of buckets (allocated on first use)
+    struct Shard {
+        std::mutex mutex;
+        std::vector<Bucket> ring;
+    };
+
+    void collect(Bucket& out, uint64_t start_time, uint64_t end_time) const;
+    void collect_devices(Devices& out, uint64_t start_time, uint64_t end_time) const;
+    bool bucket_range(uint64_t start_time, uint64_t end_time, uint64_t& first, uint64_t& last) const;
+    size_t bucket_bytes() const;
+    static uint64_t get_current_time_ms();
+
+    bool enabled_;
+    uint64_t bucket_ms_;
+    size_t buckets_;
+    size_t top_k_;
+    size_t sketch_width_;
+    size_t sketch_depth_;
+    int device_precision_;
+
+    mutable std::array<Shard, core::kMetricShards> shards_;
+
+    // Query scratch (guarded by query_mutex_)
+    mutable std::mutex query_mutex_;
+    mutable std::unique_ptr<Bucket> before_;
+    mutable std::unique_ptr<Bucket> after_;
+    mutable std::unique_ptr<Devices> devices_;
+
+    std::string last_error_;
+};
+
+} // namespace net
+} // namespace environet
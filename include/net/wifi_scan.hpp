@@ -6,6 +6,9 @@
 #include <chrono>
 #include <nlohmann/json.hpp>
 
+#include "core/config.hpp"
+#include "core/metrics_registry.hpp"
+
 namespace environet {
 namespace net {
 
@@ -40,10 +43,17 @@ struct BssInfo {
  */
 class WifiScan {
 public:
+    /**
+     * @brief Construct from a shared configuration snapshot
+     * 
+     * @param config Configuration snapshot (must not be null)
+     */
+    explicit WifiScan(std::shared_ptr<const core::Config> config);
+
     /**
      * @brief Constructor
      * 
-     * @param config_path Path to configuration file
+     * @param config_path Path to configuration file (parsed once, defaults if unreadable)
      */
     explicit WifiScan(const std::string& config_path);
     
@@ -102,8 +112,9 @@ private:
     // Scan state
     std::vector<BssInfo> last_scan_results_;
     std::chrono::steady_clock::time_point last_scan_time_;
-    int scan_count_;
-    int scan_errors_;
+    core::Counter& scan_count_;
+    core::Counter& scan_errors_;
+    core::Histogram& scan_latency_;
     
     // Error handling
     std::string last_error_;
@@ -132,6 +143,13 @@ private:
      */
     std::string execute_command(const std::string& command);
     
+    /**
+     * @brief Append one BSS record per result to the binary event trace
+     *
+     * @param results Scan results
+     */
+    static void trace_results(const std::vector<BssInfo>& results);
+
     /**
      * @brief Set error message
      * 
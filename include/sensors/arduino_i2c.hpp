@@ -4,11 +4,13 @@
 #include <string>
 #include <memory>
 #include <random>
+#include <atomic>
 #include <chrono>
 #include <thread>
 #include <mutex>
 
 #include "core/config.hpp"
+#include "core/metrics_registry.hpp"
 
 namespace environet {
 namespace sensors {
@@ -52,6 +54,11 @@ public:
      */
     explicit ArduinoI2C(const environet::core::Config& cfg);
 
+    /**
+     * @brief Construct from a shared configuration snapshot
+     */
+    explicit ArduinoI2C(std::shared_ptr<const environet::core::Config> cfg);
+
     /**
      * @brief Construct from a config file path (loads internally)
      */
@@ -84,6 +91,16 @@ public:
      * @brief Stop I2C communication
      */
     void stop();
+
+    /**
+     * @brief Apply settings that can change while running
+     *
+     * Only the sample interval is applied live; bus, address and mock
+     * mode need a restart.
+     *
+     * @param cfg New configuration
+     */
+    void apply_config(const environet::core::Config& cfg);
     
     /**
      * @brief Check if mock mode is enabled
@@ -92,6 +109,30 @@ public:
      */
     bool is_mock_mode() const { return mock_mode_; }
     
+    /**
+     * @brief Get sensor statistics
+     * 
+     * @return JSON object with read latency statistics
+     */
+    nlohmann::json get_stats() const;
+    
+    /**
+     * @brief Compute CRC-16-CCITT
+     * 
+     * @param data Data buffer
+     * @param len Length of data
+     * @return CRC-16 value
+     */
+    static uint16_t compute_crc16(const uint8_t* data, size_t len);
+    
+    /**
+     * @brief Validate CRC-16 in frame
+     * 
+     * @param frame Frame to validate
+     * @return true if CRC is valid
+     */
+    static bool validate_crc16(const SensorFrame& frame);
+    
     /**
      * @brief Get last error message
      * 
@@ -104,7 +145,7 @@ private:
     bool mock_mode_;
     int bus_id_;
     int addr_;
-    int sample_interval_ms_;
+    std::atomic<int> sample_interval_ms_;
     
     // Real hardware mode
     int fd_;  // I2C file descriptor
@@ -116,6 +157,9 @@ private:
     std::mutex lock_;
     uint64_t mock_reads_ = 0;
     
+    // Statistics (registered in the global metrics registry)
+    core::Histogram& read_frame_latency_;
+    
     // Error handling
     std::string last_error_;
     
@@ -125,23 +169,6 @@ private:
     bool read_frame_real(SensorFrame& frame);
     bool read_frame_mock(SensorFrame& frame);
     
-    /**
-     * @brief Compute CRC-16-CCITT
-     * 
-     * @param data Data buffer
-     * @param len Length of data
-     * @return CRC-16 value
-     */
-    static uint16_t compute_crc16(const uint8_t* data, size_t len);
-    
-    /**
-     * @brief Validate CRC-16 in frame
-     * 
-     * @param frame Frame to validate
-     * @return true if CRC is valid
-     */
-    static bool validate_crc16(const SensorFrame& frame);
-    
     /**
      * @brief Generate mock sensor data
      * 
@@ -150,7 +150,7 @@ run_tests() {
         cd "$BUILD_DIR"
         
         if [ -f "environet_tests" ]; then
-            ./environet_tests
+            ./environet_tests && ./environet_alloc_tests
             if [ $? -eq 0 ]; then
                 print_success "All tests passed"
             else
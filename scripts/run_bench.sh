@@ -0,0 +1,92 @@
+#!/bin/bash
+
+# EnviroNet Analyzer - C++ Implementation
+# Benchmark Runner Script
+#
+# Builds environet_bench and writes Google Benchmark JSON results that can
+# be archived and compared across commits (e.g. with benchmark's compare.py)
+
+set -e
+
+# Colors for output
+RED='\033[0;31m'
+GREEN='\033[0;32m'
+YELLOW='\033[1;33m'
+BLUE='\033[0;34m'
+NC='\033[0m' # No Color
+
+# Configuration
+BUILD_DIR=${BUILD_DIR:-"build-bench"}
+RESULTS_DIR=${RESULTS_DIR:-"bench_results"}
+BENCH_FILTER=${BENCH_FILTER:-""}
+BENCH_REPETITIONS=${BENCH_REPETITIONS:-3}
+JOBS=${JOBS:-$(nproc)}
+
+# Function to print colored output
+print_status() {
+    echo -e "${BLUE}[INFO]${NC} $1"
+}
+
+print_success() {
+    echo -e "${GREEN}[SUCCESS]${NC} $1"
+}
+
+print_warning() {
+    echo -e "${YELLOW}[WARNING]${NC} $1"
+}
+
+print_error() {
+    echo -e "${RED}[ERROR]${NC} $1"
+}
+
+# Build the benchmark target in Release mode
+build_bench() {
+    print_status "Configuring benchmark build in $BUILD_DIR..."
+    cmake -S . -B "$BUILD_DIR" -DCMAKE_BUILD_TYPE=Release -DENVIRONET_ENABLE_BENCH=ON
+    print_status "Building environet_bench..."
+    cmake --build "$BUILD_DIR" --target environet_bench -j"$JOBS"
+}
+
+# Run benchmarks and write JSON results
+run_bench() {
+    mkdir -p "$RESULTS_DIR"
+    local rev
+    rev=$(git rev-parse --short HEAD 2>/dev/null || echo "unknown")
+    local out="$RESULTS_DIR/bench_$(date +%Y%m%d_%H%M%S)_${rev}.json"
+
+    local args=(
+        --benchmark_out="$out"
+        --benchmark_out_format=json
+        --benchmark_repetitions="$BENCH_REPETITIONS"
+        --benchmark_report_aggregates_only=true
+    )
+    if [ -n "$BENCH_FILTER" ]; then
+        args+=(--benchmark_filter="$BENCH_FILTER")
+    fi
+
+    print_status "Running benchmarks (results: $out)..."
+    "$BUILD_DIR/environet_bench" "${args[@]}" "$@"
+    print_success "Benchmark results written to $out"
+}
+
+main() {
+    if [ ! -f "CMakeLists.txt" ]; then
+        print_error "Run this script from the project root"
+        exit 1
+    fi
+
+    if [ "$1" != "--no-build" ]; then
+        build_bench
+    else
+        shift
+    fi
+
+    if [ ! -x "$BUILD_DIR/environet_bench" ]; then
+        print_error "environet_bench not found in $BUILD_DIR"
+        exit 1
+    fi
+
+    run_bench "$@"
+}
+
+main "$@"
@@ -78,7 +78,8 @@ run_basic_tests() {
     
     # Run all tests
     print_info "Running all tests..."
-    if ./environet_tests --gtest_output=xml:test_results.xml; then
+    if ./environet_tests --gtest_output=xml:test_results.xml &&
+       ./environet_alloc_tests --gtest_output=xml:alloc_test_results.xml; then
         print_success "All basic tests passed!"
         PASSED_TESTS=$((PASSED_TESTS + 1))
     else
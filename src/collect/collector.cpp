@@ -0,0 +1,495 @@
+#include "collect/collector.hpp"
+#include "core/http_json.hpp"
+#include "core/log.hpp"
+
+#include <algorithm>
+#include <cctype>
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <vector>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+namespace environet {
+namespace collect {
+
+namespace {
+
+constexpr size_t MAX_CONNECTIONS = 1024;
+constexpr size_t READ_BUDGET = 256 * 1024;          // Per connection per wakeup, so one edge cannot starve others
+constexpr size_t MAX_PENDING_OUT = 64 * 1024;       // Stop reading from an edge that does not read its acks
+constexpr size_t MAX_EDGE_ID = 64;
+constexpr size_t DEFAULT_RECORDS = 100;
+
+const char* const ROUTES[] = {"/api/v1/edges", "/api/v1/findings", "/api/v1/rollups", "/api/v1/stats"};
+
+bool valid_edge_id(const std::string& id) {
+    if (id.empty() || id.size() > MAX_EDGE_ID) return false;
+    return std::all_of(id.begin(), id.end(), [](unsigned char c) {
+        return std::isalnum(c) || c == '-' || c == '_' || c == '.';
+    });
+}
+
+} // namespace
+
+Collector::Collector(std::shared_ptr<const core::Config> config)
+    : bind_address_(config->collector.bind_address),
+      config_port_(config->collector.port),
+      max_edges_(static_cast<size_t>(config->collector.max_edges)),
+      credits_(static_cast<size_t>(config->collector.credits)),
+      max_batch_bytes_(config->collector.max_batch_kb * 1024),
+      findings_per_edge_(static_cast<size_t>(config->collector.findings_per_edge)),
+      rollups_per_edge_(static_cast<size_t>(config->collector.rollups_per_edge)) {}
+
+Collector::~Collector() { stop(); }
+
+bool Collector::start() {
+    if (running_) return true;
+    listen_fd_ = ::socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (listen_fd_ < 0) {
+        last_error_ = std::string("socket failed: ") + std::strerror(errno);
+        return false;
+    }
+    int one = 1;
+    setsockopt(listen_fd_, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+    sockaddr_in addr{};
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(static_cast<uint16_t>(config_port_));
+    if (inet_pton(AF_INET, bind_address_.c_str(), &addr.sin_addr) != 1) {
+        last_error_ = "Invalid bind address: " + bind_address_;
+        cleanup();
+        return false;
+    }
+    if (::bind(listen_fd_, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) < 0 || ::listen(listen_fd_, 128) < 0) {
+        last_error_ = "bind " + bind_address_ + ":" + std::to_string(config_port_) + " failed: " + std::strerror(errno);
+        cleanup();
+        return false;
+    }
+    socklen_t len = sizeof(addr);
+    getsockname(listen_fd_, reinterpret_cast<sockaddr*>(&addr), &len);
+    port_ = ntohs(addr.sin_port);
+
+    epoll_fd_ = epoll_create1(EPOLL_CLOEXEC);
+    wake_fd_ = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (epoll_fd_ < 0 || wake_fd_ < 0) {
+        last_error_ = std::string("epoll/eventfd setup failed: ") + std::strerror(errno);
+        cleanup();
+        return false;
+    }
+    epoll_event ev{};
+    ev.events = EPOLLIN;
+    for (int fd : {listen_fd_, wake_fd_}) {
+        ev.data.fd = fd;
+        epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, fd, &ev);
+    }
+    running_ = true;
+    thread_ = std::thread([this]() { serve_loop(); });
+    return true;
+}
+
+bool Collector::start_api(const std::string& bind_address, int port) {
+    for (const char* route : ROUTES) {
+        api_.add_route(route, [this](const core::HttpRequest& req) { return handle(req); });
+    }
+    if (!api_.start(bind_address, port)) {
+        last_error_ = api_.get_last_error();
+        return false;
+    }
+    return true;
+}
+
+void Collector::stop() {
+    api_.stop();
+    if (running_) {
+        running_ = false;
+        uint64_t one = 1;
+        (void)::write(wake_fd_, &one, sizeof(one));
+        if (thread_.joinable()) thread_.join();
+    }
+    cleanup();
+}
+
+void Collector::cleanup() {
+    for (int* fd : {&listen_fd_, &epoll_fd_, &wake_fd_}) {
+        if (*fd >= 0) ::close(*fd);
+        *fd = -1;
+    }
+}
+
+void Collector::serve_loop() {
+    epoll_event events[64];
+    while (running_) {
+        int n = epoll_wait(epoll_fd_, events, 64, 1000);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            last_error_ = std::string("epoll_wait failed: ") + std::strerror(errno);
+            break;
+        }
+        for (int i = 0; i < n; ++i) {
+            int fd = events[i].data.fd;
+            if (fd == wake_fd_) continue;
+            if (fd == listen_fd_) {
+                accept_connections();
+                continue;
+            }
+            if (events[i].events & EPOLLIN) handle_readable(fd);
+            if ((events[i].events & EPOLLOUT) && connections_.count(fd)) handle_writable(fd);
+            if ((events[i].events & (EPOLLERR | EPOLLHUP)) && connections_.count(fd)) close_connection(fd);
+        }
+    }
+    while (!connections_.empty()) close_connection(connections_.begin()->first);
+}
+
+void Collector::accept_connections() {
+    while (true) {
+        sockaddr_in addr{};
+        socklen_t len = sizeof(addr);
+        int fd = ::accept4(listen_fd_, reinterpret_cast<sockaddr*>(&addr), &len, SOCK_NONBLOCK | SOCK_CLOEXEC);
+        if (fd < 0) return;
+        if (connections_.size() >= MAX_CONNECTIONS) {
+            ::close(fd);
+            ++connections_rejected_;
+            continue;
+        }
+        int one = 1;
+        setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+        epoll_event ev{};
+        ev.events = EPOLLIN;
+        ev.data.fd = fd;
+        if (epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, fd, &ev) < 0) {
+            ::close(fd);
+            continue;
+        }
+        char ip[INET_ADDRSTRLEN] = {};
+        inet_ntop(AF_INET, &addr.sin_addr, ip, sizeof(ip));
+        connections_[fd].peer = std::string(ip) + ":" + std::to_string(ntohs(addr.sin_port));
+        ++connections_accepted_;
+    }
+}
+
+void Collector::handle_readable(int fd) {
+    auto it = connections_.find(fd);
+    if (it == connections_.end()) return;
+    Connection& conn = it->second;
+    size_t max_payload = BATCH_HEADER_SIZE + max_batch_bytes_;
+    size_t budget = READ_BUDGET;
+    char buf[16384];
+    while (budget > 0 && !conn.close_after_write) {
+        ssize_t n = ::recv(fd, buf, std::min(sizeof(buf), budget), 0);
+        if (n == 0) {
+            close_connection(fd);
+            return;
+        }
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            if (errno == EAGAIN || errno == EWOULDBLOCK) break;
+            close_connection(fd);
+            return;
+        }
+        conn.in.append(buf, static_cast<size_t>(n));
+        budget -= static_cast<size_t>(n);
+
+        // Apply complete frames as they arrive so a connection buffers at most one batch
+        Frame frame;
+        int got;
+        while (!conn.close_after_write && (got = take_frame(conn.in, frame, max_payload)) != 0) {
+            if (got < 0) {
+                reject(conn, "bad frame");
+                break;
+            }
+            if (!handle_frame(fd, conn, frame)) break;
+        }
+    }
+    handle_writable(fd);
+}
+
+void Collector::handle_writable(int fd) {
+    auto it = connections_.find(fd);
+    if (it == connections_.end()) return;
+    Connection& conn = it->second;
+    while (conn.out_pos < conn.out.size()) {
+        ssize_t n = ::send(fd, conn.out.data() + conn.out_pos, conn.out.size() - conn.out_pos, MSG_NOSIGNAL);
+        if (n > 0) {
+            conn.out_pos += static_cast<size_t>(n);
+            continue;
+        }
+        if (n < 0 && errno == EINTR) continue;
+        if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) break;
+        close_connection(fd);
+        return;
+    }
+    if (conn.out_pos == conn.out.size()) {
+        conn.out.clear();
+        conn.out_pos = 0;
+        if (conn.close_after_write) {
+            close_connection(fd);
+            return;
+        }
+    }
+    size_t pending = conn.out.size() - conn.out_pos;
+    epoll_event ev{};
+    ev.events = (pending < MAX_PENDING_OUT && !conn.close_after_write ? static_cast<uint32_t>(EPOLLIN) : 0u) |
+                (pending ? static_cast<uint32_t>(EPOLLOUT) : 0u);
+    ev.data.fd = fd;
+    epoll_ctl(epoll_fd_, EPOLL_CTL_MOD, fd, &ev);
+}
+
+void Collector::close_connection(int fd) {
+    epoll_ctl(epoll_fd_, EPOLL_CTL_DEL, fd, nullptr);
+    ::close(fd);
+    auto it = connections_.find(fd);
+    if (it == connections_.end()) return;
+    if (!it->second.edge.empty()) {
+        std::lock_guard<std::mutex> lock(edges_mutex_);
+        auto edge = edges_.find(it->second.edge);
+        if (edge != edges_.end() && edge->second.peer == it->second.peer) edge->second.connected = false;
+        LOGI("Collector: edge '{}' ({}) disconnected", it->second.edge, it->second.peer);
+    }
+    connections_.erase(it);
+}
+
+bool Collector::handle_frame(int fd, Connection& conn, const Frame& frame) {
+    switch (frame.type) {
+    case FrameType::Hello:
+        return hello(fd, conn, frame);
+    case FrameType::Batch:
+        return apply_batch(conn, frame);
+    default:
+        reject(conn, "unexpected frame");
+        return false;
+    }
+}
+
+bool Collector::hello(int fd, Connection& conn, const Frame& frame) {
+    auto j = nlohmann::json::parse(frame.payload, nullptr, false);
+    if (!conn.edge.empty() || !j.is_object() || j.value("proto", 0) != PROTOCOL_VERSION) {
+        reject(conn, "expected hello with proto " + std::to_string(PROTOCOL_VERSION));
+        return false;
+    }
+    std::string id = j.value("edge", "");
+    if (!valid_edge_id(id)) {
+        reject(conn, "invalid edge name");
+        return false;
+    }
+    // A reconnecting edge replaces its stale connection
+    for (auto& kv : connections_) {
+        if (kv.first != fd && kv.second.edge == id) {
+            kv.second.edge.clear();
+            kv.second.close_after_write = true;
+            handle_writable(kv.first);
+            break;
+        }
+    }
+    uint64_t acked;
+    {
+        std::lock_guard<std::mutex> lock(edges_mutex_);
+        auto it = edges_.find(id);
+        if (it == edges_.end()) {
+            if (edges_.size() >= max_edges_) {
+                reject(conn, "too many edges");
+                return false;
+            }
+            it = edges_.emplace(id, Edge()).first;
+        }
+        it->second.connected = true;
+        it->second.peer = conn.peer;
+        it->second.last_seen_ms = wall_ms();
+        // The edge's spool started over (e.g. was wiped): its sequence begins again
+        Edge& edge = it->second;
+        uint64_t epoch = j.value("epoch", uint64_t{0});
+        uint64_t next_seq = j.value("next_seq", uint64_t{0});
+        bool new_epoch = epoch != 0 && edge.epoch != 0 && epoch != edge.epoch;
+        if (new_epoch || (next_seq > 0 && edge.acked_seq >= next_seq)) {
+            LOGW("Collector: edge '{}' restarted its sequence (epoch {:x}, next {}, acked through {}); "
+                 "resetting its cursor", id, epoch, next_seq, edge.acked_seq);
+            edge.acked_seq = 0;
+            ++edge.sequence_resets;
+        }
+        if (epoch != 0) edge.epoch = epoch;
+        acked = edge.acked_seq;
+    }
+    conn.edge = id;
+    nlohmann::json welcome = {{"credits", credits_}, {"acked_seq", acked}};
+    append_frame(conn.out, FrameType::Welcome, 0, welcome.dump());
+    LOGI("Collector: edge '{}' connected from {} (acked through {})", id, conn.peer, acked);
+    return true;
+}
+
+bool Collector::apply_batch(Connection& conn, const Frame& frame) {
+    Batch batch;
+    if (conn.edge.empty()) {
+        reject(conn, "hello first");
+        return false;
+    }
+    if (!decode_batch(frame, batch, max_batch_bytes_)) {
+        reject(conn, "malformed batch");
+        return false;
+    }
+    ++batches_;
+    bytes_in_ += frame.payload.size();
+
+    std::lock_guard<std::mutex> lock(edges_mutex_);
+    Edge& edge = edges_[conn.edge];
+    edge.last_seen_ms = wall_ms();
+    edge.bytes += frame.payload.size();
+    if (batch.seq <= edge.acked_seq) {
+        // Resent after a lost ack; applied already
+        ++edge.duplicates;
+        ++duplicates_;
+        append_ack_frame(conn.out, edge.acked_seq);
+        return true;
+    }
+    bytes_raw_ += batch.body.size();
+    // Records up to acked_seq were applied from an earlier, differently cut batch
+    uint64_t first = batch.seq - std::min<uint64_t>(batch.seq, batch.records) + 1;
+    uint64_t skip = first <= edge.acked_seq ? edge.acked_seq - first + 1 : 0;
+    size_t pos = 0;
+    while (pos < batch.body.size()) {
+        size_t end = batch.body.find('\n', pos);
+        if (end == std::string::npos) end = batch.body.size();
+        if (skip > 0) {
+            --skip;
+            pos = end + 1;
+            continue;
+        }
+        auto j = nlohmann::json::parse(batch.body.begin() + static_cast<std::ptrdiff_t>(pos),
+                                       batch.body.begin() + static_cast<std::ptrdiff_t>(end), nullptr, false);
+        pos = end + 1;
+        std::string kind = j.is_object() ? j.value("kind", "") : "";
+        if ((kind != "finding" && kind != "rollup") || !j.contains("data")) {
+            ++edge.bad_records;
+            continue;
+        }
+        Record rec{j.value("wall_ms", uint64_t{0}), j.value("interval_ms", uint64_t{0}), j["data"].dump()};
+        auto& list = kind == "finding" ? edge.findings : edge.rollups;
+        size_t cap = kind == "finding" ? findings_per_edge_ : rollups_per_edge_;
+        list.push_back(std::move(rec));
+        if (list.size() > cap) list.pop_front();
+        ++edge.records;
+        ++records_;
+    }
+    ++edge.batches;
+    edge.acked_seq = batch.seq;
+    append_ack_frame(conn.out, batch.seq);
+    return true;
+}
+
+void Collector::reject(Connection& conn, const std::string& message) {
+    LOGW("Collector: rejecting {}{}: {}", conn.peer, conn.edge.empty() ? "" : " ('" + conn.edge + "')", message);
+    append_frame(conn.out, FrameType::Error, 0, nlohmann::json{{"error", message}}.dump());
+    conn.close_after_write = true;
+    ++connections_rejected_;
+}
+
+core::HttpResponse Collector::handle(const core::HttpRequest& req) const {
+    uint64_t now = wall_ms();
+    if (req.path == "/api/v1/edges") {
+        nlohmann::json j;
+        j["now_ms"] = now;
+        j["edges"] = get_edges();
+        return core::json_response(200, j.dump());
+    }
+    if (req.path == "/api/v1/stats") {
+        nlohmann::json j = get_stats();
+        j["now_ms"] = now;
+        return core::json_response(200, j.dump());
+    }
+    if (req.path == "/api/v1/findings" || req.path == "/api/v1/rollups") {
+        uint64_t since = 0;
+        uint64_t limit = DEFAULT_RECORDS;
+        if (!core::param_u64(req, "since", since) || !core::param_u64(req, "limit", limit)) {
+            ++bad_requests_;
+            return core::error_response(400, "since and limit must be non-negative integers");
+        }
+        bool rollups = req.path == "/api/v1/rollups";
+        std::string body;
+        core::JsonWriter out(body);
+        out.begin_object().field("now_ms", now).key(rollups ? "rollups" : "findings");
+        write_records(out, rollups, req.query_param("edge"), since, static_cast<size_t>(limit));
+        out.end_object();
+        return core::json_response(200, std::move(body));
+    }
+    return core::error_response(404, "unknown endpoint");
+}
+
+nlohmann::json Collector::get_edges() const {
+    nlohmann::json j = nlohmann::json::object();
+    std::lock_guard<std::mutex> lock(edges_mutex_);
+    for (const auto& kv : edges_) {
+        const Edge& e = kv.second;
+        j[kv.first] = {
+            {"connected", e.connected},
+            {"peer", e.peer},
+            {"acked_seq", e.acked_seq},
+            {"last_seen_ms", e.last_seen_ms},
+            {"batches", e.batches},
+            {"duplicates", e.duplicates},
+            {"records", e.records},
+            {"bad_records", e.bad_records},
+            {"sequence_resets", e.sequence_resets},
+            {"bytes", e.bytes},
+            {"findings", e.findings.size()},
+            {"rollups", e.rollups.size()}
+        };
+    }
+    return j;
+}
+
+size_t Collector::write_records(core::JsonWriter& out, bool rollups, const std::string& edge, uint64_t since_ms,
+                                size_t limit) const {
+    std::lock_guard<std::mutex> lock(edges_mutex_);
+    std::vector<std::pair<const std::string*, const Record*>> selected;
+    for (const auto& kv : edges_) {
+        if (!edge.empty() && kv.first != edge) continue;
+        for (const auto& rec : rollups ? kv.second.rollups : kv.second.findings) {
+            if (rec.wall_ms > since_ms) selected.emplace_back(&kv.first, &rec);
+        }
+    }
+    std::stable_sort(selected.begin(), selected.end(),
+                     [](const auto& a, const auto& b) { return a.second->wall_ms < b.second->wall_ms; });
+    size_t first = selected.size() > limit ? selected.size() - limit : 0;
+    out.begin_array();
+    for (size_t i = first; i < selected.size(); ++i) {
+        const Record& rec = *selected[i].second;
+        out.begin_object().field("edge", *selected[i].first).field("wall_ms", rec.wall_ms);
+        if (rollups) out.field("interval_ms", rec.interval_ms);
+        out.key("data").raw(rec.data).end_object();
+    }
+    out.end_array();
+    return selected.size() - first;
+}
+
+nlohmann::json Collector::get_stats() const {
+    nlohmann::json j;
+    j["port"] = port_;
+    {
+        std::lock_guard<std::mutex> lock(edges_mutex_);
+        j["edges"] = edges_.size();
+        j["edges_connected"] = std::count_if(edges_.begin(), edges_.end(),
+                                             [](const auto& kv) { return kv.second.connected; });
+    }
+    j["connections_accepted"] = connections_accepted_.load();
+    j["connections_rejected"] = connections_rejected_.load();
+    j["batches"] = batches_.load();
+    j["duplicates"] = duplicates_.load();
+    j["records"] = records_.load();
+    j["bytes_in"] = bytes_in_.load();
+    j["bytes_raw"] = bytes_raw_.load();
+    j["api"] = api_.get_stats();
+    j["api"]["bad_requests"] = bad_requests_.load();
+    return j;
+}
+
+uint64_t Collector::wall_ms() {
+    using namespace std::chrono;
+    return duration_cast<milliseconds>(system_clock::now().time_since_epoch()).count();
+}
+
+} // namespace collect
+} // namespace environet
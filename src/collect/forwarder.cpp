@@ -0,0 +1,457 @@
+#include "collect/forwarder.hpp"
+#include "core/json_writer.hpp"
+#include "core/log.hpp"
+#include "correlate/correlator.hpp"
+
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <poll.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+namespace environet {
+namespace collect {
+
+namespace {
+
+constexpr uint64_t HANDSHAKE_TIMEOUT_MS = 5000;
+constexpr size_t MAX_CONTROL_PAYLOAD = 64 * 1024;   // Welcome, Ack and Error frames are small
+constexpr size_t MAX_BATCH_BODY = 1024 * 1024;      // Well under the collector's default max_batch_kb
+constexpr size_t MB = 1024 * 1024;
+
+} // namespace
+
+Forwarder::Forwarder(std::shared_ptr<const core::Config> config)
+    : host_(config->forward.collector_host),
+      port_(config->forward.collector_port),
+      edge_id_(config->forward.edge_id),
+      batch_interval_ms_(config->forward.batch_interval_ms),
+      batch_max_records_(static_cast<size_t>(config->forward.batch_max_records)),
+      rollup_interval_ms_(config->forward.rollup_interval_ms),
+      sync_interval_ms_(config->forward.sync_interval_ms),
+      reconnect_ms_(config->forward.reconnect_ms),
+      wal_(config->forward.spool_dir, config->forward.spool_segment_mb * MB, config->forward.spool_max_mb * MB) {
+    parse_compression(config->forward.compression, compression_);
+    if (edge_id_.empty()) {
+        char host[256] = {};
+        edge_id_ = gethostname(host, sizeof(host) - 1) == 0 && host[0] ? host : "edge";
+    }
+}
+
+Forwarder::~Forwarder() {
+    stop();
+    if (wake_fd_ >= 0) ::close(wake_fd_);
+}
+
+bool Forwarder::init() {
+    if (!wal_.open()) {
+        set_error("Cannot open spool: " + wal_.get_last_error());
+        return false;
+    }
+    if (wake_fd_ < 0) wake_fd_ = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (wake_fd_ < 0) {
+        set_error(std::string("eventfd failed: ") + std::strerror(errno));
+        return false;
+    }
+    return true;
+}
+
+bool Forwarder::start() {
+    if (running_) return true;
+    if (wake_fd_ < 0) {
+        set_error("Forwarder not initialized");
+        return false;
+    }
+    running_ = true;
+    thread_ = std::thread([this]() { run(); });
+    return true;
+}
+
+void Forwarder::stop() {
+    if (running_) {
+        running_ = false;
+        wake();
+        if (thread_.joinable()) thread_.join();
+    }
+    // Whatever is still buffered becomes durable for the next run
+    if (wake_fd_ >= 0 && !wal_.sync()) {
+        LOGW("Forwarder: spool sync failed: {}", wal_.get_last_error());
+    }
+}
+
+void Forwarder::publish_finding(const correlate::Finding& finding) {
+    std::string record;
+    core::JsonWriter out(record);
+    out.begin_object().field("kind", "finding").field("wall_ms", wall_ms()).key("data");
+    correlate::write_finding(out, finding);
+    out.end_object();
+    add_record(record);
+}
+
+void Forwarder::add_record(const std::string& record) {
+    uint64_t lsn = wal_.append(record);
+    if (lsn == 0) {
+        ++records_dropped_;
+        LOGW_RATELIMITED(60000, "Forwarder: cannot spool record: {}", wal_.get_last_error());
+        return;
+    }
+    ++records_;
+    // A full batch goes out without waiting for the interval
+    if (lsn % batch_max_records_ == 0) flush();
+}
+
+void Forwarder::flush() {
+    flush_requested_ = true;
+    wake();
+}
+
+size_t Forwarder::spooled() const {
+    uint64_t last = wal_.next_lsn() - 1;
+    uint64_t done = std::max(acked_seq_.load(), wal_.first_lsn() - 1);
+    return last > done ? static_cast<size_t>(last - done) : 0;
+}
+
+void Forwarder::run() {
+    uint64_t now = now_ms();
+    uint64_t next_sync = now + static_cast<uint64_t>(sync_interval_ms_);
+    uint64_t next_batch = now + static_cast<uint64_t>(batch_interval_ms_);
+    uint64_t next_rollup = rollup_interval_ms_ > 0 ? now + static_cast<uint64_t>(rollup_interval_ms_) : UINT64_MAX;
+    uint64_t next_connect = now;
+
+    while (running_) {
+        now = now_ms();
+        if (now >= next_rollup) {
+            add_rollup(static_cast<uint64_t>(rollup_interval_ms_));
+            next_rollup = now + static_cast<uint64_t>(rollup_interval_ms_);
+        }
+        // One fdatasync covers everything appended since the last one
+        bool flush = flush_requested_.exchange(false);
+        if (flush || now >= next_sync) {
+            if (!wal_.sync()) LOGW_RATELIMITED(60000, "Forwarder: spool sync failed: {}", wal_.get_last_error());
+            next_sync = now + static_cast<uint64_t>(sync_interval_ms_);
+        }
+        bool partial = flush || now >= next_batch;
+        if (partial) next_batch = now + static_cast<uint64_t>(batch_interval_ms_);
+        if (fd_ < 0 && now >= next_connect) {
+            if (connect_collector()) {
+                next_batch = 0;     // Send the backlog right away
+            } else {
+                LOGW_RATELIMITED(60000, "Forwarder: cannot reach collector {}:{}: {}", host_, port_, get_last_error());
+                next_connect = now_ms() + static_cast<uint64_t>(reconnect_ms_);
+            }
+            continue;
+        }
+        if (fd_ >= 0 && !send_batches(partial)) {
+            disconnect("send failed: " + std::string(std::strerror(errno)));
+            next_connect = now_ms() + static_cast<uint64_t>(reconnect_ms_);
+        }
+
+        uint64_t deadline = std::min({next_sync, next_batch, next_rollup});
+        if (fd_ < 0) deadline = std::min(deadline, next_connect);
+        now = now_ms();
+        int timeout = deadline > now ? static_cast<int>(std::min<uint64_t>(deadline - now, 60000)) : 0;
+
+        pollfd fds[2] = {{wake_fd_, POLLIN, 0}, {fd_, POLLIN, 0}};
+        if (out_pos_ < out_.size()) fds[1].events |= POLLOUT;
+        int n = ::poll(fds, fd_ >= 0 ? 2 : 1, timeout);
+        if (n <= 0) continue;
+        if (fds[0].revents & POLLIN) {
+            uint64_t count;
+            (void)::read(wake_fd_, &count, sizeof(count));
+        }
+        if (fd_ >= 0 && (fds[1].revents & (POLLIN | POLLHUP | POLLERR)) && !read_frames()) {
+            disconnect(get_last_error());
+            next_connect = now_ms() + static_cast<uint64_t>(reconnect_ms_);
+        }
+    }
+    if (fd_ >= 0) disconnect({});
+}
+
+void Forwarder::add_rollup(uint64_t interval_ms) {
+    if (!rollup_provider_) return;
+    nlohmann::json data;
+    try {
+        data = rollup_provider_();
+    } catch (const std::exception& e) {
+        LOGW_RATELIMITED(60000, "Forwarder: rollup failed: {}", e.what());
+        return;
+    }
+    std::string record;
+    core::JsonWriter out(record);
+    out.begin_object().field("kind", "rollup").field("wall_ms", wall_ms()).field("interval_ms", interval_ms);
+    out.key("data").raw(data.dump()).end_object();
+    add_record(record);
+}
+
+bool Forwarder::connect_collector() {
+    addrinfo hints{};
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_STREAM;
+    addrinfo* res = nullptr;
+    int rc = getaddrinfo(host_.c_str(), std::to_string(port_).c_str(), &hints, &res);
+    if (rc != 0 || !res) {
+        set_error(std::string("resolve failed: ") + gai_strerror(rc));
+        return false;
+    }
+    fd_ = ::socket(res->ai_family, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (fd_ < 0) {
+        set_error(std::string("socket failed: ") + std::strerror(errno));
+        freeaddrinfo(res);
+        return false;
+    }
+    rc = ::connect(fd_, res->ai_addr, res->ai_addrlen);
+    freeaddrinfo(res);
+    uint64_t deadline = now_ms() + HANDSHAKE_TIMEOUT_MS;
+    if (rc != 0 && errno != EINPROGRESS) {
+        set_error(std::string("connect failed: ") + std::strerror(errno));
+        disconnect({});
+        return false;
+    }
+    int err = 0;
+    socklen_t len = sizeof(err);
+    if (rc != 0 && (!wait_fd(fd_, POLLOUT, deadline) || getsockopt(fd_, SOL_SOCKET, SO_ERROR, &err, &len) != 0 || err)) {
+        set_error(err ? std::string("connect failed: ") + std::strerror(err) : "connect timed out");
+        disconnect({});
+        return false;
+    }
+    int one = 1;
+    setsockopt(fd_, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+
+    in_.clear();
+    out_.clear();
+    out_pos_ = 0;
+    nlohmann::json hello = {{"edge", edge_id_}, {"proto", PROTOCOL_VERSION}, {"epoch", wal_.epoch()},
+                            {"next_seq", wal_.next_lsn()}};
+    append_frame(out_, FrameType::Hello, 0, hello.dump());
+    while (out_pos_ < out_.size()) {
+        if (!flush_out() || (out_pos_ < out_.size() && !wait_fd(fd_, POLLOUT, deadline))) {
+            set_error("handshake send failed");
+            disconnect({});
+            return false;
+        }
+    }
+
+    Frame frame;
+    while (true) {
+        int got = take_frame(in_, frame, MAX_CONTROL_PAYLOAD);
+        if (got < 0) {
+            set_error("bad frame from collector");
+            disconnect({});
+            return false;
+        }
+        if (got > 0) break;
+        char buf[4096];
+        ssize_t n = ::recv(fd_, buf, sizeof(buf), 0);
+        if (n > 0) {
+            in_.append(buf, static_cast<size_t>(n));
+        } else if ((n == 0) || (errno != EAGAIN && errno != EINTR) || !wait_fd(fd_, POLLIN, deadline)) {
+            set_error(n == 0 ? "collector closed the connection" : "no welcome from collector");
+            disconnect({});
+            return false;
+        }
+    }
+    nlohmann::json welcome = nlohmann::json::parse(frame.payload, nullptr, false);
+    if (frame.type != FrameType::Welcome || !welcome.is_object()) {
+        set_error(frame.type == FrameType::Error && welcome.is_object() ? welcome.value("error", "rejected")
+                                                                         : "unexpected frame from collector");
+        disconnect({});
+        return false;
+    }
+    uint64_t acked = welcome.value("acked_seq", uint64_t{0});
+    if (acked >= hello["next_seq"].get<uint64_t>()) {
+        // The collector did not reset its cursor for our restarted spool:
+        // acking up to its seq would discard records it never received
+        set_error("collector has records up to " + std::to_string(acked) + " but the spool restarted at " +
+                  hello["next_seq"].dump() + "; keeping records spooled");
+        disconnect({});
+        return false;
+    }
+    credits_ = std::max<size_t>(1, welcome.value("credits", size_t{1}));
+    in_flight_.clear();
+    // Records the collector applied before an ack was lost (or in a previous run)
+    handle_ack(acked);
+    next_send_lsn_ = std::max(acked + 1, wal_.first_lsn());
+    connected_ = true;
+    ++connects_;
+    LOGI("Forwarder: connected to collector {}:{} as '{}' ({} credits, {} records spooled)", host_, port_, edge_id_,
+         credits_, spooled());
+    return true;
+}
+
+// Wait for fd to become ready; false on timeout or when stopping
+bool Forwarder::wait_fd(int fd, short events, uint64_t deadline_ms) {
+    while (running_) {
+        uint64_t now = now_ms();
+        if (now >= deadline_ms) return false;
+        pollfd fds[2] = {{fd, events, 0}, {wake_fd_, POLLIN, 0}};
+        int n = ::poll(fds, 2, static_cast<int>(deadline_ms - now));
+        if (n < 0 && errno != EINTR) return false;
+        if (n > 0 && fds[0].revents) return true;
+        if (n > 0 && (fds[1].revents & POLLIN)) {
+            // Keep the wakeup for the main loop; only stop() interrupts a handshake
+            if (!running_) return false;
+            uint64_t count;
+            (void)::read(wake_fd_, &count, sizeof(count));
+            if (flush_requested_.exchange(false)) wal_.sync();
+        }
+    }
+    return false;
+}
+
+void Forwarder::disconnect(const std::string& reason) {
+    if (fd_ >= 0) ::close(fd_);
+    fd_ = -1;
+    in_.clear();
+    out_.clear();
+    out_pos_ = 0;
+    credits_ = 0;
+    in_flight_.clear();     // Unacknowledged records are sent again on the next connection
+    if (connected_.exchange(false) && !reason.empty()) {
+        LOGW("Forwarder: disconnected from collector {}:{}: {}", host_, port_, reason);
+    }
+}
+
+// Sends full batches while credits last, and a final partial batch when
+// partial is set; only synced records are read from the spool.
+bool Forwarder::send_batches(bool partial) {
+    if (!flush_out()) return false;
+    if (out_pos_ < out_.size()) return true;    // Socket full; wait for POLLOUT
+    while (in_flight_.size() < credits_) {
+        uint64_t synced = wal_.synced_lsn();
+        if (next_send_lsn_ > synced) break;
+        if (!partial && synced - next_send_lsn_ + 1 < batch_max_records_) break;
+        body_.clear();
+        uint64_t last = 0;
+        size_t records = wal_.read(next_send_lsn_, batch_max_records_, MAX_BATCH_BODY,
+                                   [&](uint64_t lsn, std::string_view record) {
+                                       body_.append(record.data(), record.size());
+                                       body_ += '\n';
+                                       last = lsn;
+                                   });
+        if (records == 0) break;
+        size_t before = out_.size();
+        append_batch_frame(out_, last, static_cast<uint32_t>(records), body_, compression_);
+        in_flight_.push_back(last);
+        next_send_lsn_ = last + 1;
+        sent_lsn_ = last;
+        ++batches_sent_;
+        bytes_raw_ += body_.size();
+        bytes_sent_ += out_.size() - before;
+    }
+    return flush_out();
+}
+
+bool Forwarder::flush_out() {
+    while (out_pos_ < out_.size()) {
+        ssize_t n = ::send(fd_, out_.data() + out_pos_, out_.size() - out_pos_, MSG_NOSIGNAL);
+        if (n > 0) {
+            out_pos_ += static_cast<size_t>(n);
+            continue;
+        }
+        if (n < 0 && errno == EINTR) continue;
+        if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) return true;
+        return false;
+    }
+    out_.clear();
+    out_pos_ = 0;
+    return true;
+}
+
+bool Forwarder::read_frames() {
+    char buf[4096];
+    while (true) {
+        ssize_t n = ::recv(fd_, buf, sizeof(buf), 0);
+        if (n > 0) {
+            in_.append(buf, static_cast<size_t>(n));
+            continue;
+        }
+        if (n == 0) {
+            set_error("collector closed the connection");
+            return false;
+        }
+        if (errno == EINTR) continue;
+        if (errno == EAGAIN || errno == EWOULDBLOCK) break;
+        set_error(std::string("recv failed: ") + std::strerror(errno));
+        return false;
+    }
+    Frame frame;
+    int got;
+    while ((got = take_frame(in_, frame, MAX_CONTROL_PAYLOAD)) > 0) {
+        uint64_t seq = 0;
+        if (decode_ack(frame, seq)) {
+            handle_ack(seq);
+            continue;
+        }
+        auto j = nlohmann::json::parse(frame.payload, nullptr, false);
+        set_error(frame.type == FrameType::Error && j.is_object() ? "collector error: " + j.value("error", "")
+                                                                   : "unexpected frame from collector");
+        return false;
+    }
+    if (got < 0) {
+        set_error("bad frame from collector");
+        return false;
+    }
+    return true;
+}
+
+void Forwarder::handle_ack(uint64_t seq) {
+    if (seq > acked_seq_) acked_seq_ = seq;
+    while (!in_flight_.empty() && in_flight_.front() <= seq) {
+        in_flight_.pop_front();
+        ++batches_acked_;
+    }
+    wal_.release(seq);
+}
+
+void Forwarder::wake() {
+    uint64_t one = 1;
+    if (wake_fd_ >= 0) (void)::write(wake_fd_, &one, sizeof(one));
+}
+
+nlohmann::json Forwarder::get_stats() const {
+    nlohmann::json j;
+    j["edge_id"] = edge_id_;
+    j["collector"] = host_ + ":" + std::to_string(port_);
+    j["connected"] = connected_.load();
+    j["records"] = records_.load();
+    j["records_dropped"] = records_dropped_.load();
+    j["batches_sent"] = batches_sent_.load();
+    j["batches_acked"] = batches_acked_.load();
+    j["bytes_raw"] = bytes_raw_.load();
+    j["bytes_sent"] = bytes_sent_.load();
+    j["connects"] = connects_.load();
+    j["acked_seq"] = acked_seq_.load();
+    j["sent_seq"] = sent_lsn_.load();
+    j["spooled_records"] = spooled();
+    j["spool"] = wal_.get_stats();
+    return j;
+}
+
+std::string Forwarder::get_last_error() const {
+    std::lock_guard<std::mutex> lock(error_mutex_);
+    return last_error_;
+}
+
+void Forwarder::set_error(const std::string& error) {
+    std::lock_guard<std::mutex> lock(error_mutex_);
+    last_error_ = error;
+}
+
+uint64_t Forwarder::now_ms() {
+    using namespace std::chrono;
+    return duration_cast<milliseconds>(steady_clock::now().time_since_epoch()).count();
+}
+
+uint64_t Forwarder::wall_ms() {
+    using namespace std::chrono;
+    return duration_cast<milliseconds>(system_clock::now().time_since_epoch()).count();
+}
+
+} // namespace collect
+} // namespace environet
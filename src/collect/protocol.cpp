@@ -0,0 +1,125 @@
+#include "collect/protocol.hpp"
+
+#include <zlib.h>
+
+namespace environet {
+namespace collect {
+
+namespace {
+
+template <typename T>
+void put_le(std::string& out, T value) {
+    for (size_t i = 0; i < sizeof(T); ++i) out += static_cast<char>(static_cast<uint64_t>(value) >> (i * 8));
+}
+
+template <typename T>
+T get_le(const char* p) {
+    uint64_t v = 0;
+    for (size_t i = 0; i < sizeof(T); ++i) v |= uint64_t{static_cast<uint8_t>(p[i])} << (i * 8);
+    return static_cast<T>(v);
+}
+
+uint32_t checksum(std::string_view data) {
+    return static_cast<uint32_t>(
+        crc32(0L, reinterpret_cast<const Bytef*>(data.data()), static_cast<uInt>(data.size())));
+}
+
+} // namespace
+
+void append_frame(std::string& out, FrameType type, uint8_t flags, std::string_view payload) {
+    put_le(out, FRAME_MAGIC);
+    put_le(out, static_cast<uint8_t>(type));
+    put_le(out, flags);
+    put_le(out, uint16_t{0});
+    put_le(out, static_cast<uint32_t>(payload.size()));
+    put_le(out, checksum(payload));
+    out.append(payload);
+}
+
+int take_frame(std::string& in, Frame& frame, size_t max_payload) {
+    if (in.size() < FRAME_HEADER_SIZE) return 0;
+    if (get_le<uint32_t>(in.data()) != FRAME_MAGIC) return -1;
+    uint32_t len = get_le<uint32_t>(in.data() + 8);
+    if (len > max_payload) return -1;
+    if (in.size() < FRAME_HEADER_SIZE + len) return 0;
+    std::string_view payload(in.data() + FRAME_HEADER_SIZE, len);
+    if (checksum(payload) != get_le<uint32_t>(in.data() + 12)) return -1;
+    frame.type = static_cast<FrameType>(in[4]);
+    frame.flags = static_cast<uint8_t>(in[5]);
+    frame.payload.assign(payload);
+    in.erase(0, FRAME_HEADER_SIZE + len);
+    return 1;
+}
+
+void append_batch_frame(std::string& out, uint64_t seq, uint32_t records, std::string_view body,
+                        Compression compression) {
+    std::string payload;
+    payload.reserve(BATCH_HEADER_SIZE + body.size());
+    put_le(payload, seq);
+    put_le(payload, records);
+    put_le(payload, static_cast<uint32_t>(body.size()));
+    uint8_t flags = 0;
+    if (compression == Compression::Zlib && !body.empty()) {
+        // Level 1: most of the gain on repetitive JSON at a fraction of the CPU
+        uLongf packed = compressBound(static_cast<uLong>(body.size()));
+        payload.resize(BATCH_HEADER_SIZE + packed);
+        if (compress2(reinterpret_cast<Bytef*>(&payload[BATCH_HEADER_SIZE]), &packed,
+                      reinterpret_cast<const Bytef*>(body.data()), static_cast<uLong>(body.size()), 1) == Z_OK &&
+            packed < body.size()) {
+            payload.resize(BATCH_HEADER_SIZE + packed);
+            flags = FLAG_ZLIB;
+        } else {
+            payload.resize(BATCH_HEADER_SIZE);
+        }
+    }
+    if (!(flags & FLAG_ZLIB)) payload.append(body);
+    append_frame(out, FrameType::Batch, flags, payload);
+}
+
+bool decode_batch(const Frame& frame, Batch& batch, size_t max_body) {
+    if (frame.type != FrameType::Batch || frame.payload.size() < BATCH_HEADER_SIZE) return false;
+    const char* p = frame.payload.data();
+    batch.seq = get_le<uint64_t>(p);
+    batch.records = get_le<uint32_t>(p + 8);
+    uint32_t raw_len = get_le<uint32_t>(p + 12);
+    if (raw_len > max_body) return false;
+    std::string_view data(p + BATCH_HEADER_SIZE, frame.payload.size() - BATCH_HEADER_SIZE);
+    if (!(frame.flags & FLAG_ZLIB)) {
+        if (data.size() != raw_len) return false;
+        batch.body.assign(data);
+        return true;
+    }
+    batch.body.resize(raw_len);
+    uLongf len = raw_len;
+    if (uncompress(reinterpret_cast<Bytef*>(&batch.body[0]), &len, reinterpret_cast<const Bytef*>(data.data()),
+                   static_cast<uLong>(data.size())) != Z_OK) {
+        return false;
+    }
+    return len == raw_len;
+}
+
+void append_ack_frame(std::string& out, uint64_t seq) {
+    std::string payload;
+    put_le(payload, seq);
+    append_frame(out, FrameType::Ack, 0, payload);
+}
+
+bool decode_ack(const Frame& frame, uint64_t& seq) {
+    if (frame.type != FrameType::Ack || frame.payload.size() != 8) return false;
+    seq = get_le<uint64_t>(frame.payload.data());
+    return true;
+}
+
+bool parse_compression(const std::string& name, Compression& compression) {
+    if (name == "zlib") {
+        compression = Compression::Zlib;
+    } else if (name == "none") {
+        compression = Compression::None;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+} // namespace collect
+} // namespace environet
@@ -0,0 +1,74 @@
+#include "core/arena.hpp"
+
+namespace environet {
+namespace core {
+
+namespace {
+
+size_t round_up_pow2(size_t n) {
+    size_t p = 1024;
+    while (p < n) p <<= 1;
+    return p;
+}
+
+} // namespace
+
+TickArena::TickArena(size_t initial_bytes)
+    : capacity_(round_up_pow2(initial_bytes)), block_(new std::byte[capacity_]) {
+    monotonic_.emplace(block_.get(), capacity_, &spill_);
+}
+
+void TickArena::reset() {
+    monotonic_->release();
+    ++resets_;
+    if (spill_.bytes > 0) {
+        // Size the block for the tick that just overflowed, with headroom for alignment
+        ++spills_;
+        capacity_ = round_up_pow2(used_ + used_ / 4);
+        monotonic_.reset();
+        block_.reset(new std::byte[capacity_]);
+        monotonic_.emplace(block_.get(), capacity_, &spill_);
+        spill_.bytes = 0;
+    }
+    used_ = 0;
+}
+
+nlohmann::json TickArena::get_stats() const {
+    nlohmann::json j;
+    j["capacity_bytes"] = capacity_;
+    j["used_bytes"] = used_;
+    j["high_water_bytes"] = high_water_;
+    j["resets"] = resets_;
+    j["spills"] = spills_;
+    return j;
+}
+
+void* TickArena::do_allocate(size_t bytes, size_t alignment) {
+    used_ += bytes + (alignment > alignof(std::max_align_t) ? alignment : 0);
+    if (used_ > high_water_) high_water_ = used_;
+    return monotonic_->allocate(bytes, alignment);
+}
+
+void TickArena::do_deallocate(void*, size_t, size_t) {
+    // Monotonic: memory comes back at reset()
+}
+
+bool TickArena::do_is_equal(const std::pmr::memory_resource& other) const noexcept {
+    return this == &other;
+}
+
+void* TickArena::Spill::do_allocate(size_t n, size_t alignment) {
+    bytes += n;
+    return std::pmr::new_delete_resource()->allocate(n, alignment);
+}
+
+void TickArena::Spill::do_deallocate(void* p, size_t n, size_t alignment) {
+    std::pmr::new_delete_resource()->deallocate(p, n, alignment);
+}
+
+bool TickArena::Spill::do_is_equal(const std::pmr::memory_resource& other) const noexcept {
+    return this == &other;
+}
+
+} // namespace core
+} // namespace environet
@@ -13,6 +13,18 @@ static bool file_exists(const std::string& path) {
     return f.good();
 }
 
+static const char* const THREAD_ROLES[] = {"capture", "writer", "sensor", "correlation", "metrics"};
+
+// Threads is Config::ThreadsConfig, const or not
+template <typename Threads>
+static auto& thread_role(Threads& threads, const std::string& role) {
+    if (role == "capture") return threads.capture;
+    if (role == "writer") return threads.writer;
+    if (role == "sensor") return threads.sensor;
+    if (role == "correlation") return threads.correlation;
+    return threads.metrics;
+}
+
 Config Config::load(const std::string& path) {
     if (!file_exists(path)) {
         throw std::runtime_error("Config file not found: " + path);
@@ -49,6 +61,14 @@ Config Config::get_defaults() {
     return cfg;
 }
 
+std::shared_ptr<const Config> Config::load_snapshot(const std::string& path) {
+    try {
+        return std::make_shared<const Config>(Config::load(path));
+    } catch (const std::exception&) {
+        return std::make_shared<const Config>(Config::get_defaults());
+    }
+}
+
 void Config::validate() const {
     if (i2c.bus_id < 0) {
         throw std::runtime_error("i2c.bus_id must be >= 0");
@@ -68,6 +88,69 @@ void Config::validate() const {
     if (pcap.max_files <= 0) {
         throw std::runtime_error("pcap.max_files must be > 0");
     }
+    if (classifier.rules.size() > 64) {
+        throw std::runtime_error("classifier.rules supports at most 64 rules");
+    }
+    for (const auto& rule : classifier.rules) {
+        if (rule.name.empty() || rule.name == "unclassified") {
+            throw std::runtime_error("classifier.rules entries need a name other than \"unclassified\"");
+        }
+        for (int protocol : rule.protocols) {
+            if (protocol < 0 || protocol > 255) {
+                throw std::runtime_error("classifier rule " + rule.name + ": protocols must be 0..255");
+            }
+        }
+    }
+    if (accounting.bucket_ms <= 0) {
+        throw std::runtime_error("accounting.bucket_ms must be > 0");
+    }
+    if (accounting.buckets <= 0 || accounting.buckets > 3600) {
+        throw std::runtime_error("accounting.buckets must be 1..3600");
+    }
+    if (accounting.top_k == 0 || accounting.top_k > 1024) {
+        throw std::runtime_error("accounting.top_k must be 1..1024");
+    }
+    if (accounting.sketch_width < 16 || accounting.sketch_width > 65536 ||
+        (accounting.sketch_width & (accounting.sketch_width - 1)) != 0) {
+        throw std::runtime_error("accounting.sketch_width must be a power of two in 16..65536");
+    }
+    if (accounting.sketch_depth == 0 || accounting.sketch_depth > 16) {
+        throw std::runtime_error("accounting.sketch_depth must be 1..16");
+    }
+    if (accounting.device_precision < 4 || accounting.device_precision > 16) {
+        throw std::runtime_error("accounting.device_precision must be 4..16");
+    }
+    if (dns.bucket_ms <= 0) {
+        throw std::runtime_error("dns.bucket_ms must be > 0");
+    }
+    if (dns.max_pending < 64 || dns.max_pending > (1u << 20) || (dns.max_pending & (dns.max_pending - 1)) != 0) {
+        throw std::runtime_error("dns.max_pending must be a power of two in 64..1048576");
+    }
+    if (dns.timeout_ms <= 0) {
+        throw std::runtime_error("dns.timeout_ms must be > 0");
+    }
+    if (flow_export.protocol != "ipfix" && flow_export.protocol != "netflow9") {
+        throw std::runtime_error("flow_export.protocol must be ipfix or netflow9");
+    }
+    if (flow_export.enabled && flow_export.collector_host.empty()) {
+        throw std::runtime_error("flow_export.collector_host must be set when flow_export.enabled");
+    }
+    if (flow_export.collector_port < 1 || flow_export.collector_port > 65535) {
+        throw std::runtime_error("flow_export.collector_port must be 1..65535");
+    }
+    if (flow_export.active_timeout_ms < 1000 || flow_export.inactive_timeout_ms < 1000) {
+        throw std::runtime_error("flow_export timeouts must be >= 1000 ms");
+    }
+    if (flow_export.template_refresh_ms < 1000) {
+        throw std::runtime_error("flow_export.template_refresh_ms must be >= 1000");
+    }
+    if (flow_export.max_flows < 64 || flow_export.max_flows > (1u << 22) ||
+        (flow_export.max_flows & (flow_export.max_flows - 1)) != 0) {
+        throw std::runtime_error("flow_export.max_flows must be a power of two in 64..4194304");
+    }
+    if (flow_export.mtu < 512 || flow_export.mtu > 65000) {
+        throw std::runtime_error("flow_export.mtu must be 512..65000");
+    }
     if (correlator.window_ms <= 0) {
         throw std::runtime_error("correlator.window_ms must be > 0");
     }
@@ -77,12 +160,140 @@ void Config::validate() const {
     if (logging.max_files <= 0) {
         throw std::runtime_error("logging.max_files must be > 0");
     }
+    if (logging.async_queue_size == 0) {
+        throw std::runtime_error("logging.async_queue_size must be > 0");
+    }
+    if (logging.overflow_policy != "block" && logging.overflow_policy != "overrun_oldest") {
+        throw std::runtime_error("logging.overflow_policy must be \"block\" or \"overrun_oldest\"");
+    }
     if (metrics.ping_interval_ms <= 0) {
         throw std::runtime_error("metrics.ping_interval_ms must be > 0");
     }
     if (metrics.iperf3_duration <= 0) {
         throw std::runtime_error("metrics.iperf3_duration must be > 0");
     }
+    if (telemetry.port < 0 || telemetry.port > 65535) {
+        throw std::runtime_error("telemetry.port must be 0..65535");
+    }
+    if (api.port < -1 || api.port > 65535) {
+        throw std::runtime_error("api.port must be -1..65535");
+    }
+    if (api.port < 0 && api.unix_socket.empty()) {
+        throw std::runtime_error("api needs a port or a unix_socket");
+    }
+    if (api.unix_socket.size() >= 108) {
+        throw std::runtime_error("api.unix_socket path must be shorter than 108 characters");
+    }
+    if (api.max_points < 1 || api.max_points > 100000) {
+        throw std::runtime_error("api.max_points must be 1..100000");
+    }
+    if (push.max_clients < 1 || push.max_clients > 128) {
+        throw std::runtime_error("push.max_clients must be 1..128");
+    }
+    if (push.queue_size < 1) {
+        throw std::runtime_error("push.queue_size must be positive");
+    }
+    if (push.max_series < 1) {
+        throw std::runtime_error("push.max_series must be positive");
+    }
+    if (forward.enabled && forward.collector_host.empty()) {
+        throw std::runtime_error("forward.collector_host must be set when forward.enabled");
+    }
+    if (forward.collector_port < 1 || forward.collector_port > 65535) {
+        throw std::runtime_error("forward.collector_port must be 1..65535");
+    }
+    if (forward.spool_dir.empty()) {
+        throw std::runtime_error("forward.spool_dir must not be empty");
+    }
+    if (forward.compression != "zlib" && forward.compression != "none") {
+        throw std::runtime_error("forward.compression must be zlib or none");
+    }
+    if (forward.batch_interval_ms < 10) {
+        throw std::runtime_error("forward.batch_interval_ms must be >= 10");
+    }
+    if (forward.batch_max_records < 1) {
+        throw std::runtime_error("forward.batch_max_records must be positive");
+    }
+    if (forward.rollup_interval_ms < 0) {
+        throw std::runtime_error("forward.rollup_interval_ms must be >= 0");
+    }
+    if (forward.sync_interval_ms < 1) {
+        throw std::runtime_error("forward.sync_interval_ms must be positive");
+    }
+    if (forward.spool_segment_mb == 0) {
+        throw std::runtime_error("forward.spool_segment_mb must be positive");
+    }
+    if (forward.spool_max_mb < forward.spool_segment_mb) {
+        throw std::runtime_error("forward.spool_max_mb must be >= forward.spool_segment_mb");
+    }
+    if (forward.reconnect_ms < 10) {
+        throw std::runtime_error("forward.reconnect_ms must be >= 10");
+    }
+    if (collector.port < 0 || collector.port > 65535) {
+        throw std::runtime_error("collector.port must be 0..65535");
+    }
+    if (collector.max_edges < 1) {
+        throw std::runtime_error("collector.max_edges must be positive");
+    }
+    if (collector.credits < 1 || collector.credits > 1024) {
+        throw std::runtime_error("collector.credits must be 1..1024");
+    }
+    if (collector.max_batch_kb == 0) {
+        throw std::runtime_error("collector.max_batch_kb must be positive");
+    }
+    if (collector.findings_per_edge < 1 || collector.rollups_per_edge < 1) {
+        throw std::runtime_error("collector.findings_per_edge and rollups_per_edge must be positive");
+    }
+    if (trace.enabled && trace.file.empty()) {
+        throw std::runtime_error("trace.file must be set when trace.enabled");
+    }
+    if (trace.max_file_size_mb == 0) {
+        throw std::runtime_error("trace.max_file_size_mb must be > 0");
+    }
+    if (trace.max_files <= 0) {
+        throw std::runtime_error("trace.max_files must be > 0");
+    }
+    if (trace.buffer_records == 0) {
+        throw std::runtime_error("trace.buffer_records must be > 0");
+    }
+    if (trace.flush_interval_ms <= 0) {
+        throw std::runtime_error("trace.flush_interval_ms must be > 0");
+    }
+    if (timeline.buffer_events == 0) {
+        throw std::runtime_error("timeline.buffer_events must be > 0");
+    }
+    if (timeline.dump_seconds <= 0) {
+        throw std::runtime_error("timeline.dump_seconds must be > 0");
+    }
+    if (tasks.workers > 256) {
+        throw std::runtime_error("tasks.workers must be <= 256");
+    }
+    for (const char* role : THREAD_ROLES) {
+        const auto& t = thread_role(threads, role);
+        const std::string key = std::string("threads.") + role;
+        for (int cpu : t.cpus) {
+            if (cpu < 0 || cpu >= 1024) {
+                throw std::runtime_error(key + ".cpus entries must be 0..1023");
+            }
+        }
+        if (t.policy == "other") {
+            if (t.priority != 0) {
+                throw std::runtime_error(key + ".priority requires policy fifo or rr");
+            }
+        } else if (t.policy == "fifo" || t.policy == "rr") {
+            if (t.priority < 1 || t.priority > 99) {
+                throw std::runtime_error(key + ".priority must be 1..99 for policy " + t.policy);
+            }
+        } else {
+            throw std::runtime_error(key + ".policy must be other, fifo or rr");
+        }
+        if (t.nice < -20 || t.nice > 19) {
+            throw std::runtime_error(key + ".nice must be -20..19");
+        }
+    }
+    if (threads.numa_node < -1 || threads.numa_node >= 1024) {
+        throw std::runtime_error("threads.numa_node must be -1..1023");
+    }
 }
 
 nlohmann::json Config::to_json() const {
@@ -105,6 +316,44 @@ nlohmann::json Config::to_json() const {
         {"max_file_size_mb", pcap.max_file_size_mb},
         {"max_files", pcap.max_files}
     };
+    j["classifier"] = {{"rules", json::array()}};
+    for (const auto& rule : classifier.rules) {
+        j["classifier"]["rules"].push_back({
+            {"name", rule.name},
+            {"macs", rule.macs},
+            {"ips", rule.ips},
+            {"ports", rule.ports},
+            {"protocols", rule.protocols}
+        });
+    }
+    j["accounting"] = {
+        {"enabled", accounting.enabled},
+        {"bucket_ms", accounting.bucket_ms},
+        {"buckets", accounting.buckets},
+        {"top_k", accounting.top_k},
+        {"sketch_width", accounting.sketch_width},
+        {"sketch_depth", accounting.sketch_depth},
+        {"device_precision", accounting.device_precision}
+    };
+    j["dns"] = {
+        {"enabled", dns.enabled},
+        {"bucket_ms", dns.bucket_ms},
+        {"max_pending", dns.max_pending},
+        {"timeout_ms", dns.timeout_ms}
+    };
+    j["flow_export"] = {
+        {"enabled", flow_export.enabled},
+        {"protocol", flow_export.protocol},
+        {"collector_host", flow_export.collector_host},
+        {"collector_port", flow_export.collector_port},
+        {"observation_domain", flow_export.observation_domain},
+        {"enterprise_id", flow_export.enterprise_id},
+        {"active_timeout_ms", flow_export.active_timeout_ms},
+        {"inactive_timeout_ms", flow_export.inactive_timeout_ms},
+        {"template_refresh_ms", flow_export.template_refresh_ms},
+        {"max_flows", flow_export.max_flows},
+        {"mtu", flow_export.mtu}
+    };
     j["correlator"] = {
         {"sensor_threshold", correlator.sensor_threshold},
         {"window_ms", correlator.window_ms},
@@ -115,7 +364,10 @@ nlohmann::json Config::to_json() const {
         {"file", logging.file},
         {"console", logging.console},
         {"max_size_mb", logging.max_size_mb},
-        {"max_files", logging.max_files}
+        {"max_files", logging.max_files},
+        {"async", logging.async},
+        {"async_queue_size", logging.async_queue_size},
+        {"overflow_policy", logging.overflow_policy}
     };
     j["metrics"] = {
         {"ping_targets", metrics.ping_targets},
@@ -125,6 +377,76 @@ nlohmann::json Config::to_json() const {
         {"iperf3_duration", metrics.iperf3_duration},
         {"iperf_duration", metrics.iperf3_duration}
     };
+    j["telemetry"] = {
+        {"enabled", telemetry.enabled},
+        {"bind_address", telemetry.bind_address},
+        {"port", telemetry.port}
+    };
+    j["api"] = {
+        {"enabled", api.enabled},
+        {"bind_address", api.bind_address},
+        {"port", api.port},
+        {"unix_socket", api.unix_socket},
+        {"max_points", api.max_points}
+    };
+    j["push"] = {
+        {"enabled", push.enabled},
+        {"max_clients", push.max_clients},
+        {"queue_size", push.queue_size},
+        {"max_series", push.max_series}
+    };
+    j["forward"] = {
+        {"enabled", forward.enabled},
+        {"collector_host", forward.collector_host},
+        {"collector_port", forward.collector_port},
+        {"edge_id", forward.edge_id},
+        {"spool_dir", forward.spool_dir},
+        {"compression", forward.compression},
+        {"batch_interval_ms", forward.batch_interval_ms},
+        {"batch_max_records", forward.batch_max_records},
+        {"rollup_interval_ms", forward.rollup_interval_ms},
+        {"sync_interval_ms", forward.sync_interval_ms},
+        {"spool_segment_mb", forward.spool_segment_mb},
+        {"spool_max_mb", forward.spool_max_mb},
+        {"reconnect_ms", forward.reconnect_ms}
+    };
+    j["collector"] = {
+        {"bind_address", collector.bind_address},
+        {"port", collector.port},
+        {"max_edges", collector.max_edges},
+        {"credits", collector.credits},
+        {"max_batch_kb", collector.max_batch_kb},
+        {"findings_per_edge", collector.findings_per_edge},
+        {"rollups_per_edge", collector.rollups_per_edge}
+    };
+    j["trace"] = {
+        {"enabled", trace.enabled},
+        {"file", trace.file},
+        {"max_file_size_mb", trace.max_file_size_mb},
+        {"max_files", trace.max_files},
+        {"buffer_records", trace.buffer_records},
+        {"flush_interval_ms", trace.flush_interval_ms}
+    };
+    j["timeline"] = {
+        {"enabled", timeline.enabled},
+        {"buffer_events", timeline.buffer_events},
+        {"dump_seconds", timeline.dump_seconds},
+        {"output_dir", timeline.output_dir}
+    };
+    j["tasks"] = {
+        {"workers", tasks.workers},
+        {"pin_workers", tasks.pin_workers}
+    };
+    j["threads"] = {{"numa_node", threads.numa_node}};
+    for (const char* role : THREAD_ROLES) {
+        const auto& t = thread_role(threads, role);
+        j["threads"][role] = {
+            {"cpus", t.cpus},
+            {"policy", t.policy},
+            {"priority", t.priority},
+            {"nice", t.nice}
+        };
+    }
     return j;
 }
 
@@ -150,6 +472,57 @@ void Config::from_json_object(const json& j) {
         if (jp.contains("max_file_size_mb")) pcap.max_file_size_mb = jp["max_file_size_mb"].get<size_t>();
         if (jp.contains("max_files")) pcap.max_files = jp["max_files"].get<int>();
     }
+    if (j.contains("classifier") && j["classifier"].is_object()) {
+        auto& jc = j["classifier"];
+        if (jc.contains("rules")) {
+            classifier.rules.clear();
+            for (const auto& jr : jc["rules"]) {
+                ClassRule rule;
+                if (jr.contains("name")) rule.name = jr["name"].get<std::string>();
+                if (jr.contains("macs")) rule.macs = jr["macs"].get<std::vector<std::string>>();
+                if (jr.contains("ips")) rule.ips = jr["ips"].get<std::vector<std::string>>();
+                if (jr.contains("protocols")) rule.protocols = jr["protocols"].get<std::vector<int>>();
+                // Ports may be written as numbers or as "lo-hi" strings
+                if (jr.contains("ports")) {
+                    for (const auto& p : jr["ports"]) {
+                        rule.ports.push_back(p.is_number() ? std::to_string(p.get<int>()) : p.get<std::string>());
+                    }
+                }
+                classifier.rules.push_back(rule);
+            }
+        }
+    }
+    if (j.contains("accounting") && j["accounting"].is_object()) {
+        auto& ja = j["accounting"];
+        if (ja.contains("enabled")) accounting.enabled = ja["enabled"].get<bool>();
+        if (ja.contains("bucket_ms")) accounting.bucket_ms = ja["bucket_ms"].get<int>();
+        if (ja.contains("buckets")) accounting.buckets = ja["buckets"].get<int>();
+        if (ja.contains("top_k")) accounting.top_k = ja["top_k"].get<size_t>();
+        if (ja.contains("sketch_width")) accounting.sketch_width = ja["sketch_width"].get<size_t>();
+        if (ja.contains("sketch_depth")) accounting.sketch_depth = ja["sketch_depth"].get<size_t>();
+        if (ja.contains("device_precision")) accounting.device_precision = ja["device_precision"].get<int>();
+    }
+    if (j.contains("dns") && j["dns"].is_object()) {
+        auto& jd = j["dns"];
+        if (jd.contains("enabled")) dns.enabled = jd["enabled"].get<bool>();
+        if (jd.contains("bucket_ms")) dns.bucket_ms = jd["bucket_ms"].get<int>();
+        if (jd.contains("max_pending")) dns.max_pending = jd["max_pending"].get<size_t>();
+        if (jd.contains("timeout_ms")) dns.timeout_ms = jd["timeout_ms"].get<int>();
+    }
+    if (j.contains("flow_export") && j["flow_export"].is_object()) {
+        auto& jx = j["flow_export"];
+        if (jx.contains("enabled")) flow_export.enabled = jx["enabled"].get<bool>();
+        if (jx.contains("protocol")) flow_export.protocol = jx["protocol"].get<std::string>();
+        if (jx.contains("collector_host")) flow_export.collector_host = jx["collector_host"].get<std::string>();
+        if (jx.contains("collector_port")) flow_export.collector_port = jx["collector_port"].get<int>();
+        if (jx.contains("observation_domain")) flow_export.observation_domain = jx["observation_domain"].get<uint32_t>();
+        if (jx.contains("enterprise_id")) flow_export.enterprise_id = jx["enterprise_id"].get<uint32_t>();
+        if (jx.contains("active_timeout_ms")) flow_export.active_timeout_ms = jx["active_timeout_ms"].get<int>();
+        if (jx.contains("inactive_timeout_ms")) flow_export.inactive_timeout_ms = jx["inactive_timeout_ms"].get<int>();
+        if (jx.contains("template_refresh_ms")) flow_export.template_refresh_ms = jx["template_refresh_ms"].get<int>();
+        if (jx.contains("max_flows")) flow_export.max_flows = jx["max_flows"].get<size_t>();
+        if (jx.contains("mtu")) flow_export.mtu = jx["mtu"].get<size_t>();
+    }
     if (j.contains("correlator") && j["correlator"].is_object()) {
         auto& jc = j["correlator"];
         if (jc.contains("sensor_threshold")) correlator.sensor_threshold = jc["sensor_threshold"].get<int>();
@@ -163,6 +536,9 @@ void Config::from_json_object(const json& j) {
         if (jl.contains("console")) logging.console = jl["console"].get<bool>();
         if (jl.contains("max_size_mb")) logging.max_size_mb = jl["max_size_mb"].get<size_t>();
         if (jl.contains("max_files")) logging.max_files = jl["max_files"].get<int>();
+        if (jl.contains("async")) logging.async = jl["async"].get<bool>();
+        if (jl.contains("async_queue_size")) logging.async_queue_size = jl["async_queue_size"].get<size_t>();
+        if (jl.contains("overflow_policy")) logging.overflow_policy = jl["overflow_policy"].get<std::string>();
     }
     if (j.contains("metrics") && j["metrics"].is_object()) {
         auto& jm = j["metrics"];
@@ -172,6 +548,89 @@ void Config::from_json_object(const json& j) {
         if (jm.contains("iperf3_duration")) metrics.iperf3_duration = jm["iperf3_duration"].get<int>();
         else if (jm.contains("iperf_duration")) metrics.iperf3_duration = jm["iperf_duration"].get<int>();
     }
+    if (j.contains("telemetry") && j["telemetry"].is_object()) {
+        auto& jt = j["telemetry"];
+        if (jt.contains("enabled")) telemetry.enabled = jt["enabled"].get<bool>();
+        if (jt.contains("bind_address")) telemetry.bind_address = jt["bind_address"].get<std::string>();
+        if (jt.contains("port")) telemetry.port = jt["port"].get<int>();
+    }
+
+    if (j.contains("api") && j["api"].is_object()) {
+        auto& ja = j["api"];
+        if (ja.contains("enabled")) api.enabled = ja["enabled"].get<bool>();
+        if (ja.contains("bind_address")) api.bind_address = ja["bind_address"].get<std::string>();
+        if (ja.contains("port")) api.port = ja["port"].get<int>();
+        if (ja.contains("unix_socket")) api.unix_socket = ja["unix_socket"].get<std::string>();
+        if (ja.contains("max_points")) api.max_points = ja["max_points"].get<int>();
+    }
+
+    if (j.contains("push") && j["push"].is_object()) {
+        auto& jp = j["push"];
+        if (jp.contains("enabled")) push.enabled = jp["enabled"].get<bool>();
+        if (jp.contains("max_clients")) push.max_clients = jp["max_clients"].get<int>();
+        if (jp.contains("queue_size")) push.queue_size = jp["queue_size"].get<int>();
+        if (jp.contains("max_series")) push.max_series = jp["max_series"].get<int>();
+    }
+    if (j.contains("forward") && j["forward"].is_object()) {
+        auto& jf = j["forward"];
+        if (jf.contains("enabled")) forward.enabled = jf["enabled"].get<bool>();
+        if (jf.contains("collector_host")) forward.collector_host = jf["collector_host"].get<std::string>();
+        if (jf.contains("collector_port")) forward.collector_port = jf["collector_port"].get<int>();
+        if (jf.contains("edge_id")) forward.edge_id = jf["edge_id"].get<std::string>();
+        if (jf.contains("spool_dir")) forward.spool_dir = jf["spool_dir"].get<std::string>();
+        if (jf.contains("compression")) forward.compression = jf["compression"].get<std::string>();
+        if (jf.contains("batch_interval_ms")) forward.batch_interval_ms = jf["batch_interval_ms"].get<int>();
+        if (jf.contains("batch_max_records")) forward.batch_max_records = jf["batch_max_records"].get<int>();
+        if (jf.contains("rollup_interval_ms")) forward.rollup_interval_ms = jf["rollup_interval_ms"].get<int>();
+        if (jf.contains("sync_interval_ms")) forward.sync_interval_ms = jf["sync_interval_ms"].get<int>();
+        if (jf.contains("spool_segment_mb")) forward.spool_segment_mb = jf["spool_segment_mb"].get<size_t>();
+        if (jf.contains("spool_max_mb")) forward.spool_max_mb = jf["spool_max_mb"].get<size_t>();
+        if (jf.contains("reconnect_ms")) forward.reconnect_ms = jf["reconnect_ms"].get<int>();
+    }
+    if (j.contains("collector") && j["collector"].is_object()) {
+        auto& jc = j["collector"];
+        if (jc.contains("bind_address")) collector.bind_address = jc["bind_address"].get<std::string>();
+        if (jc.contains("port")) collector.port = jc["port"].get<int>();
+        if (jc.contains("max_edges")) collector.max_edges = jc["max_edges"].get<int>();
+        if (jc.contains("credits")) collector.credits = jc["credits"].get<int>();
+        if (jc.contains("max_batch_kb")) collector.max_batch_kb = jc["max_batch_kb"].get<size_t>();
+        if (jc.contains("findings_per_edge")) collector.findings_per_edge = jc["findings_per_edge"].get<int>();
+        if (jc.contains("rollups_per_edge")) collector.rollups_per_edge = jc["rollups_per_edge"].get<int>();
+    }
+    if (j.contains("trace") && j["trace"].is_object()) {
+        auto& jr = j["trace"];
+        if (jr.contains("enabled")) trace.enabled = jr["enabled"].get<bool>();
+        if (jr.contains("file")) trace.file = jr["file"].get<std::string>();
+        if (jr.contains("max_file_size_mb")) trace.max_file_size_mb = jr["max_file_size_mb"].get<size_t>();
+        if (jr.contains("max_files")) trace.max_files = jr["max_files"].get<int>();
+        if (jr.contains("buffer_records")) trace.buffer_records = jr["buffer_records"].get<size_t>();
+        if (jr.contains("flush_interval_ms")) trace.flush_interval_ms = jr["flush_interval_ms"].get<int>();
+    }
+    if (j.contains("timeline") && j["timeline"].is_object()) {
+        auto& jl = j["timeline"];
+        if (jl.contains("enabled")) timeline.enabled = jl["enabled"].get<bool>();
+        if (jl.contains("buffer_events")) timeline.buffer_events = jl["buffer_events"].get<size_t>();
+        if (jl.contains("dump_seconds")) timeline.dump_seconds = jl["dump_seconds"].get<int>();
+        if (jl.contains("output_dir")) timeline.output_dir = jl["output_dir"].get<std::string>();
+    }
+    if (j.contains("tasks") && j["tasks"].is_object()) {
+        auto& jt = j["tasks"];
+        if (jt.contains("workers")) tasks.workers = jt["workers"].get<size_t>();
+        if (jt.contains("pin_workers")) tasks.pin_workers = jt["pin_workers"].get<bool>();
+    }
+    if (j.contains("threads") && j["threads"].is_object()) {
+        auto& jt = j["threads"];
+        if (jt.contains("numa_node")) threads.numa_node = jt["numa_node"].get<int>();
+        for (const char* role : THREAD_ROLES) {
+            if (!jt.contains(role) || !jt[role].is_object()) continue;
+            auto& jr = jt[role];
+            auto& t = thread_role(threads, role);
+            if (jr.contains("cpus")) t.cpus = jr["cpus"].get<std::vector<int>>();
+            if (jr.contains("policy")) t.policy = jr["policy"].get<std::string>();
+            if (jr.contains("priority")) t.priority = jr["priority"].get<int>();
+            if (jr.contains("nice")) t.nice = jr["nice"].get<int>();
+        }
+    }
 }
 
 void Config::set_defaults() {
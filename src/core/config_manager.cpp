@@ -0,0 +1,173 @@
+#include "core/config_manager.hpp"
+#include "core/log.hpp"
+
+#include <cerrno>
+#include <cstring>
+#include <poll.h>
+#include <sys/eventfd.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+
+namespace environet {
+namespace core {
+
+ConfigManager::ConfigManager(const std::string& path, Config initial, Adjuster adjust)
+    : path_(path), adjust_(std::move(adjust)), current_(std::make_shared<const Config>(std::move(initial))) {}
+
+ConfigManager::~ConfigManager() { stop_watch(); }
+
+std::shared_ptr<const Config> ConfigManager::current() const {
+    std::lock_guard<std::mutex> lock(config_mutex_);
+    return current_;
+}
+
+void ConfigManager::subscribe(Listener listener) {
+    std::lock_guard<std::mutex> lock(reload_mutex_);
+    listeners_.push_back(std::move(listener));
+}
+
+bool ConfigManager::reload() {
+    std::lock_guard<std::mutex> lock(reload_mutex_);
+    Config loaded;
+    try {
+        loaded = Config::load(path_);
+        if (adjust_) {
+            adjust_(loaded);
+            loaded.validate();
+        }
+    } catch (const std::exception& e) {
+        ++failed_reloads_;
+        set_error(std::string("reload failed, keeping running configuration: ") + e.what());
+        return false;
+    }
+
+    auto old_config = current();
+    auto changed = diff(*old_config, loaded);
+    ++reloads_;
+    last_changed_ = changed;
+    if (changed.empty()) return true;
+
+    auto new_config = std::make_shared<const Config>(std::move(loaded));
+    {
+        std::lock_guard<std::mutex> config_lock(config_mutex_);
+        current_ = new_config;
+    }
+    for (const auto& listener : listeners_) {
+        listener(*old_config, *new_config, changed);
+    }
+    return true;
+}
+
+std::vector<std::string> ConfigManager::diff(const Config& a, const Config& b) {
+    std::vector<std::string> changed;
+    auto ja = a.to_json();
+    auto jb = b.to_json();
+    for (auto section = jb.begin(); section != jb.end(); ++section) {
+        const auto& old_section = ja[section.key()];
+        for (auto it = section->begin(); it != section->end(); ++it) {
+            if (!old_section.contains(it.key()) || old_section[it.key()] != *it) {
+                changed.push_back(section.key() + "." + it.key());
+            }
+        }
+    }
+    return changed;
+}
+
+bool ConfigManager::start_watch() {
+    if (watching_.load()) return true;
+    inotify_fd_ = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if (inotify_fd_ < 0) {
+        set_error(std::string("inotify_init1 failed: ") + std::strerror(errno));
+        return false;
+    }
+    size_t slash = path_.find_last_of('/');
+    std::string dir = slash == std::string::npos ? "." : (slash == 0 ? "/" : path_.substr(0, slash));
+    if (inotify_add_watch(inotify_fd_, dir.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO | IN_CREATE) < 0) {
+        set_error("inotify_add_watch failed for " + dir + ": " + std::strerror(errno));
+        ::close(inotify_fd_);
+        inotify_fd_ = -1;
+        return false;
+    }
+    wake_fd_ = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (wake_fd_ < 0) {
+        // Without it stop_watch() could not wake the watcher
+        set_error(std::string("eventfd failed: ") + std::strerror(errno));
+        LOGE("Config watch: {}", get_last_error());
+        ::close(inotify_fd_);
+        inotify_fd_ = -1;
+        return false;
+    }
+    watching_.store(true);
+    watch_thread_ = std::thread([this]() { watch_loop(); });
+    return true;
+}
+
+void ConfigManager::stop_watch() {
+    if (!watching_.exchange(false)) return;
+    // Wake the watcher; it also re-checks watching_ on its poll timeout
+    uint64_t one = 1;
+    ssize_t ignored = ::write(wake_fd_, &one, sizeof(one));
+    (void)ignored;
+    if (watch_thread_.joinable()) watch_thread_.join();
+    ::close(inotify_fd_);
+    ::close(wake_fd_);
+    inotify_fd_ = -1;
+    wake_fd_ = -1;
+}
+
+void ConfigManager::watch_loop() {
+    size_t slash = path_.find_last_of('/');
+    std::string name = slash == std::string::npos ? path_ : path_.substr(slash + 1);
+    alignas(inotify_event) char buf[4096];
+    bool pending = false;
+
+    while (watching_.load()) {
+        pollfd fds[2] = {{inotify_fd_, POLLIN, 0}, {wake_fd_, POLLIN, 0}};
+        // While a change is pending, wait for the burst to settle before reloading
+        int rc = ::poll(fds, 2, pending ? 200 : 1000);
+        if (rc < 0 && errno != EINTR) break;
+        if (rc == 0 && pending) {
+            pending = false;
+            if (reload()) {
+                LOGI("Configuration file changed, reloaded {}", path_);
+            } else {
+                LOGW("{}", get_last_error());
+            }
+            continue;
+        }
+        if (rc <= 0 || !(fds[0].revents & POLLIN)) continue;
+
+        ssize_t len;
+        while ((len = ::read(inotify_fd_, buf, sizeof(buf))) > 0) {
+            for (char* p = buf; p < buf + len;) {
+                auto* ev = reinterpret_cast<inotify_event*>(p);
+                if (ev->len && name == ev->name) pending = true;
+                p += sizeof(inotify_event) + ev->len;
+            }
+        }
+    }
+}
+
+nlohmann::json ConfigManager::get_stats() const {
+    nlohmann::json j;
+    j["path"] = path_;
+    j["watching"] = watching_.load();
+    std::lock_guard<std::mutex> lock(reload_mutex_);
+    j["reloads"] = reloads_;
+    j["failed_reloads"] = failed_reloads_;
+    j["last_changed"] = last_changed_;
+    return j;
+}
+
+std::string ConfigManager::get_last_error() const {
+    std::lock_guard<std::mutex> lock(error_mutex_);
+    return last_error_;
+}
+
+void ConfigManager::set_error(const std::string& error) {
+    std::lock_guard<std::mutex> lock(error_mutex_);
+    last_error_ = error;
+}
+
+} // namespace core
+} // namespace environet
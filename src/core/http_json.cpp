@@ -0,0 +1,32 @@
+#include "core/http_json.hpp"
+#include "core/json_writer.hpp"
+
+#include <charconv>
+
+namespace environet {
+namespace core {
+
+HttpResponse json_response(int status, std::string body) {
+    HttpResponse resp;
+    resp.status = status;
+    resp.content_type = "application/json";
+    resp.body = std::move(body);
+    resp.body += '\n';
+    return resp;
+}
+
+HttpResponse error_response(int status, std::string_view message) {
+    std::string body;
+    JsonWriter(body).begin_object().field("error", message).end_object();
+    return json_response(status, std::move(body));
+}
+
+bool param_u64(const HttpRequest& req, const char* key, uint64_t& value) {
+    std::string s = req.query_param(key);
+    if (s.empty()) return true;
+    auto res = std::from_chars(s.data(), s.data() + s.size(), value);
+    return res.ec == std::errc() && res.ptr == s.data() + s.size();
+}
+
+} // namespace core
+} // namespace environet
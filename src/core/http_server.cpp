@@ -0,0 +1,544 @@
+#include "core/http_server.hpp"
+#include "core/log.hpp"
+#include "core/metrics_registry.hpp"
+
+#include <algorithm>
+#include <cctype>
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <arpa/inet.h>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+namespace environet {
+namespace core {
+
+static constexpr size_t kMaxRequestBytes = 64 * 1024;
+static constexpr size_t kMaxConnections = 256;
+static constexpr uint64_t kIdleTimeoutMs = 30000;
+static constexpr size_t kMaxRetainedOutBytes = 1024 * 1024;   // Output buffer kept between responses
+
+static uint64_t now_ms() {
+    using namespace std::chrono;
+    return duration_cast<milliseconds>(steady_clock::now().time_since_epoch()).count();
+}
+
+static bool set_nonblocking(int fd) {
+    int flags = fcntl(fd, F_GETFL, 0);
+    return flags >= 0 && fcntl(fd, F_SETFL, flags | O_NONBLOCK) == 0;
+}
+
+static std::string to_lower(std::string s) {
+    std::transform(s.begin(), s.end(), s.begin(), [](unsigned char c) { return std::tolower(c); });
+    return s;
+}
+
+std::string HttpRequest::query_param(const std::string& key, const std::string& fallback) const {
+    size_t pos = 0;
+    while (pos <= query.size()) {
+        size_t amp = query.find('&', pos);
+        std::string pair = query.substr(pos, amp == std::string::npos ? std::string::npos : amp - pos);
+        size_t eq = pair.find('=');
+        if (pair.substr(0, eq) == key) {
+            return eq == std::string::npos ? std::string() : pair.substr(eq + 1);
+        }
+        if (amp == std::string::npos) break;
+        pos = amp + 1;
+    }
+    return fallback;
+}
+
+HttpServer::HttpServer()
+    : listen_fd_(-1), unix_fd_(-1), epoll_fd_(-1), wake_fd_(-1), port_(0), running_(false),
+      requests_served_(0), connections_accepted_(0), streams_opened_(0) {}
+
+HttpServer::~HttpServer() { stop(); }
+
+void HttpServer::add_route(const std::string& path, Handler handler) {
+    routes_[path] = std::move(handler);
+}
+
+void HttpServer::add_stream_route(const std::string& path, StreamHandler handler) {
+    stream_routes_[path] = std::move(handler);
+}
+
+void HttpServer::notify() {
+    uint64_t one = 1;
+    if (running_ && wake_fd_ >= 0) (void)::write(wake_fd_, &one, sizeof(one));
+}
+
+bool HttpServer::listen_unix(const std::string& path) {
+    if (running_ || unix_fd_ >= 0) {
+        set_error("listen_unix must be called once, before start");
+        return false;
+    }
+    sockaddr_un addr{};
+    addr.sun_family = AF_UNIX;
+    if (path.empty() || path.size() >= sizeof(addr.sun_path)) {
+        set_error("Invalid Unix socket path: " + path);
+        return false;
+    }
+    std::memcpy(addr.sun_path, path.c_str(), path.size() + 1);
+
+    // Replace a socket left behind by an earlier run, but never a regular file
+    struct stat st{};
+    if (::lstat(path.c_str(), &st) == 0) {
+        if (!S_ISSOCK(st.st_mode)) {
+            set_error(path + " exists and is not a socket");
+            return false;
+        }
+        ::unlink(path.c_str());
+    }
+    unix_fd_ = ::socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (unix_fd_ < 0) {
+        set_error(std::string("socket failed: ") + std::strerror(errno));
+        return false;
+    }
+    if (::bind(unix_fd_, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) < 0) {
+        set_error("bind " + path + " failed: " + std::strerror(errno));
+        ::close(unix_fd_);
+        unix_fd_ = -1;
+        return false;
+    }
+    unix_path_ = path;
+    if (::listen(unix_fd_, 128) < 0 || !set_nonblocking(unix_fd_)) {
+        set_error(std::string("listen failed: ") + std::strerror(errno));
+        cleanup();
+        return false;
+    }
+    return true;
+}
+
+bool HttpServer::start(const std::string& bind_address, int port) {
+    if (running_) return true;
+    if (port < 0 && unix_fd_ < 0) {
+        set_error("No TCP port or Unix socket to listen on");
+        return false;
+    }
+
+    sockaddr_in addr{};
+    if (port >= 0) {
+        listen_fd_ = ::socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0);
+        if (listen_fd_ < 0) {
+            set_error(std::string("socket failed: ") + std::strerror(errno));
+            cleanup();
+            return false;
+        }
+        int one = 1;
+        setsockopt(listen_fd_, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+
+        addr.sin_family = AF_INET;
+        addr.sin_port = htons(static_cast<uint16_t>(port));
+        if (inet_pton(AF_INET, bind_address.c_str(), &addr.sin_addr) != 1) {
+            set_error("Invalid bind address: " + bind_address);
+            cleanup();
+            return false;
+        }
+        if (::bind(listen_fd_, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) < 0) {
+            set_error("bind " + bind_address + ":" + std::to_string(port) + " failed: " + std::strerror(errno));
+            cleanup();
+            return false;
+        }
+        if (::listen(listen_fd_, 128) < 0 || !set_nonblocking(listen_fd_)) {
+            set_error(std::string("listen failed: ") + std::strerror(errno));
+            cleanup();
+            return false;
+        }
+        socklen_t len = sizeof(addr);
+        getsockname(listen_fd_, reinterpret_cast<sockaddr*>(&addr), &len);
+        port_ = ntohs(addr.sin_port);
+    }
+
+    epoll_fd_ = epoll_create1(EPOLL_CLOEXEC);
+    wake_fd_ = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (epoll_fd_ < 0 || wake_fd_ < 0) {
+        set_error(std::string("epoll/eventfd setup failed: ") + std::strerror(errno));
+        cleanup();
+        return false;
+    }
+    epoll_event ev{};
+    ev.events = EPOLLIN;
+    for (int fd : {listen_fd_, unix_fd_, wake_fd_}) {
+        if (fd < 0) continue;
+        ev.data.fd = fd;
+        epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, fd, &ev);
+    }
+
+    running_ = true;
+    thread_ = std::thread([this]() { serve_loop(); });
+    return true;
+}
+
+void HttpServer::stop() {
+    if (running_) {
+        running_ = false;
+        uint64_t one = 1;
+        if (wake_fd_ >= 0) (void)::write(wake_fd_, &one, sizeof(one));
+        if (thread_.joinable()) thread_.join();
+    }
+    cleanup();
+}
+
+nlohmann::json HttpServer::get_stats() const {
+    nlohmann::json j;
+    j["port"] = port_;
+    j["requests_served"] = requests_served_.load();
+    j["connections_accepted"] = connections_accepted_.load();
+    j["streams_opened"] = streams_opened_.load();
+    return j;
+}
+
+void HttpServer::serve_loop() {
+    epoll_event events[64];
+    while (running_) {
+        int n = epoll_wait(epoll_fd_, events, 64, 1000);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            set_error(std::string("epoll_wait failed: ") + std::strerror(errno));
+            break;
+        }
+        for (int i = 0; i < n; ++i) {
+            int fd = events[i].data.fd;
+            if (fd == wake_fd_) {
+                uint64_t count;
+                (void)::read(wake_fd_, &count, sizeof(count));
+                if (running_) pull_streams();
+                continue;
+            }
+            if (fd == listen_fd_ || fd == unix_fd_) {
+                accept_connections(fd);
+                continue;
+            }
+            if (events[i].events & (EPOLLERR | EPOLLHUP)) {
+                close_connection(fd);
+                continue;
+            }
+            if (events[i].events & EPOLLIN) handle_readable(fd);
+            if ((events[i].events & EPOLLOUT) && connections_.count(fd)) handle_writable(fd);
+        }
+        close_idle_connections();
+    }
+    while (!connections_.empty()) close_connection(connections_.begin()->first);
+}
+
+void HttpServer::accept_connections(int listen_fd) {
+    while (true) {
+        int fd = ::accept4(listen_fd, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
+        if (fd < 0) return; // EAGAIN or transient error
+        if (connections_.size() >= kMaxConnections) {
+            ::close(fd);
+            continue;
+        }
+        if (listen_fd == listen_fd_) {
+            int one = 1;
+            setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+        }
+        epoll_event ev{};
+        ev.events = EPOLLIN;
+        ev.data.fd = fd;
+        if (epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, fd, &ev) < 0) {
+            ::close(fd);
+            continue;
+        }
+        connections_[fd].last_active_ms = now_ms();
+        ++connections_accepted_;
+    }
+}
+
+void HttpServer::handle_readable(int fd) {
+    static Counter& requests_total = MetricsRegistry::instance().counter(
+        "environet_http_requests_total", "HTTP requests served by embedded servers");
+    auto it = connections_.find(fd);
+    if (it == connections_.end()) return;
+    Connection& conn = it->second;
+    char buf[8192];
+    while (true) {
+        ssize_t n = ::recv(fd, buf, sizeof(buf), 0);
+        if (n > 0) {
+            conn.in.append(buf, static_cast<size_t>(n));
+            if (conn.in.size() > kMaxRequestBytes) break;
+            continue;
+        }
+        if (n == 0) {
+            close_connection(fd);
+            return;
+        }
+        if (errno == EINTR) continue;
+        if (errno == EAGAIN || errno == EWOULDBLOCK) break;
+        close_connection(fd);
+        return;
+    }
+    conn.last_active_ms = now_ms();
+    if (conn.stream) {
+        if (!conn.stream->receive(conn.in, conn.out) || conn.in.size() > kMaxRequestBytes) {
+            conn.close_after_write = true;
+        }
+        handle_writable(fd);
+        return;
+    }
+
+    // Handle every complete (possibly pipelined) request in the buffer
+    while (!conn.close_after_write && !conn.stream) {
+        HttpRequest req;
+        bool keep_alive = false;
+        bool bad = false;
+        if (!parse_request(conn, req, keep_alive, bad)) {
+            if (bad || conn.in.size() > kMaxRequestBytes) {
+                HttpResponse resp;
+                resp.status = 400;
+                resp.body = "Bad Request\n";
+                serialize(conn.out, resp, false);
+                conn.close_after_write = true;
+            }
+            break;
+        }
+        ++requests_served_;
+        requests_total.inc();
+        if (req.method == "GET" && stream_routes_.count(req.path)) {
+            open_stream(conn, req);
+            // Bytes after the request (e.g. early WebSocket frames) belong to the stream
+            if (conn.stream && !conn.in.empty() && !conn.stream->receive(conn.in, conn.out)) {
+                conn.close_after_write = true;
+            }
+            break;
+        }
+        serialize(conn.out, dispatch(req), keep_alive);
+        if (!keep_alive) conn.close_after_write = true;
+    }
+    handle_writable(fd);
+}
+
+void HttpServer::handle_writable(int fd) {
+    auto it = connections_.find(fd);
+    if (it == connections_.end()) return;
+    Connection& conn = it->second;
+    // Large responses go out in pieces; the buffer is only reset once fully sent
+    while (true) {
+        while (conn.out_pos < conn.out.size()) {
+            ssize_t n = ::send(fd, conn.out.data() + conn.out_pos, conn.out.size() - conn.out_pos, MSG_NOSIGNAL);
+            if (n > 0) {
+                conn.out_pos += static_cast<size_t>(n);
+                continue;
+            }
+            if (n < 0 && errno == EINTR) continue;
+            if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) break;
+            close_connection(fd);
+            return;
+        }
+        if (conn.out_pos < conn.out.size()) break;
+        conn.out.clear();
+        conn.out_pos = 0;
+        if (conn.out.capacity() > kMaxRetainedOutBytes) conn.out.shrink_to_fit();
+        // A stream refills only once the socket took everything, so a slow client backs up in the stream
+        if (!conn.stream || conn.close_after_write) break;
+        if (!conn.stream->pull(conn.out)) conn.close_after_write = true;
+        if (conn.out.empty()) break;
+    }
+    if (conn.out.empty() && conn.close_after_write) {
+        close_connection(fd);
+        return;
+    }
+    epoll_event ev{};
+    ev.events = EPOLLIN | (conn.out.empty() ? 0u : static_cast<uint32_t>(EPOLLOUT));
+    ev.data.fd = fd;
+    epoll_ctl(epoll_fd_, EPOLL_CTL_MOD, fd, &ev);
+}
+
+void HttpServer::close_connection(int fd) {
+    epoll_ctl(epoll_fd_, EPOLL_CTL_DEL, fd, nullptr);
+    ::close(fd);
+    auto it = connections_.find(fd);
+    if (it == connections_.end()) return;
+    auto stream = std::move(it->second.stream);
+    connections_.erase(it);
+    if (stream) stream->closed();
+}
+
+void HttpServer::close_idle_connections() {
+    uint64_t now = now_ms();
+    for (auto it = connections_.begin(); it != connections_.end();) {
+        int fd = it->first;
+        bool idle = !it->second.stream && now - it->second.last_active_ms > kIdleTimeoutMs;
+        ++it;
+        if (idle) close_connection(fd);
+    }
+}
+
+void HttpServer::pull_streams() {
+    std::vector<int> idle;
+    for (const auto& kv : connections_) {
+        if (kv.second.stream && kv.second.out.empty()) idle.push_back(kv.first);
+    }
+    for (int fd : idle) handle_writable(fd);
+}
+
+void HttpServer::open_stream(Connection& conn, const HttpRequest& req) {
+    HttpResponse resp;
+    std::shared_ptr<HttpStream> stream;
+    try {
+        stream = stream_routes_[req.path](req, resp);
+    } catch (const std::exception& e) {
+        LOGW("HTTP stream handler for {} failed: {}", req.path, e.what());
+        resp = HttpResponse();
+        resp.status = 500;
+        resp.body = "Internal Server Error\n";
+    }
+    if (!stream) {
+        serialize(conn.out, resp, false);
+        conn.close_after_write = true;
+        return;
+    }
+    serialize_head(conn.out, resp);
+    conn.stream = std::move(stream);
+    ++streams_opened_;
+}
+
+bool HttpServer::parse_request(Connection& conn, HttpRequest& req, bool& keep_alive, bool& bad) {
+    size_t header_end = conn.in.find("\r\n\r\n");
+    if (header_end == std::string::npos) return false;
+
+    size_t line_end = conn.in.find("\r\n");
+    std::string request_line = conn.in.substr(0, line_end);
+    size_t sp1 = request_line.find(' ');
+    size_t sp2 = request_line.find(' ', sp1 == std::string::npos ? 0 : sp1 + 1);
+    if (sp1 == std::string::npos || sp2 == std::string::npos) {
+        bad = true;
+        return false;
+    }
+    req.method = request_line.substr(0, sp1);
+    std::string target = request_line.substr(sp1 + 1, sp2 - sp1 - 1);
+    std::string version = request_line.substr(sp2 + 1);
+    size_t q = target.find('?');
+    req.path = target.substr(0, q);
+    if (q != std::string::npos) req.query = target.substr(q + 1);
+
+    size_t pos = line_end + 2;
+    while (pos < header_end) {
+        size_t eol = conn.in.find("\r\n", pos);
+        std::string line = conn.in.substr(pos, eol - pos);
+        size_t colon = line.find(':');
+        if (colon != std::string::npos) {
+            std::string value = line.substr(colon + 1);
+            value.erase(0, value.find_first_not_of(" \t"));
+            req.headers[to_lower(line.substr(0, colon))] = value;
+        }
+        pos = eol + 2;
+    }
+
+    size_t body_len = 0;
+    auto cl = req.headers.find("content-length");
+    if (cl != req.headers.end()) {
+        try { body_len = std::stoul(cl->second); } catch (...) { bad = true; return false; }
+        if (body_len > kMaxRequestBytes) { bad = true; return false; }
+    }
+    if (conn.in.size() < header_end + 4 + body_len) return false;
+    req.body = conn.in.substr(header_end + 4, body_len);
+    conn.in.erase(0, header_end + 4 + body_len);
+
+    auto connection = req.headers.find("connection");
+    std::string conn_hdr = connection != req.headers.end() ? to_lower(connection->second) : "";
+    if (version == "HTTP/1.1") keep_alive = conn_hdr != "close";
+    else keep_alive = conn_hdr == "keep-alive";
+    return true;
+}
+
+HttpResponse HttpServer::dispatch(const HttpRequest& req) {
+    HttpResponse resp;
+    if (req.method != "GET" && req.method != "HEAD") {
+        resp.status = 405;
+        resp.body = "Method Not Allowed\n";
+        return resp;
+    }
+    auto it = routes_.find(req.path);
+    if (it == routes_.end()) {
+        resp.status = 404;
+        resp.body = "Not Found\n";
+        return resp;
+    }
+    try {
+        resp = it->second(req);
+    } catch (const std::exception& e) {
+        LOGW("HTTP handler for {} failed: {}", req.path, e.what());
+        resp = HttpResponse();
+        resp.status = 500;
+        resp.body = "Internal Server Error\n";
+    }
+    if (req.method == "HEAD") resp.body.clear();
+    return resp;
+}
+
+void HttpServer::serialize(std::string& out, const HttpResponse& resp, bool keep_alive) {
+    out.reserve(out.size() + resp.body.size() + 160);
+    out += "HTTP/1.1 ";
+    out += std::to_string(resp.status);
+    out += ' ';
+    out += status_text(resp.status);
+    for (const auto& h : resp.headers) {
+        out += "\r\n";
+        out += h.first;
+        out += ": ";
+        out += h.second;
+    }
+    out += "\r\nContent-Type: ";
+    out += resp.content_type;
+    out += "\r\nContent-Length: ";
+    out += std::to_string(resp.body.size());
+    out += keep_alive ? "\r\nConnection: keep-alive\r\n\r\n" : "\r\nConnection: close\r\n\r\n";
+    out += resp.body;
+}
+
+void HttpServer::serialize_head(std::string& out, const HttpResponse& resp) {
+    out += "HTTP/1.1 ";
+    out += std::to_string(resp.status);
+    out += ' ';
+    out += status_text(resp.status);
+    out += "\r\n";
+    if (!resp.content_type.empty()) {
+        out += "Content-Type: ";
+        out += resp.content_type;
+        out += "\r\n";
+    }
+    for (const auto& h : resp.headers) {
+        out += h.first;
+        out += ": ";
+        out += h.second;
+        out += "\r\n";
+    }
+    out += "\r\n";
+}
+
+const char* HttpServer::status_text(int status) {
+    switch (status) {
+        case 101: return "Switching Protocols";
+        case 200: return "OK";
+        case 204: return "No Content";
+        case 400: return "Bad Request";
+        case 404: return "Not Found";
+        case 405: return "Method Not Allowed";
+        case 500: return "Internal Server Error";
+        case 503: return "Service Unavailable";
+        default: return "Unknown";
+    }
+}
+
+void HttpServer::set_error(const std::string& e) { last_error_ = e; }
+
+void HttpServer::cleanup() {
+    while (!connections_.empty()) close_connection(connections_.begin()->first);
+    if (listen_fd_ >= 0) { ::close(listen_fd_); listen_fd_ = -1; }
+    if (unix_fd_ >= 0) { ::close(unix_fd_); unix_fd_ = -1; }
+    if (!unix_path_.empty()) { ::unlink(unix_path_.c_str()); unix_path_.clear(); }
+    if (epoll_fd_ >= 0) { ::close(epoll_fd_); epoll_fd_ = -1; }
+    if (wake_fd_ >= 0) { ::close(wake_fd_); wake_fd_ = -1; }
+}
+
+} // namespace core
+} // namespace environet
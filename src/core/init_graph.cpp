@@ -0,0 +1,233 @@
+#include "core/init_graph.hpp"
+
+#include <condition_variable>
+#include <map>
+#include <mutex>
+#include <thread>
+
+namespace environet {
+namespace core {
+
+using Clock = std::chrono::steady_clock;
+
+namespace {
+
+enum class Status { Pending, Running, Succeeded, Failed, TimedOut, Skipped };
+
+double ms_between(Clock::time_point from, Clock::time_point to) {
+    return std::chrono::duration<double, std::milli>(to - from).count();
+}
+
+} // namespace
+
+// Shared with step threads so an abandoned step can finish after run() returns
+struct InitGraph::State {
+    std::mutex mutex;
+    std::condition_variable cv;
+    std::vector<Status> status;
+    std::vector<Clock::time_point> started;
+    std::vector<InitResult> results;
+};
+
+InitGraph::InitGraph() = default;
+InitGraph::~InitGraph() = default;
+
+void InitGraph::add(const std::string& name, InitFn fn, std::vector<std::string> deps,
+                    std::chrono::milliseconds deadline, bool required) {
+    nodes_.push_back(Node{name, std::move(fn), {}, std::move(deps), deadline, required});
+}
+
+bool InitGraph::resolve() {
+    std::map<std::string, size_t> index;
+    for (size_t i = 0; i < nodes_.size(); ++i) {
+        if (!index.emplace(nodes_[i].name, i).second) {
+            last_error_ = "duplicate init step: " + nodes_[i].name;
+            return false;
+        }
+    }
+    std::vector<size_t> pending_deps(nodes_.size(), 0);
+    for (auto& node : nodes_) {
+        node.deps.clear();
+        for (const auto& dep : node.dep_names) {
+            auto it = index.find(dep);
+            if (it == index.end()) {
+                last_error_ = "init step " + node.name + " depends on unknown step " + dep;
+                return false;
+            }
+            node.deps.push_back(it->second);
+        }
+    }
+
+    // Kahn's algorithm: every step must be reachable without a cycle
+    std::vector<size_t> ready;
+    for (size_t i = 0; i < nodes_.size(); ++i) {
+        pending_deps[i] = nodes_[i].deps.size();
+        if (pending_deps[i] == 0) ready.push_back(i);
+    }
+    size_t visited = 0;
+    while (!ready.empty()) {
+        size_t done = ready.back();
+        ready.pop_back();
+        ++visited;
+        for (size_t i = 0; i < nodes_.size(); ++i) {
+            for (size_t dep : nodes_[i].deps) {
+                if (dep == done && --pending_deps[i] == 0) ready.push_back(i);
+            }
+        }
+    }
+    if (visited != nodes_.size()) {
+        last_error_ = "init steps have a dependency cycle";
+        return false;
+    }
+    return true;
+}
+
+bool InitGraph::run() {
+    last_error_.clear();
+    results_.clear();
+    if (!resolve()) return false;
+
+    const size_t n = nodes_.size();
+    auto state = std::make_shared<State>();
+    state->status.assign(n, Status::Pending);
+    state->started.resize(n);
+    state->results.resize(n);
+    for (size_t i = 0; i < n; ++i) {
+        state->results[i].name = nodes_[i].name;
+        state->results[i].required = nodes_[i].required;
+    }
+    state_ = state;
+
+    std::vector<std::thread> threads(n);
+    const auto begin = Clock::now();
+    std::unique_lock<std::mutex> lock(state->mutex);
+
+    for (;;) {
+        // Start every step whose dependencies have all succeeded; skip those
+        // with a dependency that will never succeed
+        bool changed = true;
+        while (changed) {
+            changed = false;
+            for (size_t i = 0; i < n; ++i) {
+                if (state->status[i] != Status::Pending) continue;
+                bool ready = true;
+                std::string blocked_by;
+                for (size_t dep : nodes_[i].deps) {
+                    Status s = state->status[dep];
+                    if (s == Status::Failed || s == Status::TimedOut || s == Status::Skipped) {
+                        blocked_by = nodes_[dep].name;
+                        break;
+                    }
+                    if (s != Status::Succeeded) ready = false;
+                }
+                if (!blocked_by.empty()) {
+                    state->status[i] = Status::Skipped;
+                    state->results[i].skipped = true;
+                    state->results[i].error = "dependency " + blocked_by + " did not succeed";
+                    changed = true;
+                } else if (ready) {
+                    state->status[i] = Status::Running;
+                    state->started[i] = Clock::now();
+                    state->results[i].start_ms = ms_between(begin, state->started[i]);
+                    threads[i] = std::thread([state, i, fn = nodes_[i].fn]() {
+                        std::string error;
+                        bool ok = false;
+                        try {
+                            ok = fn(error);
+                        } catch (const std::exception& e) {
+                            error = e.what();
+                        }
+                        auto end = Clock::now();
+                        std::lock_guard<std::mutex> step_lock(state->mutex);
+                        if (state->status[i] != Status::Running) return;  // Abandoned at its deadline
+                        state->status[i] = ok ? Status::Succeeded : Status::Failed;
+                        state->results[i].ok = ok;
+                        state->results[i].error = ok ? std::string() : error;
+                        state->results[i].elapsed_ms = ms_between(state->started[i], end);
+                        state->cv.notify_all();
+                    });
+                    changed = true;
+                }
+            }
+        }
+
+        // Abandon steps past their deadline and find the next one to wait for
+        auto now = Clock::now();
+        auto next_deadline = Clock::time_point::max();
+        bool running = false;
+        bool expired = false;
+        for (size_t i = 0; i < n; ++i) {
+            if (state->status[i] != Status::Running) continue;
+            auto deadline = state->started[i] + nodes_[i].deadline;
+            if (now >= deadline) {
+                state->status[i] = Status::TimedOut;
+                state->results[i].timed_out = true;
+                state->results[i].elapsed_ms = ms_between(state->started[i], now);
+                state->results[i].error = "timed out after " + std::to_string(nodes_[i].deadline.count()) + " ms";
+                expired = true;
+            } else {
+                running = true;
+                if (deadline < next_deadline) next_deadline = deadline;
+            }
+        }
+        if (expired) continue;
+        if (!running) break;
+        state->cv.wait_until(lock, next_deadline);
+    }
+
+    results_ = state->results;
+    lock.unlock();
+    elapsed_ms_ = ms_between(begin, Clock::now());
+
+    for (size_t i = 0; i < n; ++i) {
+        if (!threads[i].joinable()) continue;
+        if (results_[i].timed_out) {
+            threads[i].detach();
+        } else {
+            threads[i].join();
+        }
+    }
+
+    for (const auto& r : results_) {
+        if (r.required && !r.ok) {
+            last_error_ = r.name + ": " + r.error;
+            return false;
+        }
+    }
+    return true;
+}
+
+const InitResult* InitGraph::result(const std::string& name) const {
+    for (const auto& r : results_) {
+        if (r.name == name) return &r;
+    }
+    return nullptr;
+}
+
+const std::vector<InitResult>& InitGraph::results() const { return results_; }
+
+double InitGraph::elapsed_ms() const { return elapsed_ms_; }
+
+nlohmann::json InitGraph::get_stats() const {
+    nlohmann::json j;
+    j["elapsed_ms"] = elapsed_ms_;
+    j["steps"] = nlohmann::json::array();
+    for (const auto& r : results_) {
+        j["steps"].push_back({
+            {"name", r.name},
+            {"required", r.required},
+            {"ok", r.ok},
+            {"timed_out", r.timed_out},
+            {"skipped", r.skipped},
+            {"start_ms", r.start_ms},
+            {"elapsed_ms", r.elapsed_ms},
+            {"error", r.error},
+        });
+    }
+    return j;
+}
+
+std::string InitGraph::get_last_error() const { return last_error_; }
+
+} // namespace core
+} // namespace environet
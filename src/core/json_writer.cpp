@@ -0,0 +1,44 @@
+#include "core/json_writer.hpp"
+
+#include <cmath>
+
+namespace environet {
+namespace core {
+
+JsonWriter& JsonWriter::value(double v) {
+    if (!std::isfinite(v)) return null();
+    separator();
+    char buf[32];
+    auto res = std::to_chars(buf, buf + sizeof(buf), v);
+    out_.append(buf, res.ptr);
+    return *this;
+}
+
+void JsonWriter::append_string(std::string_view s) {
+    static const char hex[] = "0123456789abcdef";
+    out_ += '"';
+    size_t run = 0;     // Start of the pending run of bytes that need no escaping
+    for (size_t i = 0; i < s.size(); ++i) {
+        unsigned char c = static_cast<unsigned char>(s[i]);
+        if (c >= 0x20 && c != '"' && c != '\\') continue;
+        out_.append(s.data() + run, i - run);
+        run = i + 1;
+        switch (c) {
+        case '"': out_ += "\\\""; break;
+        case '\\': out_ += "\\\\"; break;
+        case '\n': out_ += "\\n"; break;
+        case '\r': out_ += "\\r"; break;
+        case '\t': out_ += "\\t"; break;
+        default:
+            out_ += "\\u00";
+            out_ += hex[c >> 4];
+            out_ += hex[c & 0x0F];
+            break;
+        }
+    }
+    out_.append(s.data() + run, s.size() - run);
+    out_ += '"';
+}
+
+} // namespace core
+} // namespace environet
@@ -0,0 +1,90 @@
+#include "core/latency.hpp"
+#include "core/log.hpp"
+
+#include <mutex>
+#include <vector>
+
+namespace environet {
+namespace core {
+
+static uint64_t monotonic_raw_ns() {
+    timespec ts;
+    clock_gettime(CLOCK_MONOTONIC_RAW, &ts);
+    return static_cast<uint64_t>(ts.tv_sec) * 1000000000ULL + static_cast<uint64_t>(ts.tv_nsec);
+}
+
+static double calibrate_seconds_per_tick() {
+#if defined(__x86_64__) || defined(__i386__)
+    // Spin for ~5 ms and compare TSC progress against the raw monotonic clock
+    uint64_t ns0 = monotonic_raw_ns();
+    uint64_t t0 = latency_ticks();
+    uint64_t ns1 = ns0;
+    while (ns1 - ns0 < 5000000ULL) ns1 = monotonic_raw_ns();
+    uint64_t t1 = latency_ticks();
+    if (t1 <= t0) return 1e-9;
+    return static_cast<double>(ns1 - ns0) * 1e-9 / static_cast<double>(t1 - t0);
+#elif defined(__aarch64__)
+    uint64_t freq;
+    asm volatile("mrs %0, cntfrq_el0" : "=r"(freq));
+    return freq ? 1.0 / static_cast<double>(freq) : 1e-9;
+#else
+    return 1e-9;
+#endif
+}
+
+double latency_seconds_per_tick() {
+    static const double seconds_per_tick = calibrate_seconds_per_tick();
+    return seconds_per_tick;
+}
+
+namespace {
+struct LatencyEntry {
+    std::string name;
+    Histogram* hist;
+};
+std::mutex g_latency_mutex;
+std::vector<LatencyEntry> g_latency_histograms;
+} // namespace
+
+Histogram& latency_histogram(const std::string& name, const std::string& help) {
+    Histogram& hist = MetricsRegistry::instance().histogram(name, help, latency_seconds_per_tick());
+    std::lock_guard<std::mutex> lock(g_latency_mutex);
+    for (const auto& e : g_latency_histograms) {
+        if (e.hist == &hist) return hist;
+    }
+    g_latency_histograms.push_back({name, &hist});
+    return hist;
+}
+
+nlohmann::json latency_summary(const Histogram& hist) {
+    auto snap = hist.snapshot();
+    double ns_per_tick = hist.unit_scale() * 1e9;
+    auto ns = [ns_per_tick](uint64_t ticks) { return static_cast<double>(ticks) * ns_per_tick; };
+    nlohmann::json j;
+    j["count"] = snap.count;
+    j["p50_ns"] = ns(snap.percentile(0.50));
+    j["p99_ns"] = ns(snap.percentile(0.99));
+    j["p999_ns"] = ns(snap.percentile(0.999));
+    j["max_ns"] = ns(snap.max);
+    return j;
+}
+
+nlohmann::json latency_stats() {
+    std::lock_guard<std::mutex> lock(g_latency_mutex);
+    nlohmann::json j = nlohmann::json::object();
+    for (const auto& e : g_latency_histograms) j[e.name] = latency_summary(*e.hist);
+    return j;
+}
+
+void dump_latency_stats() {
+    auto stats = latency_stats();
+    for (auto it = stats.begin(); it != stats.end(); ++it) {
+        const auto& s = it.value();
+        LOGI("Latency {}: n={} p50={:.0f}ns p99={:.0f}ns p999={:.0f}ns max={:.0f}ns",
+             it.key(), s["count"].get<uint64_t>(), s["p50_ns"].get<double>(), s["p99_ns"].get<double>(),
+             s["p999_ns"].get<double>(), s["max_ns"].get<double>());
+    }
+}
+
+} // namespace core
+} // namespace environet
@@ -1,28 +1,63 @@
 #include "core/log.hpp"
+#include "core/metrics_registry.hpp"
+#include <spdlog/async.h>
 #include <spdlog/sinks/rotating_file_sink.h>
 #include <spdlog/sinks/stdout_color_sinks.h>
 #include <spdlog/sinks/basic_file_sink.h>
 #include <iostream>
+#include <mutex>
+#include <vector>
 
 namespace environet {
 namespace core {
 
+namespace detail {
+std::atomic<spdlog::logger*> g_logger_raw{nullptr};
+} // namespace detail
+
 // Global logger instance
 static std::shared_ptr<spdlog::logger> g_logger;
+static std::shared_ptr<spdlog::details::thread_pool> g_thread_pool;
+static std::mutex g_logger_mutex;
+
+// Loggers and thread pools replaced at runtime. Kept alive because other
+// threads may still hold the raw pointer handed out by logger_ptr().
+static std::vector<std::shared_ptr<void>> g_retired;
+
+static Counter& suppressed_counter() {
+    static Counter& counter = MetricsRegistry::instance().counter(
+        "environet_log_suppressed_total", "Log records dropped by per-call-site rate limiting");
+    return counter;
+}
+
+// Caller holds g_logger_mutex
+static void publish_logger(std::shared_ptr<spdlog::logger> logger,
+                           std::shared_ptr<spdlog::details::thread_pool> pool) {
+    if (g_logger) g_retired.push_back(g_logger);
+    if (g_thread_pool && g_thread_pool != pool) g_retired.push_back(g_thread_pool);
+    g_logger = std::move(logger);
+    g_thread_pool = std::move(pool);
+    detail::g_logger_raw.store(g_logger.get(), std::memory_order_release);
+    if (g_logger) spdlog::set_default_logger(g_logger);
+}
+
+void init_logger(const std::string& level,
+                 const std::string& file_path,
+                 size_t max_size,
+                 size_t max_files,
+                 bool async,
+                 size_t async_queue_size,
+                 const std::string& overflow_policy,
+                 std::function<void()> on_thread_start) {
 
-void init_logger(const std::string& level, 
-                 const std::string& file_path, 
-                 size_t max_size, 
-                 size_t max_files) {
-    
     // Create sinks vector
     std::vector<spdlog::sink_ptr> sinks;
-    
+
     // Always add console sink
     auto console_sink = std::make_shared<spdlog::sinks::stdout_color_sink_mt>();
     console_sink->set_level(spdlog::level::from_str(level));
     sinks.push_back(console_sink);
-    
+
     // Add file sink if path is provided
     if (!file_path.empty()) {
         try {
@@ -35,42 +70,101 @@ void init_logger(const std::string& level,
             std::cerr << "Continuing with console logging only." << std::endl;
         }
     }
-    
-    // Create logger with multiple sinks
-    g_logger = std::make_shared<spdlog::logger>("environet", sinks.begin(), sinks.end());
-    g_logger->set_level(spdlog::level::from_str(level));
-    
+
+    // Create logger with multiple sinks; in async mode a single background
+    // thread drains a preallocated queue into the sinks
+    std::shared_ptr<spdlog::logger> logger;
+    std::shared_ptr<spdlog::details::thread_pool> pool;
+    if (async) {
+        auto policy = overflow_policy == "block" ? spdlog::async_overflow_policy::block
+                                                 : spdlog::async_overflow_policy::overrun_oldest;
+        pool = on_thread_start
+            ? std::make_shared<spdlog::details::thread_pool>(async_queue_size, 1, std::move(on_thread_start))
+            : std::make_shared<spdlog::details::thread_pool>(async_queue_size, 1);
+        logger = std::make_shared<spdlog::async_logger>("environet", sinks.begin(), sinks.end(), pool, policy);
+        // Errors should reach disk promptly even though writes are deferred
+        logger->flush_on(spdlog::level::err);
+    } else {
+        logger = std::make_shared<spdlog::logger>("environet", sinks.begin(), sinks.end());
+    }
+    logger->set_level(spdlog::level::from_str(level));
+
     // Set as default logger
-    spdlog::set_default_logger(g_logger);
-    
+    {
+        std::lock_guard<std::mutex> lock(g_logger_mutex);
+        publish_logger(logger, pool);
+    }
+
     // Log initialization
-    g_logger->info("Logging system initialized with level: {}", level);
+    logger->info("Logging system initialized with level: {}{}", level,
+                 async ? fmt::format(" (async, queue={}, overflow={})", async_queue_size, overflow_policy) : "");
     if (!file_path.empty()) {
-        g_logger->info("Log file: {} (max: {}MB, keep: {} files)", 
-                      file_path, max_size / (1024 * 1024), max_files);
+        logger->info("Log file: {} (max: {}MB, keep: {} files)",
+                     file_path, max_size / (1024 * 1024), max_files);
     }
 }
 
 std::shared_ptr<spdlog::logger> get_logger() {
+    std::lock_guard<std::mutex> lock(g_logger_mutex);
     if (!g_logger) {
         // If logger hasn't been initialized, create a basic console logger
         std::cerr << "Warning: Logger not initialized, creating default console logger" << std::endl;
         auto console_sink = std::make_shared<spdlog::sinks::stdout_color_sink_mt>();
-        g_logger = std::make_shared<spdlog::logger>("environet_default", console_sink);
-        g_logger->set_level(spdlog::level::info);
-        spdlog::set_default_logger(g_logger);
+        auto logger = std::make_shared<spdlog::logger>("environet_default", console_sink);
+        logger->set_level(spdlog::level::info);
+        publish_logger(logger, nullptr);
     }
     return g_logger;
 }
 
+spdlog::logger* detail::fallback_logger() {
+    return get_logger().get();
+}
+
+void detail::count_suppressed() {
+    suppressed_counter().inc();
+}
+
+void set_log_level(const std::string& level) {
+    auto logger = get_logger();
+    auto lvl = spdlog::level::from_str(level);
+    for (auto& sink : logger->sinks()) sink->set_level(lvl);
+    logger->set_level(lvl);
+}
+
 void shutdown_logger() {
-    if (g_logger) {
-        g_logger->info("Shutting down logging system");
-        g_logger->flush();
-        spdlog::shutdown();
-        g_logger.reset();
+    std::shared_ptr<spdlog::logger> logger;
+    {
+        std::lock_guard<std::mutex> lock(g_logger_mutex);
+        logger = g_logger;
+    }
+    if (logger) {
+        logger->info("Shutting down logging system");
+        // Async loggers only queue the flush; it runs when the pool drains below
+        logger->flush();
+        std::shared_ptr<spdlog::details::thread_pool> pool;
+        {
+            std::lock_guard<std::mutex> lock(g_logger_mutex);
+            pool = std::move(g_thread_pool);
+            publish_logger(nullptr, nullptr);
+            detail::g_logger_raw.store(nullptr, std::memory_order_release);
+            spdlog::shutdown();
+        }
+        // Loggers only hold the pool weakly: dropping the last reference
+        // processes every queued record, then joins the worker thread
+        pool.reset();
     }
 }
 
+nlohmann::json get_log_stats() {
+    nlohmann::json j;
+    std::lock_guard<std::mutex> lock(g_logger_mutex);
+    j["async"] = static_cast<bool>(g_thread_pool);
+    j["queue_depth"] = g_thread_pool ? g_thread_pool->queue_size() : 0;
+    j["queue_overruns"] = g_thread_pool ? g_thread_pool->overrun_counter() : 0;
+    j["rate_limited"] = suppressed_counter().value();
+    return j;
+}
+
 } // namespace core
 } // namespace environet
@@ -0,0 +1,231 @@
+#include "core/metrics_registry.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <stdexcept>
+
+namespace environet {
+namespace core {
+
+static std::string format_value(double v) {
+    if (std::isnan(v)) return "NaN";
+    if (std::isinf(v)) return v > 0 ? "+Inf" : "-Inf";
+    char buf[64];
+    std::snprintf(buf, sizeof(buf), "%.10g", v);
+    return buf;
+}
+
+static std::string escape_label_value(const std::string& v) {
+    std::string out;
+    out.reserve(v.size());
+    for (char c : v) {
+        if (c == '\\' || c == '"') { out.push_back('\\'); out.push_back(c); }
+        else if (c == '\n') out += "\\n";
+        else out.push_back(c);
+    }
+    return out;
+}
+
+std::string format_metric_labels(const MetricLabels& labels) {
+    if (labels.empty()) return {};
+    std::string out = "{";
+    for (size_t i = 0; i < labels.size(); ++i) {
+        if (i) out.push_back(',');
+        out += labels[i].first;
+        out += "=\"";
+        out += escape_label_value(labels[i].second);
+        out.push_back('"');
+    }
+    out.push_back('}');
+    return out;
+}
+
+// Append an extra label to an already formatted label block
+static std::string with_label(const std::string& block, const std::string& key, const std::string& value) {
+    std::string extra = key + "=\"" + value + "\"";
+    if (block.empty()) return "{" + extra + "}";
+    return block.substr(0, block.size() - 1) + "," + extra + "}";
+}
+
+uint64_t Histogram::bucket_lower_bound(size_t index) {
+    if (index < kSubBuckets) return index;
+    size_t group = index / kSubBuckets;
+    uint64_t sub = index % kSubBuckets;
+    return (kSubBuckets + sub) << (group - 1);
+}
+
+uint64_t Histogram::bucket_upper_bound(size_t index) {
+    if (index < kSubBuckets) return index;
+    size_t group = index / kSubBuckets;
+    return bucket_lower_bound(index) + ((uint64_t{1} << (group - 1)) - 1);
+}
+
+static std::atomic<size_t> g_next_histogram_id{0};
+
+Histogram::Histogram(double unit_scale)
+    : id_(g_next_histogram_id.fetch_add(1, std::memory_order_relaxed)), unit_scale_(unit_scale) {}
+
+Histogram::Shard* Histogram::attach_thread_shard() {
+    auto shard = std::make_unique<Shard>();
+    Shard* raw = shard.get();
+    {
+        std::lock_guard<std::mutex> lock(shards_mutex_);
+        shards_.push_back(std::move(shard));
+    }
+    auto& shards = thread_shards();
+    if (shards.size() <= id_) shards.resize(id_ + 1, nullptr);
+    shards[id_] = raw;
+    return raw;
+}
+
+Histogram::Snapshot Histogram::snapshot() const {
+    Snapshot snap;
+    std::lock_guard<std::mutex> lock(shards_mutex_);
+    for (const auto& s : shards_) {
+        snap.count += s->count.load(std::memory_order_relaxed);
+        snap.sum += s->sum.load(std::memory_order_relaxed);
+        snap.max = std::max(snap.max, s->max.load(std::memory_order_relaxed));
+        for (size_t i = 0; i < kBucketCount; ++i) {
+            snap.buckets[i] += s->buckets[i].load(std::memory_order_relaxed);
+        }
+    }
+    return snap;
+}
+
+uint64_t Histogram::Snapshot::percentile(double q) const {
+    if (count == 0) return 0;
+    if (q <= 0.0) q = 0.0;
+    if (q >= 1.0) return max;
+    uint64_t rank = static_cast<uint64_t>(std::ceil(q * static_cast<double>(count)));
+    if (rank == 0) rank = 1;
+    uint64_t seen = 0;
+    for (size_t i = 0; i < kBucketCount; ++i) {
+        seen += buckets[i];
+        if (seen >= rank) {
+            uint64_t lo = bucket_lower_bound(i);
+            uint64_t hi = bucket_upper_bound(i);
+            uint64_t mid = lo + (hi - lo) / 2;
+            return std::min(mid, max);
+        }
+    }
+    return max;
+}
+
+MetricsRegistry& MetricsRegistry::instance() {
+    static MetricsRegistry registry;
+    return registry;
+}
+
+MetricsRegistry::Family& MetricsRegistry::family(const std::string& name, const std::string& help, Type type) {
+    auto it = families_.find(name);
+    if (it == families_.end()) {
+        Family f;
+        f.type = type;
+        f.help = help;
+        it = families_.emplace(name, std::move(f)).first;
+    } else if (it->second.type != type) {
+        throw std::invalid_argument("metric registered with a different type: " + name);
+    }
+    return it->second;
+}
+
+Counter& MetricsRegistry::counter(const std::string& name, const std::string& help, const MetricLabels& labels) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto& slot = family(name, help, Type::Counter).counters[format_metric_labels(labels)];
+    if (!slot) slot = std::make_unique<Counter>();
+    return *slot;
+}
+
+Gauge& MetricsRegistry::gauge(const std::string& name, const std::string& help, const MetricLabels& labels) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto& slot = family(name, help, Type::Gauge).gauges[format_metric_labels(labels)];
+    if (!slot) slot = std::make_unique<Gauge>();
+    return *slot;
+}
+
+Histogram& MetricsRegistry::histogram(const std::string& name, const std::string& help,
+                                      double unit_scale, const MetricLabels& labels) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto& slot = family(name, help, Type::Histogram).histograms[format_metric_labels(labels)];
+    if (!slot) slot = std::make_unique<Histogram>(unit_scale);
+    return *slot;
+}
+
+std::string MetricsRegistry::render_prometheus(bool openmetrics) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    std::string out;
+    out.reserve(4096);
+    for (const auto& [name, fam] : families_) {
+        std::string family_name = name;
+        const char* type = "gauge";
+        if (fam.type == Type::Counter) {
+            type = "counter";
+            // OpenMetrics names the family without the _total sample suffix
+            if (openmetrics && family_name.size() > 6 &&
+                family_name.compare(family_name.size() - 6, 6, "_total") == 0) {
+                family_name.resize(family_name.size() - 6);
+            }
+        } else if (fam.type == Type::Histogram) {
+            type = "histogram";
+        }
+        out += "# HELP " + family_name + " " + fam.help + "\n";
+        out += "# TYPE " + family_name + " " + type + "\n";
+
+        for (const auto& [labels, c] : fam.counters) {
+            out += name + labels + " " + std::to_string(c->value()) + "\n";
+        }
+        for (const auto& [labels, g] : fam.gauges) {
+            out += name + labels + " " + format_value(g->value()) + "\n";
+        }
+        for (const auto& [labels, h] : fam.histograms) {
+            auto snap = h->snapshot();
+            // Export le = 2^k - 1 up to the largest observed value: each is the
+            // upper bound of the last bucket in a group, so summing the buckets
+            // that end at or below it counts exactly the values <= le
+            int top = snap.max ? 64 - __builtin_clzll(snap.max) : 0;
+            size_t bucket = 0;
+            uint64_t cumulative = 0;
+            for (int k = 0; k <= top; ++k) {
+                uint64_t le = k == 64 ? UINT64_MAX : (uint64_t{1} << k) - 1;
+                while (bucket < Histogram::kBucketCount && Histogram::bucket_upper_bound(bucket) <= le) {
+                    cumulative += snap.buckets[bucket++];
+                }
+                out += name + "_bucket" +
+                       with_label(labels, "le", format_value(static_cast<double>(le) * h->unit_scale())) +
+                       " " + std::to_string(cumulative) + "\n";
+            }
+            out += name + "_bucket" + with_label(labels, "le", "+Inf") + " " + std::to_string(snap.count) + "\n";
+            out += name + "_sum" + labels + " " +
+                   format_value(static_cast<double>(snap.sum) * h->unit_scale()) + "\n";
+            out += name + "_count" + labels + " " + std::to_string(snap.count) + "\n";
+        }
+    }
+    if (openmetrics) out += "# EOF\n";
+    return out;
+}
+
+nlohmann::json MetricsRegistry::to_json() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    nlohmann::json j = nlohmann::json::object();
+    for (const auto& [name, fam] : families_) {
+        for (const auto& [labels, c] : fam.counters) j[name + labels] = c->value();
+        for (const auto& [labels, g] : fam.gauges) j[name + labels] = g->value();
+        for (const auto& [labels, h] : fam.histograms) {
+            auto snap = h->snapshot();
+            double scale = h->unit_scale();
+            j[name + labels] = {
+                {"count", snap.count},
+                {"mean", snap.mean() * scale},
+                {"p50", static_cast<double>(snap.percentile(0.50)) * scale},
+                {"p99", static_cast<double>(snap.percentile(0.99)) * scale},
+                {"p999", static_cast<double>(snap.percentile(0.999)) * scale},
+                {"max", static_cast<double>(snap.max) * scale}
+            };
+        }
+    }
+    return j;
+}
+
+} // namespace core
+} // namespace environet
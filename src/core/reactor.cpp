@@ -0,0 +1,256 @@
+#include "core/reactor.hpp"
+
+#include <cerrno>
+#include <csignal>
+#include <cstring>
+#include <pthread.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/signalfd.h>
+#include <sys/timerfd.h>
+#include <unistd.h>
+
+namespace environet {
+namespace core {
+
+namespace {
+
+itimerspec to_itimerspec(std::chrono::milliseconds interval, std::chrono::milliseconds first) {
+    itimerspec spec{};
+    spec.it_interval.tv_sec = interval.count() / 1000;
+    spec.it_interval.tv_nsec = (interval.count() % 1000) * 1000000L;
+    if (first.count() <= 0) {
+        spec.it_value.tv_nsec = 1;  // All-zero it_value would disarm the timer
+    } else {
+        spec.it_value.tv_sec = first.count() / 1000;
+        spec.it_value.tv_nsec = (first.count() % 1000) * 1000000L;
+    }
+    return spec;
+}
+
+} // namespace
+
+Reactor::Reactor() = default;
+
+Reactor::~Reactor() {
+    for (const auto& entry : handlers_) {
+        if (entry.second->kind != Kind::Fd) ::close(entry.first);
+    }
+    if (wake_fd_ >= 0) ::close(wake_fd_);
+    if (epoll_fd_ >= 0) ::close(epoll_fd_);
+}
+
+bool Reactor::init() {
+    epoll_fd_ = epoll_create1(EPOLL_CLOEXEC);
+    if (epoll_fd_ < 0) {
+        set_error(std::string("epoll_create1 failed: ") + std::strerror(errno));
+        return false;
+    }
+    wake_fd_ = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (wake_fd_ < 0) {
+        set_error(std::string("eventfd failed: ") + std::strerror(errno));
+        return false;
+    }
+    epoll_event ev{};
+    ev.events = EPOLLIN;
+    ev.data.fd = wake_fd_;
+    if (epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, wake_fd_, &ev) < 0) {
+        set_error(std::string("epoll_ctl failed: ") + std::strerror(errno));
+        return false;
+    }
+    return true;
+}
+
+bool Reactor::watch(int fd, uint32_t events, std::shared_ptr<Handler> handler) {
+    epoll_event ev{};
+    ev.events = events;
+    ev.data.fd = fd;
+    if (epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, fd, &ev) < 0) {
+        set_error(std::string("epoll_ctl failed: ") + std::strerror(errno));
+        return false;
+    }
+    handlers_[fd] = std::move(handler);
+    return true;
+}
+
+int Reactor::add_timer(std::chrono::milliseconds interval, Callback callback, std::chrono::milliseconds first) {
+    int fd = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+    if (fd < 0) {
+        set_error(std::string("timerfd_create failed: ") + std::strerror(errno));
+        return -1;
+    }
+    itimerspec spec = to_itimerspec(interval, first);
+    auto handler = std::make_shared<Handler>();
+    handler->kind = Kind::Timer;
+    handler->callback = std::move(callback);
+    if (timerfd_settime(fd, 0, &spec, nullptr) < 0) {
+        set_error(std::string("timerfd_settime failed: ") + std::strerror(errno));
+        ::close(fd);
+        return -1;
+    }
+    if (!watch(fd, EPOLLIN, handler)) {
+        ::close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+bool Reactor::set_timer_interval(int id, std::chrono::milliseconds interval) {
+    auto it = handlers_.find(id);
+    if (it == handlers_.end() || it->second->kind != Kind::Timer) {
+        set_error("unknown timer " + std::to_string(id));
+        return false;
+    }
+    itimerspec spec = to_itimerspec(interval, interval);
+    if (timerfd_settime(id, 0, &spec, nullptr) < 0) {
+        set_error(std::string("timerfd_settime failed: ") + std::strerror(errno));
+        return false;
+    }
+    return true;
+}
+
+bool Reactor::add_signals(const std::vector<int>& signals, SignalCallback callback) {
+    sigset_t mask;
+    sigemptyset(&mask);
+    for (int signo : signals) sigaddset(&mask, signo);
+    int fd = signalfd(-1, &mask, SFD_NONBLOCK | SFD_CLOEXEC);
+    if (fd < 0) {
+        set_error(std::string("signalfd failed: ") + std::strerror(errno));
+        return false;
+    }
+    auto handler = std::make_shared<Handler>();
+    handler->kind = Kind::Signal;
+    handler->signal_callback = std::move(callback);
+    if (!watch(fd, EPOLLIN, handler)) {
+        ::close(fd);
+        return false;
+    }
+    return true;
+}
+
+bool Reactor::add_fd(int fd, uint32_t events, FdCallback callback) {
+    auto handler = std::make_shared<Handler>();
+    handler->kind = Kind::Fd;
+    handler->fd_callback = std::move(callback);
+    return watch(fd, events, handler);
+}
+
+bool Reactor::remove(int fd) {
+    auto it = handlers_.find(fd);
+    if (it == handlers_.end()) return false;
+    epoll_ctl(epoll_fd_, EPOLL_CTL_DEL, fd, nullptr);
+    if (it->second->kind != Kind::Fd) ::close(fd);
+    handlers_.erase(it);
+    return true;
+}
+
+void Reactor::post(Callback task) {
+    {
+        std::lock_guard<std::mutex> lock(post_mutex_);
+        posted_.push_back(std::move(task));
+    }
+    uint64_t one = 1;
+    ssize_t ignored = ::write(wake_fd_, &one, sizeof(one));
+    (void)ignored;
+}
+
+void Reactor::stop() {
+    stop_requested_.store(true);
+    uint64_t one = 1;
+    ssize_t ignored = ::write(wake_fd_, &one, sizeof(one));
+    (void)ignored;
+}
+
+void Reactor::run() {
+    epoll_event events[16];
+    while (!stop_requested_.load()) {
+        int n = epoll_wait(epoll_fd_, events, 16, -1);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            set_error(std::string("epoll_wait failed: ") + std::strerror(errno));
+            break;
+        }
+        wakeups_.fetch_add(1, std::memory_order_relaxed);
+        for (int i = 0; i < n && !stop_requested_.load(); ++i) {
+            dispatch(events[i].data.fd, events[i].events);
+        }
+    }
+    stop_requested_.store(false);
+}
+
+void Reactor::dispatch(int fd, uint32_t events) {
+    if (fd == wake_fd_) {
+        uint64_t count;
+        ssize_t ignored = ::read(wake_fd_, &count, sizeof(count));
+        (void)ignored;
+        drain_posted();
+        return;
+    }
+    auto it = handlers_.find(fd);
+    if (it == handlers_.end()) return;  // Removed by an earlier callback in this batch
+    auto handler = it->second;           // Keep alive if the callback removes itself
+
+    switch (handler->kind) {
+    case Kind::Timer: {
+        uint64_t expirations = 0;
+        if (::read(fd, &expirations, sizeof(expirations)) != sizeof(expirations)) return;
+        timer_fires_.fetch_add(1, std::memory_order_relaxed);
+        if (expirations > 1) timer_overruns_.fetch_add(expirations - 1, std::memory_order_relaxed);
+        handler->callback();
+        break;
+    }
+    case Kind::Signal: {
+        signalfd_siginfo info;
+        while (::read(fd, &info, sizeof(info)) == sizeof(info)) {
+            signals_.fetch_add(1, std::memory_order_relaxed);
+            handler->signal_callback(static_cast<int>(info.ssi_signo));
+        }
+        break;
+    }
+    case Kind::Fd:
+        handler->fd_callback(events);
+        break;
+    }
+}
+
+void Reactor::drain_posted() {
+    std::deque<Callback> tasks;
+    {
+        std::lock_guard<std::mutex> lock(post_mutex_);
+        tasks.swap(posted_);
+    }
+    for (auto& task : tasks) {
+        tasks_.fetch_add(1, std::memory_order_relaxed);
+        task();
+    }
+}
+
+bool Reactor::block_signals(const std::vector<int>& signals) {
+    sigset_t mask;
+    sigemptyset(&mask);
+    for (int signo : signals) sigaddset(&mask, signo);
+    return pthread_sigmask(SIG_BLOCK, &mask, nullptr) == 0;
+}
+
+nlohmann::json Reactor::get_stats() const {
+    nlohmann::json j;
+    j["wakeups"] = wakeups_.load();
+    j["timer_fires"] = timer_fires_.load();
+    j["timer_overruns"] = timer_overruns_.load();
+    j["signals"] = signals_.load();
+    j["tasks"] = tasks_.load();
+    return j;
+}
+
+std::string Reactor::get_last_error() const {
+    std::lock_guard<std::mutex> lock(error_mutex_);
+    return last_error_;
+}
+
+void Reactor::set_error(const std::string& error) {
+    std::lock_guard<std::mutex> lock(error_mutex_);
+    last_error_ = error;
+}
+
+} // namespace core
+} // namespace environet
@@ -0,0 +1,155 @@
+#include "core/sketch.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace environet {
+namespace core {
+
+namespace {
+
+size_t round_up_pow2(size_t n) {
+    size_t p = 1;
+    while (p < n) p <<= 1;
+    return p;
+}
+
+} // namespace
+
+CountMinSketch::CountMinSketch(size_t width, size_t depth)
+    : width_(round_up_pow2(std::max<size_t>(width, 1))), depth_(std::max<size_t>(depth, 1)),
+      mask_(width_ - 1), counters_(width_ * depth_, 0) {}
+
+uint64_t CountMinSketch::estimate(uint64_t hash) const {
+    uint64_t h2 = (hash >> 32) | 1;
+    uint64_t best = std::numeric_limits<uint64_t>::max();
+    for (size_t row = 0; row < depth_; ++row) {
+        best = std::min(best, counters_[row * width_ + ((hash + row * h2) & mask_)]);
+    }
+    return best;
+}
+
+bool CountMinSketch::merge(const CountMinSketch& other) {
+    if (other.width_ != width_ || other.depth_ != depth_) return false;
+    for (size_t i = 0; i < counters_.size(); ++i) counters_[i] += other.counters_[i];
+    total_ += other.total_;
+    return true;
+}
+
+void CountMinSketch::clear() {
+    std::fill(counters_.begin(), counters_.end(), 0);
+    total_ = 0;
+}
+
+SpaceSaving::SpaceSaving(size_t capacity) : capacity_(std::max<size_t>(capacity, 1)) {
+    entries_.reserve(2 * capacity_);
+}
+
+void SpaceSaving::add(uint64_t hash, const char* key, size_t len, uint64_t count) {
+    Entry* smallest = nullptr;
+    for (auto& e : entries_) {
+        if (e.hash == hash) {
+            e.count += count;
+            return;
+        }
+        if (!smallest || e.count < smallest->count) smallest = &e;
+    }
+    Entry* slot;
+    uint64_t inherited = 0;
+    if (entries_.size() < capacity_) {
+        slot = &entries_.emplace_back();
+    } else {
+        slot = smallest;
+        inherited = smallest->count;
+    }
+    slot->hash = hash;
+    slot->count = inherited + count;
+    slot->error = inherited;
+    len = std::min(len, KEY_SIZE - 1);
+    std::memcpy(slot->key, key, len);
+    slot->key[len] = '\0';
+}
+
+void SpaceSaving::merge(const SpaceSaving& other) {
+    // A key missing from a full summary may have up to its minimum count there
+    const uint64_t own_min = min_count();
+    const uint64_t other_min = other.min_count();
+    const size_t own = entries_.size();
+    for (size_t i = 0; i < own; ++i) {
+        auto& e = entries_[i];
+        auto it = std::find_if(other.entries_.begin(), other.entries_.end(),
+                               [&e](const Entry& o) { return o.hash == e.hash; });
+        if (it != other.entries_.end()) {
+            e.count += it->count;
+            e.error += it->error;
+        } else {
+            e.count += other_min;
+            e.error += other_min;
+        }
+    }
+    for (const auto& o : other.entries_) {
+        auto end = entries_.begin() + static_cast<std::ptrdiff_t>(own);
+        if (std::find_if(entries_.begin(), end, [&o](const Entry& e) { return e.hash == o.hash; }) != end) {
+            continue;
+        }
+        Entry& e = entries_.emplace_back(o);
+        e.count += own_min;
+        e.error += own_min;
+    }
+    if (entries_.size() > capacity_) {
+        std::nth_element(entries_.begin(), entries_.begin() + static_cast<std::ptrdiff_t>(capacity_ - 1),
+                         entries_.end(), [](const Entry& a, const Entry& b) { return a.count > b.count; });
+        entries_.resize(capacity_);
+    }
+}
+
+std::vector<SpaceSaving::Entry> SpaceSaving::top(size_t k) const {
+    std::vector<Entry> sorted(entries_);
+    std::sort(sorted.begin(), sorted.end(), [](const Entry& a, const Entry& b) { return a.count > b.count; });
+    if (sorted.size() > k) sorted.resize(k);
+    return sorted;
+}
+
+uint64_t SpaceSaving::min_count() const {
+    if (entries_.size() < capacity_) return 0;
+    uint64_t smallest = std::numeric_limits<uint64_t>::max();
+    for (const auto& e : entries_) smallest = std::min(smallest, e.count);
+    return smallest;
+}
+
+HyperLogLog::HyperLogLog(int precision)
+    : precision_(std::clamp(precision, 4, 16)), registers_(size_t{1} << precision_, 0) {}
+
+double HyperLogLog::estimate() const {
+    const double m = static_cast<double>(registers_.size());
+    double sum = 0.0;
+    size_t zeros = 0;
+    for (uint8_t r : registers_) {
+        sum += std::ldexp(1.0, -r);
+        if (r == 0) ++zeros;
+    }
+    double alpha = registers_.size() == 16 ? 0.673
+                 : registers_.size() == 32 ? 0.697
+                 : registers_.size() == 64 ? 0.709
+                 : 0.7213 / (1.0 + 1.079 / m);
+    double raw = alpha * m * m / sum;
+    // Small cardinalities: the fraction of empty registers is more accurate
+    if (raw <= 2.5 * m && zeros > 0) return m * std::log(m / static_cast<double>(zeros));
+    return raw;
+}
+
+bool HyperLogLog::merge(const HyperLogLog& other) {
+    if (other.precision_ != precision_) return false;
+    for (size_t i = 0; i < registers_.size(); ++i) {
+        registers_[i] = std::max(registers_[i], other.registers_[i]);
+    }
+    return true;
+}
+
+void HyperLogLog::clear() {
+    std::fill(registers_.begin(), registers_.end(), 0);
+}
+
+} // namespace core
+} // namespace environet
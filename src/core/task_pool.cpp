@@ -0,0 +1,195 @@
+#include "core/task_pool.hpp"
+#include "core/log.hpp"
+#include "core/timeline.hpp"
+
+#include <pthread.h>
+#include <sched.h>
+
+namespace environet {
+namespace core {
+
+namespace {
+
+// Worker identity of the calling thread (nullptr outside any pool)
+thread_local const TaskPool* tl_pool = nullptr;
+thread_local size_t tl_index = 0;
+
+std::vector<int> allowed_cpus() {
+    std::vector<int> cpus;
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    if (sched_getaffinity(0, sizeof(set), &set) == 0) {
+        for (int cpu = 0; cpu < CPU_SETSIZE; ++cpu) {
+            if (CPU_ISSET(cpu, &set)) cpus.push_back(cpu);
+        }
+    }
+    return cpus;
+}
+
+} // namespace
+
+TaskPool::TaskPool()
+    : tasks_run_(MetricsRegistry::instance().counter(
+          "environet_task_pool_tasks_total", "Tasks run by the work-stealing pool")),
+      steals_(MetricsRegistry::instance().counter(
+          "environet_task_pool_steals_total", "Tasks taken from another worker's deque")),
+      queue_depth_(MetricsRegistry::instance().gauge(
+          "environet_task_pool_queue_depth", "Tasks queued in the work-stealing pool")) {}
+
+TaskPool::~TaskPool() { stop(); }
+
+bool TaskPool::start(size_t workers, bool pin_workers) {
+    if (running_.load()) return false;
+    std::vector<int> cpus = allowed_cpus();
+    if (workers == 0) workers = cpus.empty() ? 1 : cpus.size();
+
+    // Deques outlive stop() so late submitters and waiting callers never
+    // see them go away; a restarted pool keeps its first worker count
+    if (queues_.empty()) {
+        for (size_t i = 0; i < workers; ++i) queues_.push_back(std::make_unique<Queue>());
+    }
+    workers = queues_.size();
+    pinned_ = pin_workers && !cpus.empty();
+    running_.store(true, std::memory_order_release);
+
+    for (size_t i = 0; i < workers; ++i) {
+        workers_.emplace_back([this, i]() { worker_loop(i); });
+        if (pinned_) {
+            cpu_set_t set;
+            CPU_ZERO(&set);
+            CPU_SET(cpus[i % cpus.size()], &set);
+            if (pthread_setaffinity_np(workers_.back().native_handle(), sizeof(set), &set) != 0) {
+                LOGW("Failed to pin task worker {} to CPU {}", i, cpus[i % cpus.size()]);
+            }
+        }
+    }
+    return true;
+}
+
+void TaskPool::stop() {
+    if (!running_.exchange(false)) return;
+    {
+        std::lock_guard<std::mutex> lock(sleep_mutex_);
+    }
+    sleep_cv_.notify_all();
+    for (auto& worker : workers_) {
+        if (worker.joinable()) worker.join();
+    }
+    workers_.clear();
+    // Finish what was queued so parallel_for callers waiting on it return
+    while (run_one()) {
+    }
+}
+
+void TaskPool::submit(Task task) {
+    if (!running_.load(std::memory_order_acquire)) {
+        execute(task);
+        return;
+    }
+    size_t index = tl_pool == this ? tl_index
+                                   : next_queue_.fetch_add(1, std::memory_order_relaxed) % queues_.size();
+    {
+        std::lock_guard<std::mutex> lock(queues_[index]->mutex);
+        queues_[index]->tasks.push_back(std::move(task));
+    }
+    queued(1);
+    if (!running_.load(std::memory_order_acquire)) {
+        // Raced with stop(): no worker may be left to pick the task up
+        while (run_one()) {
+        }
+        return;
+    }
+    {
+        std::lock_guard<std::mutex> lock(sleep_mutex_);
+    }
+    sleep_cv_.notify_one();
+}
+
+bool TaskPool::run_one() {
+    if (queues_.empty()) return false;
+    Task task;
+    bool found = tl_pool == this ? (pop_local(tl_index, task) || steal(tl_index, task))
+                                 : steal(queues_.size() - 1, task);
+    if (!found) return false;
+    execute(task);
+    return true;
+}
+
+bool TaskPool::pop_local(size_t index, Task& task) {
+    auto& queue = *queues_[index];
+    std::lock_guard<std::mutex> lock(queue.mutex);
+    if (queue.tasks.empty()) return false;
+    task = std::move(queue.tasks.back());
+    queue.tasks.pop_back();
+    queued(-1);
+    return true;
+}
+
+bool TaskPool::steal(size_t thief, Task& task) {
+    const size_t n = queues_.size();
+    for (size_t offset = 1; offset <= n; ++offset) {
+        size_t victim = (thief + offset) % n;
+        if (victim == thief && tl_pool == this) continue;  // Own deque is popped, not stolen
+        auto& queue = *queues_[victim];
+        std::lock_guard<std::mutex> lock(queue.mutex);
+        if (queue.tasks.empty()) continue;
+        task = std::move(queue.tasks.front());
+        queue.tasks.pop_front();
+        queued(-1);
+        stolen_.fetch_add(1, std::memory_order_relaxed);
+        steals_.inc();
+        return true;
+    }
+    return false;
+}
+
+void TaskPool::execute(Task& task) {
+    try {
+        task();
+    } catch (const std::exception& e) {
+        LOGW("Task failed: {}", e.what());
+    } catch (...) {
+        LOGW("Task failed: unknown exception");
+    }
+    tasks_.fetch_add(1, std::memory_order_relaxed);
+    tasks_run_.inc();
+}
+
+void TaskPool::queued(int64_t delta) {
+    int64_t depth = pending_.fetch_add(delta, std::memory_order_acq_rel) + delta;
+    queue_depth_.set(static_cast<double>(depth));
+}
+
+void TaskPool::worker_loop(size_t index) {
+    tl_pool = this;
+    tl_index = index;
+    Timeline::instance().set_thread_name("task-" + std::to_string(index));
+    while (running_.load(std::memory_order_acquire)) {
+        Task task;
+        if (pop_local(index, task) || steal(index, task)) {
+            execute(task);
+            continue;
+        }
+        std::unique_lock<std::mutex> lock(sleep_mutex_);
+        sleep_cv_.wait(lock, [this]() {
+            return !running_.load(std::memory_order_acquire) || pending_.load(std::memory_order_acquire) > 0;
+        });
+    }
+    tl_pool = nullptr;
+}
+
+nlohmann::json TaskPool::get_stats() const {
+    nlohmann::json j;
+    uint64_t tasks = tasks_.load();
+    uint64_t steals = stolen_.load();
+    j["workers"] = size();
+    j["pinned"] = pinned_;
+    j["tasks"] = tasks;
+    j["steals"] = steals;
+    j["steal_rate"] = tasks ? static_cast<double>(steals) / static_cast<double>(tasks) : 0.0;
+    j["queue_depth"] = pending_.load();
+    return j;
+}
+
+} // namespace core
+} // namespace environet
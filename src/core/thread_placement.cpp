@@ -0,0 +1,232 @@
+#include "core/thread_placement.hpp"
+
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <linux/mempolicy.h>
+#include <pthread.h>
+#include <sched.h>
+#include <sys/resource.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+namespace environet {
+namespace core {
+
+namespace fs = std::filesystem;
+
+namespace {
+
+constexpr int MAX_NODES = 1024;
+
+pid_t current_tid() {
+    return static_cast<pid_t>(::syscall(SYS_gettid));
+}
+
+const Config::ThreadPlacementConfig* role_config(const Config::ThreadsConfig& threads, const std::string& role) {
+    if (role == "capture") return &threads.capture;
+    if (role == "writer") return &threads.writer;
+    if (role == "sensor") return &threads.sensor;
+    if (role == "correlation") return &threads.correlation;
+    if (role == "metrics") return &threads.metrics;
+    return nullptr;
+}
+
+int policy_value(const std::string& policy) {
+    if (policy == "fifo") return SCHED_FIFO;
+    if (policy == "rr") return SCHED_RR;
+    return SCHED_OTHER;
+}
+
+const char* policy_name(int policy) {
+    switch (policy) {
+    case SCHED_OTHER: return "other";
+    case SCHED_FIFO: return "fifo";
+    case SCHED_RR: return "rr";
+    case SCHED_BATCH: return "batch";
+    case SCHED_IDLE: return "idle";
+    default: return "unknown";
+    }
+}
+
+bool thread_exists(pid_t tid) {
+    std::ifstream f("/proc/self/task/" + std::to_string(tid) + "/stat");
+    return f.good();
+}
+
+// Field 39 of /proc/<tid>/stat: CPU the thread last ran on
+int last_cpu(pid_t tid) {
+    std::ifstream f("/proc/self/task/" + std::to_string(tid) + "/stat");
+    std::string line;
+    if (!std::getline(f, line)) return -1;
+    size_t paren = line.rfind(')');
+    if (paren == std::string::npos) return -1;
+    std::istringstream fields(line.substr(paren + 2));
+    std::string field;
+    for (int i = 3; i <= 39 && fields >> field; ++i) {
+        if (i == 39) return std::atoi(field.c_str());
+    }
+    return -1;
+}
+
+// /sys/devices/system/cpu/cpuN has a nodeM link on NUMA kernels
+int cpu_node(int cpu) {
+    if (cpu < 0) return -1;
+    std::error_code ec;
+    for (const auto& entry : fs::directory_iterator("/sys/devices/system/cpu/cpu" + std::to_string(cpu), ec)) {
+        std::string name = entry.path().filename().string();
+        if (name.size() > 4 && name.compare(0, 4, "node") == 0 &&
+            name.find_first_not_of("0123456789", 4) == std::string::npos) {
+            return std::stoi(name.substr(4));
+        }
+    }
+    return -1;
+}
+
+} // namespace
+
+ThreadPlacement& ThreadPlacement::instance() {
+    static ThreadPlacement placement;
+    return placement;
+}
+
+void ThreadPlacement::configure(const Config::ThreadsConfig& threads) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    threads_ = threads;
+}
+
+bool ThreadPlacement::apply(const std::string& role, int memory_node) {
+    Config::ThreadPlacementConfig placement;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        const auto* cfg = role_config(threads_, role);
+        if (!cfg) {
+            last_error_ = "unknown thread role " + role;
+            return false;
+        }
+        placement = *cfg;
+    }
+
+    Entry entry;
+    entry.tid = current_tid();
+    std::string error;
+    auto fail = [&error](const std::string& what, int rc) {
+        error += (error.empty() ? "" : "; ") + what + ": " + std::strerror(rc);
+    };
+
+    if (!placement.cpus.empty()) {
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        for (int cpu : placement.cpus) {
+            if (cpu >= 0 && cpu < CPU_SETSIZE) CPU_SET(cpu, &set);
+        }
+        int rc = pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+        if (rc != 0) fail("affinity", rc);
+    }
+    // Nice is per thread on Linux; setting it first keeps it if the policy change fails
+    if (placement.nice != 0 && setpriority(PRIO_PROCESS, static_cast<id_t>(entry.tid), placement.nice) != 0) {
+        fail("nice", errno);
+    }
+    if (placement.policy != "other") {
+        sched_param param{};
+        param.sched_priority = placement.priority;
+        int rc = pthread_setschedparam(pthread_self(), policy_value(placement.policy), &param);
+        if (rc != 0) fail("policy " + placement.policy, rc);
+    }
+    if (memory_node >= 0) {
+        if (set_memory_node(memory_node)) {
+            entry.memory_node = memory_node;
+        } else {
+            fail("memory node " + std::to_string(memory_node), errno);
+        }
+    }
+    entry.error = error;
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto& threads = entries_[role];
+    // Drop threads of this role that have exited (e.g. capture restarted)
+    for (auto it = threads.begin(); it != threads.end();) {
+        it = thread_exists(it->tid) && it->tid != entry.tid ? it + 1 : threads.erase(it);
+    }
+    threads.push_back(entry);
+    if (!error.empty()) {
+        last_error_ = role + " thread placement: " + error;
+        return false;
+    }
+    return true;
+}
+
+nlohmann::json ThreadPlacement::get_stats() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    nlohmann::json j = nlohmann::json::object();
+    for (const auto& role : entries_) {
+        nlohmann::json list = nlohmann::json::array();
+        for (const auto& entry : role.second) {
+            nlohmann::json t;
+            t["tid"] = entry.tid;
+            cpu_set_t set;
+            CPU_ZERO(&set);
+            if (!thread_exists(entry.tid) || sched_getaffinity(entry.tid, sizeof(set), &set) != 0) {
+                t["alive"] = false;
+                list.push_back(t);
+                continue;
+            }
+            t["alive"] = true;
+            std::vector<int> cpus;
+            for (int cpu = 0; cpu < CPU_SETSIZE; ++cpu) {
+                if (CPU_ISSET(cpu, &set)) cpus.push_back(cpu);
+            }
+            t["cpus"] = cpus;
+            int policy = sched_getscheduler(entry.tid);
+            sched_param param{};
+            sched_getparam(entry.tid, &param);
+            t["policy"] = policy_name(policy);
+            t["priority"] = param.sched_priority;
+            errno = 0;
+            int nice = getpriority(PRIO_PROCESS, static_cast<id_t>(entry.tid));
+            t["nice"] = errno == 0 ? nice : 0;
+            int cpu = last_cpu(entry.tid);
+            t["last_cpu"] = cpu;
+            t["node"] = cpu_node(cpu);
+            t["memory_node"] = entry.memory_node;
+            if (!entry.error.empty()) t["error"] = entry.error;
+            list.push_back(t);
+        }
+        j[role.first] = list;
+    }
+    return j;
+}
+
+std::string ThreadPlacement::get_last_error() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return last_error_;
+}
+
+int ThreadPlacement::interface_numa_node(const std::string& iface) {
+    if (iface.empty() || iface.find('/') != std::string::npos) return -1;
+    std::ifstream f("/sys/class/net/" + iface + "/device/numa_node");
+    int node = -1;
+    if (!(f >> node)) return -1;
+    return node;
+}
+
+bool ThreadPlacement::set_memory_node(int node) {
+    if (node < 0) {
+        return ::syscall(SYS_set_mempolicy, MPOL_DEFAULT, nullptr, 0) == 0;
+    }
+    if (node >= MAX_NODES) {
+        errno = EINVAL;
+        return false;
+    }
+    constexpr size_t BITS = 8 * sizeof(unsigned long);
+    unsigned long mask[MAX_NODES / BITS] = {};
+    mask[node / BITS] |= 1UL << (node % BITS);
+    // maxnode counts one past the last bit the kernel reads
+    return ::syscall(SYS_set_mempolicy, MPOL_PREFERRED, mask, MAX_NODES + 1) == 0;
+}
+
+} // namespace core
+} // namespace environet
@@ -0,0 +1,189 @@
+#include "core/timeline.hpp"
+
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <pthread.h>
+#include <sys/syscall.h>
+#include <time.h>
+#include <unistd.h>
+#include <vector>
+
+namespace environet {
+namespace core {
+
+namespace {
+uint32_t current_tid() {
+    thread_local uint32_t tid = static_cast<uint32_t>(::syscall(SYS_gettid));
+    return tid;
+}
+
+void append_escaped(std::string& out, const char* s) {
+    out.push_back('"');
+    for (; *s; ++s) {
+        char c = *s;
+        if (c == '"' || c == '\\') {
+            out.push_back('\\');
+            out.push_back(c);
+        } else if (static_cast<unsigned char>(c) < 0x20) {
+            char buf[8];
+            std::snprintf(buf, sizeof(buf), "\\u%04x", c);
+            out += buf;
+        } else {
+            out.push_back(c);
+        }
+    }
+    out.push_back('"');
+}
+} // namespace
+
+Timeline& Timeline::instance() {
+    static Timeline trace;
+    return trace;
+}
+
+void Timeline::enable(size_t capacity) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (!ring_) {
+        size_t cap = 1;
+        while (cap < capacity) cap <<= 1;
+        ring_.reset(new TimelineEvent[cap]);
+        mask_ = cap - 1;
+    }
+    enabled_.store(true, std::memory_order_release);
+}
+
+void Timeline::record(char phase, const char* name, uint64_t ticks, uint64_t dur_ticks, int64_t value) {
+    uint64_t index = next_.fetch_add(1, std::memory_order_relaxed);
+    TimelineEvent& ev = ring_[index & mask_];
+    // Seqlock: odd while writing so dump() skips torn slots
+    ev.seq.store(2 * index + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    ev.ticks = ticks;
+    ev.dur_ticks = dur_ticks;
+    ev.value = value;
+    ev.name = name;
+    ev.tid = current_tid();
+    ev.phase = phase;
+    ev.seq.store(2 * index + 2, std::memory_order_release);
+}
+
+void Timeline::set_thread_name(const std::string& name) {
+    uint32_t tid = current_tid();
+    // Kernel thread names are limited to 15 characters
+    pthread_setname_np(pthread_self(), name.substr(0, 15).c_str());
+    std::lock_guard<std::mutex> lock(mutex_);
+    thread_names_[tid] = name;
+}
+
+std::string Timeline::to_chrome_json(double last_seconds) const {
+    struct Snapshot {
+        uint64_t ticks, dur_ticks;
+        int64_t value;
+        const char* name;
+        uint32_t tid;
+        char phase;
+    };
+    std::vector<Snapshot> events;
+    std::map<uint32_t, std::string> names;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        names = thread_names_;
+    }
+
+    // Map ticks onto wall-clock microseconds so traces line up with logs
+    double us_per_tick = latency_seconds_per_tick() * 1e6;
+    timespec ts;
+    clock_gettime(CLOCK_REALTIME, &ts);
+    uint64_t now_ticks = latency_ticks();
+    double now_us = static_cast<double>(ts.tv_sec) * 1e6 + static_cast<double>(ts.tv_nsec) / 1e3;
+    uint64_t window_ticks = last_seconds > 0 ? static_cast<uint64_t>(last_seconds * 1e6 / us_per_tick) : now_ticks;
+    uint64_t min_ticks = now_ticks > window_ticks ? now_ticks - window_ticks : 0;
+
+    if (ring_) {
+        uint64_t end = next_.load(std::memory_order_acquire);
+        uint64_t begin = end > mask_ + 1 ? end - (mask_ + 1) : 0;
+        events.reserve(end - begin);
+        for (uint64_t i = begin; i < end; ++i) {
+            const TimelineEvent& ev = ring_[i & mask_];
+            uint64_t seq = ev.seq.load(std::memory_order_acquire);
+            if (seq != 2 * i + 2) continue;
+            Snapshot s{ev.ticks, ev.dur_ticks, ev.value, ev.name, ev.tid, ev.phase};
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (ev.seq.load(std::memory_order_relaxed) != seq) continue;
+            if (s.ticks < min_ticks || !s.name) continue;
+            events.push_back(s);
+        }
+    }
+
+    int pid = static_cast<int>(::getpid());
+    std::string out;
+    out.reserve(128 + events.size() * 96);
+    out += "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+    char buf[160];
+    std::snprintf(buf, sizeof(buf),
+                  "{\"ph\":\"M\",\"name\":\"process_name\",\"pid\":%d,\"tid\":0,\"args\":{\"name\":\"environet\"}}", pid);
+    out += buf;
+    for (const auto& kv : names) {
+        std::snprintf(buf, sizeof(buf), ",{\"ph\":\"M\",\"name\":\"thread_name\",\"pid\":%d,\"tid\":%u,\"args\":{\"name\":",
+                      pid, kv.first);
+        out += buf;
+        append_escaped(out, kv.second.c_str());
+        out += "}}";
+    }
+    for (const auto& ev : events) {
+        double ts_us = now_us - static_cast<double>(now_ticks - std::min(ev.ticks, now_ticks)) * us_per_tick;
+        out += ",{\"name\":";
+        append_escaped(out, ev.name);
+        switch (ev.phase) {
+            case 'X':
+                std::snprintf(buf, sizeof(buf), ",\"ph\":\"X\",\"pid\":%d,\"tid\":%u,\"ts\":%.3f,\"dur\":%.3f}", pid,
+                              ev.tid, ts_us, static_cast<double>(ev.dur_ticks) * us_per_tick);
+                break;
+            case 'C':
+                std::snprintf(buf, sizeof(buf), ",\"ph\":\"C\",\"pid\":%d,\"tid\":%u,\"ts\":%.3f,\"args\":{\"value\":%lld}}",
+                              pid, ev.tid, ts_us, static_cast<long long>(ev.value));
+                break;
+            default:
+                std::snprintf(buf, sizeof(buf), ",\"ph\":\"i\",\"s\":\"t\",\"pid\":%d,\"tid\":%u,\"ts\":%.3f}", pid, ev.tid,
+                              ts_us);
+                break;
+        }
+        out += buf;
+    }
+    out += "]}\n";
+    return out;
+}
+
+bool Timeline::dump(const std::string& path, double last_seconds) {
+    std::string doc = to_chrome_json(last_seconds);
+    std::ofstream out(path, std::ios::binary | std::ios::trunc);
+    if (!out.is_open()) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        last_error_ = "cannot open " + path + ": " + std::strerror(errno);
+        return false;
+    }
+    out.write(doc.data(), static_cast<std::streamsize>(doc.size()));
+    if (!out.good()) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        last_error_ = "short write to " + path;
+        return false;
+    }
+    return true;
+}
+
+nlohmann::json Timeline::get_stats() const {
+    nlohmann::json j;
+    j["enabled"] = enabled();
+    j["capacity"] = ring_ ? mask_ + 1 : 0;
+    j["events_recorded"] = next_.load(std::memory_order_relaxed);
+    return j;
+}
+
+std::string Timeline::get_last_error() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return last_error_;
+}
+
+} // namespace core
+} // namespace environet
@@ -0,0 +1,376 @@
+#include "core/trace_log.hpp"
+
+#include <algorithm>
+#include <arpa/inet.h>
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <fcntl.h>
+#include <time.h>
+#include <unistd.h>
+
+namespace environet {
+namespace core {
+
+/**
+ * @brief Single-producer ring owned by one writing thread
+ */
+struct TraceLog::Ring {
+    Ring(size_t capacity, uint16_t index)
+        : records(new TraceRecord[capacity]), mask(capacity - 1), thread_index(index) {}
+
+    std::unique_ptr<TraceRecord[]> records;
+    const size_t mask;
+    const uint16_t thread_index;
+
+    // Writer side
+    alignas(64) std::atomic<size_t> head{0};
+    size_t cached_tail = 0;
+    uint32_t seq = 0;
+
+    // Flusher side
+    alignas(64) std::atomic<size_t> tail{0};
+    std::atomic<bool> orphaned{false};
+};
+
+namespace {
+std::atomic<size_t> g_next_trace_id{0};
+
+// Returns bytes written; short only on error
+size_t write_all(int fd, const void* data, size_t len) {
+    const char* p = static_cast<const char*>(data);
+    size_t done = 0;
+    while (done < len) {
+        ssize_t rc = ::write(fd, p + done, len - done);
+        if (rc < 0) {
+            if (errno == EINTR) continue;
+            break;
+        }
+        done += static_cast<size_t>(rc);
+    }
+    return done;
+}
+
+size_t round_up_pow2(size_t v) {
+    size_t p = 1;
+    while (p < v) p <<= 1;
+    return p;
+}
+} // namespace
+
+TraceLog& TraceLog::instance() {
+    static TraceLog log;
+    return log;
+}
+
+TraceLog::TraceLog() : id_(g_next_trace_id.fetch_add(1, std::memory_order_relaxed)) {}
+
+TraceLog::~TraceLog() { stop(); }
+
+bool TraceLog::start(const std::string& path, uint64_t max_file_bytes, int max_files,
+                     size_t buffer_records, int flush_interval_ms) {
+    if (running_.load()) {
+        set_error("trace log already running");
+        return false;
+    }
+    if (path.empty() || max_files < 1 || buffer_records == 0) {
+        set_error("invalid trace log parameters");
+        return false;
+    }
+    path_ = path;
+    max_file_bytes_ = max_file_bytes;
+    max_files_ = max_files;
+    buffer_records_ = round_up_pow2(buffer_records);
+    flush_interval_ms_ = flush_interval_ms > 0 ? flush_interval_ms : 20;
+    if (!open_file()) return false;
+
+    running_.store(true);
+    flusher_ = std::thread([this]() { flush_loop(); });
+    enabled_.store(true, std::memory_order_release);
+    return true;
+}
+
+void TraceLog::stop() {
+    enabled_.store(false, std::memory_order_release);
+    {
+        std::lock_guard<std::mutex> lock(wake_mutex_);
+        if (!running_.exchange(false)) return;
+    }
+    wake_cv_.notify_all();
+    if (flusher_.joinable()) flusher_.join();
+    if (fd_ >= 0) {
+        ::close(fd_);
+        fd_ = -1;
+    }
+}
+
+TraceLog::Ring* TraceLog::local_ring() {
+    // Per-thread ring pointers indexed by trace log id; the holder marks
+    // the thread's rings orphaned on thread exit so the flusher can retire them
+    struct Holder {
+        std::vector<Ring*> by_id;
+        std::vector<std::shared_ptr<Ring>> owned;
+        ~Holder() {
+            for (auto& r : owned) r->orphaned.store(true, std::memory_order_release);
+        }
+    };
+    thread_local Holder holder;
+    if (id_ < holder.by_id.size() && holder.by_id[id_]) return holder.by_id[id_];
+
+    std::shared_ptr<Ring> ring;
+    {
+        std::lock_guard<std::mutex> lock(rings_mutex_);
+        ring = std::make_shared<Ring>(buffer_records_, static_cast<uint16_t>(rings_.size()));
+        rings_.push_back(ring);
+    }
+    if (holder.by_id.size() <= id_) holder.by_id.resize(id_ + 1, nullptr);
+    holder.by_id[id_] = ring.get();
+    holder.owned.push_back(ring);
+    return ring.get();
+}
+
+TraceRecord* TraceLog::begin(TraceEventType type) {
+    if (!enabled_.load(std::memory_order_relaxed)) return nullptr;
+    Ring* ring = local_ring();
+    size_t head = ring->head.load(std::memory_order_relaxed);
+    if (head - ring->cached_tail > ring->mask) {
+        ring->cached_tail = ring->tail.load(std::memory_order_acquire);
+        if (head - ring->cached_tail > ring->mask) {
+            ++ring->seq;  // leave a gap so decoders can see the drop
+            records_dropped_.fetch_add(1, std::memory_order_relaxed);
+            return nullptr;
+        }
+    }
+    TraceRecord* rec = &ring->records[head & ring->mask];
+    rec->ticks = latency_ticks();
+    rec->type = static_cast<uint8_t>(type);
+    rec->reserved = 0;
+    rec->thread = ring->thread_index;
+    rec->seq = ring->seq++;
+    std::memset(rec->raw, 0, sizeof(rec->raw));
+    return rec;
+}
+
+void TraceLog::commit() {
+    Ring* ring = local_ring();
+    ring->head.store(ring->head.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+}
+
+size_t TraceLog::drain(Ring& ring) {
+    size_t tail = ring.tail.load(std::memory_order_relaxed);
+    size_t head = ring.head.load(std::memory_order_acquire);
+    size_t count = head - tail;
+    if (count == 0 || fd_ < 0) return 0;
+
+    // Straight from the ring to the file: at most two contiguous segments
+    size_t capacity = ring.mask + 1;
+    size_t start = tail & ring.mask;
+    size_t first = std::min(count, capacity - start);
+    size_t done = write_all(fd_, &ring.records[start], first * sizeof(TraceRecord));
+    if (done == first * sizeof(TraceRecord) && count > first) {
+        done += write_all(fd_, &ring.records[0], (count - first) * sizeof(TraceRecord));
+    }
+    if (done != count * sizeof(TraceRecord)) set_error(std::string("trace write failed: ") + std::strerror(errno));
+    size_t written = done / sizeof(TraceRecord);
+    ring.tail.store(head, std::memory_order_release);
+    records_written_.fetch_add(written, std::memory_order_relaxed);
+    file_bytes_ += written * sizeof(TraceRecord);
+    return written;
+}
+
+void TraceLog::flush_loop() {
+    for (;;) {
+        bool stopping = !running_.load(std::memory_order_acquire);
+        std::vector<std::shared_ptr<Ring>> rings;
+        {
+            std::lock_guard<std::mutex> lock(rings_mutex_);
+            rings = rings_;
+        }
+        size_t max_backlog = 0;
+        for (auto& ring : rings) {
+            bool orphaned = ring->orphaned.load(std::memory_order_acquire);
+            max_backlog = std::max(max_backlog, drain(*ring));
+            if (max_file_bytes_ > 0 && file_bytes_ >= max_file_bytes_) rotate_file();
+            if (orphaned) {
+                std::lock_guard<std::mutex> lock(rings_mutex_);
+                rings_.erase(std::remove(rings_.begin(), rings_.end(), ring), rings_.end());
+            }
+        }
+        if (stopping) break;
+        // A ring that filled past a quarter between wake-ups would overflow
+        // before the next full interval, so poll faster while under load
+        int wait_ms = max_backlog > buffer_records_ / 4 ? 1 : flush_interval_ms_;
+        std::unique_lock<std::mutex> lock(wake_mutex_);
+        wake_cv_.wait_for(lock, std::chrono::milliseconds(wait_ms), [this]() { return !running_.load(); });
+    }
+}
+
+bool TraceLog::open_file() {
+    fd_ = ::open(path_.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (fd_ < 0) {
+        set_error("cannot open trace file " + path_ + ": " + std::strerror(errno));
+        return false;
+    }
+
+    TraceFileHeader hdr{};
+    std::memcpy(hdr.magic, "ENVTRACE", 8);
+    hdr.version = kTraceVersion;
+    hdr.record_size = sizeof(TraceRecord);
+    hdr.seconds_per_tick = latency_seconds_per_tick();
+    timespec ts;
+    clock_gettime(CLOCK_REALTIME, &ts);
+    hdr.base_ticks = latency_ticks();
+    hdr.base_realtime_ns = static_cast<uint64_t>(ts.tv_sec) * 1000000000ULL + static_cast<uint64_t>(ts.tv_nsec);
+    if (write_all(fd_, &hdr, sizeof(hdr)) != sizeof(hdr)) {
+        set_error("cannot write trace header to " + path_);
+    }
+    file_bytes_ = sizeof(hdr);
+    return true;
+}
+
+void TraceLog::rotate_file() {
+    if (fd_ >= 0) {
+        ::close(fd_);
+        fd_ = -1;
+    }
+    // path -> path.1 -> path.2 ...; the oldest file falls off the end
+    for (int i = max_files_ - 1; i >= 1; --i) {
+        std::string src = i == 1 ? path_ : path_ + "." + std::to_string(i - 1);
+        std::string dst = path_ + "." + std::to_string(i);
+        std::rename(src.c_str(), dst.c_str());
+    }
+    files_rotated_.fetch_add(1, std::memory_order_relaxed);
+    open_file();
+}
+
+nlohmann::json TraceLog::get_stats() const {
+    nlohmann::json j;
+    j["enabled"] = enabled();
+    j["file"] = path_;
+    j["records_written"] = records_written_.load();
+    j["records_dropped"] = records_dropped_.load();
+    j["files_rotated"] = files_rotated_.load();
+    std::lock_guard<std::mutex> lock(rings_mutex_);
+    j["thread_buffers"] = rings_.size();
+    j["buffer_bytes"] = rings_.size() * buffer_records_ * sizeof(TraceRecord);
+    return j;
+}
+
+std::string TraceLog::get_last_error() const {
+    std::lock_guard<std::mutex> lock(error_mutex_);
+    return last_error_;
+}
+
+void TraceLog::set_error(const std::string& error) {
+    std::lock_guard<std::mutex> lock(error_mutex_);
+    last_error_ = error;
+}
+
+TraceReader::~TraceReader() {
+    if (file_) std::fclose(file_);
+}
+
+bool TraceReader::open(const std::string& path) {
+    if (file_) std::fclose(file_);
+    file_ = std::fopen(path.c_str(), "rb");
+    if (!file_) {
+        last_error_ = "cannot open " + path + ": " + std::strerror(errno);
+        return false;
+    }
+    if (std::fread(&header_, sizeof(header_), 1, file_) != 1 || std::memcmp(header_.magic, "ENVTRACE", 8) != 0) {
+        last_error_ = path + " is not an environet trace file";
+        return false;
+    }
+    if (header_.version != kTraceVersion || header_.record_size != sizeof(TraceRecord)) {
+        last_error_ = "unsupported trace version " + std::to_string(header_.version) +
+                      " (record size " + std::to_string(header_.record_size) + ")";
+        return false;
+    }
+    return true;
+}
+
+bool TraceReader::next(TraceRecord& record) {
+    return file_ && std::fread(&record, sizeof(record), 1, file_) == 1;
+}
+
+uint64_t TraceReader::to_realtime_ns(uint64_t ticks) const {
+    double delta_ns = (static_cast<double>(ticks) - static_cast<double>(header_.base_ticks)) *
+                      header_.seconds_per_tick * 1e9;
+    return static_cast<uint64_t>(static_cast<double>(header_.base_realtime_ns) + delta_ns);
+}
+
+const char* trace_event_name(uint8_t type) {
+    switch (static_cast<TraceEventType>(type)) {
+        case TraceEventType::Packet: return "packet";
+        case TraceEventType::Sensor: return "sensor";
+        case TraceEventType::Bss: return "bss";
+        case TraceEventType::Finding: return "finding";
+    }
+    return "unknown";
+}
+
+static std::string mac_string(const uint8_t* mac) {
+    char buf[18];
+    std::snprintf(buf, sizeof(buf), "%02x:%02x:%02x:%02x:%02x:%02x", mac[0], mac[1], mac[2], mac[3], mac[4], mac[5]);
+    return buf;
+}
+
+static std::string bounded_string(const char* s, size_t max) {
+    return std::string(s, strnlen(s, max));
+}
+
+nlohmann::json trace_record_to_json(const TraceRecord& r, uint64_t realtime_ns) {
+    nlohmann::json j;
+    j["type"] = trace_event_name(r.type);
+    j["ts_ns"] = realtime_ns;
+    j["thread"] = r.thread;
+    j["seq"] = r.seq;
+    switch (static_cast<TraceEventType>(r.type)) {
+        case TraceEventType::Packet: {
+            const auto& p = r.packet;
+            j["length"] = p.length;
+            j["ethertype"] = p.ethertype;
+            j["protocol"] = p.protocol;
+            j["src_mac"] = mac_string(p.src_mac);
+            j["dst_mac"] = mac_string(p.dst_mac);
+            if (p.ip_version == 4 || p.ip_version == 6) {
+                int af = p.ip_version == 4 ? AF_INET : AF_INET6;
+                char buf[INET6_ADDRSTRLEN];
+                j["src_ip"] = inet_ntop(af, p.src_ip, buf, sizeof(buf)) ? buf : "";
+                j["dst_ip"] = inet_ntop(af, p.dst_ip, buf, sizeof(buf)) ? buf : "";
+                j["src_port"] = p.src_port;
+                j["dst_port"] = p.dst_port;
+            }
+            if (p.signal_dbm != 0) j["signal_dbm"] = p.signal_dbm;
+            break;
+        }
+        case TraceEventType::Sensor:
+            j["sensor_ts_ms"] = r.sensor.ts_ms;
+            j["ir_raw"] = r.sensor.ir_raw;
+            j["ultra_mm"] = r.sensor.ultra_mm;
+            j["status"] = r.sensor.status;
+            break;
+        case TraceEventType::Bss:
+            j["bssid"] = mac_string(r.bss.bssid);
+            j["ssid"] = bounded_string(r.bss.ssid, sizeof(r.bss.ssid));
+            j["signal_dbm"] = r.bss.signal_mbm / 100.0;
+            j["freq"] = r.bss.freq;
+            j["channel"] = r.bss.channel;
+            j["connected"] = r.bss.connected != 0;
+            break;
+        case TraceEventType::Finding:
+            j["event_type"] = bounded_string(r.finding.event_type, sizeof(r.finding.event_type));
+            j["ir_raw_delta"] = r.finding.ir_raw_delta;
+            j["ultra_distance_delta"] = r.finding.ultra_distance_delta;
+            j["rssi_avg"] = r.finding.rssi_avg;
+            j["rssi_delta"] = r.finding.rssi_delta;
+            j["ping_latency_delta"] = r.finding.ping_latency_delta;
+            j["throughput_delta"] = r.finding.throughput_delta;
+            j["sensor_status"] = r.finding.sensor_status;
+            break;
+    }
+    return j;
+}
+
+} // namespace core
+} // namespace environet
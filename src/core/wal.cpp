@@ -0,0 +1,587 @@
+#include "core/wal.hpp"
+#include "core/log.hpp"
+
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cinttypes>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fcntl.h>
+#include <random>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <vector>
+#include <zlib.h>
+
+namespace environet {
+namespace core {
+
+namespace {
+constexpr size_t READ_CHUNK = 1024 * 1024;
+constexpr const char* SEGMENT_SUFFIX = ".wal";
+constexpr const char* EPOCH_FILE = "epoch";
+
+void put_le(char* out, uint64_t value, size_t bytes) {
+    for (size_t i = 0; i < bytes; ++i) out[i] = static_cast<char>(value >> (8 * i));
+}
+
+uint64_t get_le(const char* in, size_t bytes) {
+    uint64_t value = 0;
+    for (size_t i = 0; i < bytes; ++i) value |= static_cast<uint64_t>(static_cast<uint8_t>(in[i])) << (8 * i);
+    return value;
+}
+
+uint32_t record_crc(const char* lsn_le, const char* payload, size_t len) {
+    uLong crc = crc32(0L, reinterpret_cast<const Bytef*>(lsn_le), 8);
+    // zlib takes uInt lengths; records are capped well below 4 GB
+    return static_cast<uint32_t>(crc32(crc, reinterpret_cast<const Bytef*>(payload), static_cast<uInt>(len)));
+}
+
+std::string segment_path(const std::string& dir, uint64_t first_lsn) {
+    char name[32];
+    std::snprintf(name, sizeof(name), "%020" PRIu64 "%s", first_lsn, SEGMENT_SUFFIX);
+    return dir + "/" + name;
+}
+
+bool sync_dir(const std::string& dir) {
+    int fd = ::open(dir.c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+    if (fd < 0) return false;
+    bool ok = ::fsync(fd) == 0;
+    ::close(fd);
+    return ok;
+}
+
+bool write_all(int fd, const std::string& data) {
+    size_t done = 0;
+    while (done < data.size()) {
+        ssize_t n = ::write(fd, data.data() + done, data.size() - done);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            return false;
+        }
+        done += static_cast<size_t>(n);
+    }
+    return true;
+}
+
+/**
+ * @brief Buffered sequential record reader over one segment file
+ */
+class SegmentReader {
+public:
+    SegmentReader(int fd, uint64_t offset) : fd_(fd), offset_(offset) {}
+
+    // Parses the next record; false at end of file, on a torn record or a bad CRC
+    bool next(uint64_t& lsn, const char*& payload, size_t& len, bool& corrupt) {
+        corrupt = false;
+        const char* header = peek(WriteAheadLog::RECORD_HEADER_SIZE);
+        if (!header) {
+            corrupt = pos_ != end_;
+            return false;
+        }
+        len = get_le(header, 4);
+        if (len > WriteAheadLog::MAX_RECORD_SIZE) {
+            corrupt = true;
+            return false;
+        }
+        const char* record = peek(WriteAheadLog::RECORD_HEADER_SIZE + len);
+        if (!record) {
+            corrupt = true;
+            return false;
+        }
+        uint32_t crc = static_cast<uint32_t>(get_le(record + 4, 4));
+        payload = record + WriteAheadLog::RECORD_HEADER_SIZE;
+        if (record_crc(record + 8, payload, len) != crc) {
+            corrupt = true;
+            return false;
+        }
+        lsn = get_le(record + 8, 8);
+        pos_ += WriteAheadLog::RECORD_HEADER_SIZE + len;
+        return true;
+    }
+
+    // File offset of the next unparsed record
+    uint64_t offset() const { return offset_ - (end_ - pos_); }
+
+    bool failed() const { return failed_; }
+
+private:
+    const char* peek(size_t n) {
+        if (end_ - pos_ >= n) return buf_.data() + pos_;
+        if (pos_ > 0) {
+            std::memmove(buf_.data(), buf_.data() + pos_, end_ - pos_);
+            end_ -= pos_;
+            pos_ = 0;
+        }
+        size_t want = std::max(n, READ_CHUNK);
+        if (buf_.size() < want) buf_.resize(want);
+        while (end_ < n) {
+            ssize_t got = ::pread(fd_, buf_.data() + end_, buf_.size() - end_, static_cast<off_t>(offset_));
+            if (got < 0 && errno == EINTR) continue;
+            if (got <= 0) {
+                failed_ = got < 0;
+                return nullptr;
+            }
+            end_ += static_cast<size_t>(got);
+            offset_ += static_cast<uint64_t>(got);
+        }
+        return buf_.data();
+    }
+
+    int fd_;
+    uint64_t offset_;               // File offset of buf_[end_]
+    std::vector<char> buf_;
+    size_t pos_ = 0;
+    size_t end_ = 0;
+    bool failed_ = false;
+};
+} // namespace
+
+WriteAheadLog::WriteAheadLog(std::string dir, size_t segment_bytes, size_t max_bytes)
+    : dir_(std::move(dir)), segment_bytes_(std::max<size_t>(segment_bytes, 4096)),
+      max_bytes_(std::max(max_bytes, segment_bytes_)) {}
+
+WriteAheadLog::~WriteAheadLog() {
+    close();
+}
+
+bool WriteAheadLog::open() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (fd_ >= 0) return true;
+
+    auto start = std::chrono::steady_clock::now();
+    std::error_code ec;
+    std::filesystem::create_directories(dir_, ec);
+    if (ec) {
+        set_error("cannot create " + dir_ + ": " + ec.message());
+        return false;
+    }
+
+    std::vector<Segment> found;
+    for (const auto& entry : std::filesystem::directory_iterator(dir_, ec)) {
+        const std::string name = entry.path().filename().string();
+        if (name.size() != 20 + std::strlen(SEGMENT_SUFFIX) ||
+            name.compare(20, std::string::npos, SEGMENT_SUFFIX) != 0 ||
+            !std::all_of(name.begin(), name.begin() + 20, [](char c) { return c >= '0' && c <= '9'; })) {
+            continue;
+        }
+        uint64_t first = std::strtoull(name.c_str(), nullptr, 10);
+        if (first == 0) continue;
+        found.push_back({first, first - 1, 0, entry.path().string()});
+    }
+    if (ec) {
+        set_error("cannot list " + dir_ + ": " + ec.message());
+        return false;
+    }
+    std::sort(found.begin(), found.end(),
+              [](const Segment& a, const Segment& b) { return a.first_lsn < b.first_lsn; });
+
+    segments_.clear();
+    total_bytes_ = 0;
+    for (size_t i = 0; i < found.size(); ++i) {
+        Segment& seg = found[i];
+        bool newest = i + 1 == found.size();
+        if (!segments_.empty() && seg.first_lsn <= segments_.back().last_lsn) {
+            LOGW("WAL: {} overlaps the previous segment, removing it", seg.path);
+            ++corrupt_records_;
+            std::filesystem::remove(seg.path, ec);
+            continue;
+        }
+        if (!recover_segment(seg, newest)) return false;
+        if (!newest && seg.last_lsn < seg.first_lsn) {
+            std::filesystem::remove(seg.path, ec);
+            continue;
+        }
+        recovered_records_ += seg.last_lsn + 1 - seg.first_lsn;
+        recovered_bytes_ += seg.bytes;
+        total_bytes_ += seg.bytes;
+        segments_.push_back(seg);
+    }
+
+    // No segments: LSNs start over, and so does the epoch
+    if (!load_epoch(segments_.empty())) return false;
+    if (segments_.empty()) {
+        std::string path;
+        int fd = create_segment(next_lsn_, path);
+        if (fd < 0) return false;
+        segments_.push_back({next_lsn_, next_lsn_ - 1, 0, path});
+        fd_ = fd;
+    } else {
+        const Segment& last = segments_.back();
+        fd_ = ::open(last.path.c_str(), O_WRONLY | O_APPEND | O_CLOEXEC);
+        if (fd_ < 0) {
+            set_error("cannot open " + last.path + ": " + std::strerror(errno));
+            return false;
+        }
+        next_lsn_ = last.last_lsn + 1;
+    }
+    synced_lsn_ = next_lsn_ - 1;
+    released_lsn_ = segments_.front().first_lsn - 1;
+    hint_lsn_ = 0;
+    drop_segments();
+
+    recovery_ms_ = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    if (recovered_records_ > 0) {
+        LOGI("WAL: recovered {} records ({} bytes, {} segments) from {} in {:.1f} ms", recovered_records_,
+             recovered_bytes_, segments_.size(), dir_, recovery_ms_);
+    }
+    return true;
+}
+
+bool WriteAheadLog::recover_segment(Segment& seg, bool newest) {
+    int fd = ::open(seg.path.c_str(), (newest ? O_RDWR : O_RDONLY) | O_CLOEXEC);
+    if (fd < 0) {
+        set_error("cannot open " + seg.path + ": " + std::strerror(errno));
+        return false;
+    }
+    struct stat st{};
+    ::fstat(fd, &st);
+
+    SegmentReader reader(fd, 0);
+    uint64_t lsn = 0;
+    const char* payload = nullptr;
+    size_t len = 0;
+    bool corrupt = false;
+    uint64_t valid = 0;
+    while (reader.next(lsn, payload, len, corrupt)) {
+        if (lsn != seg.last_lsn + 1) {
+            corrupt = true;
+            break;
+        }
+        seg.last_lsn = lsn;
+        valid = reader.offset();
+    }
+    if (reader.failed()) {
+        set_error("cannot read " + seg.path + ": " + std::strerror(errno));
+        ::close(fd);
+        return false;
+    }
+
+    seg.bytes = static_cast<uint64_t>(st.st_size);
+    if (corrupt) {
+        ++corrupt_records_;
+        if (newest) {
+            LOGW("WAL: truncating {} at byte {} of {} (torn or corrupt record)", seg.path, valid, st.st_size);
+            if (::ftruncate(fd, static_cast<off_t>(valid)) != 0 || ::fdatasync(fd) != 0) {
+                set_error("cannot truncate " + seg.path + ": " + std::strerror(errno));
+                ::close(fd);
+                return false;
+            }
+            seg.bytes = valid;
+        } else {
+            LOGW("WAL: ignoring {} bytes after byte {} of {} (corrupt record)", st.st_size - valid, valid, seg.path);
+        }
+    }
+    ::close(fd);
+    return true;
+}
+
+int WriteAheadLog::create_segment(uint64_t first_lsn, std::string& path) {
+    path = segment_path(dir_, first_lsn);
+    int fd = ::open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_APPEND | O_CLOEXEC, 0644);
+    if (fd < 0) {
+        set_error("cannot create " + path + ": " + std::strerror(errno));
+        return -1;
+    }
+    // The newest segment carries next_lsn across restarts, so its name must be durable
+    if (!sync_dir(dir_)) {
+        set_error("cannot sync " + dir_ + ": " + std::strerror(errno));
+        ::close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+bool WriteAheadLog::load_epoch(bool fresh) {
+    const std::string path = dir_ + "/" + EPOCH_FILE;
+    if (!fresh) {
+        if (FILE* f = std::fopen(path.c_str(), "r")) {
+            uint64_t epoch = 0;
+            bool ok = std::fscanf(f, "%" SCNx64, &epoch) == 1;
+            std::fclose(f);
+            if (ok && epoch != 0) {
+                epoch_ = epoch;
+                return true;
+            }
+        }
+        LOGW("WAL: {} is missing or unreadable, starting a new epoch", path);
+    }
+    std::random_device rd;
+    uint64_t epoch = 0;
+    while (epoch == 0) epoch = static_cast<uint64_t>(rd()) << 32 | rd();
+
+    // Written aside and renamed, so a crash leaves the old epoch or the new one
+    char text[24];
+    std::snprintf(text, sizeof(text), "%016" PRIx64 "\n", epoch);
+    const std::string tmp = path + ".tmp";
+    int fd = ::open(tmp.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    bool ok = fd >= 0 && write_all(fd, text) && ::fsync(fd) == 0;
+    if (fd >= 0) ::close(fd);
+    if (!ok || ::rename(tmp.c_str(), path.c_str()) != 0 || !sync_dir(dir_)) {
+        set_error("cannot write " + path + ": " + std::strerror(errno));
+        return false;
+    }
+    epoch_ = epoch;
+    return true;
+}
+
+void WriteAheadLog::close() {
+    sync();
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (fd_ >= 0) {
+        ::close(fd_);
+        fd_ = -1;
+    }
+}
+
+uint64_t WriteAheadLog::append(std::string_view payload) {
+    if (payload.size() > MAX_RECORD_SIZE) {
+        set_error("WAL record of " + std::to_string(payload.size()) + " bytes exceeds the limit");
+        return 0;
+    }
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (fd_ < 0) return 0;
+    uint64_t lsn = next_lsn_++;
+    char header[RECORD_HEADER_SIZE];
+    put_le(header, payload.size(), 4);
+    put_le(header + 8, lsn, 8);
+    put_le(header + 4, record_crc(header + 8, payload.data(), payload.size()), 4);
+    buffer_.append(header, sizeof(header));
+    buffer_.append(payload.data(), payload.size());
+    ++buffered_records_;
+    ++records_appended_;
+    bytes_appended_ += payload.size();
+    return lsn;
+}
+
+bool WriteAheadLog::sync() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    const uint64_t target = next_lsn_ - 1;
+    for (;;) {
+        if (synced_lsn_ >= target) return true;
+        if (fd_ < 0) return false;
+        if (!syncing_) break;
+        synced_cv_.wait(lock);
+    }
+
+    // Leader: write everything buffered so far with one fdatasync
+    std::string data;
+    data.swap(buffer_);
+    const uint64_t records = buffered_records_;
+    const uint64_t first = synced_lsn_ + 1;
+    const uint64_t last = next_lsn_ - 1;
+    buffered_records_ = 0;
+    const Segment& current = segments_.back();
+    const bool rotate = current.bytes >= segment_bytes_ && current.last_lsn >= current.first_lsn;
+    const uint64_t offset = rotate ? 0 : current.bytes;
+    int fd = fd_;
+    syncing_ = true;
+    lock.unlock();
+
+    std::string new_path;
+    bool ok = true;
+    if (rotate) {
+        fd = create_segment(first, new_path);
+        ok = fd >= 0;
+    }
+    if (ok && (!write_all(fd, data) || ::fdatasync(fd) != 0)) {
+        set_error("WAL write failed: " + std::string(std::strerror(errno)));
+        // Drop the partial write so the records can be retried
+        if (::ftruncate(fd, static_cast<off_t>(offset)) != 0) {
+            LOGW_RATELIMITED(60000, "WAL: cannot truncate after failed write: {}", std::strerror(errno));
+        }
+        ok = false;
+    }
+
+    lock.lock();
+    syncing_ = false;
+    if (ok) {
+        if (rotate) {
+            ::close(fd_);
+            fd_ = fd;
+            segments_.push_back({first, first - 1, 0, new_path});
+        }
+        Segment& seg = segments_.back();
+        seg.last_lsn = last;
+        seg.bytes += data.size();
+        total_bytes_ += data.size();
+        synced_lsn_ = last;
+        ++syncs_;
+        records_synced_ += records;
+        drop_segments();
+    } else {
+        if (rotate && fd >= 0) {
+            ::close(fd);
+            ::unlink(new_path.c_str());
+        }
+        buffer_.insert(0, data);
+        buffered_records_ += records;
+    }
+    synced_cv_.notify_all();
+    return ok;
+}
+
+size_t WriteAheadLog::read(uint64_t from_lsn, size_t max_records, size_t max_bytes,
+                           const std::function<void(uint64_t, std::string_view)>& fn) {
+    size_t count = 0;
+    size_t bytes = 0;
+    uint64_t expected = 0;
+    while (count < max_records) {
+        // Locate the segment holding from_lsn and snapshot what is readable
+        std::string path;
+        uint64_t segment_first = 0;
+        uint64_t limit = 0;
+        uint64_t offset = 0;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            auto it = std::find_if(segments_.begin(), segments_.end(),
+                                   [&](const Segment& s) { return s.last_lsn >= from_lsn && s.last_lsn >= s.first_lsn; });
+            if (it == segments_.end()) break;
+            if (from_lsn < it->first_lsn) {
+                if (expected != 0) break;       // Gap: leave it for the next call
+                from_lsn = it->first_lsn;
+            }
+            path = it->path;
+            segment_first = it->first_lsn;
+            limit = std::min(it->last_lsn, synced_lsn_);
+            if (hint_lsn_ != 0 && hint_segment_ == segment_first && hint_lsn_ <= from_lsn) {
+                offset = hint_offset_;
+            }
+        }
+        if (from_lsn > limit) break;
+
+        int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+        if (fd < 0) {
+            // Evicted since the lookup; the next pass finds the following segment
+            if (errno == ENOENT && expected == 0) continue;
+            break;
+        }
+        SegmentReader reader(fd, offset);
+        uint64_t lsn = 0;
+        const char* payload = nullptr;
+        size_t len = 0;
+        bool corrupt = false;
+        uint64_t resume = offset;
+        bool stopped = false;
+        while (count < max_records && reader.next(lsn, payload, len, corrupt)) {
+            if (lsn > limit) break;
+            if (lsn >= from_lsn) {
+                if (count > 0 && bytes + len > max_bytes) {
+                    stopped = true;
+                    break;
+                }
+                fn(lsn, std::string_view(payload, len));
+                ++count;
+                bytes += len;
+                expected = lsn + 1;
+            }
+            resume = reader.offset();
+        }
+        ::close(fd);
+        if (corrupt) set_error("WAL: corrupt record in " + path);
+
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            hint_lsn_ = expected != 0 ? expected : from_lsn;
+            hint_segment_ = segment_first;
+            hint_offset_ = resume;
+        }
+        if (stopped || corrupt || expected == 0 || expected <= limit) break;
+        from_lsn = expected;
+    }
+    return count;
+}
+
+void WriteAheadLog::release(uint64_t lsn) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    released_lsn_ = std::max(released_lsn_, std::min(lsn, synced_lsn_));
+    drop_segments();
+}
+
+void WriteAheadLog::drop_segments() {
+    std::error_code ec;
+    bool warned = false;
+    while (segments_.size() > 1) {
+        const Segment& oldest = segments_.front();
+        bool released = oldest.last_lsn <= released_lsn_;
+        if (!released && total_bytes_ <= max_bytes_) break;
+        if (!released) {
+            uint64_t lost = oldest.last_lsn - std::max(oldest.first_lsn - 1, released_lsn_);
+            records_evicted_ += lost;
+            ++segments_evicted_;
+            if (!warned) {
+                LOGW_RATELIMITED(60000, "WAL: {} over {} bytes, dropping {} unreleased records", dir_, max_bytes_, lost);
+                warned = true;
+            }
+            released_lsn_ = oldest.last_lsn;
+        }
+        std::filesystem::remove(oldest.path, ec);
+        total_bytes_ -= oldest.bytes;
+        segments_.pop_front();
+    }
+}
+
+uint64_t WriteAheadLog::first_lsn() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return segments_.empty() ? next_lsn_ : std::min(segments_.front().first_lsn, next_lsn_);
+}
+
+uint64_t WriteAheadLog::next_lsn() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return next_lsn_;
+}
+
+uint64_t WriteAheadLog::epoch() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return epoch_;
+}
+
+uint64_t WriteAheadLog::synced_lsn() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return synced_lsn_;
+}
+
+uint64_t WriteAheadLog::size_bytes() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return total_bytes_;
+}
+
+nlohmann::json WriteAheadLog::get_stats() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    nlohmann::json j;
+    j["dir"] = dir_;
+    j["segments"] = segments_.size();
+    j["bytes"] = total_bytes_;
+    j["max_bytes"] = max_bytes_;
+    j["first_lsn"] = segments_.empty() ? next_lsn_ : segments_.front().first_lsn;
+    j["next_lsn"] = next_lsn_;
+    j["epoch"] = epoch_;
+    j["synced_lsn"] = synced_lsn_;
+    j["released_lsn"] = released_lsn_;
+    j["records_appended"] = records_appended_;
+    j["bytes_appended"] = bytes_appended_;
+    j["syncs"] = syncs_;
+    j["records_per_sync"] = syncs_ > 0 ? static_cast<double>(records_synced_) / syncs_ : 0.0;
+    j["records_evicted"] = records_evicted_;
+    j["segments_evicted"] = segments_evicted_;
+    j["corrupt_records"] = corrupt_records_;
+    j["recovered_records"] = recovered_records_;
+    j["recovered_bytes"] = recovered_bytes_;
+    j["recovery_ms"] = recovery_ms_;
+    return j;
+}
+
+std::string WriteAheadLog::get_last_error() const {
+    std::lock_guard<std::mutex> lock(error_mutex_);
+    return last_error_;
+}
+
+void WriteAheadLog::set_error(const std::string& error) {
+    std::lock_guard<std::mutex> lock(error_mutex_);
+    last_error_ = error;
+}
+
+} // namespace core
+} // namespace environet
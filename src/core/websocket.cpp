@@ -0,0 +1,134 @@
+#include "core/websocket.hpp"
+
+#include <algorithm>
+#include <cctype>
+#include <cstring>
+
+namespace environet {
+namespace core {
+
+namespace {
+
+const char WS_GUID[] = "258EAFA5-E914-47DA-95CA-C5AB0DC85B11";
+
+uint32_t rotl(uint32_t v, int n) { return (v << n) | (v >> (32 - n)); }
+
+// SHA-1 (FIPS 180-4); only used for the handshake
+void sha1(const std::string& msg, uint8_t digest[20]) {
+    uint32_t h[5] = {0x67452301, 0xEFCDAB89, 0x98BADCFE, 0x10325476, 0xC3D2E1F0};
+    std::string data = msg;
+    uint64_t bits = static_cast<uint64_t>(msg.size()) * 8;
+    data += static_cast<char>(0x80);
+    while (data.size() % 64 != 56) data += '\0';
+    for (int i = 7; i >= 0; --i) data += static_cast<char>(bits >> (i * 8));
+
+    for (size_t block = 0; block < data.size(); block += 64) {
+        uint32_t w[80];
+        for (int i = 0; i < 16; ++i) {
+            const auto* p = reinterpret_cast<const uint8_t*>(data.data() + block + i * 4);
+            w[i] = (uint32_t{p[0]} << 24) | (uint32_t{p[1]} << 16) | (uint32_t{p[2]} << 8) | p[3];
+        }
+        for (int i = 16; i < 80; ++i) w[i] = rotl(w[i - 3] ^ w[i - 8] ^ w[i - 14] ^ w[i - 16], 1);
+        uint32_t a = h[0], b = h[1], c = h[2], d = h[3], e = h[4];
+        for (int i = 0; i < 80; ++i) {
+            uint32_t f, k;
+            if (i < 20) { f = (b & c) | (~b & d); k = 0x5A827999; }
+            else if (i < 40) { f = b ^ c ^ d; k = 0x6ED9EBA1; }
+            else if (i < 60) { f = (b & c) | (b & d) | (c & d); k = 0x8F1BBCDC; }
+            else { f = b ^ c ^ d; k = 0xCA62C1D6; }
+            uint32_t t = rotl(a, 5) + f + e + k + w[i];
+            e = d;
+            d = c;
+            c = rotl(b, 30);
+            b = a;
+            a = t;
+        }
+        h[0] += a; h[1] += b; h[2] += c; h[3] += d; h[4] += e;
+    }
+    for (int i = 0; i < 5; ++i) {
+        for (int j = 0; j < 4; ++j) digest[i * 4 + j] = static_cast<uint8_t>(h[i] >> (24 - j * 8));
+    }
+}
+
+std::string base64(const uint8_t* data, size_t len) {
+    static const char table[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+    std::string out;
+    for (size_t i = 0; i < len; i += 3) {
+        uint32_t v = uint32_t{data[i]} << 16;
+        if (i + 1 < len) v |= uint32_t{data[i + 1]} << 8;
+        if (i + 2 < len) v |= data[i + 2];
+        out += table[(v >> 18) & 0x3F];
+        out += table[(v >> 12) & 0x3F];
+        out += i + 1 < len ? table[(v >> 6) & 0x3F] : '=';
+        out += i + 2 < len ? table[v & 0x3F] : '=';
+    }
+    return out;
+}
+
+bool header_has_token(const HttpRequest& req, const char* name, const char* token) {
+    auto it = req.headers.find(name);
+    if (it == req.headers.end()) return false;
+    std::string value = it->second;
+    std::transform(value.begin(), value.end(), value.begin(), [](unsigned char c) { return std::tolower(c); });
+    return value.find(token) != std::string::npos;
+}
+
+} // namespace
+
+bool is_websocket_upgrade(const HttpRequest& req) {
+    auto version = req.headers.find("sec-websocket-version");
+    return header_has_token(req, "upgrade", "websocket") && header_has_token(req, "connection", "upgrade") &&
+           req.headers.count("sec-websocket-key") && version != req.headers.end() && version->second == "13";
+}
+
+std::string websocket_accept(const std::string& key) {
+    uint8_t digest[20];
+    sha1(key + WS_GUID, digest);
+    return base64(digest, sizeof(digest));
+}
+
+void append_websocket_frame(std::string& out, WsOpcode opcode, const void* data, size_t len) {
+    out += static_cast<char>(0x80 | static_cast<uint8_t>(opcode));
+    if (len < 126) {
+        out += static_cast<char>(len);
+    } else if (len <= 0xFFFF) {
+        out += static_cast<char>(126);
+        out += static_cast<char>(len >> 8);
+        out += static_cast<char>(len);
+    } else {
+        out += static_cast<char>(127);
+        for (int i = 7; i >= 0; --i) out += static_cast<char>(static_cast<uint64_t>(len) >> (i * 8));
+    }
+    out.append(static_cast<const char*>(data), len);
+}
+
+int take_websocket_frame(std::string& in, WsFrame& frame, size_t max_payload) {
+    if (in.size() < 2) return 0;
+    const auto* p = reinterpret_cast<const uint8_t*>(in.data());
+    if (!(p[1] & 0x80)) return -1;                          // Clients must mask
+    uint64_t len = p[1] & 0x7F;
+    size_t pos = 2;
+    if (len == 126) {
+        if (in.size() < 4) return 0;
+        len = (uint64_t{p[2]} << 8) | p[3];
+        pos = 4;
+    } else if (len == 127) {
+        if (in.size() < 10) return 0;
+        len = 0;
+        for (int i = 0; i < 8; ++i) len = (len << 8) | p[2 + i];
+        pos = 10;
+    }
+    if (len > max_payload) return -1;
+    if (in.size() < pos + 4 + len) return 0;
+    const uint8_t* mask = p + pos;
+    pos += 4;
+    frame.fin = p[0] & 0x80;
+    frame.opcode = static_cast<WsOpcode>(p[0] & 0x0F);
+    frame.payload.resize(len);
+    for (size_t i = 0; i < len; ++i) frame.payload[i] = static_cast<char>(p[pos + i] ^ mask[i & 3]);
+    in.erase(0, pos + len);
+    return 1;
+}
+
+} // namespace core
+} // namespace environet
@@ -0,0 +1,84 @@
+#include "core/worker_pool.hpp"
+#include "core/log.hpp"
+#include "core/timeline.hpp"
+
+namespace environet {
+namespace core {
+
+WorkerPool::~WorkerPool() { stop(); }
+
+bool WorkerPool::start(size_t threads, const std::string& name, ThreadHook on_thread_start) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (running_ || threads == 0) return false;
+    name_ = name;
+    on_thread_start_ = std::move(on_thread_start);
+    running_ = true;
+    for (size_t i = 0; i < threads; ++i) {
+        workers_.emplace_back([this, i]() { worker_loop(i); });
+    }
+    return true;
+}
+
+bool WorkerPool::submit(Job job) {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (!running_) return false;
+        queue_.push_back(std::move(job));
+    }
+    cv_.notify_one();
+    return true;
+}
+
+void WorkerPool::stop() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (!running_) return;
+        running_ = false;
+        dropped_.fetch_add(queue_.size(), std::memory_order_relaxed);
+        queue_.clear();
+    }
+    cv_.notify_all();
+    for (auto& worker : workers_) {
+        if (worker.joinable()) worker.join();
+    }
+    workers_.clear();
+}
+
+void WorkerPool::worker_loop(size_t index) {
+    Timeline::instance().set_thread_name(name_ + "-" + std::to_string(index));
+    if (on_thread_start_) on_thread_start_();
+    for (;;) {
+        Job job;
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            cv_.wait(lock, [this]() { return !running_ || !queue_.empty(); });
+            if (!running_) return;
+            job = std::move(queue_.front());
+            queue_.pop_front();
+        }
+        active_.fetch_add(1, std::memory_order_relaxed);
+        try {
+            job();
+        } catch (const std::exception& e) {
+            LOGW("{} job failed: {}", name_, e.what());
+        }
+        active_.fetch_sub(1, std::memory_order_relaxed);
+        completed_.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+nlohmann::json WorkerPool::get_stats() const {
+    nlohmann::json j;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        j["threads"] = workers_.size();
+        j["queued"] = queue_.size();
+    }
+    j["active"] = active_.load();
+    j["completed"] = completed_.load();
+    j["dropped"] = dropped_.load();
+    return j;
+}
+
+} // namespace core
+} // namespace environet
@@ -1,13 +1,326 @@
 #include "correlate/correlator.hpp"
+#include "correlate/live_feed.hpp"
 #include "core/log.hpp"
+#include "core/latency.hpp"
+#include "core/timeline.hpp"
+#include "core/trace_log.hpp"
 
+#include <algorithm>
 #include <chrono>
+#include <cmath>
+#include <cstring>
+#include <iterator>
+#include <string_view>
 
 namespace environet { namespace correlate {
 
-Correlator::Correlator(const std::string& /*config_path*/)
-    : sensor_threshold_(200), correlation_window_ms_(5000), findings_dir_("findings"),
-      sensor_events_(0), network_events_(0), correlations_found_(0), start_time_ms_(0) {}
+namespace {
+
+constexpr size_t MAX_FINDINGS = 256;        // Findings kept for get_findings()
+constexpr double AFFECTED_RSSI_DB = 3.0;    // Per-network RSSI shift that counts as affected
+constexpr double AFFECTED_VOLUME_RATIO = 0.5; // Per-host traffic change (of the larger side) that counts as affected
+constexpr uint64_t AFFECTED_HOST_BYTES = 4096; // Ignore hosts below this volume on both sides
+
+// Per-network RSSI before and after a sensor event (scratch, tick arena)
+struct NetworkShift {
+    std::string_view bssid;
+    std::string_view ssid;
+    double before_sum = 0.0;
+    double after_sum = 0.0;
+    size_t before_n = 0;
+    size_t after_n = 0;
+};
+
+// Mean of a field over the samples before and after ts within +-window
+template <typename Point, typename Field>
+double mean_shift(const std::vector<Point>& buffer, uint64_t start, uint64_t ts, uint64_t end, Field field) {
+    double before = 0.0, after = 0.0;
+    size_t nb = 0, na = 0;
+    for (const auto& p : buffer) {
+        if (p.timestamp_ms < start || p.timestamp_ms > end) continue;
+        if (p.timestamp_ms < ts) { before += field(p.value); ++nb; }
+        else { after += field(p.value); ++na; }
+    }
+    return nb && na ? after / na - before / nb : 0.0;
+}
+
+// Passive throughput over samples stamped in [lo, hi): bytes over the time the buckets cover
+struct PassiveRate {
+    uint64_t bytes[3] = {};
+    uint64_t first = UINT64_MAX, last = 0;
+    uint32_t interval_ms = 0;
+
+    void add(const net::ThroughputSample& s) { add(s.timestamp_ms, s.interval_ms, s.bytes); }
+    void add(uint64_t ts, uint32_t interval, const uint64_t (&b)[3]) {
+        for (size_t d = 0; d < 3; ++d) bytes[d] += b[d];
+        first = std::min(first, ts);
+        last = std::max(last, ts);
+        interval_ms = interval;
+    }
+    bool empty() const { return first == UINT64_MAX; }
+    double mbps(size_t direction) const {
+        return empty() ? 0.0 : bytes[direction] * 8.0 / ((last - first + interval_ms) * 1000.0);
+    }
+    double total_mbps() const { return mbps(0) + mbps(1) + mbps(2); }
+};
+
+template <typename Point>
+PassiveRate passive_rate(const std::vector<Point>& buffer, uint64_t lo, uint64_t hi) {
+    PassiveRate rate;
+    for (const auto& p : buffer) {
+        if (p.timestamp_ms >= lo && p.timestamp_ms < hi) rate.add(p.value);
+    }
+    return rate;
+}
+
+// DNS counts over samples stamped in [lo, hi)
+struct DnsTotals {
+    uint64_t queries = 0, responses = 0, nxdomain = 0, servfail = 0, timeouts = 0;
+    uint64_t latency_sum_us = 0, latency_max_us = 0;
+
+    double avg_latency_ms() const { return responses ? latency_sum_us / 1000.0 / responses : 0.0; }
+    double failure_pct() const { return queries ? 100.0 * (servfail + timeouts) / queries : 0.0; }
+};
+
+template <typename Point>
+DnsTotals dns_totals(const std::vector<Point>& buffer, uint64_t lo, uint64_t hi) {
+    DnsTotals t;
+    for (const auto& p : buffer) {
+        if (p.timestamp_ms < lo || p.timestamp_ms >= hi) continue;
+        t.queries += p.value.queries;
+        t.responses += p.value.responses;
+        t.nxdomain += p.value.nxdomain;
+        t.servfail += p.value.servfail;
+        t.timeouts += p.value.timeouts;
+        t.latency_sum_us += p.value.latency_sum_us;
+        t.latency_max_us = std::max(t.latency_max_us, p.value.latency_max_us);
+    }
+    return t;
+}
+
+// Downsampling accumulators: one per step, fed every sample stamped in it
+struct SensorStep {
+    uint64_t n = 0;
+    double ir_sum = 0.0, ultra_sum = 0.0;
+    int ir_min = INT32_MAX, ir_max = INT32_MIN;
+
+    void add(const sensors::SensorFrame& f) {
+        ++n;
+        ir_sum += f.ir_raw;
+        ultra_sum += f.ultra_mm;
+        ir_min = std::min<int>(ir_min, f.ir_raw);
+        ir_max = std::max<int>(ir_max, f.ir_raw);
+    }
+    void write(core::JsonWriter& out, uint64_t) const {
+        out.field("ir_avg", ir_sum / n).field("ir_min", ir_min).field("ir_max", ir_max);
+        out.field("ultra_mm_avg", ultra_sum / n);
+    }
+};
+
+struct RssiStep {
+    uint64_t n = 0;
+    double sum = 0.0, min = 0.0, max = 0.0;
+
+    void add(const net::BssInfo& b) {
+        double dbm = b.signal_mbm / 100.0;
+        min = n ? std::min(min, dbm) : dbm;
+        max = n ? std::max(max, dbm) : dbm;
+        sum += dbm;
+        ++n;
+    }
+    void write(core::JsonWriter& out, uint64_t) const {
+        out.field("rssi_avg", sum / n).field("rssi_min", min).field("rssi_max", max);
+    }
+};
+
+struct PacketStep {
+    uint64_t n = 0, bytes = 0;
+
+    void add(const net::PacketMeta& p) { ++n; bytes += p.length; }
+    void write(core::JsonWriter& out, uint64_t step_ms) const {
+        out.field("bytes", bytes).field("mbps", bytes * 8.0 / (step_ms * 1000.0));
+    }
+};
+
+struct PingStep {
+    uint64_t n = 0, reachable = 0;
+    double rtt_sum = 0.0, loss_sum = 0.0;
+
+    void add(const net::PingStats& p) {
+        ++n;
+        if (p.reachable) { ++reachable; rtt_sum += p.avg_rtt_ms; }
+        loss_sum += p.loss_percentage;
+    }
+    void write(core::JsonWriter& out, uint64_t) const {
+        out.field("avg_rtt_ms", reachable ? rtt_sum / reachable : 0.0).field("loss_pct", loss_sum / n);
+    }
+};
+
+struct ThroughputStep {
+    uint64_t n = 0, bytes[3] = {};
+
+    void add(const net::ThroughputSample& s) {
+        ++n;
+        for (size_t d = 0; d < 3; ++d) bytes[d] += s.bytes[d];
+    }
+    void write(core::JsonWriter& out, uint64_t step_ms) const {
+        double scale = 8.0 / (step_ms * 1000.0);
+        out.field("mbps", (bytes[0] + bytes[1] + bytes[2]) * scale);
+        out.field("rx_mbps", bytes[static_cast<size_t>(net::Direction::Rx)] * scale);
+        out.field("tx_mbps", bytes[static_cast<size_t>(net::Direction::Tx)] * scale);
+    }
+};
+
+struct DnsStep {
+    uint64_t n = 0;
+    DnsTotals t;
+
+    void add(const net::DnsSample& s) {
+        ++n;
+        t.queries += s.queries;
+        t.responses += s.responses;
+        t.nxdomain += s.nxdomain;
+        t.servfail += s.servfail;
+        t.timeouts += s.timeouts;
+        t.latency_sum_us += s.latency_sum_us;
+        t.latency_max_us = std::max(t.latency_max_us, s.latency_max_us);
+    }
+    void write(core::JsonWriter& out, uint64_t) const {
+        out.field("queries", t.queries).field("responses", t.responses);
+        out.field("avg_latency_ms", t.avg_latency_ms()).field("max_latency_ms", t.latency_max_us / 1000.0);
+        out.field("nxdomain", t.nxdomain).field("servfail", t.servfail).field("timeouts", t.timeouts);
+    }
+};
+
+// Window statistics read only these fields, so the copy taken under
+// data_mutex_ holds no strings
+struct BssSignal { int32_t signal_mbm; };
+struct PacketSize { uint32_t length; };
+struct PingRtt { double avg_rtt_ms, loss_percentage; };
+struct InterfaceBytes {
+    size_t interface;                   // Index into WindowSamples::interfaces
+    uint32_t interval_ms;
+    uint64_t bytes[3];
+};
+
+// Copy the samples stamped in [lo, hi], converted to their compact form
+template <typename Point, typename Out, typename Convert>
+void copy_in_range(const std::vector<Point>& buffer, uint64_t lo, uint64_t hi, std::vector<Out>& out,
+                   Convert convert) {
+    for (const auto& p : buffer) {
+        if (p.timestamp_ms >= lo && p.timestamp_ms <= hi) out.emplace_back(p.timestamp_ms, convert(p.value));
+    }
+}
+
+template <typename Point>
+void sort_by_time(std::vector<Point>& points) {
+    std::stable_sort(points.begin(), points.end(),
+                     [](const Point& a, const Point& b) { return a.timestamp_ms < b.timestamp_ms; });
+}
+
+// The samples of a time-sorted copy stamped in [lo, hi]
+template <typename Point>
+struct TimeRange {
+    const Point* first;
+    const Point* last;
+    const Point* begin() const { return first; }
+    const Point* end() const { return last; }
+    size_t size() const { return static_cast<size_t>(last - first); }
+};
+
+template <typename Point>
+TimeRange<Point> in_range(const std::vector<Point>& points, uint64_t lo, uint64_t hi) {
+    auto first = std::lower_bound(points.begin(), points.end(), lo,
+                                  [](const Point& p, uint64_t t) { return p.timestamp_ms < t; });
+    auto last = std::upper_bound(first, points.end(), hi,
+                                 [](uint64_t t, const Point& p) { return t < p.timestamp_ms; });
+    return {points.data() + (first - points.begin()), points.data() + (last - points.begin())};
+}
+
+// Exclusive bound for an inclusive end time, saturating at UINT64_MAX
+uint64_t exclusive_end(uint64_t end_time) { return end_time == UINT64_MAX ? end_time : end_time + 1; }
+
+} // namespace
+
+struct Correlator::WindowSamples {
+    std::vector<TimeSeriesPoint<sensors::SensorFrame>> sensor;
+    std::vector<TimeSeriesPoint<BssSignal>> bss;
+    std::vector<TimeSeriesPoint<PacketSize>> packet;
+    std::vector<TimeSeriesPoint<PingRtt>> ping;
+    std::vector<TimeSeriesPoint<InterfaceBytes>> throughput;
+    std::vector<TimeSeriesPoint<net::DnsSample>> dns;
+    std::vector<std::string> interfaces;
+};
+
+namespace {
+
+// One pass over a buffer (which need not be sorted) into per-step accumulators
+template <typename Step, typename Point>
+void write_downsampled(core::JsonWriter& out, const std::vector<Point>& buffer, uint64_t start, uint64_t end,
+                       uint64_t step_ms) {
+    const uint64_t span = end - start;
+    std::vector<Step> steps(static_cast<size_t>(span / step_ms + (span % step_ms != 0)));
+    for (const auto& p : buffer) {
+        if (p.timestamp_ms < start || p.timestamp_ms >= end) continue;
+        const uint64_t i = (p.timestamp_ms - start) / step_ms;
+        if (i >= steps.size()) continue;
+        steps[i].add(p.value);
+    }
+    out.begin_array();
+    for (size_t i = 0; i < steps.size(); ++i) {
+        if (!steps[i].n) continue;
+        out.begin_object().field("t", start + i * step_ms).field("n", steps[i].n);
+        steps[i].write(out, step_ms);
+        out.end_object();
+    }
+    out.end_array();
+}
+
+} // namespace
+
+void write_finding(core::JsonWriter& out, const Finding& f) {
+    out.begin_object();
+    out.field("timestamp_ms", f.timestamp_ms);
+    out.field("event_type", f.event_type);
+    out.field("description", f.description);
+    out.field("ir_raw_delta", f.ir_raw_delta);
+    out.field("ultra_distance_delta", f.ultra_distance_delta);
+    out.field("sensor_status", f.sensor_status);
+    out.field("rssi_avg", f.rssi_avg);
+    out.field("rssi_delta", f.rssi_delta);
+    out.field("ping_latency_delta", f.ping_latency_delta);
+    out.field("packet_loss_delta", f.packet_loss_delta);
+    out.field("throughput_delta", f.throughput_delta);
+    out.field("dns_latency_delta", f.dns_latency_delta);
+    out.field("dns_failure_delta", f.dns_failure_delta);
+    out.field("correlation_window_ms", f.correlation_window_ms);
+    out.field("sensor_threshold", f.sensor_threshold);
+    out.key("affected_networks").begin_array();
+    for (const auto& n : f.affected_networks) out.value(n);
+    out.end_array();
+    out.key("affected_hosts").begin_array();
+    for (const auto& h : f.affected_hosts) out.value(h);
+    out.end_array();
+    out.end_object();
+}
+
+Correlator::Correlator(const std::string& config_path)
+    : Correlator(core::Config::load_snapshot(config_path)) {}
+
+Correlator::Correlator(std::shared_ptr<const core::Config> config)
+    : sensor_threshold_(config->correlator.sensor_threshold),
+      correlation_window_ms_(config->correlator.window_ms),
+      sensor_events_(core::MetricsRegistry::instance().counter(
+          "environet_correlator_sensor_events_total", "Sensor frames pushed into the correlator")),
+      network_events_(core::MetricsRegistry::instance().counter(
+          "environet_correlator_network_events_total", "Network samples pushed into the correlator")),
+      correlations_found_(core::MetricsRegistry::instance().counter(
+          "environet_correlator_findings_total", "Findings generated by the correlator")),
+      push_packet_latency_(core::latency_histogram(
+          "environet_correlator_push_packet_seconds", "Time spent buffering one packet in the correlator")),
+      start_time_ms_(0) {
+    findings_.reserve(MAX_FINDINGS);
+}
 
 Correlator::~Correlator() {}
 
@@ -17,63 +330,516 @@ bool Correlator::init() {
     return true;
 }
 
-void Correlator::push_sensor(const sensors::SensorFrame& frame) {
-    std::lock_guard<std::mutex> lock(data_mutex_);
-    sensor_buffer_.emplace_back(get_current_time_ms(), frame);
+void Correlator::push_sensor(const sensors::SensorFrame& frame) { push_sensor_at(get_current_time_ms(), frame); }
+
+void Correlator::push_sensor_at(uint64_t now, const sensors::SensorFrame& frame) {
+    {
+        std::lock_guard<std::mutex> lock(data_mutex_);
+        sensor_buffer_.emplace_back(now, frame);
+        ++sensor_seq_;
+    }
+    sensor_events_.inc();
+    if (live_feed_) live_feed_->publish_sensor(now, frame);
 }
 
-void Correlator::push_bss(const net::BssInfo& bss) {
-    std::lock_guard<std::mutex> lock(data_mutex_);
-    bss_buffer_.emplace_back(get_current_time_ms(), bss);
+void Correlator::push_bss(const net::BssInfo& bss) { push_bss_at(get_current_time_ms(), bss); }
+
+void Correlator::push_bss_at(uint64_t now, const net::BssInfo& bss) {
+    {
+        std::lock_guard<std::mutex> lock(data_mutex_);
+        bss_buffer_.emplace_back(now, bss);
+    }
+    network_events_.inc();
+    if (live_feed_) live_feed_->publish_bss(now, bss);
 }
 
 void Correlator::push_packet(const net::PacketMeta& pkt) {
+    core::ScopedLatency timer(push_packet_latency_);
     std::lock_guard<std::mutex> lock(data_mutex_);
     packet_buffer_.emplace_back(get_current_time_ms(), pkt);
+    network_events_.inc();
 }
 
-void Correlator::push_ping_stats(const net::PingStats& ps) {
-    std::lock_guard<std::mutex> lock(data_mutex_);
-    ping_buffer_.emplace_back(get_current_time_ms(), ps);
+void Correlator::push_ping_stats(const net::PingStats& ps) { push_ping_stats_at(get_current_time_ms(), ps); }
+
+void Correlator::push_ping_stats_at(uint64_t now, const net::PingStats& ps) {
+    {
+        std::lock_guard<std::mutex> lock(data_mutex_);
+        ping_buffer_.emplace_back(now, ps);
+    }
+    network_events_.inc();
+    if (live_feed_) live_feed_->publish_ping(now, ps);
 }
 
 void Correlator::push_iperf3_results(const net::Iperf3Results& r) {
     std::lock_guard<std::mutex> lock(data_mutex_);
     iperf_buffer_.emplace_back(get_current_time_ms(), r);
+    network_events_.inc();
 }
 
-std::vector<Finding> Correlator::process() {
-    // Stub: no real correlation yet
-    return {};
+void Correlator::push_throughput(const net::ThroughputSample& sample) {
+    std::lock_guard<std::mutex> lock(data_mutex_);
+    throughput_buffer_.emplace_back(sample.timestamp_ms, sample);
+}
+
+void Correlator::push_dns(const net::DnsSample& sample) {
+    std::lock_guard<std::mutex> lock(data_mutex_);
+    dns_buffer_.emplace_back(sample.timestamp_ms, sample);
 }
 
-std::vector<Finding> Correlator::get_findings() const { return findings_; }
+size_t Correlator::process() { return process_at(get_current_time_ms()); }
+
+size_t Correlator::process_at(uint64_t now) {
+    TIMELINE_SCOPE("correlator.process");
+    std::lock_guard<std::mutex> process_lock(process_mutex_);
+    if (!throughput_meters_.empty()) {
+        drained_.clear();
+        for (auto* meter : throughput_meters_) meter->drain(now, drained_);
+        for (const auto& sample : drained_) push_throughput(sample);
+    }
+    if (!dns_analyzers_.empty()) {
+        drained_dns_.clear();
+        for (auto* dns : dns_analyzers_) dns->drain(now, drained_dns_);
+        for (const auto& sample : drained_dns_) push_dns(sample);
+    }
+    // Everything allocated from the arena is released when the tick ends
+    struct ArenaReset {
+        core::TickArena& arena;
+        ~ArenaReset() { arena.reset(); }
+    } arena_reset{tick_arena_};
+    std::pmr::vector<Finding> new_findings(&tick_arena_);
+
+    {
+        std::lock_guard<std::mutex> lock(data_mutex_);
+        // A frame is checked once the window after it has been observed
+        uint64_t window = static_cast<uint64_t>(correlation_window_ms_.load());
+        uint64_t first_seq = sensor_seq_ - sensor_buffer_.size();
+        sensor_checked_ = std::max(sensor_checked_, first_seq);
+        for (size_t i = sensor_checked_ - first_seq; i < sensor_buffer_.size(); ++i) {
+            const auto& point = sensor_buffer_[i];
+            if (point.timestamp_ms + window > now) break;
+            if (i > 0) {
+                new_findings.emplace_back();
+                if (!correlate_sensor_event(point, sensor_buffer_[i - 1].value, new_findings.back())) {
+                    new_findings.pop_back();
+                }
+            }
+            ++sensor_checked_;
+        }
+        cleanup_old_data(now);
+        TIMELINE_COUNTER("correlator.sensor_buffer", sensor_buffer_.size());
+        TIMELINE_COUNTER("correlator.bss_buffer", bss_buffer_.size());
+        TIMELINE_COUNTER("correlator.packet_buffer", packet_buffer_.size());
+        TIMELINE_COUNTER("correlator.ping_buffer", ping_buffer_.size());
+    }
+    if (new_findings.empty()) return 0;
+
+    for (const auto& finding : new_findings) {
+        correlations_found_.inc();
+        save_finding(finding);
+        if (finding_callback_) finding_callback_(finding);
+    }
+    std::lock_guard<std::mutex> lock(findings_mutex_);
+    size_t total = findings_.size() + new_findings.size();
+    if (total > MAX_FINDINGS) {
+        size_t drop = std::min(total - MAX_FINDINGS, findings_.size());
+        findings_.erase(findings_.begin(), findings_.begin() + static_cast<std::ptrdiff_t>(drop));
+    }
+    // Copied into the finding pool; storage freed by dropped findings is reused
+    auto first = new_findings.size() > MAX_FINDINGS ? new_findings.end() - MAX_FINDINGS : new_findings.begin();
+    findings_.insert(findings_.end(), first, new_findings.end());
+    return new_findings.size();
+}
+
+std::vector<Finding> Correlator::get_findings() const {
+    std::lock_guard<std::mutex> lock(findings_mutex_);
+    return std::vector<Finding>(findings_.begin(), findings_.end());
+}
+
+void Correlator::apply_config(const core::Config& cfg) {
+    sensor_threshold_.store(cfg.correlator.sensor_threshold);
+    correlation_window_ms_.store(cfg.correlator.window_ms);
+}
 
 nlohmann::json Correlator::get_stats() const {
     nlohmann::json j;
-    j["sensor_events"] = sensor_events_;
-    j["network_events"] = network_events_;
-    j["correlations_found"] = correlations_found_;
+    j["sensor_events"] = sensor_events_.value();
+    j["network_events"] = network_events_.value();
+    j["correlations_found"] = correlations_found_.value();
+    j["push_packet_latency"] = core::latency_summary(push_packet_latency_);
+    {
+        std::lock_guard<std::mutex> lock(process_mutex_);
+        j["arena"] = tick_arena_.get_stats();
+    }
+    {
+        std::lock_guard<std::mutex> lock(findings_mutex_);
+        j["findings"] = findings_.size();
+    }
+    std::lock_guard<std::mutex> lock(data_mutex_);
+    j["buffer_sizes"] = {
+        {"sensor", sensor_buffer_.size()},
+        {"bss", bss_buffer_.size()},
+        {"packet", packet_buffer_.size()},
+        {"ping", ping_buffer_.size()},
+        {"iperf", iperf_buffer_.size()},
+    };
     return j;
 }
 
 void Correlator::set_finding_callback(std::function<void(const Finding&)> cb) { finding_callback_ = std::move(cb); }
 
-void Correlator::cleanup_old_data() {}
-std::vector<Finding> Correlator::correlate_sensor_event(const sensors::SensorFrame&) { return {}; }
+void Correlator::cleanup_old_data(uint64_t now) {
+    // Keep two correlation windows of history; caller holds data_mutex_
+    uint64_t retention = 2 * static_cast<uint64_t>(correlation_window_ms_.load());
+    if (now <= retention) return;
+    uint64_t cutoff = now - retention;
+    auto prune = [cutoff](auto& buffer) {
+        auto it = std::find_if(buffer.begin(), buffer.end(),
+                               [cutoff](const auto& p) { return p.timestamp_ms >= cutoff; });
+        buffer.erase(buffer.begin(), it);
+    };
+    prune(sensor_buffer_);
+    prune(bss_buffer_);
+    prune(packet_buffer_);
+    prune(ping_buffer_);
+    prune(iperf_buffer_);
+    prune(throughput_buffer_);
+    prune(dns_buffer_);
+}
+bool Correlator::correlate_sensor_event(const TimeSeriesPoint<sensors::SensorFrame>& point,
+                                        const sensors::SensorFrame& previous, Finding& finding) {
+    // Caller holds data_mutex_ and process_mutex_; scratch comes from the tick arena
+    const auto& frame = point.value;
+    int threshold = sensor_threshold_.load();
+    int ir_delta = frame.ir_raw - previous.ir_raw;
+    if (std::abs(ir_delta) < threshold) return false;
+
+    uint64_t ts = point.timestamp_ms;
+    int window_ms = correlation_window_ms_.load();
+    uint64_t window = static_cast<uint64_t>(window_ms);
+    uint64_t start = ts > window ? ts - window : 0;
+    uint64_t end = ts + window;
+
+    std::pmr::vector<NetworkShift> networks(&tick_arena_);
+    for (const auto& p : bss_buffer_) {
+        if (p.timestamp_ms < start || p.timestamp_ms > end) continue;
+        auto it = std::find_if(networks.begin(), networks.end(),
+                               [&p](const NetworkShift& n) { return n.bssid == p.value.bssid; });
+        if (it == networks.end()) {
+            networks.push_back(NetworkShift{p.value.bssid, p.value.ssid});
+            it = networks.end() - 1;
+        }
+        double dbm = p.value.signal_mbm / 100.0;
+        if (p.timestamp_ms < ts) { it->before_sum += dbm; ++it->before_n; }
+        else { it->after_sum += dbm; ++it->after_n; }
+    }
+
+    double shift_sum = 0.0;
+    size_t shifted = 0;
+    for (const auto& n : networks) {
+        if (!n.before_n || !n.after_n) continue;
+        double shift = n.after_sum / n.after_n - n.before_sum / n.before_n;
+        shift_sum += shift;
+        ++shifted;
+        if (std::abs(shift) >= AFFECTED_RSSI_DB) {
+            finding.affected_networks.emplace_back(n.ssid.empty() ? n.bssid : n.ssid);
+        }
+    }
+    if (accounting_) {
+        std::pmr::vector<net::HostShift> hosts(&tick_arena_);
+        accounting_->host_shifts(net::HostKind::Mac, start, ts, end, hosts);
+        for (const auto& h : hosts) {
+            uint64_t larger = std::max(h.before_bytes, h.after_bytes);
+            uint64_t smaller = std::min(h.before_bytes, h.after_bytes);
+            if (larger >= AFFECTED_HOST_BYTES && larger - smaller >= AFFECTED_VOLUME_RATIO * larger) {
+                finding.affected_hosts.emplace_back(h.host);
+            }
+        }
+    }
+    if (finding.affected_networks.empty() && finding.affected_hosts.empty()) return false;
+
+    finding.timestamp_ms = ts;
+    finding.event_type = (frame.status & sensors::SensorFrame::STATUS_MOTION) ? "motion" : "sensor_change";
+    finding.ir_raw_delta = ir_delta;
+    finding.ultra_distance_delta = static_cast<double>(frame.ultra_mm) - previous.ultra_mm;
+    finding.sensor_status = frame.status;
+    finding.rssi_avg = calculate_avg_rssi(start, end);
+    finding.rssi_delta = shifted ? shift_sum / shifted : 0.0;
+    finding.ping_latency_delta = mean_shift(ping_buffer_, start, ts, end,
+                                            [](const net::PingStats& s) { return s.avg_rtt_ms; });
+    finding.packet_loss_delta = mean_shift(ping_buffer_, start, ts, end,
+                                           [](const net::PingStats& s) { return s.loss_percentage; });
+    // Passive capture covers the whole window at 100 ms resolution; iperf3 runs are the fallback
+    PassiveRate before = passive_rate(throughput_buffer_, start, ts);
+    PassiveRate after = passive_rate(throughput_buffer_, ts, end + 1);
+    if (!before.empty() && !after.empty()) {
+        finding.throughput_delta = after.total_mbps() - before.total_mbps();
+    } else {
+        finding.throughput_delta = mean_shift(iperf_buffer_, start, ts, end,
+                                              [](const net::Iperf3Results& r) { return r.bandwidth_mbps; });
+    }
+    DnsTotals dns_before = dns_totals(dns_buffer_, start, ts);
+    DnsTotals dns_after = dns_totals(dns_buffer_, ts, end + 1);
+    if (dns_before.responses && dns_after.responses) {
+        finding.dns_latency_delta = dns_after.avg_latency_ms() - dns_before.avg_latency_ms();
+    }
+    if (dns_before.queries && dns_after.queries) {
+        finding.dns_failure_delta = dns_after.failure_pct() - dns_before.failure_pct();
+    }
+    finding.correlation_window_ms = window_ms;
+    finding.sensor_threshold = threshold;
+    fmt::format_to(std::back_inserter(finding.description),
+                   "IR {:+d} (threshold {}), RSSI {:+.1f} dB across {} network(s)",
+                   ir_delta, threshold, finding.rssi_delta, finding.affected_networks.size());
+    if (!finding.affected_hosts.empty()) {
+        fmt::format_to(std::back_inserter(finding.description), ", traffic shift on {} host(s)",
+                       finding.affected_hosts.size());
+    }
+    return true;
+}
+
+nlohmann::json Correlator::get_window_stats(uint64_t start_time, uint64_t end_time) const {
+    WindowSamples samples;
+    copy_window_samples(start_time, end_time, samples);
+    net::DeviceCount devices;
+    if (accounting_) devices = accounting_->devices(start_time, exclusive_end(end_time));
+    return window_stats(samples, start_time, end_time, devices);
+}
+
+nlohmann::json Correlator::get_window_series(uint64_t start_time, uint64_t end_time, uint64_t step_ms) const {
+    nlohmann::json series = nlohmann::json::array();
+    if (step_ms == 0 || end_time <= start_time) return series;
+    const uint64_t span = end_time - start_time;
+    size_t windows = static_cast<size_t>(span / step_ms + (span % step_ms != 0));
+    auto bounds = [&](size_t i) {
+        uint64_t lo = start_time + i * step_ms;
+        return std::make_pair(lo, end_time - lo < step_ms ? end_time : lo + step_ms - 1);
+    };
+
+    WindowSamples samples;
+    copy_window_samples(start_time, end_time, samples);
+    // Device counts share the accounting's query scratch, so they are
+    // taken here one after another rather than from the pool
+    std::vector<net::DeviceCount> devices(windows);
+    if (accounting_) {
+        for (size_t i = 0; i < windows; ++i) {
+            auto [lo, hi] = bounds(i);
+            devices[i] = accounting_->devices(lo, exclusive_end(hi));
+        }
+    }
+
+    std::vector<nlohmann::json> results(windows);
+    auto compute = [&](size_t i) {
+        auto [lo, hi] = bounds(i);
+        results[i] = window_stats(samples, lo, hi, devices[i]);
+        results[i]["start"] = lo;
+        results[i]["end"] = hi;
+    };
+    if (task_pool_) {
+        task_pool_->parallel_for(0, windows, 1, compute);
+    } else {
+        for (size_t i = 0; i < windows; ++i) compute(i);
+    }
+    for (auto& r : results) series.push_back(std::move(r));
+    return series;
+}
+
+size_t Correlator::write_findings(core::JsonWriter& out, uint64_t since_ms, size_t limit) const {
+    std::lock_guard<std::mutex> lock(findings_mutex_);
+    // Findings are kept oldest first: walk back to the first one to write
+    auto first = findings_.end();
+    size_t n = 0;
+    while (first != findings_.begin() && n < limit && std::prev(first)->timestamp_ms > since_ms) {
+        --first;
+        ++n;
+    }
+    out.begin_array();
+    for (auto it = first; it != findings_.end(); ++it) write_finding(out, *it);
+    out.end_array();
+    return n;
+}
+
+const std::vector<std::string_view>& Correlator::series_names() {
+    static const std::vector<std::string_view> names = {"sensor", "rssi", "packets", "ping", "throughput", "dns"};
+    return names;
+}
+
+bool Correlator::write_series(core::JsonWriter& out, std::string_view series, uint64_t start_time,
+                              uint64_t end_time, uint64_t step_ms) const {
+    const auto& names = series_names();
+    if (std::find(names.begin(), names.end(), series) == names.end()) return false;
+    if (step_ms == 0 || end_time <= start_time) {
+        out.begin_array().end_array();
+        return true;
+    }
+    std::lock_guard<std::mutex> lock(data_mutex_);
+    if (series == "sensor") {
+        write_downsampled<SensorStep>(out, sensor_buffer_, start_time, end_time, step_ms);
+    } else if (series == "rssi") {
+        write_downsampled<RssiStep>(out, bss_buffer_, start_time, end_time, step_ms);
+    } else if (series == "packets") {
+        write_downsampled<PacketStep>(out, packet_buffer_, start_time, end_time, step_ms);
+    } else if (series == "ping") {
+        write_downsampled<PingStep>(out, ping_buffer_, start_time, end_time, step_ms);
+    } else if (series == "throughput") {
+        write_downsampled<ThroughputStep>(out, throughput_buffer_, start_time, end_time, step_ms);
+    } else {
+        write_downsampled<DnsStep>(out, dns_buffer_, start_time, end_time, step_ms);
+    }
+    return true;
+}
+
+void Correlator::copy_window_samples(uint64_t start_time, uint64_t end_time, WindowSamples& out) const {
+    {
+        std::lock_guard<std::mutex> lock(data_mutex_);
+        copy_in_range(sensor_buffer_, start_time, end_time, out.sensor, [](const auto& v) { return v; });
+        copy_in_range(bss_buffer_, start_time, end_time, out.bss,
+                      [](const net::BssInfo& b) { return BssSignal{b.signal_mbm}; });
+        copy_in_range(packet_buffer_, start_time, end_time, out.packet,
+                      [](const net::PacketMeta& p) { return PacketSize{p.length}; });
+        copy_in_range(ping_buffer_, start_time, end_time, out.ping,
+                      [](const net::PingStats& p) { return PingRtt{p.avg_rtt_ms, p.loss_percentage}; });
+        copy_in_range(throughput_buffer_, start_time, end_time, out.throughput,
+                      [&out](const net::ThroughputSample& t) {
+                          auto it = std::find(out.interfaces.begin(), out.interfaces.end(), t.interface);
+                          if (it == out.interfaces.end()) it = out.interfaces.insert(it, t.interface);
+                          InterfaceBytes b{static_cast<size_t>(it - out.interfaces.begin()), t.interval_ms, {}};
+                          std::copy(std::begin(t.bytes), std::end(t.bytes), b.bytes);
+                          return b;
+                      });
+        copy_in_range(dns_buffer_, start_time, end_time, out.dns, [](const auto& v) { return v; });
+    }
+    // Pushes may land slightly out of order; windows need each copy sorted
+    sort_by_time(out.sensor);
+    sort_by_time(out.bss);
+    sort_by_time(out.packet);
+    sort_by_time(out.ping);
+    sort_by_time(out.throughput);
+    sort_by_time(out.dns);
+}
+
+nlohmann::json Correlator::window_stats(const WindowSamples& samples, uint64_t start_time, uint64_t end_time,
+                                        const net::DeviceCount& devices) {
+    double ir_sum = 0.0, ultra_sum = 0.0;
+    int ir_min = 0, ir_max = 0;
+    auto sensor = in_range(samples.sensor, start_time, end_time);
+    for (const auto& p : sensor) {
+        int ir = p.value.ir_raw;
+        if (&p == sensor.begin()) { ir_min = ir; ir_max = ir; }
+        ir_min = std::min(ir_min, ir);
+        ir_max = std::max(ir_max, ir);
+        ir_sum += ir;
+        ultra_sum += p.value.ultra_mm;
+    }
+    const size_t sensor_samples = sensor.size();
+
+    double rssi_sum = 0.0;
+    auto bss = in_range(samples.bss, start_time, end_time);
+    for (const auto& p : bss) rssi_sum += p.value.signal_mbm / 100.0;
 
-nlohmann::json Correlator::calculate_window_stats(uint64_t, uint64_t) { return {}; }
-void Correlator::save_finding(const Finding&) {}
-void Correlator::ensure_findings_dir() {}
+    uint64_t bytes = 0;
+    auto packets = in_range(samples.packet, start_time, end_time);
+    for (const auto& p : packets) bytes += p.value.length;
+
+    double rtt_sum = 0.0, loss_sum = 0.0;
+    auto ping = in_range(samples.ping, start_time, end_time);
+    for (const auto& p : ping) {
+        rtt_sum += p.value.avg_rtt_ms;
+        loss_sum += p.value.loss_percentage;
+    }
+    const size_t ping_samples = ping.size();
+
+    nlohmann::json j;
+    j["sensor_samples"] = sensor_samples;
+    j["ir_avg"] = sensor_samples ? ir_sum / sensor_samples : 0.0;
+    j["ir_min"] = ir_min;
+    j["ir_max"] = ir_max;
+    j["ultra_avg_mm"] = sensor_samples ? ultra_sum / sensor_samples : 0.0;
+    j["rssi_avg"] = bss.size() ? rssi_sum / bss.size() : 0.0;
+    // Difference between the last and first RSSI samples in the window
+    j["rssi_delta"] = bss.size() ? (bss.last[-1].value.signal_mbm - bss.first->value.signal_mbm) / 100.0 : 0.0;
+    j["packets"] = static_cast<uint64_t>(packets.size());
+    j["bytes"] = bytes;
+    j["ping_samples"] = ping_samples;
+    j["ping_avg_rtt_ms"] = ping_samples ? rtt_sum / ping_samples : 0.0;
+    j["ping_avg_loss_pct"] = ping_samples ? loss_sum / ping_samples : 0.0;
+
+    // Passive throughput, overall and per capture interface
+    PassiveRate rate;
+    std::vector<PassiveRate> interfaces(samples.interfaces.size());
+    for (const auto& p : in_range(samples.throughput, start_time, end_time)) {
+        rate.add(p.timestamp_ms, p.value.interval_ms, p.value.bytes);
+        interfaces[p.value.interface].add(p.timestamp_ms, p.value.interval_ms, p.value.bytes);
+    }
+    j["throughput_mbps"] = rate.total_mbps();
+    j["rx_mbps"] = rate.mbps(static_cast<size_t>(net::Direction::Rx));
+    j["tx_mbps"] = rate.mbps(static_cast<size_t>(net::Direction::Tx));
+    j["interfaces"] = nlohmann::json::object();
+    for (size_t i = 0; i < interfaces.size(); ++i) {
+        const auto& r = interfaces[i];
+        if (r.empty()) continue;
+        j["interfaces"][samples.interfaces[i]] = {
+            {"throughput_mbps", r.total_mbps()},
+            {"rx_mbps", r.mbps(static_cast<size_t>(net::Direction::Rx))},
+            {"tx_mbps", r.mbps(static_cast<size_t>(net::Direction::Tx))}
+        };
+    }
+
+    // Passive DNS: latency over matched responses, error rates over responses
+    DnsStep dns_step;
+    for (const auto& p : in_range(samples.dns, start_time, end_time)) dns_step.add(p.value);
+    const DnsTotals& dns = dns_step.t;
+    j["dns_queries"] = dns.queries;
+    j["dns_responses"] = dns.responses;
+    j["dns_avg_latency_ms"] = dns.avg_latency_ms();
+    j["dns_max_latency_ms"] = dns.latency_max_us / 1000.0;
+    j["dns_nxdomain_rate"] = dns.responses ? static_cast<double>(dns.nxdomain) / dns.responses : 0.0;
+    j["dns_servfail_rate"] = dns.responses ? static_cast<double>(dns.servfail) / dns.responses : 0.0;
+    j["dns_timeouts"] = dns.timeouts;
+
+    // Distinct devices (HyperLogLog, resolved to whole accounting buckets)
+    j["unique_devices"] = devices.devices;
+    j["channel_devices"] = nlohmann::json::object();
+    for (const auto& c : devices.channels) {
+        j["channel_devices"][std::to_string(c.frequency_mhz)] = c.devices;
+    }
+    return j;
+}
+
+void Correlator::save_finding(const Finding& finding) {
+    auto& trace = core::TraceLog::instance();
+    if (!trace.enabled()) return;
+    if (core::TraceRecord* rec = trace.begin(core::TraceEventType::Finding)) {
+        auto& f = rec->finding;
+        f.ir_raw_delta = static_cast<float>(finding.ir_raw_delta);
+        f.ultra_distance_delta = static_cast<float>(finding.ultra_distance_delta);
+        f.rssi_avg = static_cast<float>(finding.rssi_avg);
+        f.rssi_delta = static_cast<float>(finding.rssi_delta);
+        f.ping_latency_delta = static_cast<float>(finding.ping_latency_delta);
+        f.throughput_delta = static_cast<float>(finding.throughput_delta);
+        f.sensor_status = finding.sensor_status;
+        std::strncpy(f.event_type, finding.event_type.c_str(), sizeof(f.event_type) - 1);
+        trace.commit();
+    }
+}
 void Correlator::set_error(const std::string& e) { last_error_ = e; }
 uint64_t Correlator::get_current_time_ms() {
     using namespace std::chrono;
     return duration_cast<milliseconds>(steady_clock::now().time_since_epoch()).count();
 }
 bool Correlator::is_in_window(uint64_t ts, uint64_t window_start) const {
-    return ts >= window_start && ts <= (window_start + static_cast<uint64_t>(correlation_window_ms_));
+    return ts >= window_start && ts <= (window_start + static_cast<uint64_t>(correlation_window_ms_.load()));
+}
+double Correlator::calculate_avg_rssi(uint64_t start_time, uint64_t end_time) const {
+    double sum = 0.0;
+    size_t n = 0;
+    for (const auto& p : bss_buffer_) {
+        if (p.timestamp_ms < start_time || p.timestamp_ms > end_time) continue;
+        sum += p.value.signal_mbm / 100.0;
+        ++n;
+    }
+    return n ? sum / n : 0.0;
 }
-double Correlator::calculate_avg_rssi(uint64_t, uint64_t) const { return 0.0; }
-double Correlator::calculate_rssi_delta(uint64_t, uint64_t) const { return 0.0; }
+
 
 }} // namespace
@@ -0,0 +1,396 @@
+#include "correlate/live_feed.hpp"
+#include "correlate/correlator.hpp"
+#include "core/http_json.hpp"
+#include "core/json_writer.hpp"
+#include "core/sketch.hpp"
+#include "core/websocket.hpp"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <deque>
+#include <unordered_map>
+
+namespace environet {
+namespace correlate {
+
+/**
+ * @brief One published event, encoded once and shared by all clients
+ *
+ * Binary layout (little-endian): u8 topic, u64 t, then
+ *   ir:   i16 ir_raw, u16 ultra_mm, u8 status
+ *   rssi: i32 signal_mbm, u32 freq_mhz, 6 bytes bssid, u8 ssid_len, ssid
+ *   rtt:  f32 avg_rtt_ms, f32 loss_pct, u8 reachable, u8 target_len, target
+ * Findings have no binary form and are sent as JSON text frames.
+ */
+struct LiveFeed::Message {
+    FeedTopic topic;
+    uint64_t key = 0;           // Series key for coalescing (topic in the top byte)
+    std::string json;
+    std::string binary;
+};
+
+namespace {
+
+const char* topic_name(FeedTopic topic) {
+    switch (topic) {
+        case FeedTopic::Finding: return "finding";
+        case FeedTopic::Ir: return "ir";
+        case FeedTopic::Rssi: return "rssi";
+        case FeedTopic::Rtt: return "rtt";
+    }
+    return "unknown";
+}
+
+constexpr uint32_t topic_bit(FeedTopic topic) { return 1u << static_cast<unsigned>(topic); }
+
+constexpr uint32_t ALL_TOPICS =
+    topic_bit(FeedTopic::Finding) | topic_bit(FeedTopic::Ir) | topic_bit(FeedTopic::Rssi) | topic_bit(FeedTopic::Rtt);
+
+// Parse a comma-separated topic list ("findings,rssi"); 0 if any name is unknown
+uint32_t parse_topics(const std::string& list) {
+    if (list.empty()) return ALL_TOPICS;
+    uint32_t mask = 0;
+    size_t pos = 0;
+    while (pos <= list.size()) {
+        size_t end = std::min(list.find(',', pos), list.size());
+        std::string name = list.substr(pos, end - pos);
+        if (name == "findings") mask |= topic_bit(FeedTopic::Finding);
+        else if (name == "ir") mask |= topic_bit(FeedTopic::Ir);
+        else if (name == "rssi") mask |= topic_bit(FeedTopic::Rssi);
+        else if (name == "rtt") mask |= topic_bit(FeedTopic::Rtt);
+        else return 0;
+        pos = end + 1;
+    }
+    return mask;
+}
+
+template <typename T>
+void put_le(std::string& out, T value) {
+    for (size_t i = 0; i < sizeof(T); ++i) out += static_cast<char>(static_cast<uint64_t>(value) >> (i * 8));
+}
+
+void put_f32(std::string& out, double value) {
+    float f = static_cast<float>(value);
+    uint32_t bits;
+    std::memcpy(&bits, &f, sizeof(bits));
+    put_le(out, bits);
+}
+
+void put_short_string(std::string& out, const std::string& s) {
+    size_t len = std::min<size_t>(s.size(), 255);
+    out += static_cast<char>(len);
+    out.append(s, 0, len);
+}
+
+void put_mac(std::string& out, const std::string& mac) {
+    unsigned b[6] = {};
+    if (std::sscanf(mac.c_str(), "%x:%x:%x:%x:%x:%x", &b[0], &b[1], &b[2], &b[3], &b[4], &b[5]) != 6) {
+        std::fill(b, b + 6, 0u);
+    }
+    for (unsigned v : b) out += static_cast<char>(v);
+}
+
+void begin_binary(std::string& out, FeedTopic topic, uint64_t ts_ms) {
+    out += static_cast<char>(topic);
+    put_le(out, ts_ms);
+}
+
+uint64_t series_key(FeedTopic topic, const std::string& id) {
+    return (uint64_t{static_cast<uint8_t>(topic)} << 56) | (core::hash64(id.data(), id.size()) >> 8);
+}
+
+} // namespace
+
+/**
+ * @brief Stream for one connected client
+ *
+ * Queues are guarded by the feed's mutex; pull() and receive() run on the
+ * server thread.
+ */
+class LiveFeed::Client : public core::HttpStream {
+public:
+    Client(LiveFeed& feed, uint32_t topics, bool websocket, bool binary)
+        : topics(topics), feed_(feed), websocket_(websocket), binary_(binary) {}
+
+    bool pull(std::string& out) override {
+        taken_.clear();
+        {
+            std::lock_guard<std::mutex> lock(feed_.mutex_);
+            size_t bytes = 0;
+            while (bytes < MAX_PULL_BYTES && (!findings.empty() || !series_order.empty())) {
+                std::shared_ptr<const Message> msg;
+                if (!findings.empty()) {
+                    msg = std::move(findings.front());
+                    findings.pop_front();
+                } else {
+                    auto it = series.find(series_order.front());
+                    series_order.pop_front();
+                    msg = std::move(it->second);
+                    series.erase(it);
+                }
+                bytes += msg->json.size();
+                taken_.push_back(std::move(msg));
+            }
+        }
+        for (const auto& msg : taken_) append(out, *msg);
+        feed_.sent_ += taken_.size();
+        taken_.clear();
+        return !closing_;
+    }
+
+    bool receive(std::string& in, std::string& out) override {
+        if (!websocket_) {
+            in.clear();
+            return true;
+        }
+        core::WsFrame frame;
+        int r;
+        while ((r = core::take_websocket_frame(in, frame)) > 0) {
+            if (frame.opcode == core::WsOpcode::Ping) {
+                core::append_websocket_frame(out, core::WsOpcode::Pong, frame.payload.data(), frame.payload.size());
+            } else if (frame.opcode == core::WsOpcode::Close) {
+                // Echo the status code and close once it is sent
+                core::append_websocket_frame(out, core::WsOpcode::Close, frame.payload.data(),
+                                             std::min<size_t>(frame.payload.size(), 2));
+                closing_ = true;
+                return false;
+            }
+            // Data frames from clients are ignored; subscriptions are fixed at connect
+        }
+        return r == 0;
+    }
+
+    void closed() override { feed_.remove(this); }
+
+    // Queue a message (requires feed mutex)
+    void enqueue(const std::shared_ptr<const Message>& msg) {
+        if (msg->topic == FeedTopic::Finding) {
+            if (findings.size() >= feed_.queue_size_) {
+                findings.pop_front();
+                ++feed_.dropped_;
+            }
+            findings.push_back(msg);
+            return;
+        }
+        auto it = series.find(msg->key);
+        if (it != series.end()) {
+            it->second = msg;       // Client has not taken the previous value yet
+            ++feed_.coalesced_;
+        } else if (series.size() >= feed_.max_series_) {
+            ++feed_.dropped_;
+        } else {
+            series.emplace(msg->key, msg);
+            series_order.push_back(msg->key);
+        }
+    }
+
+    const uint32_t topics;
+    std::deque<std::shared_ptr<const Message>> findings;
+    std::unordered_map<uint64_t, std::shared_ptr<const Message>> series;   // Latest pending value per key
+    std::deque<uint64_t> series_order;                                     // Keys in first-pending order
+
+private:
+    void append(std::string& out, const Message& msg) const {
+        if (!websocket_) {
+            out += "event: ";
+            out += topic_name(msg.topic);
+            out += "\ndata: ";
+            out += msg.json;
+            out += "\n\n";
+        } else if (binary_ && !msg.binary.empty()) {
+            core::append_websocket_frame(out, core::WsOpcode::Binary, msg.binary.data(), msg.binary.size());
+        } else {
+            core::append_websocket_frame(out, core::WsOpcode::Text, msg.json.data(), msg.json.size());
+        }
+    }
+
+    LiveFeed& feed_;
+    const bool websocket_;
+    const bool binary_;
+    bool closing_ = false;
+    std::vector<std::shared_ptr<const Message>> taken_;    // Reused by pull()
+};
+
+LiveFeed::LiveFeed(std::shared_ptr<const core::Config> config)
+    : enabled_(config->push.enabled),
+      max_clients_(static_cast<size_t>(config->push.max_clients)),
+      queue_size_(static_cast<size_t>(config->push.queue_size)),
+      max_series_(static_cast<size_t>(config->push.max_series)) {}
+
+LiveFeed::~LiveFeed() = default;
+
+std::shared_ptr<core::HttpStream> LiveFeed::open(const core::HttpRequest& req, core::HttpResponse& resp) {
+    if (!enabled_) {
+        resp = core::error_response(404, "push is disabled");
+        return nullptr;
+    }
+    uint32_t topics = parse_topics(req.query_param("topics"));
+    if (topics == 0) {
+        resp = core::error_response(400, "unknown topic; expected findings, ir, rssi or rtt");
+        return nullptr;
+    }
+    std::string format = req.query_param("format", "json");
+    bool websocket = core::is_websocket_upgrade(req);
+    if (format != "json" && format != "binary") {
+        resp = core::error_response(400, "format must be json or binary");
+        return nullptr;
+    }
+    if (format == "binary" && !websocket) {
+        resp = core::error_response(400, "binary format needs a WebSocket");
+        return nullptr;
+    }
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (clients_.size() >= max_clients_) {
+        ++refused_;
+        resp = core::error_response(503, "too many stream clients");
+        return nullptr;
+    }
+    auto client = std::make_shared<Client>(*this, topics, websocket, format == "binary");
+    clients_.push_back(client);
+    update_subscriptions();
+
+    resp = core::HttpResponse();
+    if (websocket) {
+        resp.status = 101;
+        resp.content_type.clear();
+        resp.headers = {{"Upgrade", "websocket"},
+                        {"Connection", "Upgrade"},
+                        {"Sec-WebSocket-Accept", core::websocket_accept(req.headers.at("sec-websocket-key"))}};
+    } else {
+        resp.status = 200;
+        resp.content_type = "text/event-stream";
+        resp.headers = {{"Cache-Control", "no-cache"}};
+    }
+    return client;
+}
+
+void LiveFeed::set_notifier(std::function<void()> notify) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    notify_ = std::move(notify);
+}
+
+void LiveFeed::publish_finding(const Finding& finding) {
+    if (!wanted(FeedTopic::Finding)) return;
+    auto msg = std::make_shared<Message>();
+    msg->topic = FeedTopic::Finding;
+    core::JsonWriter out(msg->json);
+    out.begin_object().field("topic", "finding").field("t", finding.timestamp_ms).key("finding");
+    write_finding(out, finding);
+    out.end_object();
+    publish(std::move(msg));
+}
+
+void LiveFeed::publish_sensor(uint64_t ts_ms, const sensors::SensorFrame& frame) {
+    if (!wanted(FeedTopic::Ir)) return;
+    auto msg = std::make_shared<Message>();
+    msg->topic = FeedTopic::Ir;
+    msg->key = series_key(FeedTopic::Ir, {});
+    core::JsonWriter(msg->json)
+        .begin_object()
+        .field("topic", "ir")
+        .field("t", ts_ms)
+        .field("ir_raw", frame.ir_raw)
+        .field("ultra_mm", frame.ultra_mm)
+        .field("status", frame.status)
+        .end_object();
+    begin_binary(msg->binary, FeedTopic::Ir, ts_ms);
+    put_le(msg->binary, static_cast<uint16_t>(frame.ir_raw));
+    put_le(msg->binary, frame.ultra_mm);
+    put_le(msg->binary, frame.status);
+    publish(std::move(msg));
+}
+
+void LiveFeed::publish_bss(uint64_t ts_ms, const net::BssInfo& bss) {
+    if (!wanted(FeedTopic::Rssi)) return;
+    auto msg = std::make_shared<Message>();
+    msg->topic = FeedTopic::Rssi;
+    msg->key = series_key(FeedTopic::Rssi, bss.bssid);
+    core::JsonWriter(msg->json)
+        .begin_object()
+        .field("topic", "rssi")
+        .field("t", ts_ms)
+        .field("bssid", bss.bssid)
+        .field("ssid", bss.ssid)
+        .field("freq", bss.freq)
+        .field("rssi_dbm", bss.signal_mbm / 100.0)
+        .end_object();
+    begin_binary(msg->binary, FeedTopic::Rssi, ts_ms);
+    put_le(msg->binary, static_cast<uint32_t>(bss.signal_mbm));
+    put_le(msg->binary, static_cast<uint32_t>(bss.freq));
+    put_mac(msg->binary, bss.bssid);
+    put_short_string(msg->binary, bss.ssid);
+    publish(std::move(msg));
+}
+
+void LiveFeed::publish_ping(uint64_t ts_ms, const net::PingStats& ping) {
+    if (!wanted(FeedTopic::Rtt)) return;
+    auto msg = std::make_shared<Message>();
+    msg->topic = FeedTopic::Rtt;
+    msg->key = series_key(FeedTopic::Rtt, ping.target);
+    core::JsonWriter(msg->json)
+        .begin_object()
+        .field("topic", "rtt")
+        .field("t", ts_ms)
+        .field("target", ping.target)
+        .field("reachable", ping.reachable)
+        .field("avg_rtt_ms", ping.avg_rtt_ms)
+        .field("loss_pct", ping.loss_percentage)
+        .end_object();
+    begin_binary(msg->binary, FeedTopic::Rtt, ts_ms);
+    put_f32(msg->binary, ping.avg_rtt_ms);
+    put_f32(msg->binary, ping.loss_percentage);
+    put_le(msg->binary, static_cast<uint8_t>(ping.reachable));
+    put_short_string(msg->binary, ping.target);
+    publish(std::move(msg));
+}
+
+void LiveFeed::publish(std::shared_ptr<const Message> message) {
+    ++published_;
+    uint32_t bit = topic_bit(message->topic);
+    std::lock_guard<std::mutex> lock(mutex_);
+    bool queued = false;
+    for (const auto& client : clients_) {
+        if (client->topics & bit) {
+            client->enqueue(message);
+            queued = true;
+        }
+    }
+    // Notified under the lock so set_notifier(nullptr) guarantees no later call
+    if (queued && notify_) notify_();
+}
+
+void LiveFeed::remove(Client* client) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    clients_.erase(std::remove_if(clients_.begin(), clients_.end(),
+                                  [client](const std::shared_ptr<Client>& c) { return c.get() == client; }),
+                   clients_.end());
+    update_subscriptions();
+}
+
+void LiveFeed::update_subscriptions() {
+    uint32_t mask = 0;
+    for (const auto& client : clients_) mask |= client->topics;
+    subscribed_.store(mask, std::memory_order_relaxed);
+}
+
+size_t LiveFeed::clients() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return clients_.size();
+}
+
+nlohmann::json LiveFeed::get_stats() const {
+    nlohmann::json j;
+    j["enabled"] = enabled_;
+    j["clients"] = clients();
+    j["published"] = published_.load();
+    j["sent"] = sent_.load();
+    j["dropped"] = dropped_.load();
+    j["coalesced"] = coalesced_.load();
+    j["refused"] = refused_.load();
+    return j;
+}
+
+} // namespace correlate
+} // namespace environet
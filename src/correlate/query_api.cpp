@@ -0,0 +1,173 @@
+#include "correlate/query_api.hpp"
+#include "core/http_json.hpp"
+#include "core/json_writer.hpp"
+
+#include <algorithm>
+#include <chrono>
+
+namespace environet {
+namespace correlate {
+
+namespace {
+
+constexpr uint64_t DEFAULT_RANGE_MS = 60000;    // Range when neither from nor last is given
+constexpr uint64_t DEFAULT_STEP_MS = 1000;
+constexpr size_t DEFAULT_FINDINGS = 100;
+
+const char* const ROUTES[] = {"/api/v1/stats", "/api/v1/findings", "/api/v1/series", "/api/v1/window"};
+
+// [from, to) from from/to or last (ms before now); defaults to the last minute
+bool time_range(const core::HttpRequest& req, uint64_t now, uint64_t& from, uint64_t& to) {
+    uint64_t last = DEFAULT_RANGE_MS;
+    from = UINT64_MAX;
+    to = now + 1;
+    if (!core::param_u64(req, "from", from) || !core::param_u64(req, "to", to) || !core::param_u64(req, "last", last)) return false;
+    if (from == UINT64_MAX) from = to > last ? to - last : 0;
+    return from < to;
+}
+
+} // namespace
+
+QueryApi::QueryApi(std::shared_ptr<const core::Config> config, const Correlator& correlator)
+    : correlator_(correlator),
+      bind_address_(config->api.bind_address),
+      port_(config->api.port),
+      unix_socket_(config->api.unix_socket),
+      max_points_(static_cast<uint64_t>(config->api.max_points)) {}
+
+QueryApi::~QueryApi() { stop(); }
+
+bool QueryApi::start() {
+    for (const char* route : ROUTES) {
+        server_.add_route(route, [this](const core::HttpRequest& req) { return handle(req); });
+    }
+    if (live_feed_) {
+        server_.add_stream_route("/api/v1/stream", [this](const core::HttpRequest& req, core::HttpResponse& resp) {
+            auto stream = live_feed_->open(req, resp);
+            if (resp.status == 400) ++bad_requests_;
+            return stream;
+        });
+    }
+    if (!unix_socket_.empty() && !server_.listen_unix(unix_socket_)) {
+        last_error_ = server_.get_last_error();
+        return false;
+    }
+    if (!server_.start(bind_address_, port_)) {
+        last_error_ = server_.get_last_error();
+        return false;
+    }
+    if (live_feed_) live_feed_->set_notifier([this] { server_.notify(); });
+    return true;
+}
+
+void QueryApi::stop() {
+    if (live_feed_) live_feed_->set_notifier(nullptr);
+    server_.stop();
+}
+
+core::HttpResponse QueryApi::handle(const core::HttpRequest& req) const {
+    uint64_t now = get_current_time_ms();
+    core::HttpResponse resp;
+    if (req.path == "/api/v1/stats") {
+        resp = stats(now);
+    } else if (req.path == "/api/v1/findings") {
+        resp = findings(req, now);
+    } else if (req.path == "/api/v1/series") {
+        resp = series(req, now);
+    } else if (req.path == "/api/v1/window") {
+        resp = window(req, now);
+    } else {
+        resp = core::error_response(404, "unknown endpoint");
+    }
+    if (resp.status == 400) ++bad_requests_;
+    return resp;
+}
+
+core::HttpResponse QueryApi::stats(uint64_t now) const {
+    nlohmann::json j = stats_provider_ ? stats_provider_() : nlohmann::json::object();
+    j["correlator"] = correlator_.get_stats();
+    j["api"] = get_stats();
+    j["now_ms"] = now;
+    return core::json_response(200, j.dump());
+}
+
+core::HttpResponse QueryApi::findings(const core::HttpRequest& req, uint64_t now) const {
+    uint64_t since = 0;
+    uint64_t limit = DEFAULT_FINDINGS;
+    if (!core::param_u64(req, "since", since) || !core::param_u64(req, "limit", limit)) {
+        return core::error_response(400, "since and limit must be non-negative integers");
+    }
+    std::string body;
+    core::JsonWriter out(body);
+    out.begin_object().field("now_ms", now).key("findings");
+    correlator_.write_findings(out, since, static_cast<size_t>(limit));
+    out.end_object();
+    return core::json_response(200, std::move(body));
+}
+
+core::HttpResponse QueryApi::series(const core::HttpRequest& req, uint64_t now) const {
+    std::string name = req.query_param("name");
+    uint64_t from, to;
+    uint64_t step = DEFAULT_STEP_MS;
+    if (!time_range(req, now, from, to) || !core::param_u64(req, "step", step)) {
+        return core::error_response(400, "from, to, last and step must be non-negative integers with from < to");
+    }
+    // Widen the step so a long range still yields at most max_points points
+    // (rounded up without overflowing for ranges up to UINT64_MAX)
+    const uint64_t span = to - from;
+    step = std::max({step, uint64_t{1}, span / max_points_ + (span % max_points_ != 0)});
+
+    std::string body;
+    body.reserve(4096);
+    core::JsonWriter out(body);
+    out.begin_object().field("name", name).field("now_ms", now).field("from", from).field("to", to);
+    out.field("step_ms", step).key("points");
+    if (!correlator_.write_series(out, name, from, to, step)) {
+        std::string message = "unknown series; expected one of:";
+        for (auto n : Correlator::series_names()) (message += ' ') += n;
+        return core::error_response(400, message);
+    }
+    out.end_object();
+    return core::json_response(200, std::move(body));
+}
+
+core::HttpResponse QueryApi::window(const core::HttpRequest& req, uint64_t now) const {
+    uint64_t from, to;
+    if (!time_range(req, now, from, to)) {
+        return core::error_response(400, "from, to and last must be non-negative integers with from < to");
+    }
+    nlohmann::json j;
+    if (req.query_param("step").empty()) {
+        j = correlator_.get_window_stats(from, to - 1);
+    } else {
+        uint64_t step = 0;
+        if (!core::param_u64(req, "step", step)) {
+            return core::error_response(400, "step must be a non-negative integer");
+        }
+        // Same widening as series; the windows are computed on the task pool
+        const uint64_t span = to - from;
+        step = std::max({step, uint64_t{1}, span / max_points_ + (span % max_points_ != 0)});
+        j["step_ms"] = step;
+        j["windows"] = correlator_.get_window_series(from, to - 1, step);
+    }
+    j["now_ms"] = now;
+    j["from"] = from;
+    j["to"] = to;
+    return core::json_response(200, j.dump());
+}
+
+nlohmann::json QueryApi::get_stats() const {
+    nlohmann::json j = server_.get_stats();
+    j["unix_socket"] = unix_socket_;
+    j["bad_requests"] = bad_requests_.load();
+    if (live_feed_) j["push"] = live_feed_->get_stats();
+    return j;
+}
+
+uint64_t QueryApi::get_current_time_ms() {
+    using namespace std::chrono;
+    return duration_cast<milliseconds>(steady_clock::now().time_since_epoch()).count();
+}
+
+} // namespace correlate
+} // namespace environet
@@ -7,42 +7,95 @@
 #include <sys/stat.h>
 #include <errno.h>
 #include <cstring>
+#include <chrono>
+#include <ctime>
 #include <fstream>
+#include <functional>
+#include <set>
+#include <vector>
 
 #include "core/log.hpp"
 #include "core/config.hpp"
+#include "core/config_manager.hpp"
+#include "core/http_server.hpp"
+#include "core/init_graph.hpp"
+#include "core/latency.hpp"
+#include "core/metrics_registry.hpp"
+#include "core/reactor.hpp"
+#include "core/task_pool.hpp"
+#include "core/thread_placement.hpp"
+#include "core/timeline.hpp"
+#include "core/trace_log.hpp"
+#include "core/worker_pool.hpp"
 #include "sensors/arduino_i2c.hpp"
 #include "net/wifi_scan.hpp"
 #include "net/pcap_sniffer.hpp"
 #include "net/metrics.hpp"
 #include "correlate/correlator.hpp"
+#include "correlate/live_feed.hpp"
+#include "correlate/query_api.hpp"
+#include "collect/collector.hpp"
+#include "collect/forwarder.hpp"
 
-// Global shutdown flag
-std::atomic<bool> g_shutdown_requested(false);
+// Signals handled by the event loop; blocked in every thread so they are
+// only delivered through its signalfd
+static const std::vector<int> HANDLED_SIGNALS = {SIGINT, SIGTERM, SIGQUIT, SIGUSR1, SIGUSR2, SIGHUP};
 
-// Signal handler for graceful shutdown
-void signal_handler(int signal) {
-    LOGI("Received signal {}, initiating graceful shutdown...", signal);
-    g_shutdown_requested.store(true);
-}
+// Periodic job for the worker pool; a tick is skipped while the previous run
+// is still going so slow jobs (iperf3, scans) cannot pile up in the queue
+class PoolJob {
+public:
+    explicit PoolJob(std::string name) : name_(std::move(name)) {}
+
+    void run_on(environet::core::WorkerPool& pool, std::function<void()> job) {
+        if (busy_->exchange(true)) {
+            LOGW_RATELIMITED(60000, "Skipping {} tick: previous run still in progress", name_);
+            return;
+        }
+        auto busy = busy_;
+        bool queued = pool.submit([busy, job = std::move(job)]() {
+            try {
+                job();
+            } catch (...) {
+                busy->store(false);
+                throw;
+            }
+            busy->store(false);
+        });
+        if (!queued) busy_->store(false);
+    }
+
+private:
+    std::string name_;
+    std::shared_ptr<std::atomic<bool>> busy_ = std::make_shared<std::atomic<bool>>(false);
+};
 
 // Forward declarations
-void setup_signal_handlers();
 void create_directories(const environet::core::Config& config);
+void dump_timeline(const environet::core::Config& config);
+void apply_config_changes(const environet::core::Config& old_cfg, const environet::core::Config& new_cfg,
+                          const std::vector<std::string>& changed, environet::sensors::ArduinoI2C& sensor,
+                          environet::net::PcapSniffer& pcap_sniffer, environet::correlate::Correlator& correlator);
 void mkdirs(const std::string& dir);
+
+template <typename Component>
+environet::core::InitGraph::InitFn component_init(std::shared_ptr<Component> component) {
+    return [component](std::string& error) {
+        if (component->init()) return true;
+        error = component->get_last_error();
+        return false;
+    };
+}
 bool write_default_config(const std::string& path, bool user_mode);
-void sensor_thread_func(std::shared_ptr<environet::sensors::ArduinoI2C> sensor,
-                       std::shared_ptr<environet::correlate::Correlator> correlator,
-                       const environet::core::Config& config);
-void wifi_scan_thread_func(std::shared_ptr<environet::net::WifiScan> wifi_scan,
-                          std::shared_ptr<environet::correlate::Correlator> correlator,
-                          const environet::core::Config& config);
-void pcap_thread_func(std::shared_ptr<environet::net::PcapSniffer> pcap_sniffer,
-                     std::shared_ptr<environet::correlate::Correlator> correlator);
-void metrics_thread_func(std::shared_ptr<environet::net::Metrics> metrics,
-                        std::shared_ptr<environet::correlate::Correlator> correlator,
-                        const environet::core::Config& config);
-void correlation_thread_func(std::shared_ptr<environet::correlate::Correlator> correlator);
+void read_sensor(environet::sensors::ArduinoI2C& sensor, environet::correlate::Correlator& correlator,
+                 environet::net::FlowExporter* flows);
+void scan_wifi(environet::net::WifiScan& wifi_scan, environet::correlate::Correlator& correlator);
+bool start_capture(std::shared_ptr<environet::net::PcapSniffer> pcap_sniffer,
+                   std::shared_ptr<environet::correlate::Correlator> correlator);
+void collect_metrics(environet::net::Metrics& metrics, environet::correlate::Correlator& correlator,
+                     const environet::core::Config& config);
+void run_correlation(environet::correlate::Correlator& correlator);
+int run_collector(const environet::core::Config& config);
 
 int main(int argc, char* argv[]) {
     try {
@@ -54,6 +107,7 @@ int main(int argc, char* argv[]) {
         bool test_pcap = false;
     bool init_config = false;
     std::string init_config_path;
+        bool collector_mode = false;
         
         for (int i = 1; i < argc; i++) {
             std::string arg = argv[i];
@@ -69,6 +123,8 @@ int main(int argc, char* argv[]) {
                 test_network = true;
             } else if (arg == "--test-pcap") {
                 test_pcap = true;
+            } else if (arg == "--collector") {
+                collector_mode = true;
             } else if (arg == "--init-config") {
                 init_config = true;
                 if (i + 1 < argc && std::string(argv[i+1]).rfind("--", 0) != 0) {
@@ -81,6 +137,7 @@ int main(int argc, char* argv[]) {
                           << "  --config <path>    Configuration file path\n"
                           << "  --mock             Enable mock mode (default)\n"
                           << "  --real             Enable real hardware mode\n"
+                          << "  --collector        Run as central collector for edge instances\n"
                           << "  --init-config [p]  Write a default config template to path p (default: config/config.json) and exit\n"
                           << "  --test-sensors     Test sensor functionality\n"
                           << "  --test-network     Test network functionality\n"
@@ -101,6 +158,9 @@ int main(int argc, char* argv[]) {
             }
         }
         
+        // Block handled signals before any thread starts; the event loop receives them
+        environet::core::Reactor::block_signals(HANDLED_SIGNALS);
+
         // Load configuration
         LOGI("Loading configuration from: {}", config_path);
         environet::core::Config config;
@@ -121,63 +181,133 @@ int main(int argc, char* argv[]) {
     // Create necessary directories (before logging to avoid missing log dir)
     create_directories(config);
 
+    // Pipeline threads apply their CPU/priority placement as they start
+    auto& placement = environet::core::ThreadPlacement::instance();
+    placement.configure(config.threads);
+
     // Initialize logging
     LOGI("Initializing logging system");
     environet::core::init_logger(config.logging.level, config.logging.file, 
                    config.logging.max_size_mb * 1024 * 1024, 
-                   config.logging.max_files);
-        
+                   config.logging.max_files,
+                   config.logging.async, config.logging.async_queue_size,
+                   config.logging.overflow_policy,
+                   []() { environet::core::ThreadPlacement::instance().apply("writer"); });
+        
+        if (collector_mode) {
+            int rc = run_collector(config);
+            environet::core::shutdown_logger();
+            return rc;
+        }
+
         LOGI("EnviroNet Analyzer starting up...");
         LOGI("Configuration: mock_i2c={}, wifi_scan_interval={}ms, pcap_bpf='{}'", 
              config.i2c.mock_mode, config.wifi.scan_interval_ms, config.pcap.bpf);
         
     // Directories already ensured above
         
-        // Setup signal handlers for graceful shutdown
-        setup_signal_handlers();
-        
-        // Initialize components
+        // Initialize components from one parsed snapshot; reloads publish new ones
         LOGI("Initializing components...");
-        
-    auto sensor = std::make_shared<environet::sensors::ArduinoI2C>(config);
-        if (!sensor->init()) {
-            LOGE("Failed to initialize sensor: {}", sensor->get_last_error());
+        auto init_start = std::chrono::steady_clock::now();
+        environet::core::ConfigManager config_manager(config_path, config, [mock_mode](environet::core::Config& cfg) {
+            if (!mock_mode) cfg.i2c.mock_mode = false;
+        });
+        auto snapshot = config_manager.current();
+        
+        auto sensor = std::make_shared<environet::sensors::ArduinoI2C>(snapshot);
+        auto wifi_scan = std::make_shared<environet::net::WifiScan>(snapshot);
+        auto pcap_sniffer = std::make_shared<environet::net::PcapSniffer>(snapshot);
+        auto metrics = std::make_shared<environet::net::Metrics>(snapshot);
+        auto correlator = std::make_shared<environet::correlate::Correlator>(snapshot);
+        auto accounting = std::make_shared<environet::net::TrafficAccounting>(snapshot);
+        auto dns = std::make_shared<environet::net::DnsAnalyzer>(snapshot);
+        auto flow_exporter = std::make_shared<environet::net::FlowExporter>(snapshot);
+        auto forwarder = std::make_shared<environet::collect::Forwarder>(snapshot);
+
+        // Independent inits run concurrently; WiFi, pcap and metrics are optional
+        using std::chrono::milliseconds;
+        environet::core::InitGraph init_graph;
+        init_graph.add("sensor", component_init(sensor), {}, milliseconds(3000));
+        init_graph.add("wifi", component_init(wifi_scan), {}, milliseconds(5000), false);
+        init_graph.add("pcap", component_init(pcap_sniffer), {}, milliseconds(5000), false);
+        init_graph.add("metrics", component_init(metrics), {}, milliseconds(5000), false);
+        init_graph.add("correlator", component_init(correlator), {}, milliseconds(1000));
+        init_graph.add("accounting", component_init(accounting), {}, milliseconds(1000), false);
+        init_graph.add("dns", component_init(dns), {}, milliseconds(1000), false);
+        init_graph.add("flow_export", component_init(flow_exporter), {}, milliseconds(1000), false);
+        if (config.forward.enabled) {
+            init_graph.add("forwarder", component_init(forwarder), {}, milliseconds(5000), false);
+        }
+        bool init_ok = init_graph.run();
+        for (const auto& step : init_graph.results()) {
+            if (step.ok) {
+                LOGI("Initialized {} in {:.1f} ms", step.name, step.elapsed_ms);
+            } else if (step.required) {
+                LOGE("Failed to initialize {}: {}", step.name, step.error);
+            } else {
+                LOGW("Failed to initialize {}: {}; continuing without it", step.name, step.error);
+            }
+        }
+        if (!init_ok) {
             return 1;
         }
-        
-        auto wifi_scan = std::make_shared<environet::net::WifiScan>(config_path);
-        if (!wifi_scan->init()) {
-            LOGW("Failed to initialize WiFi scan: {}", wifi_scan->get_last_error());
-            LOGW("Continuing without WiFi scanning...");
+        // A step abandoned at its deadline may still be running; leave it alone
+        auto usable = [&init_graph](const char* name) {
+            const auto* step = init_graph.result(name);
+            return step && !step->timed_out && !step->skipped;
+        };
+
+        // Per-host traffic accounting: fed by capture, queried for attribution
+        if (usable("accounting") && accounting->enabled()) {
+            pcap_sniffer->set_traffic_accounting(accounting.get());
+            correlator->set_traffic_accounting(accounting.get());
         }
-        
-        auto pcap_sniffer = std::make_shared<environet::net::PcapSniffer>(config_path);
-        if (!pcap_sniffer->init()) {
-            LOGW("Failed to initialize PCAP sniffer: {}", pcap_sniffer->get_last_error());
-            LOGW("Continuing without packet capture...");
+        // Passive throughput from capture, merged into the correlator every tick
+        if (usable("pcap")) {
+            correlator->add_throughput_meter(&pcap_sniffer->throughput());
         }
-        
-        auto metrics = std::make_shared<environet::net::Metrics>(config_path);
-        if (!metrics->init()) {
-            LOGW("Failed to initialize metrics: {}", metrics->get_last_error());
-            LOGW("Continuing without network metrics...");
+        if (usable("dns") && dns->enabled()) {
+            pcap_sniffer->set_dns_analyzer(dns.get());
+            correlator->add_dns_analyzer(dns.get());
         }
-        
-        auto correlator = std::make_shared<environet::correlate::Correlator>(config_path);
-        if (!correlator->init()) {
-            LOGE("Failed to initialize correlator: {}", correlator->get_last_error());
-            return 1;
+        // Flows from capture exported as IPFIX / NetFlow v9 to an external collector
+        bool flow_export_enabled = usable("flow_export") && flow_exporter->enabled();
+        if (flow_export_enabled) {
+            pcap_sniffer->set_flow_exporter(flow_exporter.get());
         }
         
+        // Live push of findings and ingest series, served by the query API
+        auto live_feed = std::make_shared<environet::correlate::LiveFeed>(snapshot);
+        bool push_enabled = config.api.enabled && live_feed->enabled();
+        if (push_enabled) {
+            correlator->set_live_feed(live_feed.get());
+        }
+
+        // Findings and window rollups spooled and forwarded to a central collector
+        bool forward_enabled = usable("forwarder");
+        if (forward_enabled && config.forward.rollup_interval_ms > 0) {
+            uint64_t rollup_ms = static_cast<uint64_t>(config.forward.rollup_interval_ms);
+            forwarder->set_rollup_provider([correlator, rollup_ms]() {
+                using namespace std::chrono;
+                uint64_t now = duration_cast<milliseconds>(steady_clock::now().time_since_epoch()).count();
+                return correlator->get_window_stats(now > rollup_ms ? now - rollup_ms : 0, now);
+            });
+        }
+
         // Set up finding callback
-        correlator->set_finding_callback([](const environet::correlate::Finding& finding) {
+        correlator->set_finding_callback([live_feed, push_enabled, forwarder, forward_enabled](
+                                             const environet::correlate::Finding& finding) {
             LOGI("New finding: {} - {}", finding.event_type, finding.description);
+            if (push_enabled) live_feed->publish_finding(finding);
+            if (forward_enabled) forwarder->publish_finding(finding);
             // TODO: Save to database, send alerts, etc.
         });
         
-        LOGI("All components initialized successfully");
-        
-        // Run tests if requested
+        LOGI("All components initialized in {:.1f} ms (init graph {:.1f} ms)",
+             std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - init_start).count(),
+             init_graph.elapsed_ms());
+
+        // One-shot diagnostics run before any server, pool or watcher starts
         if (test_sensors) {
             LOGI("Running sensor tests...");
             environet::sensors::SensorFrame frame;
@@ -195,6 +325,12 @@ int main(int argc, char* argv[]) {
         }
         
         if (test_network) {
+            for (const char* name : {"wifi", "metrics"}) {
+                if (!usable(name)) {
+                    LOGE("Cannot run network tests: {} is not initialized", name);
+                    return 1;
+                }
+            }
             LOGI("Running network tests...");
             auto bss_list = wifi_scan->scan();
             LOGI("Found {} WiFi networks", bss_list.size());
@@ -215,16 +351,25 @@ int main(int argc, char* argv[]) {
         }
         
         if (test_pcap) {
+            if (!usable("pcap")) {
+                LOGE("Cannot run PCAP tests: pcap is not initialized");
+                return 1;
+            }
             LOGI("Running PCAP tests...");
             bool pcap_started = pcap_sniffer->start([correlator](const environet::net::PacketMeta& meta, const uint8_t* data) {
                 (void)data; // Suppress unused parameter warning
                 correlator->push_packet(meta);
-                LOGD("Packet: {} -> {}, {} bytes", meta.src_mac, meta.dst_mac, meta.length);
+                LOGD_EVERY_N(1000, "Packet: {} -> {}, {} bytes", meta.src_mac, meta.dst_mac, meta.length);
             });
             
             if (pcap_started) {
                 LOGI("PCAP capture started, running for 10 seconds...");
-                std::this_thread::sleep_for(std::chrono::seconds(10));
+                sigset_t stop_signals;
+                sigemptyset(&stop_signals);
+                sigaddset(&stop_signals, SIGINT);
+                sigaddset(&stop_signals, SIGTERM);
+                timespec capture_time{10, 0};
+                sigtimedwait(&stop_signals, nullptr, &capture_time);
                 pcap_sniffer->stop();
                 LOGI("PCAP tests completed");
             } else {
@@ -232,58 +377,259 @@ int main(int argc, char* argv[]) {
             }
             return 0;
         }
-        
-        // Start main monitoring threads
-        LOGI("Starting monitoring threads...");
-        
-        std::thread sensor_thread(sensor_thread_func, sensor, correlator, std::ref(config));
-        std::thread wifi_thread(wifi_scan_thread_func, wifi_scan, correlator, std::ref(config));
-        std::thread pcap_thread(pcap_thread_func, pcap_sniffer, correlator);
-        std::thread metrics_thread(metrics_thread_func, metrics, correlator, std::ref(config));
-        std::thread correlation_thread(correlation_thread_func, correlator);
-        
-        // Main loop - wait for shutdown signal
-        LOGI("Monitoring started. Press Ctrl+C to stop.");
-        while (!g_shutdown_requested.load()) {
-            std::this_thread::sleep_for(std::chrono::seconds(1));
+
+        // Live configuration: SIGHUP or saving the file applies changes in place
+        config_manager.subscribe([sensor, pcap_sniffer, correlator](const environet::core::Config& old_cfg,
+                                                                    const environet::core::Config& new_cfg,
+                                                                    const std::vector<std::string>& changed) {
+            apply_config_changes(old_cfg, new_cfg, changed, *sensor, *pcap_sniffer, *correlator);
+        });
+        if (!config_manager.start_watch()) {
+            LOGW("Config file watch unavailable ({}); reload with SIGHUP", config_manager.get_last_error());
         }
-        
-        // Shutdown sequence
-        LOGI("Shutting down...");
-        
-        // Stop components first
-        pcap_sniffer->stop();
-        
-        // Wait for threads to finish
-        if (sensor_thread.joinable()) {
-            // For std::thread, we can't timeout on join, so we just join
-            // In a real application, you might want to use std::future with timeout
-            sensor_thread.join();
-            LOGI("Sensor thread joined successfully");
+
+        // Binary event trace (decode with environet_trace_decode)
+        if (config.trace.enabled) {
+            auto& trace = environet::core::TraceLog::instance();
+            if (trace.start(config.trace.file, config.trace.max_file_size_mb * 1024 * 1024,
+                            config.trace.max_files, config.trace.buffer_records,
+                            config.trace.flush_interval_ms)) {
+                LOGI("Event trace: {} (max: {}MB, keep: {} files)", config.trace.file,
+                     config.trace.max_file_size_mb, config.trace.max_files);
+            } else {
+                LOGW("Failed to start event trace: {}", trace.get_last_error());
+            }
         }
-        
-        if (wifi_thread.joinable()) {
-            wifi_thread.join();
-            LOGI("WiFi thread joined successfully");
+
+        // Pipeline timeline (dump with SIGUSR2 or GET /debug/timeline)
+        if (config.timeline.enabled) {
+            environet::core::Timeline::instance().enable(config.timeline.buffer_events);
+            environet::core::Timeline::instance().set_thread_name("main");
+            LOGI("Timeline recording enabled ({} events)", config.timeline.buffer_events);
         }
         
-        if (pcap_thread.joinable()) {
-            pcap_thread.join();
-            LOGI("PCAP thread joined successfully");
+        // Expose the metrics registry for Prometheus/OpenMetrics scrapers
+        environet::core::HttpServer telemetry_server;
+        if (config.telemetry.enabled) {
+            telemetry_server.add_route("/metrics", [](const environet::core::HttpRequest& req) {
+                auto accept = req.headers.find("accept");
+                bool openmetrics = accept != req.headers.end() &&
+                                   accept->second.find("application/openmetrics-text") != std::string::npos;
+                environet::core::HttpResponse resp;
+                resp.content_type = openmetrics
+                    ? "application/openmetrics-text; version=1.0.0; charset=utf-8"
+                    : "text/plain; version=0.0.4; charset=utf-8";
+                resp.body = environet::core::MetricsRegistry::instance().render_prometheus(openmetrics);
+                return resp;
+            });
+            if (config.timeline.enabled) {
+                int default_seconds = config.timeline.dump_seconds;
+                telemetry_server.add_route("/debug/timeline", [default_seconds](const environet::core::HttpRequest& req) {
+                    environet::core::HttpResponse resp;
+                    double seconds = default_seconds;
+                    try {
+                        seconds = std::stod(req.query_param("seconds", std::to_string(default_seconds)));
+                    } catch (const std::exception&) {
+                        resp.status = 400;
+                        resp.body = "invalid seconds\n";
+                        return resp;
+                    }
+                    resp.content_type = "application/json";
+                    resp.body = environet::core::Timeline::instance().to_chrome_json(seconds);
+                    return resp;
+                });
+            }
+            telemetry_server.add_route("/debug/threads", [](const environet::core::HttpRequest&) {
+                environet::core::HttpResponse resp;
+                resp.content_type = "application/json";
+                resp.body = environet::core::ThreadPlacement::instance().get_stats().dump(2) + "\n";
+                return resp;
+            });
+            telemetry_server.add_route("/debug/traffic", [accounting](const environet::core::HttpRequest&) {
+                environet::core::HttpResponse resp;
+                resp.content_type = "application/json";
+                resp.body = accounting->get_stats().dump(2) + "\n";
+                return resp;
+            });
+            telemetry_server.add_route("/debug/dns", [dns](const environet::core::HttpRequest&) {
+                environet::core::HttpResponse resp;
+                resp.content_type = "application/json";
+                resp.body = dns->get_stats().dump(2) + "\n";
+                return resp;
+            });
+            telemetry_server.add_route("/debug/flows", [flow_exporter](const environet::core::HttpRequest&) {
+                environet::core::HttpResponse resp;
+                resp.content_type = "application/json";
+                resp.body = flow_exporter->get_stats().dump(2) + "\n";
+                return resp;
+            });
+            if (telemetry_server.start(config.telemetry.bind_address, config.telemetry.port)) {
+                LOGI("Metrics endpoint: http://{}:{}/metrics", config.telemetry.bind_address,
+                     telemetry_server.port());
+            } else {
+                LOGW("Failed to start metrics endpoint: {}", telemetry_server.get_last_error());
+            }
         }
-        
-        if (metrics_thread.joinable()) {
-            metrics_thread.join();
-            LOGI("Metrics thread joined successfully");
+
+        // Work-stealing pool for CPU-bound analysis (windowed queries)
+        environet::core::TaskPool task_pool;
+        task_pool.start(config.tasks.workers, config.tasks.pin_workers);
+        correlator->set_task_pool(&task_pool);
+        LOGI("Task pool: {} workers{}", task_pool.size(), config.tasks.pin_workers ? " (pinned)" : "");
+
+        // Local query API: stats, findings and downsampled series as JSON
+        environet::correlate::QueryApi query_api(snapshot, *correlator);
+        if (config.api.enabled) {
+            query_api.set_stats_provider([sensor, pcap_sniffer, metrics, accounting, dns, flow_exporter, forwarder,
+                                         forward_enabled]() {
+                nlohmann::json j;
+                j["sensor"] = sensor->get_stats();
+                j["pcap"] = pcap_sniffer->get_stats();
+                j["metrics"] = metrics->get_stats();
+                j["accounting"] = accounting->get_stats();
+                j["dns"] = dns->get_stats();
+                j["flow_export"] = flow_exporter->get_stats();
+                if (forward_enabled) j["forward"] = forwarder->get_stats();
+                return j;
+            });
+            if (push_enabled) query_api.set_live_feed(live_feed.get());
+            if (query_api.start()) {
+                if (config.api.port >= 0) {
+                    LOGI("Query API: http://{}:{}/api/v1/", config.api.bind_address, query_api.port());
+                }
+                if (!config.api.unix_socket.empty()) LOGI("Query API socket: {}", config.api.unix_socket);
+            } else {
+                LOGW("Failed to start query API: {}", query_api.get_last_error());
+            }
         }
         
-        if (correlation_thread.joinable()) {
-            correlation_thread.join();
-            LOGI("Correlation thread joined successfully");
+        // Event loop: timers drive sensor reads, scans, metrics and correlation
+        // ticks; blocking work runs on a small worker pool
+        LOGI("Starting event loop...");
+        environet::core::Reactor reactor;
+        if (!reactor.init()) {
+            LOGE("Failed to start event loop: {}", reactor.get_last_error());
+            return 1;
+        }
+        // One worker per pool job so a long iperf3 run never delays a scan;
+        // metrics and correlation get their own threads so each can be placed
+        environet::core::WorkerPool workers, metrics_workers, correlation_workers;
+        auto place = [&placement](const char* role) {
+            return [&placement, role]() {
+                if (!placement.apply(role)) LOGW("{}", placement.get_last_error());
+            };
+        };
+        workers.start(1, "wifi");
+        metrics_workers.start(1, "metrics", place("metrics"));
+        correlation_workers.start(1, "correlation", place("correlation"));
+
+        reactor.add_signals(HANDLED_SIGNALS, [&](int signo) {
+            switch (signo) {
+            case SIGUSR1:
+                environet::core::dump_latency_stats();
+                break;
+            case SIGUSR2:
+                dump_timeline(*config_manager.current());
+                break;
+            case SIGHUP:
+                LOGI("SIGHUP received, reloading {}", config_path);
+                if (!config_manager.reload()) {
+                    LOGW("{}", config_manager.get_last_error());
+                }
+                break;
+            default:
+                LOGI("Received signal {}, initiating graceful shutdown...", signo);
+                reactor.stop();
+            }
+        });
+
+        auto current = config_manager.current();
+        PoolJob wifi_job("wifi"), metrics_job("metrics"), correlation_job("correlation");
+        int sensor_timer = reactor.add_timer(milliseconds(current->i2c.sample_interval_ms), [sensor, correlator, flow_exporter, flow_export_enabled]() {
+            read_sensor(*sensor, *correlator, flow_export_enabled ? flow_exporter.get() : nullptr);
+        }, milliseconds(0));
+        int wifi_timer = -1;
+        if (usable("wifi")) {
+            wifi_timer = reactor.add_timer(milliseconds(current->wifi.scan_interval_ms), [&]() {
+                wifi_job.run_on(workers, [wifi_scan, correlator]() { scan_wifi(*wifi_scan, *correlator); });
+            }, milliseconds(0));
+        }
+        int metrics_timer = -1;
+        if (usable("metrics")) {
+            metrics_timer = reactor.add_timer(milliseconds(current->metrics.ping_interval_ms), [&]() {
+                // One snapshot per round: targets follow reloads
+                auto config = config_manager.current();
+                metrics_job.run_on(metrics_workers, [metrics, correlator, config]() {
+                    collect_metrics(*metrics, *correlator, *config);
+                });
+            }, milliseconds(0));
+        }
+        int correlation_timer = reactor.add_timer(milliseconds(1000), [&]() {
+            correlation_job.run_on(correlation_workers, [correlator]() { run_correlation(*correlator); });
+            TIMELINE_COUNTER("log.queue_depth", environet::core::get_log_stats()["queue_depth"].get<uint64_t>());
+        });
+        int flow_timer = -1;
+        if (flow_export_enabled) {
+            // Idle and active timeouts are checked once a second
+            flow_timer = reactor.add_timer(milliseconds(1000), [flow_exporter]() { flow_exporter->expire(); });
         }
+        if (sensor_timer < 0 || correlation_timer < 0 || (flow_export_enabled && flow_timer < 0)) {
+            LOGE("Failed to schedule timers: {}", reactor.get_last_error());
+            return 1;
+        }
+        if (usable("pcap")) {
+            start_capture(pcap_sniffer, correlator);
+        }
+        if (forward_enabled && forwarder->start()) {
+            LOGI("Forwarding to collector {}:{} as '{}'", config.forward.collector_host,
+                 config.forward.collector_port, forwarder->edge_id());
+        }
+        if (flow_export_enabled) {
+            LOGI("Exporting flows as {} to {}:{}", config.flow_export.protocol, config.flow_export.collector_host,
+                 config.flow_export.collector_port);
+        }
+
+        // Reloaded intervals re-arm their timers on the loop thread
+        config_manager.subscribe([&reactor, sensor_timer, wifi_timer, metrics_timer](
+                                     const environet::core::Config& old_cfg, const environet::core::Config& new_cfg,
+                                     const std::vector<std::string>& /*changed*/) {
+            auto rearm = [&reactor](int timer, int old_ms, int new_ms) {
+                if (timer < 0 || old_ms == new_ms) return;
+                reactor.post([&reactor, timer, new_ms]() { reactor.set_timer_interval(timer, milliseconds(new_ms)); });
+            };
+            rearm(sensor_timer, old_cfg.i2c.sample_interval_ms, new_cfg.i2c.sample_interval_ms);
+            rearm(wifi_timer, old_cfg.wifi.scan_interval_ms, new_cfg.wifi.scan_interval_ms);
+            rearm(metrics_timer, old_cfg.metrics.ping_interval_ms, new_cfg.metrics.ping_interval_ms);
+        });
+
+        // The loop thread reads the sensor
+        place("sensor")();
+        LOGI("Thread placement: {}", placement.get_stats().dump());
+
+        LOGI("Monitoring started. Press Ctrl+C to stop.");
+        reactor.run();
+
+        // Shutdown sequence: queued jobs are dropped, running ones finish
+        LOGI("Shutting down...");
+        config_manager.stop_watch();
+        if (usable("pcap")) pcap_sniffer->stop();
+        // No more packets: open flows are exported before the socket closes
+        if (flow_export_enabled) flow_exporter->flush();
+        workers.stop();
+        metrics_workers.stop();
+        correlation_workers.stop();
+        // The query API computes window series on the task pool: stop it first
+        query_api.stop();
+        correlator->set_task_pool(nullptr);
+        task_pool.stop();
+        // After correlation stopped: the last findings are sealed into the spool
+        if (forward_enabled) forwarder->stop();
+        LOGI("Event loop stats: {}", reactor.get_stats().dump());
         
         // Cleanup
         sensor->stop();
+        telemetry_server.stop();
+        environet::core::TraceLog::instance().stop();
         
         LOGI("Shutdown complete");
         environet::core::shutdown_logger();
@@ -297,10 +643,39 @@ int main(int argc, char* argv[]) {
     return 0;
 }
 
-void setup_signal_handlers() {
-    signal(SIGINT, signal_handler);
-    signal(SIGTERM, signal_handler);
-    signal(SIGQUIT, signal_handler);
+int run_collector(const environet::core::Config& config) {
+    auto snapshot = std::make_shared<const environet::core::Config>(config);
+    environet::collect::Collector collector(snapshot);
+    if (!collector.start()) {
+        LOGE("Failed to start collector: {}", collector.get_last_error());
+        return 1;
+    }
+    LOGI("Collector accepting edges on {}:{}", config.collector.bind_address, collector.port());
+    if (config.api.enabled) {
+        if (collector.start_api(config.api.bind_address, config.api.port)) {
+            LOGI("Collector query API: http://{}:{}/api/v1/", config.api.bind_address, collector.api_port());
+        } else {
+            LOGW("Failed to start collector query API: {}", collector.get_last_error());
+        }
+    }
+
+    // Handled signals are blocked in every thread; take them here
+    sigset_t signals;
+    sigemptyset(&signals);
+    for (int signo : HANDLED_SIGNALS) sigaddset(&signals, signo);
+    while (true) {
+        int signo = 0;
+        if (sigwait(&signals, &signo) != 0) continue;
+        if (signo == SIGUSR1) {
+            LOGI("Collector stats: {}", collector.get_stats().dump());
+        } else if (signo == SIGINT || signo == SIGTERM || signo == SIGQUIT) {
+            LOGI("Received signal {}, stopping collector...", signo);
+            break;
+        }
+    }
+    collector.stop();
+    LOGI("Collector stopped");
+    return 0;
 }
 
 void create_directories(const environet::core::Config& config) {
@@ -315,6 +690,66 @@ void create_directories(const environet::core::Config& config) {
     
     // Create captures directory
     mkdirs(config.pcap.output_dir);
+
+    // Create trace directory
+    if (config.trace.enabled) {
+        size_t slash = config.trace.file.find_last_of('/');
+        if (slash != std::string::npos) mkdirs(config.trace.file.substr(0, slash));
+    }
+
+    // Create timeline dump directory
+    if (config.timeline.enabled) {
+        mkdirs(config.timeline.output_dir);
+    }
+}
+
+void apply_config_changes(const environet::core::Config& old_cfg, const environet::core::Config& new_cfg,
+                          const std::vector<std::string>& changed, environet::sensors::ArduinoI2C& sensor,
+                          environet::net::PcapSniffer& pcap_sniffer, environet::correlate::Correlator& correlator) {
+    // Settings applied without restarting; thread loops re-read their intervals
+    // and ping targets from the current snapshot on every pass
+    static const std::set<std::string> live = {
+        "i2c.sample_interval_ms", "wifi.scan_interval_ms", "pcap.bpf", "classifier.rules",
+        "correlator.sensor_threshold", "correlator.window_ms", "logging.level",
+        "metrics.ping_targets", "metrics.iperf_server", "metrics.ping_interval_ms",
+        "metrics.iperf3_duration", "metrics.iperf_duration", "timeline.dump_seconds",
+    };
+    std::string applied, restart;
+    for (const auto& key : changed) {
+        std::string& list = live.count(key) ? applied : restart;
+        list += (list.empty() ? "" : ", ") + key;
+    }
+
+    if (new_cfg.logging.level != old_cfg.logging.level) {
+        environet::core::set_log_level(new_cfg.logging.level);
+    }
+    sensor.apply_config(new_cfg);
+    correlator.apply_config(new_cfg);
+    if (!pcap_sniffer.apply_config(new_cfg)) {
+        LOGW("Keeping previous capture filter or classification rules: {}", pcap_sniffer.get_last_error());
+    }
+
+    if (!applied.empty()) LOGI("Configuration reloaded, applied: {}", applied);
+    if (!restart.empty()) LOGW("Configuration changes that need a restart: {}", restart);
+}
+
+void dump_timeline(const environet::core::Config& config) {
+    auto& timeline = environet::core::Timeline::instance();
+    if (!timeline.enabled()) {
+        LOGW("Timeline dump requested but timeline.enabled is false");
+        return;
+    }
+    char stamp[32];
+    time_t now = time(nullptr);
+    struct tm tm_buf;
+    localtime_r(&now, &tm_buf);
+    strftime(stamp, sizeof(stamp), "%Y%m%d_%H%M%S", &tm_buf);
+    std::string path = config.timeline.output_dir + "/timeline_" + stamp + ".json";
+    if (timeline.dump(path, config.timeline.dump_seconds)) {
+        LOGI("Wrote last {}s of timeline to {}", config.timeline.dump_seconds, path);
+    } else {
+        LOGW("Failed to write timeline: {}", timeline.get_last_error());
+    }
 }
 
 void mkdirs(const std::string& dir) {
@@ -365,125 +800,93 @@ bool write_default_config(const std::string& path, bool user_mode) {
     }
 }
 
-void sensor_thread_func(std::shared_ptr<environet::sensors::ArduinoI2C> sensor,
-                       std::shared_ptr<environet::correlate::Correlator> correlator,
-                       const environet::core::Config& config) {
-    LOGI("Sensor thread started");
-    
+void read_sensor(environet::sensors::ArduinoI2C& sensor, environet::correlate::Correlator& correlator,
+                 environet::net::FlowExporter* flows) {
     environet::sensors::SensorFrame frame;
-    while (!g_shutdown_requested.load()) {
-        if (sensor->read_frame(frame)) {
-            correlator->push_sensor(frame);
-            LOGD("Sensor frame: IR={}, Ultra={}mm, Status=0x{:02x}", 
-                 frame.ir_raw, frame.ultra_mm, frame.status);
-        } else {
-            LOGW("Failed to read sensor frame: {}", sensor->get_last_error());
-        }
-        
-        // Sleep for sample interval
-        std::this_thread::sleep_for(std::chrono::milliseconds(config.i2c.sample_interval_ms));
+    bool ok;
+    {
+        TIMELINE_SCOPE("sensor.read_frame");
+        ok = sensor.read_frame(frame);
+    }
+    if (ok) {
+        TIMELINE_SCOPE("correlator.push_sensor");
+        correlator.push_sensor(frame);
+        if (flows) flows->set_sensor_context(frame.ir_raw, frame.ultra_mm, frame.status);
+        LOGD("Sensor frame: IR={}, Ultra={}mm, Status=0x{:02x}", 
+             frame.ir_raw, frame.ultra_mm, frame.status);
+    } else {
+        LOGW_RATELIMITED(5000, "Failed to read sensor frame: {}", sensor.get_last_error());
     }
-    
-    LOGI("Sensor thread stopped");
 }
 
-void wifi_scan_thread_func(std::shared_ptr<environet::net::WifiScan> wifi_scan,
-                          std::shared_ptr<environet::correlate::Correlator> correlator,
-                          const environet::core::Config& config) {
-    LOGI("WiFi scan thread started");
-    
-    while (!g_shutdown_requested.load()) {
-        try {
-            auto bss_list = wifi_scan->scan();
-            for (const auto& bss : bss_list) {
-                correlator->push_bss(bss);
-            }
-            LOGD("WiFi scan completed: {} networks found", bss_list.size());
-        } catch (const std::exception& e) {
-            LOGW("WiFi scan failed: {}", e.what());
+void scan_wifi(environet::net::WifiScan& wifi_scan, environet::correlate::Correlator& correlator) {
+    try {
+        std::vector<environet::net::BssInfo> bss_list;
+        {
+            TIMELINE_SCOPE("wifi.scan");
+            bss_list = wifi_scan.scan();
         }
-        
-        // Sleep for scan interval
-        std::this_thread::sleep_for(std::chrono::milliseconds(config.wifi.scan_interval_ms));
+        TIMELINE_SCOPE("correlator.push_bss");
+        for (const auto& bss : bss_list) {
+            correlator.push_bss(bss);
+        }
+        LOGD("WiFi scan completed: {} networks found", bss_list.size());
+    } catch (const std::exception& e) {
+        LOGW_RATELIMITED(60000, "WiFi scan failed: {}", e.what());
     }
-    
-    LOGI("WiFi scan thread stopped");
 }
 
-void pcap_thread_func(std::shared_ptr<environet::net::PcapSniffer> pcap_sniffer,
-                     std::shared_ptr<environet::correlate::Correlator> correlator) {
-    LOGI("PCAP thread started");
-    
+bool start_capture(std::shared_ptr<environet::net::PcapSniffer> pcap_sniffer,
+                   std::shared_ptr<environet::correlate::Correlator> correlator) {
     bool started = pcap_sniffer->start([correlator](const environet::net::PacketMeta& meta, const uint8_t* data) {
         (void)data; // Suppress unused parameter warning
+        TIMELINE_SCOPE("correlator.push_packet");
         correlator->push_packet(meta);
-        LOGD("Packet: {} -> {}, {} bytes", meta.src_mac, meta.dst_mac, meta.length);
+        LOGD_EVERY_N(1000, "Packet: {} -> {}, {} bytes", meta.src_mac, meta.dst_mac, meta.length);
     });
     
     if (!started) {
         LOGE("Failed to start PCAP capture");
-        return;
-    }
-    
-    // Wait for shutdown
-    while (!g_shutdown_requested.load()) {
-        std::this_thread::sleep_for(std::chrono::seconds(1));
+        return false;
     }
-    
-    LOGI("PCAP thread stopped");
+    LOGI("PCAP capture started");
+    return true;
 }
 
-void metrics_thread_func(std::shared_ptr<environet::net::Metrics> metrics,
-                        std::shared_ptr<environet::correlate::Correlator> correlator,
-                        const environet::core::Config& config) {
-    LOGI("Metrics thread started");
-    
-    while (!g_shutdown_requested.load()) {
-        try {
-            // Run ping tests
-            for (const auto& target : config.metrics.ping_targets) {
-                auto ping_stats = metrics->ping_test(target, 4);
-                correlator->push_ping_stats(ping_stats);
-                LOGD("Ping {}: avg={:.2f}ms, loss={:.1f}%", 
-                     target, ping_stats.avg_rtt_ms, ping_stats.loss_percentage);
-            }
-            
-            // Run iperf3 test if server is configured
-            if (!config.metrics.iperf_server.empty()) {
-                auto iperf_results = metrics->iperf3_test(config.metrics.iperf_server, 
-                                                        config.metrics.iperf3_duration);
-                correlator->push_iperf3_results(iperf_results);
-                if (iperf_results.success) {
-                    LOGD("iPerf3: {} Mbps", iperf_results.bandwidth_mbps);
-                }
-            }
-        } catch (const std::exception& e) {
-            LOGW("Metrics collection failed: {}", e.what());
+void collect_metrics(environet::net::Metrics& metrics, environet::correlate::Correlator& correlator,
+                     const environet::core::Config& config) {
+    try {
+        // Run ping tests
+        for (const auto& target : config.metrics.ping_targets) {
+            TIMELINE_SCOPE("metrics.ping");
+            auto ping_stats = metrics.ping_test(target, 4);
+            correlator.push_ping_stats(ping_stats);
+            LOGD("Ping {}: avg={:.2f}ms, loss={:.1f}%", 
+                 target, ping_stats.avg_rtt_ms, ping_stats.loss_percentage);
         }
         
-        // Sleep for metrics interval
-        std::this_thread::sleep_for(std::chrono::milliseconds(config.metrics.ping_interval_ms));
+        // Run iperf3 test if server is configured
+        if (!config.metrics.iperf_server.empty()) {
+            TIMELINE_SCOPE("metrics.iperf3");
+            auto iperf_results = metrics.iperf3_test(config.metrics.iperf_server, 
+                                                    config.metrics.iperf3_duration);
+            correlator.push_iperf3_results(iperf_results);
+            if (iperf_results.success) {
+                LOGD("iPerf3: {} Mbps", iperf_results.bandwidth_mbps);
+            }
+        }
+    } catch (const std::exception& e) {
+        LOGW("Metrics collection failed: {}", e.what());
     }
-    
-    LOGI("Metrics thread stopped");
 }
 
-void correlation_thread_func(std::shared_ptr<environet::correlate::Correlator> correlator) {
-    LOGI("Correlation thread started");
-    
-    while (!g_shutdown_requested.load()) {
-        try {
-            auto findings = correlator->process();
-            if (!findings.empty()) {
-                LOGI("Generated {} new findings", findings.size());
-            }
-        } catch (const std::exception& e) {
-            LOGW("Correlation processing failed: {}", e.what());
+void run_correlation(environet::correlate::Correlator& correlator) {
+    try {
+        size_t found = correlator.process();
+        if (found > 0) {
+            LOGI("Generated {} new findings", found);
         }
-        
-        // Process correlations every second
-        std::this_thread::sleep_for(std::chrono::seconds(1));
+    } catch (const std::exception& e) {
+        LOGW("Correlation processing failed: {}", e.what());
     }
-    
-    LOGI("Correlation thread stopped");
 }
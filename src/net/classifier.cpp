@@ -0,0 +1,310 @@
+#include "net/classifier.hpp"
+
+#include <cstdlib>
+#include <unordered_map>
+#include <arpa/inet.h>
+
+namespace environet {
+namespace net {
+
+namespace {
+
+// Parse a decimal number in [0, max]; the whole string must be consumed
+bool parse_uint(const std::string& text, long max, long& value) {
+    if (text.empty() || text.find_first_not_of("0123456789") != std::string::npos || text.size() > 6) {
+        return false;
+    }
+    value = std::strtol(text.c_str(), nullptr, 10);
+    return value <= max;
+}
+
+int hex_digit(char c) {
+    if (c >= '0' && c <= '9') return c - '0';
+    if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+    if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+    return -1;
+}
+
+inline int lowest_rule(uint64_t mask) {
+    return __builtin_ctzll(mask);
+}
+
+} // namespace
+
+PrefixTrie::PrefixTrie() : nodes_(1) {}
+
+void PrefixTrie::insert(const uint8_t* key, int bits, uint64_t rules) {
+    uint32_t node = 0;
+    int depth = 0;
+    while (true) {
+        uint8_t nibble = (key[depth / 8] >> (depth % 8 == 0 ? 4 : 0)) & 0xF;
+        int remaining = bits - depth;
+        if (remaining <= 4) {
+            // Prefix ends in this stride: mark every slot it covers
+            int free_bits = 4 - remaining;
+            uint8_t base = static_cast<uint8_t>(nibble & (0xF << free_bits) & 0xF);
+            for (int i = 0; i < (1 << free_bits); ++i) {
+                nodes_[node].rules[base | i] |= rules;
+            }
+            return;
+        }
+        if (nodes_[node].child[nibble] == 0) {
+            nodes_[node].child[nibble] = static_cast<uint32_t>(nodes_.size());
+            nodes_.emplace_back();
+        }
+        node = nodes_[node].child[nibble];
+        depth += 4;
+    }
+}
+
+uint64_t PrefixTrie::lookup(const uint8_t* key, int key_bits) const {
+    uint64_t rules = 0;
+    uint32_t node = 0;
+    for (int depth = 0; depth < key_bits; depth += 4) {
+        uint8_t nibble = (key[depth / 8] >> (depth % 8 == 0 ? 4 : 0)) & 0xF;
+        const Node& n = nodes_[node];
+        rules |= n.rules[nibble];
+        node = n.child[nibble];
+        if (node == 0) break;
+    }
+    return rules;
+}
+
+Classifier::Classifier() {
+    std::string error;
+    installed_ = compile({}, error);
+    generation_.store(1);
+}
+
+bool Classifier::load(const std::vector<core::Config::ClassRule>& rules) {
+    std::string error;
+    auto set = compile(rules, error);
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (!set) {
+        last_error_ = error;
+        return false;
+    }
+    installed_ = std::move(set);
+    generation_.fetch_add(1, std::memory_order_release);
+    return true;
+}
+
+uint16_t Classifier::classify(const PacketMeta& meta, const PacketLayers& layers) {
+    uint64_t generation = generation_.load(std::memory_order_acquire);
+    if (generation != active_generation_) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        active_ = installed_;
+        active_generation_ = generation;
+    }
+    uint16_t id = match(*active_, meta, layers);
+    active_->packets[id]->inc();
+    active_->bytes[id]->inc(meta.length);
+    return id;
+}
+
+uint16_t Classifier::match(const RuleSet& set, const PacketMeta& meta, const PacketLayers& layers) const {
+    if (set.rule_count == 0) return 0;
+    uint64_t mac = set.mac_any;
+    if (layers.src_mac) mac |= set.mac.lookup(layers.src_mac, 48);
+    if (layers.dst_mac) mac |= set.mac.lookup(layers.dst_mac, 48);
+
+    uint64_t ip = set.ip_any;
+    uint64_t port = set.port_any;
+    uint64_t protocol = set.protocol_any;
+    bool ipv4 = meta.ethertype == 0x0800, ipv6 = meta.ethertype == 0x86DD;
+    if (ipv4 || ipv6) {
+        const uint8_t* l3 = layers.network;
+        if (l3 && ipv4 && layers.network_len >= 20) {
+            ip |= set.ipv4.lookup(l3 + 12, 32) | set.ipv4.lookup(l3 + 16, 32);
+        } else if (l3 && ipv6 && layers.network_len >= 40) {
+            ip |= set.ipv6.lookup(l3 + 8, 128) | set.ipv6.lookup(l3 + 24, 128);
+        }
+        protocol |= set.protocol_rules[meta.protocol];
+        if ((meta.protocol == 6 || meta.protocol == 17) && !set.port_class.empty()) {
+            port |= set.port_rules[set.port_class[meta.src_port]] | set.port_rules[set.port_class[meta.dst_port]];
+        }
+    }
+
+    uint64_t rules = mac & ip & port & protocol;
+    return rules ? set.rule_class[lowest_rule(rules)] : 0;
+}
+
+std::shared_ptr<const Classifier::RuleSet> Classifier::compile(
+    const std::vector<core::Config::ClassRule>& rules, std::string& error) const {
+    if (rules.size() > MAX_RULES) {
+        error = "classifier supports at most " + std::to_string(MAX_RULES) + " rules";
+        return nullptr;
+    }
+    auto set = std::make_shared<RuleSet>();
+    set->rule_count = rules.size();
+    set->names.push_back("unclassified");
+
+    std::vector<uint64_t> port_masks;
+    for (size_t i = 0; i < rules.size(); ++i) {
+        const auto& rule = rules[i];
+        const uint64_t bit = 1ULL << i;
+        auto fail = [&](const char* what, const std::string& value) {
+            error = "rule '" + rule.name + "': invalid " + what + " '" + value + "'";
+            return nullptr;
+        };
+
+        uint16_t id = 0;
+        for (size_t c = 1; c < set->names.size(); ++c) {
+            if (set->names[c] == rule.name) id = static_cast<uint16_t>(c);
+        }
+        if (id == 0) {
+            id = static_cast<uint16_t>(set->names.size());
+            set->names.push_back(rule.name);
+        }
+        set->rule_class.push_back(id);
+
+        if (rule.macs.empty()) set->mac_any |= bit;
+        for (const auto& text : rule.macs) {
+            std::array<uint8_t, 6> mac{};
+            int bits = 0;
+            if (!parse_mac_prefix(text, mac, bits)) return fail("MAC prefix", text);
+            set->mac.insert(mac.data(), bits, bit);
+        }
+
+        if (rule.ips.empty()) set->ip_any |= bit;
+        for (const auto& text : rule.ips) {
+            std::array<uint8_t, 16> addr{};
+            int bits = 0;
+            bool v6 = false;
+            if (!parse_ip_prefix(text, addr, bits, v6)) return fail("IP prefix", text);
+            (v6 ? set->ipv6 : set->ipv4).insert(addr.data(), bits, bit);
+        }
+
+        if (rule.ports.empty()) set->port_any |= bit;
+        for (const auto& text : rule.ports) {
+            uint16_t lo = 0, hi = 0;
+            if (!parse_port_range(text, lo, hi)) return fail("port", text);
+            if (port_masks.empty()) port_masks.assign(65536, 0);
+            for (uint32_t p = lo; p <= hi; ++p) port_masks[p] |= bit;
+        }
+
+        if (rule.protocols.empty()) set->protocol_any |= bit;
+        for (int protocol : rule.protocols) {
+            if (protocol < 0 || protocol > 255) return fail("protocol", std::to_string(protocol));
+            set->protocol_rules[protocol] |= bit;
+        }
+    }
+
+    // Ports with the same rule mask share one entry: 128 KiB of indices
+    // instead of a 512 KiB mask per port
+    if (!port_masks.empty()) {
+        std::unordered_map<uint64_t, uint16_t> index;
+        set->port_class.resize(65536);
+        for (size_t p = 0; p < port_masks.size(); ++p) {
+            auto it = index.find(port_masks[p]);
+            if (it == index.end()) {
+                it = index.emplace(port_masks[p], static_cast<uint16_t>(set->port_rules.size())).first;
+                set->port_rules.push_back(port_masks[p]);
+            }
+            set->port_class[p] = it->second;
+        }
+    }
+
+    auto& registry = core::MetricsRegistry::instance();
+    for (const auto& name : set->names) {
+        set->packets.push_back(&registry.counter("environet_class_packets_total",
+                                                 "Packets per traffic class", {{"class", name}}));
+        set->bytes.push_back(&registry.counter("environet_class_bytes_total",
+                                               "Bytes per traffic class", {{"class", name}}));
+    }
+    return set;
+}
+
+std::vector<std::string> Classifier::class_names() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return installed_->names;
+}
+
+nlohmann::json Classifier::get_stats() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    nlohmann::json j;
+    j["rules"] = installed_->rule_count;
+    j["trie_nodes"] = installed_->mac.nodes() + installed_->ipv4.nodes() + installed_->ipv6.nodes();
+    j["classes"] = nlohmann::json::array();
+    for (size_t id = 0; id < installed_->names.size(); ++id) {
+        j["classes"].push_back({
+            {"id", id},
+            {"name", installed_->names[id]},
+            {"packets", installed_->packets[id]->value()},
+            {"bytes", installed_->bytes[id]->value()}
+        });
+    }
+    return j;
+}
+
+std::string Classifier::get_last_error() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return last_error_;
+}
+
+bool Classifier::parse_mac_prefix(const std::string& text, std::array<uint8_t, 6>& mac, int& bits) {
+    std::string addr = text;
+    long prefix = -1;
+    size_t slash = text.find('/');
+    if (slash != std::string::npos) {
+        addr = text.substr(0, slash);
+        if (!parse_uint(text.substr(slash + 1), 48, prefix)) return false;
+    }
+    // One to six hex byte groups separated by ':' or '-'
+    mac.fill(0);
+    size_t count = 0, pos = 0;
+    while (pos < addr.size()) {
+        if (count == 6 || pos + 2 > addr.size()) return false;
+        int hi = hex_digit(addr[pos]), lo = hex_digit(addr[pos + 1]);
+        if (hi < 0 || lo < 0) return false;
+        mac[count++] = static_cast<uint8_t>((hi << 4) | lo);
+        pos += 2;
+        if (pos < addr.size()) {
+            if (addr[pos] != ':' && addr[pos] != '-') return false;
+            if (++pos == addr.size()) return false;
+        }
+    }
+    if (count == 0) return false;
+    bits = prefix < 0 ? static_cast<int>(count * 8) : static_cast<int>(prefix);
+    return bits <= static_cast<int>(count * 8);
+}
+
+bool Classifier::parse_ip_prefix(const std::string& text, std::array<uint8_t, 16>& addr, int& bits, bool& v6) {
+    std::string host = text;
+    long prefix = -1;
+    size_t slash = text.find('/');
+    if (slash != std::string::npos) {
+        host = text.substr(0, slash);
+        if (!parse_uint(text.substr(slash + 1), 128, prefix)) return false;
+    }
+    addr.fill(0);
+    if (inet_pton(AF_INET, host.c_str(), addr.data()) == 1) {
+        v6 = false;
+        bits = prefix < 0 ? 32 : static_cast<int>(prefix);
+        return bits <= 32;
+    }
+    if (inet_pton(AF_INET6, host.c_str(), addr.data()) == 1) {
+        v6 = true;
+        bits = prefix < 0 ? 128 : static_cast<int>(prefix);
+        return true;
+    }
+    return false;
+}
+
+bool Classifier::parse_port_range(const std::string& text, uint16_t& lo, uint16_t& hi) {
+    long first = 0, last = 0;
+    size_t dash = text.find('-');
+    if (dash == std::string::npos) {
+        if (!parse_uint(text, 65535, first)) return false;
+        last = first;
+    } else if (!parse_uint(text.substr(0, dash), 65535, first) ||
+               !parse_uint(text.substr(dash + 1), 65535, last) || last < first) {
+        return false;
+    }
+    lo = static_cast<uint16_t>(first);
+    hi = static_cast<uint16_t>(last);
+    return true;
+}
+
+} // namespace net
+} // namespace environet
@@ -0,0 +1,20 @@
+#include "net/dissector.hpp"
+
+namespace environet {
+namespace net {
+
+Dissector dissector_for(int dlt) {
+    switch (dlt) {
+    case DLT_EN10MB: return &dissect<LinkType::EN10MB>;
+    case DLT_IEEE802_11_RADIO: return &dissect<LinkType::IEEE802_11_RADIO>;
+    case DLT_LINUX_SLL: return &dissect<LinkType::LINUX_SLL>;
+    case DLT_LINUX_SLL2: return &dissect<LinkType::LINUX_SLL2>;
+    case DLT_RAW:
+    case DLT_IPV4:
+    case DLT_IPV6: return &dissect<LinkType::RAW>;
+    default: return nullptr;
+    }
+}
+
+} // namespace net
+} // namespace environet
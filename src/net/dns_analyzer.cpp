@@ -0,0 +1,247 @@
+#include "net/dns_analyzer.hpp"
+
+#include "core/sketch.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+
+namespace environet {
+namespace net {
+
+namespace {
+
+core::Counter& responses(const char* rcode) {
+    return core::MetricsRegistry::instance().counter("environet_dns_responses_total",
+                                                     "DNS responses matched to a query", {{"rcode", rcode}});
+}
+
+// Client address, client port and transaction id; never 0 (the free-slot marker)
+uint64_t query_key(const uint8_t* addr, size_t addr_len, uint16_t port, uint16_t txid) {
+    uint8_t key[20];
+    std::memcpy(key, addr, addr_len);
+    std::memcpy(key + addr_len, &port, 2);
+    std::memcpy(key + addr_len + 2, &txid, 2);
+    uint64_t h = core::hash64(key, addr_len + 4);
+    return h ? h : 1;
+}
+
+} // namespace
+
+DnsAnalyzer::DnsAnalyzer(const std::string& config_path)
+    : DnsAnalyzer(core::Config::load_snapshot(config_path)) {}
+
+DnsAnalyzer::DnsAnalyzer(std::shared_ptr<const core::Config> config)
+    : enabled_(config->dns.enabled),
+      bucket_ms_(static_cast<uint64_t>(config->dns.bucket_ms)),
+      timeout_us_(static_cast<uint64_t>(config->dns.timeout_ms) * 1000),
+      mask_(config->dns.max_pending - 1),
+      queries_(core::MetricsRegistry::instance().counter(
+          "environet_dns_queries_total", "DNS queries seen on the capture interface")),
+      responses_noerror_(responses("noerror")),
+      responses_nxdomain_(responses("nxdomain")),
+      responses_servfail_(responses("servfail")),
+      responses_other_(responses("other")),
+      timeouts_(core::MetricsRegistry::instance().counter(
+          "environet_dns_timeouts_total", "DNS queries expired or evicted without a response")),
+      unmatched_(core::MetricsRegistry::instance().counter(
+          "environet_dns_unmatched_responses_total", "DNS responses with no pending query")),
+      latency_(core::MetricsRegistry::instance().histogram(
+          "environet_dns_response_seconds", "Time from DNS query to response", 1e-6)) {}
+
+bool DnsAnalyzer::init() {
+    if (!enabled_) return true;
+    std::lock_guard<std::mutex> lock(mutex_);
+    pending_.assign(mask_ + 1, Pending{});
+    current_.timestamp_ms = get_current_time_ms() / bucket_ms_ * bucket_ms_;
+    current_.interval_ms = static_cast<uint32_t>(bucket_ms_);
+    return true;
+}
+
+const uint8_t* DnsAnalyzer::dns_message(const PacketMeta& meta, const PacketLayers& layers, size_t& len) {
+    if (meta.src_port != 53 && meta.dst_port != 53) return nullptr;
+    if ((meta.protocol != 17 && meta.protocol != 6) || !layers.network || !layers.transport) return nullptr;
+    if (meta.ethertype != 0x0800 && meta.ethertype != 0x86DD) return nullptr;
+    const uint8_t* l4 = layers.transport;
+    size_t l4_len = layers.transport_len;
+    size_t offset;
+    if (meta.protocol == 17) {
+        offset = 8;
+    } else {
+        if (l4_len < 20) return nullptr;
+        offset = (l4[12] >> 4) * 4u;
+        // Only a segment holding exactly one whole message: continuations and
+        // segments carrying several messages would be misread without
+        // reassembly. The segment length comes from the IP header, so
+        // snaplen truncation and link padding do not matter.
+        const uint8_t* l3 = layers.network;
+        size_t datagram = meta.ethertype == 0x0800 ? detail::be16(l3 + 2) : 40u + detail::be16(l3 + 4);
+        size_t l4_start = static_cast<size_t>(l4 - l3);
+        if (offset < 20 || l4_len < offset + 2 || datagram < l4_start + offset + 2 ||
+            detail::be16(l4 + offset) != datagram - l4_start - offset - 2) {
+            return nullptr;
+        }
+        offset += 2;                                        // Two-byte message length prefix
+    }
+    if (l4_len < offset + 12) return nullptr;                // Header not captured (or TCP ack)
+    len = l4_len - offset;
+    return l4 + offset;
+}
+
+void DnsAnalyzer::process(uint64_t ts_us, const PacketMeta& meta, const PacketLayers& layers) {
+    if (meta.src_port != 53 && meta.dst_port != 53) return;
+    process_at(get_current_time_ms(), ts_us, meta, layers);
+}
+
+void DnsAnalyzer::process_at(uint64_t now_ms, uint64_t ts_us, const PacketMeta& meta, const PacketLayers& layers) {
+    if (!enabled_) return;
+    size_t len = 0;
+    const uint8_t* msg = dns_message(meta, layers, len);
+    if (!msg) return;
+    uint16_t txid = static_cast<uint16_t>((msg[0] << 8) | msg[1]);
+    bool response = msg[2] & 0x80;
+    uint8_t opcode = (msg[2] >> 3) & 0x0F;
+    uint8_t rcode = msg[3] & 0x0F;
+    if (opcode != 0) return;                                // Only standard queries
+
+    // The client is the source of a query and the destination of a response
+    bool v4 = meta.ethertype == 0x0800;
+    size_t addr_len = v4 ? 4 : 16;
+    const uint8_t* src = layers.network + (v4 ? 12 : 8);
+    const uint8_t* client = response ? src + addr_len : src;
+    uint16_t port = response ? meta.dst_port : meta.src_port;
+    uint64_t key = query_key(client, addr_len, port, txid);
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (pending_.empty()) return;
+    roll(now_ms);
+    last_ts_us_ = std::max(last_ts_us_, ts_us);
+    if (response) {
+        add_response(key, ts_us, rcode);
+    } else {
+        add_query(key, ts_us);
+    }
+}
+
+void DnsAnalyzer::add_query(uint64_t key, uint64_t ts_us) {
+    ++current_.queries;
+    queries_.inc();
+    Pending* slot = nullptr;
+    Pending* oldest = nullptr;
+    size_t home = key & mask_;
+    for (size_t i = 0; i < PROBE; ++i) {
+        Pending& p = pending_[(home + i) & mask_];
+        if (p.key == key) return;                           // Retransmission: keep the first send
+        if (p.key == 0 || p.ts_us + timeout_us_ < ts_us) {
+            if (!slot) slot = &p;
+        } else if (!oldest || p.ts_us < oldest->ts_us) {
+            oldest = &p;
+        }
+    }
+    if (!slot) slot = oldest;
+    if (slot->key != 0) {
+        // Expired or evicted: either way it was never answered
+        ++current_.timeouts;
+        timeouts_.inc();
+    } else {
+        ++pending_count_;
+    }
+    slot->key = key;
+    slot->ts_us = ts_us;
+}
+
+void DnsAnalyzer::add_response(uint64_t key, uint64_t ts_us, uint8_t rcode) {
+    size_t home = key & mask_;
+    for (size_t i = 0; i < PROBE; ++i) {
+        Pending& p = pending_[(home + i) & mask_];
+        if (p.key != key) continue;
+        uint64_t latency_us = ts_us > p.ts_us ? ts_us - p.ts_us : 0;
+        p.key = 0;
+        --pending_count_;
+        if (latency_us > timeout_us_) {
+            ++current_.timeouts;
+            timeouts_.inc();
+            return;
+        }
+        ++current_.responses;
+        current_.latency_sum_us += latency_us;
+        current_.latency_max_us = std::max(current_.latency_max_us, latency_us);
+        latency_.record(latency_us);
+        switch (rcode) {
+        case 0: responses_noerror_.inc(); break;
+        case 2: ++current_.servfail; responses_servfail_.inc(); break;
+        case 3: ++current_.nxdomain; responses_nxdomain_.inc(); break;
+        default: responses_other_.inc(); break;
+        }
+        return;
+    }
+    ++current_.unmatched;
+    unmatched_.inc();
+}
+
+void DnsAnalyzer::expire(uint64_t ts_us) {
+    if (pending_count_ == 0 || ts_us < timeout_us_) return;
+    uint64_t cutoff = ts_us - timeout_us_;
+    for (auto& p : pending_) {
+        if (p.key != 0 && p.ts_us < cutoff) {
+            p.key = 0;
+            --pending_count_;
+            ++current_.timeouts;
+            timeouts_.inc();
+        }
+    }
+}
+
+void DnsAnalyzer::roll(uint64_t now_ms) {
+    uint64_t start = now_ms / bucket_ms_ * bucket_ms_;
+    if (start <= current_.timestamp_ms) return;
+    // Sweep once per interval so queries nobody retries still time out
+    expire(last_ts_us_);
+    completed_.push_back(current_);
+    if (completed_.size() > MAX_SAMPLES) {
+        completed_.pop_front();
+        ++dropped_samples_;
+    }
+    current_ = DnsSample{};
+    current_.timestamp_ms = start;
+    current_.interval_ms = static_cast<uint32_t>(bucket_ms_);
+}
+
+size_t DnsAnalyzer::drain(uint64_t now_ms, std::vector<DnsSample>& out) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (pending_.empty()) return 0;
+    roll(now_ms);
+    size_t n = completed_.size();
+    out.insert(out.end(), completed_.begin(), completed_.end());
+    completed_.clear();
+    return n;
+}
+
+nlohmann::json DnsAnalyzer::get_stats() const {
+    nlohmann::json j;
+    j["enabled"] = enabled_;
+    if (!enabled_) return j;
+    auto summary = latency_.snapshot();
+    std::lock_guard<std::mutex> lock(mutex_);
+    j["queries"] = queries_.value();
+    j["responses"] = responses_noerror_.value() + responses_nxdomain_.value() + responses_servfail_.value() +
+                     responses_other_.value();
+    j["nxdomain"] = responses_nxdomain_.value();
+    j["servfail"] = responses_servfail_.value();
+    j["timeouts"] = timeouts_.value();
+    j["unmatched"] = unmatched_.value();
+    j["pending"] = pending_count_;
+    j["max_pending"] = mask_ + 1;
+    j["latency_avg_ms"] = summary.mean() / 1000.0;
+    j["latency_p99_ms"] = summary.percentile(0.99) / 1000.0;
+    j["dropped_samples"] = dropped_samples_;
+    return j;
+}
+
+uint64_t DnsAnalyzer::get_current_time_ms() {
+    using namespace std::chrono;
+    return duration_cast<milliseconds>(steady_clock::now().time_since_epoch()).count();
+}
+
+} // namespace net
+} // namespace environet
@@ -0,0 +1,494 @@
+#include "net/flow_export.hpp"
+
+#include "core/log.hpp"
+#include "core/sketch.hpp"
+
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <netdb.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+namespace environet {
+namespace net {
+
+namespace {
+
+// IANA information elements (NetFlow v9 field types where they differ)
+constexpr uint16_t IE_OCTET_DELTA_COUNT = 1;
+constexpr uint16_t IE_PACKET_DELTA_COUNT = 2;
+constexpr uint16_t IE_PROTOCOL = 4;
+constexpr uint16_t IE_TCP_FLAGS = 6;
+constexpr uint16_t IE_SRC_PORT = 7;
+constexpr uint16_t IE_SRC_IPV4 = 8;
+constexpr uint16_t IE_DST_PORT = 11;
+constexpr uint16_t IE_DST_IPV4 = 12;
+constexpr uint16_t IE_V9_LAST_SWITCHED = 21;
+constexpr uint16_t IE_V9_FIRST_SWITCHED = 22;
+constexpr uint16_t IE_SRC_IPV6 = 27;
+constexpr uint16_t IE_DST_IPV6 = 28;
+constexpr uint16_t IE_SRC_MAC = 56;
+constexpr uint16_t IE_DST_MAC = 80;
+constexpr uint16_t IE_FLOW_END_REASON = 136;
+constexpr uint16_t IE_FLOW_START_MS = 152;
+constexpr uint16_t IE_FLOW_END_MS = 153;
+
+constexpr uint16_t ENTERPRISE_BIT = 0x8000;
+constexpr size_t IPFIX_HEADER_SIZE = 16;
+constexpr size_t V9_HEADER_SIZE = 20;
+constexpr size_t SET_HEADER_SIZE = 4;
+constexpr uint8_t TCP_FIN = 0x01;
+constexpr uint8_t TCP_RST = 0x04;
+
+inline void put_be(uint8_t* out, uint64_t value, size_t bytes) {
+    for (size_t i = 0; i < bytes; ++i) out[i] = static_cast<uint8_t>(value >> (8 * (bytes - 1 - i)));
+}
+
+} // namespace
+
+FlowExporter::FlowExporter(const std::string& config_path)
+    : FlowExporter(core::Config::load_snapshot(config_path)) {}
+
+FlowExporter::FlowExporter(std::shared_ptr<const core::Config> config)
+    : enabled_(config->flow_export.enabled),
+      ipfix_(config->flow_export.protocol != "netflow9"),
+      host_(config->flow_export.collector_host),
+      port_(config->flow_export.collector_port),
+      domain_(config->flow_export.observation_domain),
+      enterprise_id_(config->flow_export.enterprise_id),
+      active_timeout_ms_(static_cast<uint64_t>(config->flow_export.active_timeout_ms)),
+      inactive_timeout_ms_(static_cast<uint64_t>(config->flow_export.inactive_timeout_ms)),
+      template_refresh_ms_(static_cast<uint64_t>(config->flow_export.template_refresh_ms)),
+      mask_(config->flow_export.max_flows - 1),
+      mtu_(config->flow_export.mtu),
+      records_exported_(core::MetricsRegistry::instance().counter(
+          "environet_flow_records_exported_total", "Flow records exported over IPFIX or NetFlow v9")),
+      messages_sent_(core::MetricsRegistry::instance().counter(
+          "environet_flow_export_datagrams_total", "Flow export datagrams sent")),
+      send_errors_(core::MetricsRegistry::instance().counter(
+          "environet_flow_export_errors_total", "Flow export datagrams that could not be sent")) {}
+
+FlowExporter::~FlowExporter() {
+    if (fd_ >= 0) ::close(fd_);
+}
+
+bool FlowExporter::init() {
+    if (!enabled_) return true;
+    std::lock_guard<std::mutex> lock(mutex_);
+    v4_ = make_template(IPV4_TEMPLATE_ID, false);
+    v6_ = make_template(IPV6_TEMPLATE_ID, true);
+    size_t template_set = SET_HEADER_SIZE + 3;
+    for (const Template* t : {&v4_, &v6_}) {
+        template_set += 4;
+        for (const auto& f : t->fields) template_set += 4 + (ipfix_ && f.enterprise ? 4 : 0);
+    }
+    size_t header = ipfix_ ? IPFIX_HEADER_SIZE : V9_HEADER_SIZE;
+    if (header + template_set + SET_HEADER_SIZE + v6_.record_size + 3 > mtu_) {
+        set_error("flow_export.mtu too small for templates and a record");
+        return false;
+    }
+
+    addrinfo hints{};
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_DGRAM;
+    addrinfo* res = nullptr;
+    int rc = getaddrinfo(host_.c_str(), std::to_string(port_).c_str(), &hints, &res);
+    if (rc != 0 || !res) {
+        set_error("Cannot resolve flow collector " + host_ + ": " + gai_strerror(rc));
+        return false;
+    }
+    if (fd_ >= 0) ::close(fd_);
+    fd_ = ::socket(res->ai_family, SOCK_DGRAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (fd_ < 0 || ::connect(fd_, res->ai_addr, res->ai_addrlen) != 0) {
+        set_error("Cannot open flow export socket to " + host_ + ":" + std::to_string(port_) + ": " +
+                  std::strerror(errno));
+        freeaddrinfo(res);
+        return false;
+    }
+    freeaddrinfo(res);
+
+    flows_.assign(mask_ + 1, Flow{});
+    active_flows_ = 0;
+    buf_.assign(mtu_, 0);
+    len_ = 0;
+    start_ms_ = get_current_time_ms();
+    clock_ms_ = start_ms_;
+    next_template_ms_ = 0;
+    return true;
+}
+
+FlowExporter::Template FlowExporter::make_template(uint16_t id, bool v6) const {
+    Template t;
+    t.id = id;
+    uint16_t addr = v6 ? 16 : 4;
+    t.fields = {
+        {v6 ? IE_SRC_IPV6 : IE_SRC_IPV4, addr, false},
+        {v6 ? IE_DST_IPV6 : IE_DST_IPV4, addr, false},
+        {IE_SRC_PORT, 2, false},
+        {IE_DST_PORT, 2, false},
+        {IE_PROTOCOL, 1, false},
+        {IE_TCP_FLAGS, static_cast<uint16_t>(ipfix_ ? 2 : 1), false},
+        {IE_SRC_MAC, 6, false},
+        {IE_DST_MAC, 6, false},
+        {IE_OCTET_DELTA_COUNT, 8, false},
+        {IE_PACKET_DELTA_COUNT, 8, false},
+    };
+    if (ipfix_) {
+        t.fields.push_back({IE_FLOW_START_MS, 8, false});
+        t.fields.push_back({IE_FLOW_END_MS, 8, false});
+        t.fields.push_back({IE_FLOW_END_REASON, 1, false});
+    } else {
+        t.fields.push_back({IE_V9_FIRST_SWITCHED, 4, false});
+        t.fields.push_back({IE_V9_LAST_SWITCHED, 4, false});
+    }
+    const std::pair<FlowEnterpriseIe, uint16_t> custom[] = {
+        {FlowEnterpriseIe::RssiAverage, 1},       {FlowEnterpriseIe::RssiMinimum, 1},
+        {FlowEnterpriseIe::RssiMaximum, 1},       {FlowEnterpriseIe::NoiseAverage, 1},
+        {FlowEnterpriseIe::ChannelFrequency, 2},  {FlowEnterpriseIe::TrafficClass, 2},
+        {FlowEnterpriseIe::SensorIrRaw, 2},       {FlowEnterpriseIe::SensorUltrasonicMm, 2},
+        {FlowEnterpriseIe::SensorStatus, 1},
+    };
+    for (const auto& [ie, length] : custom) t.fields.push_back({static_cast<uint16_t>(ie), length, true});
+    for (const auto& f : t.fields) t.record_size += f.length;
+    return t;
+}
+
+void FlowExporter::process(const PacketMeta& meta, const PacketLayers& layers) {
+    if (!enabled_) return;
+    const uint8_t* l3 = layers.network;
+    size_t l3_len = layers.network_len;
+    FlowKey key;
+    std::memset(&key, 0, sizeof(key));
+    // octetDeltaCount covers the IP header and payload only (RFC 7012), so
+    // take the datagram length from the IP header rather than the frame
+    uint32_t ip_bytes;
+    if (meta.ethertype == 0x0800 && l3 && l3_len >= 20 && (l3[0] >> 4) == 4) {
+        key.version = 4;
+        ip_bytes = (static_cast<uint32_t>(l3[2]) << 8) | l3[3];
+        std::memcpy(key.src, l3 + 12, 4);
+        std::memcpy(key.dst, l3 + 16, 4);
+    } else if (meta.ethertype == 0x86DD && l3 && l3_len >= 40 && (l3[0] >> 4) == 6) {
+        key.version = 6;
+        ip_bytes = 40 + ((static_cast<uint32_t>(l3[4]) << 8) | l3[5]);
+        std::memcpy(key.src, l3 + 8, 16);
+        std::memcpy(key.dst, l3 + 24, 16);
+    } else {
+        ++packets_ignored_;
+        return;
+    }
+    key.src_port = meta.src_port;
+    key.dst_port = meta.dst_port;
+    key.protocol = meta.protocol;
+    // The dissector locates TCP past any IPv6 extension headers
+    const uint8_t* l4 = layers.transport;
+    uint16_t tcp_flags = meta.protocol == 6 && l4 && layers.transport_len >= 14 ? l4[13] : 0;
+    uint64_t hash = core::hash64(&key, sizeof(key));
+    if (hash == 0) hash = 1;
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (flows_.empty()) return;
+    clock_ms_ = std::max(clock_ms_, meta.timestamp_ms);
+    Flow* free_slot = nullptr;
+    Flow* oldest = nullptr;
+    size_t home = hash & mask_;
+    for (size_t i = 0; i < PROBE; ++i) {
+        Flow& f = flows_[(home + i) & mask_];
+        if (f.hash == hash && std::memcmp(&f.key, &key, sizeof(key)) == 0) {
+            if (meta.timestamp_ms >= f.first_ms + active_timeout_ms_) {
+                // Long-lived: export what we have and continue in a fresh record
+                export_flow(f, FlowEndReason::Active);
+                start_flow(f, key, hash, meta, layers);
+            }
+            add_packet(f, meta, ip_bytes, tcp_flags);
+            return;
+        }
+        if (f.hash == 0) {
+            if (!free_slot) free_slot = &f;
+        } else if (!oldest || f.last_ms < oldest->last_ms) {
+            oldest = &f;
+        }
+    }
+    Flow* slot = free_slot;
+    if (!slot) {
+        slot = oldest;
+        export_flow(*slot, FlowEndReason::LackOfResources);
+    }
+    start_flow(*slot, key, hash, meta, layers);
+    add_packet(*slot, meta, ip_bytes, tcp_flags);
+}
+
+void FlowExporter::start_flow(Flow& flow, const FlowKey& key, uint64_t hash, const PacketMeta& meta,
+                              const PacketLayers& layers) {
+    flow = Flow{};
+    flow.hash = hash;
+    flow.key = key;
+    if (layers.src_mac) std::memcpy(flow.src_mac, layers.src_mac, 6);
+    if (layers.dst_mac) std::memcpy(flow.dst_mac, layers.dst_mac, 6);
+    flow.first_ms = meta.timestamp_ms;
+    flow.last_ms = meta.timestamp_ms;
+    flow.rssi_min = INT8_MAX;
+    flow.rssi_max = INT8_MIN;
+    ++active_flows_;
+    ++flows_created_;
+}
+
+void FlowExporter::add_packet(Flow& flow, const PacketMeta& meta, uint32_t ip_bytes, uint16_t tcp_flags) {
+    ++flow.packets;
+    flow.bytes += ip_bytes;
+    flow.last_ms = std::max(flow.last_ms, meta.timestamp_ms);
+    flow.tcp_flags |= tcp_flags;
+    if (tcp_flags & (TCP_FIN | TCP_RST)) flow.ended = true;
+    if (meta.class_id) flow.class_id = meta.class_id;
+    if (meta.signal_strength != 0) {
+        int8_t rssi = static_cast<int8_t>(std::clamp(meta.signal_strength, -128, 127));
+        flow.rssi_sum += rssi;
+        flow.noise_sum += std::clamp(meta.noise_level, -128, 127);
+        flow.rssi_min = std::min(flow.rssi_min, rssi);
+        flow.rssi_max = std::max(flow.rssi_max, rssi);
+        ++flow.radio_packets;
+        if (meta.frequency_mhz) flow.frequency_mhz = meta.frequency_mhz;
+    }
+}
+
+void FlowExporter::export_flow(Flow& flow, FlowEndReason reason) {
+    const Template& tmpl = flow.key.version == 4 ? v4_ : v6_;
+    if (len_ == 0) begin_message();
+    // NetFlow v9 sets are padded to four bytes when closed
+    size_t slack = ipfix_ ? 0 : 3;
+    if (len_ + tmpl.record_size + (set_id_ != tmpl.id ? SET_HEADER_SIZE : 0) + slack > mtu_) {
+        send_message();
+        begin_message();
+    }
+    if (set_id_ != tmpl.id) {
+        close_set();
+        set_start_ = len_;
+        set_id_ = tmpl.id;
+        put_be(&buf_[len_], tmpl.id, 2);
+        len_ += SET_HEADER_SIZE;
+    }
+    encode_record(&buf_[len_], tmpl, flow, reason);
+    len_ += tmpl.record_size;
+    ++message_records_;
+    ++message_data_records_;
+
+    flow.hash = 0;
+    --active_flows_;
+    ++records_;
+    ++reasons_[static_cast<size_t>(reason)];
+    records_exported_.inc();
+}
+
+void FlowExporter::encode_record(uint8_t* out, const Template& tmpl, const Flow& flow, FlowEndReason reason) const {
+    auto uptime = [this](uint64_t ms) { return ms > start_ms_ ? ms - start_ms_ : 0; };
+    bool radio = flow.radio_packets > 0;
+    for (const auto& f : tmpl.fields) {
+        uint64_t v = 0;
+        if (f.enterprise) {
+            switch (static_cast<FlowEnterpriseIe>(f.id)) {
+            case FlowEnterpriseIe::RssiAverage:
+                v = static_cast<uint8_t>(radio ? flow.rssi_sum / static_cast<int32_t>(flow.radio_packets) : 0);
+                break;
+            case FlowEnterpriseIe::RssiMinimum: v = static_cast<uint8_t>(radio ? flow.rssi_min : 0); break;
+            case FlowEnterpriseIe::RssiMaximum: v = static_cast<uint8_t>(radio ? flow.rssi_max : 0); break;
+            case FlowEnterpriseIe::NoiseAverage:
+                v = static_cast<uint8_t>(radio ? flow.noise_sum / static_cast<int32_t>(flow.radio_packets) : 0);
+                break;
+            case FlowEnterpriseIe::ChannelFrequency: v = flow.frequency_mhz; break;
+            case FlowEnterpriseIe::TrafficClass: v = flow.class_id; break;
+            case FlowEnterpriseIe::SensorIrRaw: v = static_cast<uint16_t>(sensor_ir_.load()); break;
+            case FlowEnterpriseIe::SensorUltrasonicMm: v = sensor_ultra_.load(); break;
+            case FlowEnterpriseIe::SensorStatus: v = sensor_status_.load(); break;
+            }
+            put_be(out, v, f.length);
+            out += f.length;
+            continue;
+        }
+        switch (f.id) {
+        case IE_SRC_IPV4:
+        case IE_SRC_IPV6: std::memcpy(out, flow.key.src, f.length); out += f.length; continue;
+        case IE_DST_IPV4:
+        case IE_DST_IPV6: std::memcpy(out, flow.key.dst, f.length); out += f.length; continue;
+        case IE_SRC_MAC: std::memcpy(out, flow.src_mac, 6); out += 6; continue;
+        case IE_DST_MAC: std::memcpy(out, flow.dst_mac, 6); out += 6; continue;
+        case IE_SRC_PORT: v = flow.key.src_port; break;
+        case IE_DST_PORT: v = flow.key.dst_port; break;
+        case IE_PROTOCOL: v = flow.key.protocol; break;
+        case IE_TCP_FLAGS: v = flow.tcp_flags; break;
+        case IE_OCTET_DELTA_COUNT: v = flow.bytes; break;
+        case IE_PACKET_DELTA_COUNT: v = flow.packets; break;
+        case IE_FLOW_START_MS: v = flow.first_ms; break;
+        case IE_FLOW_END_MS: v = flow.last_ms; break;
+        case IE_FLOW_END_REASON: v = static_cast<uint8_t>(reason); break;
+        case IE_V9_FIRST_SWITCHED: v = uptime(flow.first_ms); break;
+        case IE_V9_LAST_SWITCHED: v = uptime(flow.last_ms); break;
+        }
+        put_be(out, v, f.length);
+        out += f.length;
+    }
+}
+
+void FlowExporter::begin_message() {
+    len_ = ipfix_ ? IPFIX_HEADER_SIZE : V9_HEADER_SIZE;
+    set_start_ = 0;
+    set_id_ = 0;
+    message_records_ = 0;
+    message_data_records_ = 0;
+    if (next_template_ms_ == 0 || clock_ms_ >= next_template_ms_) append_templates();
+}
+
+void FlowExporter::append_templates() {
+    set_start_ = len_;
+    set_id_ = ipfix_ ? 2 : 0;
+    put_be(&buf_[len_], set_id_, 2);
+    len_ += SET_HEADER_SIZE;
+    for (const Template* t : {&v4_, &v6_}) {
+        put_be(&buf_[len_], t->id, 2);
+        put_be(&buf_[len_ + 2], t->fields.size(), 2);
+        len_ += 4;
+        for (const auto& f : t->fields) {
+            put_be(&buf_[len_], f.enterprise ? (ENTERPRISE_BIT | f.id) : f.id, 2);
+            put_be(&buf_[len_ + 2], f.length, 2);
+            len_ += 4;
+            if (ipfix_ && f.enterprise) {
+                put_be(&buf_[len_], enterprise_id_, 4);
+                len_ += 4;
+            }
+        }
+        ++message_records_;
+        ++templates_sent_;
+    }
+    close_set();
+    next_template_ms_ = clock_ms_ + template_refresh_ms_;
+}
+
+void FlowExporter::close_set() {
+    if (set_start_ == 0) return;
+    if (!ipfix_) {
+        while ((len_ - set_start_) % 4) buf_[len_++] = 0;
+    }
+    put_be(&buf_[set_start_ + 2], len_ - set_start_, 2);
+    set_start_ = 0;
+    set_id_ = 0;
+}
+
+void FlowExporter::send_message() {
+    if (len_ == 0) return;
+    close_set();
+    uint8_t* h = buf_.data();
+    if (ipfix_) {
+        put_be(h, 10, 2);
+        put_be(h + 2, len_, 2);
+        put_be(h + 4, clock_ms_ / 1000, 4);
+        put_be(h + 8, sequence_, 4);
+        put_be(h + 12, domain_, 4);
+        sequence_ += message_data_records_;     // Counts data records, not messages
+    } else {
+        put_be(h, 9, 2);
+        put_be(h + 2, message_records_, 2);
+        put_be(h + 4, clock_ms_ > start_ms_ ? clock_ms_ - start_ms_ : 0, 4);
+        put_be(h + 8, clock_ms_ / 1000, 4);
+        put_be(h + 12, sequence_++, 4);
+        put_be(h + 16, domain_, 4);
+    }
+    ssize_t n = ::send(fd_, h, len_, MSG_DONTWAIT | MSG_NOSIGNAL);
+    if (n < 0) {
+        ++errors_;
+        send_errors_.inc();
+        set_error(std::string("flow export send failed: ") + std::strerror(errno));
+        LOGW_RATELIMITED(60000, "Flow export to {}:{}: {}", host_, port_, get_last_error());
+        next_template_ms_ = 0;      // The templates may have been in the lost datagram
+    } else {
+        ++messages_;
+        bytes_sent_ += static_cast<uint64_t>(n);
+        messages_sent_.inc();
+    }
+    len_ = 0;
+    set_start_ = 0;
+    set_id_ = 0;
+    message_records_ = 0;
+    message_data_records_ = 0;
+}
+
+void FlowExporter::expire() {
+    expire_at(get_current_time_ms());
+}
+
+void FlowExporter::expire_at(uint64_t now_ms) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (flows_.empty()) return;
+    clock_ms_ = std::max(clock_ms_, now_ms);
+    if (active_flows_ > 0) {
+        for (auto& f : flows_) {
+            if (f.hash == 0) continue;
+            if (f.ended) {
+                export_flow(f, FlowEndReason::EndOfFlow);
+            } else if (now_ms >= f.last_ms + inactive_timeout_ms_) {
+                export_flow(f, FlowEndReason::Idle);
+            } else if (now_ms >= f.first_ms + active_timeout_ms_) {
+                export_flow(f, FlowEndReason::Active);
+            }
+        }
+    }
+    send_message();
+}
+
+void FlowExporter::flush() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (flows_.empty()) return;
+    for (auto& f : flows_) {
+        if (f.hash != 0) export_flow(f, FlowEndReason::Forced);
+    }
+    send_message();
+}
+
+void FlowExporter::set_sensor_context(int16_t ir_raw, uint16_t ultra_mm, uint8_t status) {
+    sensor_ir_.store(ir_raw, std::memory_order_relaxed);
+    sensor_ultra_.store(ultra_mm, std::memory_order_relaxed);
+    sensor_status_.store(status, std::memory_order_relaxed);
+}
+
+nlohmann::json FlowExporter::get_stats() const {
+    nlohmann::json j;
+    j["enabled"] = enabled_;
+    if (!enabled_) return j;
+    std::lock_guard<std::mutex> lock(mutex_);
+    j["protocol"] = ipfix_ ? "ipfix" : "netflow9";
+    j["collector"] = host_ + ":" + std::to_string(port_);
+    j["flows_active"] = active_flows_;
+    j["max_flows"] = mask_ + 1;
+    j["flows_created"] = flows_created_;
+    j["records"] = records_;
+    j["records_by_reason"] = {
+        {"idle", reasons_[static_cast<size_t>(FlowEndReason::Idle)]},
+        {"active", reasons_[static_cast<size_t>(FlowEndReason::Active)]},
+        {"end_of_flow", reasons_[static_cast<size_t>(FlowEndReason::EndOfFlow)]},
+        {"forced", reasons_[static_cast<size_t>(FlowEndReason::Forced)]},
+        {"lack_of_resources", reasons_[static_cast<size_t>(FlowEndReason::LackOfResources)]},
+    };
+    j["templates_sent"] = templates_sent_;
+    j["datagrams"] = messages_;
+    j["bytes_sent"] = bytes_sent_;
+    j["send_errors"] = errors_;
+    j["packets_ignored"] = packets_ignored_.load();
+    return j;
+}
+
+std::string FlowExporter::get_last_error() const {
+    std::lock_guard<std::mutex> lock(error_mutex_);
+    return last_error_;
+}
+
+void FlowExporter::set_error(const std::string& error) {
+    std::lock_guard<std::mutex> lock(error_mutex_);
+    last_error_ = error;
+}
+
+uint64_t FlowExporter::get_current_time_ms() {
+    using namespace std::chrono;
+    return duration_cast<milliseconds>(system_clock::now().time_since_epoch()).count();
+}
+
+} // namespace net
+} // namespace environet
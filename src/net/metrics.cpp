@@ -10,9 +10,20 @@
 
 namespace environet { namespace net {
 
-Metrics::Metrics(const std::string& /*config_path*/)
-    : ping_interval_ms_(10000), iperf3_duration_(10), ping_tests_run_(0), iperf3_tests_run_(0),
-      ping_errors_(0), iperf3_errors_(0), start_time_ms_(0) {}
+Metrics::Metrics(const std::string& config_path)
+    : Metrics(core::Config::load_snapshot(config_path)) {}
+
+Metrics::Metrics(std::shared_ptr<const core::Config> config)
+    : ping_interval_ms_(config->metrics.ping_interval_ms), iperf3_duration_(config->metrics.iperf3_duration),
+      ping_tests_run_(core::MetricsRegistry::instance().counter(
+          "environet_ping_tests_total", "Ping tests run")),
+      iperf3_tests_run_(core::MetricsRegistry::instance().counter(
+          "environet_iperf3_tests_total", "iperf3 tests run")),
+      ping_errors_(core::MetricsRegistry::instance().counter(
+          "environet_ping_errors_total", "Ping tests that failed or found the target unreachable")),
+      iperf3_errors_(core::MetricsRegistry::instance().counter(
+          "environet_iperf3_errors_total", "iperf3 tests that failed")),
+      start_time_ms_(0) {}
 
 Metrics::~Metrics() {}
 
@@ -22,17 +33,17 @@ bool Metrics::init() {
 }
 
 PingStats Metrics::ping_test(const std::string& target, int count, int timeout_ms) {
-    ++ping_tests_run_;
+    ping_tests_run_.inc();
     PingStats ps; ps.target = target; ps.timestamp_ms = get_current_time_ms();
 
 #ifndef __linux__
     set_error("ping not implemented on this platform in current build");
-    ++ping_errors_;
+    ping_errors_.inc();
     return ps;
 #else
     if (!check_ping_available()) {
         set_error("ping command not found");
-        ++ping_errors_;
+        ping_errors_.inc();
         return ps;
     }
 
@@ -44,7 +55,7 @@ PingStats Metrics::ping_test(const std::string& target, int count, int timeout_m
     std::string out = execute_command(cmd.str());
     PingStats parsed = parse_ping_output(out, target);
     if (!parsed.reachable) {
-        ++ping_errors_;
+        ping_errors_.inc();
     }
     return parsed;
 #endif
@@ -58,22 +69,22 @@ std::vector<PingStats> Metrics::ping_multiple(const std::vector<std::string>& ta
 }
 
 Iperf3Results Metrics::iperf3_test(const std::string& server, int duration, const std::string& protocol, int port) {
-    ++iperf3_tests_run_;
+    iperf3_tests_run_.inc();
     Iperf3Results r; r.server = server; r.duration_seconds = duration; r.protocol = protocol; r.timestamp_ms = get_current_time_ms();
 
 #ifndef __linux__
     set_error("iperf3 not implemented on this platform in current build");
-    ++iperf3_errors_;
+    iperf3_errors_.inc();
     return r;
 #else
     if (server.empty()) {
         set_error("iperf3 server not configured");
-        ++iperf3_errors_;
+        iperf3_errors_.inc();
         return r;
     }
     if (!check_iperf3_available()) {
         set_error("iperf3 command not found");
-        ++iperf3_errors_;
+        iperf3_errors_.inc();
         return r;
     }
 
@@ -87,7 +98,7 @@ Iperf3Results Metrics::iperf3_test(const std::string& server, int duration, cons
     std::string out = execute_command(cmd.str());
     Iperf3Results parsed = parse_iperf3_output(out, server);
     if (!parsed.success) {
-        ++iperf3_errors_;
+        iperf3_errors_.inc();
     }
     return parsed;
 #endif
@@ -95,10 +106,10 @@ Iperf3Results Metrics::iperf3_test(const std::string& server, int duration, cons
 
 nlohmann::json Metrics::get_stats() const {
     nlohmann::json j;
-    j["ping_tests_run"] = ping_tests_run_;
-    j["iperf3_tests_run"] = iperf3_tests_run_;
-    j["ping_errors"] = ping_errors_;
-    j["iperf3_errors"] = iperf3_errors_;
+    j["ping_tests_run"] = ping_tests_run_.value();
+    j["iperf3_tests_run"] = iperf3_tests_run_.value();
+    j["ping_errors"] = ping_errors_.value();
+    j["iperf3_errors"] = iperf3_errors_.value();
     return j;
 }
 
@@ -1,40 +1,39 @@
 #include "net/pcap_sniffer.hpp"
 #include "core/log.hpp"
+#include "core/latency.hpp"
+#include "core/thread_placement.hpp"
+#include "core/timeline.hpp"
+#include "core/trace_log.hpp"
 
 #include <cstring>
 #include <chrono>
 #include <filesystem>
-#include <fstream>
-#include <arpa/inet.h>
 #include <atomic>
 
 namespace fs = std::filesystem;
 namespace environet { namespace net {
 
 PcapSniffer::PcapSniffer(const std::string& config_path)
-    : interface_("wlan0"), bpf_filter_(""), output_dir_("captures"), max_file_size_mb_(100),
-      max_files_(10), promiscuous_(true), pcap_handle_(nullptr), pcap_dumper_(nullptr),
-      running_(false), packets_captured_(0), packets_dropped_(0), bytes_captured_(0),
-      start_time_ms_(0), file_index_(0) {
-    // Load minimal fields from config json if available
-    try {
-        std::ifstream in(config_path);
-        if (in.is_open()) {
-            nlohmann::json j; in >> j;
-            if (j.contains("pcap")) {
-                auto &p = j["pcap"];
-                if (p.contains("bpf")) bpf_filter_ = p["bpf"].get<std::string>();
-                if (p.contains("output_dir")) output_dir_ = p["output_dir"].get<std::string>();
-                if (p.contains("max_file_size_mb")) max_file_size_mb_ = p["max_file_size_mb"].get<size_t>();
-                if (p.contains("max_files")) max_files_ = p["max_files"].get<int>();
-            }
-            if (j.contains("wifi")) {
-                auto &w = j["wifi"];
-                if (w.contains("iface_scan")) interface_ = w["iface_scan"].get<std::string>();
-            }
-        }
-    } catch (...) {
-        // ignore config parse errors; keep defaults
+    : PcapSniffer(core::Config::load_snapshot(config_path)) {}
+
+PcapSniffer::PcapSniffer(std::shared_ptr<const core::Config> config)
+    : interface_(config->wifi.iface_scan), bpf_filter_(config->pcap.bpf), output_dir_(config->pcap.output_dir),
+      max_file_size_mb_(config->pcap.max_file_size_mb), max_files_(config->pcap.max_files), promiscuous_(true),
+      pcap_handle_(nullptr), pcap_dumper_(nullptr), throughput_(config->wifi.iface_scan),
+      numa_node_(config->threads.numa_node), running_(false),
+      packets_captured_(core::MetricsRegistry::instance().counter(
+          "environet_pcap_packets_captured_total", "Packets captured by the sniffer")),
+      packets_dropped_(core::MetricsRegistry::instance().counter(
+          "environet_pcap_packets_dropped_total", "Packets dropped by the kernel or libpcap")),
+      bytes_captured_(core::MetricsRegistry::instance().counter(
+          "environet_pcap_bytes_captured_total", "Bytes captured by the sniffer")),
+      process_packet_latency_(core::latency_histogram(
+          "environet_pcap_process_packet_seconds", "Time spent parsing and dispatching one packet")),
+      start_time_ms_(0) {
+    if (classifier_.load(config->classifier.rules)) {
+        class_rules_ = config->classifier.rules;
+    } else {
+        LOGW("Packet classification disabled: {}", classifier_.get_last_error());
     }
 }
 
@@ -54,11 +53,24 @@ bool PcapSniffer::init() {
 
 bool PcapSniffer::start(PacketCallback callback) {
     packet_callback_ = std::move(callback);
-    if (!init_interface()) return false;
-    if (!compile_bpf()) return false;
+    int node = numa_node_ >= 0 ? numa_node_ : core::ThreadPlacement::interface_numa_node(interface_);
+    {
+        std::lock_guard<std::mutex> lock(handle_mutex_);
+        // The kernel allocates the capture ring under the opening thread's
+        // memory policy, so open the handle preferring the NIC's node
+        bool preferred = node >= 0 && core::ThreadPlacement::set_memory_node(node);
+        capture_node_.store(preferred ? node : -1);
+        bool opened = init_interface() && compile_bpf();
+        if (preferred) core::ThreadPlacement::set_memory_node(-1);
+        if (!opened) return false;
+    }
     if (!open_pcap_file()) return false;
 
     running_ = true;
+    {
+        std::lock_guard<std::mutex> lock(filter_mutex_);
+        capture_active_ = true;
+    }
     capture_thread_ = std::thread([this]() { capture_loop(); });
     return true;
 }
@@ -73,9 +85,14 @@ void PcapSniffer::stop() {
 
 nlohmann::json PcapSniffer::get_stats() const {
     nlohmann::json j;
-    j["packets_captured"] = packets_captured_;
-    j["packets_dropped"] = packets_dropped_;
-    j["bytes_captured"] = bytes_captured_;
+    j["packets_captured"] = packets_captured_.value();
+    j["packets_dropped"] = packets_dropped_.value();
+    j["bytes_captured"] = bytes_captured_.value();
+    j["numa_node"] = capture_node_.load();
+    j["datalink"] = datalink_;
+    j["classifier"] = classifier_.get_stats();
+    j["throughput"] = throughput_.get_stats();
+    j["process_packet_latency"] = core::latency_summary(process_packet_latency_);
     return j;
 }
 
@@ -86,14 +103,75 @@ bool PcapSniffer::init_interface() {
         set_error(std::string("pcap_open_live failed: ") + errbuf);
         return false;
     }
-    datalink_ = pcap_datalink(pcap_handle_);
+    if (!set_datalink(pcap_datalink(pcap_handle_))) {
+        LOGW("Datalink {} on {} has no dissector; packets are captured but not parsed",
+             datalink_, interface_);
+    }
+    std::array<uint8_t, 6> mac{};
+    if (ThroughputMeter::read_interface_mac(interface_, mac)) {
+        throughput_.set_local_mac(mac.data());
+    } else {
+        LOGD("No hardware address for {}; throughput is not split by direction", interface_);
+    }
     return true;
 }
 
+bool PcapSniffer::set_datalink(int dlt) {
+    datalink_ = dlt;
+    dissector_ = dissector_for(dlt);
+    return dissector_ != nullptr;
+}
+
+bool PcapSniffer::set_bpf_filter(const std::string& filter) {
+    std::lock_guard<std::mutex> lock(handle_mutex_);
+    std::unique_lock<std::mutex> request_lock(filter_mutex_);
+    if (!capture_active_) {
+        // No reader on the handle; install it here
+        if (pcap_handle_ && !install_bpf(filter)) return false;
+        bpf_filter_ = filter;
+        return true;
+    }
+    // libpcap handles are not thread-safe: the capture thread swaps the
+    // filter between reads, woken from pcap_next_ex() by pcap_breakloop()
+    pending_filter_ = filter;
+    filter_request_ = FilterRequest::Pending;
+    pcap_breakloop(pcap_handle_);
+    filter_cv_.wait(request_lock, [this]() { return filter_request_ != FilterRequest::Pending; });
+    bool ok = filter_request_ == FilterRequest::Applied;
+    filter_request_ = FilterRequest::None;
+    if (ok) bpf_filter_ = filter;
+    return ok;
+}
+
+void PcapSniffer::apply_pending_filter() {
+    std::lock_guard<std::mutex> lock(filter_mutex_);
+    if (filter_request_ != FilterRequest::Pending) return;
+    filter_request_ = install_bpf(pending_filter_) ? FilterRequest::Applied : FilterRequest::Failed;
+    filter_cv_.notify_all();
+}
+
+bool PcapSniffer::apply_config(const core::Config& cfg) {
+    bool ok = true;
+    if (cfg.classifier.rules != class_rules_) {
+        if (classifier_.load(cfg.classifier.rules)) {
+            class_rules_ = cfg.classifier.rules;
+        } else {
+            set_error("classifier: " + classifier_.get_last_error());
+            ok = false;
+        }
+    }
+    if (cfg.pcap.bpf != bpf_filter_ && !set_bpf_filter(cfg.pcap.bpf)) ok = false;
+    return ok;
+}
+
 bool PcapSniffer::compile_bpf() {
     if (bpf_filter_.empty()) return true; // nothing to do
+    return install_bpf(bpf_filter_);
+}
+
+bool PcapSniffer::install_bpf(const std::string& filter) {
     bpf_program prog{};
-    if (pcap_compile(pcap_handle_, &prog, bpf_filter_.c_str(), 1, PCAP_NETMASK_UNKNOWN) < 0) {
+    if (pcap_compile(pcap_handle_, &prog, filter.c_str(), 1, PCAP_NETMASK_UNKNOWN) < 0) {
         set_error(std::string("pcap_compile failed: ") + pcap_geterr(pcap_handle_));
         return false;
     }
@@ -153,15 +231,19 @@ void PcapSniffer::rotate_pcap_file() {
 }
 
 void PcapSniffer::capture_loop() {
-    const pcap_pkthdr* header = nullptr;
+    if (!core::ThreadPlacement::instance().apply("capture", capture_node_.load())) {
+        LOGW("{}", core::ThreadPlacement::instance().get_last_error());
+    }
+    pcap_pkthdr* header = nullptr;
     const u_char* data = nullptr;
     while (running_ && pcap_handle_) {
+        apply_pending_filter();
         int rc = pcap_next_ex(pcap_handle_, &header, &data);
         if (rc == 1 && header && data) {
             // Write to pcap file
             if (pcap_dumper_) pcap_dump(reinterpret_cast<u_char*>(pcap_dumper_), header, data);
-            bytes_captured_ += header->caplen;
-            packets_captured_++;
+            bytes_captured_.inc(header->caplen);
+            packets_captured_.inc();
             try {
                 if (!current_pcap_file_.empty()) {
                     auto sz = fs::file_size(current_pcap_file_);
@@ -171,7 +253,7 @@ void PcapSniffer::capture_loop() {
                     }
                 }
             } catch (const std::exception& e) {
-                LOGE("Error during file size check or rotation: {}", e.what());
+                LOGE_RATELIMITED(10000, "Error during file size check or rotation: {}", e.what());
             }
             // Process packet
             if (packet_callback_) {
@@ -184,8 +266,8 @@ void PcapSniffer::capture_loop() {
             set_error(std::string("pcap_next_ex error: ") + pcap_geterr(pcap_handle_));
             break;
         } else if (rc == -2) {
-            // breakloop
-            break;
+            // breakloop: stop() or a filter swap, which the loop head applies
+            continue;
         }
     }
     close_pcap_file();
@@ -193,95 +275,87 @@ void PcapSniffer::capture_loop() {
     if (pcap_handle_) {
         struct pcap_stat ps{};
         if (pcap_stats(pcap_handle_, &ps) == 0) {
-            packets_dropped_ += ps.ps_drop;
+            packets_dropped_.inc(ps.ps_drop);
+        }
+    }
+    {
+        // Requests posted from here on install directly; fail one caught in between
+        std::lock_guard<std::mutex> lock(filter_mutex_);
+        capture_active_ = false;
+        if (filter_request_ == FilterRequest::Pending) {
+            set_error("capture stopped before the filter was applied");
+            filter_request_ = FilterRequest::Failed;
+            filter_cv_.notify_all();
         }
     }
     cleanup();
 }
 
+void PcapSniffer::set_packet_callback(PacketCallback callback) {
+    packet_callback_ = std::move(callback);
+}
+
+void PcapSniffer::inject_packet(const pcap_pkthdr* header, const uint8_t* packet) {
+    bytes_captured_.inc(header->caplen);
+    packets_captured_.inc();
+    if (packet_callback_) process_packet(header, packet);
+}
+
 void PcapSniffer::process_packet(const pcap_pkthdr* header, const uint8_t* packet) {
+    core::ScopedLatency timer(process_packet_latency_);
+    TIMELINE_SCOPE("pcap.process_packet");
     PacketMeta meta;
     meta.timestamp_ms = static_cast<uint64_t>(header->ts.tv_sec) * 1000ULL + header->ts.tv_usec / 1000ULL;
     meta.length = header->len;
-
-    const uint8_t* cursor = packet;
-    // Attempt Ethernet first
-    if (!parse_ethernet_header(cursor, meta)) {
-        // Some WLAN captures with radiotap may not start with Ethernet
-        parse_radiotap_header(cursor, meta); // best-effort
+    PacketLayers layers;
+    if (dissector_) dissector_(packet, header->caplen, meta, layers);
+    meta.class_id = classifier_.classify(meta, layers);
+    if (accounting_) accounting_->record(meta, layers);
+    throughput_.record(layers, meta.length);
+    if (dns_) {
+        dns_->process(static_cast<uint64_t>(header->ts.tv_sec) * 1000000ULL + header->ts.tv_usec, meta, layers);
     }
+    if (flows_) flows_->process(meta, layers);
+    if (core::TraceLog::instance().enabled()) trace_packet(meta, layers);
     if (packet_callback_) packet_callback_(meta, packet);
 }
 
-static std::string hex2(const uint8_t* p, size_t n) {
-    static const char* hexd = "0123456789abcdef";
-    std::string s; s.reserve(n * 3);
-    for (size_t i = 0; i < n; ++i) {
-        s.push_back(hexd[(p[i] >> 4) & 0xF]);
-        s.push_back(hexd[p[i] & 0xF]);
-        if (i + 1 < n) s.push_back(':');
+void PcapSniffer::trace_packet(const PacketMeta& meta, const PacketLayers& layers) {
+    auto& trace = core::TraceLog::instance();
+    core::TraceRecord* rec = trace.begin(core::TraceEventType::Packet);
+    if (!rec) return;
+    auto& p = rec->packet;
+    p.length = meta.length;
+    p.ethertype = meta.ethertype;
+    p.protocol = meta.protocol;
+    p.src_port = meta.src_port;
+    p.dst_port = meta.dst_port;
+    p.signal_dbm = static_cast<int16_t>(meta.signal_strength);
+    // Copy addresses from the frame rather than re-parsing the strings
+    if (layers.dst_mac) std::memcpy(p.dst_mac, layers.dst_mac, 6);
+    if (layers.src_mac) std::memcpy(p.src_mac, layers.src_mac, 6);
+    const uint8_t* ip = layers.network;
+    if (ip && meta.ethertype == 0x0800 && layers.network_len >= 20) {
+        p.ip_version = 4;
+        std::memcpy(p.src_ip, ip + 12, 4);
+        std::memcpy(p.dst_ip, ip + 16, 4);
+    } else if (ip && meta.ethertype == 0x86DD && layers.network_len >= 40) {
+        p.ip_version = 6;
+        std::memcpy(p.src_ip, ip + 8, 16);
+        std::memcpy(p.dst_ip, ip + 24, 16);
     }
-    return s;
+    trace.commit();
 }
 
-bool PcapSniffer::parse_ethernet_header(const uint8_t* packet, PacketMeta& meta) {
-    if (!packet) return false;
-    const uint8_t* dst = packet;
-    const uint8_t* src = packet + 6;
-    uint16_t type = (packet[12] << 8) | packet[13];
-    meta.dst_mac = hex2(dst, 6);
-    meta.src_mac = hex2(src, 6);
-    meta.ethertype = type;
-
-    const uint8_t* payload = packet + 14;
-    if (type == 0x0800) {
-        // IPv4
-        parse_ip_header(payload, meta);
-    } else if (type == 0x86DD) {
-        // IPv6 (basic parsing)
-        meta.protocol = payload[6];
-        meta.src_ip = ip_to_string(payload + 8, 6);
-        meta.dst_ip = ip_to_string(payload + 24, 6);
-    }
-    return true;
-}
-
-bool PcapSniffer::parse_ip_header(const uint8_t* packet, PacketMeta& meta) {
-    if (!packet) return false;
-    uint8_t ver_ihl = packet[0];
-    uint8_t ihl = (ver_ihl & 0x0F) * 4;
-    if (ihl < 20) return false;
-    meta.protocol = packet[9];
-    meta.src_ip = ip_to_string(packet + 12, 4);
-    meta.dst_ip = ip_to_string(packet + 16, 4);
-    const uint8_t* l4 = packet + ihl;
-    if (meta.protocol == 6) parse_tcp_header(l4, meta);
-    else if (meta.protocol == 17) parse_udp_header(l4, meta);
-    return true;
-}
-
-bool PcapSniffer::parse_tcp_header(const uint8_t* packet, PacketMeta& meta) {
-    if (!packet) return false;
-    meta.src_port = (packet[0] << 8) | packet[1];
-    meta.dst_port = (packet[2] << 8) | packet[3];
-    return true;
-}
-
-bool PcapSniffer::parse_udp_header(const uint8_t* packet, PacketMeta& meta) {
-    if (!packet) return false;
-    meta.src_port = (packet[0] << 8) | packet[1];
-    meta.dst_port = (packet[2] << 8) | packet[3];
-    return true;
-}
-
-bool PcapSniffer::parse_radiotap_header(const uint8_t* /*packet*/, PacketMeta& /*meta*/) {
-    // Placeholder: radiotap parsing can be added later for RSSI
-    return false;
+bool PcapSniffer::parse_packet(const uint8_t* packet, uint32_t caplen, PacketMeta& meta) {
+    PacketLayers layers;
+    return dissect<LinkType::EN10MB>(packet, caplen, meta, layers);
 }
 
 void PcapSniffer::set_error(const std::string& e) { last_error_ = e; }
 
 void PcapSniffer::cleanup() {
+    std::lock_guard<std::mutex> lock(handle_mutex_);
     if (pcap_handle_) {
         pcap_close(pcap_handle_);
         pcap_handle_ = nullptr;
@@ -293,16 +367,4 @@ uint64_t PcapSniffer::get_current_time_ms() {
     return duration_cast<milliseconds>(steady_clock::now().time_since_epoch()).count();
 }
 
-std::string PcapSniffer::mac_to_string(const uint8_t* mac) { return hex2(mac, 6); }
-
-std::string PcapSniffer::ip_to_string(const uint8_t* ip, int version) {
-    char buf[INET6_ADDRSTRLEN] = {};
-    if (version == 4) {
-        inet_ntop(AF_INET, ip, buf, sizeof(buf));
-    } else {
-        inet_ntop(AF_INET6, ip, buf, sizeof(buf));
-    }
-    return std::string(buf);
-}
-
 }} // namespace
@@ -0,0 +1,135 @@
+#include "net/throughput.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <thread>
+
+namespace environet {
+namespace net {
+
+ThroughputMeter::ThroughputMeter(std::string interface)
+    : interface_(std::move(interface)), next_bucket_(get_current_time_ms() / BUCKET_MS) {}
+
+void ThroughputMeter::set_local_mac(const uint8_t* mac) {
+    std::memcpy(local_mac_.data(), mac, local_mac_.size());
+    has_local_mac_.store(true, std::memory_order_release);
+}
+
+bool ThroughputMeter::read_interface_mac(const std::string& interface, std::array<uint8_t, 6>& mac) {
+    if (interface.empty() || interface.find('/') != std::string::npos) return false;
+    std::ifstream f("/sys/class/net/" + interface + "/address");
+    std::string text;
+    if (!(f >> text)) return false;
+    unsigned int b[6];
+    if (std::sscanf(text.c_str(), "%2x:%2x:%2x:%2x:%2x:%2x", &b[0], &b[1], &b[2], &b[3], &b[4], &b[5]) != 6) {
+        return false;
+    }
+    for (size_t i = 0; i < 6; ++i) mac[i] = static_cast<uint8_t>(b[i]);
+    // Loopback and tunnels report an all-zero address
+    return std::any_of(mac.begin(), mac.end(), [](uint8_t v) { return v != 0; });
+}
+
+Direction ThroughputMeter::direction(const PacketLayers& layers) const {
+    if (!has_local_mac_.load(std::memory_order_acquire)) return Direction::Other;
+    if (layers.src_mac && std::memcmp(layers.src_mac, local_mac_.data(), 6) == 0) return Direction::Tx;
+    if (layers.dst_mac && ((layers.dst_mac[0] & 0x01) || std::memcmp(layers.dst_mac, local_mac_.data(), 6) == 0)) {
+        return Direction::Rx;
+    }
+    return Direction::Other;
+}
+
+void ThroughputMeter::record(const PacketLayers& layers, uint32_t bytes) {
+    record_at(get_current_time_ms(), direction(layers), bytes);
+}
+
+void ThroughputMeter::record_at(uint64_t now_ms, Direction direction, uint32_t bytes) {
+    const uint64_t id = now_ms / BUCKET_MS;
+    Slot& slot = shards_[core::metric_shard_index()].slots[id % RING];
+    for (;;) {
+        uint64_t held = slot.id.load(std::memory_order_acquire);
+        if (held == id) break;
+        if (held == RECYCLING) {                        // Another writer is resetting it
+            std::this_thread::yield();
+            continue;
+        }
+        if (held != UINT64_MAX && held > id) return;   // Older than the ring
+        // Several writer threads can share a shard: the one that claims the
+        // slot resets it, and the old id is invalidated before the counters
+        // are zeroed, so drain() never reads a half-reset bucket
+        if (!slot.id.compare_exchange_strong(held, RECYCLING, std::memory_order_acq_rel)) continue;
+        for (size_t d = 0; d < 3; ++d) {
+            slot.bytes[d].store(0, std::memory_order_relaxed);
+            slot.packets[d].store(0, std::memory_order_relaxed);
+        }
+        slot.id.store(id, std::memory_order_release);
+        break;
+    }
+    const size_t d = static_cast<size_t>(direction);
+    slot.bytes[d].fetch_add(bytes, std::memory_order_relaxed);
+    slot.packets[d].fetch_add(1, std::memory_order_relaxed);
+}
+
+size_t ThroughputMeter::drain(uint64_t now_ms, std::vector<ThroughputSample>& out) {
+    std::lock_guard<std::mutex> lock(drain_mutex_);
+    const uint64_t current = now_ms / BUCKET_MS;
+    if (current <= next_bucket_) return 0;
+    // Buckets older than the ring have been overwritten
+    if (current - next_bucket_ > RING - 1) {
+        skipped_buckets_ += current - next_bucket_ - (RING - 1);
+        next_bucket_ = current - (RING - 1);
+    }
+    const size_t first = out.size();
+    for (uint64_t id = next_bucket_; id < current; ++id) {
+        ThroughputSample& sample = out.emplace_back();
+        sample.interface = interface_;
+        sample.timestamp_ms = id * BUCKET_MS;
+        sample.interval_ms = static_cast<uint32_t>(BUCKET_MS);
+        for (const auto& shard : shards_) {
+            const Slot& slot = shard.slots[id % RING];
+            if (slot.id.load(std::memory_order_acquire) != id) continue;
+            uint64_t bytes[3], packets[3];
+            for (size_t d = 0; d < 3; ++d) {
+                bytes[d] = slot.bytes[d].load(std::memory_order_relaxed);
+                packets[d] = slot.packets[d].load(std::memory_order_relaxed);
+            }
+            // Recycled while being read: the bucket is gone
+            if (slot.id.load(std::memory_order_acquire) != id) continue;
+            for (size_t d = 0; d < 3; ++d) {
+                sample.bytes[d] += bytes[d];
+                sample.packets[d] += packets[d];
+            }
+        }
+        for (size_t d = 0; d < 3; ++d) {
+            drained_bytes_[d] += sample.bytes[d];
+            drained_packets_[d] += sample.packets[d];
+        }
+    }
+    next_bucket_ = current;
+    return out.size() - first;
+}
+
+nlohmann::json ThroughputMeter::get_stats() const {
+    std::lock_guard<std::mutex> lock(drain_mutex_);
+    nlohmann::json j;
+    j["interface"] = interface_;
+    j["bucket_ms"] = BUCKET_MS;
+    j["local_mac_known"] = has_local_mac_.load();
+    const char* names[] = {"rx", "tx", "other"};
+    for (size_t d = 0; d < 3; ++d) {
+        j[std::string(names[d]) + "_bytes"] = drained_bytes_[d];
+        j[std::string(names[d]) + "_packets"] = drained_packets_[d];
+    }
+    j["skipped_buckets"] = skipped_buckets_;
+    return j;
+}
+
+uint64_t ThroughputMeter::get_current_time_ms() {
+    using namespace std::chrono;
+    return duration_cast<milliseconds>(steady_clock::now().time_since_epoch()).count();
+}
+
+} // namespace net
+} // namespace environet
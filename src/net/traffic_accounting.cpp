@@ -0,0 +1,298 @@
+#include "net/traffic_accounting.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+
+namespace environet {
+namespace net {
+
+namespace {
+
+size_t index_of(TrafficKey key) { return static_cast<size_t>(key); }
+
+} // namespace
+
+TrafficAccounting::Devices::Devices(int precision) : all(precision), channel(MAX_CHANNELS, core::HyperLogLog(precision)) {}
+
+void TrafficAccounting::Devices::add(uint64_t hash, uint16_t frequency_mhz) {
+    all.add(hash);
+    if (frequency_mhz == 0) return;
+    for (size_t i = 0; i < MAX_CHANNELS; ++i) {
+        if (frequency[i] == 0) frequency[i] = frequency_mhz;
+        if (frequency[i] == frequency_mhz) {
+            channel[i].add(hash);
+            return;
+        }
+    }
+}
+
+void TrafficAccounting::Devices::clear() {
+    all.clear();
+    for (size_t i = 0; i < MAX_CHANNELS && frequency[i] != 0; ++i) channel[i].clear();
+    frequency.fill(0);
+}
+
+void TrafficAccounting::Devices::merge(const Devices& other) {
+    all.merge(other.all);
+    for (size_t o = 0; o < MAX_CHANNELS && other.frequency[o] != 0; ++o) {
+        for (size_t i = 0; i < MAX_CHANNELS; ++i) {
+            if (frequency[i] == 0) frequency[i] = other.frequency[o];
+            if (frequency[i] == other.frequency[o]) {
+                channel[i].merge(other.channel[o]);
+                break;
+            }
+        }
+    }
+}
+
+TrafficAccounting::Bucket::Bucket(size_t width, size_t depth, size_t top_k, int precision) : devices(precision) {
+    volume.reserve(KEYS);
+    heavy.reserve(KEYS);
+    for (size_t i = 0; i < KEYS; ++i) {
+        volume.emplace_back(width, depth);
+        heavy.emplace_back(top_k);
+    }
+}
+
+void TrafficAccounting::Bucket::clear() {
+    id = UINT64_MAX;
+    packets = 0;
+    bytes = 0;
+    for (auto& v : volume) v.clear();
+    for (auto& h : heavy) h.clear();
+    devices.clear();
+}
+
+void TrafficAccounting::Bucket::merge(const Bucket& other) {
+    packets += other.packets;
+    bytes += other.bytes;
+    for (size_t i = 0; i < KEYS; ++i) {
+        volume[i].merge(other.volume[i]);
+        heavy[i].merge(other.heavy[i]);
+    }
+    devices.merge(other.devices);
+}
+
+TrafficAccounting::TrafficAccounting(const std::string& config_path)
+    : TrafficAccounting(core::Config::load_snapshot(config_path)) {}
+
+TrafficAccounting::TrafficAccounting(std::shared_ptr<const core::Config> config)
+    : enabled_(config->accounting.enabled),
+      bucket_ms_(static_cast<uint64_t>(config->accounting.bucket_ms)),
+      buckets_(static_cast<size_t>(config->accounting.buckets)),
+      top_k_(config->accounting.top_k),
+      sketch_width_(config->accounting.sketch_width),
+      sketch_depth_(config->accounting.sketch_depth),
+      device_precision_(config->accounting.device_precision) {}
+
+bool TrafficAccounting::init() {
+    if (!enabled_) return true;
+    std::lock_guard<std::mutex> lock(query_mutex_);
+    before_ = std::make_unique<Bucket>(sketch_width_, sketch_depth_, top_k_, device_precision_);
+    after_ = std::make_unique<Bucket>(sketch_width_, sketch_depth_, top_k_, device_precision_);
+    devices_ = std::make_unique<Devices>(device_precision_);
+    return true;
+}
+
+void TrafficAccounting::record(const PacketMeta& meta, const PacketLayers& layers) {
+    if (enabled_) record_at(get_current_time_ms(), meta, layers);
+}
+
+void TrafficAccounting::record_at(uint64_t now_ms, const PacketMeta& meta, const PacketLayers& layers) {
+    if (!enabled_) return;
+    uint64_t id = now_ms / bucket_ms_;
+    Shard& shard = shards_[core::metric_shard_index()];
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    if (shard.ring.empty()) {
+        shard.ring.reserve(buckets_);
+        for (size_t i = 0; i < buckets_; ++i) {
+            shard.ring.emplace_back(sketch_width_, sketch_depth_, top_k_, device_precision_);
+        }
+    }
+    Bucket& bucket = shard.ring[id % buckets_];
+    if (bucket.id != id) {
+        bucket.clear();
+        bucket.id = id;
+    }
+    ++bucket.packets;
+    bucket.bytes += meta.length;
+
+    auto account = [&bucket, &meta](TrafficKey key, const uint8_t* addr, size_t len, const std::string& text) {
+        uint64_t hash = core::hash64(addr, len);
+        bucket.volume[index_of(key)].add(hash, meta.length);
+        bucket.heavy[index_of(key)].add(hash, text.data(), text.size(), meta.length);
+        return hash;
+    };
+    if (layers.src_mac) {
+        uint64_t hash = account(TrafficKey::SrcMac, layers.src_mac, 6, meta.src_mac);
+        // Group addresses are never a transmitter; count only unicast sources as devices
+        if (!(layers.src_mac[0] & 0x01)) bucket.devices.add(hash, meta.frequency_mhz);
+    }
+    if (layers.dst_mac) account(TrafficKey::DstMac, layers.dst_mac, 6, meta.dst_mac);
+    // The dissector formats addresses only for headers it accepted
+    if (layers.network && !meta.src_ip.empty()) {
+        bool v6 = meta.ethertype == 0x86DD;
+        size_t len = v6 ? 16 : 4;
+        const uint8_t* src = layers.network + (v6 ? 8 : 12);
+        account(TrafficKey::SrcIp, src, len, meta.src_ip);
+        account(TrafficKey::DstIp, src + len, len, meta.dst_ip);
+    }
+}
+
+bool TrafficAccounting::bucket_range(uint64_t start_time, uint64_t end_time, uint64_t& first, uint64_t& last) const {
+    if (end_time <= start_time) return false;
+    first = start_time / bucket_ms_;
+    last = (end_time - 1) / bucket_ms_;
+    if (last - first >= buckets_) first = last - buckets_ + 1;
+    return true;
+}
+
+void TrafficAccounting::collect(Bucket& out, uint64_t start_time, uint64_t end_time) const {
+    out.clear();
+    uint64_t first = 0, last = 0;
+    if (!bucket_range(start_time, end_time, first, last)) return;
+    for (auto& shard : shards_) {
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        if (shard.ring.empty()) continue;
+        for (uint64_t id = first; id <= last; ++id) {
+            const Bucket& bucket = shard.ring[id % buckets_];
+            if (bucket.id == id) out.merge(bucket);
+        }
+    }
+}
+
+void TrafficAccounting::collect_devices(Devices& out, uint64_t start_time, uint64_t end_time) const {
+    out.clear();
+    uint64_t first = 0, last = 0;
+    if (!bucket_range(start_time, end_time, first, last)) return;
+    for (auto& shard : shards_) {
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        if (shard.ring.empty()) continue;
+        for (uint64_t id = first; id <= last; ++id) {
+            const Bucket& bucket = shard.ring[id % buckets_];
+            if (bucket.id == id) out.merge(bucket.devices);
+        }
+    }
+}
+
+DeviceCount TrafficAccounting::devices(uint64_t start_time, uint64_t end_time) const {
+    DeviceCount count;
+    if (!enabled_) return count;
+    std::lock_guard<std::mutex> lock(query_mutex_);
+    if (!devices_) return count;
+    collect_devices(*devices_, start_time, end_time);
+    count.devices = devices_->all.estimate();
+    for (size_t i = 0; i < MAX_CHANNELS && devices_->frequency[i] != 0; ++i) {
+        count.channels.push_back(ChannelDevices{devices_->frequency[i], devices_->channel[i].estimate()});
+    }
+    std::sort(count.channels.begin(), count.channels.end(),
+              [](const ChannelDevices& a, const ChannelDevices& b) { return a.frequency_mhz < b.frequency_mhz; });
+    return count;
+}
+
+std::vector<HeavyHitter> TrafficAccounting::top(TrafficKey key, uint64_t start_time, uint64_t end_time,
+                                                size_t k) const {
+    std::vector<HeavyHitter> hitters;
+    if (!enabled_) return hitters;
+    std::lock_guard<std::mutex> lock(query_mutex_);
+    if (!before_) return hitters;
+    collect(*before_, start_time, end_time);
+    const auto& volume = before_->volume[index_of(key)];
+    for (const auto& e : before_->heavy[index_of(key)].entries()) {
+        // Both are upper bounds; the smaller one is tighter
+        uint64_t bytes = std::min(e.count, volume.estimate(e.hash));
+        uint64_t floor = e.count - e.error;
+        hitters.push_back(HeavyHitter{e.key, bytes, bytes > floor ? bytes - floor : 0});
+    }
+    std::sort(hitters.begin(), hitters.end(),
+              [](const HeavyHitter& a, const HeavyHitter& b) { return a.bytes > b.bytes; });
+    if (hitters.size() > k) hitters.resize(k);
+    return hitters;
+}
+
+size_t TrafficAccounting::host_shifts(HostKind kind, uint64_t start_time, uint64_t split_time, uint64_t end_time,
+                                      std::pmr::vector<HostShift>& out) const {
+    if (!enabled_) return 0;
+    std::lock_guard<std::mutex> lock(query_mutex_);
+    if (!before_) return 0;
+    collect(*before_, start_time, split_time);
+    collect(*after_, split_time, end_time);
+    const size_t sent = index_of(kind == HostKind::Mac ? TrafficKey::SrcMac : TrafficKey::SrcIp);
+    const size_t received = sent + 1;
+
+    const size_t first = out.size();
+    auto volume = [sent, received](const Bucket& b, uint64_t hash) {
+        return b.volume[sent].estimate(hash) + b.volume[received].estimate(hash);
+    };
+    for (const Bucket* b : {before_.get(), after_.get()}) {
+        for (size_t key : {sent, received}) {
+            for (const auto& e : b->heavy[key].entries()) {
+                auto seen = std::find_if(out.begin() + static_cast<std::ptrdiff_t>(first), out.end(),
+                                         [&e](const HostShift& s) { return s.hash == e.hash; });
+                if (seen != out.end()) continue;
+                HostShift& shift = out.emplace_back();
+                shift.hash = e.hash;
+                std::memcpy(shift.host, e.key, sizeof(shift.host));
+                shift.before_bytes = volume(*before_, e.hash);
+                shift.after_bytes = volume(*after_, e.hash);
+            }
+        }
+    }
+    auto magnitude = [](const HostShift& s) {
+        return s.after_bytes > s.before_bytes ? s.after_bytes - s.before_bytes : s.before_bytes - s.after_bytes;
+    };
+    std::sort(out.begin() + static_cast<std::ptrdiff_t>(first), out.end(),
+              [&magnitude](const HostShift& a, const HostShift& b) { return magnitude(a) > magnitude(b); });
+    return out.size() - first;
+}
+
+size_t TrafficAccounting::bucket_bytes() const {
+    size_t heavy = top_k_ * 2 * sizeof(core::SpaceSaving::Entry);
+    size_t counters = sketch_width_ * sketch_depth_ * sizeof(uint64_t);
+    size_t registers = (1 + MAX_CHANNELS) * (size_t{1} << device_precision_);
+    return sizeof(Bucket) + KEYS * (heavy + counters) + registers;
+}
+
+nlohmann::json TrafficAccounting::get_stats() const {
+    nlohmann::json j;
+    j["enabled"] = enabled_;
+    if (!enabled_) return j;
+    size_t active = 0;
+    for (auto& shard : shards_) {
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        if (!shard.ring.empty()) ++active;
+    }
+    j["bucket_ms"] = bucket_ms_;
+    j["buckets"] = buckets_;
+    j["capture_threads"] = active;
+    j["memory_bytes"] = (active * buckets_ + 2) * bucket_bytes();
+    j["device_precision"] = device_precision_;
+
+    // Top talkers over the retained history
+    uint64_t now = get_current_time_ms();
+    uint64_t span = bucket_ms_ * buckets_;
+    uint64_t start = now > span ? now - span : 0;
+    auto list = [](const std::vector<HeavyHitter>& hitters) {
+        nlohmann::json a = nlohmann::json::array();
+        for (const auto& h : hitters) a.push_back({{"host", h.host}, {"bytes", h.bytes}, {"error", h.error}});
+        return a;
+    };
+    j["top_src_mac"] = list(top(TrafficKey::SrcMac, start, now + 1, 5));
+    j["top_dst_mac"] = list(top(TrafficKey::DstMac, start, now + 1, 5));
+    j["top_src_ip"] = list(top(TrafficKey::SrcIp, start, now + 1, 5));
+    j["top_dst_ip"] = list(top(TrafficKey::DstIp, start, now + 1, 5));
+    auto count = devices(start, now + 1);
+    j["unique_devices"] = count.devices;
+    j["channel_devices"] = nlohmann::json::object();
+    for (const auto& c : count.channels) j["channel_devices"][std::to_string(c.frequency_mhz)] = c.devices;
+    return j;
+}
+
+uint64_t TrafficAccounting::get_current_time_ms() {
+    using namespace std::chrono;
+    return duration_cast<milliseconds>(steady_clock::now().time_since_epoch()).count();
+}
+
+} // namespace net
+} // namespace environet
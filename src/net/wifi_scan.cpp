@@ -1,12 +1,27 @@
 #include "net/wifi_scan.hpp"
 #include "core/config.hpp"
 #include "core/log.hpp"
+#include "core/latency.hpp"
+#include "core/trace_log.hpp"
+
+#include <cstdio>
+#include <cstring>
 
 namespace environet { namespace net {
 
-WifiScan::WifiScan(const std::string& /*config_path*/)
-    : iface_scan_("wlan0"), iface_ap_("wlan1"), scan_interval_ms_(5000), monitor_mode_(false),
-      nl_sock_(nullptr), nl_cache_(nullptr), nl_family_(0), scan_count_(0), scan_errors_(0) {}
+WifiScan::WifiScan(const std::string& config_path)
+    : WifiScan(core::Config::load_snapshot(config_path)) {}
+
+WifiScan::WifiScan(std::shared_ptr<const core::Config> config)
+    : iface_scan_(config->wifi.iface_scan), iface_ap_(config->wifi.iface_ap),
+      scan_interval_ms_(config->wifi.scan_interval_ms), monitor_mode_(config->wifi.monitor_mode),
+      nl_sock_(nullptr), nl_cache_(nullptr), nl_family_(0),
+      scan_count_(core::MetricsRegistry::instance().counter(
+          "environet_wifi_scans_total", "WiFi scans performed")),
+      scan_errors_(core::MetricsRegistry::instance().counter(
+          "environet_wifi_scan_errors_total", "WiFi scans that failed")),
+      scan_latency_(core::latency_histogram(
+          "environet_wifi_scan_seconds", "Time spent performing one WiFi scan")) {}
 
 WifiScan::~WifiScan() { cleanup_libnl(); }
 
@@ -26,9 +41,10 @@ bool WifiScan::init() {
 }
 
 std::vector<BssInfo> WifiScan::scan() {
+    core::ScopedLatency timer(scan_latency_);
 #ifndef __linux__
     last_scan_results_.clear();
-    ++scan_count_;
+    scan_count_.inc();
     return last_scan_results_;
 #else
     // Try libnl path first (not yet implemented), then fallback to `iw`
@@ -37,17 +53,39 @@ std::vector<BssInfo> WifiScan::scan() {
         results = scan_fallback();
     }
     last_scan_results_ = std::move(results);
-    ++scan_count_;
+    scan_count_.inc();
+    if (core::TraceLog::instance().enabled()) trace_results(last_scan_results_);
     return last_scan_results_;
 #endif
 }
 
+void WifiScan::trace_results(const std::vector<BssInfo>& results) {
+    auto& trace = core::TraceLog::instance();
+    for (const auto& bss : results) {
+        core::TraceRecord* rec = trace.begin(core::TraceEventType::Bss);
+        if (!rec) return;
+        auto& b = rec->bss;
+        b.signal_mbm = bss.signal_mbm;
+        b.freq = bss.freq;
+        b.channel = static_cast<int16_t>(bss.channel);
+        unsigned int mac[6] = {};
+        if (std::sscanf(bss.bssid.c_str(), "%x:%x:%x:%x:%x:%x",
+                        &mac[0], &mac[1], &mac[2], &mac[3], &mac[4], &mac[5]) == 6) {
+            for (int i = 0; i < 6; ++i) b.bssid[i] = static_cast<uint8_t>(mac[i]);
+        }
+        std::strncpy(b.ssid, bss.ssid.c_str(), sizeof(b.ssid) - 1);
+        b.connected = bss.is_connected ? 1 : 0;
+        trace.commit();
+    }
+}
+
 BssInfo WifiScan::get_connected_network() { return BssInfo(); }
 
 nlohmann::json WifiScan::get_scan_stats() const {
     nlohmann::json j;
-    j["scan_count"] = scan_count_;
-    j["scan_errors"] = scan_errors_;
+    j["scan_count"] = scan_count_.value();
+    j["scan_errors"] = scan_errors_.value();
+    j["scan_latency"] = core::latency_summary(scan_latency_);
     return j;
 }
 
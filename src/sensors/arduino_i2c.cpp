@@ -1,6 +1,8 @@
 #include "sensors/arduino_i2c.hpp"
 #include "core/log.hpp"
 #include "core/config.hpp"
+#include "core/latency.hpp"
+#include "core/trace_log.hpp"
 
 #include <cmath>
 #include <cstring>
@@ -21,16 +23,25 @@ namespace sensors {
 static constexpr uint16_t CRC16_POLY = 0x1021;
 static constexpr uint16_t CRC16_INIT = 0xFFFF;
 
+static core::Histogram& read_frame_histogram() {
+    return core::latency_histogram("environet_sensor_read_frame_seconds",
+                                   "Time spent reading one sensor frame (excluding cadence wait)");
+}
+
 ArduinoI2C::ArduinoI2C(const environet::core::Config& cfg)
     : mock_mode_(cfg.i2c.mock_mode),
       bus_id_(cfg.i2c.bus_id),
       addr_(cfg.i2c.addr),
       sample_interval_ms_(cfg.i2c.sample_interval_ms),
       fd_(-1),
-      mock_timestamp_(0) {}
+      mock_timestamp_(0),
+      read_frame_latency_(read_frame_histogram()) {}
+
+ArduinoI2C::ArduinoI2C(std::shared_ptr<const environet::core::Config> cfg) : ArduinoI2C(*cfg) {}
 
 ArduinoI2C::ArduinoI2C(const std::string& config_path)
-    : mock_mode_(true), bus_id_(1), addr_(16), sample_interval_ms_(100), fd_(-1), mock_timestamp_(0) {
+    : mock_mode_(true), bus_id_(1), addr_(16), sample_interval_ms_(100), fd_(-1), mock_timestamp_(0),
+      read_frame_latency_(read_frame_histogram()) {
     try {
         auto cfg = environet::core::Config::load(config_path);
         mock_mode_ = cfg.i2c.mock_mode;
@@ -94,15 +105,24 @@ bool ArduinoI2C::init_mock_i2c() {
 }
 
 bool ArduinoI2C::read_frame(SensorFrame& frame) {
-    if (mock_mode_) {
-        return read_frame_mock(frame);
+    bool ok = mock_mode_ ? read_frame_mock(frame) : read_frame_real(frame);
+    if (ok && core::TraceLog::instance().enabled()) {
+        auto& trace = core::TraceLog::instance();
+        if (core::TraceRecord* rec = trace.begin(core::TraceEventType::Sensor)) {
+            rec->sensor.ts_ms = frame.ts_ms;
+            rec->sensor.ir_raw = frame.ir_raw;
+            rec->sensor.ultra_mm = frame.ultra_mm;
+            rec->sensor.status = frame.status;
+            trace.commit();
+        }
     }
-    return read_frame_real(frame);
+    return ok;
 }
 
 bool ArduinoI2C::read_frame_real(SensorFrame& frame) {
     // Enforce sampling cadence similar to mock
     wait_for_sample_interval(true);
+    core::ScopedLatency timer(read_frame_latency_);
 
 #ifndef __linux__
     (void)frame;
@@ -167,6 +187,16 @@ bool ArduinoI2C::read_frame_real(SensorFrame& frame) {
 #endif
 }
 
+void ArduinoI2C::apply_config(const environet::core::Config& cfg) {
+    sample_interval_ms_.store(cfg.i2c.sample_interval_ms);
+}
+
+nlohmann::json ArduinoI2C::get_stats() const {
+    nlohmann::json j;
+    j["read_frame_latency"] = core::latency_summary(read_frame_latency_);
+    return j;
+}
+
 void ArduinoI2C::stop() {
     if (!mock_mode_ && fd_ >= 0) {
         ::close(fd_);
@@ -201,8 +231,9 @@ void ArduinoI2C::generate_mock_frame(SensorFrame& frame) {
     bool enforce = (mock_reads_ < 5);
     ++mock_reads_;
     wait_for_sample_interval(enforce);
+    core::ScopedLatency timer(read_frame_latency_);
 
-    mock_timestamp_ += static_cast<uint32_t>(sample_interval_ms_);
+    mock_timestamp_ += static_cast<uint32_t>(sample_interval_ms_.load());
     frame.ts_ms = mock_timestamp_;
 
     // Deterministic pseudo-random sensors
@@ -246,7 +277,7 @@ void ArduinoI2C::wait_for_sample_interval(bool enforce_sleep) {
     using namespace std::chrono;
     auto now = steady_clock::now();
     if (enforce_sleep) {
-        auto next_time = last_sample_ + milliseconds(sample_interval_ms_);
+        auto next_time = last_sample_ + milliseconds(sample_interval_ms_.load());
         if (now < next_time) {
             std::this_thread::sleep_until(next_time);
         }
@@ -0,0 +1,113 @@
+#include <cstring>
+#include <ctime>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "core/trace_log.hpp"
+
+using environet::core::TraceEventType;
+using environet::core::TraceReader;
+using environet::core::TraceRecord;
+
+static void print_usage(const char* argv0) {
+    std::cout << "Usage: " << argv0 << " [options] <trace-file>...\n"
+              << "Decode EnviroNet binary event traces\n\n"
+              << "Options:\n"
+              << "  --json          Print one JSON object per record (NDJSON)\n"
+              << "  --type TYPE     Only print records of TYPE (packet, sensor, bss, finding)\n"
+              << "  --summary       Print per-type record counts only\n"
+              << "  --help          Show this help message\n";
+}
+
+static std::string format_time(uint64_t realtime_ns) {
+    time_t secs = static_cast<time_t>(realtime_ns / 1000000000ULL);
+    struct tm tm_buf;
+    gmtime_r(&secs, &tm_buf);
+    char date[32];
+    std::strftime(date, sizeof(date), "%Y-%m-%dT%H:%M:%S", &tm_buf);
+    char out[48];
+    std::snprintf(out, sizeof(out), "%s.%06uZ", date, static_cast<unsigned>((realtime_ns % 1000000000ULL) / 1000));
+    return out;
+}
+
+static void print_text(const TraceRecord& record, uint64_t realtime_ns) {
+    auto j = environet::core::trace_record_to_json(record, realtime_ns);
+    std::cout << format_time(realtime_ns) << " t" << record.thread << " #" << record.seq << ' '
+              << environet::core::trace_event_name(record.type);
+    for (auto it = j.begin(); it != j.end(); ++it) {
+        if (it.key() == "type" || it.key() == "ts_ns" || it.key() == "thread" || it.key() == "seq") continue;
+        std::cout << ' ' << it.key() << '=' << (it->is_string() ? it->get<std::string>() : it->dump());
+    }
+    std::cout << '\n';
+}
+
+int main(int argc, char* argv[]) {
+    bool json = false;
+    bool summary = false;
+    int type_filter = 0;
+    std::vector<std::string> files;
+
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "--json") {
+            json = true;
+        } else if (arg == "--summary") {
+            summary = true;
+        } else if (arg == "--type" && i + 1 < argc) {
+            std::string name = argv[++i];
+            for (uint8_t t = 1; t <= static_cast<uint8_t>(TraceEventType::Finding); ++t) {
+                if (name == environet::core::trace_event_name(t)) type_filter = t;
+            }
+            if (!type_filter) {
+                std::cerr << "Unknown record type: " << name << std::endl;
+                return 1;
+            }
+        } else if (arg == "--help") {
+            print_usage(argv[0]);
+            return 0;
+        } else if (!arg.empty() && arg[0] == '-') {
+            std::cerr << "Unknown option: " << arg << std::endl;
+            print_usage(argv[0]);
+            return 1;
+        } else {
+            files.push_back(arg);
+        }
+    }
+    if (files.empty()) {
+        print_usage(argv[0]);
+        return 1;
+    }
+
+    // Rotated files can be passed oldest first; each carries its own clock base
+    uint64_t counts[256] = {};
+    uint64_t total = 0;
+    for (const auto& file : files) {
+        TraceReader reader;
+        if (!reader.open(file)) {
+            std::cerr << reader.get_last_error() << std::endl;
+            return 1;
+        }
+        TraceRecord record;
+        while (reader.next(record)) {
+            if (type_filter && record.type != type_filter) continue;
+            ++counts[record.type];
+            ++total;
+            if (summary) continue;
+            uint64_t ns = reader.to_realtime_ns(record.ticks);
+            if (json) {
+                std::cout << environet::core::trace_record_to_json(record, ns).dump() << '\n';
+            } else {
+                print_text(record, ns);
+            }
+        }
+    }
+
+    if (summary) {
+        for (int t = 0; t < 256; ++t) {
+            if (counts[t]) std::cout << environet::core::trace_event_name(static_cast<uint8_t>(t)) << ": " << counts[t] << '\n';
+        }
+        std::cout << "total: " << total << '\n';
+    }
+    return 0;
+}
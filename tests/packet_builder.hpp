@@ -0,0 +1,159 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+#include "net/dissector.hpp"
+
+namespace environet {
+namespace test {
+
+/**
+ * @brief Builds Ethernet frames carrying IPv4 or IPv6 with a TCP or UDP header
+ *
+ * The address family follows the length of the addresses (4 or 16 bytes).
+ * IP and UDP length fields cover the headers and payload as built, so link
+ * padding or truncation applied to the result stays visible to the code
+ * under test. Defaults: 02:00:00:00:00:01 -> 02:00:00:00:00:02,
+ * 10.0.0.2 -> 10.0.0.1, UDP with ports 0.
+ */
+class PacketBuilder {
+public:
+    PacketBuilder& macs(std::vector<uint8_t> src, std::vector<uint8_t> dst) {
+        src_mac_ = std::move(src);
+        dst_mac_ = std::move(dst);
+        return *this;
+    }
+
+    PacketBuilder& ips(std::vector<uint8_t> src, std::vector<uint8_t> dst) {
+        src_ip_ = std::move(src);
+        dst_ip_ = std::move(dst);
+        return *this;
+    }
+
+    /// @brief Transport header for @p protocol (6 = TCP, anything else a UDP-sized header)
+    PacketBuilder& ports(uint8_t protocol, uint16_t src_port, uint16_t dst_port) {
+        protocol_ = protocol;
+        src_port_ = src_port;
+        dst_port_ = dst_port;
+        return *this;
+    }
+
+    PacketBuilder& udp(uint16_t src_port, uint16_t dst_port) { return ports(17, src_port, dst_port); }
+    PacketBuilder& tcp(uint16_t src_port, uint16_t dst_port) { return ports(6, src_port, dst_port); }
+
+    PacketBuilder& tcp_flags(uint8_t flags) {
+        tcp_flags_ = flags;
+        return *this;
+    }
+
+    PacketBuilder& payload(std::vector<uint8_t> bytes) {
+        payload_ = std::move(bytes);
+        return *this;
+    }
+
+    /**
+     * @brief Append an IPv6 extension header
+     *
+     * Next-header fields are chained when building: byte 0 of @p header is
+     * overwritten with the type of what follows it.
+     */
+    PacketBuilder& extension(uint8_t type, std::vector<uint8_t> header) {
+        extensions_.emplace_back(type, std::move(header));
+        return *this;
+    }
+
+    /// @brief IP packet without a link-layer header
+    std::vector<uint8_t> ip_packet() const {
+        std::vector<uint8_t> l4 = {hi(src_port_), lo(src_port_), hi(dst_port_), lo(dst_port_)};
+        if (protocol_ == 6) {
+            l4.insert(l4.end(), {0, 0, 0, 1, 0, 0, 0, 1, 0x50, tcp_flags_, 0xff, 0xff, 0, 0, 0, 0});
+        } else {
+            size_t len = 8 + payload_.size();
+            l4.insert(l4.end(), {hi(len), lo(len), 0, 0});
+        }
+        l4.insert(l4.end(), payload_.begin(), payload_.end());
+
+        std::vector<uint8_t> p;
+        if (src_ip_.size() == 16) {
+            size_t len = l4.size();
+            for (const auto& ext : extensions_) len += ext.second.size();
+            uint8_t next = extensions_.empty() ? protocol_ : extensions_.front().first;
+            p = {0x60, 0, 0, 0, hi(len), lo(len), next, 64};
+            p.insert(p.end(), src_ip_.begin(), src_ip_.end());
+            p.insert(p.end(), dst_ip_.begin(), dst_ip_.end());
+            for (size_t i = 0; i < extensions_.size(); ++i) {
+                size_t start = p.size();
+                p.insert(p.end(), extensions_[i].second.begin(), extensions_[i].second.end());
+                p[start] = i + 1 < extensions_.size() ? extensions_[i + 1].first : protocol_;
+            }
+        } else {
+            size_t len = 20 + l4.size();
+            p = {0x45, 0, hi(len), lo(len), 0, 0, 0, 0, 64, protocol_, 0, 0};
+            p.insert(p.end(), src_ip_.begin(), src_ip_.end());
+            p.insert(p.end(), dst_ip_.begin(), dst_ip_.end());
+        }
+        p.insert(p.end(), l4.begin(), l4.end());
+        return p;
+    }
+
+    /// @brief Ethernet II frame around ip_packet()
+    std::vector<uint8_t> frame() const {
+        std::vector<uint8_t> p(dst_mac_);
+        p.insert(p.end(), src_mac_.begin(), src_mac_.end());
+        if (src_ip_.size() == 16) {
+            p.insert(p.end(), {0x86, 0xDD});
+        } else {
+            p.insert(p.end(), {0x08, 0x00});
+        }
+        auto ip = ip_packet();
+        p.insert(p.end(), ip.begin(), ip.end());
+        return p;
+    }
+
+private:
+    static uint8_t hi(size_t v) { return static_cast<uint8_t>(v >> 8); }
+    static uint8_t lo(size_t v) { return static_cast<uint8_t>(v); }
+
+    std::vector<uint8_t> src_mac_ = {0x02, 0, 0, 0, 0, 0x01};
+    std::vector<uint8_t> dst_mac_ = {0x02, 0, 0, 0, 0, 0x02};
+    std::vector<uint8_t> src_ip_ = {10, 0, 0, 2};
+    std::vector<uint8_t> dst_ip_ = {10, 0, 0, 1};
+    uint8_t protocol_ = 17;
+    uint16_t src_port_ = 0;
+    uint16_t dst_port_ = 0;
+    uint8_t tcp_flags_ = 0x10;
+    std::vector<uint8_t> payload_;
+    std::vector<std::pair<uint8_t, std::vector<uint8_t>>> extensions_;
+};
+
+/**
+ * @brief A frame and its Ethernet dissection
+ *
+ * layers points into bytes, so the value can be moved but not copied.
+ */
+struct DissectedFrame {
+    std::vector<uint8_t> bytes;
+    net::PacketMeta meta;
+    net::PacketLayers layers;
+
+    DissectedFrame() = default;
+    DissectedFrame(DissectedFrame&&) = default;
+    DissectedFrame& operator=(DissectedFrame&&) = default;
+    DissectedFrame(const DissectedFrame&) = delete;
+    DissectedFrame& operator=(const DissectedFrame&) = delete;
+};
+
+/// @brief Dissect an Ethernet frame the way the sniffer does, with meta.length set to its size
+inline DissectedFrame dissect_frame(std::vector<uint8_t> bytes) {
+    DissectedFrame f;
+    f.bytes = std::move(bytes);
+    f.meta.length = static_cast<uint32_t>(f.bytes.size());
+    net::dissect<net::LinkType::EN10MB>(f.bytes.data(), f.meta.length, f.meta, f.layers);
+    return f;
+}
+
+} // namespace test
+} // namespace environet
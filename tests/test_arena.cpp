@@ -0,0 +1,171 @@
+#include <gtest/gtest.h>
+#include <atomic>
+#include <cstddef>
+#include <cstdlib>
+#include <new>
+#include <vector>
+
+#include "core/arena.hpp"
+#include "correlate/correlator.hpp"
+
+using namespace environet;
+
+// Count heap allocations made by the calling thread while counting is on.
+// Every form of the global operator new and delete is replaced, so this
+// file builds into its own test binary (environet_alloc_tests).
+namespace {
+thread_local bool tl_counting = false;
+thread_local size_t tl_allocations = 0;
+
+struct AllocationCounter {
+    AllocationCounter() { tl_allocations = 0; tl_counting = true; }
+    ~AllocationCounter() { tl_counting = false; }
+    size_t count() const { return tl_allocations; }
+};
+
+void* allocate(std::size_t size, std::size_t alignment) noexcept {
+    if (tl_counting) ++tl_allocations;
+    if (size == 0) size = 1;
+    if (alignment <= alignof(std::max_align_t)) return std::malloc(size);
+    // aligned_alloc wants a size that is a multiple of the alignment
+    return std::aligned_alloc(alignment, (size + alignment - 1) / alignment * alignment);
+}
+
+void* allocate_or_throw(std::size_t size, std::size_t alignment) {
+    if (void* p = allocate(size, alignment)) return p;
+    throw std::bad_alloc();
+}
+
+// Out of line so the compiler does not pair an inlined free() with new
+__attribute__((noinline)) void deallocate(void* p) noexcept { std::free(p); }
+} // namespace
+
+void* operator new(std::size_t size) { return allocate_or_throw(size, 0); }
+void* operator new[](std::size_t size) { return allocate_or_throw(size, 0); }
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept { return allocate(size, 0); }
+void* operator new[](std::size_t size, const std::nothrow_t&) noexcept { return allocate(size, 0); }
+void* operator new(std::size_t size, std::align_val_t al) {
+    return allocate_or_throw(size, static_cast<std::size_t>(al));
+}
+void* operator new[](std::size_t size, std::align_val_t al) {
+    return allocate_or_throw(size, static_cast<std::size_t>(al));
+}
+void* operator new(std::size_t size, std::align_val_t al, const std::nothrow_t&) noexcept {
+    return allocate(size, static_cast<std::size_t>(al));
+}
+void* operator new[](std::size_t size, std::align_val_t al, const std::nothrow_t&) noexcept {
+    return allocate(size, static_cast<std::size_t>(al));
+}
+
+void operator delete(void* p) noexcept { deallocate(p); }
+void operator delete[](void* p) noexcept { deallocate(p); }
+void operator delete(void* p, std::size_t) noexcept { deallocate(p); }
+void operator delete[](void* p, std::size_t) noexcept { deallocate(p); }
+void operator delete(void* p, const std::nothrow_t&) noexcept { deallocate(p); }
+void operator delete[](void* p, const std::nothrow_t&) noexcept { deallocate(p); }
+void operator delete(void* p, std::align_val_t) noexcept { deallocate(p); }
+void operator delete[](void* p, std::align_val_t) noexcept { deallocate(p); }
+void operator delete(void* p, std::size_t, std::align_val_t) noexcept { deallocate(p); }
+void operator delete[](void* p, std::size_t, std::align_val_t) noexcept { deallocate(p); }
+void operator delete(void* p, std::align_val_t, const std::nothrow_t&) noexcept { deallocate(p); }
+void operator delete[](void* p, std::align_val_t, const std::nothrow_t&) noexcept { deallocate(p); }
+
+TEST(TickArenaTest, GrowsToFitTickAndStopsSpilling) {
+    core::TickArena arena(1024);
+    EXPECT_EQ(arena.capacity(), 1024u);
+
+    // First tick outgrows the block and spills to the heap
+    {
+        std::pmr::vector<int> v(&arena);
+        for (int i = 0; i < 4000; ++i) v.push_back(i);
+    }
+    arena.reset();
+    EXPECT_GT(arena.capacity(), 16000u);
+    EXPECT_EQ(arena.get_stats()["spills"].get<uint64_t>(), 1u);
+
+    // The same tick now fits and makes no heap allocations
+    for (int tick = 0; tick < 3; ++tick) {
+        AllocationCounter counter;
+        {
+            std::pmr::vector<int> v(&arena);
+            for (int i = 0; i < 4000; ++i) v.push_back(i);
+            std::pmr::string s("a string longer than the small-string buffer", &arena);
+        }
+        arena.reset();
+        EXPECT_EQ(counter.count(), 0u) << "tick " << tick;
+    }
+    auto stats = arena.get_stats();
+    EXPECT_EQ(stats["spills"].get<uint64_t>(), 1u);
+    EXPECT_EQ(stats["resets"].get<uint64_t>(), 4u);
+    EXPECT_GT(stats["high_water_bytes"].get<size_t>(), 16000u);
+}
+
+TEST(TickArenaTest, CorrelatorTickDoesNotAllocateInSteadyState) {
+    auto config = std::make_shared<core::Config>(core::Config::get_defaults());
+    config->correlator.window_ms = 2;
+    config->correlator.sensor_threshold = 50;
+    correlate::Correlator corr(config);
+    ASSERT_TRUE(corr.init());
+    size_t delivered = 0;
+    corr.set_finding_callback([&delivered](const correlate::Finding&) { ++delivered; });
+
+    net::BssInfo ap_a("office-net", "aa:bb:cc:00:00:01", 2412, -5000);
+    net::BssInfo ap_b("", "aa:bb:cc:00:00:02", 5180, -6000);
+    net::PingStats ping;
+    ping.reachable = true;
+    sensors::SensorFrame frame;
+
+    // Each segment: samples, then an IR jump followed by a signal drop.
+    // Timestamps are explicit; segments are 4ms apart so their 2ms windows
+    // do not overlap, and each tick runs once its last window has elapsed.
+    uint64_t now = 1000000;
+    std::vector<size_t> allocations;
+    size_t findings = 0;
+    for (int tick = 0; tick < 50; ++tick) {
+        for (int i = 0; i < 8; ++i) {
+            ap_a.signal_mbm = -5000;
+            ap_b.signal_mbm = -6000;
+            corr.push_bss_at(now, ap_a);
+            corr.push_bss_at(now, ap_b);
+            ping.avg_rtt_ms = 10.0;
+            corr.push_ping_stats_at(now, ping);
+            frame.ir_raw = static_cast<int16_t>(i % 2 ? 400 : 100);
+            corr.push_sensor_at(now + 1, frame);
+            ap_a.signal_mbm = -6200;
+            ap_b.signal_mbm = -6900;
+            corr.push_bss_at(now + 1, ap_a);
+            corr.push_bss_at(now + 1, ap_b);
+            ping.avg_rtt_ms = 25.0;
+            corr.push_ping_stats_at(now + 1, ping);
+            now += 4;
+        }
+        AllocationCounter counter;
+        size_t n = corr.process_at(now);
+        allocations.push_back(counter.count());
+        // Every IR jump is a finding; the very first frame has no predecessor
+        EXPECT_EQ(n, tick == 0 ? 7u : 8u) << "tick " << tick;
+        findings += n;
+    }
+
+    EXPECT_EQ(findings, 399u);  // History wrapped, so pooled storage was recycled
+    EXPECT_EQ(delivered, findings);
+    // After warm-up (arena sized, pool populated, history full) ticks stay off the heap
+    for (size_t tick = 40; tick < allocations.size(); ++tick) {
+        EXPECT_EQ(allocations[tick], 0u) << "tick " << tick;
+    }
+
+    // Copies handed out by get_findings() are ordinary heap strings
+    AllocationCounter copy_counter;
+    auto history = corr.get_findings();
+    EXPECT_GT(copy_counter.count(), 0u);
+    ASSERT_EQ(history.size(), 256u);
+    const auto& f = history.back();
+    EXPECT_EQ(f.event_type, "sensor_change");
+    EXPECT_EQ(std::abs(f.ir_raw_delta), 300.0);
+    EXPECT_NEAR(f.rssi_delta, -10.5, 1e-9);
+    EXPECT_NEAR(f.ping_latency_delta, 15.0, 1e-9);
+    ASSERT_EQ(f.affected_networks.size(), 2u);
+    EXPECT_EQ(f.affected_networks[0], "office-net");
+    EXPECT_EQ(f.affected_networks[1], "aa:bb:cc:00:00:02");
+    EXPECT_NE(f.description.find("threshold 50"), std::string::npos);
+}
@@ -0,0 +1,172 @@
+#include <gtest/gtest.h>
+#include <cstdint>
+#include <vector>
+
+#include "net/classifier.hpp"
+#include "net/pcap_sniffer.hpp"
+#include "packet_builder.hpp"
+
+using namespace environet;
+using namespace environet::net;
+
+namespace {
+
+using Rule = core::Config::ClassRule;
+
+// Ethernet/IPv4/UDP or TCP frame from a host to the gateway MAC
+std::vector<uint8_t> frame(const std::vector<uint8_t>& src_mac, const std::vector<uint8_t>& src_ip,
+                           const std::vector<uint8_t>& dst_ip, uint8_t protocol, uint16_t src_port,
+                           uint16_t dst_port) {
+    return test::PacketBuilder()
+        .macs(src_mac, {0x02, 0x00, 0x00, 0x00, 0x00, 0xfe})
+        .ips(src_ip, dst_ip)
+        .ports(protocol, src_port, dst_port)
+        .frame();
+}
+
+uint16_t classify(Classifier& classifier, const std::vector<uint8_t>& pkt) {
+    auto f = test::dissect_frame(pkt);
+    return classifier.classify(f.meta, f.layers);
+}
+
+const std::vector<uint8_t> PI_MAC = {0xb8, 0x27, 0xeb, 0x12, 0x34, 0x56};
+const std::vector<uint8_t> LAPTOP_MAC = {0x3c, 0x22, 0xfb, 0x01, 0x02, 0x03};
+const std::vector<uint8_t> LAN_HOST = {192, 168, 1, 20};
+const std::vector<uint8_t> GATEWAY = {192, 168, 1, 1};
+const std::vector<uint8_t> CDN = {151, 101, 2, 9};
+
+std::vector<Rule> home_rules() {
+    Rule dns{"dns", {}, {}, {"53"}, {17, 6}};
+    Rule iot{"iot", {"b8:27:eb"}, {}, {}, {}};
+    Rule streaming{"streaming", {}, {"151.101.0.0/16", "2a04:4e42::/32"}, {"443"}, {6}};
+    Rule management{"management", {}, {"192.168.1.1"}, {"22", "8000-8099"}, {6}};
+    return {dns, iot, streaming, management};
+}
+
+} // namespace
+
+TEST(ClassifierTest, ParsesPrefixesAndPorts) {
+    std::array<uint8_t, 6> mac{};
+    int bits = 0;
+    ASSERT_TRUE(Classifier::parse_mac_prefix("B8:27:EB", mac, bits));
+    EXPECT_EQ(bits, 24);
+    EXPECT_EQ(mac[0], 0xb8);
+    ASSERT_TRUE(Classifier::parse_mac_prefix("b8-27-eb-00-00-00/20", mac, bits));
+    EXPECT_EQ(bits, 20);
+    EXPECT_FALSE(Classifier::parse_mac_prefix("b8:27:eb/32", mac, bits));
+    EXPECT_FALSE(Classifier::parse_mac_prefix("b8:27:", mac, bits));
+    EXPECT_FALSE(Classifier::parse_mac_prefix("zz", mac, bits));
+
+    std::array<uint8_t, 16> addr{};
+    bool v6 = false;
+    ASSERT_TRUE(Classifier::parse_ip_prefix("10.1.0.0/16", addr, bits, v6));
+    EXPECT_FALSE(v6);
+    EXPECT_EQ(bits, 16);
+    ASSERT_TRUE(Classifier::parse_ip_prefix("fe80::/10", addr, bits, v6));
+    EXPECT_TRUE(v6);
+    ASSERT_TRUE(Classifier::parse_ip_prefix("192.168.1.1", addr, bits, v6));
+    EXPECT_EQ(bits, 32);
+    EXPECT_FALSE(Classifier::parse_ip_prefix("10.0.0.0/33", addr, bits, v6));
+    EXPECT_FALSE(Classifier::parse_ip_prefix("router", addr, bits, v6));
+
+    uint16_t lo = 0, hi = 0;
+    ASSERT_TRUE(Classifier::parse_port_range("8000-8099", lo, hi));
+    EXPECT_EQ(lo, 8000);
+    EXPECT_EQ(hi, 8099);
+    EXPECT_FALSE(Classifier::parse_port_range("90-80", lo, hi));
+    EXPECT_FALSE(Classifier::parse_port_range("70000", lo, hi));
+}
+
+TEST(ClassifierTest, PrefixTrieExpandsPartialStrides) {
+    PrefixTrie trie;
+    const uint8_t net10[] = {10, 0, 0, 0};
+    const uint8_t net10_1[] = {10, 1, 0, 0};
+    const uint8_t any[] = {0, 0, 0, 0};
+    trie.insert(net10, 8, 0x1);
+    trie.insert(net10_1, 13, 0x2);      // 10.0.0.0 - 10.7.255.255
+    trie.insert(any, 0, 0x4);
+
+    const uint8_t a[] = {10, 7, 1, 1}, b[] = {10, 8, 1, 1}, c[] = {11, 0, 0, 1};
+    EXPECT_EQ(trie.lookup(a, 32), 0x7u);
+    EXPECT_EQ(trie.lookup(b, 32), 0x5u);
+    EXPECT_EQ(trie.lookup(c, 32), 0x4u);
+}
+
+TEST(ClassifierTest, FirstMatchingRuleWins) {
+    Classifier classifier;
+    ASSERT_TRUE(classifier.load(home_rules()));
+    auto names = classifier.class_names();
+    ASSERT_EQ(names.size(), 5u);
+    EXPECT_EQ(names[0], "unclassified");
+
+    // DNS from the Pi: rule 0 outranks the IoT MAC rule
+    EXPECT_EQ(names[classify(classifier, frame(PI_MAC, LAN_HOST, GATEWAY, 17, 40000, 53))], "dns");
+    EXPECT_EQ(names[classify(classifier, frame(PI_MAC, LAN_HOST, CDN, 6, 40000, 443))], "iot");
+    // Reply direction matches on source address and port
+    EXPECT_EQ(names[classify(classifier, frame(LAPTOP_MAC, CDN, LAN_HOST, 6, 443, 51000))], "streaming");
+    EXPECT_EQ(names[classify(classifier, frame(LAPTOP_MAC, LAN_HOST, GATEWAY, 6, 51000, 8080))], "management");
+    // Every field of a rule must match
+    EXPECT_EQ(classify(classifier, frame(LAPTOP_MAC, LAN_HOST, CDN, 17, 51000, 443)), 0);
+    EXPECT_EQ(classify(classifier, frame(LAPTOP_MAC, LAN_HOST, GATEWAY, 6, 51000, 8100)), 0);
+
+    auto stats = classifier.get_stats();
+    EXPECT_EQ(stats["rules"], 4);
+    EXPECT_EQ(stats["classes"][0]["name"], "unclassified");
+    EXPECT_GE(stats["classes"][0]["packets"].get<uint64_t>(), 2u);
+    EXPECT_GE(stats["classes"][1]["bytes"].get<uint64_t>(), 1u);
+}
+
+TEST(ClassifierTest, BadRulesKeepCurrentSet) {
+    Classifier classifier;
+    ASSERT_TRUE(classifier.load(home_rules()));
+    auto bad = home_rules();
+    bad[2].ips.push_back("151.101.0.0/40");
+    EXPECT_FALSE(classifier.load(bad));
+    EXPECT_NE(classifier.get_last_error().find("streaming"), std::string::npos);
+    EXPECT_EQ(classifier.class_names().size(), 5u);
+    EXPECT_NE(classify(classifier, frame(PI_MAC, LAN_HOST, CDN, 6, 40000, 443)), 0);
+
+    // An empty rule set takes effect on the next packet
+    ASSERT_TRUE(classifier.load({}));
+    EXPECT_EQ(classify(classifier, frame(PI_MAC, LAN_HOST, CDN, 6, 40000, 443)), 0);
+}
+
+TEST(ClassifierTest, ConfigAndSnifferIntegration) {
+    auto cfg = core::Config::from_json(R"({"classifier": {"rules": [
+        {"name": "dns", "ports": [53], "protocols": [17]},
+        {"name": "iot", "macs": ["b8:27:eb"]}
+    ]}})");
+    ASSERT_EQ(cfg.classifier.rules.size(), 2u);
+    EXPECT_EQ(cfg.classifier.rules[0].ports[0], "53");
+    auto round_trip = core::Config::from_json(cfg.to_json().dump());
+    EXPECT_TRUE(round_trip.classifier.rules == cfg.classifier.rules);
+    EXPECT_THROW(core::Config::from_json(R"({"classifier": {"rules": [{"ports": [53]}]}})"),
+                 std::runtime_error);
+    EXPECT_THROW(core::Config::from_json(R"({"classifier": {"rules": [{"name": "x", "protocols": [300]}]}})"),
+                 std::runtime_error);
+
+    PcapSniffer sniffer(std::make_shared<const core::Config>(cfg));
+    std::vector<uint16_t> classes;
+    sniffer.set_packet_callback([&classes](const PacketMeta& meta, const uint8_t*) {
+        classes.push_back(meta.class_id);
+    });
+    auto inject = [&sniffer](const std::vector<uint8_t>& pkt) {
+        pcap_pkthdr header{};
+        header.caplen = header.len = static_cast<uint32_t>(pkt.size());
+        sniffer.inject_packet(&header, pkt.data());
+    };
+    inject(frame(LAPTOP_MAC, LAN_HOST, GATEWAY, 17, 40000, 53));
+    inject(frame(PI_MAC, LAN_HOST, CDN, 6, 40000, 443));
+    inject(frame(LAPTOP_MAC, LAN_HOST, CDN, 6, 40000, 443));
+    EXPECT_EQ(classes, (std::vector<uint16_t>{1, 2, 0}));
+
+    // Live reload: a rule that does not parse leaves the current rules in place
+    auto reloaded = cfg;
+    reloaded.classifier.rules[1].macs = {"not-a-mac"};
+    EXPECT_FALSE(sniffer.apply_config(reloaded));
+    reloaded.classifier.rules.pop_back();
+    EXPECT_TRUE(sniffer.apply_config(reloaded));
+    inject(frame(PI_MAC, LAN_HOST, CDN, 6, 40000, 443));
+    EXPECT_EQ(classes.back(), 0);
+    EXPECT_EQ(sniffer.get_stats()["classifier"]["rules"], 1);
+}
@@ -0,0 +1,396 @@
+#include <gtest/gtest.h>
+#include <arpa/inet.h>
+#include <chrono>
+#include <filesystem>
+#include <functional>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <thread>
+#include <unistd.h>
+
+#include "collect/collector.hpp"
+#include "collect/forwarder.hpp"
+#include "correlate/correlator.hpp"
+
+using namespace environet;
+using namespace environet::collect;
+
+namespace {
+
+std::string spool_path(const std::string& name) {
+    return "test_spool_" + name + "_" + std::to_string(getpid());
+}
+
+std::shared_ptr<core::Config> edge_config(const std::string& name, int collector_port) {
+    auto config = std::make_shared<core::Config>(core::Config::get_defaults());
+    config->forward.enabled = true;
+    config->forward.collector_port = collector_port;
+    config->forward.edge_id = name;
+    config->forward.spool_dir = spool_path(name);
+    config->forward.batch_interval_ms = 20;
+    config->forward.rollup_interval_ms = 0;
+    config->forward.reconnect_ms = 20;
+    return config;
+}
+
+std::shared_ptr<core::Config> collector_config() {
+    auto config = std::make_shared<core::Config>(core::Config::get_defaults());
+    config->collector.bind_address = "127.0.0.1";
+    config->collector.port = 0;
+    return config;
+}
+
+correlate::Finding make_finding(uint64_t ts, const char* type) {
+    correlate::Finding f;
+    f.timestamp_ms = ts;
+    f.event_type = type;
+    f.description = "test";
+    return f;
+}
+
+bool wait_for(const std::function<bool()>& done) {
+    for (int i = 0; i < 300; ++i) {
+        if (done()) return true;
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    return done();
+}
+
+nlohmann::json query(const Collector& collector, const std::string& path, const std::string& query = "") {
+    core::HttpRequest req;
+    req.method = "GET";
+    req.path = path;
+    req.query = query;
+    return nlohmann::json::parse(collector.handle(req).body);
+}
+
+int connect_to(int port) {
+    int fd = socket(AF_INET, SOCK_STREAM, 0);
+    sockaddr_in addr{};
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(static_cast<uint16_t>(port));
+    inet_pton(AF_INET, "127.0.0.1", &addr.sin_addr);
+    if (connect(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0) {
+        close(fd);
+        return -1;
+    }
+    timeval tv{2, 0};
+    setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
+    return fd;
+}
+
+// Read frames until one arrives (blocking socket)
+bool next_frame(int fd, std::string& in, Frame& frame) {
+    char buf[4096];
+    while (true) {
+        int got = take_frame(in, frame, 1 << 20);
+        if (got != 0) return got > 0;
+        ssize_t n = recv(fd, buf, sizeof(buf), 0);
+        if (n <= 0) return false;
+        in.append(buf, static_cast<size_t>(n));
+    }
+}
+
+} // namespace
+
+TEST(CollectTest, FramesRoundTripAndRejectCorruption) {
+    std::string wire;
+    append_frame(wire, FrameType::Hello, 0, "{\"edge\":\"a\"}");
+    std::string body;
+    for (int i = 0; i < 200; ++i) body += "{\"kind\":\"finding\",\"wall_ms\":1,\"data\":{\"event_type\":\"motion\"}}\n";
+    append_batch_frame(wire, 7, 200, body, Compression::Zlib);
+    append_ack_frame(wire, 7);
+
+    // Byte by byte: nothing is taken until a frame is complete
+    std::string in;
+    std::vector<Frame> frames;
+    Frame frame;
+    for (char c : wire) {
+        in += c;
+        int got = take_frame(in, frame, 1 << 20);
+        ASSERT_GE(got, 0);
+        if (got) frames.push_back(frame);
+    }
+    ASSERT_EQ(frames.size(), 3u);
+    EXPECT_TRUE(in.empty());
+    EXPECT_EQ(frames[0].type, FrameType::Hello);
+    EXPECT_EQ(frames[0].payload, "{\"edge\":\"a\"}");
+
+    EXPECT_EQ(frames[1].flags & FLAG_ZLIB, FLAG_ZLIB);
+    EXPECT_LT(frames[1].payload.size(), body.size() / 4);
+    Batch batch;
+    ASSERT_TRUE(decode_batch(frames[1], batch, body.size()));
+    EXPECT_EQ(batch.seq, 7u);
+    EXPECT_EQ(batch.records, 200u);
+    EXPECT_EQ(batch.body, body);
+    EXPECT_FALSE(decode_batch(frames[1], batch, body.size() - 1));    // Over the body limit
+
+    uint64_t seq = 0;
+    ASSERT_TRUE(decode_ack(frames[2], seq));
+    EXPECT_EQ(seq, 7u);
+
+    // Incompressible bodies are sent as is
+    std::string raw;
+    append_batch_frame(raw, 1, 1, "x", Compression::Zlib);
+    ASSERT_EQ(take_frame(raw, frame, 1 << 20), 1);
+    EXPECT_EQ(frame.flags, 0);
+    ASSERT_TRUE(decode_batch(frame, batch, 16));
+    EXPECT_EQ(batch.body, "x");
+
+    // Payload corruption, bad magic and oversized payloads are errors
+    std::string bad;
+    append_frame(bad, FrameType::Ack, 0, "12345678");
+    bad[FRAME_HEADER_SIZE + 2] ^= 1;
+    EXPECT_EQ(take_frame(bad, frame, 1 << 20), -1);
+    bad = "XXXX" + std::string(20, '\0');
+    EXPECT_EQ(take_frame(bad, frame, 1 << 20), -1);
+    bad.clear();
+    append_frame(bad, FrameType::Batch, 0, std::string(100, 'a'));
+    EXPECT_EQ(take_frame(bad, frame, 99), -1);
+}
+
+TEST(CollectTest, EdgesForwardToCollectorOverLoopback) {
+    Collector collector(collector_config());
+    ASSERT_TRUE(collector.start()) << collector.get_last_error();
+
+    auto cfg_a = edge_config("site-a", collector.port());
+    auto cfg_b = edge_config("site-b", collector.port());
+    cfg_b->forward.compression = "none";
+    cfg_b->forward.rollup_interval_ms = 30;
+    Forwarder a(cfg_a), b(cfg_b);
+    b.set_rollup_provider([]() { return nlohmann::json{{"packets", 42}}; });
+    ASSERT_TRUE(a.init()) << a.get_last_error();
+    ASSERT_TRUE(b.init()) << b.get_last_error();
+    ASSERT_TRUE(a.start());
+    ASSERT_TRUE(b.start());
+
+    for (uint64_t t = 1; t <= 5; ++t) a.publish_finding(make_finding(t, "motion"));
+    b.publish_finding(make_finding(100, "signal_drop"));
+
+    ASSERT_TRUE(wait_for([&] {
+        return query(collector, "/api/v1/findings")["findings"].size() == 6 &&
+               !query(collector, "/api/v1/rollups", "edge=site-b")["rollups"].empty() && a.spooled() == 0;
+    }));
+    EXPECT_TRUE(a.connected());
+
+    auto all = query(collector, "/api/v1/findings")["findings"];
+    size_t from_a = 0;
+    for (const auto& f : all) {
+        if (f["edge"] == "site-a") ++from_a;
+        EXPECT_GT(f["wall_ms"].get<uint64_t>(), 0u);
+    }
+    EXPECT_EQ(from_a, 5u);
+    auto only_b = query(collector, "/api/v1/findings", "edge=site-b")["findings"];
+    ASSERT_EQ(only_b.size(), 1u);
+    EXPECT_EQ(only_b[0]["data"]["event_type"], "signal_drop");
+    EXPECT_EQ(query(collector, "/api/v1/findings", "limit=2")["findings"].size(), 2u);
+
+    auto rollup = query(collector, "/api/v1/rollups", "edge=site-b")["rollups"][0];
+    EXPECT_EQ(rollup["data"]["packets"].get<int>(), 42);
+    EXPECT_EQ(rollup["interval_ms"].get<int>(), 30);
+
+    auto edges = query(collector, "/api/v1/edges")["edges"];
+    EXPECT_TRUE(edges["site-a"]["connected"].get<bool>());
+    EXPECT_GE(edges["site-a"]["acked_seq"].get<uint64_t>(), 1u);
+    EXPECT_EQ(query(collector, "/api/v1/findings", "limit=x")["error"].is_string(), true);
+
+    a.stop();
+    b.stop();
+    collector.stop();
+    for (auto* cfg : {cfg_a.get(), cfg_b.get()}) std::filesystem::remove_all(cfg->forward.spool_dir);
+}
+
+TEST(CollectTest, SpoolSurvivesRestartUntilAcknowledged) {
+    // Reserve a port, then leave it closed while the edge runs
+    Collector probe(collector_config());
+    ASSERT_TRUE(probe.start());
+    int port = probe.port();
+    probe.stop();
+
+    auto cfg = edge_config("site-c", port);
+    cfg->forward.batch_interval_ms = 60000;
+    {
+        Forwarder edge(cfg);
+        ASSERT_TRUE(edge.init());
+        ASSERT_TRUE(edge.start());
+        edge.publish_finding(make_finding(1, "motion"));
+        edge.publish_finding(make_finding(2, "motion"));
+        edge.flush();
+        ASSERT_TRUE(wait_for([&] { return edge.get_stats()["spool"]["synced_lsn"] == 2; }));
+        EXPECT_FALSE(edge.connected());
+        edge.publish_finding(make_finding(3, "motion"));    // Not synced yet: made durable by stop()
+        edge.stop();
+        EXPECT_EQ(edge.spooled(), 3u);
+    }
+
+    auto ccfg = collector_config();
+    ccfg->collector.port = port;
+    Collector collector(ccfg);
+    ASSERT_TRUE(collector.start()) << collector.get_last_error();
+
+    Forwarder edge(cfg);
+    ASSERT_TRUE(edge.init());
+    EXPECT_EQ(edge.spooled(), 3u);
+    ASSERT_TRUE(edge.start());
+    ASSERT_TRUE(wait_for([&] { return edge.spooled() == 0; }));
+    auto findings = query(collector, "/api/v1/findings")["findings"];
+    ASSERT_EQ(findings.size(), 3u);
+    EXPECT_EQ(findings[2]["data"]["timestamp_ms"].get<uint64_t>(), 3u);
+
+    // Sequence numbers continue after a restart, so new batches are not mistaken for repeats
+    edge.stop();
+    Forwarder again(cfg);
+    ASSERT_TRUE(again.init());
+    ASSERT_TRUE(again.start());
+    again.publish_finding(make_finding(4, "motion"));
+    again.flush();
+    ASSERT_TRUE(wait_for([&] { return query(collector, "/api/v1/findings")["findings"].size() == 4; }));
+    EXPECT_EQ(query(collector, "/api/v1/stats")["duplicates"].get<uint64_t>(), 0u);
+    again.stop();
+    collector.stop();
+    std::filesystem::remove_all(cfg->forward.spool_dir);
+}
+
+TEST(CollectTest, WipedSpoolRestartsTheEdgeSequence) {
+    Collector collector(collector_config());
+    ASSERT_TRUE(collector.start()) << collector.get_last_error();
+    auto cfg = edge_config("site-w", collector.port());
+    {
+        Forwarder edge(cfg);
+        ASSERT_TRUE(edge.init());
+        ASSERT_TRUE(edge.start());
+        for (uint64_t ts = 1; ts <= 3; ++ts) edge.publish_finding(make_finding(ts, "motion"));
+        edge.flush();
+        ASSERT_TRUE(wait_for([&] { return edge.connected() && edge.spooled() == 0; }));
+        edge.stop();
+    }
+    // The spool is lost: the next run numbers its records from 1 again
+    std::filesystem::remove_all(cfg->forward.spool_dir);
+    Forwarder edge(cfg);
+    ASSERT_TRUE(edge.init());
+    edge.publish_finding(make_finding(4, "motion"));
+    edge.publish_finding(make_finding(5, "motion"));
+    ASSERT_TRUE(edge.start());
+    edge.flush();
+    ASSERT_TRUE(wait_for([&] { return query(collector, "/api/v1/findings")["findings"].size() == 5; }));
+    EXPECT_EQ(edge.spooled(), 0u);
+    auto site = query(collector, "/api/v1/edges")["edges"]["site-w"];
+    EXPECT_EQ(site["sequence_resets"].get<int>(), 1);
+    EXPECT_EQ(site["acked_seq"].get<int>(), 2);
+    edge.stop();
+    collector.stop();
+    std::filesystem::remove_all(cfg->forward.spool_dir);
+}
+
+TEST(CollectTest, WipedSpoolThatGrewPastTheCursorIsSentInFull) {
+    Collector collector(collector_config());
+    ASSERT_TRUE(collector.start()) << collector.get_last_error();
+    auto cfg = edge_config("site-g", collector.port());
+    {
+        Forwarder edge(cfg);
+        ASSERT_TRUE(edge.init());
+        ASSERT_TRUE(edge.start());
+        for (uint64_t ts = 1; ts <= 3; ++ts) edge.publish_finding(make_finding(ts, "motion"));
+        edge.flush();
+        ASSERT_TRUE(wait_for([&] { return edge.connected() && edge.spooled() == 0; }));
+        edge.stop();
+    }
+    // The new spool is already past the old cursor when it reconnects, so
+    // only its epoch tells the collector that records 1..3 are new
+    std::filesystem::remove_all(cfg->forward.spool_dir);
+    Forwarder edge(cfg);
+    ASSERT_TRUE(edge.init());
+    for (uint64_t ts = 4; ts <= 8; ++ts) edge.publish_finding(make_finding(ts, "motion"));
+    ASSERT_TRUE(edge.start());
+    edge.flush();
+    ASSERT_TRUE(wait_for([&] { return query(collector, "/api/v1/findings")["findings"].size() == 8; }));
+    EXPECT_EQ(edge.spooled(), 0u);
+    auto site = query(collector, "/api/v1/edges")["edges"]["site-g"];
+    EXPECT_EQ(site["sequence_resets"].get<int>(), 1);
+    EXPECT_EQ(site["acked_seq"].get<int>(), 5);
+    EXPECT_EQ(site["duplicates"].get<int>(), 0);
+    edge.stop();
+    collector.stop();
+    std::filesystem::remove_all(cfg->forward.spool_dir);
+}
+
+TEST(CollectTest, CollectorDropsRepeatsAndEnforcesLimits) {
+    auto cfg = collector_config();
+    cfg->collector.max_edges = 1;
+    cfg->collector.credits = 4;
+    Collector collector(cfg);
+    ASSERT_TRUE(collector.start());
+
+    int fd = connect_to(collector.port());
+    ASSERT_GE(fd, 0);
+    std::string out, in;
+    append_frame(out, FrameType::Hello, 0, "{\"edge\":\"site-d\",\"proto\":1}");
+    std::string body = "{\"kind\":\"finding\",\"wall_ms\":5,\"data\":{}}\nnot json\n";
+    append_batch_frame(out, 1, 2, body, Compression::Zlib);
+    append_batch_frame(out, 1, 2, body, Compression::Zlib);     // Resent after a lost ack
+    send(fd, out.data(), out.size(), 0);
+
+    Frame frame;
+    ASSERT_TRUE(next_frame(fd, in, frame));
+    ASSERT_EQ(frame.type, FrameType::Welcome);
+    auto welcome = nlohmann::json::parse(frame.payload);
+    EXPECT_EQ(welcome["credits"].get<int>(), 4);
+    EXPECT_EQ(welcome["acked_seq"].get<int>(), 0);
+    uint64_t seq = 0;
+    for (int i = 0; i < 2; ++i) {
+        ASSERT_TRUE(next_frame(fd, in, frame));
+        ASSERT_TRUE(decode_ack(frame, seq));
+        EXPECT_EQ(seq, 1u);
+    }
+    auto edge = query(collector, "/api/v1/edges")["edges"]["site-d"];
+    EXPECT_EQ(edge["records"].get<int>(), 1);
+    EXPECT_EQ(edge["bad_records"].get<int>(), 1);
+    EXPECT_EQ(edge["duplicates"].get<int>(), 1);
+
+    // A second edge is over max_edges
+    int other = connect_to(collector.port());
+    std::string hello, other_in;
+    append_frame(hello, FrameType::Hello, 0, "{\"edge\":\"site-e\",\"proto\":1}");
+    send(other, hello.data(), hello.size(), 0);
+    ASSERT_TRUE(next_frame(other, other_in, frame));
+    EXPECT_EQ(frame.type, FrameType::Error);
+    EXPECT_EQ(nlohmann::json::parse(frame.payload)["error"], "too many edges");
+    close(other);
+
+    // Reconnecting resumes from the last applied batch
+    close(fd);
+    fd = connect_to(collector.port());
+    in.clear();
+    hello.clear();
+    append_frame(hello, FrameType::Hello, 0, "{\"edge\":\"site-d\",\"proto\":1}");
+    send(fd, hello.data(), hello.size(), 0);
+    ASSERT_TRUE(next_frame(fd, in, frame));
+    ASSERT_EQ(frame.type, FrameType::Welcome);
+    EXPECT_EQ(nlohmann::json::parse(frame.payload)["acked_seq"].get<int>(), 1);
+
+    // A batch overlapping applied records (seq 1..3 after 1) applies only the new ones
+    std::string overlap;
+    append_batch_frame(overlap, 3, 3,
+                       "{\"kind\":\"finding\",\"wall_ms\":5,\"data\":{}}\n"
+                       "{\"kind\":\"finding\",\"wall_ms\":6,\"data\":{}}\n"
+                       "{\"kind\":\"finding\",\"wall_ms\":7,\"data\":{}}\n",
+                       Compression::None);
+    send(fd, overlap.data(), overlap.size(), 0);
+    ASSERT_TRUE(next_frame(fd, in, frame));
+    ASSERT_TRUE(decode_ack(frame, seq));
+    EXPECT_EQ(seq, 3u);
+    auto findings = query(collector, "/api/v1/findings", "edge=site-d")["findings"];
+    ASSERT_EQ(findings.size(), 3u);
+    EXPECT_EQ(findings[1]["wall_ms"].get<int>(), 6);
+
+    // Batches before hello and garbage are rejected
+    int rogue = connect_to(collector.port());
+    std::string batch, rogue_in;
+    append_batch_frame(batch, 1, 0, "", Compression::None);
+    send(rogue, batch.data(), batch.size(), 0);
+    ASSERT_TRUE(next_frame(rogue, rogue_in, frame));
+    EXPECT_EQ(frame.type, FrameType::Error);
+    close(rogue);
+    close(fd);
+    collector.stop();
+}
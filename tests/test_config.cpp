@@ -179,6 +179,11 @@ TEST_F(ConfigTest, ConfigurationValidation) {
     invalid_config = config;
     invalid_config.correlator.window_ms = 0;
     EXPECT_THROW(invalid_config.validate(), std::runtime_error);
+    
+    // Unknown async log overflow policy
+    invalid_config = config;
+    invalid_config.logging.overflow_policy = "discard";
+    EXPECT_THROW(invalid_config.validate(), std::runtime_error);
 }
 
 // Test configuration serialization
@@ -338,3 +343,19 @@ TEST_F(ConfigTest, ConfigurationPerformance) {
     // Should complete in less than 100ms
     EXPECT_LT(duration.count(), 100);
 }
+
+// Test shared snapshot loading used by path-constructed components
+TEST_F(ConfigTest, LoadSnapshot) {
+    std::string path = GetTestConfigPath("snapshot.json");
+    CreateTestConfigFile(path, R"({ "pcap": { "bpf": "udp port 53" }, "correlator": { "window_ms": 750 } })");
+
+    auto snapshot = Config::load_snapshot(path);
+    ASSERT_NE(snapshot, nullptr);
+    EXPECT_EQ(snapshot->pcap.bpf, "udp port 53");
+    EXPECT_EQ(snapshot->correlator.window_ms, 750);
+
+    // Unreadable files fall back to defaults instead of throwing
+    auto fallback = Config::load_snapshot(GetTestConfigPath("missing.json"));
+    ASSERT_NE(fallback, nullptr);
+    EXPECT_EQ(fallback->pcap.bpf, Config::get_defaults().pcap.bpf);
+}
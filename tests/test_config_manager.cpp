@@ -0,0 +1,117 @@
+#include <gtest/gtest.h>
+#include <chrono>
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+#include <string>
+#include <thread>
+
+#include "core/config_manager.hpp"
+
+using namespace environet::core;
+
+class ConfigManagerTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        system("mkdir -p test_data_cm");
+        write_config(Config::get_defaults());
+    }
+
+    void TearDown() override {
+        system("rm -rf test_data_cm");
+    }
+
+    void write_config(const Config& config) {
+        std::ofstream file(path_);
+        file << config.to_json().dump(2);
+    }
+
+    const std::string path_ = "test_data_cm/config.json";
+};
+
+TEST_F(ConfigManagerTest, DiffListsChangedKeys) {
+    Config a = Config::get_defaults();
+    Config b = a;
+    EXPECT_TRUE(ConfigManager::diff(a, b).empty());
+
+    b.pcap.bpf = "tcp port 443";
+    b.correlator.sensor_threshold = a.correlator.sensor_threshold + 10;
+    auto changed = ConfigManager::diff(a, b);
+    ASSERT_EQ(changed.size(), 2u);
+    EXPECT_NE(std::find(changed.begin(), changed.end(), "pcap.bpf"), changed.end());
+    EXPECT_NE(std::find(changed.begin(), changed.end(), "correlator.sensor_threshold"), changed.end());
+}
+
+TEST_F(ConfigManagerTest, ReloadPublishesAndNotifies) {
+    ConfigManager manager(path_, Config::get_defaults());
+    auto before = manager.current();
+
+    int calls = 0;
+    std::vector<std::string> seen;
+    manager.subscribe([&](const Config& old_cfg, const Config& new_cfg, const std::vector<std::string>& changed) {
+        ++calls;
+        seen = changed;
+        EXPECT_EQ(old_cfg.i2c.sample_interval_ms, before->i2c.sample_interval_ms);
+        EXPECT_EQ(new_cfg.i2c.sample_interval_ms, 250);
+    });
+
+    // Unchanged file: valid reload, no notification
+    EXPECT_TRUE(manager.reload());
+    EXPECT_EQ(calls, 0);
+
+    Config edited = Config::get_defaults();
+    edited.i2c.sample_interval_ms = 250;
+    write_config(edited);
+    EXPECT_TRUE(manager.reload());
+    EXPECT_EQ(calls, 1);
+    ASSERT_EQ(seen.size(), 1u);
+    EXPECT_EQ(seen[0], "i2c.sample_interval_ms");
+    EXPECT_EQ(manager.current()->i2c.sample_interval_ms, 250);
+
+    // Earlier snapshots stay valid and unchanged
+    EXPECT_EQ(before->i2c.sample_interval_ms, Config::get_defaults().i2c.sample_interval_ms);
+    EXPECT_EQ(manager.get_stats()["reloads"], 2);
+}
+
+TEST_F(ConfigManagerTest, InvalidFileKeepsRunningConfig) {
+    ConfigManager manager(path_, Config::get_defaults(), [](Config& cfg) { cfg.i2c.mock_mode = false; });
+    bool notified = false;
+    manager.subscribe([&](const Config&, const Config&, const std::vector<std::string>&) { notified = true; });
+
+    {
+        std::ofstream file(path_);
+        file << "{ \"i2c\": { \"sample_interval_ms\": ";
+    }
+    EXPECT_FALSE(manager.reload());
+    EXPECT_FALSE(notified);
+    EXPECT_FALSE(manager.get_last_error().empty());
+    EXPECT_EQ(manager.get_stats()["failed_reloads"], 1);
+    EXPECT_EQ(manager.current()->i2c.sample_interval_ms, Config::get_defaults().i2c.sample_interval_ms);
+
+    // The adjuster runs on every reload
+    write_config(Config::get_defaults());
+    EXPECT_TRUE(manager.reload());
+    EXPECT_FALSE(manager.current()->i2c.mock_mode);
+}
+
+TEST_F(ConfigManagerTest, WatchReloadsOnFileChange) {
+    ConfigManager manager(path_, Config::get_defaults());
+    ASSERT_TRUE(manager.start_watch()) << manager.get_last_error();
+
+    Config edited = Config::get_defaults();
+    edited.pcap.bpf = "udp port 53";
+    // Write to a temporary and rename, as editors and config management do
+    {
+        std::ofstream file(path_ + ".tmp");
+        file << edited.to_json().dump(2);
+    }
+    ASSERT_EQ(std::rename((path_ + ".tmp").c_str(), path_.c_str()), 0);
+
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+    while (manager.current()->pcap.bpf != "udp port 53" && std::chrono::steady_clock::now() < deadline) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    }
+    EXPECT_EQ(manager.current()->pcap.bpf, "udp port 53");
+    manager.stop_watch();
+    EXPECT_FALSE(manager.get_stats()["watching"].get<bool>());
+}
@@ -0,0 +1,280 @@
+#include <gtest/gtest.h>
+#include <cstdint>
+#include <vector>
+
+#include "net/dissector.hpp"
+#include "net/pcap_sniffer.hpp"
+#include "packet_builder.hpp"
+
+using namespace environet;
+using namespace environet::net;
+
+namespace {
+
+const std::vector<uint8_t> SRC_MAC = {0x02, 0x00, 0x00, 0x00, 0x00, 0x01};
+const std::vector<uint8_t> DST_MAC = {0x02, 0x00, 0x00, 0x00, 0x00, 0x02};
+
+// IPv4/UDP 192.168.1.10:5353 -> 192.168.1.1:53
+std::vector<uint8_t> ipv4_udp() {
+    return test::PacketBuilder().ips({192, 168, 1, 10}, {192, 168, 1, 1}).udp(5353, 53).ip_packet();
+}
+
+// IPv6/TCP [fe80::1]:443 -> [fe80::2]:49152
+test::PacketBuilder ipv6_tcp() {
+    std::vector<uint8_t> src(16, 0), dst(16, 0);
+    src[0] = dst[0] = 0xfe;
+    src[1] = dst[1] = 0x80;
+    src[15] = 1;
+    dst[15] = 2;
+    return test::PacketBuilder().ips(src, dst).tcp(443, 49152);
+}
+
+std::vector<uint8_t> concat(std::vector<uint8_t> a, const std::vector<uint8_t>& b) {
+    a.insert(a.end(), b.begin(), b.end());
+    return a;
+}
+
+bool run(int dlt, const std::vector<uint8_t>& pkt, PacketMeta& meta, PacketLayers& layers) {
+    Dissector d = dissector_for(dlt);
+    if (!d) return false;
+    return d(pkt.data(), static_cast<uint32_t>(pkt.size()), meta, layers);
+}
+
+// Radiotap (flags, rate, channel, signal, noise) + 802.11 data frame header
+std::vector<uint8_t> radiotap_80211(uint8_t fc0, uint8_t fc1, uint8_t rt_flags = 0) {
+    std::vector<uint8_t> p = {0, 0, 16, 0, 0x6e, 0, 0, 0,
+                              rt_flags, 0x02, 0x6c, 0x09, 0xa0, 0x00, 0xc4, 0xa1};
+    p.insert(p.end(), {fc0, fc1, 0, 0});
+    p.insert(p.end(), DST_MAC.begin(), DST_MAC.end());     // addr1: BSSID (to DS)
+    p.insert(p.end(), SRC_MAC.begin(), SRC_MAC.end());     // addr2: transmitter
+    p.insert(p.end(), DST_MAC.begin(), DST_MAC.end());     // addr3: destination
+    p.insert(p.end(), {0, 0});                             // Sequence control
+    return p;
+}
+
+} // namespace
+
+TEST(DissectorTest, SelectsByDatalink) {
+    EXPECT_EQ(dissector_for(DLT_EN10MB), &dissect<LinkType::EN10MB>);
+    EXPECT_EQ(dissector_for(DLT_IEEE802_11_RADIO), &dissect<LinkType::IEEE802_11_RADIO>);
+    EXPECT_EQ(dissector_for(DLT_LINUX_SLL), &dissect<LinkType::LINUX_SLL>);
+    EXPECT_EQ(dissector_for(DLT_LINUX_SLL2), &dissect<LinkType::LINUX_SLL2>);
+    EXPECT_EQ(dissector_for(DLT_RAW), &dissect<LinkType::RAW>);
+    EXPECT_EQ(dissector_for(DLT_IPV6), &dissect<LinkType::RAW>);
+    EXPECT_EQ(dissector_for(DLT_IEEE802_11), nullptr);
+
+    PcapSniffer sniffer(std::string(""));
+    EXPECT_TRUE(sniffer.set_datalink(DLT_LINUX_SLL2));
+    EXPECT_FALSE(sniffer.set_datalink(DLT_IEEE802_11));
+    EXPECT_EQ(sniffer.get_stats()["datalink"], DLT_IEEE802_11);
+}
+
+TEST(DissectorTest, EthernetIpv4Udp) {
+    auto pkt = concat(concat(concat(DST_MAC, SRC_MAC), {0x08, 0x00}), ipv4_udp());
+    PacketMeta meta;
+    PacketLayers layers;
+    ASSERT_TRUE(run(DLT_EN10MB, pkt, meta, layers));
+    EXPECT_EQ(meta.src_mac, "02:00:00:00:00:01");
+    EXPECT_EQ(meta.dst_mac, "02:00:00:00:00:02");
+    EXPECT_EQ(meta.ethertype, 0x0800);
+    EXPECT_EQ(meta.src_ip, "192.168.1.10");
+    EXPECT_EQ(meta.dst_ip, "192.168.1.1");
+    EXPECT_EQ(meta.protocol, 17);
+    EXPECT_EQ(meta.src_port, 5353);
+    EXPECT_EQ(meta.dst_port, 53);
+    EXPECT_EQ(layers.network, pkt.data() + 14);
+
+    // The static Ethernet entry point gives the same result
+    PacketMeta legacy;
+    ASSERT_TRUE(PcapSniffer::parse_packet(pkt.data(), static_cast<uint32_t>(pkt.size()), legacy));
+    EXPECT_EQ(legacy.src_ip, meta.src_ip);
+    EXPECT_EQ(legacy.dst_port, meta.dst_port);
+}
+
+TEST(DissectorTest, LinuxCookedCaptures) {
+    std::vector<uint8_t> sll = {0, 0, 0, 1, 0, 6};
+    sll = concat(concat(sll, SRC_MAC), {0, 0, 0x08, 0x00});
+    PacketMeta meta;
+    PacketLayers layers;
+    ASSERT_TRUE(run(DLT_LINUX_SLL, concat(sll, ipv4_udp()), meta, layers));
+    EXPECT_EQ(meta.src_mac, "02:00:00:00:00:01");
+    EXPECT_TRUE(meta.dst_mac.empty());
+    EXPECT_EQ(meta.dst_ip, "192.168.1.1");
+    EXPECT_EQ(meta.dst_port, 53);
+
+    std::vector<uint8_t> sll2 = {0x86, 0xdd, 0, 0, 0, 0, 0, 2, 0, 1, 0, 6};
+    sll2 = concat(concat(sll2, SRC_MAC), {0, 0});
+    PacketMeta meta6;
+    PacketLayers layers6;
+    ASSERT_TRUE(run(DLT_LINUX_SLL2, concat(sll2, ipv6_tcp().ip_packet()), meta6, layers6));
+    EXPECT_EQ(meta6.ethertype, 0x86DD);
+    EXPECT_EQ(meta6.src_mac, "02:00:00:00:00:01");
+    EXPECT_EQ(meta6.src_ip, "fe80::1");
+    EXPECT_EQ(meta6.dst_ip, "fe80::2");
+    EXPECT_EQ(meta6.protocol, 6);
+    EXPECT_EQ(meta6.src_port, 443);
+    EXPECT_EQ(meta6.dst_port, 49152);
+}
+
+TEST(DissectorTest, TransportAfterIpv6ExtensionsAndOnlyInFirstFragments) {
+    // Hop-by-hop (8 bytes) then a first fragment header, then TCP
+    auto pkt = ipv6_tcp()
+                   .extension(0, std::vector<uint8_t>(8))
+                   .extension(44, {0, 0, 0, 0x01, 0, 0, 0, 1})     // Offset 0, more fragments
+                   .ip_packet();
+    PacketMeta meta;
+    PacketLayers layers;
+    ASSERT_TRUE(run(DLT_RAW, pkt, meta, layers));
+    EXPECT_EQ(meta.protocol, 6);
+    EXPECT_EQ(meta.src_port, 443);
+    EXPECT_EQ(meta.dst_port, 49152);
+    EXPECT_EQ(layers.transport, pkt.data() + 56);
+    EXPECT_EQ(layers.transport_len, 20u);
+
+    // A later fragment has no transport header
+    pkt[48 + 3] = 0x08;
+    PacketMeta later;
+    PacketLayers later_layers;
+    ASSERT_TRUE(run(DLT_RAW, pkt, later, later_layers));
+    EXPECT_EQ(later.protocol, 44);
+    EXPECT_EQ(later.src_port, 0);
+    EXPECT_EQ(later_layers.transport, nullptr);
+
+    auto frag4 = ipv4_udp();
+    frag4[7] = 0x10;                                           // Fragment offset 128 bytes
+    PacketMeta meta4;
+    PacketLayers layers4;
+    ASSERT_TRUE(run(DLT_IPV4, frag4, meta4, layers4));
+    EXPECT_EQ(meta4.protocol, 17);
+    EXPECT_EQ(meta4.dst_port, 0);
+    EXPECT_EQ(layers4.transport, nullptr);
+    ASSERT_TRUE(run(DLT_IPV4, ipv4_udp(), meta4, layers4));
+    EXPECT_EQ(layers4.transport_len, 8u);
+}
+
+TEST(DissectorTest, RawIp) {
+    PacketMeta meta;
+    PacketLayers layers;
+    auto pkt = ipv6_tcp().ip_packet();
+    ASSERT_TRUE(run(DLT_RAW, pkt, meta, layers));
+    EXPECT_EQ(meta.ethertype, 0x86DD);
+    EXPECT_EQ(meta.dst_ip, "fe80::2");
+    EXPECT_EQ(layers.src_mac, nullptr);
+    EXPECT_EQ(layers.network, pkt.data());
+
+    PacketMeta meta4;
+    PacketLayers layers4;
+    ASSERT_TRUE(run(DLT_IPV4, ipv4_udp(), meta4, layers4));
+    EXPECT_EQ(meta4.src_port, 5353);
+
+    PacketMeta junk;
+    PacketLayers junk_layers;
+    EXPECT_FALSE(run(DLT_RAW, {0x10, 0, 0, 0}, junk, junk_layers));
+}
+
+TEST(DissectorTest, RadiotapQosDataFrame) {
+    // QoS data, to DS; QoS control then LLC/SNAP
+    auto pkt = concat(radiotap_80211(0x88, 0x01), {0, 0, 0xaa, 0xaa, 0x03, 0, 0, 0, 0x08, 0x00});
+    pkt = concat(pkt, ipv4_udp());
+    PacketMeta meta;
+    PacketLayers layers;
+    ASSERT_TRUE(run(DLT_IEEE802_11_RADIO, pkt, meta, layers));
+    EXPECT_EQ(meta.signal_strength, -60);
+    EXPECT_EQ(meta.noise_level, -95);
+    EXPECT_EQ(meta.frequency_mhz, 2412);
+    EXPECT_EQ(meta.src_mac, "02:00:00:00:00:01");
+    EXPECT_EQ(meta.dst_mac, "02:00:00:00:00:02");
+    EXPECT_EQ(meta.ethertype, 0x0800);
+    EXPECT_EQ(meta.src_ip, "192.168.1.10");
+    EXPECT_EQ(meta.dst_port, 53);
+}
+
+TEST(DissectorTest, RadiotapProtectedAndManagementFrames) {
+    // Protected data: addresses and signal, no payload parsing
+    auto pkt = concat(radiotap_80211(0x08, 0x41), {0xaa, 0xaa, 0x03, 0, 0, 0, 0x08, 0x00});
+    pkt = concat(pkt, ipv4_udp());
+    PacketMeta meta;
+    PacketLayers layers;
+    ASSERT_TRUE(run(DLT_IEEE802_11_RADIO, pkt, meta, layers));
+    EXPECT_EQ(meta.signal_strength, -60);
+    EXPECT_EQ(meta.src_mac, "02:00:00:00:00:01");
+    EXPECT_EQ(meta.ethertype, 0);
+    EXPECT_TRUE(meta.src_ip.empty());
+    EXPECT_EQ(layers.network, nullptr);
+
+    // Beacon: transmitter is addr2
+    PacketMeta beacon;
+    PacketLayers beacon_layers;
+    ASSERT_TRUE(run(DLT_IEEE802_11_RADIO, radiotap_80211(0x80, 0x00), beacon, beacon_layers));
+    EXPECT_EQ(beacon.src_mac, "02:00:00:00:00:01");
+}
+
+TEST(DissectorTest, LengthExcludesLinkPaddingAndFcs) {
+    // Minimum-size Ethernet frame: 42 bytes of headers padded to 60
+    auto eth = concat(concat(concat(DST_MAC, SRC_MAC), {0x08, 0x00}), ipv4_udp());
+    eth.resize(60, 0);
+    PacketMeta meta;
+    PacketLayers layers;
+    meta.length = static_cast<uint32_t>(eth.size());
+    ASSERT_TRUE(run(DLT_EN10MB, eth, meta, layers));
+    EXPECT_EQ(meta.length, 42u);
+    EXPECT_EQ(layers.network_len, 28u);
+    EXPECT_EQ(layers.transport_len, 8u);
+
+    // Total length 0 (segmentation offload) leaves the captured length alone
+    eth[16] = eth[17] = 0;
+    PacketMeta tso;
+    PacketLayers tso_layers;
+    tso.length = static_cast<uint32_t>(eth.size());
+    ASSERT_TRUE(run(DLT_EN10MB, eth, tso, tso_layers));
+    EXPECT_EQ(tso.length, 60u);
+    EXPECT_EQ(tso.dst_port, 53);
+
+    // Radiotap flags 0x10: the trailing FCS is neither payload nor counted
+    auto radio = concat(radiotap_80211(0x08, 0x01, 0x10), {0xaa, 0xaa, 0x03, 0, 0, 0, 0x08, 0x00});
+    radio = concat(concat(radio, ipv4_udp()), {0xde, 0xad, 0xbe, 0xef});
+    PacketMeta rmeta;
+    PacketLayers rlayers;
+    rmeta.length = static_cast<uint32_t>(radio.size());
+    ASSERT_TRUE(run(DLT_IEEE802_11_RADIO, radio, rmeta, rlayers));
+    EXPECT_EQ(rmeta.length, radio.size() - 4);
+    EXPECT_EQ(rlayers.network_len, 28u);
+    EXPECT_EQ(rmeta.dst_port, 53);
+
+    // Snapped before the FCS: the wire length still drops it
+    std::vector<uint8_t> snapped(radio.begin(), radio.end() - 6);
+    PacketMeta smeta;
+    PacketLayers slayers;
+    smeta.length = static_cast<uint32_t>(radio.size());
+    ASSERT_TRUE(run(DLT_IEEE802_11_RADIO, snapped, smeta, slayers));
+    EXPECT_EQ(smeta.length, radio.size() - 4);
+    EXPECT_EQ(slayers.network_len, 26u);
+}
+
+TEST(DissectorTest, TruncatedFramesStayInBounds) {
+    auto eth = concat(concat(concat(DST_MAC, SRC_MAC), {0x08, 0x00}), ipv4_udp());
+    auto radio = concat(radiotap_80211(0x88, 0x01), {0, 0, 0xaa, 0xaa, 0x03, 0, 0, 0, 0x08, 0x00});
+    radio = concat(radio, ipv4_udp());
+    for (int dlt : {DLT_EN10MB, DLT_IEEE802_11_RADIO, DLT_LINUX_SLL, DLT_LINUX_SLL2, DLT_RAW}) {
+        const auto& full = dlt == DLT_IEEE802_11_RADIO ? radio : eth;
+        for (size_t len = 0; len < full.size(); ++len) {
+            // Exact-size copy so a read past caplen is caught by sanitizers
+            std::vector<uint8_t> cut(full.begin(), full.begin() + len);
+            PacketMeta meta;
+            PacketLayers layers;
+            run(dlt, cut, meta, layers);
+            if (layers.network) {
+                EXPECT_LE(layers.network + layers.network_len, cut.data() + cut.size());
+            }
+        }
+    }
+
+    PacketMeta meta;
+    PacketLayers layers;
+    std::vector<uint8_t> short_eth(eth.begin(), eth.begin() + 13);
+    EXPECT_FALSE(run(DLT_EN10MB, short_eth, meta, layers));
+    std::vector<uint8_t> no_ports(eth.begin(), eth.begin() + 14 + 20);
+    ASSERT_TRUE(run(DLT_EN10MB, no_ports, meta, layers));
+    EXPECT_EQ(meta.dst_ip, "192.168.1.1");
+    EXPECT_EQ(meta.dst_port, 0);
+}
@@ -0,0 +1,267 @@
+#include <gtest/gtest.h>
+#include <chrono>
+#include <cstdint>
+#include <thread>
+#include <vector>
+
+#include "correlate/correlator.hpp"
+#include "net/dns_analyzer.hpp"
+#include "packet_builder.hpp"
+
+using namespace environet;
+using namespace environet::net;
+
+namespace {
+
+const std::vector<uint8_t> CLIENT = {192, 168, 1, 20};
+const std::vector<uint8_t> RESOLVER = {192, 168, 1, 1};
+const std::vector<uint8_t> CLIENT6 = {0xfd, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0x20};
+const std::vector<uint8_t> RESOLVER6 = {0xfd, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0x01};
+
+// Frame between two hosts over UDP or TCP; IPv6 for 16-byte addresses
+test::PacketBuilder dns_packet(uint8_t protocol, const std::vector<uint8_t>& src, const std::vector<uint8_t>& dst,
+                               uint16_t src_port, uint16_t dst_port) {
+    return test::PacketBuilder().ips(src, dst).ports(protocol, src_port, dst_port).tcp_flags(0x18);
+}
+
+// 12-byte DNS header with one question (and one answer in a response)
+std::vector<uint8_t> dns_header(uint16_t txid, bool response, uint8_t rcode = 0) {
+    return {static_cast<uint8_t>(txid >> 8), static_cast<uint8_t>(txid),
+            static_cast<uint8_t>(response ? 0x81 : 0x01), static_cast<uint8_t>(response ? 0x80 | rcode : 0),
+            0, 1, 0, static_cast<uint8_t>(response ? 1 : 0), 0, 0, 0, 0};
+}
+
+// Message behind the two-byte length prefix used over TCP
+std::vector<uint8_t> length_prefixed(const std::vector<uint8_t>& message, uint16_t length) {
+    std::vector<uint8_t> p = {static_cast<uint8_t>(length >> 8), static_cast<uint8_t>(length)};
+    p.insert(p.end(), message.begin(), message.end());
+    return p;
+}
+
+// Frame carrying a DNS header over UDP or, length-prefixed, over TCP
+std::vector<uint8_t> dns_frame(uint8_t protocol, const std::vector<uint8_t>& src, const std::vector<uint8_t>& dst,
+                               uint16_t src_port, uint16_t dst_port, uint16_t txid, bool response,
+                               uint8_t rcode = 0) {
+    auto message = dns_header(txid, response, rcode);
+    if (protocol == 6) message = length_prefixed(message, 12);
+    return dns_packet(protocol, src, dst, src_port, dst_port).payload(message).frame();
+}
+
+uint64_t steady_ms() {
+    using namespace std::chrono;
+    return duration_cast<milliseconds>(steady_clock::now().time_since_epoch()).count();
+}
+
+struct Replay {
+    DnsAnalyzer& dns;
+    uint64_t now_ms;
+
+    void operator()(uint64_t ts_us, const std::vector<uint8_t>& frame) const {
+        auto f = test::dissect_frame(frame);
+        dns.process_at(now_ms, ts_us, f.meta, f.layers);
+    }
+};
+
+DnsSample drain_all(DnsAnalyzer& dns, uint64_t now_ms) {
+    std::vector<DnsSample> samples;
+    dns.drain(now_ms, samples);
+    DnsSample total;
+    for (const auto& s : samples) {
+        total.queries += s.queries;
+        total.responses += s.responses;
+        total.nxdomain += s.nxdomain;
+        total.servfail += s.servfail;
+        total.timeouts += s.timeouts;
+        total.unmatched += s.unmatched;
+        total.latency_sum_us += s.latency_sum_us;
+        total.latency_max_us = std::max(total.latency_max_us, s.latency_max_us);
+    }
+    return total;
+}
+
+} // namespace
+
+TEST(DnsAnalyzerTest, MatchesQueriesToResponses) {
+    auto config = std::make_shared<core::Config>(core::Config::get_defaults());
+    DnsAnalyzer dns(config);
+    ASSERT_TRUE(dns.init());
+    const uint64_t now = steady_ms();
+    Replay replay{dns, now};
+
+    // UDP: answered in 12 ms, NXDOMAIN in 30 ms, a retransmitted query answered once
+    replay(1000000, dns_frame(17, CLIENT, RESOLVER, 40000, 53, 0x1234, false));
+    replay(1012000, dns_frame(17, RESOLVER, CLIENT, 53, 40000, 0x1234, true));
+    replay(1000000, dns_frame(17, CLIENT, RESOLVER, 40001, 53, 0x0001, false));
+    replay(1030000, dns_frame(17, RESOLVER, CLIENT, 53, 40001, 0x0001, true, 3));
+    replay(1100000, dns_frame(17, CLIENT, RESOLVER, 40002, 53, 0x0002, false));
+    replay(1600000, dns_frame(17, CLIENT, RESOLVER, 40002, 53, 0x0002, false));
+    replay(1700000, dns_frame(17, RESOLVER, CLIENT, 53, 40002, 0x0002, true, 2));
+    // Same txid from another client port is a different query
+    replay(1700000, dns_frame(17, RESOLVER, CLIENT, 53, 40003, 0x0002, true));
+    // TCP with the length prefix; a bare ACK on port 53 is ignored
+    replay(2000000, dns_frame(6, CLIENT, RESOLVER, 50000, 53, 0xbeef, false));
+    replay(2004000, dns_frame(6, RESOLVER, CLIENT, 53, 50000, 0xbeef, true));
+    replay(2005000, dns_packet(6, CLIENT, RESOLVER, 50000, 53).tcp_flags(0x10).frame());
+
+    DnsSample total = drain_all(dns, now + 1000);
+    EXPECT_EQ(total.queries, 5u);
+    EXPECT_EQ(total.responses, 4u);
+    EXPECT_EQ(total.nxdomain, 1u);
+    EXPECT_EQ(total.servfail, 1u);
+    EXPECT_EQ(total.unmatched, 1u);
+    EXPECT_EQ(total.timeouts, 0u);
+    EXPECT_EQ(total.latency_sum_us, 12000u + 30000u + 600000u + 4000u);
+    EXPECT_EQ(total.latency_max_us, 600000u);    // Measured from the first send
+    EXPECT_EQ(dns.get_stats()["pending"].get<size_t>(), 0u);
+
+    // Nothing new: the next drain only closes idle intervals
+    EXPECT_EQ(drain_all(dns, now + 3000).queries, 0u);
+
+    PacketMeta ntp;
+    ntp.src_port = 123;
+    ntp.dst_port = 123;
+    size_t len = 0;
+    EXPECT_EQ(DnsAnalyzer::dns_message(ntp, PacketLayers{}, len), nullptr);
+}
+
+TEST(DnsAnalyzerTest, MatchesQueriesOverIpv6) {
+    auto config = std::make_shared<core::Config>(core::Config::get_defaults());
+    DnsAnalyzer dns(config);
+    ASSERT_TRUE(dns.init());
+    const uint64_t now = steady_ms();
+    Replay replay{dns, now};
+
+    replay(1000000, dns_frame(17, CLIENT6, RESOLVER6, 40000, 53, 0x6666, false));
+    replay(1008000, dns_frame(17, RESOLVER6, CLIENT6, 53, 40000, 0x6666, true));
+    replay(2000000, dns_frame(6, CLIENT6, RESOLVER6, 50000, 53, 0x7777, false));
+    replay(2020000, dns_frame(6, RESOLVER6, CLIENT6, 53, 50000, 0x7777, true, 3));
+
+    DnsSample total = drain_all(dns, now + 1000);
+    EXPECT_EQ(total.queries, 2u);
+    EXPECT_EQ(total.responses, 2u);
+    EXPECT_EQ(total.nxdomain, 1u);
+    EXPECT_EQ(total.unmatched, 0u);
+    EXPECT_EQ(total.latency_sum_us, 8000u + 20000u);
+}
+
+TEST(DnsAnalyzerTest, ReadsOnlyWholeTcpMessagesAndSkipsIpv6Extensions) {
+    auto config = std::make_shared<core::Config>(core::Config::get_defaults());
+    DnsAnalyzer dns(config);
+    ASSERT_TRUE(dns.init());
+    const uint64_t now = steady_ms();
+    Replay replay{dns, now};
+
+    // Link padding after the datagram does not hide a whole message
+    auto padded = dns_frame(6, CLIENT, RESOLVER, 50000, 53, 0x1111, false);
+    padded.resize(padded.size() + 6, 0);
+    replay(1000000, padded);
+    replay(1010000, dns_frame(6, RESOLVER, CLIENT, 53, 50000, 0x1111, true));
+    // A segment continuing a longer message is not read as a header
+    auto continued = length_prefixed(dns_header(0x2222, false), 200);
+    replay(2000000, dns_packet(6, CLIENT, RESOLVER, 50001, 53).payload(continued).frame());
+    // Nor is a segment carrying two messages
+    auto pipelined = length_prefixed(dns_header(0x3333, false), 12);
+    auto second = length_prefixed(dns_header(0x3334, false), 12);
+    pipelined.insert(pipelined.end(), second.begin(), second.end());
+    replay(3000000, dns_packet(6, CLIENT, RESOLVER, 50002, 53).payload(pipelined).frame());
+    // UDP behind an IPv6 hop-by-hop header
+    replay(4000000, dns_packet(17, CLIENT6, RESOLVER6, 40000, 53)
+                        .extension(0, std::vector<uint8_t>(8))
+                        .payload(dns_header(0x4444, false))
+                        .frame());
+    replay(4005000, dns_packet(17, RESOLVER6, CLIENT6, 53, 40000)
+                        .extension(0, std::vector<uint8_t>(8))
+                        .payload(dns_header(0x4444, true))
+                        .frame());
+
+    DnsSample total = drain_all(dns, now + 1000);
+    EXPECT_EQ(total.queries, 2u);
+    EXPECT_EQ(total.responses, 2u);
+    EXPECT_EQ(total.unmatched, 0u);
+    EXPECT_EQ(total.latency_sum_us, 10000u + 5000u);
+}
+
+TEST(DnsAnalyzerTest, BoundsPendingQueries) {
+    auto config = std::make_shared<core::Config>(core::Config::get_defaults());
+    config->dns.max_pending = 64;
+    config->dns.timeout_ms = 1000;
+    DnsAnalyzer dns(config);
+    ASSERT_TRUE(dns.init());
+    const uint64_t now = steady_ms();
+    Replay replay{dns, now};
+
+    // A flood of unanswered queries evicts the oldest instead of growing
+    for (uint16_t i = 0; i < 1000; ++i) {
+        replay(1000000 + i, dns_frame(17, CLIENT, RESOLVER, static_cast<uint16_t>(1024 + i), 53, i, false));
+    }
+    size_t pending = dns.get_stats()["pending"].get<size_t>();
+    EXPECT_LE(pending, 64u);
+    EXPECT_GT(pending, 32u);
+    DnsSample first = drain_all(dns, now + 1000);
+    EXPECT_EQ(first.queries, 1000u);
+    EXPECT_EQ(first.timeouts, 1000u - pending);
+
+    // When the interval closes, the sweep expires everything older than the timeout
+    Replay later{dns, now + 1000};
+    later(2500000, dns_frame(17, CLIENT, RESOLVER, 60000, 53, 7, false));
+    DnsSample second = drain_all(dns, now + 2000);
+    EXPECT_EQ(second.queries, 1u);
+    EXPECT_EQ(first.timeouts + second.timeouts, 1000u);
+    EXPECT_EQ(dns.get_stats()["pending"].get<size_t>(), 1u);
+}
+
+TEST(DnsAnalyzerTest, CorrelatorReportsDnsShift) {
+    auto config = std::make_shared<core::Config>(core::Config::get_defaults());
+    config->correlator.window_ms = 200;
+    config->correlator.sensor_threshold = 50;
+    correlate::Correlator corr(config);
+    ASSERT_TRUE(corr.init());
+
+    BssInfo ap("office-net", "aa:bb:cc:00:00:01", 2412, -5000);
+    sensors::SensorFrame frame;
+    frame.ir_raw = 100;
+    corr.push_bss(ap);
+    corr.push_sensor(frame);
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    frame.ir_raw = 400;
+    corr.push_sensor(frame);
+    const uint64_t ts = steady_ms();
+
+    // Before: 10 ms responses, no failures; after: 50 ms, a quarter failed
+    DnsSample before;
+    before.timestamp_ms = ts - 150;
+    before.interval_ms = 100;
+    before.queries = 40;
+    before.responses = 40;
+    before.latency_sum_us = 40 * 10000;
+    before.latency_max_us = 15000;
+    corr.push_dns(before);
+    DnsSample after;
+    after.timestamp_ms = ts + 20;
+    after.interval_ms = 100;
+    after.queries = 40;
+    after.responses = 35;
+    after.servfail = 5;
+    after.nxdomain = 7;
+    after.timeouts = 5;
+    after.latency_sum_us = 35 * 50000;
+    after.latency_max_us = 120000;
+    corr.push_dns(after);
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    ap.signal_mbm = -6000;
+    corr.push_bss(ap);
+    std::this_thread::sleep_for(std::chrono::milliseconds(250));
+
+    ASSERT_EQ(corr.process(), 1u);
+    auto findings = corr.get_findings();
+    ASSERT_EQ(findings.size(), 1u);
+    EXPECT_NEAR(findings[0].dns_latency_delta, 40.0, 1e-9);
+    EXPECT_NEAR(findings[0].dns_failure_delta, 25.0, 1e-9);
+
+    auto stats = corr.get_window_stats(ts, ts + 200);
+    EXPECT_EQ(stats["dns_queries"].get<uint64_t>(), 40u);
+    EXPECT_NEAR(stats["dns_avg_latency_ms"].get<double>(), 50.0, 1e-9);
+    EXPECT_NEAR(stats["dns_max_latency_ms"].get<double>(), 120.0, 1e-9);
+    EXPECT_NEAR(stats["dns_nxdomain_rate"].get<double>(), 0.2, 1e-9);
+    EXPECT_EQ(stats["dns_timeouts"].get<uint64_t>(), 5u);
+}
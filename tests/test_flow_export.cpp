@@ -0,0 +1,398 @@
+#include <gtest/gtest.h>
+#include <arpa/inet.h>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <memory>
+#include <netinet/in.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <vector>
+
+#include "net/flow_export.hpp"
+#include "packet_builder.hpp"
+
+using namespace environet;
+using namespace environet::net;
+
+namespace {
+
+constexpr uint64_t T0 = 1760000000000ULL;      // Capture timestamps (wall clock ms)
+constexpr uint32_t PEN = 32473;
+
+uint64_t get_be(const uint8_t* p, size_t n) {
+    uint64_t v = 0;
+    for (size_t i = 0; i < n; ++i) v = (v << 8) | p[i];
+    return v;
+}
+
+// Ethernet/IPv4 or IPv6 frame from 10.0.0.<host> (fd00::<host>) to .1 with @p payload zero bytes
+std::vector<uint8_t> frame(bool v6, uint8_t protocol, uint8_t host, uint16_t src_port, uint16_t dst_port,
+                           uint8_t tcp_flags = 0, size_t payload = 0) {
+    test::PacketBuilder b;
+    b.macs({0x02, 0, 0, 0, 0, host}, {0x02, 0, 0, 0, 0, 0x02});
+    if (v6) {
+        std::vector<uint8_t> src(16, 0), dst(16, 0);
+        src[0] = dst[0] = 0xfd;
+        src[15] = host;
+        dst[15] = 1;
+        b.ips(src, dst);
+    } else {
+        b.ips({10, 0, 0, host}, {10, 0, 0, 1});
+    }
+    return b.ports(protocol, src_port, dst_port).tcp_flags(tcp_flags).payload(std::vector<uint8_t>(payload)).frame();
+}
+
+// UDP socket on loopback standing in for the flow collector
+struct Collector {
+    int fd = -1;
+    uint16_t port = 0;
+
+    Collector() {
+        fd = ::socket(AF_INET, SOCK_DGRAM, 0);
+        sockaddr_in addr{};
+        addr.sin_family = AF_INET;
+        addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        ::bind(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr));
+        socklen_t len = sizeof(addr);
+        ::getsockname(fd, reinterpret_cast<sockaddr*>(&addr), &len);
+        port = ntohs(addr.sin_port);
+    }
+    ~Collector() { ::close(fd); }
+
+    std::vector<std::vector<uint8_t>> receive(int timeout_ms = 200) {
+        std::vector<std::vector<uint8_t>> out;
+        pollfd pfd{fd, POLLIN, 0};
+        while (::poll(&pfd, 1, timeout_ms) > 0) {
+            std::vector<uint8_t> buf(65536);
+            ssize_t n = ::recv(fd, buf.data(), buf.size(), 0);
+            if (n <= 0) break;
+            buf.resize(static_cast<size_t>(n));
+            out.push_back(std::move(buf));
+            timeout_ms = 50;
+        }
+        return out;
+    }
+};
+
+struct Field {
+    uint16_t id;
+    uint16_t length;
+    uint32_t enterprise;
+};
+
+// Decoded data record: (enterprise, IE id) -> value (addresses and MACs as raw bytes)
+struct Record {
+    uint16_t template_id = 0;
+    std::map<std::pair<uint32_t, uint16_t>, uint64_t> values;
+    std::map<std::pair<uint32_t, uint16_t>, std::vector<uint8_t>> raw;
+
+    uint64_t operator[](uint16_t id) const { return values.at({0, id}); }
+    uint64_t custom(FlowEnterpriseIe ie) const { return values.at({PEN, static_cast<uint16_t>(ie)}); }
+};
+
+// Minimal IPFIX / NetFlow v9 collector: keeps templates across datagrams
+struct Decoder {
+    std::map<uint16_t, std::vector<Field>> templates;
+    std::vector<Record> records;
+    size_t template_records = 0;
+
+    void decode(const std::vector<uint8_t>& d) {
+        bool ipfix = get_be(d.data(), 2) == 10;
+        size_t off = ipfix ? 16 : 20;
+        if (ipfix) {
+            ASSERT_EQ(get_be(d.data() + 2, 2), d.size());
+        }
+        while (off + 4 <= d.size()) {
+            uint16_t set_id = static_cast<uint16_t>(get_be(&d[off], 2));
+            size_t set_len = get_be(&d[off + 2], 2);
+            ASSERT_GE(set_len, 4u);
+            ASSERT_LE(off + set_len, d.size());
+            if (!ipfix) {
+                EXPECT_EQ(set_len % 4, 0u);
+            }
+            size_t end = off + set_len;
+            size_t p = off + 4;
+            if (set_id == (ipfix ? 2 : 0)) {
+                while (p + 4 <= end) {
+                    uint16_t id = static_cast<uint16_t>(get_be(&d[p], 2));
+                    size_t count = get_be(&d[p + 2], 2);
+                    p += 4;
+                    std::vector<Field> fields;
+                    for (size_t i = 0; i < count; ++i) {
+                        Field f{static_cast<uint16_t>(get_be(&d[p], 2)), static_cast<uint16_t>(get_be(&d[p + 2], 2)), 0};
+                        p += 4;
+                        if (f.id & 0x8000) {
+                            f.id &= 0x7FFF;
+                            if (ipfix) {
+                                f.enterprise = static_cast<uint32_t>(get_be(&d[p], 4));
+                                p += 4;
+                            } else {
+                                f.enterprise = PEN;     // NetFlow v9: vendor types, no enterprise number
+                            }
+                        }
+                        fields.push_back(f);
+                    }
+                    templates[id] = fields;
+                    ++template_records;
+                }
+            } else {
+                ASSERT_TRUE(templates.count(set_id)) << "data set before its template";
+                const auto& fields = templates[set_id];
+                size_t size = 0;
+                for (const auto& f : fields) size += f.length;
+                while (p + size <= end) {
+                    Record r;
+                    r.template_id = set_id;
+                    for (const auto& f : fields) {
+                        r.values[{f.enterprise, f.id}] = f.length <= 8 ? get_be(&d[p], f.length) : 0;
+                        r.raw[{f.enterprise, f.id}].assign(&d[p], &d[p] + f.length);
+                        p += f.length;
+                    }
+                    records.push_back(r);
+                }
+            }
+            off = end;
+        }
+    }
+};
+
+struct Harness {
+    Collector collector;
+    std::unique_ptr<FlowExporter> exporter;
+
+    explicit Harness(std::function<void(core::Config&)> tweak = {}) {
+        auto config = std::make_shared<core::Config>(core::Config::get_defaults());
+        config->flow_export.enabled = true;
+        config->flow_export.collector_port = collector.port;
+        if (tweak) tweak(*config);
+        exporter = std::make_unique<FlowExporter>(config);
+    }
+
+    void feed(uint64_t ts_ms, const std::vector<uint8_t>& f, int rssi = 0) {
+        auto pkt = test::dissect_frame(f);
+        pkt.meta.timestamp_ms = ts_ms;
+        if (rssi) {
+            pkt.meta.signal_strength = rssi;
+            pkt.meta.noise_level = -95;
+            pkt.meta.frequency_mhz = 2437;
+        }
+        exporter->process(pkt.meta, pkt.layers);
+    }
+};
+
+} // namespace
+
+TEST(FlowExportTest, IpfixTemplatesRecordsAndEnterpriseIes) {
+    Harness h;
+    ASSERT_TRUE(h.exporter->init()) << h.exporter->get_last_error();
+    h.exporter->set_sensor_context(-300, 1250, 0x05);
+
+    // TCP connection closed by FIN, a UDP exchange over IPv6, an IPv4 UDP flow with radio context
+    h.feed(T0, frame(false, 6, 20, 40000, 443, 0x02));
+    h.feed(T0 + 10, frame(false, 6, 20, 40000, 443, 0x18, 100));
+    h.feed(T0 + 20, frame(false, 6, 20, 40000, 443, 0x11));
+    h.feed(T0 + 30, frame(true, 17, 20, 5353, 5353, 0, 50));
+    h.feed(T0 + 40, frame(false, 17, 21, 1234, 53, 0, 30), -40);
+    h.feed(T0 + 50, frame(false, 17, 21, 1234, 53, 0, 30), -60);
+
+    // Only the finished connection goes out before the inactive timeout
+    h.exporter->expire_at(T0 + 1000);
+    auto first = h.collector.receive();
+    ASSERT_EQ(first.size(), 1u);
+    EXPECT_EQ(get_be(first[0].data(), 2), 10u);
+    EXPECT_EQ(get_be(first[0].data() + 8, 4), 0u);                 // Sequence: data records before this one
+    EXPECT_EQ(get_be(first[0].data() + 12, 4), 1u);                // Observation domain
+    Decoder dec;
+    dec.decode(first[0]);
+    EXPECT_EQ(dec.template_records, 2u);
+    ASSERT_EQ(dec.records.size(), 1u);
+    const Record& tcp = dec.records[0];
+    EXPECT_EQ(tcp.template_id, FlowExporter::IPV4_TEMPLATE_ID);
+    EXPECT_EQ(tcp[8], 0x0A000014u);                                 // sourceIPv4Address 10.0.0.20
+    EXPECT_EQ(tcp[12], 0x0A000001u);
+    EXPECT_EQ(tcp[7], 40000u);
+    EXPECT_EQ(tcp[11], 443u);
+    EXPECT_EQ(tcp[4], 6u);
+    EXPECT_EQ(tcp[6], 0x1Bu);                                       // SYN|PSH|ACK|FIN
+    EXPECT_EQ(tcp[2], 3u);
+    EXPECT_EQ(tcp[1], 3u * 40 + 100);                              // IP bytes, no Ethernet header
+    EXPECT_EQ(tcp[152], T0);
+    EXPECT_EQ(tcp[153], T0 + 20);
+    EXPECT_EQ(tcp[136], static_cast<uint64_t>(FlowEndReason::EndOfFlow));
+    EXPECT_EQ(tcp.raw.at({0, 56}), (std::vector<uint8_t>{0x02, 0, 0, 0, 0, 20}));
+    EXPECT_EQ(static_cast<int16_t>(tcp.custom(FlowEnterpriseIe::SensorIrRaw)), -300);
+    EXPECT_EQ(tcp.custom(FlowEnterpriseIe::SensorUltrasonicMm), 1250u);
+    EXPECT_EQ(tcp.custom(FlowEnterpriseIe::SensorStatus), 0x05u);
+    EXPECT_EQ(tcp.custom(FlowEnterpriseIe::ChannelFrequency), 0u);  // No radiotap
+
+    // The rest idle out; templates are not repeated before the refresh interval
+    h.exporter->expire_at(T0 + 20000);
+    auto second = h.collector.receive();
+    ASSERT_EQ(second.size(), 1u);
+    EXPECT_EQ(get_be(second[0].data() + 8, 4), 1u);
+    dec.decode(second[0]);
+    EXPECT_EQ(dec.template_records, 2u);
+    ASSERT_EQ(dec.records.size(), 3u);
+    std::map<uint16_t, Record> by_template;
+    for (size_t i = 1; i < dec.records.size(); ++i) {
+        EXPECT_EQ(dec.records[i][136], static_cast<uint64_t>(FlowEndReason::Idle));
+        by_template[dec.records[i].template_id] = dec.records[i];
+    }
+    const Record& v6 = by_template.at(FlowExporter::IPV6_TEMPLATE_ID);
+    EXPECT_EQ(v6.raw.at({0, 27}).back(), 20u);                      // sourceIPv6Address fd00::14
+    EXPECT_EQ(v6[7], 5353u);
+    const Record& radio = by_template.at(FlowExporter::IPV4_TEMPLATE_ID);
+    EXPECT_EQ(radio[2], 2u);
+    EXPECT_EQ(static_cast<int8_t>(radio.custom(FlowEnterpriseIe::RssiAverage)), -50);
+    EXPECT_EQ(static_cast<int8_t>(radio.custom(FlowEnterpriseIe::RssiMinimum)), -60);
+    EXPECT_EQ(static_cast<int8_t>(radio.custom(FlowEnterpriseIe::RssiMaximum)), -40);
+    EXPECT_EQ(static_cast<int8_t>(radio.custom(FlowEnterpriseIe::NoiseAverage)), -95);
+    EXPECT_EQ(radio.custom(FlowEnterpriseIe::ChannelFrequency), 2437u);
+
+    auto stats = h.exporter->get_stats();
+    EXPECT_EQ(stats["records"], 3);
+    EXPECT_EQ(stats["flows_active"], 0);
+    EXPECT_EQ(stats["datagrams"], 2);
+    EXPECT_EQ(stats["send_errors"], 0);
+}
+
+TEST(FlowExportTest, ActiveTimeoutExportsLongFlowsInPieces) {
+    Harness h([](core::Config& c) {
+        c.flow_export.active_timeout_ms = 60000;
+        c.flow_export.inactive_timeout_ms = 15000;
+    });
+    ASSERT_TRUE(h.exporter->init());
+    // One packet every 10 s for 150 s, expiry checked once a second
+    for (uint64_t t = 0; t <= 150000; t += 1000) {
+        if (t % 10000 == 0) h.feed(T0 + t, frame(false, 17, 30, 9000, 9001, 0, 10));
+        h.exporter->expire_at(T0 + t);
+    }
+    h.exporter->flush();
+
+    Decoder dec;
+    for (const auto& d : h.collector.receive()) dec.decode(d);
+    ASSERT_EQ(dec.records.size(), 3u);
+    uint64_t packets = 0;
+    for (const auto& r : dec.records) {
+        packets += r[2];
+        EXPECT_LT(r[153] - r[152], 60000u);
+    }
+    EXPECT_EQ(packets, 16u);
+    EXPECT_EQ(dec.records[0][136], static_cast<uint64_t>(FlowEndReason::Active));
+    EXPECT_EQ(dec.records[1][136], static_cast<uint64_t>(FlowEndReason::Active));
+    EXPECT_EQ(dec.records[2][136], static_cast<uint64_t>(FlowEndReason::Forced));
+    EXPECT_EQ(dec.records[1][152], T0 + 60000);
+}
+
+TEST(FlowExportTest, OctetCountExcludesRadiotapAnd80211Headers) {
+    Harness h;
+    ASSERT_TRUE(h.exporter->init());
+    auto ip = test::PacketBuilder().ips({10, 0, 0, 40}, {10, 0, 0, 1}).udp(5000, 5001)
+                  .payload(std::vector<uint8_t>(60)).ip_packet();
+    // Radiotap (flags, rate, channel, signal, noise), 802.11 data to DS, LLC/SNAP
+    std::vector<uint8_t> pkt = {0, 0, 16, 0, 0x6e, 0, 0, 0, 0x10, 0x02, 0x6c, 0x09, 0xa0, 0x00, 0xc4, 0xa1,
+                                0x08, 0x01, 0, 0};
+    for (int i = 0; i < 3; ++i) pkt.insert(pkt.end(), {0x02, 0, 0, 0, 0, static_cast<uint8_t>(i + 1)});
+    pkt.insert(pkt.end(), {0, 0, 0xaa, 0xaa, 0x03, 0, 0, 0, 0x08, 0x00});
+    pkt.insert(pkt.end(), ip.begin(), ip.end());
+    for (uint64_t t = 0; t < 2; ++t) {
+        PacketMeta meta;
+        PacketLayers layers;
+        meta.length = static_cast<uint32_t>(pkt.size());
+        meta.timestamp_ms = T0 + t;
+        ASSERT_TRUE(dissect<LinkType::IEEE802_11_RADIO>(pkt.data(), meta.length, meta, layers));
+        h.exporter->process(meta, layers);
+    }
+    h.exporter->flush();
+
+    Decoder dec;
+    for (const auto& d : h.collector.receive()) dec.decode(d);
+    ASSERT_EQ(dec.records.size(), 1u);
+    EXPECT_EQ(dec.records[0][2], 2u);
+    EXPECT_EQ(dec.records[0][1], 2u * ip.size());
+    EXPECT_EQ(dec.records[0].custom(FlowEnterpriseIe::ChannelFrequency), 2412u);
+}
+
+TEST(FlowExportTest, NetflowV9HeaderAndVendorFields) {
+    Harness h([](core::Config& c) { c.flow_export.protocol = "netflow9"; });
+    ASSERT_TRUE(h.exporter->init()) << h.exporter->get_last_error();
+    // sysUptime starts at init(), so packets need current timestamps here
+    uint64_t base = static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::milliseconds>(
+                        std::chrono::system_clock::now().time_since_epoch()).count()) + 1000;
+    h.feed(base, frame(false, 17, 40, 1000, 2000, 0, 20));
+    h.feed(base + 500, frame(false, 17, 41, 1000, 2000, 0, 20));
+    h.exporter->flush();
+    h.feed(base + 1000, frame(false, 17, 42, 1000, 2000, 0, 20));
+    h.exporter->flush();
+
+    auto datagrams = h.collector.receive();
+    ASSERT_EQ(datagrams.size(), 2u);
+    const auto& d = datagrams[0];
+    EXPECT_EQ(get_be(d.data(), 2), 9u);
+    EXPECT_EQ(get_be(d.data() + 2, 2), 4u);                         // Two templates, two records
+    EXPECT_EQ(get_be(d.data() + 12, 4), 0u);                        // Sequence counts datagrams
+    EXPECT_EQ(get_be(d.data() + 16, 4), 1u);                        // Source id
+    EXPECT_EQ(get_be(datagrams[1].data() + 2, 2), 1u);
+    EXPECT_EQ(get_be(datagrams[1].data() + 12, 4), 1u);
+
+    Decoder dec;
+    for (const auto& dg : datagrams) dec.decode(dg);
+    const auto& fields = dec.templates.at(FlowExporter::IPV4_TEMPLATE_ID);
+    EXPECT_EQ(fields.back().id, static_cast<uint16_t>(FlowEnterpriseIe::SensorStatus));
+    EXPECT_EQ(fields.back().enterprise, PEN);
+    ASSERT_EQ(dec.records.size(), 3u);
+    // FIRST_SWITCHED/LAST_SWITCHED are sysUptime-relative
+    uint64_t uptime = get_be(datagrams[1].data() + 4, 4);
+    EXPECT_EQ(dec.records[2][22], dec.records[2][21]);
+    EXPECT_EQ(dec.records[2][21], uptime);
+    EXPECT_GE(dec.records[2][21], 2000u);
+    uint64_t a = dec.records[0][21], b = dec.records[1][21];
+    EXPECT_EQ(std::max(a, b) - std::min(a, b), 500u);
+}
+
+TEST(FlowExportTest, RecordsSplitAcrossDatagramsWithinMtu) {
+    Harness h([](core::Config& c) { c.flow_export.mtu = 512; });
+    ASSERT_TRUE(h.exporter->init()) << h.exporter->get_last_error();
+    for (uint8_t i = 0; i < 40; ++i) h.feed(T0 + i, frame(i % 2, 17, static_cast<uint8_t>(100 + i), 7000, 7001));
+    h.exporter->flush();
+
+    auto datagrams = h.collector.receive();
+    ASSERT_GT(datagrams.size(), 3u);
+    Decoder dec;
+    uint64_t expected_sequence = 0;
+    for (size_t i = 0; i < datagrams.size(); ++i) {
+        EXPECT_LE(datagrams[i].size(), 512u);
+        EXPECT_EQ(get_be(datagrams[i].data() + 8, 4), expected_sequence);
+        size_t before = dec.records.size();
+        dec.decode(datagrams[i]);
+        expected_sequence += dec.records.size() - before;
+        if (i == 0) {
+            EXPECT_EQ(dec.template_records, 2u);
+        }
+    }
+    EXPECT_EQ(dec.template_records, 2u);
+    EXPECT_EQ(dec.records.size(), 40u);
+}
+
+TEST(FlowExportTest, FullTableEvictsLeastRecentlySeen) {
+    Harness h([](core::Config& c) { c.flow_export.max_flows = 64; });
+    ASSERT_TRUE(h.exporter->init());
+    for (int i = 0; i < 200; ++i) {
+        h.feed(T0 + i, frame(false, 17, static_cast<uint8_t>(i), static_cast<uint16_t>(10000 + i), 53));
+    }
+    auto stats = h.exporter->get_stats();
+    EXPECT_LE(stats["flows_active"].get<size_t>(), 64u);
+    EXPECT_GE(stats["records_by_reason"]["lack_of_resources"].get<uint64_t>(), 136u);
+    h.exporter->flush();
+
+    Decoder dec;
+    for (const auto& d : h.collector.receive()) dec.decode(d);
+    ASSERT_EQ(dec.records.size(), 200u);
+    uint64_t packets = 0;
+    for (const auto& r : dec.records) packets += r[2];
+    EXPECT_EQ(packets, 200u);
+    EXPECT_EQ(h.exporter->get_stats()["flows_created"], 200);
+}
@@ -0,0 +1,87 @@
+#include <gtest/gtest.h>
+#include <atomic>
+#include <chrono>
+#include <string>
+#include <thread>
+
+#include "core/init_graph.hpp"
+
+using namespace environet::core;
+using std::chrono::milliseconds;
+
+namespace {
+
+InitGraph::InitFn sleep_step(int ms, bool ok = true) {
+    return [ms, ok](std::string& error) {
+        std::this_thread::sleep_for(milliseconds(ms));
+        if (!ok) error = "failed";
+        return ok;
+    };
+}
+
+} // namespace
+
+TEST(InitGraphTest, IndependentStepsOverlap) {
+    InitGraph graph;
+    graph.add("a", sleep_step(200));
+    graph.add("b", sleep_step(200));
+    graph.add("c", sleep_step(200));
+    ASSERT_TRUE(graph.run()) << graph.get_last_error();
+
+    // Sequential would take 600ms
+    EXPECT_LT(graph.elapsed_ms(), 450.0);
+    for (const auto& step : graph.results()) {
+        EXPECT_TRUE(step.ok);
+        EXPECT_GE(step.elapsed_ms, 190.0);
+    }
+    EXPECT_EQ(graph.get_stats()["steps"].size(), 3u);
+}
+
+TEST(InitGraphTest, DependenciesRunInOrder) {
+    std::atomic<int> order{0};
+    int a_pos = -1, b_pos = -1, c_pos = -1;
+    InitGraph graph;
+    graph.add("c", [&](std::string&) { c_pos = order++; return true; }, {"a", "b"});
+    graph.add("a", [&](std::string&) { std::this_thread::sleep_for(milliseconds(50)); a_pos = order++; return true; });
+    graph.add("b", [&](std::string&) { b_pos = order++; return true; }, {"a"});
+    ASSERT_TRUE(graph.run()) << graph.get_last_error();
+
+    EXPECT_LT(a_pos, b_pos);
+    EXPECT_LT(b_pos, c_pos);
+    EXPECT_GE(graph.result("c")->start_ms, graph.result("b")->start_ms);
+}
+
+TEST(InitGraphTest, DeadlineAbandonsStepAndSkipsDependents) {
+    InitGraph graph;
+    graph.add("slow", sleep_step(2000), {}, milliseconds(100), false);
+    graph.add("after_slow", sleep_step(0), {"slow"}, milliseconds(1000), false);
+    graph.add("fast", sleep_step(10));
+
+    auto start = std::chrono::steady_clock::now();
+    EXPECT_TRUE(graph.run());
+    auto waited = std::chrono::steady_clock::now() - start;
+    EXPECT_LT(waited, milliseconds(1000));
+
+    EXPECT_TRUE(graph.result("slow")->timed_out);
+    EXPECT_TRUE(graph.result("after_slow")->skipped);
+    EXPECT_TRUE(graph.result("fast")->ok);
+}
+
+TEST(InitGraphTest, RequiredFailureAndInvalidGraphs) {
+    InitGraph failing;
+    failing.add("optional", sleep_step(0, false), {}, milliseconds(1000), false);
+    EXPECT_TRUE(failing.run());
+    failing.add("required", sleep_step(0, false));
+    EXPECT_FALSE(failing.run());
+    EXPECT_NE(failing.get_last_error().find("required"), std::string::npos);
+
+    InitGraph cycle;
+    cycle.add("a", sleep_step(0), {"b"});
+    cycle.add("b", sleep_step(0), {"a"});
+    EXPECT_FALSE(cycle.run());
+
+    InitGraph unknown;
+    unknown.add("a", sleep_step(0), {"missing"});
+    EXPECT_FALSE(unknown.run());
+    EXPECT_NE(unknown.get_last_error().find("missing"), std::string::npos);
+}
@@ -0,0 +1,263 @@
+#include <gtest/gtest.h>
+#include <arpa/inet.h>
+#include <cstring>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <unistd.h>
+
+#include "core/websocket.hpp"
+#include "correlate/live_feed.hpp"
+#include "correlate/query_api.hpp"
+
+using namespace environet;
+using namespace environet::correlate;
+
+namespace {
+
+// Masked client frame, as a browser would send it
+std::string client_frame(core::WsOpcode opcode, const std::string& payload) {
+    const uint8_t mask[4] = {0x12, 0x34, 0x56, 0x78};
+    std::string out;
+    out += static_cast<char>(0x80 | static_cast<uint8_t>(opcode));
+    out += static_cast<char>(0x80 | payload.size());
+    out.append(reinterpret_cast<const char*>(mask), 4);
+    for (size_t i = 0; i < payload.size(); ++i) out += static_cast<char>(payload[i] ^ mask[i & 3]);
+    return out;
+}
+
+int connect_tcp(int port) {
+    int fd = socket(AF_INET, SOCK_STREAM, 0);
+    timeval tv{2, 0};
+    setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
+    sockaddr_in addr{};
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(static_cast<uint16_t>(port));
+    inet_pton(AF_INET, "127.0.0.1", &addr.sin_addr);
+    if (connect(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0) {
+        close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+// Read until @p buf holds at least @p n bytes (or the peer closes / times out)
+bool read_at_least(int fd, std::string& buf, size_t n) {
+    char tmp[4096];
+    while (buf.size() < n) {
+        ssize_t r = recv(fd, tmp, sizeof(tmp), 0);
+        if (r <= 0) return false;
+        buf.append(tmp, static_cast<size_t>(r));
+    }
+    return true;
+}
+
+// Send a request and read its response head; leftover bytes stay in @p buf
+std::string open_stream(int fd, const std::string& target, const std::string& headers, std::string& buf) {
+    std::string req = "GET " + target + " HTTP/1.1\r\nHost: x\r\n" + headers + "\r\n";
+    send(fd, req.data(), req.size(), 0);
+    while (buf.find("\r\n\r\n") == std::string::npos) {
+        if (!read_at_least(fd, buf, buf.size() + 1)) return {};
+    }
+    size_t end = buf.find("\r\n\r\n") + 4;
+    std::string head = buf.substr(0, end);
+    buf.erase(0, end);
+    return head;
+}
+
+// Next server-sent event's data line
+std::string next_event(int fd, std::string& buf, std::string* event) {
+    while (buf.find("\n\n") == std::string::npos) {
+        if (!read_at_least(fd, buf, buf.size() + 1)) return {};
+    }
+    size_t end = buf.find("\n\n");
+    std::string block = buf.substr(0, end);
+    buf.erase(0, end + 2);
+    size_t data = block.find("\ndata: ");
+    *event = block.substr(7, data - 7);     // After "event: "
+    return block.substr(data + 7);
+}
+
+} // namespace
+
+TEST(LiveFeedTest, WebSocketHandshakeAndFraming) {
+    // RFC 6455 section 1.3 example
+    EXPECT_EQ(core::websocket_accept("dGhlIHNhbXBsZSBub25jZQ=="), "s3pPLMBiTxaQ9kYGzzhZRbK+xOo=");
+
+    core::HttpRequest req;
+    req.headers = {{"upgrade", "WebSocket"}, {"connection", "keep-alive, Upgrade"},
+                   {"sec-websocket-key", "dGhlIHNhbXBsZSBub25jZQ=="}, {"sec-websocket-version", "13"}};
+    EXPECT_TRUE(core::is_websocket_upgrade(req));
+    req.headers["sec-websocket-version"] = "8";
+    EXPECT_FALSE(core::is_websocket_upgrade(req));
+
+    std::string in = client_frame(core::WsOpcode::Text, "hello");
+    in += client_frame(core::WsOpcode::Ping, "p");
+    core::WsFrame frame;
+    ASSERT_EQ(core::take_websocket_frame(in, frame), 1);
+    EXPECT_EQ(frame.opcode, core::WsOpcode::Text);
+    EXPECT_EQ(frame.payload, "hello");
+    in.pop_back();                                  // Incomplete frame waits for more bytes
+    EXPECT_EQ(core::take_websocket_frame(in, frame), 0);
+    std::string unmasked;
+    core::append_websocket_frame(unmasked, core::WsOpcode::Text, "x", 1);
+    EXPECT_EQ(core::take_websocket_frame(unmasked, frame), -1);
+
+    // Server frames pick the 7, 16 or 64-bit length form
+    for (size_t len : {125u, 126u, 70000u}) {
+        std::string out;
+        std::string payload(len, 'a');
+        core::append_websocket_frame(out, core::WsOpcode::Binary, payload.data(), payload.size());
+        size_t header = len < 126 ? 2 : len <= 0xFFFF ? 4 : 10;
+        EXPECT_EQ(out.size(), header + len);
+        EXPECT_EQ(static_cast<uint8_t>(out[0]), 0x82);
+    }
+}
+
+TEST(LiveFeedTest, CoalescesSeriesAndBoundsFindings) {
+    auto config = std::make_shared<core::Config>(core::Config::get_defaults());
+    config->push.queue_size = 3;
+    config->push.max_series = 2;
+    config->push.max_clients = 1;
+    LiveFeed feed(config);
+
+    core::HttpRequest req;
+    req.query = "topics=findings,rssi";
+    core::HttpResponse resp;
+    auto stream = feed.open(req, resp);
+    ASSERT_TRUE(stream);
+    EXPECT_EQ(resp.content_type, "text/event-stream");
+    EXPECT_FALSE(feed.open(req, resp));             // Over max_clients
+    EXPECT_EQ(resp.status, 503);
+    req.query = "topics=humidity";
+    EXPECT_FALSE(feed.open(req, resp));
+    EXPECT_EQ(resp.status, 400);
+
+    net::BssInfo a("office", "aa:bb:cc:00:00:01", 2412, -5000);
+    net::BssInfo b("lab", "aa:bb:cc:00:00:02", 5180, -7000);
+    net::BssInfo c("hall", "aa:bb:cc:00:00:03", 2437, -6000);
+    feed.publish_bss(1, a);
+    feed.publish_bss(2, b);
+    a.signal_mbm = -5500;
+    feed.publish_bss(3, a);                         // Replaces the pending value for a
+    feed.publish_bss(4, c);                         // Over max_series
+    feed.publish_sensor(5, sensors::SensorFrame()); // Not subscribed
+    for (uint64_t t = 10; t < 15; ++t) {
+        Finding f;
+        f.timestamp_ms = t;
+        f.event_type = "motion";
+        feed.publish_finding(f);
+    }
+
+    std::string out;
+    EXPECT_TRUE(stream->pull(out));
+    std::vector<nlohmann::json> events;
+    for (size_t pos = 0; (pos = out.find("data: ", pos)) != std::string::npos; pos += 6) {
+        events.push_back(nlohmann::json::parse(out.substr(pos + 6, out.find('\n', pos) - pos - 6)));
+    }
+    // Newest three findings first, then one value per BSSID in first-pending order
+    ASSERT_EQ(events.size(), 5u);
+    EXPECT_EQ(events[0]["finding"]["timestamp_ms"].get<uint64_t>(), 12u);
+    EXPECT_EQ(events[2]["finding"]["event_type"], "motion");
+    EXPECT_EQ(events[3]["bssid"], "aa:bb:cc:00:00:01");
+    EXPECT_EQ(events[3]["t"].get<uint64_t>(), 3u);
+    EXPECT_NEAR(events[3]["rssi_dbm"].get<double>(), -55.0, 1e-9);
+    EXPECT_EQ(events[4]["bssid"], "aa:bb:cc:00:00:02");
+
+    auto stats = feed.get_stats();
+    EXPECT_EQ(stats["sent"].get<uint64_t>(), 5u);
+    EXPECT_EQ(stats["coalesced"].get<uint64_t>(), 1u);
+    EXPECT_EQ(stats["dropped"].get<uint64_t>(), 3u);      // Two findings and one series
+    EXPECT_EQ(stats["refused"].get<uint64_t>(), 1u);
+
+    out.clear();
+    EXPECT_TRUE(stream->pull(out));
+    EXPECT_TRUE(out.empty());
+    stream->closed();
+    EXPECT_EQ(feed.clients(), 0u);
+}
+
+TEST(LiveFeedTest, StreamsOverSseAndWebSocket) {
+    auto config = std::make_shared<core::Config>(core::Config::get_defaults());
+    config->api.port = 0;
+    Correlator corr(config);
+    ASSERT_TRUE(corr.init());
+    LiveFeed feed(config);
+    corr.set_live_feed(&feed);
+    QueryApi api(config, corr);
+    api.set_live_feed(&feed);
+    ASSERT_TRUE(api.start()) << api.get_last_error();
+
+    // Server-sent events
+    int sse = connect_tcp(api.port());
+    ASSERT_GE(sse, 0);
+    std::string sse_buf;
+    std::string head = open_stream(sse, "/api/v1/stream?topics=ir,rtt", "", sse_buf);
+    EXPECT_NE(head.find("HTTP/1.1 200"), std::string::npos);
+    EXPECT_NE(head.find("text/event-stream"), std::string::npos);
+
+    // WebSocket with binary series
+    int ws = connect_tcp(api.port());
+    ASSERT_GE(ws, 0);
+    std::string ws_buf;
+    head = open_stream(ws, "/api/v1/stream?topics=rssi&format=binary",
+                       "Upgrade: websocket\r\nConnection: Upgrade\r\n"
+                       "Sec-WebSocket-Key: dGhlIHNhbXBsZSBub25jZQ==\r\nSec-WebSocket-Version: 13\r\n",
+                       ws_buf);
+    EXPECT_NE(head.find("HTTP/1.1 101"), std::string::npos);
+    EXPECT_NE(head.find("Sec-WebSocket-Accept: s3pPLMBiTxaQ9kYGzzhZRbK+xOo="), std::string::npos);
+    EXPECT_EQ(feed.clients(), 2u);
+
+    sensors::SensorFrame frame;
+    frame.ir_raw = 321;
+    corr.push_sensor(frame);
+    std::string event;
+    auto ir = nlohmann::json::parse(next_event(sse, sse_buf, &event));
+    EXPECT_EQ(event, "ir");
+    EXPECT_EQ(ir["ir_raw"].get<int>(), 321);
+
+    net::PingStats ping;
+    ping.target = "8.8.8.8";
+    ping.reachable = true;
+    ping.avg_rtt_ms = 12.5;
+    corr.push_ping_stats(ping);
+    auto rtt = nlohmann::json::parse(next_event(sse, sse_buf, &event));
+    EXPECT_EQ(event, "rtt");
+    EXPECT_EQ(rtt["target"], "8.8.8.8");
+    EXPECT_NEAR(rtt["avg_rtt_ms"].get<double>(), 12.5, 1e-9);
+
+    corr.push_bss(net::BssInfo("office", "aa:bb:cc:00:00:01", 2412, -4200));
+    ASSERT_TRUE(read_at_least(ws, ws_buf, 2));
+    EXPECT_EQ(static_cast<uint8_t>(ws_buf[0]), 0x82);
+    size_t len = static_cast<uint8_t>(ws_buf[1]);
+    ASSERT_TRUE(read_at_least(ws, ws_buf, 2 + len));
+    const auto* p = reinterpret_cast<const uint8_t*>(ws_buf.data() + 2);
+    EXPECT_EQ(p[0], static_cast<uint8_t>(FeedTopic::Rssi));
+    int32_t mbm;
+    std::memcpy(&mbm, p + 9, 4);                    // After topic and timestamp
+    EXPECT_EQ(mbm, -4200);
+    EXPECT_EQ(p[13], 2412 & 0xFF);
+    EXPECT_EQ(p[17], 0xaa);
+    EXPECT_EQ(std::string(reinterpret_cast<const char*>(p + 24), p[23]), "office");
+    ws_buf.erase(0, 2 + len);
+
+    // Ping is answered; close is echoed and ends the connection
+    std::string ping_frame = client_frame(core::WsOpcode::Ping, "hi");
+    send(ws, ping_frame.data(), ping_frame.size(), 0);
+    ASSERT_TRUE(read_at_least(ws, ws_buf, 4));
+    EXPECT_EQ(static_cast<uint8_t>(ws_buf[0]), 0x8A);
+    EXPECT_EQ(ws_buf.substr(2, 2), "hi");
+    ws_buf.clear();
+    std::string close_frame = client_frame(core::WsOpcode::Close, std::string("\x03\xe8", 2));
+    send(ws, close_frame.data(), close_frame.size(), 0);
+    ASSERT_TRUE(read_at_least(ws, ws_buf, 4));
+    EXPECT_EQ(static_cast<uint8_t>(ws_buf[0]), 0x88);
+    EXPECT_FALSE(read_at_least(ws, ws_buf, 5));    // Closed by the server
+    close(ws);
+
+    close(sse);
+    for (int i = 0; i < 100 && feed.clients() > 0; ++i) usleep(10000);
+    EXPECT_EQ(feed.clients(), 0u);
+    EXPECT_EQ(api.get_stats()["streams_opened"].get<uint64_t>(), 2u);
+    api.stop();
+}
@@ -0,0 +1,70 @@
+#include <gtest/gtest.h>
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <unistd.h>
+
+#include "core/log.hpp"
+
+using namespace environet::core;
+
+static std::string read_all(const std::string& path) {
+    std::ifstream in(path);
+    std::ostringstream ss;
+    ss << in.rdbuf();
+    return ss.str();
+}
+
+TEST(LogTest, RateLimiterAllowsOncePerInterval) {
+    LogRateLimiter limiter(200);
+    EXPECT_TRUE(limiter.allow());
+    for (int i = 0; i < 100; ++i) EXPECT_FALSE(limiter.allow());
+    std::this_thread::sleep_for(std::chrono::milliseconds(250));
+    EXPECT_TRUE(limiter.allow());
+    EXPECT_FALSE(limiter.allow());
+}
+
+TEST(LogTest, SamplerAllowsEveryNth) {
+    LogSampler sampler(10);
+    int allowed = 0;
+    for (int i = 0; i < 100; ++i) allowed += sampler.allow() ? 1 : 0;
+    EXPECT_EQ(allowed, 10);
+}
+
+TEST(LogTest, AsyncLoggerWritesFileAndRateLimits) {
+    std::string path = "test_async_" + std::to_string(getpid()) + ".log";
+    init_logger("info", path, 1024 * 1024, 1, /*async=*/true, 1024, "block");
+    EXPECT_TRUE(get_log_stats()["async"].get<bool>());
+
+    uint64_t limited_before = get_log_stats()["rate_limited"].get<uint64_t>();
+    for (int i = 0; i < 50; ++i) {
+        LOGI_RATELIMITED(60000, "limited record {}", i);
+        LOGI_EVERY_N(10, "sampled record {}", i);
+    }
+    LOGI("plain record");
+    shutdown_logger();
+
+    // shutdown_logger() returns only after the async queue is drained
+    std::string contents = read_all(path);
+    EXPECT_NE(contents.find("limited record 0"), std::string::npos);
+    EXPECT_EQ(contents.find("limited record 1"), std::string::npos);
+    EXPECT_NE(contents.find("sampled record 40"), std::string::npos);
+    EXPECT_EQ(contents.find("sampled record 41"), std::string::npos);
+    EXPECT_NE(contents.find("plain record"), std::string::npos);
+    EXPECT_EQ(get_log_stats()["rate_limited"].get<uint64_t>() - limited_before, 49u + 45u);
+    std::remove(path.c_str());
+}
+
+TEST(LogTest, LoggerPointerSurvivesReinit) {
+    init_logger("warn");
+    spdlog::logger* first = logger_ptr();
+    init_logger("warn");
+    spdlog::logger* second = logger_ptr();
+    EXPECT_NE(first, second);
+    // The retired logger must still be usable by threads that cached it
+    first->warn("late record through retired logger");
+    EXPECT_EQ(second, get_logger().get());
+}
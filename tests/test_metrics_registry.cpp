@@ -0,0 +1,229 @@
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include "core/metrics_registry.hpp"
+#include "core/http_server.hpp"
+#include "core/latency.hpp"
+
+using namespace environet::core;
+
+// Send a raw HTTP request to localhost and return the full response
+static std::string http_get(int port, const std::string& request) {
+    int fd = socket(AF_INET, SOCK_STREAM, 0);
+    sockaddr_in addr{};
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(static_cast<uint16_t>(port));
+    inet_pton(AF_INET, "127.0.0.1", &addr.sin_addr);
+    if (connect(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0) {
+        close(fd);
+        return {};
+    }
+    send(fd, request.data(), request.size(), 0);
+    std::string out;
+    char buf[4096];
+    ssize_t n;
+    while ((n = recv(fd, buf, sizeof(buf), 0)) > 0) out.append(buf, static_cast<size_t>(n));
+    close(fd);
+    return out;
+}
+
+TEST(MetricsRegistryTest, CounterConcurrentIncrements) {
+    auto& c = MetricsRegistry::instance().counter("test_concurrent_total", "test counter");
+    uint64_t before = c.value();
+
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 8; ++t) {
+        threads.emplace_back([&c]() {
+            for (int i = 0; i < 10000; ++i) c.inc();
+        });
+    }
+    for (auto& th : threads) th.join();
+
+    EXPECT_EQ(c.value() - before, 80000u);
+}
+
+TEST(MetricsRegistryTest, SameNameReturnsSameMetric) {
+    auto& a = MetricsRegistry::instance().counter("test_same_total", "help");
+    auto& b = MetricsRegistry::instance().counter("test_same_total", "help");
+    EXPECT_EQ(&a, &b);
+
+    auto& l1 = MetricsRegistry::instance().counter("test_labeled_total", "help", {{"iface", "wlan0"}});
+    auto& l2 = MetricsRegistry::instance().counter("test_labeled_total", "help", {{"iface", "wlan1"}});
+    EXPECT_NE(&l1, &l2);
+}
+
+TEST(MetricsRegistryTest, TypeConflictThrows) {
+    MetricsRegistry::instance().counter("test_conflict", "help");
+    EXPECT_THROW(MetricsRegistry::instance().gauge("test_conflict", "help"), std::invalid_argument);
+}
+
+TEST(MetricsRegistryTest, GaugeSetAndAdd) {
+    auto& g = MetricsRegistry::instance().gauge("test_gauge", "help");
+    g.set(10.5);
+    EXPECT_DOUBLE_EQ(g.value(), 10.5);
+    g.add(-0.5);
+    EXPECT_DOUBLE_EQ(g.value(), 10.0);
+}
+
+TEST(MetricsRegistryTest, HistogramBucketsAreContiguous) {
+    for (size_t i = 1; i < Histogram::kBucketCount; ++i) {
+        ASSERT_EQ(Histogram::bucket_lower_bound(i), Histogram::bucket_upper_bound(i - 1) + 1) << "bucket " << i;
+    }
+    EXPECT_EQ(Histogram::bucket_upper_bound(Histogram::kBucketCount - 1), UINT64_MAX);
+
+    for (uint64_t v : std::vector<uint64_t>{0, 1, 7, 8, 9, 1000, 123456789, UINT64_MAX}) {
+        size_t idx = Histogram::bucket_index(v);
+        EXPECT_LE(Histogram::bucket_lower_bound(idx), v);
+        EXPECT_GE(Histogram::bucket_upper_bound(idx), v);
+    }
+}
+
+TEST(MetricsRegistryTest, HistogramPercentiles) {
+    Histogram h;
+    for (uint64_t v = 1; v <= 10000; ++v) h.record(v);
+    auto snap = h.snapshot();
+
+    EXPECT_EQ(snap.count, 10000u);
+    EXPECT_EQ(snap.max, 10000u);
+    EXPECT_NEAR(static_cast<double>(snap.percentile(0.5)), 5000.0, 5000.0 * 0.125);
+    EXPECT_NEAR(static_cast<double>(snap.percentile(0.99)), 9900.0, 9900.0 * 0.125);
+    EXPECT_EQ(snap.percentile(1.0), 10000u);
+    EXPECT_DOUBLE_EQ(snap.mean(), 5000.5);
+}
+
+TEST(MetricsRegistryTest, PrometheusRendering) {
+    auto& c = MetricsRegistry::instance().counter("test_render_total", "rendered counter", {{"kind", "x"}});
+    c.inc(3);
+    auto& h = MetricsRegistry::instance().histogram("test_render_seconds", "rendered histogram", 1e-9);
+    h.record(1500);
+
+    std::string text = MetricsRegistry::instance().render_prometheus();
+    EXPECT_NE(text.find("# TYPE test_render_total counter"), std::string::npos);
+    EXPECT_NE(text.find("test_render_total{kind=\"x\"} 3"), std::string::npos);
+    EXPECT_NE(text.find("# TYPE test_render_seconds histogram"), std::string::npos);
+    EXPECT_NE(text.find("test_render_seconds_bucket{le=\"+Inf\"} 1"), std::string::npos);
+    EXPECT_NE(text.find("test_render_seconds_count 1"), std::string::npos);
+
+    // Bounds are exact: a sample on le is counted, one just above it is not
+    auto& edge = MetricsRegistry::instance().histogram("test_render_edge", "boundary histogram");
+    edge.record(1023);
+    edge.record(1024);
+    edge.record(1100);
+    text = MetricsRegistry::instance().render_prometheus();
+    EXPECT_NE(text.find("test_render_edge_bucket{le=\"511\"} 0"), std::string::npos);
+    EXPECT_NE(text.find("test_render_edge_bucket{le=\"1023\"} 1"), std::string::npos);
+    EXPECT_NE(text.find("test_render_edge_bucket{le=\"2047\"} 3"), std::string::npos);
+    EXPECT_EQ(text.find("test_render_edge_bucket{le=\"4095\"}"), std::string::npos);
+
+    std::string om = MetricsRegistry::instance().render_prometheus(true);
+    EXPECT_NE(om.find("# TYPE test_render counter"), std::string::npos);
+    EXPECT_EQ(om.compare(om.size() - 6, 6, "# EOF\n"), 0);
+}
+
+TEST(MetricsRegistryTest, HistogramMergesThreadShards) {
+    Histogram h;
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 4; ++t) {
+        threads.emplace_back([&h, t]() {
+            for (int i = 0; i < 1000; ++i) h.record(static_cast<uint64_t>(t) * 1000 + 1);
+        });
+    }
+    for (auto& th : threads) th.join();
+
+    auto snap = h.snapshot();
+    EXPECT_EQ(snap.count, 4000u);
+    EXPECT_EQ(snap.max, 3001u);
+}
+
+TEST(LatencyTest, ScopedTimerRecordsSamples) {
+    auto& h = latency_histogram("test_scoped_latency_seconds", "test latency");
+    for (int i = 0; i < 100; ++i) {
+        ScopedLatency timer(h);
+    }
+    auto summary = latency_summary(h);
+    EXPECT_EQ(summary["count"].get<uint64_t>(), 100u);
+    EXPECT_GE(summary["max_ns"].get<double>(), summary["p99_ns"].get<double>());
+    EXPECT_GE(summary["p99_ns"].get<double>(), summary["p50_ns"].get<double>());
+    EXPECT_TRUE(latency_stats().contains("test_scoped_latency_seconds"));
+}
+
+TEST(LatencyTest, TickCalibrationIsSane) {
+    double spt = latency_seconds_per_tick();
+    EXPECT_GT(spt, 1e-12);  // slower than 1 THz
+    EXPECT_LT(spt, 1e-6);   // faster than 1 MHz
+}
+
+// Measure per-sample cost: the histogram record itself must stay under
+// 20 ns; the full timed sample (two clock reads) depends on the platform
+// clock and is reported for reference.
+TEST(LatencyTest, RecordOverhead) {
+    auto& h = latency_histogram("test_overhead_seconds", "overhead probe");
+    constexpr int kSamples = 1000000;
+    double ns_per_tick = latency_seconds_per_tick() * 1e9;
+    double best_record_ns = 1e9;
+    double best_timed_ns = 1e9;
+    for (int round = 0; round < 5; ++round) {
+        uint64_t t0 = latency_ticks();
+        for (int i = 0; i < kSamples; ++i) h.record(static_cast<uint64_t>(i & 1023));
+        uint64_t t1 = latency_ticks();
+        for (int i = 0; i < kSamples; ++i) {
+            ScopedLatency timer(h);
+        }
+        uint64_t t2 = latency_ticks();
+        best_record_ns = std::min(best_record_ns, static_cast<double>(t1 - t0) * ns_per_tick / kSamples);
+        best_timed_ns = std::min(best_timed_ns, static_cast<double>(t2 - t1) * ns_per_tick / kSamples);
+    }
+    std::cout << "[ INFO     ] Histogram::record: " << best_record_ns << " ns/sample, "
+              << "ScopedLatency: " << best_timed_ns << " ns/sample" << std::endl;
+#if defined(__OPTIMIZE__) && !defined(__SANITIZE_ADDRESS__)
+    EXPECT_LT(best_record_ns, 20.0);
+#endif
+}
+
+TEST(HttpServerTest, ServesMetricsEndpoint) {
+    MetricsRegistry::instance().counter("test_http_total", "help").inc();
+
+    HttpServer server;
+    server.add_route("/metrics", [](const HttpRequest&) {
+        HttpResponse resp;
+        resp.body = MetricsRegistry::instance().render_prometheus();
+        return resp;
+    });
+    ASSERT_TRUE(server.start("127.0.0.1", 0)) << server.get_last_error();
+    ASSERT_GT(server.port(), 0);
+
+    std::string resp = http_get(server.port(), "GET /metrics HTTP/1.1\r\nHost: x\r\nConnection: close\r\n\r\n");
+    EXPECT_EQ(resp.rfind("HTTP/1.1 200 OK", 0), 0u);
+    EXPECT_NE(resp.find("test_http_total 1"), std::string::npos);
+
+    std::string missing = http_get(server.port(), "GET /nope HTTP/1.0\r\n\r\n");
+    EXPECT_EQ(missing.rfind("HTTP/1.1 404", 0), 0u);
+
+    server.stop();
+    EXPECT_FALSE(server.is_running());
+}
+
+TEST(HttpServerTest, KeepAlivePipelinedRequests) {
+    HttpServer server;
+    server.add_route("/ping", [](const HttpRequest& req) {
+        HttpResponse resp;
+        resp.body = "pong " + req.query_param("n");
+        return resp;
+    });
+    ASSERT_TRUE(server.start("127.0.0.1", 0));
+
+    std::string req = "GET /ping?n=1 HTTP/1.1\r\nHost: x\r\n\r\n"
+                      "GET /ping?n=2 HTTP/1.1\r\nHost: x\r\nConnection: close\r\n\r\n";
+    std::string resp = http_get(server.port(), req);
+    EXPECT_NE(resp.find("pong 1"), std::string::npos);
+    EXPECT_NE(resp.find("pong 2"), std::string::npos);
+    EXPECT_EQ(server.get_stats()["requests_served"].get<uint64_t>(), 2u);
+}
@@ -0,0 +1,223 @@
+#include <gtest/gtest.h>
+#include <arpa/inet.h>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <thread>
+#include <unistd.h>
+
+#include "core/json_writer.hpp"
+#include "correlate/query_api.hpp"
+
+using namespace environet;
+using namespace environet::correlate;
+
+namespace {
+
+// Send one request (Connection: close) and return the response body; status in *status
+std::string request(int fd, const std::string& target, int* status) {
+    std::string req = "GET " + target + " HTTP/1.1\r\nHost: x\r\nConnection: close\r\n\r\n";
+    send(fd, req.data(), req.size(), 0);
+    std::string resp;
+    char buf[4096];
+    ssize_t n;
+    while ((n = recv(fd, buf, sizeof(buf), 0)) > 0) resp.append(buf, static_cast<size_t>(n));
+    close(fd);
+    *status = resp.size() > 12 ? std::atoi(resp.c_str() + 9) : 0;
+    size_t body = resp.find("\r\n\r\n");
+    return body == std::string::npos ? std::string() : resp.substr(body + 4);
+}
+
+std::string tcp_get(int port, const std::string& target, int* status) {
+    int fd = socket(AF_INET, SOCK_STREAM, 0);
+    sockaddr_in addr{};
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(static_cast<uint16_t>(port));
+    inet_pton(AF_INET, "127.0.0.1", &addr.sin_addr);
+    if (connect(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0) {
+        close(fd);
+        return {};
+    }
+    return request(fd, target, status);
+}
+
+std::string unix_get(const std::string& path, const std::string& target, int* status) {
+    int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    sockaddr_un addr{};
+    addr.sun_family = AF_UNIX;
+    std::strncpy(addr.sun_path, path.c_str(), sizeof(addr.sun_path) - 1);
+    if (connect(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0) {
+        close(fd);
+        return {};
+    }
+    return request(fd, target, status);
+}
+
+} // namespace
+
+TEST(QueryApiTest, JsonWriterMatchesParser) {
+    std::string out;
+    core::JsonWriter w(out);
+    w.begin_object();
+    w.field("text", "quote \" slash \\ line\n tab\t bell\x07");
+    w.field("neg", -42).field("big", UINT64_MAX).field("pi", 3.25).field("nan", std::nan(""));
+    w.field("flag", true).key("none").null();
+    w.key("list").begin_array().value(1).begin_object().end_object().begin_array().end_array().value("x").end_array();
+    w.end_object();
+
+    auto j = nlohmann::json::parse(out);
+    EXPECT_EQ(j["text"], "quote \" slash \\ line\n tab\t bell\x07");
+    EXPECT_EQ(j["neg"].get<int>(), -42);
+    EXPECT_EQ(j["big"].get<uint64_t>(), UINT64_MAX);
+    EXPECT_EQ(j["pi"].get<double>(), 3.25);
+    EXPECT_TRUE(j["nan"].is_null());
+    EXPECT_TRUE(j["flag"].get<bool>());
+    EXPECT_TRUE(j["none"].is_null());
+    EXPECT_EQ(j["list"].dump(), "[1,{},[],\"x\"]");
+}
+
+TEST(QueryApiTest, WritesFindingsAndDownsampledSeries) {
+    auto config = std::make_shared<core::Config>(core::Config::get_defaults());
+    config->correlator.window_ms = 200;
+    config->correlator.sensor_threshold = 50;
+    Correlator corr(config);
+    ASSERT_TRUE(corr.init());
+
+    net::BssInfo ap("office \"net\"", "aa:bb:cc:00:00:01", 2412, -5000);
+    sensors::SensorFrame frame;
+    corr.push_bss(ap);
+    for (int16_t ir : {100, 400, 100}) {
+        frame.ir_raw = ir;
+        corr.push_sensor(frame);
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    }
+    ap.signal_mbm = -6000;
+    corr.push_bss(ap);
+    std::this_thread::sleep_for(std::chrono::milliseconds(250));
+    ASSERT_EQ(corr.process(), 2u);
+    auto all = corr.get_findings();
+
+    std::string out;
+    core::JsonWriter w(out);
+    EXPECT_EQ(corr.write_findings(w, 0, 100), 2u);
+    auto j = nlohmann::json::parse(out);
+    ASSERT_EQ(j.size(), 2u);
+    EXPECT_EQ(j[0]["timestamp_ms"].get<uint64_t>(), all[0].timestamp_ms);
+    EXPECT_EQ(j[1]["description"], std::string(all[1].description));
+    EXPECT_EQ(j[0]["affected_networks"][0], "office \"net\"");
+    EXPECT_NEAR(j[0]["rssi_delta"].get<double>(), all[0].rssi_delta, 1e-9);
+
+    // limit keeps the newest; since skips older ones
+    out.clear();
+    core::JsonWriter newest(out);
+    EXPECT_EQ(corr.write_findings(newest, 0, 1), 1u);
+    EXPECT_EQ(nlohmann::json::parse(out)[0]["timestamp_ms"].get<uint64_t>(), all[1].timestamp_ms);
+    out.clear();
+    core::JsonWriter since(out);
+    EXPECT_EQ(corr.write_findings(since, all[1].timestamp_ms, 100), 0u);
+    EXPECT_EQ(out, "[]");
+
+    // Both BSS samples land in one 10 s step
+    out.clear();
+    core::JsonWriter series(out);
+    uint64_t now = all[1].timestamp_ms;
+    ASSERT_TRUE(corr.write_series(series, "rssi", now - 5000, now + 5000, 10000));
+    auto points = nlohmann::json::parse(out);
+    ASSERT_EQ(points.size(), 1u);
+    EXPECT_EQ(points[0]["t"].get<uint64_t>(), now - 5000);
+    EXPECT_EQ(points[0]["n"].get<uint64_t>(), 2u);
+    EXPECT_NEAR(points[0]["rssi_avg"].get<double>(), -55.0, 1e-9);
+    EXPECT_NEAR(points[0]["rssi_min"].get<double>(), -60.0, 1e-9);
+    EXPECT_FALSE(corr.write_series(series, "humidity", 0, 1, 1));
+
+    // Step arithmetic near UINT64_MAX does not wrap
+    out.clear();
+    core::JsonWriter wide(out);
+    ASSERT_TRUE(corr.write_series(wide, "rssi", 0, UINT64_MAX, UINT64_MAX / 2));
+    points = nlohmann::json::parse(out);
+    ASSERT_EQ(points.size(), 1u);
+    EXPECT_EQ(points[0]["t"].get<uint64_t>(), 0u);
+    EXPECT_EQ(points[0]["n"].get<uint64_t>(), 2u);
+}
+
+TEST(QueryApiTest, ServesOverTcpAndUnixSocket) {
+    auto config = std::make_shared<core::Config>(core::Config::get_defaults());
+    config->api.port = 0;
+    config->api.unix_socket = testing::TempDir() + "environet_api_" + std::to_string(getpid()) + ".sock";
+    config->api.max_points = 10;
+    Correlator corr(config);
+    ASSERT_TRUE(corr.init());
+    sensors::SensorFrame frame;
+    for (int i = 0; i < 30; ++i) {
+        frame.ir_raw = static_cast<int16_t>(100 + i);
+        corr.push_sensor(frame);
+    }
+
+    QueryApi api(config, corr);
+    api.set_stats_provider([] { return nlohmann::json{{"sensor", {{"frames", 30}}}}; });
+    ASSERT_TRUE(api.start()) << api.get_last_error();
+    ASSERT_GT(api.port(), 0);
+
+    int status = 0;
+    auto series = nlohmann::json::parse(tcp_get(api.port(), "/api/v1/series?name=sensor&last=60000&step=1", &status));
+    EXPECT_EQ(status, 200);
+    EXPECT_EQ(series["step_ms"].get<uint64_t>(), 6000u);       // Widened to at most max_points
+    uint64_t frames = 0;
+    for (const auto& p : series["points"]) frames += p["n"].get<uint64_t>();
+    EXPECT_EQ(frames, 30u);
+    EXPECT_NEAR(series["points"].back()["ir_max"].get<double>(), 129.0, 1e-9);
+
+    // A range ending at UINT64_MAX is widened, not wrapped
+    auto all_time = nlohmann::json::parse(
+        tcp_get(api.port(), "/api/v1/series?name=sensor&from=0&to=18446744073709551615", &status));
+    EXPECT_EQ(status, 200);
+    EXPECT_LE(all_time["points"].size(), 10u);
+    frames = 0;
+    for (const auto& p : all_time["points"]) frames += p["n"].get<uint64_t>();
+    EXPECT_EQ(frames, 30u);
+
+    auto findings = nlohmann::json::parse(unix_get(config->api.unix_socket, "/api/v1/findings?limit=5", &status));
+    EXPECT_EQ(status, 200);
+    EXPECT_TRUE(findings["findings"].is_array());
+    EXPECT_GT(findings["now_ms"].get<uint64_t>(), 0u);
+
+    auto stats = nlohmann::json::parse(unix_get(config->api.unix_socket, "/api/v1/stats", &status));
+    EXPECT_EQ(stats["sensor"]["frames"].get<int>(), 30);
+    EXPECT_EQ(stats["correlator"]["buffer_sizes"]["sensor"].get<size_t>(), 30u);
+
+    auto window = nlohmann::json::parse(tcp_get(api.port(), "/api/v1/window?last=60000", &status));
+    EXPECT_EQ(status, 200);
+    EXPECT_EQ(window["sensor_samples"].get<size_t>(), 30u);
+
+    // Stepped windows run on the task pool and are widened like series
+    core::TaskPool pool;
+    pool.start(2, false);
+    corr.set_task_pool(&pool);
+    auto windows = nlohmann::json::parse(tcp_get(api.port(), "/api/v1/window?last=60000&step=1", &status));
+    EXPECT_EQ(status, 200);
+    EXPECT_EQ(windows["step_ms"].get<uint64_t>(), 6000u);
+    EXPECT_EQ(windows["windows"].size(), 10u);
+    size_t samples = 0;
+    for (const auto& w : windows["windows"]) samples += w["sensor_samples"].get<size_t>();
+    EXPECT_EQ(samples, 30u);
+    windows = nlohmann::json::parse(
+        tcp_get(api.port(), "/api/v1/window?from=0&to=18446744073709551615&step=1", &status));
+    EXPECT_EQ(status, 200);
+    EXPECT_LE(windows["windows"].size(), 10u);
+    corr.set_task_pool(nullptr);
+    pool.stop();
+
+    tcp_get(api.port(), "/api/v1/series?name=humidity", &status);
+    EXPECT_EQ(status, 400);
+    tcp_get(api.port(), "/api/v1/findings?limit=-1", &status);
+    EXPECT_EQ(status, 400);
+    tcp_get(api.port(), "/api/v1/series?name=sensor&from=10&to=5", &status);
+    EXPECT_EQ(status, 400);
+    EXPECT_EQ(api.get_stats()["bad_requests"].get<uint64_t>(), 3u);
+
+    api.stop();
+    EXPECT_NE(access(config->api.unix_socket.c_str(), F_OK), 0);   // Socket file removed
+}
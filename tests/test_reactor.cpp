@@ -0,0 +1,121 @@
+#include <gtest/gtest.h>
+#include <atomic>
+#include <chrono>
+#include <csignal>
+#include <thread>
+
+#include "core/reactor.hpp"
+#include "core/worker_pool.hpp"
+
+using namespace environet::core;
+using std::chrono::milliseconds;
+
+TEST(ReactorTest, PeriodicTimerAndRetiming) {
+    Reactor reactor;
+    ASSERT_TRUE(reactor.init()) << reactor.get_last_error();
+
+    int fast = 0;
+    int timer = reactor.add_timer(milliseconds(10), [&]() {
+        if (++fast == 5) reactor.stop();
+    }, milliseconds(0));
+    ASSERT_GE(timer, 0) << reactor.get_last_error();
+
+    auto start = std::chrono::steady_clock::now();
+    reactor.run();
+    auto elapsed = std::chrono::steady_clock::now() - start;
+    EXPECT_EQ(fast, 5);
+    // First fire is immediate, then four 10ms periods
+    EXPECT_GE(elapsed, milliseconds(35));
+    EXPECT_LT(elapsed, milliseconds(500));
+
+    // A slower period takes effect on the next run
+    ASSERT_TRUE(reactor.set_timer_interval(timer, milliseconds(50)));
+    fast = 4;
+    start = std::chrono::steady_clock::now();
+    reactor.run();
+    EXPECT_GE(std::chrono::steady_clock::now() - start, milliseconds(45));
+    EXPECT_TRUE(reactor.remove(timer));
+    EXPECT_GE(reactor.get_stats()["timer_fires"].get<uint64_t>(), 6u);
+}
+
+TEST(ReactorTest, PostAndStopFromOtherThreads) {
+    Reactor reactor;
+    ASSERT_TRUE(reactor.init());
+
+    std::thread::id loop_thread;
+    std::atomic<bool> ran{false};
+    std::thread poster([&]() {
+        std::this_thread::sleep_for(milliseconds(20));
+        reactor.post([&]() {
+            loop_thread = std::this_thread::get_id();
+            ran = true;
+        });
+        std::this_thread::sleep_for(milliseconds(20));
+        reactor.stop();
+    });
+
+    // No timers: the loop sleeps until woken and returns promptly on stop()
+    auto start = std::chrono::steady_clock::now();
+    reactor.run();
+    auto elapsed = std::chrono::steady_clock::now() - start;
+    poster.join();
+
+    EXPECT_TRUE(ran);
+    EXPECT_EQ(loop_thread, std::this_thread::get_id());
+    EXPECT_LT(elapsed, milliseconds(500));
+    EXPECT_LE(reactor.get_stats()["wakeups"].get<uint64_t>(), 3u);
+}
+
+TEST(ReactorTest, SignalsArriveThroughSignalfd) {
+    ASSERT_TRUE(Reactor::block_signals({SIGUSR2}));
+    Reactor reactor;
+    ASSERT_TRUE(reactor.init());
+
+    int received = 0;
+    ASSERT_TRUE(reactor.add_signals({SIGUSR2}, [&](int signo) {
+        received = signo;
+        reactor.stop();
+    })) << reactor.get_last_error();
+    // Thread-directed, so it stays pending for this (blocking) thread
+    reactor.post([]() { raise(SIGUSR2); });
+    reactor.run();
+    EXPECT_EQ(received, SIGUSR2);
+
+    sigset_t mask;
+    sigemptyset(&mask);
+    sigaddset(&mask, SIGUSR2);
+    pthread_sigmask(SIG_UNBLOCK, &mask, nullptr);
+}
+
+TEST(WorkerPoolTest, RunsJobsConcurrentlyAndDropsQueuedOnStop) {
+    WorkerPool pool;
+    ASSERT_TRUE(pool.start(2, "test"));
+
+    std::atomic<int> done{0};
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < 2; ++i) {
+        pool.submit([&]() {
+            std::this_thread::sleep_for(milliseconds(100));
+            ++done;
+        });
+    }
+    while (done < 2 && std::chrono::steady_clock::now() - start < milliseconds(2000)) {
+        std::this_thread::sleep_for(milliseconds(5));
+    }
+    EXPECT_EQ(done, 2);
+    EXPECT_LT(std::chrono::steady_clock::now() - start, milliseconds(190));
+
+    // Both workers busy; the third job is still queued when the pool stops
+    std::atomic<int> late{0};
+    for (int i = 0; i < 3; ++i) {
+        pool.submit([&]() {
+            std::this_thread::sleep_for(milliseconds(50));
+            ++late;
+        });
+    }
+    std::this_thread::sleep_for(milliseconds(10));
+    pool.stop();
+    EXPECT_EQ(late, 2);
+    EXPECT_EQ(pool.get_stats()["dropped"].get<uint64_t>(), 1u);
+    EXPECT_FALSE(pool.submit([]() {}));
+}
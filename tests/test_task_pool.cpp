@@ -0,0 +1,135 @@
+#include <gtest/gtest.h>
+#include <atomic>
+#include <chrono>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+#include "core/task_pool.hpp"
+#include "correlate/correlator.hpp"
+
+using namespace environet;
+using core::TaskPool;
+
+TEST(TaskPoolTest, ParallelForCoversRangeOnce) {
+    TaskPool pool;
+    ASSERT_TRUE(pool.start(4));
+    EXPECT_EQ(pool.size(), 4u);
+
+    std::vector<std::atomic<int>> hits(10000);
+    pool.parallel_for(0, hits.size(), 64, [&](size_t i) { hits[i].fetch_add(1); });
+    for (const auto& h : hits) ASSERT_EQ(h.load(), 1);
+
+    // Uneven tail and a single-chunk range
+    std::atomic<size_t> sum{0};
+    pool.parallel_for(5, 1000, 7, [&](size_t i) { sum += i; });
+    EXPECT_EQ(sum.load(), (999 * 1000) / 2 - 10);
+    pool.parallel_for(0, 3, 8, [&](size_t) { sum += 1; });
+}
+
+TEST(TaskPoolTest, NestedParallelForAndExceptions) {
+    TaskPool pool;
+    ASSERT_TRUE(pool.start(2));
+
+    // Inner loops run from inside tasks; callers help instead of blocking
+    std::atomic<int> cells{0};
+    pool.parallel_for(0, 8, 1, [&](size_t) {
+        pool.parallel_for(0, 100, 10, [&](size_t) { cells.fetch_add(1); });
+    });
+    EXPECT_EQ(cells.load(), 800);
+
+    EXPECT_THROW(pool.parallel_for(0, 100, 1, [](size_t i) {
+        if (i == 42) throw std::runtime_error("boom");
+    }), std::runtime_error);
+}
+
+TEST(TaskPoolTest, IdleWorkersStealQueuedTasks) {
+    TaskPool pool;
+    ASSERT_TRUE(pool.start(2));
+
+    // One task fans out onto its own worker's deque; the other worker must steal
+    std::atomic<int> done{0};
+    pool.submit([&]() {
+        for (int i = 0; i < 64; ++i) {
+            pool.submit([&]() {
+                std::this_thread::sleep_for(std::chrono::milliseconds(1));
+                done.fetch_add(1);
+            });
+        }
+    });
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+    while (done.load() < 64 && std::chrono::steady_clock::now() < deadline) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    }
+    EXPECT_EQ(done.load(), 64);
+
+    auto stats = pool.get_stats();
+    EXPECT_EQ(stats["tasks"].get<uint64_t>(), 65u);
+    EXPECT_GT(stats["steals"].get<uint64_t>(), 0u);
+    EXPECT_EQ(stats["queue_depth"].get<int64_t>(), 0);
+
+    // A stopped pool runs submissions inline
+    pool.stop();
+    bool ran = false;
+    pool.submit([&]() { ran = true; });
+    EXPECT_TRUE(ran);
+}
+
+TEST(TaskPoolTest, StopFinishesQueuedWork) {
+    TaskPool pool;
+    ASSERT_TRUE(pool.start(2));
+
+    // A caller still waiting on its chunks returns once stop() has run them
+    std::vector<std::atomic<int>> hits(200);
+    std::thread caller([&]() {
+        pool.parallel_for(0, hits.size(), 1, [&](size_t i) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            hits[i].fetch_add(1);
+        });
+    });
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    pool.stop();
+    caller.join();
+    for (const auto& h : hits) ASSERT_EQ(h.load(), 1);
+    EXPECT_EQ(pool.size(), 0u);
+    EXPECT_EQ(pool.get_stats()["queue_depth"].get<int64_t>(), 0);
+
+    // Exceptions of any type stay inside the task
+    ASSERT_TRUE(pool.start(2));
+    std::atomic<bool> after{false};
+    pool.submit([]() { throw 42; });
+    pool.submit([&]() { after = true; });
+    pool.stop();
+    EXPECT_TRUE(after.load());
+}
+
+TEST(TaskPoolTest, CorrelatorWindowSeriesMatchesInline) {
+    correlate::Correlator corr("");
+    ASSERT_TRUE(corr.init());
+    for (int i = 0; i < 200; ++i) {
+        net::PacketMeta meta;
+        meta.length = 100 + i;
+        corr.push_packet(meta);
+    }
+    uint64_t now = std::chrono::duration_cast<std::chrono::milliseconds>(
+                       std::chrono::steady_clock::now().time_since_epoch()).count();
+
+    auto inline_series = corr.get_window_series(now - 5000, now + 1000, 500);
+    TaskPool pool;
+    ASSERT_TRUE(pool.start(3));
+    corr.set_task_pool(&pool);
+    auto pooled_series = corr.get_window_series(now - 5000, now + 1000, 500);
+
+    ASSERT_EQ(inline_series.size(), 12u);
+    EXPECT_EQ(pooled_series, inline_series);
+    uint64_t packets = 0;
+    for (const auto& w : pooled_series) packets += w["packets"].get<uint64_t>();
+    EXPECT_EQ(packets, 200u);
+    // Each window matches the same range queried on its own
+    for (const auto& w : pooled_series) {
+        auto single = corr.get_window_stats(w["start"].get<uint64_t>(), w["end"].get<uint64_t>());
+        single["start"] = w["start"];
+        single["end"] = w["end"];
+        EXPECT_EQ(single, w);
+    }
+}
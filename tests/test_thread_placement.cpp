@@ -0,0 +1,114 @@
+#include <gtest/gtest.h>
+#include <future>
+#include <sched.h>
+#include <thread>
+
+#include "core/thread_placement.hpp"
+
+using namespace environet::core;
+
+namespace {
+
+int first_allowed_cpu() {
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    sched_getaffinity(0, sizeof(set), &set);
+    for (int cpu = 0; cpu < CPU_SETSIZE; ++cpu) {
+        if (CPU_ISSET(cpu, &set)) return cpu;
+    }
+    return 0;
+}
+
+// Run apply() on a fresh thread and read the stats while it is still alive
+nlohmann::json apply_on_thread(const std::string& role, bool& ok) {
+    std::promise<void> applied, done;
+    std::thread t([&]() {
+        ok = ThreadPlacement::instance().apply(role);
+        applied.set_value();
+        done.get_future().wait();
+    });
+    applied.get_future().wait();
+    auto stats = ThreadPlacement::instance().get_stats();
+    done.set_value();
+    t.join();
+    return stats;
+}
+
+} // namespace
+
+TEST(ThreadPlacementTest, ConfigRoundTripAndValidation) {
+    Config cfg = Config::from_json(R"({"threads": {"numa_node": 0,
+        "capture": {"cpus": [2, 3], "policy": "fifo", "priority": 50},
+        "writer": {"nice": 10}}})");
+    EXPECT_EQ(cfg.threads.capture.cpus, (std::vector<int>{2, 3}));
+    EXPECT_EQ(cfg.threads.capture.policy, "fifo");
+    EXPECT_EQ(cfg.threads.capture.priority, 50);
+    EXPECT_EQ(cfg.threads.writer.nice, 10);
+    EXPECT_EQ(cfg.threads.writer.policy, "other");
+    EXPECT_EQ(cfg.threads.numa_node, 0);
+
+    Config round = Config::from_json(cfg.to_json().dump());
+    EXPECT_EQ(round.to_json(), cfg.to_json());
+
+    EXPECT_THROW(Config::from_json(R"({"threads": {"sensor": {"policy": "deadline"}}})"), std::runtime_error);
+    EXPECT_THROW(Config::from_json(R"({"threads": {"sensor": {"policy": "fifo"}}})"), std::runtime_error);
+    EXPECT_THROW(Config::from_json(R"({"threads": {"sensor": {"priority": 10}}})"), std::runtime_error);
+    EXPECT_THROW(Config::from_json(R"({"threads": {"metrics": {"nice": 20}}})"), std::runtime_error);
+    EXPECT_THROW(Config::from_json(R"({"threads": {"metrics": {"cpus": [-1]}}})"), std::runtime_error);
+    EXPECT_THROW(Config::from_json(R"({"threads": {"numa_node": -2}})"), std::runtime_error);
+}
+
+TEST(ThreadPlacementTest, AppliesAffinityAndReportsLivePlacement) {
+    int cpu = first_allowed_cpu();
+    Config::ThreadsConfig threads;
+    threads.correlation.cpus = {cpu};
+    threads.metrics.nice = 5;
+    ThreadPlacement::instance().configure(threads);
+
+    bool ok = false;
+    auto stats = apply_on_thread("correlation", ok);
+    EXPECT_TRUE(ok) << ThreadPlacement::instance().get_last_error();
+    ASSERT_TRUE(stats.contains("correlation"));
+    const auto& entry = stats["correlation"].back();
+    EXPECT_TRUE(entry["alive"].get<bool>());
+    EXPECT_EQ(entry["cpus"], nlohmann::json::array({cpu}));
+    EXPECT_EQ(entry["policy"], "other");
+    EXPECT_EQ(entry["last_cpu"].get<int>(), cpu);
+
+    stats = apply_on_thread("metrics", ok);
+    EXPECT_TRUE(ok) << ThreadPlacement::instance().get_last_error();
+    EXPECT_EQ(stats["metrics"].back()["nice"].get<int>(), 5);
+
+    // Exited threads stay listed but are no longer read from the kernel
+    stats = ThreadPlacement::instance().get_stats();
+    EXPECT_FALSE(stats["correlation"].back()["alive"].get<bool>());
+
+    EXPECT_FALSE(ThreadPlacement::instance().apply("bogus"));
+    ThreadPlacement::instance().configure(Config::ThreadsConfig{});
+}
+
+TEST(ThreadPlacementTest, RealtimePolicyAppliesOrReportsError) {
+    Config::ThreadsConfig threads;
+    threads.correlation.policy = "fifo";
+    threads.correlation.priority = 1;
+    ThreadPlacement::instance().configure(threads);
+
+    // Needs CAP_SYS_NICE; either way the outcome is visible in the stats
+    bool ok = false;
+    auto entry = apply_on_thread("correlation", ok)["correlation"].back();
+    if (ok) {
+        EXPECT_EQ(entry["policy"], "fifo");
+        EXPECT_EQ(entry["priority"].get<int>(), 1);
+    } else {
+        EXPECT_EQ(entry["policy"], "other");
+        EXPECT_NE(entry["error"].get<std::string>().find("policy fifo"), std::string::npos);
+    }
+    ThreadPlacement::instance().configure(Config::ThreadsConfig{});
+}
+
+TEST(ThreadPlacementTest, NumaHelpers) {
+    EXPECT_EQ(ThreadPlacement::interface_numa_node("lo"), -1);
+    EXPECT_EQ(ThreadPlacement::interface_numa_node("../../etc"), -1);
+    EXPECT_TRUE(ThreadPlacement::set_memory_node(-1));
+    EXPECT_FALSE(ThreadPlacement::set_memory_node(4096));
+}
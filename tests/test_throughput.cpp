@@ -0,0 +1,187 @@
+#include <gtest/gtest.h>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <thread>
+#include <vector>
+
+#include "correlate/correlator.hpp"
+#include "net/throughput.hpp"
+
+using namespace environet;
+using namespace environet::net;
+
+namespace {
+
+const uint8_t LOCAL_MAC[6] = {0x02, 0x00, 0x00, 0x00, 0x00, 0x0a};
+const uint8_t PEER_MAC[6] = {0x02, 0x00, 0x00, 0x00, 0x00, 0x0b};
+const uint8_t OTHER_MAC[6] = {0x02, 0x00, 0x00, 0x00, 0x00, 0x0c};
+const uint8_t BROADCAST[6] = {0xff, 0xff, 0xff, 0xff, 0xff, 0xff};
+
+PacketLayers between(const uint8_t* src, const uint8_t* dst) {
+    PacketLayers layers;
+    layers.src_mac = src;
+    layers.dst_mac = dst;
+    return layers;
+}
+
+constexpr size_t RX = static_cast<size_t>(Direction::Rx);
+constexpr size_t TX = static_cast<size_t>(Direction::Tx);
+constexpr size_t OTHER = static_cast<size_t>(Direction::Other);
+
+} // namespace
+
+TEST(ThroughputMeterTest, ClassifiesDirectionByLocalMac) {
+    ThroughputMeter meter("eth0");
+    EXPECT_EQ(meter.direction(between(LOCAL_MAC, PEER_MAC)), Direction::Other);
+
+    meter.set_local_mac(LOCAL_MAC);
+    EXPECT_EQ(meter.direction(between(LOCAL_MAC, PEER_MAC)), Direction::Tx);
+    EXPECT_EQ(meter.direction(between(PEER_MAC, LOCAL_MAC)), Direction::Rx);
+    EXPECT_EQ(meter.direction(between(PEER_MAC, BROADCAST)), Direction::Rx);
+    EXPECT_EQ(meter.direction(between(PEER_MAC, OTHER_MAC)), Direction::Other);
+    EXPECT_EQ(meter.direction(PacketLayers{}), Direction::Other);
+
+    std::array<uint8_t, 6> mac{};
+    EXPECT_FALSE(ThroughputMeter::read_interface_mac("", mac));
+    EXPECT_FALSE(ThroughputMeter::read_interface_mac("../etc", mac));
+    EXPECT_FALSE(ThroughputMeter::read_interface_mac("lo", mac));     // All-zero address
+}
+
+TEST(ThroughputMeterTest, DrainsMergedBucketsIncludingIdleOnes) {
+    ThroughputMeter meter("wlan0");
+    const uint64_t base = (ThroughputMeter::get_current_time_ms() / 100 + 1) * 100;
+    meter.record_at(base + 10, Direction::Rx, 1000);
+    meter.record_at(base + 99, Direction::Other, 60);
+
+    // Two capture threads write the same bucket into their own rings
+    auto send = [&meter, base] {
+        for (int i = 0; i < 1000; ++i) meter.record_at(base + 150, Direction::Tx, 100);
+    };
+    std::thread first(send), second(send);
+    first.join();
+    second.join();
+
+    // Bucket base+300 is still open and is not drained yet
+    meter.record_at(base + 310, Direction::Rx, 5);
+    std::vector<ThroughputSample> samples;
+    size_t drained = meter.drain(base + 350, samples);
+    ASSERT_GE(drained, 3u);
+    ASSERT_EQ(samples.size(), drained);
+    for (size_t i = 0; i + 3 < samples.size(); ++i) EXPECT_EQ(samples[i].total_bytes(), 0u);
+    const auto& rx = samples[drained - 3];
+    const auto& tx = samples[drained - 2];
+    const auto& idle = samples[drained - 1];
+    EXPECT_EQ(rx.interface, "wlan0");
+    EXPECT_EQ(rx.timestamp_ms, base);
+    EXPECT_EQ(rx.interval_ms, 100u);
+    EXPECT_EQ(rx.bytes[RX], 1000u);
+    EXPECT_EQ(rx.bytes[OTHER], 60u);
+    EXPECT_EQ(rx.packets[RX], 1u);
+    EXPECT_EQ(tx.bytes[TX], 200000u);
+    EXPECT_EQ(tx.packets[TX], 2000u);
+    EXPECT_EQ(idle.timestamp_ms, base + 200);
+    EXPECT_EQ(idle.total_bytes(), 0u);
+
+    EXPECT_EQ(meter.drain(base + 350, samples), 0u);
+    samples.clear();
+    ASSERT_EQ(meter.drain(base + 400, samples), 1u);
+    EXPECT_EQ(samples[0].bytes[RX], 5u);
+
+    // A drain later than the ring keeps only what the ring still holds
+    samples.clear();
+    EXPECT_EQ(meter.drain(base + 400 + 100 * (ThroughputMeter::RING + 10), samples), ThroughputMeter::RING - 1);
+    auto stats = meter.get_stats();
+    EXPECT_EQ(stats["skipped_buckets"].get<uint64_t>(), 11u);
+    EXPECT_EQ(stats["tx_bytes"].get<uint64_t>(), 200000u);
+    EXPECT_EQ(stats["rx_packets"].get<uint64_t>(), 2u);
+}
+
+TEST(ThroughputMeterTest, WritersSharingAShardLoseNoCounts) {
+    ThroughputMeter meter("eth0");
+    const uint64_t base = (ThroughputMeter::get_current_time_ms() / 100 + 1) * 100;
+    // Twice as many threads as shards, all opening the same new buckets
+    const size_t threads = 2 * core::kMetricShards;
+    const int buckets = 10;
+    const int per_bucket = 500;
+    std::atomic<size_t> ready{0};
+    std::vector<std::thread> writers;
+    for (size_t t = 0; t < threads; ++t) {
+        writers.emplace_back([&meter, &ready, base, threads] {
+            ready.fetch_add(1);
+            while (ready.load() < threads) std::this_thread::yield();
+            for (int b = 0; b < buckets; ++b) {
+                for (int i = 0; i < per_bucket; ++i) meter.record_at(base + 100 * b, Direction::Rx, 10);
+            }
+        });
+    }
+    for (auto& w : writers) w.join();
+
+    std::vector<ThroughputSample> samples;
+    meter.drain(base + 100 * buckets, samples);
+    uint64_t packets = 0;
+    for (const auto& s : samples) {
+        if (s.timestamp_ms < base) continue;
+        EXPECT_EQ(s.packets[RX], threads * per_bucket) << "bucket " << s.timestamp_ms;
+        packets += s.packets[RX];
+    }
+    EXPECT_EQ(packets, threads * buckets * per_bucket);
+}
+
+TEST(ThroughputMeterTest, CorrelatorPrefersPassiveThroughput) {
+    auto config = std::make_shared<core::Config>(core::Config::get_defaults());
+    config->correlator.window_ms = 200;
+    config->correlator.sensor_threshold = 50;
+    correlate::Correlator corr(config);
+    ASSERT_TRUE(corr.init());
+
+    BssInfo ap("office-net", "aa:bb:cc:00:00:01", 2412, -5000);
+    Iperf3Results iperf;
+    iperf.success = true;
+    iperf.bandwidth_mbps = 100.0;
+    sensors::SensorFrame frame;
+    frame.ir_raw = 100;
+    corr.push_bss(ap);
+    corr.push_iperf3_results(iperf);
+    corr.push_sensor(frame);
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+
+    frame.ir_raw = 400;
+    corr.push_sensor(frame);
+    const uint64_t ts = ThroughputMeter::get_current_time_ms();
+    // 20 Mbps before the event, 2 Mbps after
+    for (uint64_t at : {ts - 190, ts - 90}) {
+        ThroughputSample s;
+        s.interface = "eth0";
+        s.timestamp_ms = at;
+        s.interval_ms = 100;
+        s.bytes[RX] = 200000;
+        s.bytes[TX] = 50000;
+        corr.push_throughput(s);
+    }
+    for (uint64_t at : {ts + 10, ts + 110}) {
+        ThroughputSample s;
+        s.interface = "eth0";
+        s.timestamp_ms = at;
+        s.interval_ms = 100;
+        s.bytes[RX] = 25000;
+        corr.push_throughput(s);
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    ap.signal_mbm = -6000;
+    corr.push_bss(ap);
+    iperf.bandwidth_mbps = 50.0;
+    corr.push_iperf3_results(iperf);
+    std::this_thread::sleep_for(std::chrono::milliseconds(250));
+
+    ASSERT_EQ(corr.process(), 1u);
+    auto findings = corr.get_findings();
+    ASSERT_EQ(findings.size(), 1u);
+    EXPECT_NEAR(findings[0].throughput_delta, -18.0, 1e-9);
+
+    auto stats = corr.get_window_stats(ts - 190, ts - 1);
+    EXPECT_NEAR(stats["throughput_mbps"].get<double>(), 20.0, 1e-9);
+    EXPECT_NEAR(stats["rx_mbps"].get<double>(), 16.0, 1e-9);
+    EXPECT_NEAR(stats["tx_mbps"].get<double>(), 4.0, 1e-9);
+    EXPECT_NEAR(stats["interfaces"]["eth0"]["rx_mbps"].get<double>(), 16.0, 1e-9);
+}
@@ -0,0 +1,72 @@
+#include <gtest/gtest.h>
+#include <chrono>
+#include <string>
+#include <thread>
+#include <nlohmann/json.hpp>
+
+#include "core/timeline.hpp"
+
+using namespace environet::core;
+
+static size_t count_events(const nlohmann::json& doc, const std::string& ph, const std::string& name) {
+    size_t n = 0;
+    for (const auto& ev : doc["traceEvents"]) {
+        if (ev["ph"] == ph && ev["name"] == name) ++n;
+    }
+    return n;
+}
+
+TEST(TimelineTest, ExportsSlicesCountersAndThreadNames) {
+    Timeline timeline;
+    EXPECT_EQ(timeline.to_chrome_json(0).find("\"ph\":\"X\""), std::string::npos);
+
+    timeline.enable(1024);
+    std::thread worker([&timeline]() {
+        timeline.set_thread_name("worker");
+        uint64_t start = latency_ticks();
+        std::this_thread::sleep_for(std::chrono::milliseconds(2));
+        timeline.slice("worker.step", start, latency_ticks());
+        timeline.counter("queue_depth", 42);
+        timeline.instant("worker.done");
+    });
+    worker.join();
+
+    auto doc = nlohmann::json::parse(timeline.to_chrome_json(60));
+    EXPECT_EQ(count_events(doc, "X", "worker.step"), 1u);
+    EXPECT_EQ(count_events(doc, "C", "queue_depth"), 1u);
+    EXPECT_EQ(count_events(doc, "i", "worker.done"), 1u);
+    EXPECT_EQ(count_events(doc, "M", "thread_name"), 1u);
+    for (const auto& ev : doc["traceEvents"]) {
+        if (ev["ph"] == "X") {
+            EXPECT_GE(ev["dur"].get<double>(), 1000.0);  // microseconds
+        }
+        if (ev["ph"] == "C") {
+            EXPECT_EQ(ev["args"]["value"], 42);
+        }
+    }
+}
+
+TEST(TimelineTest, RingKeepsNewestEventsAndWindowFilters) {
+    Timeline timeline;
+    timeline.enable(16);
+    for (int i = 0; i < 100; ++i) timeline.counter("depth", i);
+    auto doc = nlohmann::json::parse(timeline.to_chrome_json(0));
+    EXPECT_EQ(count_events(doc, "C", "depth"), 16u);
+    int64_t min_value = 1000;
+    for (const auto& ev : doc["traceEvents"]) {
+        if (ev["ph"] == "C") min_value = std::min<int64_t>(min_value, ev["args"]["value"].get<int64_t>());
+    }
+    EXPECT_EQ(min_value, 84);
+
+    // Only events from the last few milliseconds survive a short window
+    std::this_thread::sleep_for(std::chrono::milliseconds(200));
+    timeline.counter("fresh", 1);
+    doc = nlohmann::json::parse(timeline.to_chrome_json(0.1));
+    EXPECT_EQ(count_events(doc, "C", "depth"), 0u);
+    EXPECT_EQ(count_events(doc, "C", "fresh"), 1u);
+
+    // Disabled timeline records nothing new
+    timeline.disable();
+    timeline.counter("fresh", 2);
+    EXPECT_EQ(timeline.get_stats()["events_recorded"].get<uint64_t>(), 101u);
+}
@@ -0,0 +1,108 @@
+#include <gtest/gtest.h>
+#include <chrono>
+#include <cstdio>
+#include <string>
+#include <thread>
+#include <vector>
+#include <unistd.h>
+
+#include "core/trace_log.hpp"
+
+using namespace environet::core;
+
+static std::string trace_path(const std::string& name) {
+    return "test_trace_" + name + "_" + std::to_string(getpid()) + ".trace";
+}
+
+TEST(TraceLogTest, MultiThreadWriteAndReadBack) {
+    std::string path = trace_path("mt");
+    TraceLog trace;
+    ASSERT_TRUE(trace.start(path, 64 * 1024 * 1024, 1, 1 << 16, 5)) << trace.get_last_error();
+
+    const int threads = 4;
+    const uint32_t per_thread = 10000;
+    std::vector<std::thread> writers;
+    for (int t = 0; t < threads; ++t) {
+        writers.emplace_back([&trace, t]() {
+            for (uint32_t i = 0; i < per_thread; ++i) {
+                TraceRecord* rec = trace.begin(TraceEventType::Sensor);
+                if (!rec) continue;
+                rec->sensor.ts_ms = i;
+                rec->sensor.ir_raw = static_cast<int16_t>(t);
+                trace.commit();
+            }
+        });
+    }
+    for (auto& w : writers) w.join();
+    trace.stop();
+
+    auto stats = trace.get_stats();
+    EXPECT_EQ(stats["records_written"].get<uint64_t>() + stats["records_dropped"].get<uint64_t>(),
+              threads * per_thread);
+
+    TraceReader reader;
+    ASSERT_TRUE(reader.open(path)) << reader.get_last_error();
+    EXPECT_EQ(reader.header().record_size, sizeof(TraceRecord));
+
+    // Per-thread records come out in order, with seq gaps only for drops
+    std::vector<int64_t> last_ts(threads, -1);
+    uint64_t read = 0;
+    TraceRecord rec;
+    while (reader.next(rec)) {
+        ASSERT_EQ(rec.type, static_cast<uint8_t>(TraceEventType::Sensor));
+        int t = rec.sensor.ir_raw;
+        ASSERT_GE(t, 0);
+        ASSERT_LT(t, threads);
+        EXPECT_GT(static_cast<int64_t>(rec.sensor.ts_ms), last_ts[t]);
+        last_ts[t] = rec.sensor.ts_ms;
+        ++read;
+    }
+    EXPECT_EQ(read, stats["records_written"].get<uint64_t>());
+
+    auto j = trace_record_to_json(rec, reader.to_realtime_ns(rec.ticks));
+    EXPECT_EQ(j["type"], "sensor");
+    std::remove(path.c_str());
+}
+
+TEST(TraceLogTest, FullRingDropsInsteadOfBlocking) {
+    std::string path = trace_path("drop");
+    TraceLog trace;
+    // Long flush interval so the ring cannot drain while we write
+    ASSERT_TRUE(trace.start(path, 64 * 1024 * 1024, 1, 16, 10000));
+    int accepted = 0;
+    for (int i = 0; i < 100; ++i) {
+        if (TraceRecord* rec = trace.begin(TraceEventType::Packet)) {
+            rec->packet.length = static_cast<uint32_t>(i);
+            trace.commit();
+            ++accepted;
+        }
+    }
+    EXPECT_EQ(accepted, 16);
+    EXPECT_EQ(trace.get_stats()["records_dropped"].get<uint64_t>(), 84u);
+    trace.stop();
+    EXPECT_EQ(trace.get_stats()["records_written"].get<uint64_t>(), 16u);
+
+    // Disabled log accepts nothing
+    EXPECT_EQ(trace.begin(TraceEventType::Packet), nullptr);
+    std::remove(path.c_str());
+}
+
+TEST(TraceLogTest, RotatesFiles) {
+    std::string path = trace_path("rot");
+    TraceLog trace;
+    ASSERT_TRUE(trace.start(path, 4096, 3, 1024, 1));
+    for (int batch = 0; batch < 20; ++batch) {
+        for (int i = 0; i < 100; ++i) {
+            if (trace.begin(TraceEventType::Finding)) trace.commit();
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    }
+    trace.stop();
+    EXPECT_GT(trace.get_stats()["files_rotated"].get<uint64_t>(), 0u);
+
+    TraceReader rotated;
+    EXPECT_TRUE(rotated.open(path + ".1")) << rotated.get_last_error();
+    TraceReader missing;
+    EXPECT_FALSE(missing.open(path + ".3"));
+    for (const char* suffix : {"", ".1", ".2"}) std::remove((path + suffix).c_str());
+}
@@ -0,0 +1,284 @@
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <random>
+#include <thread>
+#include <vector>
+
+#include "core/sketch.hpp"
+#include "correlate/correlator.hpp"
+#include "net/traffic_accounting.hpp"
+#include "packet_builder.hpp"
+
+using namespace environet;
+using namespace environet::net;
+
+namespace {
+
+// Ethernet/IPv4/UDP frame of a given total length (at least 42 bytes)
+std::vector<uint8_t> frame(const std::vector<uint8_t>& src_mac, const std::vector<uint8_t>& dst_mac,
+                           uint8_t src_host, uint8_t dst_host, size_t length) {
+    return test::PacketBuilder()
+        .macs(src_mac, dst_mac)
+        .ips({10, 0, 0, src_host}, {10, 0, 0, dst_host})
+        .udp(12345, 53)
+        .payload(std::vector<uint8_t>(length - 42))
+        .frame();
+}
+
+std::shared_ptr<core::Config> accounting_config(int bucket_ms, int buckets) {
+    auto config = std::make_shared<core::Config>(core::Config::get_defaults());
+    config->accounting.bucket_ms = bucket_ms;
+    config->accounting.buckets = buckets;
+    return config;
+}
+
+const std::vector<uint8_t> GATEWAY_MAC = {0x02, 0x00, 0x00, 0x00, 0x00, 0x01};
+const std::vector<uint8_t> CAMERA_MAC = {0xb8, 0x27, 0xeb, 0x00, 0x00, 0x10};
+const std::vector<uint8_t> LAPTOP_MAC = {0x3c, 0x22, 0xfb, 0x00, 0x00, 0x20};
+
+} // namespace
+
+TEST(SketchTest, CountMinBoundsAndMerge) {
+    core::CountMinSketch a(256, 4), b(256, 4);
+    std::vector<uint64_t> truth(2000);
+    std::mt19937_64 rng(7);
+    for (uint64_t key = 0; key < truth.size(); ++key) {
+        truth[key] = rng() % 100;
+        (key % 2 ? a : b).add(core::hash64(&key, sizeof(key)), truth[key]);
+    }
+    ASSERT_TRUE(a.merge(b));
+    uint64_t total = 0;
+    for (uint64_t t : truth) total += t;
+    EXPECT_EQ(a.total(), total);
+
+    // Never below the truth; above by more than e/width of total only rarely
+    size_t outliers = 0;
+    for (uint64_t key = 0; key < truth.size(); ++key) {
+        uint64_t estimate = a.estimate(core::hash64(&key, sizeof(key)));
+        EXPECT_GE(estimate, truth[key]);
+        if (estimate - truth[key] > 2.72 * total / 256) ++outliers;
+    }
+    EXPECT_LT(outliers, truth.size() / 20);
+
+    core::CountMinSketch other_shape(128, 4);
+    EXPECT_FALSE(a.merge(other_shape));
+    a.clear();
+    EXPECT_EQ(a.total(), 0u);
+}
+
+TEST(SketchTest, SpaceSavingFindsHeavyHittersAmongRandomMacs) {
+    // Randomized MACs flood the summary; the three real talkers still surface
+    core::SpaceSaving left(16), right(16);
+    std::mt19937_64 rng(11);
+    const char* heavy[] = {"aa:aa:aa:aa:aa:01", "aa:aa:aa:aa:aa:02", "aa:aa:aa:aa:aa:03"};
+    for (int i = 0; i < 20000; ++i) {
+        auto& summary = i % 2 ? left : right;
+        if (i % 4 == 0) {
+            const char* key = heavy[(i / 4) % 3];
+            summary.add(core::hash64(key, 17), key, 17, 1500);
+        } else {
+            uint64_t random = rng();
+            summary.add(core::hash64(&random, 6), "random", 6, 100);
+        }
+    }
+    left.merge(right);
+    EXPECT_EQ(left.entries().size(), 16u);
+    auto top = left.top(3);
+    ASSERT_EQ(top.size(), 3u);
+    std::vector<std::string> keys;
+    for (const auto& e : top) {
+        keys.emplace_back(e.key);
+        EXPECT_LE(e.count - e.error, 5000u * 1500u / 3 + 1500u);
+        EXPECT_GE(e.count, 5000u * 1500u / 3 - 1500u);
+    }
+    std::sort(keys.begin(), keys.end());
+    EXPECT_EQ(keys, std::vector<std::string>(std::begin(heavy), std::end(heavy)));
+}
+
+TEST(TrafficAccountingTest, RanksHostsPerBucketRange) {
+    TrafficAccounting accounting(accounting_config(100, 8));
+    ASSERT_TRUE(accounting.init());
+    auto camera = test::dissect_frame(frame(CAMERA_MAC, GATEWAY_MAC, 10, 1, 1000));
+    auto laptop = test::dissect_frame(frame(LAPTOP_MAC, GATEWAY_MAC, 20, 1, 200));
+
+    // Buckets 10..11: camera dominates; bucket 12: only the laptop
+    for (int i = 0; i < 10; ++i) accounting.record_at(1000 + i * 10, camera.meta, camera.layers);
+    for (int i = 0; i < 5; ++i) accounting.record_at(1100 + i, laptop.meta, laptop.layers);
+    for (int i = 0; i < 3; ++i) accounting.record_at(1250, laptop.meta, laptop.layers);
+
+    auto top = accounting.top(TrafficKey::SrcMac, 1000, 1200, 5);
+    ASSERT_EQ(top.size(), 2u);
+    EXPECT_EQ(top[0].host, "b8:27:eb:00:00:10");
+    EXPECT_EQ(top[0].bytes, 10000u);
+    EXPECT_EQ(top[1].host, "3c:22:fb:00:00:20");
+    EXPECT_EQ(top[1].bytes, 1000u);
+    EXPECT_EQ(top[0].error, 0u);
+
+    top = accounting.top(TrafficKey::SrcIp, 1200, 1300, 5);
+    ASSERT_EQ(top.size(), 1u);
+    EXPECT_EQ(top[0].host, "10.0.0.20");
+    EXPECT_EQ(top[0].bytes, 600u);
+    top = accounting.top(TrafficKey::DstIp, 1000, 1300, 5);
+    ASSERT_EQ(top.size(), 1u);
+    EXPECT_EQ(top[0].bytes, 11600u);
+
+    // The camera went quiet and the laptop picked up across t=1200
+    std::pmr::vector<HostShift> shifts;
+    ASSERT_EQ(accounting.host_shifts(HostKind::Mac, 1000, 1200, 1300, shifts), 3u);
+    EXPECT_STREQ(shifts[0].host, "02:00:00:00:00:01");     // Gateway receives both
+    EXPECT_EQ(shifts[0].before_bytes, 11000u);
+    EXPECT_EQ(shifts[0].after_bytes, 600u);
+    EXPECT_STREQ(shifts[1].host, "b8:27:eb:00:00:10");
+    EXPECT_EQ(shifts[1].after_bytes, 0u);
+    EXPECT_STREQ(shifts[2].host, "3c:22:fb:00:00:20");
+
+    // A bucket that wrapped around the ring no longer answers for its old interval
+    accounting.record_at(1000 + 8 * 100, laptop.meta, laptop.layers);
+    top = accounting.top(TrafficKey::SrcMac, 1000, 1100, 5);
+    EXPECT_TRUE(top.empty());
+
+    auto stats = accounting.get_stats();
+    EXPECT_EQ(stats["capture_threads"].get<size_t>(), 1u);
+    EXPECT_GT(stats["memory_bytes"].get<size_t>(), 8u * 4 * 512 * 4 * sizeof(uint64_t));
+}
+
+TEST(TrafficAccountingTest, MergesCaptureThreads) {
+    TrafficAccounting accounting(accounting_config(1000, 4));
+    ASSERT_TRUE(accounting.init());
+    auto camera = test::dissect_frame(frame(CAMERA_MAC, GATEWAY_MAC, 10, 1, 500));
+    auto laptop = test::dissect_frame(frame(LAPTOP_MAC, GATEWAY_MAC, 20, 1, 100));
+
+    std::thread first([&] {
+        for (int i = 0; i < 1000; ++i) accounting.record_at(5000, camera.meta, camera.layers);
+    });
+    std::thread second([&] {
+        for (int i = 0; i < 1000; ++i) accounting.record_at(5500, laptop.meta, laptop.layers);
+        for (int i = 0; i < 1000; ++i) accounting.record_at(5500, camera.meta, camera.layers);
+    });
+    first.join();
+    second.join();
+
+    auto top = accounting.top(TrafficKey::SrcMac, 5000, 6000, 2);
+    ASSERT_EQ(top.size(), 2u);
+    EXPECT_EQ(top[0].host, "b8:27:eb:00:00:10");
+    EXPECT_EQ(top[0].bytes, 1000000u);
+    EXPECT_EQ(top[1].bytes, 100000u);
+    EXPECT_EQ(accounting.top(TrafficKey::DstMac, 5000, 6000, 2)[0].bytes, 1100000u);
+}
+
+TEST(TrafficAccountingTest, CorrelatorAttributesTrafficShift) {
+    auto config = accounting_config(1, 256);
+    config->correlator.window_ms = 40;
+    config->correlator.sensor_threshold = 50;
+    TrafficAccounting accounting(config);
+    ASSERT_TRUE(accounting.init());
+    correlate::Correlator corr(config);
+    ASSERT_TRUE(corr.init());
+    corr.set_traffic_accounting(&accounting);
+
+    auto camera = test::dissect_frame(frame(CAMERA_MAC, GATEWAY_MAC, 10, 1, 1400));
+    auto laptop = test::dissect_frame(frame(LAPTOP_MAC, GATEWAY_MAC, 20, 1, 1400));
+    sensors::SensorFrame frame;
+    frame.ir_raw = 100;
+    corr.push_sensor(frame);
+    for (int i = 0; i < 8; ++i) accounting.record(camera.meta, camera.layers);
+    std::this_thread::sleep_for(std::chrono::milliseconds(5));
+
+    // Someone walks in: IR jumps and the camera stops streaming
+    frame.ir_raw = 400;
+    corr.push_sensor(frame);
+    std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    for (int i = 0; i < 8; ++i) accounting.record(laptop.meta, laptop.layers);
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+
+    ASSERT_EQ(corr.process(), 1u);
+    auto findings = corr.get_findings();
+    ASSERT_EQ(findings.size(), 1u);
+    const auto& f = findings[0];
+    EXPECT_TRUE(f.affected_networks.empty());
+    ASSERT_EQ(f.affected_hosts.size(), 2u);
+    std::vector<std::string> hosts(f.affected_hosts.begin(), f.affected_hosts.end());
+    std::sort(hosts.begin(), hosts.end());
+    EXPECT_EQ(hosts, (std::vector<std::string>{"3c:22:fb:00:00:20", "b8:27:eb:00:00:10"}));
+    EXPECT_NE(f.description.find("traffic shift on 2 host(s)"), std::string::npos);
+}
+
+TEST(SketchTest, HyperLogLogEstimatesAndMerges) {
+    core::HyperLogLog low(10), high(10);
+    for (uint64_t key = 0; key < 60000; ++key) low.add(core::hash64(&key, sizeof(key)));
+    for (uint64_t key = 40000; key < 100000; ++key) high.add(core::hash64(&key, sizeof(key)));
+    EXPECT_NEAR(low.estimate(), 60000.0, 6000.0);
+    ASSERT_TRUE(low.merge(high));
+    EXPECT_NEAR(low.estimate(), 100000.0, 10000.0);   // Overlap counted once
+    EXPECT_EQ(low.memory_bytes(), 1024u);
+
+    // Small counts use linear counting; repeats change nothing
+    core::HyperLogLog few(10);
+    for (int round = 0; round < 50; ++round) {
+        for (uint64_t key = 0; key < 40; ++key) few.add(core::hash64(&key, sizeof(key), 1));
+    }
+    EXPECT_NEAR(few.estimate(), 40.0, 2.0);
+
+    core::HyperLogLog other_precision(12);
+    EXPECT_FALSE(few.merge(other_precision));
+    few.clear();
+    EXPECT_EQ(few.estimate(), 0.0);
+}
+
+TEST(TrafficAccountingTest, CountsDevicesPerWindowAndChannel) {
+    auto config = accounting_config(100, 8);
+    TrafficAccounting accounting(config);
+    ASSERT_TRUE(accounting.init());
+
+    // Probe-request-like traffic: many randomized MACs, each seen repeatedly
+    auto probes = [&accounting](uint64_t now, uint16_t frequency, uint32_t first, uint32_t count) {
+        for (int repeat = 0; repeat < 3; ++repeat) {
+            for (uint32_t n = first; n < first + count; ++n) {
+                uint8_t mac[6] = {0x02, 0x5a, static_cast<uint8_t>(n >> 16), static_cast<uint8_t>(n >> 8),
+                                  static_cast<uint8_t>(n), 0x01};
+                PacketMeta meta;
+                PacketLayers layers;
+                meta.length = 100;
+                meta.frequency_mhz = frequency;
+                layers.src_mac = mac;
+                accounting.record_at(now, meta, layers);
+            }
+        }
+    };
+    std::thread first([&] { probes(1000, 2412, 0, 300); });
+    std::thread second([&] {
+        probes(1150, 2412, 200, 200);   // 100 new devices on 2412, 100 already seen
+        probes(1150, 5180, 1000, 50);
+    });
+    first.join();
+    second.join();
+
+    // Broadcast/multicast sources are not devices
+    uint8_t group[6] = {0x01, 0x00, 0x5e, 0x00, 0x00, 0x01};
+    PacketMeta meta;
+    PacketLayers layers;
+    layers.src_mac = group;
+    accounting.record_at(1000, meta, layers);
+
+    auto count = accounting.devices(1000, 1100);
+    EXPECT_NEAR(count.devices, 300.0, 15.0);
+    count = accounting.devices(1000, 1200);
+    EXPECT_NEAR(count.devices, 450.0, 25.0);
+    ASSERT_EQ(count.channels.size(), 2u);
+    EXPECT_EQ(count.channels[0].frequency_mhz, 2412);
+    EXPECT_NEAR(count.channels[0].devices, 400.0, 20.0);
+    EXPECT_EQ(count.channels[1].frequency_mhz, 5180);
+    EXPECT_NEAR(count.channels[1].devices, 50.0, 3.0);
+
+    // The correlator reports the same counts as a window series
+    correlate::Correlator corr(config);
+    ASSERT_TRUE(corr.init());
+    corr.set_traffic_accounting(&accounting);
+    auto series = corr.get_window_series(1000, 1199, 100);
+    ASSERT_EQ(series.size(), 2u);
+    EXPECT_NEAR(series[0]["unique_devices"].get<double>(), 300.0, 15.0);
+    EXPECT_NEAR(series[1]["unique_devices"].get<double>(), 250.0, 15.0);
+    EXPECT_NEAR(series[1]["channel_devices"]["5180"].get<double>(), 50.0, 3.0);
+}
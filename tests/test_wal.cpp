@@ -0,0 +1,227 @@
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <thread>
+#include <vector>
+#include <unistd.h>
+
+#include "core/wal.hpp"
+
+using namespace environet::core;
+
+static std::string wal_dir(const std::string& name) {
+    std::string dir = "test_wal_" + name + "_" + std::to_string(getpid());
+    std::filesystem::remove_all(dir);
+    return dir;
+}
+
+static std::vector<std::filesystem::path> segment_files(const std::string& dir) {
+    std::vector<std::filesystem::path> files;
+    for (const auto& entry : std::filesystem::directory_iterator(dir)) {
+        if (entry.path().extension() == ".wal") files.push_back(entry.path());
+    }
+    std::sort(files.begin(), files.end());
+    return files;
+}
+
+static std::vector<std::pair<uint64_t, std::string>> read_all(WriteAheadLog& wal, uint64_t from = 1) {
+    std::vector<std::pair<uint64_t, std::string>> records;
+    for (;;) {
+        size_t n = wal.read(from, 1000, 1 << 20, [&](uint64_t lsn, std::string_view payload) {
+            records.emplace_back(lsn, std::string(payload));
+            from = lsn + 1;
+        });
+        if (n == 0) break;
+    }
+    return records;
+}
+
+TEST(WalTest, AppendSyncAndRecoverAcrossSegments) {
+    std::string dir = wal_dir("recover");
+    {
+        WriteAheadLog wal(dir, 4096, 1 << 20);
+        ASSERT_TRUE(wal.open()) << wal.get_last_error();
+        for (int i = 0; i < 200; ++i) {
+            EXPECT_EQ(wal.append("record-" + std::to_string(i) + std::string(40, 'x')), static_cast<uint64_t>(i + 1));
+            if (i % 10 == 9) {
+                ASSERT_TRUE(wal.sync()) << wal.get_last_error();
+            }
+        }
+        // Appended but not synced: invisible to readers and lost on restart
+        wal.append("unsynced");
+        EXPECT_EQ(read_all(wal).size(), 200u);
+        EXPECT_GT(wal.get_stats()["segments"].get<size_t>(), 1u);
+    }
+    // The destructor syncs, so the last record survives too
+    WriteAheadLog wal(dir, 4096, 1 << 20);
+    ASSERT_TRUE(wal.open()) << wal.get_last_error();
+    auto records = read_all(wal);
+    ASSERT_EQ(records.size(), 201u);
+    for (size_t i = 0; i < 200; ++i) {
+        EXPECT_EQ(records[i].first, i + 1);
+        EXPECT_EQ(records[i].second.rfind("record-" + std::to_string(i), 0), 0u);
+    }
+    EXPECT_EQ(records.back().second, "unsynced");
+    EXPECT_EQ(wal.next_lsn(), 202u);
+    EXPECT_EQ(wal.get_stats()["recovered_records"], 201);
+
+    // Reads resume mid-log and respect the record and byte limits
+    std::vector<uint64_t> lsns;
+    EXPECT_EQ(wal.read(150, 5, 1 << 20, [&](uint64_t lsn, std::string_view) { lsns.push_back(lsn); }), 5u);
+    EXPECT_EQ(lsns, (std::vector<uint64_t>{150, 151, 152, 153, 154}));
+    EXPECT_EQ(wal.read(10, 100, 1, [](uint64_t, std::string_view) {}), 1u);
+    std::filesystem::remove_all(dir);
+}
+
+TEST(WalTest, EpochChangesOnlyWhenLsnsStartOver) {
+    std::string dir = wal_dir("epoch");
+    uint64_t epoch = 0;
+    {
+        WriteAheadLog wal(dir, 4096, 1 << 20);
+        ASSERT_TRUE(wal.open()) << wal.get_last_error();
+        epoch = wal.epoch();
+        EXPECT_NE(epoch, 0u);
+        wal.append("a");
+        wal.append("b");
+        wal.release(2);
+    }
+    {
+        // Released records are gone but the sequence continues
+        WriteAheadLog wal(dir, 4096, 1 << 20);
+        ASSERT_TRUE(wal.open()) << wal.get_last_error();
+        EXPECT_EQ(wal.next_lsn(), 3u);
+        EXPECT_EQ(wal.epoch(), epoch);
+    }
+    // Segments removed (with or without the epoch file): LSNs and the epoch restart
+    for (const auto& file : segment_files(dir)) std::filesystem::remove(file);
+    {
+        WriteAheadLog wal(dir, 4096, 1 << 20);
+        ASSERT_TRUE(wal.open()) << wal.get_last_error();
+        EXPECT_EQ(wal.next_lsn(), 1u);
+        EXPECT_NE(wal.epoch(), epoch);
+        epoch = wal.epoch();
+    }
+    std::filesystem::remove_all(dir);
+    WriteAheadLog wal(dir, 4096, 1 << 20);
+    ASSERT_TRUE(wal.open()) << wal.get_last_error();
+    EXPECT_NE(wal.epoch(), epoch);
+    EXPECT_EQ(wal.get_stats()["epoch"].get<uint64_t>(), wal.epoch());
+    std::filesystem::remove_all(dir);
+}
+
+TEST(WalTest, TornTailIsTruncatedOnRecovery) {
+    std::string dir = wal_dir("torn");
+    {
+        WriteAheadLog wal(dir, 1 << 20, 1 << 22);
+        ASSERT_TRUE(wal.open());
+        for (int i = 0; i < 10; ++i) wal.append("payload-" + std::to_string(i));
+        ASSERT_TRUE(wal.sync());
+    }
+    auto files = segment_files(dir);
+    ASSERT_EQ(files.size(), 1u);
+    // Simulate a crash halfway through writing the last record
+    auto size = std::filesystem::file_size(files[0]);
+    std::filesystem::resize_file(files[0], size - 4);
+
+    WriteAheadLog wal(dir, 1 << 20, 1 << 22);
+    ASSERT_TRUE(wal.open()) << wal.get_last_error();
+    auto records = read_all(wal);
+    ASSERT_EQ(records.size(), 9u);
+    EXPECT_EQ(records.back().second, "payload-8");
+    EXPECT_EQ(wal.get_stats()["corrupt_records"], 1);
+
+    // New records continue the sequence right after the truncated one
+    EXPECT_EQ(wal.append("after"), 10u);
+    ASSERT_TRUE(wal.sync());
+    records = read_all(wal);
+    ASSERT_EQ(records.size(), 10u);
+    EXPECT_EQ(records.back(), std::make_pair(uint64_t{10}, std::string("after")));
+    std::filesystem::remove_all(dir);
+}
+
+TEST(WalTest, CorruptRecordEndsTheSegment) {
+    std::string dir = wal_dir("crc");
+    {
+        WriteAheadLog wal(dir, 1 << 20, 1 << 22);
+        ASSERT_TRUE(wal.open());
+        for (int i = 0; i < 5; ++i) wal.append(std::string(100, static_cast<char>('a' + i)));
+        ASSERT_TRUE(wal.sync());
+    }
+    auto files = segment_files(dir);
+    ASSERT_EQ(files.size(), 1u);
+    {
+        // Flip one payload byte of the third record
+        std::fstream f(files[0], std::ios::in | std::ios::out | std::ios::binary);
+        f.seekp(2 * (WriteAheadLog::RECORD_HEADER_SIZE + 100) + WriteAheadLog::RECORD_HEADER_SIZE + 50);
+        f.put('!');
+    }
+    WriteAheadLog wal(dir, 1 << 20, 1 << 22);
+    ASSERT_TRUE(wal.open());
+    auto records = read_all(wal);
+    ASSERT_EQ(records.size(), 2u);
+    EXPECT_EQ(records[1].second, std::string(100, 'b'));
+    EXPECT_EQ(wal.next_lsn(), 3u);
+    std::filesystem::remove_all(dir);
+}
+
+TEST(WalTest, ReleaseAndSizeLimitDropOldestSegments) {
+    std::string dir = wal_dir("evict");
+    WriteAheadLog wal(dir, 4096, 16384);
+    ASSERT_TRUE(wal.open());
+    const std::string payload(1000, 'p');
+    for (int i = 0; i < 100; ++i) {
+        wal.append(payload);
+        ASSERT_TRUE(wal.sync());
+    }
+    // The size bound holds and only whole, oldest segments were dropped
+    EXPECT_LE(wal.size_bytes(), 16384u);
+    auto stats = wal.get_stats();
+    uint64_t evicted = stats["records_evicted"];
+    EXPECT_GT(evicted, 0u);
+    EXPECT_EQ(wal.first_lsn(), evicted + 1);
+    auto records = read_all(wal);
+    ASSERT_FALSE(records.empty());
+    EXPECT_EQ(records.front().first, evicted + 1);
+    EXPECT_EQ(records.back().first, 100u);
+
+    // Releasing everything keeps only the segment being written, and the
+    // sequence survives a restart even with no records left
+    wal.release(100);
+    EXPECT_EQ(segment_files(dir).size(), 1u);
+    wal.close();
+    WriteAheadLog reopened(dir, 4096, 16384);
+    ASSERT_TRUE(reopened.open());
+    EXPECT_EQ(reopened.append("next"), 101u);
+    std::filesystem::remove_all(dir);
+}
+
+TEST(WalTest, ConcurrentSyncsShareWrites) {
+    std::string dir = wal_dir("group");
+    WriteAheadLog wal(dir, 1 << 20, 1 << 24);
+    ASSERT_TRUE(wal.open());
+    const int threads = 8;
+    const int per_thread = 200;
+    std::vector<std::thread> writers;
+    for (int t = 0; t < threads; ++t) {
+        writers.emplace_back([&wal, t]() {
+            for (int i = 0; i < per_thread; ++i) {
+                uint64_t lsn = wal.append(std::to_string(t) + ":" + std::to_string(i));
+                ASSERT_NE(lsn, 0u);
+                ASSERT_TRUE(wal.sync());
+                // Once sync() returns, the caller's record is durable
+                ASSERT_GE(wal.synced_lsn(), lsn);
+            }
+        });
+    }
+    for (auto& w : writers) w.join();
+
+    auto stats = wal.get_stats();
+    EXPECT_EQ(stats["records_appended"], threads * per_thread);
+    EXPECT_LE(stats["syncs"].get<uint64_t>(), static_cast<uint64_t>(threads * per_thread));
+    auto records = read_all(wal);
+    ASSERT_EQ(records.size(), static_cast<size_t>(threads * per_thread));
+    for (size_t i = 0; i < records.size(); ++i) EXPECT_EQ(records[i].first, i + 1);
+    std::filesystem::remove_all(dir);
+}